@@ -23,6 +23,10 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::abi
 {
+    // Marks parameters of functions whose type the lowering of the ABI has
+    // changed, e.g., records passed as integers. Their attributes no longer
+    // follow from their type.
+    constexpr string_ref coerced_arg_attr = "abi.coerced";
 
     // Whole ABI transformation is heavily based on clang implementation, because there is a
     // need to be faithful to it (since once use-case is to link with clanf compiled
@@ -265,11 +269,11 @@ namespace vast::abi
     template< typename Op >
     func_info( Op ) -> func_info< Op >;
 
-    template< typename Fn, typename Classifier, typename DL >
-    func_info< Fn > make( Fn fn, const DL &dl )
+    template< typename Fn, typename Classifier, typename DL, typename ... Args >
+    func_info< Fn > make( Fn fn, const DL &dl, Args && ... args )
     {
         auto info = func_info( fn );
-        return Classifier( info, dl ).compute_abi().take();
+        return Classifier( info, dl, std::forward< Args >( args ) ... ).compute_abi().take();
     }
 
 } // namespace vast::abi
@@ -5,12 +5,14 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/Alignment.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/ABI/ABI.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
 
 namespace vast::abi
 {
@@ -105,11 +107,7 @@ namespace vast::abi
 
         static hl::StructDeclOp get_struct_def( hl::RecordType t, mlir::ModuleOp m )
         {
-            for ( auto &op : *m.getBody() )
-                if ( auto decl = mlir::dyn_cast< hl::StructDeclOp >( op ) )
-                    if ( decl.getName() == t.getName() )
-                        return decl;
-            return {};
+            return hl::definition_of( t, m ).value_or( hl::StructDeclOp() );
         }
 
         static bool can_be_promoted( mlir::Type t )
@@ -134,7 +132,7 @@ namespace vast::abi
         static bool bits_contain_no_user_data( mlir::Type t, std::size_t start,
                                                std::size_t end, const auto &ctx )
         {
-            const auto &[ dl, op ] = ctx;
+            const auto &[ dl, op, _ ] = ctx;
 
             if ( size( dl, t ) <= start )
                 return true;
@@ -145,6 +143,20 @@ namespace vast::abi
             if ( is_record( t ) )
             {
                 // TODO(abi): CXXRecordDecl.
+                if ( auto layout = layout_of( ctx, t ) )
+                {
+                    for ( const auto &field : layout->fields )
+                    {
+                        if ( field.offset >= end )
+                            break;
+                        auto field_start = start > field.offset ? start - field.offset : 0;
+                        if ( !bits_contain_no_user_data( field.type, field_start,
+                                                         end - field.offset, ctx ) )
+                            return false;
+                    }
+                    return true;
+                }
+
                 std::size_t current = 0;
                 for ( auto field : fields( t, op ) )
                 {
@@ -170,14 +182,13 @@ namespace vast::abi
                                               mlir::Type root, std::size_t root_offset,
                                               const auto &ctx )
         {
-            const auto &[ dl, _ ] = ctx;
+            const auto &dl = std::get< 0 >( ctx );
             //if ( offset != 0 )
             //    VAST_TODO( "int_type_at_offset called with {0}.", offset );
 
             auto is_int_type = [ & ]( std::size_t trg_size )
             {
-                const auto &[ dl_, _ ] = ctx;
-                return is_scalar_integer( t ) && size( dl_, t ) == trg_size;
+                return is_scalar_integer( t ) && size( dl, t ) == trg_size;
             };
 
 
@@ -224,7 +235,14 @@ namespace vast::abi
         static auto field_containing_offset( const auto &ctx, mlir::Type t, std::size_t offset )
             -> std::tuple< mlir::Type, std::size_t >
         {
-            const auto &[ dl, op ] = ctx;
+            const auto &[ dl, op, _ ] = ctx;
+
+            if ( auto layout = layout_of( ctx, t ) )
+            {
+                if ( auto field = layout->field_containing( offset ) )
+                    return { field->type, field->offset };
+                VAST_UNREACHABLE( "Did not find field at offset {0} in {1}", offset,t );
+            }
 
             auto curr = 0;
             for ( auto field : fields( t, op ) )
@@ -242,9 +260,33 @@ namespace vast::abi
             auto mod = func->template getParentOfType< vast_module >();
             return vast::hl::field_types(type, mod);
         }
+
+        static const hl::record_layout *layout_of( const auto &ctx, mlir::Type t )
+        {
+            const auto &layouts = std::get< 2 >( ctx );
+            return layouts ? layouts->lookup( t ) : nullptr;
+        }
     };
 
 
+    // Classification results shared by classifiers of all functions in a module,
+    // e.g. for the duration of the EmitABI pass. They depend only on the type
+    // (fields of records are looked up in the module) and on the target, which is
+    // fixed by the classifier using the cache. Registers needed by an argument
+    // are remembered, so the register accounting of a function does not change.
+    struct classification_cache
+    {
+        struct arg_entry
+        {
+            arg_info info;
+            std::size_t needed_int;
+            std::size_t needed_sse;
+        };
+
+        llvm::DenseMap< mlir::Type, arg_entry > args;
+        llvm::DenseMap< mlir::Type, arg_info > rets;
+    };
+
     // Stateful - one object should be use per one function classification.
     // TODO(abi): For now this serves as x86_64, later core parts will be extracted.
     // TODO(codestyle): See if `arg_` and `ret_` can be unified - in clang they are separately
@@ -261,6 +303,8 @@ namespace vast::abi
 
         func_info info;
         const data_layout &dl;
+        const hl::record_layout_analysis *layouts;
+        classification_cache *cache;
 
         static constexpr std::size_t max_gpr = 6;
         static constexpr std::size_t max_sse = 8;
@@ -269,8 +313,10 @@ namespace vast::abi
         std::size_t needed_sse = 0;
 
         classifier_base( func_info info,
-                         const data_layout &dl )
-            : info( std::move( info ) ), dl( dl )
+                         const data_layout &dl,
+                         const hl::record_layout_analysis *layouts = nullptr,
+                         classification_cache *cache = nullptr )
+            : info( std::move( info ) ), dl( dl ), layouts( layouts ), cache( cache )
         {}
 
         auto size( mlir::Type t )
@@ -395,17 +441,33 @@ namespace vast::abi
         }
 
         // TODO(abi): Refactor.
-        auto mk_ctx() const { return std::make_tuple( dl, info.raw_fn ); }
+        auto mk_ctx() const { return std::make_tuple( dl, info.raw_fn, layouts ); }
 
         classification_t get_aggregate_class( mlir::Type t, std::size_t &offset )
         {
+            auto layout = layouts ? layouts->lookup( t ) : nullptr;
+            if ( layout && layout->has_unaligned_fields )
+                return { Class::Memory, {} };
+
             if ( size( t ) > 8 * 64 || TypeConfig::has_unaligned_field( t ) )
                 return { Class::Memory, {} };
             // TODO(abi): C++ perks.
 
-            auto fields = TypeConfig::fields( t, info.raw_fn );
             classification_t result = { Class::NoClass, Class::NoClass };
 
+            if ( layout )
+            {
+                for ( const auto &field : layout->fields )
+                {
+                    auto field_offset = offset + field.offset;
+                    result = join( result, classify( field.type, field_offset ) );
+                }
+
+                offset += size( t );
+                return post_merge( t, result );
+            }
+
+            auto fields = TypeConfig::fields( t, info.raw_fn );
             auto field_offset = offset;
             for ( auto field_type : fields )
             {
@@ -586,6 +648,19 @@ namespace vast::abi
         }
 
         arg_info classify_return( type t )
+        {
+            if ( !cache )
+                return compute_return_class( t );
+
+            if ( auto it = cache->rets.find( t ); it != cache->rets.end() )
+                return it->second;
+
+            auto out = compute_return_class( t );
+            cache->rets.try_emplace( t, out );
+            return out;
+        }
+
+        arg_info compute_return_class( type t )
         {
             if ( TypeConfig::is_void( t ) )
                 return arg_info::make< ignore >();
@@ -695,6 +770,30 @@ namespace vast::abi
         }
 
         arg_info classify_arg( type t )
+        {
+            if ( !cache )
+                return compute_arg_class( t );
+
+            if ( auto it = cache->args.find( t ); it != cache->args.end() )
+            {
+                needed_int += it->second.needed_int;
+                needed_sse += it->second.needed_sse;
+                return it->second.info;
+            }
+
+            auto int_before = needed_int;
+            auto sse_before = needed_sse;
+
+            auto out = compute_arg_class( t );
+            cache->args.try_emplace(
+                t, classification_cache::arg_entry{
+                    out, needed_int - int_before, needed_sse - sse_before
+                }
+            );
+            return out;
+        }
+
+        arg_info compute_arg_class( type t )
         {
             auto c = classify( t );
             auto low = arg_lo( t, c );
@@ -0,0 +1,256 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/MathExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/ABI/ABI.hpp"
+#include "vast/ABI/Classify.hpp"
+
+namespace vast::abi
+{
+    // Classification of the AAPCS64, the procedure call standard of arm64,
+    // based on `AArch64ABIInfo` of clang:
+    //  * homogeneous aggregates of up to four floats or short vectors (HFA,
+    //    HVA) are passed in SIMD registers, one member per register,
+    //  * other composites of up to 16 bytes are passed in one or two general
+    //    registers,
+    //  * larger composites are passed indirectly.
+    // Unlike on x86_64, the classification of an argument does not depend on
+    // the registers taken by the previous ones.
+    template< typename FnInfo, typename DL >
+    struct aarch64_classifier
+    {
+        using self_t = aarch64_classifier< FnInfo, DL >;
+        using func_info = FnInfo;
+        using data_layout = DL;
+
+        using type = typename func_info::type;
+        using types = typename func_info::types;
+
+        func_info info;
+        const data_layout &dl;
+        const hl::record_layout_analysis *layouts;
+        classification_cache *cache;
+
+        static constexpr std::size_t max_homogeneous_members = 4;
+        // Composites up to two general registers are passed by value.
+        static constexpr std::size_t max_register_size = 128;
+
+        aarch64_classifier( func_info info,
+                            const data_layout &dl,
+                            const hl::record_layout_analysis *layouts = nullptr,
+                            classification_cache *cache = nullptr )
+            : info( std::move( info ) ), dl( dl ), layouts( layouts ), cache( cache )
+        {}
+
+        std::size_t size( type t ) const { return dl.getTypeSizeInBits( t ); }
+
+        const hl::record_layout *layout_of( type t ) const
+        {
+            return layouts ? layouts->lookup( t ) : nullptr;
+        }
+
+        std::vector< type > fields( type t ) const
+        {
+            std::vector< type > out;
+            if ( auto layout = layout_of( t ) )
+            {
+                for ( const auto &field : layout->fields )
+                    out.push_back( field.type );
+                return out;
+            }
+
+            for ( auto field : TypeConfig::fields( t, info.raw_fn ) )
+                out.push_back( field );
+            return out;
+        }
+
+        // In bits.
+        std::size_t align( type t ) const
+        {
+            t = maybe_strip< hl::ElaboratedType >( t );
+            if ( auto layout = layout_of( t ) )
+                return layout->align;
+
+            if ( auto array = t.dyn_cast< hl::ArrayType >() )
+                return align( array.getElementType() );
+
+            if ( TypeConfig::is_record( t ) )
+            {
+                std::size_t out = 8;
+                for ( auto field : fields( t ) )
+                    out = std::max( out, align( field ) );
+                return out;
+            }
+
+            return dl.getTypeABIAlignment( t ) * 8;
+        }
+
+        bool is_homogeneous_base( type t ) const
+        {
+            if ( TypeConfig::is_scalar_float( t ) )
+                return true;
+
+            if ( t.isa< hl::VectorType, mlir::VectorType >() )
+                return size( t ) == 64 || size( t ) == 128;
+
+            return false;
+        }
+
+        // Members of floats or short vectors of the same type, see 6.8.2 of
+        // the AAPCS64. `base` is the type of the members found so far.
+        bool homogeneous_members( type t, type &base, std::size_t &members ) const
+        {
+            t = maybe_strip< hl::ElaboratedType >( t );
+
+            if ( auto array = t.dyn_cast< hl::ArrayType >() )
+            {
+                auto count = array.getSize();
+                if ( !count || *count == 0 )
+                    return false;
+
+                std::size_t element_members = 0;
+                if ( !homogeneous_members( array.getElementType(), base, element_members ) )
+                    return false;
+                members = element_members * *count;
+                return true;
+            }
+
+            if ( TypeConfig::is_record( t ) )
+            {
+                auto layout = layout_of( t );
+                if ( layout && llvm::any_of( layout->fields, [] ( const auto &f ) { return f.bits; } ) )
+                    return false;
+
+                // Fields of a union overlap, the union has as many members as
+                // its largest field.
+                auto is_union = layout && layout->fields.size() > 1
+                    && llvm::all_of( layout->fields, [] ( const auto &f ) { return f.offset == 0; } );
+
+                members = 0;
+                for ( auto field : fields( t ) )
+                {
+                    std::size_t field_members = 0;
+                    if ( !homogeneous_members( field, base, field_members ) )
+                        return false;
+                    members = is_union ? std::max( members, field_members ) : members + field_members;
+                }
+                return members != 0;
+            }
+
+            if ( !is_homogeneous_base( t ) )
+                return false;
+
+            // Vectors of the same size are interchangeable, floats are not.
+            if ( base && base != t )
+            {
+                if ( !TypeConfig::is_scalar_float( t ) && !TypeConfig::is_scalar_float( base ) )
+                    return size( base ) == size( t );
+                return false;
+            }
+
+            base = t;
+            members = 1;
+            return true;
+        }
+
+        std::optional< types > as_homogeneous( type t ) const
+        {
+            type base;
+            std::size_t members = 0;
+            if ( !homogeneous_members( t, base, members ) )
+                return std::nullopt;
+
+            if ( members == 0 || members > max_homogeneous_members )
+                return std::nullopt;
+
+            // The members have to cover the whole aggregate, without padding.
+            if ( members * size( base ) != size( t ) )
+                return std::nullopt;
+
+            return types( members, base );
+        }
+
+        arg_info classify_aggregate( type t, bool is_return )
+        {
+            auto bits = size( t );
+            if ( bits == 0 )
+                return arg_info::make< ignore >();
+
+            if ( auto members = as_homogeneous( t ) )
+                return arg_info::make< direct >( std::move( *members ) );
+
+            if ( bits > max_register_size )
+                return arg_info::make< indirect >( type{} );
+
+            // Small composites are returned in the low bits of `x0`, not
+            // rounded up, as integers are.
+            if ( is_return && bits <= 64 )
+                return arg_info::make< direct >( TypeConfig::iN( t, bits ) );
+
+            bits = llvm::alignTo( bits, 64 );
+            if ( bits == 128 && align( t ) < 128 )
+                return arg_info::make< direct >( types{ TypeConfig::iN( t, 64 ), TypeConfig::iN( t, 64 ) } );
+            return arg_info::make< direct >( TypeConfig::iN( t, bits ) );
+        }
+
+        arg_info classify( type t, bool is_return )
+        {
+            if ( TypeConfig::is_void( t ) )
+                return arg_info::make< ignore >();
+
+            if ( TypeConfig::is_aggregate( t ) )
+                return classify_aggregate( t, is_return );
+
+            if ( TypeConfig::is_scalar_integer( t ) && TypeConfig::can_be_promoted( t ) )
+                return arg_info::make< extend >( t );
+
+            return arg_info::make< direct >( t );
+        }
+
+        arg_info classify_return( type t )
+        {
+            if ( !cache )
+                return classify( t, /* is_return */ true );
+
+            if ( auto it = cache->rets.find( t ); it != cache->rets.end() )
+                return it->second;
+
+            auto out = classify( t, /* is_return */ true );
+            cache->rets.try_emplace( t, out );
+            return out;
+        }
+
+        arg_info classify_arg( type t )
+        {
+            if ( !cache )
+                return classify( t, /* is_return */ false );
+
+            if ( auto it = cache->args.find( t ); it != cache->args.end() )
+                return it->second.info;
+
+            auto out = classify( t, /* is_return */ false );
+            cache->args.try_emplace( t, classification_cache::arg_entry{ out, 0, 0 } );
+            return out;
+        }
+
+        self_t &compute_abi()
+        {
+            info.add_return( classify_return( TypeConfig::prepare( info.return_type() ) ) );
+            for ( auto arg : info.fn_type().getInputs() )
+                info.add_arg( classify_arg( TypeConfig::prepare( arg ) ) );
+            return *this;
+        }
+
+        func_info take()
+        {
+            return std::move( info );
+        }
+    };
+
+} // namespace vast::abi
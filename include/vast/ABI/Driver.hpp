@@ -11,17 +11,35 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
 
 #include "vast/ABI/Classify.hpp"
+#include "vast/ABI/ClassifyAArch64.hpp"
 #include "vast/ABI/ABI.hpp"
 
 namespace vast::abi
 {
-    template< typename FnOp >
-    auto make_x86_64( FnOp fn, const mlir::DataLayout &dl )
+    // `layouts` provides field offsets of aggregates, without them fields are
+    // assumed to be laid out back to back. `cache` shares classification
+    // results between functions. `dl` is `mlir::DataLayout` or, to answer the
+    // builtin types from a table, `hl::builtin_data_layout`.
+    template< typename FnOp, typename DL >
+    auto make_x86_64( FnOp fn, const DL &dl,
+                      const hl::record_layout_analysis *layouts = nullptr,
+                      classification_cache *cache = nullptr )
     {
         using out = func_info< FnOp >;
-        using classifier = classifier_base< out, mlir::DataLayout >;
-        return make< FnOp, classifier >( fn, dl );
+        using classifier = classifier_base< out, DL >;
+        return make< FnOp, classifier >( fn, dl, layouts, cache );
+    }
+
+    template< typename FnOp, typename DL >
+    auto make_aarch64( FnOp fn, const DL &dl,
+                       const hl::record_layout_analysis *layouts = nullptr,
+                       classification_cache *cache = nullptr )
+    {
+        using out = func_info< FnOp >;
+        using classifier = aarch64_classifier< out, DL >;
+        return make< FnOp, classifier >( fn, dl, layouts, cache );
     }
 } // namespace vast::abi
@@ -10,10 +10,12 @@ VAST_RELAX_WARNINGS
 #include <mlir/InitAllDialects.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/CodeGen/DefaultCodeGen.hpp"
 #include "vast/CodeGen/DefaultVisitor.hpp"
 #include "vast/CodeGen/UnsupportedVisitor.hpp"
 #include "vast/CodeGen/UnreachableVisitor.hpp"
 #include "vast/CodeGen/FallBackVisitor.hpp"
+#include "vast/CodeGen/TableDispatchVisitor.hpp"
 
 #include "vast/Dialect/Dialects.hpp"
 #include "vast/CodeGen/DataLayout.hpp"
@@ -22,16 +24,18 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cg
 {
-    template< typename From, typename Symbol >
-    using scoped_symbol_table = llvm::ScopedHashTableScope< From, Symbol >;
+    template< typename From, typename Symbol, typename allocator = llvm::MallocAllocator >
+    using scoped_symbol_table = llvm::ScopedHashTableScope<
+        From, Symbol, llvm::DenseMapInfo< From >, allocator
+    >;
 
     using typedefs_scope   = scoped_symbol_table< const clang::TypedefDecl *, hl::TypeDefOp >;
     using typedecls_scope  = scoped_symbol_table< const clang::TypeDecl *, hl::TypeDeclOp >;
     using enumdecls_scope  = scoped_symbol_table< const clang::EnumDecl *, hl::EnumDeclOp >;
     using enumconsts_scope = scoped_symbol_table< const clang::EnumConstantDecl *, hl::EnumConstantOp >;
-    using lables_scope     = scoped_symbol_table< const clang::LabelDecl*, hl::LabelDeclOp >;
+    using lables_scope     = scoped_symbol_table< const clang::LabelDecl*, hl::LabelDeclOp, scratch_allocator >;
     using functions_scope  = scoped_symbol_table< mangled_name_ref, hl::FuncOp >;
-    using vars_scope       = scoped_symbol_table< const clang::VarDecl *, Value >;
+    using vars_scope       = scoped_symbol_table< const clang::VarDecl *, Value, scratch_allocator >;
 
     struct scope_t {
         typedefs_scope   typedefs;
@@ -44,7 +48,7 @@ namespace vast::cg
     };
 
     template< typename derived_t >
-    using default_visitor_stack = fallback_visitor< derived_t,
+    using default_visitor_stack = table_dispatch_visitor< derived_t,
         default_visitor, unsup_visitor, unreach_visitor
     >;
 
@@ -64,7 +68,7 @@ namespace vast::cg
         {
             mlir::registerAllDialects(cgctx.mctx);
             vast::registerAllDialects(cgctx.mctx);
-            cgctx.mctx.loadAllAvailableDialects();
+            vast::load_vast_dialects(cgctx.mctx);
 
             scope = std::unique_ptr< scope_t >( new scope_t{
                 .typedefs   = cgctx.typedefs,
@@ -84,6 +88,8 @@ namespace vast::cg
             hl::emit_data_layout(mcontext(), this->ctx.mod, this->ctx.data_layout());
         }
 
+        // Functions are isolated from above, mlir verifies them in parallel on
+        // the thread pool of the context.
         bool verify_module() const {
             return mlir::verify(this->ctx.mod.get()).succeeded();
         }
@@ -250,8 +256,11 @@ namespace vast::cg
 
             // TODO: prologuecleanupdepth
 
-            if (lang.OpenMP && decl) {
-                VAST_UNIMPLEMENTED;
+            // The OpenMP prologue allocates parameters of `omp allocate`.
+            if (lang.OpenMP && function_decl) {
+                for (const auto *param : function_decl->parameters()) {
+                    VAST_UNIMPLEMENTED_IF(param->hasAttr< clang::OMPAllocateDeclAttr >());
+                }
             }
 
             // TODO: build_function_prolog
@@ -396,8 +405,14 @@ namespace vast::cg
                 }
             }
 
+            // Bookkeeping of the body is released at once after it, the arena
+            // outlives the scopes of the body.
+            function_arena::scope scratch(this->ctx.scratch);
+
             // Create a scope in the symbol table to hold variable declarations.
             llvm::ScopedHashTableScope var_scope(this->ctx.vars);
+            // Labels are function scoped.
+            llvm::ScopedHashTableScope label_scope(this->ctx.labels);
             {
                 auto body = function_decl->getBody();
                 auto begin_loc = meta_location(body);
@@ -488,6 +503,24 @@ namespace vast::cg
         std::unique_ptr< scope_t > scope;
     };
 
-    using default_codegen = codegen_instance< default_visitor_stack >;
+    //
+    // The templates of the default code generator are instantiated once, in
+    // CodeGen.cpp, instead of in every translation unit that uses it.
+    //
+    using default_visitor_instance = visitor_instance< default_visitor_stack >;
+
+    extern template struct fallback_visitor<
+        default_visitor_instance, default_visitor, unsup_visitor, unreach_visitor
+    >;
+    extern template struct table_dispatch_visitor<
+        default_visitor_instance, default_visitor, unsup_visitor, unreach_visitor
+    >;
+    extern template struct visitor_instance< default_visitor_stack >;
+    extern template struct codegen_instance< default_visitor_stack >;
+
+    struct default_codegen final : codegen_instance< default_visitor_stack >
+    {
+        using codegen_instance::codegen_instance;
+    };
 
 } // namespace vast::cg
@@ -83,6 +83,38 @@ namespace vast::cg {
             return make< hl::NoThrowAttr >();
         }
 
+        mlir_attr VisitAlwaysInlineAttr(const clang::AlwaysInlineAttr *attr) {
+            return make< hl::AlwaysInlineAttr >();
+        }
+
+        mlir_attr VisitNoInlineAttr(const clang::NoInlineAttr *attr) {
+            return make< hl::NoInlineAttr >();
+        }
+
+        mlir_attr VisitFlattenAttr(const clang::FlattenAttr *attr) {
+            return make< hl::FlattenAttr >();
+        }
+
+        mlir_attr VisitHotAttr(const clang::HotAttr *attr) {
+            return make< hl::HotAttr >();
+        }
+
+        mlir_attr VisitColdAttr(const clang::ColdAttr *attr) {
+            return make< hl::ColdAttr >();
+        }
+
+        mlir_attr VisitNoReturnAttr(const clang::NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
+        }
+
+        mlir_attr VisitC11NoReturnAttr(const clang::C11NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
+        }
+
+        mlir_attr VisitCXX11NoReturnAttr(const clang::CXX11NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
+        }
+
         mlir_attr VisitNonNullAttr(const clang::NonNullAttr *attr) {
             return make< hl::NonNullAttr >();
         }
@@ -10,6 +10,8 @@ VAST_RELAX_WARNINGS
 #include <clang/Basic/SourceManager.h>
 #include <llvm/ADT/ScopedHashTable.h>
 #include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/StringSaver.h>
 #include <llvm/IR/GlobalValue.h>
 #include <mlir/IR/MLIRContext.h>
 #include <mlir/IR/Value.h>
@@ -74,6 +76,30 @@ namespace vast::cg
         }
     } // namespace detail
 
+    // Conversion of some types has side effects that depend on the point of
+    // the conversion, e.g., `typeof` types emit operations and forward declared
+    // tags have no data layout yet. Such types must be always converted anew.
+    bool is_cacheable_type(clang::QualType type);
+
+    //
+    // Memoizes conversion of clang types to mlir types. It is keyed by the
+    // sugared type with its local qualifiers.
+    //
+    struct type_cache {
+        mlir_type lookup(clang::QualType type) const { return types.lookup(type); }
+
+        void insert(clang::QualType type, mlir_type converted) {
+            if (converted && is_cacheable_type(type)) {
+                types.try_emplace(type, converted);
+            }
+        }
+
+      private:
+        llvm::DenseMap< clang::QualType, mlir_type > types;
+    };
+
+    struct header_cache;
+
     struct codegen_context {
         mcontext_t &mctx;
         acontext_t &actx;
@@ -98,8 +124,11 @@ namespace vast::cg
         // It owns the strings that mangled_name_ref uses
         CodeGenMangler mangler;
 
-        using var_table = scoped_table< const clang::VarDecl *, Value >;
-        var_table vars;
+        // Scratch memory of the function-local tables, see `function_arena`.
+        function_arena scratch;
+
+        using var_table = scoped_table< const clang::VarDecl *, Value, scratch_allocator >;
+        var_table vars{ scratch_allocator(scratch) };
 
         using TypeDefTable = scoped_table< const clang::TypedefDecl *, hl::TypeDefOp >;
         TypeDefTable typedefs;
@@ -116,11 +145,40 @@ namespace vast::cg
         using EnumConstants = scoped_table< const clang::EnumConstantDecl *, hl::EnumConstantOp >;
         EnumConstants enumconsts;
 
-        using LabelTable = scoped_table< const clang::LabelDecl*, hl::LabelDeclOp >;
-        LabelTable labels;
+        using LabelTable = scoped_table< const clang::LabelDecl*, hl::LabelDeclOp, scratch_allocator >;
+        LabelTable labels{ scratch_allocator(scratch) };
+
+        type_cache converted_types;
+
+        // Declarations of AST files, i.e., of precompiled headers and modules,
+        // are not handed to the consumer. They are emitted at the start of the
+        // module on their first use, e.g., of their type.
+        llvm::DenseSet< const clang::Decl * > imported_decls;
+
+        // Records of AST files by their declaration, a record may be reached
+        // by its definition, by the types of its fields or through typedefs.
+        llvm::DenseMap< const clang::Decl *, operation > imported_records;
+
+        // Global variables of AST files. Their declarations are emitted in the
+        // scope of the first user and have to be redeclared in later ones.
+        llvm::DenseMap< const clang::VarDecl *, mlir_value > imported_vars;
+
+        bool is_imported(const clang::Decl *decl) const {
+            return decl->isFromASTFile();
+        }
+
+        // Operations of imported declarations reused from other compilations,
+        // null without `-vast-hl-header-cache`.
+        header_cache *headers = nullptr;
 
         size_t anonymous_count = 0;
-        llvm::DenseMap< const clang::NamedDecl *, std::string > tag_names;
+
+        // Namespaced names of declarations and the prefixes of their contexts
+        // are interned, so that each context is named once.
+        llvm::BumpPtrAllocator name_arena;
+        llvm::StringSaver name_saver{ name_arena };
+        llvm::DenseMap< const clang::NamedDecl *, string_ref > tag_names;
+        llvm::DenseMap< const clang::DeclContext *, string_ref > context_prefixes;
 
         /// Set of global decls for which we already diagnosed mangled name conflict.
         /// Required to not issue a warning (on a mangling conflict) multiple times
@@ -172,10 +230,36 @@ namespace vast::cg
             default_methods_to_emit.emplace_back(decl);
         }
 
+        // Symbols of the module body by name. It is kept up to date as the
+        // symbols are emitted, `mlir::SymbolTable::lookupSymbolIn` would scan
+        // the whole module on each lookup.
+        llvm::DenseMap< string_ref, operation > global_symbols;
+
+        void add_global_symbol(operation op) {
+            if (op->getParentOp() != mod->getOperation()) {
+                return;
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName())) {
+                // The first symbol of a name wins, as in a module lookup.
+                global_symbols.try_emplace(name.getValue(), op);
+            }
+        }
+
+        void replace_global_symbol(string_ref name, operation op) {
+            if (op) {
+                global_symbols[name] = op;
+            } else {
+                global_symbols.erase(name);
+            }
+        }
+
+        operation get_global_value(string_ref name) {
+            return global_symbols.lookup(name);
+        }
+
         operation get_global_value(mangled_name_ref name) {
-            if (auto global = mlir::SymbolTable::lookupSymbolIn(mod.get(), name.name))
-                return global;
-            return {};
+            return get_global_value(name.name);
         }
 
         mlir_value get_global_value(const clang::Decl * /* decl */) {
@@ -188,48 +272,42 @@ namespace vast::cg
             return "anonymous[" + std::to_string(decl->getID()) + "]";
         }
 
-        std::string get_namespaced_for_decl_name(const clang::NamedDecl *decl) {
-            // gather contexts
-            std::vector< const clang::DeclContext * > dctxs;
-            for (const auto *dctx = decl->getDeclContext(); dctx; dctx = dctx->getParent()) {
-                dctxs.push_back(dctx);
+        // Prefix `a::b::` of names declared in `dctx`, functions and linkage
+        // specifications are not a part of it.
+        string_ref namespace_prefix(const clang::DeclContext *dctx) {
+            if (!dctx) {
+                return {};
             }
 
-            std::string name;
-            for (const auto *dctx : llvm::reverse(dctxs)) {
-                if (llvm::isa< clang::TranslationUnitDecl >(dctx))
-                    continue;
-
-                if (llvm::isa< clang::FunctionDecl >(dctx))
-                    continue;
-
-                if (llvm::isa< clang::LinkageSpecDecl >(dctx))
-                    continue;
-
-                if (const auto *d = llvm::dyn_cast< clang::NamedDecl >(dctx)) {
-                    name += get_decl_name(d);
-                } else {
-                    VAST_UNREACHABLE("unknown decl context: {0}", dctx->getDeclKindName());
-                }
-
-                name += "::";
+            if (auto it = context_prefixes.find(dctx); it != context_prefixes.end()) {
+                return it->second;
             }
 
-            return name;
-        }
+            auto prefix = namespace_prefix(dctx->getParent());
+            if (!llvm::isa< clang::TranslationUnitDecl, clang::FunctionDecl, clang::LinkageSpecDecl >(dctx)) {
+                const auto *d = llvm::dyn_cast< clang::NamedDecl >(dctx);
+                VAST_CHECK(d, "unknown decl context: {0}", dctx->getDeclKindName());
+                prefix = name_saver.save(llvm::Twine(prefix) + get_decl_name(d) + "::");
+            }
 
-        std::string get_namespaced_decl_name(const clang::NamedDecl *decl) {
-            return get_namespaced_for_decl_name(decl) + get_decl_name(decl);
+            context_prefixes.try_emplace(dctx, prefix);
+            return prefix;
         }
 
-        llvm::StringRef decl_name(const clang::NamedDecl *decl) {
-            if (tag_names.count(decl)) {
-                return tag_names[decl];
+        string_ref decl_name(const clang::NamedDecl *decl) {
+            if (auto it = tag_names.find(decl); it != tag_names.end()) {
+                return it->second;
             }
 
-            auto name = get_namespaced_decl_name(decl);
-            auto [it, _] = tag_names.try_emplace(decl, name);
-            return it->second;
+            auto prefix = namespace_prefix(decl->getDeclContext());
+
+            // Identifiers outlive the context, a global name needs no copy.
+            string_ref name = prefix.empty() && decl->getIdentifier()
+                ? decl->getName()
+                : name_saver.save(llvm::Twine(prefix) + get_decl_name(decl));
+
+            tag_names.try_emplace(decl, name);
+            return name;
         }
 
         const dl::DataLayoutBlueprint &data_layout() const { return dl; }
@@ -253,7 +331,11 @@ namespace vast::cg
         }
 
         hl::FuncOp declare(mangled_name_ref mangled, auto vast_decl_builder) {
-            return declare< hl::FuncOp >(funcdecls, mangled, vast_decl_builder, mangled.name);
+            return declare< hl::FuncOp >(funcdecls, mangled, [&] {
+                auto fn = vast_decl_builder();
+                add_global_symbol(fn);
+                return fn;
+            }, mangled.name);
         }
 
         mlir_value declare(const clang::VarDecl *decl, mlir_value vast_value) {
@@ -10,6 +10,7 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/Attr.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Frontend/FrontendDiagnostic.h>
+#include <mlir/IR/BuiltinAttributes.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/CodeGenMeta.hpp"
@@ -17,12 +18,16 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenVisitorBase.hpp"
 #include "vast/CodeGen/CodeGenVisitorLens.hpp"
 #include "vast/CodeGen/CodeGenFunction.hpp"
+#include "vast/CodeGen/HeaderCache.hpp"
 #include "vast/CodeGen/Mangler.hpp"
 #include "vast/CodeGen/Util.hpp"
 
 #include "vast/Util/Scopes.hpp"
 
 #include "vast/Dialect/Core/Linkage.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+
+#include <numeric>
 
 namespace vast::cg {
 
@@ -61,6 +66,12 @@ namespace vast::cg {
               clang::WeakAttr
             , clang::SelectAnyAttr
             , clang::CUDAGlobalAttr
+            // Kept as `hl.alignment` of the declaration, see `visit_alignment`.
+            , clang::AlignedAttr
+            // Kept as `hl.tls_model` of the declaration.
+            , clang::TLSModelAttr
+            // Kept as `hl.visibility` of the declaration.
+            , clang::VisibilityAttr
         >;
 
         template< typename op_t, typename... args_t >
@@ -68,6 +79,24 @@ namespace vast::cg {
             return mlir_builder().template create< op_t >(std::forward< args_t >(args)...);
         }
 
+        // An operation of a declaration of an AST file is reused from the
+        // header cache if it has one, and stored in it otherwise.
+        template< typename op_t >
+        op_t make_header_decl(const clang::Decl *decl, string_ref name, auto make_op) {
+            auto headers = context().headers;
+            if (!headers || !context().is_imported(decl)) {
+                return make_op();
+            }
+
+            if (auto op = headers->reuse(op_t::getOperationName(), name)) {
+                return mlir::cast< op_t >(op);
+            }
+
+            op_t op = make_op();
+            headers->record(op);
+            return op;
+        }
+
         auto visit_decl_attrs(const clang::Decl *decl, operation op) {
             // getAttrs on decl without attrs triggers an assertion in clang
             if (decl->hasAttrs()) {
@@ -78,7 +107,7 @@ namespace vast::cg {
                     auto spelling = attr->getSpelling();
                     // Bultin attr doesn't have spelling because it can not be written in code
                     if (auto builtin = clang::dyn_cast< clang::BuiltinAttr >(attr)) {
-                        spelling = "builtin";
+                        spelling = hl::BuiltinAttr::attr_name().data();
                     }
 
                     if (auto prev = attrs.getNamed(spelling)) {
@@ -91,6 +120,31 @@ namespace vast::cg {
             }
         }
 
+        // Annotations of parameters that describe the pointed-to object are kept
+        // as argument attributes, so that they can be lowered to the ones of llvm.
+        void visit_param_attrs(const clang::FunctionDecl *decl, vast_function fn) {
+            auto all_nonnull = decl->getAttr< clang::NonNullAttr >();
+            auto params = decl->parameters();
+            auto size   = std::min< std::size_t >(params.size(), fn.getNumArguments());
+
+            for (unsigned idx = 0; idx < size; ++idx) {
+                const auto *param = params[idx];
+
+                auto nonnull = (all_nonnull && all_nonnull->isNonNull(idx))
+                    || param->hasAttr< clang::NonNullAttr >();
+                if (nonnull && param->getType()->isPointerType()) {
+                    fn.setArgAttr(idx, hl::NonNullAttr::attr_name(), hl::NonNullAttr::get(&mcontext()));
+                }
+
+                if (auto align = param->getAttr< clang::AlignValueAttr >()) {
+                    auto value = align->getAlignment()->EvaluateKnownConstInt(acontext());
+                    fn.setArgAttr(idx, hl::AlignValueAttr::attr_name(),
+                        hl::AlignValueAttr::get(&mcontext(), unsigned(value.getZExtValue()))
+                    );
+                }
+            }
+        }
+
         static bool is_defaulted_method(const clang::FunctionDecl *function_decl)  {
             if (function_decl->isDefaulted() && clang::isa< clang::CXXMethodDecl >(function_decl)) {
                 auto method = clang::cast< clang::CXXMethodDecl >(function_decl);
@@ -117,6 +171,8 @@ namespace vast::cg {
             });
 
             visit_decl_attrs(function_decl, fn);
+            visit_param_attrs(function_decl, fn);
+            visit_symbol_visibility(function_decl, fn, function_decl->isDefined());
 
             VAST_CHECK(fn.isDeclaration(), "expected empty body");
 
@@ -455,7 +511,13 @@ namespace vast::cg {
             fn.setVisibility(core::get_visibility_from_linkage(linkage));
 
             if (fn.empty()) {
-                emit_function_body(fn);
+                auto headers = context().is_imported(decl) ? context().headers : nullptr;
+                if (!headers || !headers->reuse_body(fn)) {
+                    emit_function_body(fn);
+                    if (headers) {
+                        headers->record_body(fn);
+                    }
+                }
             }
 
             return fn;
@@ -499,11 +561,157 @@ namespace vast::cg {
             VAST_UNREACHABLE("unknown storage class");
         }
 
+        // Shape of a (multidimensional) constant array of integers or floats
+        // and its innermost element type.
+        std::optional< std::pair< llvm::SmallVector< std::int64_t >, clang::QualType > >
+        scalar_array_shape(clang::QualType type) {
+            llvm::SmallVector< std::int64_t > shape;
+            while (auto array = acontext().getAsConstantArrayType(type)) {
+                shape.push_back(std::int64_t(array->getSize().getZExtValue()));
+                type = array->getElementType();
+            }
+
+            if (shape.empty()) {
+                return std::nullopt;
+            }
+
+            auto is_supported = [] (clang::QualType element) {
+                if (element->isIntegerType()) {
+                    return !element->isBooleanType();
+                }
+                return element->isSpecificBuiltinType(clang::BuiltinType::Float)
+                    || element->isSpecificBuiltinType(clang::BuiltinType::Double);
+            };
+
+            if (!is_supported(type)) {
+                return std::nullopt;
+            }
+
+            return std::make_pair(std::move(shape), type);
+        }
+
+        // Flattens the evaluated initializer, elements not covered by the
+        // initializer take the value of the array filler.
+        bool flatten_constant(const clang::APValue &value, clang::QualType type,
+                              llvm::SmallVectorImpl< llvm::APInt > &out
+        ) {
+            if (auto array = acontext().getAsConstantArrayType(type)) {
+                if (!value.isArray()) {
+                    return false;
+                }
+
+                auto size = array->getSize().getZExtValue();
+                for (unsigned i = 0; i < size; ++i) {
+                    if (i < value.getArrayInitializedElts()) {
+                        if (!flatten_constant(value.getArrayInitializedElt(i), array->getElementType(), out))
+                            return false;
+                    } else if (!value.hasArrayFiller()
+                        || !flatten_constant(value.getArrayFiller(), array->getElementType(), out)
+                    ) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            auto width = unsigned(acontext().getTypeSize(type));
+            if (value.isInt()) {
+                out.push_back(value.getInt().extOrTrunc(width));
+                return true;
+            }
+
+            if (value.isFloat()) {
+                out.push_back(value.getFloat().bitcastToAPInt());
+                return true;
+            }
+
+            return false;
+        }
+
+        // Global and automatic arrays with a constant initializer are folded to
+        // their elements, large tables would otherwise be built by an operation
+        // per element. Small arrays keep the initializer region for readability.
+        mlir::ElementsAttr constant_array_init(const clang::VarDecl *decl) {
+            static constexpr std::int64_t min_folded_elements = 16;
+
+            if (!decl->isFileVarDecl() && !decl->hasLocalStorage()) {
+                return {};
+            }
+
+            if (!decl->hasInit() || decl->getType().isVolatileQualified()) {
+                return {};
+            }
+
+            auto shape_and_type = scalar_array_shape(decl->getType());
+            if (!shape_and_type) {
+                return {};
+            }
+
+            auto &[shape, element] = *shape_and_type;
+            auto count = std::accumulate(shape.begin(), shape.end(), std::int64_t(1), std::multiplies<>());
+            if (count < min_folded_elements) {
+                return {};
+            }
+
+            const auto *value = decl->evaluateValue();
+            if (!value) {
+                return {};
+            }
+
+            llvm::SmallVector< llvm::APInt > elements;
+            if (!flatten_constant(*value, decl->getType(), elements)) {
+                return {};
+            }
+
+            auto width = unsigned(acontext().getTypeSize(element));
+            mlir_type element_type = [&] () -> mlir_type {
+                if (element->isSpecificBuiltinType(clang::BuiltinType::Float))
+                    return mlir::Float32Type::get(&mcontext());
+                if (element->isSpecificBuiltinType(clang::BuiltinType::Double))
+                    return mlir::Float64Type::get(&mcontext());
+                return mlir::IntegerType::get(&mcontext(), width);
+            } ();
+
+            auto tensor = mlir::RankedTensorType::get(shape, element_type);
+            if (mlir::isa< mlir::FloatType >(element_type)) {
+                const auto &semantics = mlir::cast< mlir::FloatType >(element_type).getFloatSemantics();
+                llvm::SmallVector< llvm::APFloat > floats;
+                for (const auto &bits : elements) {
+                    floats.emplace_back(semantics, bits);
+                }
+                return mlir::DenseElementsAttr::get(tensor, floats);
+            }
+
+            return mlir::DenseElementsAttr::get(tensor, elements);
+        }
+
+        void visit_symbol_visibility(const clang::NamedDecl *decl, operation op, bool is_definition) {
+            if (auto visibility = core::get_symbol_visibility(decl, is_definition)) {
+                auto name = *visibility == clang::HiddenVisibility ? "hidden" : "protected";
+                op->setAttr(hl::VisibilityAttr::attr_name(), hl::VisibilityAttr::get(&mcontext(), name));
+            }
+        }
+
+        // Only alignments stated in the source are kept, the natural ones are
+        // given by the data layout.
+        void visit_alignment(const clang::VarDecl *decl, hl::VarDeclOp var) {
+            if (!decl->hasAttr< clang::AlignedAttr >() && !acontext().isAlignmentRequired(decl->getType())) {
+                return;
+            }
+
+            auto align = acontext().getDeclAlign(decl).getQuantity();
+            var->setAttr(hl::AlignmentAttr::attr_name(),
+                hl::AlignmentAttr::get(&mcontext(), static_cast< unsigned >(align))
+            );
+        }
+
         operation VisitVarDecl(const clang::VarDecl *decl) {
+            auto initial_value = constant_array_init(decl);
+
             auto var_decl = context().declare(decl, [&] {
                 auto type = decl->getType();
                 bool has_allocator = type->isVariableArrayType();
-                bool has_init = decl->getInit();
+                bool has_init = decl->getInit() && !initial_value;
                 auto array_allocator = [decl, this](auto &bld, auto loc) {
                     if (auto type = clang::dyn_cast< clang::VariableArrayType >(decl->getType())) {
                         make_value_builder(type->getSizeExpr())(bld, loc);
@@ -527,14 +735,28 @@ namespace vast::cg {
 
                 if (auto tsc = VisitThreadStorageClass(decl); tsc != hl::TSClass::tsc_none) {
                     var.setThreadStorageClass(tsc);
+                    if (auto tls = decl->getAttr< clang::TLSModelAttr >()) {
+                        var->setAttr(hl::TLSModelAttr::attr_name(),
+                            hl::TLSModelAttr::get(&mcontext(), tls->getModel())
+                        );
+                    }
+                }
+
+                visit_alignment(decl, var);
+
+                if (decl->isFileVarDecl()) {
+                    auto definition = decl->isThisDeclarationADefinition() != clang::VarDecl::DeclarationOnly;
+                    visit_symbol_visibility(decl, var, definition);
                 }
 
                 return var;
             }).getDefiningOp();
 
-            if (decl->hasInit()) {
+            auto declared = mlir::dyn_cast< hl::VarDeclOp >(var_decl);
+            if (initial_value && declared.getInitializer().empty()) {
+                declared.setInitialValueAttr(initial_value);
+            } else if (decl->hasInit()) {
                 auto guard = insertion_guard();
-                auto declared = mlir::dyn_cast< hl::VarDeclOp >(var_decl);
                 set_insertion_point_to_start(&declared.getInitializer());
 
                 auto value_builder = make_value_builder(decl->getInit());
@@ -602,13 +824,13 @@ namespace vast::cg {
                 };
 
                 // create typedef operation
-                auto def = this->template make_operation< hl::TypeDefOp >()
-                    .bind(meta_location(decl)) // location
-                    .bind(decl->getName())     // name
-                    .bind(type())              // type
-                    .freeze();
-
-                return def;
+                return make_header_decl< hl::TypeDefOp >(decl, decl->getName(), [&] {
+                    return this->template make_operation< hl::TypeDefOp >()
+                        .bind(meta_location(decl)) // location
+                        .bind(decl->getName())     // name
+                        .bind(type())              // type
+                        .freeze();
+                });
             });
         }
 
@@ -649,6 +871,7 @@ namespace vast::cg {
                         for (auto con : decl->enumerators()) {
                             visit(con);
                         }
+                        mark_value_range(prev_op, decl);
                         return prev_op;
                     }
                     prev = prev->getPreviousDecl();
@@ -669,15 +892,49 @@ namespace vast::cg {
                     }
                 };
 
-                return this->template make_operation< hl::EnumDeclOp >()
-                    .bind(meta_location(decl))                              // location
-                    .bind(decl->getName())                                  // name
-                    .bind(visit(decl->getIntegerType()))                    // type
-                    .bind(constants)                                        // constants
-                    .freeze();
+                auto make_enum = [&] {
+                    auto op = this->template make_operation< hl::EnumDeclOp >()
+                        .bind(meta_location(decl))                              // location
+                        .bind(decl->getName())                                  // name
+                        .bind(visit(decl->getIntegerType()))                    // type
+                        .bind(constants)                                        // constants
+                        .freeze();
+
+                    mark_value_range(op, decl);
+                    return op;
+                };
+
+                auto op = make_header_decl< hl::EnumDeclOp >(decl, decl->getName(), make_enum);
+
+                // Constants of a reused enum are not visited.
+                auto reused = op.getConstants().front().template getOps< hl::EnumConstantOp >();
+                for (auto [con, con_op] : llvm::zip(decl->enumerators(), reused)) {
+                    context().declare(con, [con_op = con_op] { return con_op; });
+                }
+
+                return op;
             });
         }
 
+        // Objects of a C++ enumeration without a fixed underlying type hold
+        // only the values of the smallest bit-field that fits all enumerators.
+        void mark_value_range(hl::EnumDeclOp op, const clang::EnumDecl *decl) {
+            if (!acontext().getLangOpts().CPlusPlus || decl->isFixed()) {
+                return;
+            }
+
+            llvm::APInt max, min;
+            decl->getValueRange(max, min);
+            if (max == min || max.getBitWidth() > 64) {
+                return;
+            }
+
+            auto range = hl::ValueRangeAttr::get(
+                op.getContext(), min.getSExtValue(), max.getSExtValue()
+            );
+            op->setAttr(hl::ValueRangeAttr::attr_name(), range);
+        }
+
         operation VisitEnumConstantDecl(const clang::EnumConstantDecl *decl) {
             return context().declare(decl, [&] {
                 auto initializer = make_value_builder(decl->getInitExpr());
@@ -719,13 +976,34 @@ namespace vast::cg {
             // declare the type first to allow recursive type definitions
             if (!decl->isCompleteDefinition()) {
                 return context().declare(decl, [&] {
-                    return this->template make_operation< hl::TypeDeclOp >()
-                        .bind(meta_location(decl)) // location
-                        .bind(decl->getName())     // name
-                        .freeze();
+                    return make_header_decl< hl::TypeDeclOp >(decl, decl->getName(), [&] {
+                        return this->template make_operation< hl::TypeDeclOp >()
+                            .bind(meta_location(decl)) // location
+                            .bind(decl->getName())     // name
+                            .freeze();
+                    });
+                });
+            }
+
+            // A record of an AST file is emitted once, however it is reached.
+            if (context().is_imported(decl)) {
+                auto [it, inserted] = context().imported_records.try_emplace(decl, nullptr);
+                if (!inserted) {
+                    return it->second;
+                }
+
+                operation op = make_header_decl< Op >(decl, name, [&] {
+                    return make_record< Op >(decl, loc, name);
                 });
+                context().imported_records[decl] = op;
+                return op;
             }
 
+            return make_record< Op >(decl, loc, name);
+        }
+
+        template< typename Op, typename Decl >
+        Op make_record(const Decl *decl, loc_t loc, string_ref name) {
             auto fields = [&](auto &bld, auto loc) {
                 for (auto child: decl->decls()) {
                     if (auto field = clang::dyn_cast< clang::FieldDecl >(child)) {
@@ -7,12 +7,20 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/Decl.h>
 #include <clang/AST/GlobalDecl.h>
+#include <llvm/ADT/StringMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
-#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/CodeGen/CodeGenMeta.hpp"
+#include "vast/CodeGen/CodeGenProfile.hpp"
+#include "vast/CodeGen/CodeGenReport.hpp"
+#include "vast/CodeGen/DefaultCodeGen.hpp"
+#include "vast/CodeGen/HeaderCache.hpp"
+
+#include "vast/Frontend/Options.hpp"
 
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DataLayout.hpp"
@@ -37,6 +45,20 @@ namespace vast::cg
 
     meta_generator_ptr make_meta_generator(codegen_context &cgctx, const cc::vast_args &vargs);
 
+    // Returns null unless `-vast-codegen-report[=N]` is present.
+    std::unique_ptr< codegen_report > make_codegen_report(
+        codegen_context &cgctx, const cc::vast_args &vargs
+    );
+
+    // Returns null unless `-fprofile-instr-use` is present or if the profile
+    // cannot be read.
+    std::unique_ptr< codegen_profile > make_codegen_profile(const cc::action_options &opts);
+
+    // Returns null unless `-fprofile-instr-generate` is present.
+    std::unique_ptr< profile_instrumentation > make_profile_instrumentation(
+        codegen_context &cgctx, const cc::action_options &opts
+    );
+
     // This is a layer that provides interface between
     // clang codegen and vast codegen
 
@@ -44,17 +66,9 @@ namespace vast::cg
 
         explicit codegen_driver(
             codegen_context &cgctx, cc::action_options &opts, const cc::vast_args &vargs
-        )
-            : cgctx(cgctx)
-            , opts(opts)
-            , vargs(vargs)
-            , meta(make_meta_generator(cgctx, vargs))
-            , codegen(cgctx, *meta)
-        {}
-
-        ~codegen_driver() {
-            VAST_ASSERT(deferred_inline_member_func_defs.empty());
-        }
+        );
+
+        ~codegen_driver();
 
         codegen_driver(const codegen_driver &) = delete;
         codegen_driver(codegen_driver &&) = delete;
@@ -69,6 +83,17 @@ namespace vast::cg
 
         void finalize();
 
+        // Returns true if some of the already seen declarations still wait for
+        // their emission, i.e., the module is not consistent yet.
+        bool has_pending_emission() const {
+            return !deferred_function_bodies.empty()
+                || !deferred_inline_member_func_defs.empty()
+                || !cgctx.deferred_decls_to_emit.empty();
+        }
+
+        // Per-declaration measurements, null if not requested.
+        codegen_report *report() const { return decl_report.get(); }
+
         const acontext_t &acontext() const { return cgctx.actx; }
         const mcontext_t &mcontext() const { return cgctx.mctx; }
 
@@ -80,12 +105,59 @@ namespace vast::cg
         operation build_global_function_definition(clang::GlobalDecl decl);
         operation build_global_var_definition(const clang::VarDecl *decl, bool tentative = false);
 
-        hl::FuncOp build_function_body(hl::FuncOp fn, clang::GlobalDecl decl);
+        // Without `verify`, the caller verifies the finished body.
+        hl::FuncOp build_function_body(hl::FuncOp fn, clang::GlobalDecl decl, bool verify = true);
+
+        // The header cache, if `decl` comes from a precompiled header.
+        header_cache *headers_of(clang::GlobalDecl decl) const;
 
         hl::FuncOp emit_function_epilogue(hl::FuncOp fn, clang::GlobalDecl decl);
 
         void deal_with_missing_return(hl::FuncOp fn, const clang::FunctionDecl *decl);
 
+        // With `-vast-elide-unsupported` a function body with any `unsup`
+        // operation is replaced by a single `unsup.stmt "elided"`, the
+        // signature is kept. Elided operations are counted by their kind.
+        hl::FuncOp elide_unsupported_body(hl::FuncOp fn);
+
+        // Attaches the weights of `-fprofile-instr-use` and inserts the
+        // counters of `-fprofile-instr-generate` into a finished body.
+        void apply_profile(hl::FuncOp fn, clang::GlobalDecl decl);
+
+        void print_elided_report(llvm::raw_ostream &os) const;
+
+        // With `-vast-verify-threads=N` (N > 1) function definitions are first
+        // emitted as shells and their bodies are built only after all top-level
+        // declarations of the translation unit are known.
+        bool defer_function_bodies() const { return verify_threads > 1; }
+
+        // Builds queued function bodies in the order their shells were created.
+        // The bodies are built on the calling thread, as the visitors memoize
+        // into unsynchronized caches of the ASTContext, only their
+        // verification runs on a pool of `verify_threads` workers.
+        void build_deferred_function_bodies();
+
+        static unsigned parse_verify_threads(const cc::vast_args &vargs);
+
+        // With `-vast-emit-decls-only` function definitions are emitted as
+        // declarations, i.e., their bodies are never built.
+        bool emit_decls_only() const { return decls_only; }
+
+        bool lazy_function_bodies() const { return lazy_bodies; }
+
+        // With `-vast-lazy-function-bodies` function definitions are emitted as
+        // body-less stubs that remember their clang declaration. A body is built
+        // only on the first request, together with the declarations it needs.
+        // The clang AST has to outlive the driver for this to work.
+        hl::FuncOp materialize(hl::FuncOp fn);
+
+        // With `-vast-emit-reachable-from=<names>` only the named declarations
+        // and the declarations they transitively refer to are emitted. Bodies
+        // are built lazily, starting from the roots, and the rest is removed.
+        void emit_reachable();
+
+        static std::vector< std::string > parse_reachable_roots(const cc::vast_args &vargs);
+
         // Emit any needed decls for which code generation was deferred.
         void build_deferred();
 
@@ -126,11 +198,42 @@ namespace vast::cg
 
         unsigned deferred_top_level_decls = 0;
 
+        const unsigned verify_threads;
+        const bool decls_only;
+        const std::vector< std::string > reachable_roots;
+        const bool lazy_bodies;
+        const bool elide_unsup;
+
+        // Elided bodies and their unsupported operations by kind, i.e., by
+        // the statement class or the declaration kind.
+        unsigned elided_bodies = 0;
+        llvm::StringMap< unsigned > elided_kinds;
+
+        // Stubs waiting for materialization, keyed by their symbol name.
+        llvm::StringMap< clang::GlobalDecl > lazy_function_decls;
+
+        using deferred_function_body = std::pair< hl::FuncOp, clang::GlobalDecl >;
+        std::vector< deferred_function_body > deferred_function_bodies;
+
         friend struct defer_handle_of_top_level_decl;
         llvm::SmallVector< clang::FunctionDecl *, 8 > deferred_inline_member_func_defs;
 
+        std::unique_ptr< codegen_report > decl_report;
+
+        // Instrumentation profile of `-fprofile-instr-use`, null without one.
+        std::unique_ptr< codegen_profile > profile;
+
+        // Counters of `-fprofile-instr-generate`, null without the option.
+        std::unique_ptr< profile_instrumentation > instrumentation;
+
+        // Cache of `-vast-hl-header-cache`, null without one.
+        std::unique_ptr< header_cache > headers;
+
         meta_generator_ptr meta;
-        default_codegen codegen;
+
+        // Out of line, so that includers of the driver do not instantiate
+        // the code generator.
+        std::unique_ptr< default_codegen > codegen;
     };
 
 } // namespace vast::cg
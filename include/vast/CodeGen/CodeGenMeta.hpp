@@ -9,11 +9,14 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/CXXInheritance.h>
 #include <clang/AST/TypeLoc.h>
 #include <clang/Basic/FileEntry.h>
+#include <clang/Basic/SourceManager.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Meta/MetaAttributes.hpp"
 
 #include <concepts>
+#include <optional>
 
 namespace vast::cg
 {
@@ -26,9 +29,18 @@ namespace vast::cg
 
     using meta_generator_ptr = std::unique_ptr< meta_generator >;
 
+    // Detail of source locations attached to operations. Locations are
+    // uniqued in the mlir context and never freed, coarser locations are
+    // shared by more operations.
+    enum class location_detail { none, line, full };
+
+    std::optional< location_detail > parse_location_detail(string_ref value);
+
     struct default_meta_gen : meta_generator {
-        default_meta_gen(acontext_t *actx, mcontext_t *mctx)
-            : actx(actx), mctx(mctx)
+        default_meta_gen(
+            acontext_t *actx, mcontext_t *mctx, location_detail detail = location_detail::full
+        )
+            : actx(actx), mctx(mctx), detail(detail)
         {}
 
         loc_t location(const clang::Decl *decl) const final {
@@ -45,19 +57,41 @@ namespace vast::cg
 
       private:
 
-        loc_t location(const clang::FullSourceLoc &loc) const {
-            auto file = loc.getFileEntry() ? loc.getFileEntry()->getName() : "unknown";
-            auto line = loc.getLineNumber();
-            auto col  = loc.getColumnNumber();
-            return { mlir::FileLineColLoc::get(mctx, file, line, col) };
+        // Interning of the file name in the mlir context is shared by all
+        // locations from the same file, the presumed names of a file share
+        // the storage of the source manager.
+        mlir::StringAttr file_name(const char *name) const {
+            if (auto it = file_names.find(name); it != file_names.end()) {
+                return it->second;
+            }
+
+            auto attr = mlir::StringAttr::get(mctx, name);
+            file_names.try_emplace(name, attr);
+            return attr;
         }
 
         loc_t location(const clang::SourceLocation &loc) const {
-            return location(clang::FullSourceLoc(loc, actx->getSourceManager()));
+            if (detail == location_detail::none) {
+                return { mlir::UnknownLoc::get(mctx) };
+            }
+
+            // Locations in macros are attributed to the expansion in the file,
+            // and `#line` directives are honored, as in the diagnostics.
+            auto presumed = actx->getSourceManager().getPresumedLoc(loc);
+            if (presumed.isInvalid()) {
+                return { mlir::FileLineColLoc::get(file_name("unknown"), 0, 0) };
+            }
+
+            auto line = presumed.getLine();
+            auto col  = detail == location_detail::full ? presumed.getColumn() : 0;
+            return { mlir::FileLineColLoc::get(file_name(presumed.getFilename()), line, col) };
         }
 
         acontext_t *actx;
         mcontext_t *mctx;
+        location_detail detail;
+
+        mutable llvm::DenseMap< const char *, mlir::StringAttr > file_names;
     };
 
     struct id_meta_gen : meta_generator {
@@ -0,0 +1,100 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <clang/Basic/Diagnostic.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/VirtualFileSystem.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vast::cg
+{
+    struct codegen_context;
+
+    //
+    // codegen_profile
+    //
+    // Counters of an indexed clang instrumentation profile
+    // (`-fprofile-instr-use`). Counters of a function are numbered as clang's
+    // CodeGenPGO numbers them, i.e., the function body first and then the
+    // counted statements in the pre-order of the AST. Branch weights are
+    // derived from the counters the same way clang derives them.
+    //
+    // Records are matched by the PGO name of the function and by the number
+    // of counters, the structural hash of the function body is not recomputed.
+    //
+    struct codegen_profile
+    {
+        using counters = std::vector< std::uint64_t >;
+
+        // Reports an error and returns null if the profile cannot be read.
+        static std::unique_ptr< codegen_profile > load(
+            string_ref path, string_ref main_file,
+            llvm::vfs::FileSystem &fs, clang::DiagnosticsEngine &diags
+        );
+
+        // Attaches the entry count to `fn` and branch weights to its control
+        // flow operations, `fn` has to be the body of `decl` built by codegen.
+        void annotate(hl::FuncOp fn, const clang::FunctionDecl *decl) const;
+
+      private:
+        codegen_profile(std::string main_file, std::uint64_t version)
+            : main_file(std::move(main_file)), version(version)
+        {}
+
+        const counters *lookup(hl::FuncOp fn, std::size_t size) const;
+
+        std::string main_file;
+        std::uint64_t version;
+
+        // Records of functions keyed by their PGO name. There may be more
+        // than one for a name, e.g., for different definitions of a static
+        // function in a file compiled more than once.
+        llvm::StringMap< std::vector< counters > > records;
+    };
+
+    //
+    // profile_instrumentation
+    //
+    // Region counters of `-fprofile-instr-generate`. Counters are numbered as
+    // for `codegen_profile` and incremented by calls of
+    // `llvm.instrprof.increment`, which the backend lowers as it lowers the
+    // counters of clang. The hash of a function is clang's `PGO_HASH_V3` of
+    // its body, so the profiles of programs built by vast can be used by
+    // both vast and clang.
+    //
+    struct profile_instrumentation
+    {
+        profile_instrumentation(codegen_context &cgctx, std::string main_file)
+            : cgctx(cgctx), main_file(std::move(main_file))
+        {}
+
+        // Inserts the counters into `fn`, the body of `decl` built by codegen.
+        // Functions whose operations do not match the counted statements are
+        // left as they are.
+        void instrument(hl::FuncOp fn, const clang::FunctionDecl *decl);
+
+      private:
+        hl::FuncOp increment_decl();
+        hl::VarDeclOp name_var(hl::FuncOp fn);
+
+        codegen_context &cgctx;
+        std::string main_file;
+
+        // Declaration of `llvm.instrprof.increment`.
+        hl::FuncOp increment;
+    };
+
+} // namespace vast::cg
@@ -0,0 +1,93 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <clang/AST/Mangle.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/Builders.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vast::cg
+{
+    //
+    // codegen_report
+    //
+    // Collects wall time, created operations and allocated bytes per top-level
+    // declaration (`-vast-codegen-report[=N]`). Measurements are exclusive, i.e.,
+    // declarations emitted while another one is measured are accounted separately.
+    // Operations are counted as the report listens to insertions of the
+    // code generator's builder, so operations nested in or inserted before
+    // existing ones are accounted too, without walking the module.
+    //
+    struct codegen_report : mlir::OpBuilder::Listener
+    {
+        using clock = std::chrono::steady_clock;
+
+        struct entry {
+            std::string name;
+            std::string location;
+            clock::duration time = {};
+            std::int64_t ops = 0;
+            std::int64_t bytes = 0;
+        };
+
+        struct scope {
+            scope(codegen_report *report, const clang::Decl *decl);
+            ~scope();
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+          private:
+            friend struct codegen_report;
+
+            struct sample {
+                clock::time_point time;
+                std::int64_t ops;
+                std::int64_t bytes;
+            };
+
+            void pause();
+            void resume();
+
+            codegen_report *report;
+            scope *parent = nullptr;
+            entry measured;
+            sample start;
+        };
+
+        codegen_report(acontext_t &actx, std::size_t limit);
+
+        void notifyOperationInserted(operation) override { ++inserted; }
+
+        // Prints top `limit` declarations sorted by time.
+        void print(llvm::raw_ostream &os) const;
+
+      private:
+        scope::sample take_sample() const;
+
+        std::string name(const clang::Decl *decl) const;
+
+        acontext_t &actx;
+        std::size_t limit;
+
+        std::int64_t inserted = 0;
+
+        std::unique_ptr< clang::MangleContext > mangle_context;
+
+        scope *active = nullptr;
+        std::vector< entry > entries;
+    };
+
+} // namespace vast::cg
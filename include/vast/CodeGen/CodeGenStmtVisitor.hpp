@@ -5,8 +5,13 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <clang/AST/Attr.h>
 #include <clang/AST/StmtVisitor.h>
+#include <clang/AST/StmtOpenMP.h>
 #include <clang/AST/OperationKinds.h>
+#include <clang/Basic/Builtins.h>
+
+#include <mlir/Dialect/OpenMP/OpenMPDialect.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/CodeGenMeta.hpp"
@@ -14,17 +19,59 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenVisitorBase.hpp"
 #include "vast/CodeGen/CodeGenVisitorLens.hpp"
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/Core/CoreOps.hpp"
 
 #include "vast/Util/Common.hpp"
+#include "vast/Util/TypeList.hpp"
 
 namespace vast::hl {
 
     CastKind cast_kind(const clang::CastExpr *expr);
     IdentKind ident_kind(const clang::PredefinedExpr *expr);
 
+    // Whether `cond` is expected to hold, taken from `__builtin_expect` in the
+    // condition or, if there is none, from the likelihood attributes of the
+    // guarded statements.
+    std::optional< bool > expected_condition(
+        const clang::ASTContext &actx, const clang::Expr *cond, clang::Stmt::Likelihood lh
+    );
+
+    // Fast-math flags of the floating-point options in effect for `expr`,
+    // e.g., of `-ffast-math` or `#pragma clang fp`, null if there are none.
+    FastMathAttr fast_math(
+        mcontext_t &mctx, const clang::ASTContext &actx, const clang::BinaryOperator *expr
+    );
+
+    // Whether multiplications may be contracted with additions of `expr`,
+    // within the expression only, i.e., `-ffp-contract=on`.
+    bool contracts_within_expression(
+        const clang::ASTContext &actx, const clang::BinaryOperator *expr
+    );
+
+    // Collects loop pragmas of an attributed statement, returns null if there
+    // are none.
+    LoopHintsAttr loop_hints(
+        mcontext_t &mctx, const clang::ASTContext &actx,
+        llvm::ArrayRef< const clang::Attr * > attrs
+    );
+
+    // Schedule of the loop of a worksharing directive.
+    WorksharingAttr worksharing(
+        mcontext_t &mctx, const clang::ASTContext &actx, const clang::OMPLoopDirective *dir
+    );
+
+    // Memory order of an atomic operation, orders that are not constant are
+    // strengthened to `seq_cst`.
+    MemoryOrder memory_order(const clang::ASTContext &actx, const clang::Expr *order);
+
+    // Operator of the read-modify-write atomic builtins, none for the other
+    // atomic operations.
+    std::optional< RMWKind > rmw_kind(const clang::AtomicExpr *expr);
+
 } // namespace vast::hl
 
 
@@ -40,6 +87,7 @@ namespace vast::cg {
         using lens::derived;
         using lens::context;
         using lens::mcontext;
+        using lens::acontext;
 
         using lens::visit;
         using lens::visit_as_lvalue_type;
@@ -65,6 +113,18 @@ namespace vast::cg {
             return derived().template create< Op >(std::forward< Args >(args)...);
         }
 
+        template< typename Op >
+        Op with_likelihood(Op op, const clang::Expr *cond, clang::Stmt::Likelihood lh) {
+            if (auto likely = hl::expected_condition(acontext(), cond, lh)) {
+                op->setAttr(
+                    hl::BranchLikelihoodAttr::attr_name(),
+                    hl::BranchLikelihoodAttr::get(&mcontext(), *likely)
+                );
+            }
+
+            return op;
+        }
+
         operation VisitCompoundStmt(const clang::CompoundStmt *stmt) {
             return derived().template make_scoped< CoreScope >(meta_location(stmt), [&] {
                 for (auto s : stmt->body()) {
@@ -73,6 +133,50 @@ namespace vast::cg {
             });
         }
 
+        // Arithmetic on vectors is lane-wise, it is chosen by the element type.
+        static clang::QualType scalar_type(clang::QualType ty) {
+            if (auto vec = ty->getAs< clang::VectorType >()) {
+                return vec->getElementType();
+            }
+            return ty;
+        }
+
+        template< typename Op >
+        static constexpr bool is_floating_arithmetic = util::type_list<
+            hl::AddFOp, hl::SubFOp, hl::MulFOp, hl::DivFOp, hl::RemFOp, hl::FCmpOp,
+            hl::AddFAssignOp, hl::SubFAssignOp, hl::MulFAssignOp, hl::DivFAssignOp,
+            hl::RemFAssignOp
+        >::template contains< Op >;
+
+        // Additions whose operand may be fused with its multiplication.
+        template< typename Op >
+        static constexpr bool is_floating_addition = util::type_list<
+            hl::AddFOp, hl::SubFOp, hl::AddFAssignOp, hl::SubFAssignOp
+        >::template contains< Op >;
+
+        // Floating-point options of the expression, `rhs` and `lhs` are the
+        // operands as emitted.
+        template< typename Op >
+        Op with_fp_options(Op op, const clang::BinaryOperator *expr, mlir_value lhs, mlir_value rhs) {
+            if constexpr (is_floating_arithmetic< Op >) {
+                if (auto flags = hl::fast_math(mcontext(), acontext(), expr)) {
+                    op->setAttr(hl::FastMathAttr::attr_name(), flags);
+                }
+            }
+
+            if constexpr (is_floating_addition< Op >) {
+                auto product = [] (mlir_value value) {
+                    return value && value.getDefiningOp< hl::MulFOp >();
+                };
+
+                if ((product(lhs) || product(rhs)) && hl::contracts_within_expression(acontext(), expr)) {
+                    op->setAttr(hl::FPContractAttr::attr_name(), hl::FPContractAttr::get(&mcontext()));
+                }
+            }
+
+            return op;
+        }
+
         //
         // Binary Operations
         //
@@ -82,12 +186,12 @@ namespace vast::cg {
             auto lhs = visit(op->getLHS())->getResult(0);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto type = visit(op->getType());
-            return make< Op >(meta_location(op), type, lhs, rhs);
+            return with_fp_options(make< Op >(meta_location(op), type, lhs, rhs), op, lhs, rhs);
         }
 
         template< typename UOp, typename SOp >
         Operation* VisitIBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -97,7 +201,7 @@ namespace vast::cg {
 
         template< typename IOp, typename FOp >
         operation VisitIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isIntegerType())
                 return VisitBinOp< IOp >(op);
             // FIXME: eventually decouple arithmetic and pointer additions?
@@ -110,7 +214,7 @@ namespace vast::cg {
 
         template< typename UOp, typename SOp, typename FOp >
         operation VisitIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -133,12 +237,14 @@ namespace vast::cg {
             auto lhs = visit(op->getLHS())->getResult(0);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto res = visit(op->getType());
-            return make< hl::FCmpOp >(meta_location(op), res, pred, lhs, rhs);
+            return with_fp_options(
+                make< hl::FCmpOp >(meta_location(op), res, pred, lhs, rhs), op, lhs, rhs
+            );
         }
 
         template< hl::Predicate upred, hl::Predicate spred, hl::FPredicate fpred >
         operation VisitCmp(const clang::BinaryOperator *op) {
-            auto ty = op->getLHS()->getType();
+            auto ty = scalar_type(op->getLHS()->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitCmp< upred >(op);
             if (ty->isPointerType())
@@ -240,12 +346,13 @@ namespace vast::cg {
         operation VisitAssignBinOp(const clang::BinaryOperator *op) {
             auto lhs = visit(op->getLHS())->getResult(0);
             auto rhs = visit(op->getRHS())->getResult(0);
-            return make< Op >(meta_location(op), lhs, rhs);
+            // The destination is only an lvalue, it is never a product.
+            return with_fp_options(make< Op >(meta_location(op), lhs, rhs), op, nullptr, rhs);
         }
 
         template< typename UOp, typename SOp >
         operation VisitAssignIBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitAssignBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -255,7 +362,7 @@ namespace vast::cg {
 
         template< typename IOp, typename FOp >
         operation VisitAssignIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isIntegerType())
                 return VisitAssignBinOp< IOp >(op);
             // FIXME: eventually decouple arithmetic and pointer additions?
@@ -268,7 +375,7 @@ namespace vast::cg {
 
         template< typename UOp, typename SOp, typename FOp >
         operation VisitAssignIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = scalar_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitAssignBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -422,7 +529,54 @@ namespace vast::cg {
         // operation VisitCoyieldExpr(const clang::CoyieldExpr *expr)
         // operation VisitDependentCoawaitExpr(const clang::DependentCoawaitExpr *expr)
 
-        // operation VisitAttributedStmt(const clang::AttributedStmt *stmt)
+        operation VisitAttributedStmt(const clang::AttributedStmt *stmt) {
+            auto op = visit(stmt->getSubStmt());
+            if (auto hints = hl::loop_hints(mcontext(), acontext(), stmt->getAttrs())) {
+                if (auto loop = enclosed_loop(op)) {
+                    loop->setAttr(hl::LoopHintsAttr::attr_name(), hints);
+                }
+            }
+
+            if (clang::hasSpecificAttr< clang::MustTailAttr >(stmt->getAttrs())) {
+                if (auto call = returned_call(op)) {
+                    call->setAttr(hl::MustTailAttr::attr_name(), hl::MustTailAttr::get(&mcontext()));
+                }
+            }
+
+            return op;
+        }
+
+        // Call returned by `op`, calls without a result directly precede the return.
+        static operation returned_call(operation op) {
+            auto ret = mlir::dyn_cast_or_null< hl::ReturnOp >(op);
+            if (!ret) {
+                return nullptr;
+            }
+
+            if (ret->getNumOperands() == 0) {
+                return mlir::dyn_cast_or_null< hl::CallOp >(ret->getPrevNode());
+            }
+
+            return ret->getOperand(0).getDefiningOp< hl::CallOp >();
+        }
+
+        // A loop with an init statement is wrapped in a scope.
+        static operation enclosed_loop(operation op) {
+            operation loop = nullptr;
+            if (!op) {
+                return loop;
+            }
+
+            op->walk< mlir::WalkOrder::PreOrder >([&] (operation nested) {
+                if (mlir::isa< hl::ForOp, hl::WhileOp, hl::DoOp >(nested)) {
+                    loop = nested;
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+
+            return loop;
+        }
 
         //
         // Cast Operations
@@ -582,6 +736,13 @@ namespace vast::cg {
 
         operation VisitEnumDeclRefExpr(const clang::DeclRefExpr *expr) {
             auto decl = clang::cast< clang::EnumConstantDecl >(expr->getDecl()->getUnderlyingDecl());
+            if (!context().enumconsts.lookup(decl)) {
+                // Constants of AST files are emitted with their enum, on the
+                // first use of its type.
+                auto parent = clang::cast< clang::EnumDecl >(decl->getDeclContext());
+                visit(acontext().getEnumType(parent));
+            }
+
             if (auto val = context().enumconsts.lookup(decl)) {
                 auto rty = visit(expr->getType());
                 return make< hl::EnumRefOp >(meta_location(expr), rty, val.getName());
@@ -610,8 +771,31 @@ namespace vast::cg {
             return nullptr;
         }
 
+        // Variables of AST files are emitted on their first use, see
+        // `codegen_context::imported_vars`.
+        void import_var_decl(const clang::VarDecl *decl) {
+            if (!context().is_imported(decl)) {
+                return;
+            }
+
+            if (auto var = context().imported_vars.lookup(decl)) {
+                context().declare(decl, var);
+                return;
+            }
+
+            auto guard = insertion_guard();
+            set_insertion_point_to_start(&context().getBodyRegion());
+            if (auto var = visit(decl)) {
+                context().imported_vars[decl] = var->getResult(0);
+            }
+        }
+
         operation VisitFileVarDeclRefExpr(const clang::DeclRefExpr *expr) {
             auto decl = getDeclForVarRef(expr);
+            if (!context().vars.lookup(decl)) {
+                import_var_decl(decl);
+            }
+
             if (!context().vars.lookup(decl)) {
                 // Ref: https://github.com/trailofbits/vast/issues/384
                 // github issue to avoid emitting error if declaration is missing
@@ -731,7 +915,10 @@ namespace vast::cg {
         operation VisitWhileStmt(const clang::WhileStmt *stmt) {
             auto cond_builder = make_cond_builder(stmt->getCond());
             auto body_builder = make_region_builder(stmt->getBody());
-            return make< hl::WhileOp >(meta_location(stmt), cond_builder, body_builder);
+            return with_likelihood(
+                make< hl::WhileOp >(meta_location(stmt), cond_builder, body_builder),
+                stmt->getCond(), clang::Stmt::getLikelihood(stmt->getBody())
+            );
         }
 
         // operation VisitCXXCatchStmt(const clang::CXXCatchStmt *stmt)
@@ -746,9 +933,14 @@ namespace vast::cg {
             auto make_loop_op = [&] {
                 auto incr = make_region_builder(stmt->getInc());
                 auto body = make_region_builder(stmt->getBody());
-                if (auto cond = stmt->getCond())
-                    return make< hl::ForOp >(loc, make_cond_builder(cond), incr, body);
-                return make< hl::ForOp >(loc, make_yield_true(), incr, body);
+                auto lh   = clang::Stmt::getLikelihood(stmt->getBody());
+                if (auto cond = stmt->getCond()) {
+                    auto op = make< hl::ForOp >(loc, make_cond_builder(cond), incr, body);
+                    return with_likelihood(op, cond, lh);
+                }
+                return with_likelihood(
+                    make< hl::ForOp >(loc, make_yield_true(), incr, body), nullptr, lh
+                );
             };
 
             if (stmt->getInit()) {
@@ -765,7 +957,11 @@ namespace vast::cg {
             auto lab = visit(stmt->getLabel())->getResult(0);
             return make< hl::GotoStmt >(meta_location(stmt), lab);
         }
-        // operation VisitIndirectGotoStmt(const clang::IndirectGotoStmt *stmt)
+
+        operation VisitIndirectGotoStmt(const clang::IndirectGotoStmt *stmt) {
+            auto target = visit(stmt->getTarget())->getResult(0);
+            return make< hl::IndirectGotoStmt >(meta_location(stmt), target);
+        }
 
         operation VisitLabelStmt(const clang::LabelStmt *stmt) {
             auto lab = visit(stmt->getDecl())->getResult(0);
@@ -774,12 +970,294 @@ namespace vast::cg {
         }
 
         operation VisitIfStmt(const clang::IfStmt *stmt) {
-            return this->template make_operation< hl::IfOp >()
+            operation op = this->template make_operation< hl::IfOp >()
                 .bind(meta_location(stmt))
                 .bind(make_cond_builder(stmt->getCond()))
                 .bind(make_region_builder(stmt->getThen()))
                 .bind_if(stmt->getElse(), make_region_builder(stmt->getElse()))
                 .freeze();
+
+            auto lh = clang::Stmt::getLikelihood(stmt->getThen(), stmt->getElse());
+            return with_likelihood(op, stmt->getCond(), lh);
+        }
+
+        //
+        // OpenMP Directives
+        //
+        // Directives are emitted to the `omp` dialect directly, except for the
+        // loops of worksharing directives. These stay `hl.for` marked by the
+        // schedule and are converted to `omp.wsloop` when their bounds are
+        // recognized after the types are lowered.
+        //
+        // Data-sharing clauses are emitted as private copies of the variables
+        // that shadow them in the region of the directive. The copies of
+        // reductions are combined to the shared variables in `omp.critical`
+        // at the end of the region.
+        //
+
+        struct omp_reduction
+        {
+            clang::OverloadedOperatorKind kind;
+            const clang::VarDecl *decl;
+            Value shared;
+            Value copy;
+        };
+
+        void check_omp_clauses(
+            const clang::OMPExecutableDirective *dir,
+            std::initializer_list< llvm::omp::Clause > supported
+        ) {
+            for (const auto *clause : dir->clauses()) {
+                auto kind = clause->getClauseKind();
+                if (!llvm::is_contained(supported, kind)) {
+                    VAST_UNIMPLEMENTED_MSG(
+                        "OpenMP clause " + llvm::omp::getOpenMPClauseName(kind).str()
+                    );
+                }
+            }
+        }
+
+        template< typename op_t >
+        op_t make_omp_region(loc_t loc, auto &&content_builder, auto &&...args) {
+            auto op = make< op_t >(loc, std::forward< decltype(args) >(args)...);
+            {
+                auto guard = insertion_guard();
+                set_insertion_point_to_start(&op.getRegion().emplaceBlock());
+                content_builder();
+                make< mlir::omp::TerminatorOp >(loc);
+            }
+            return op;
+        }
+
+        const clang::VarDecl *omp_clause_var(const clang::Expr *expr) {
+            auto ref = clang::dyn_cast< clang::DeclRefExpr >(expr->IgnoreParenImpCasts());
+            if (!ref) {
+                VAST_UNIMPLEMENTED_MSG("OpenMP clause on an expression that is not a variable");
+            }
+            return clang::cast< clang::VarDecl >(ref->getDecl()->getUnderlyingDecl());
+        }
+
+        Value make_omp_load(loc_t loc, Value var) {
+            auto type = mlir::cast< hl::LValueType >(var.getType());
+            auto ref  = make< hl::DeclRefOp >(loc, type, var);
+            return make< hl::ImplicitCastOp >(
+                loc, type.getElementType(), ref, hl::CastKind::LValueToRValue
+            );
+        }
+
+        Value make_omp_copy(const clang::VarDecl *decl, BuilderCallback init = std::nullopt) {
+            auto type = visit_as_lvalue_type(decl->getType());
+            auto copy = make< hl::VarDeclOp >(
+                meta_location(decl), type, context().decl_name(decl), init
+            );
+            context().vars.insert(decl, copy.getResult());
+            return copy.getResult();
+        }
+
+        Value make_omp_firstprivate(const clang::VarDecl *decl) {
+            auto type = decl->getType();
+            if (!type->isScalarType()) {
+                VAST_UNIMPLEMENTED_MSG("OpenMP firstprivate of a non-scalar variable");
+            }
+
+            auto shared = context().vars.lookup(decl);
+            auto lvalue = mlir::cast< hl::LValueType >(shared.getType());
+            return make_omp_copy(decl, [&] (Builder &bld, Location loc) {
+                auto ref   = bld.create< hl::DeclRefOp >(loc, lvalue, shared);
+                auto value = bld.create< hl::ImplicitCastOp >(
+                    loc, lvalue.getElementType(), ref, hl::CastKind::LValueToRValue
+                );
+                bld.create< hl::ValueYieldOp >(loc, value);
+            });
+        }
+
+        // Copies of reductions start from the identity of the operator.
+        omp_reduction make_omp_reduction(
+            const clang::VarDecl *decl, clang::OverloadedOperatorKind kind
+        ) {
+            auto qty = decl->getType();
+            if (!qty->isIntegerType() && !qty->isRealFloatingType()) {
+                VAST_UNIMPLEMENTED_MSG("OpenMP reduction of a non-arithmetic variable");
+            }
+
+            auto type   = visit(qty);
+            auto shared = context().vars.lookup(decl);
+            auto copy   = make_omp_copy(decl, [&] (Builder &bld, Location loc) {
+                auto identity = [&] () -> Value {
+                    if (qty->isRealFloatingType()) {
+                        auto &semantics = acontext().getFloatTypeSemantics(qty);
+                        llvm::APFloat value(semantics, kind == clang::OO_Star ? 1 : 0);
+                        return bld.create< hl::ConstantOp >(loc, type, value);
+                    }
+
+                    auto width = acontext().getIntWidth(qty);
+                    auto value = kind == clang::OO_Star ? llvm::APInt(width, 1)
+                               : kind == clang::OO_Amp  ? llvm::APInt::getAllOnes(width)
+                               : llvm::APInt(width, 0);
+                    return bld.create< hl::ConstantOp >(
+                        loc, type, llvm::APSInt(value, qty->isUnsignedIntegerType())
+                    );
+                } ();
+                bld.create< hl::ValueYieldOp >(loc, identity);
+            });
+
+            return { kind, decl, shared, copy };
+        }
+
+        void make_omp_combiner(loc_t loc, const omp_reduction &red) {
+            auto type     = mlir::cast< hl::LValueType >(red.shared.getType());
+            auto dst      = make< hl::DeclRefOp >(loc, type, red.shared);
+            auto src      = make_omp_load(loc, red.copy);
+            auto floating = red.decl->getType()->isRealFloatingType();
+
+            switch (red.kind) {
+                // The combiner of `-` is an addition, as the copies are partial sums.
+                case clang::OO_Plus:
+                case clang::OO_Minus:
+                    if (floating) {
+                        make< hl::AddFAssignOp >(loc, dst, src);
+                    } else {
+                        make< hl::AddIAssignOp >(loc, dst, src);
+                    }
+                    return;
+                case clang::OO_Star:
+                    if (floating) {
+                        make< hl::MulFAssignOp >(loc, dst, src);
+                    } else {
+                        make< hl::MulIAssignOp >(loc, dst, src);
+                    }
+                    return;
+                case clang::OO_Amp:   make< hl::BinAndAssignOp >(loc, dst, src); return;
+                case clang::OO_Pipe:  make< hl::BinOrAssignOp >(loc, dst, src); return;
+                case clang::OO_Caret: make< hl::BinXorAssignOp >(loc, dst, src); return;
+                default:
+                    VAST_UNREACHABLE("unsupported OpenMP reduction operator");
+            }
+        }
+
+        void emit_omp_data_sharing(const clang::OMPExecutableDirective *dir, auto &&body_builder) {
+            llvm::ScopedHashTableScope scope(context().vars);
+
+            for (const auto *clause : dir->getClausesOfKind< clang::OMPPrivateClause >()) {
+                for (const auto *var : clause->varlists()) {
+                    make_omp_copy(omp_clause_var(var));
+                }
+            }
+
+            for (const auto *clause : dir->getClausesOfKind< clang::OMPFirstprivateClause >()) {
+                for (const auto *var : clause->varlists()) {
+                    make_omp_firstprivate(omp_clause_var(var));
+                }
+            }
+
+            llvm::SmallVector< omp_reduction > reductions;
+            for (const auto *clause : dir->getClausesOfKind< clang::OMPReductionClause >()) {
+                if (clause->getModifier() != clang::OMPC_REDUCTION_unknown) {
+                    VAST_UNIMPLEMENTED_MSG("OpenMP reduction modifiers");
+                }
+
+                auto kind = clause->getNameInfo().getName().getCXXOverloadedOperator();
+                switch (kind) {
+                    case clang::OO_Plus: case clang::OO_Minus: case clang::OO_Star:
+                    case clang::OO_Amp:  case clang::OO_Pipe:  case clang::OO_Caret:
+                        break;
+                    default:
+                        VAST_UNIMPLEMENTED_MSG("OpenMP reduction operator");
+                }
+
+                for (const auto *var : clause->varlists()) {
+                    reductions.push_back(make_omp_reduction(omp_clause_var(var), kind));
+                }
+            }
+
+            body_builder();
+
+            if (!reductions.empty()) {
+                auto loc = meta_location(dir);
+                make_omp_region< mlir::omp::CriticalOp >(loc, [&] {
+                    for (const auto &red : reductions) {
+                        make_omp_combiner(loc, red);
+                    }
+                }, mlir::FlatSymbolRefAttr());
+            }
+        }
+
+        void emit_omp_loop(const clang::OMPLoopDirective *dir) {
+            auto stmt = clang::dyn_cast< clang::ForStmt >(dir->getRawStmt()->IgnoreContainers(true));
+            if (!stmt) {
+                VAST_UNIMPLEMENTED_MSG("OpenMP loop that is not a for statement");
+            }
+
+            // Loop variables are private, clang makes private also those that
+            // are not declared by the loop.
+            if (!clang::isa_and_nonnull< clang::DeclStmt >(stmt->getInit())) {
+                for (const auto *counter : dir->counters()) {
+                    make_omp_copy(omp_clause_var(counter));
+                }
+            }
+
+            operation loop = visit(stmt);
+            auto ws = hl::worksharing(mcontext(), acontext(), dir);
+            loop->walk< mlir::WalkOrder::PreOrder >([&] (hl::ForOp op) {
+                op->setAttr(hl::WorksharingAttr::attr_name(), ws);
+                return mlir::WalkResult::interrupt();
+            });
+        }
+
+        operation VisitOMPParallelDirective(const clang::OMPParallelDirective *dir) {
+            check_omp_clauses(dir, {
+                llvm::omp::OMPC_default, llvm::omp::OMPC_shared, llvm::omp::OMPC_private,
+                llvm::omp::OMPC_firstprivate, llvm::omp::OMPC_reduction
+            });
+
+            return make_omp_region< mlir::omp::ParallelOp >(meta_location(dir), [&] {
+                emit_omp_data_sharing(dir, [&] { visit(dir->getRawStmt()); });
+            });
+        }
+
+        operation VisitOMPParallelForDirective(const clang::OMPParallelForDirective *dir) {
+            check_omp_clauses(dir, {
+                llvm::omp::OMPC_default, llvm::omp::OMPC_shared, llvm::omp::OMPC_private,
+                llvm::omp::OMPC_firstprivate, llvm::omp::OMPC_reduction, llvm::omp::OMPC_schedule
+            });
+
+            return make_omp_region< mlir::omp::ParallelOp >(meta_location(dir), [&] {
+                emit_omp_data_sharing(dir, [&] { emit_omp_loop(dir); });
+            });
+        }
+
+        operation VisitOMPForDirective(const clang::OMPForDirective *dir) {
+            check_omp_clauses(dir, {
+                llvm::omp::OMPC_private, llvm::omp::OMPC_firstprivate,
+                llvm::omp::OMPC_reduction, llvm::omp::OMPC_schedule, llvm::omp::OMPC_nowait
+            });
+
+            auto loc = meta_location(dir);
+            return derived().template make_scoped< CoreScope >(loc, [&] {
+                emit_omp_data_sharing(dir, [&] { emit_omp_loop(dir); });
+
+                // Outside of a combined directive, the team sees the combined
+                // values only after a barrier.
+                auto nowait = dir->getSingleClause< clang::OMPNowaitClause >();
+                if (dir->hasClausesOfKind< clang::OMPReductionClause >() && !nowait) {
+                    make< mlir::omp::BarrierOp >(loc);
+                }
+            });
+        }
+
+        operation VisitOMPCriticalDirective(const clang::OMPCriticalDirective *dir) {
+            check_omp_clauses(dir, {});
+            if (!dir->getDirectiveName().getName().isEmpty()) {
+                VAST_UNIMPLEMENTED_MSG("named OpenMP critical sections");
+            }
+
+            return make_omp_region< mlir::omp::CriticalOp >(meta_location(dir), [&] {
+                visit(dir->getRawStmt());
+            }, mlir::FlatSymbolRefAttr());
+        }
+
+        operation VisitOMPBarrierDirective(const clang::OMPBarrierDirective *dir) {
+            return make< mlir::omp::BarrierOp >(meta_location(dir));
         }
 
         //
@@ -815,7 +1293,38 @@ namespace vast::cg {
             return visit(expr->getSubExpr());
         }
 
+        //
+        // Elements of vector objects are addressed through a pointer to the
+        // element type, so that they are read and written as any other lvalue.
+        // Only vector values that are not objects need a dedicated operation.
+        //
+        operation VisitVectorSubscript(const clang::ArraySubscriptExpr *expr) {
+            auto loc    = meta_location(expr);
+            auto vec    = expr->getBase();
+            auto base   = visit(vec)->getResult(0);
+            auto offset = visit(expr->getIdx())->getResult(0);
+
+            if (!vec->isGLValue()) {
+                return make< hl::VectorExtractOp >(loc, visit(expr->getType()), base, offset);
+            }
+
+            auto &actx = acontext();
+            auto addr = make< hl::AddressOf >(
+                loc, visit(actx.getPointerType(vec->getType())), base
+            );
+            auto ptr = make< hl::ImplicitCastOp >(
+                loc, visit(actx.getPointerType(expr->getType())), addr, hl::CastKind::BitCast
+            );
+            return make< hl::SubscriptOp >(
+                loc, visit_as_lvalue_type(expr->getType()), ptr, offset
+            );
+        }
+
         operation VisitArraySubscriptExpr(const clang::ArraySubscriptExpr *expr) {
+            if (expr->getBase()->getType()->isVectorType()) {
+                return VisitVectorSubscript(expr);
+            }
+
             auto rty    = visit_as_lvalue_type(expr->getType());
             auto base   = visit(expr->getBase())->getResult(0);
             auto offset = visit(expr->getIdx())->getResult(0);
@@ -824,7 +1333,6 @@ namespace vast::cg {
 
         // operation VisitArrayTypeTraitExpr(const clang::ArrayTypeTraitExpr *expr)
         // operation VisitAsTypeExpr(const clang::AsTypeExpr *expr)
-        // operation VisitAtomicExpr(const clang::AtomicExpr *expr)
         // operation VisitBlockExpr(const clang::BlockExpr *expr)
 
         // operation VisitCXXBindTemporaryExpr(const clang::CXXBindTemporaryExpr *expr)
@@ -852,6 +1360,260 @@ namespace vast::cg {
         // operation VisitCXXUnresolvedConstructExpr(const clang::CXXThrowExpr *expr)
         // operation VisitCXXUuidofExpr(const clang::CXXUuidofExpr *expr)
 
+        //
+        // Atomic Operations
+        //
+
+        hl::MemoryOrder memory_order(const clang::Expr *order) {
+            return hl::memory_order(acontext(), order);
+        }
+
+        // Object of type `type` that `ptr` points to.
+        Value make_deref(Location loc, Value ptr, clang::QualType type) {
+            return make< hl::Deref >(loc, visit_as_lvalue_type(type), ptr);
+        }
+
+        Value make_deref_load(Location loc, Value ptr, clang::QualType type) {
+            auto obj = make_deref(loc, ptr, type);
+            return make< hl::ImplicitCastOp >(
+                loc, visit(type), obj, hl::CastKind::LValueToRValue
+            );
+        }
+
+        bool is_generic(clang::AtomicExpr::AtomicOp op) {
+            using clang::AtomicExpr;
+            return op == AtomicExpr::AO__atomic_store
+                || op == AtomicExpr::AO__atomic_exchange
+                || op == AtomicExpr::AO__atomic_compare_exchange;
+        }
+
+        // Value operand of an atomic builtin, generic builtins take it by
+        // pointer.
+        Value atomic_operand(Location loc, const clang::AtomicExpr *expr, const clang::Expr *arg) {
+            auto value = visit(arg)->getResult(0);
+            if (is_generic(expr->getOp())) {
+                return make_deref_load(loc, value, expr->getValueType());
+            }
+            return value;
+        }
+
+        // Value of `*_fetch` builtins, computed from the previous value of
+        // the object.
+        Value make_fetched(Location loc, hl::RMWKind kind, Value old, Value arg) {
+            auto type = old.getType();
+            switch (kind) {
+                case hl::RMWKind::add:  return make< hl::AddIOp >(loc, type, old, arg);
+                case hl::RMWKind::sub:  return make< hl::SubIOp >(loc, type, old, arg);
+                case hl::RMWKind::_and: return make< hl::BinAndOp >(loc, type, old, arg);
+                case hl::RMWKind::_or:  return make< hl::BinOrOp >(loc, type, old, arg);
+                case hl::RMWKind::_xor: return make< hl::BinXorOp >(loc, type, old, arg);
+                case hl::RMWKind::nand:
+                    return make< hl::NotOp >(loc, type, make< hl::BinAndOp >(loc, type, old, arg));
+                default:
+                    VAST_UNREACHABLE("unexpected atomic fetch operator");
+            }
+        }
+
+        bool is_op_fetch(clang::AtomicExpr::AtomicOp op) {
+            using clang::AtomicExpr;
+            switch (op) {
+                case AtomicExpr::AO__atomic_add_fetch:
+                case AtomicExpr::AO__atomic_sub_fetch:
+                case AtomicExpr::AO__atomic_and_fetch:
+                case AtomicExpr::AO__atomic_or_fetch:
+                case AtomicExpr::AO__atomic_xor_fetch:
+                case AtomicExpr::AO__atomic_nand_fetch:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        operation VisitAtomicRMW(const clang::AtomicExpr *expr, hl::RMWKind kind) {
+            auto loc   = meta_location(expr);
+            auto order = memory_order(expr->getOrder());
+            auto type  = visit(expr->getValueType());
+            auto ptr   = visit(expr->getPtr())->getResult(0);
+            auto arg   = atomic_operand(loc, expr, expr->getVal1());
+
+            auto old = make< hl::AtomicRMWOp >(loc, type, kind, ptr, arg, order);
+            if (expr->getOp() == clang::AtomicExpr::AO__atomic_exchange) {
+                return make< hl::AssignOp >(
+                    loc, make_deref(loc, visit(expr->getVal2())->getResult(0), expr->getValueType()), old
+                );
+            }
+
+            if (is_op_fetch(expr->getOp())) {
+                return make_fetched(loc, kind, old, arg).getDefiningOp();
+            }
+
+            return old;
+        }
+
+        operation VisitAtomicCmpXchg(const clang::AtomicExpr *expr) {
+            auto loc      = meta_location(expr);
+            auto ptr      = visit(expr->getPtr())->getResult(0);
+            auto expected = visit(expr->getVal1())->getResult(0);
+            auto desired  = atomic_operand(loc, expr, expr->getVal2());
+
+            bool weak = false;
+            if (auto flag = expr->getWeak()) {
+                bool value = false;
+                weak = flag->EvaluateAsBooleanCondition(value, acontext()) && value;
+            }
+
+            return make< hl::AtomicCmpXchgOp >(
+                loc, visit(expr->getType()), ptr, expected, desired,
+                memory_order(expr->getOrder()), memory_order(expr->getOrderFail()), weak
+            );
+        }
+
+        //
+        // Only the GNU builtins on ordinary objects are supported, the C11
+        // builtins and `_Atomic` objects (as well as arithmetic on pointers
+        // and floats) are left to the fallback visitors.
+        //
+        operation VisitAtomicExpr(const clang::AtomicExpr *expr) {
+            using clang::AtomicExpr;
+
+            auto loc = meta_location(expr);
+            auto val = expr->getValueType();
+
+            if (auto kind = hl::rmw_kind(expr)) {
+                if (*kind != hl::RMWKind::xchg && !val->isIntegerType()) {
+                    return {};
+                }
+                return VisitAtomicRMW(expr, *kind);
+            }
+
+            switch (expr->getOp()) {
+                case AtomicExpr::AO__atomic_load_n:
+                case AtomicExpr::AO__atomic_load: {
+                    auto order = memory_order(expr->getOrder());
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = make< hl::AtomicLoadOp >(loc, visit(val), ptr, order);
+                    if (expr->getOp() == AtomicExpr::AO__atomic_load_n) {
+                        return value;
+                    }
+                    auto ret = visit(expr->getVal1())->getResult(0);
+                    return make< hl::AssignOp >(loc, make_deref(loc, ret, val), value);
+                }
+                case AtomicExpr::AO__atomic_store_n:
+                case AtomicExpr::AO__atomic_store: {
+                    auto order = memory_order(expr->getOrder());
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = atomic_operand(loc, expr, expr->getVal1());
+                    return make< hl::AtomicStoreOp >(loc, value, ptr, order);
+                }
+                case AtomicExpr::AO__atomic_compare_exchange_n:
+                case AtomicExpr::AO__atomic_compare_exchange:
+                    return VisitAtomicCmpXchg(expr);
+                default:
+                    return {};
+            }
+        }
+
+        operation VisitAtomicFence(const clang::CallExpr *expr, bool single_thread) {
+            return make< hl::AtomicFenceOp >(
+                meta_location(expr), memory_order(expr->getArg(0)), single_thread
+            );
+        }
+
+        //
+        // Builtins
+        //
+
+        template< typename Op >
+        operation make_builtin(const clang::CallExpr *expr) {
+            return make< Op >(meta_location(expr), visit(expr->getType()), VisitArguments(expr));
+        }
+
+        operation VisitBuiltinPrefetch(const clang::CallExpr *expr) {
+            auto constant_arg = [&] (unsigned idx, std::uint32_t init) -> std::uint32_t {
+                if (expr->getNumArgs() <= idx) {
+                    return init;
+                }
+                auto value = expr->getArg(idx)->getIntegerConstantExpr(acontext());
+                return value ? static_cast< std::uint32_t >(value->getZExtValue()) : init;
+            };
+
+            auto addr = visit(expr->getArg(0))->getResult(0);
+            return make< hl::BuiltinPrefetchOp >(
+                meta_location(expr), addr, constant_arg(1, 0), constant_arg(2, 3)
+            );
+        }
+
+        // The record behind `va_list` is implicit in clang, no declaration of the
+        // source defines it. It is emitted with the first variadic builtin.
+        void declare_va_list_tag() {
+            auto tag = acontext().getVaListTagDecl();
+            if (!tag) {
+                return;
+            }
+
+            auto type = visit(acontext().getRecordType(tag));
+            if (hl::definition_of(type, context().mod.get())) {
+                return;
+            }
+
+            auto guard = insertion_guard();
+            set_insertion_point_to_start(&context().getBodyRegion());
+            visit(tag);
+        }
+
+        mlir_value visit_va_list(const clang::Expr *list) {
+            declare_va_list_tag();
+            return visit(list)->getResult(0);
+        }
+
+        operation VisitBuiltinCall(const clang::CallExpr *expr) {
+            auto loc = meta_location(expr);
+            switch (expr->getBuiltinCallee()) {
+                case clang::Builtin::BI__atomic_thread_fence:
+                case clang::Builtin::BI__c11_atomic_thread_fence:
+                    return VisitAtomicFence(expr, false /* single thread */);
+                case clang::Builtin::BI__atomic_signal_fence:
+                case clang::Builtin::BI__c11_atomic_signal_fence:
+                    return VisitAtomicFence(expr, true /* single thread */);
+                case clang::Builtin::BI__builtin_memcpy:
+                    return make_builtin< hl::BuiltinMemcpyOp >(expr);
+                case clang::Builtin::BI__builtin_memset:
+                    return make_builtin< hl::BuiltinMemsetOp >(expr);
+                case clang::Builtin::BI__builtin_popcount:
+                case clang::Builtin::BI__builtin_popcountl:
+                case clang::Builtin::BI__builtin_popcountll:
+                    return make_builtin< hl::BuiltinPopcountOp >(expr);
+                case clang::Builtin::BI__builtin_clz:
+                case clang::Builtin::BI__builtin_clzl:
+                case clang::Builtin::BI__builtin_clzll:
+                    return make_builtin< hl::BuiltinClzOp >(expr);
+                case clang::Builtin::BI__builtin_ctz:
+                case clang::Builtin::BI__builtin_ctzl:
+                case clang::Builtin::BI__builtin_ctzll:
+                    return make_builtin< hl::BuiltinCtzOp >(expr);
+                case clang::Builtin::BI__builtin_bswap16:
+                case clang::Builtin::BI__builtin_bswap32:
+                case clang::Builtin::BI__builtin_bswap64:
+                    return make_builtin< hl::BuiltinBswapOp >(expr);
+                case clang::Builtin::BI__builtin_prefetch:
+                    return VisitBuiltinPrefetch(expr);
+                case clang::Builtin::BI__builtin_assume:
+                    return make< hl::BuiltinAssumeOp >(loc, visit(expr->getArg(0))->getResult(0));
+                case clang::Builtin::BI__builtin_unreachable:
+                    return make< hl::BuiltinUnreachableOp >(loc);
+                case clang::Builtin::BI__builtin_va_start:
+                    return make< hl::BuiltinVAStartOp >(loc, visit_va_list(expr->getArg(0)));
+                case clang::Builtin::BI__builtin_va_end:
+                    return make< hl::BuiltinVAEndOp >(loc, visit_va_list(expr->getArg(0)));
+                case clang::Builtin::BI__builtin_va_copy: {
+                    auto dst = visit_va_list(expr->getArg(0));
+                    return make< hl::BuiltinVACopyOp >(loc, dst, visit_va_list(expr->getArg(1)));
+                }
+                default:
+                    return {};
+            }
+        }
+
         hl::FuncOp VisitDirectCallee(const clang::FunctionDecl *callee) {
             auto guard = insertion_guard();
 
@@ -892,6 +1654,10 @@ namespace vast::cg {
         }
 
         operation VisitCallExpr(const clang::CallExpr *expr) {
+            if (auto builtin = VisitBuiltinCall(expr)) {
+                return builtin;
+            }
+
             if (expr->getDirectCallee()) {
                 return VisitDirectCall(expr);
             }
@@ -912,6 +1678,23 @@ namespace vast::cg {
         }
 
         // operation VisitParenListExpr(const clang::ParenListExpr *expr)
+
+        // operation VisitConvertVectorExpr(const clang::ConvertVectorExpr *expr)
+
+        operation VisitShuffleVectorExpr(const clang::ShuffleVectorExpr *expr) {
+            auto lhs = visit(expr->getExpr(0))->getResult(0);
+            auto rhs = visit(expr->getExpr(1))->getResult(0);
+
+            llvm::SmallVector< std::int32_t > mask;
+            for (unsigned idx = 0; idx < expr->getNumSubExprs() - 2; ++idx) {
+                auto lane = expr->getShuffleMaskIdx(acontext(), idx);
+                mask.push_back(static_cast< std::int32_t >(lane.getExtValue()));
+            }
+
+            return make< hl::VectorShuffleOp >(
+                meta_location(expr), visit(expr->getType()), lhs, rhs, mask
+            );
+        }
         operation VisitStmtExpr(const clang::StmtExpr *expr) {
             auto loc = meta_location(expr);
             auto sub = llvm::cast< clang::CompoundStmt >(expr->getSubStmt());
@@ -954,7 +1737,10 @@ namespace vast::cg {
             VAST_UNREACHABLE("unsupported UnaryExprOrTypeTraitExpr");
         }
 
-        // operation VisitVAArgExpr(const clang::VAArgExpr *expr)
+        operation VisitVAArgExpr(const clang::VAArgExpr *expr) {
+            auto list = visit_va_list(expr->getSubExpr());
+            return make< hl::BuiltinVAArgOp >(meta_location(expr), visit(expr->getType()), list);
+        }
 
         operation VisitNullStmt(const clang::NullStmt *stmt) {
             return make< hl::SkipStmt >(meta_location(stmt));
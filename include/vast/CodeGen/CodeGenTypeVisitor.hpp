@@ -40,8 +40,23 @@ namespace vast::cg {
 
         using lens::meta_location;
 
+        using lens::insertion_guard;
+        using lens::set_insertion_point_to_start;
+
         using qualifiers   = clang::Qualifiers;
 
+        // Emits a declaration of an AST file on the first use of its type,
+        // see `codegen_context::imported_decls`.
+        void import_decl(const clang::Decl *decl) {
+            if (!context().is_imported(decl) || !context().imported_decls.insert(decl).second) {
+                return;
+            }
+
+            auto guard = insertion_guard();
+            set_insertion_point_to_start(&context().getBodyRegion());
+            visit(decl);
+        }
+
         template< typename high_level_type >
         auto type_builder() {
             return derived().template make_type< high_level_type >().bind(&mcontext());
@@ -106,21 +121,34 @@ namespace vast::cg {
                 .freeze();
         }
 
+        auto with_qualifiers(const clang::VectorType *ty, qualifiers quals) -> mlir_type {
+            auto element_type = visit(ty->getElementType());
+            return with_cv_qualifiers(type_builder< hl::VectorType >()
+                .bind(ty->getNumElements())
+                .bind(element_type), quals)
+                .freeze();
+        }
+
         auto make_name_attr(string_ref name) {
             return mlir::StringAttr::get(&mcontext(), name);
         }
 
         auto with_qualifiers(const clang::RecordType *ty, qualifiers quals) -> mlir_type {
+            import_decl(ty->getDecl());
             auto name = make_name_attr( context().decl_name(ty->getDecl()) );
             return with_cv_qualifiers( type_builder< hl::RecordType >().bind(name), quals ).freeze();
         }
 
         auto with_qualifiers(const clang::EnumType *ty, qualifiers quals) -> mlir_type {
+            import_decl(ty->getDecl());
             auto name = make_name_attr( context().decl_name(ty->getDecl()) );
             return with_cv_qualifiers( type_builder< hl::RecordType >().bind(name), quals ).freeze();
         }
 
         auto with_qualifiers(const clang::TypedefType *ty, qualifiers quals) -> mlir_type {
+            if (auto decl = clang::dyn_cast< clang::TypedefDecl >(ty->getDecl())) {
+                import_decl(decl);
+            }
             auto name = make_name_attr( ty->getDecl()->getName() );
             return with_cvr_qualifiers( type_builder< hl::TypedefType >().bind(name), quals ).freeze();
         }
@@ -179,6 +207,10 @@ namespace vast::cg {
                 return VisitArrayType(t, quals);
             }
 
+            if (auto t = llvm::dyn_cast< clang::VectorType >(underlying)) {
+                return VisitVectorType(t, quals);
+            }
+
             if (auto t = llvm::dyn_cast< clang::ElaboratedType >(underlying)) {
                 return VisitElaboratedType(t, quals);
             }
@@ -328,6 +360,19 @@ namespace vast::cg {
             return VisitArrayType(ty, qualifiers());
         }
 
+        // Vectors of booleans are bit masks, their layout differs from the
+        // layout of an array of elements.
+        auto VisitVectorType(const clang::VectorType *ty, qualifiers quals) -> mlir_type {
+            if (ty->getElementType()->isBooleanType()) {
+                return {};
+            }
+            return with_qualifiers(ty, quals);
+        }
+
+        auto VisitVectorType(const clang::VectorType *ty) -> mlir_type {
+            return VisitVectorType(ty, ty->desugar().getQualifiers());
+        }
+
         auto VisitRecordType(const clang::RecordType *ty, qualifiers quals) -> mlir_type {
             return with_qualifiers(ty, quals);
         }
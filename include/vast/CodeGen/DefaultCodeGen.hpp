@@ -0,0 +1,14 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+namespace vast::cg
+{
+    //
+    // Code generator of the default visitor stack, defined in CodeGen.hpp and
+    // instantiated in the CodeGen library. Holders of one, e.g., the
+    // `codegen_driver`, need only this declaration.
+    //
+    struct default_codegen;
+
+} // namespace vast::cg
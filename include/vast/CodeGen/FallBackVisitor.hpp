@@ -20,7 +20,16 @@ namespace vast::cg
         operation Visit(const clang::Decl *decl) { return visit_with_fallback(decl); }
         mlir_type Visit(const clang::Type *type) { return visit_with_fallback(type); }
         mlir_attr Visit(const clang::Attr *attr) { return visit_with_fallback(attr); }
-        mlir_type Visit(clang::QualType    type) { return visit_with_fallback(type); }
+        mlir_type Visit(clang::QualType type) {
+            auto &types = static_cast< derived_t & >(*this).ctx.converted_types;
+            if (auto cached = types.lookup(type)) {
+                return cached;
+            }
+
+            auto result = visit_with_fallback(type);
+            types.insert(type, result);
+            return result;
+        }
 
         using visitors_list = util::type_list< visitors< derived_t >... >;
 
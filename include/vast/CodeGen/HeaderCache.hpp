@@ -0,0 +1,79 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/Block.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <string>
+
+namespace vast::cg
+{
+    struct codegen_context;
+
+    //
+    // Cache of high-level code of a precompiled header (-vast-hl-header-cache=<dir>)
+    //
+    // The entry of a compilation is keyed by the contents of the precompiled
+    // header, the target and the vast options. It holds the type declarations
+    // of the header the compilation emitted, the bodies of its inline
+    // functions and declarations of the functions these refer to. The next
+    // compilation with the same header reuses the cached operations by name
+    // instead of visiting the declarations again. Variables of the header are
+    // not cached, neither is anything that refers to an operation outside of
+    // the entry.
+    //
+    struct header_cache
+    {
+        // Returns null unless `-vast-hl-header-cache=<dir>` is present and the
+        // compilation includes a precompiled header.
+        static std::unique_ptr< header_cache > make(
+            codegen_context &cgctx, const cc::action_options &opts, const cc::vast_args &vargs
+        );
+
+        header_cache(codegen_context &cgctx, std::string path);
+
+        // Moves the cached declaration `kind` `name` (and what it depends on)
+        // to the module. Returns null if the entry does not have it.
+        operation reuse(string_ref kind, string_ref name);
+
+        // Fills the declaration `fn` with its cached body.
+        bool reuse_body(hl::FuncOp fn);
+
+        // Declarations emitted anew, stored at the end of the compilation.
+        void record(operation op);
+        void record_body(hl::FuncOp fn);
+
+        // To be run after the module is finished.
+        void store() const;
+
+      private:
+        void load();
+        void pull_dependencies(operation op);
+        operation place(operation op);
+
+        codegen_context &cgctx;
+        std::string path;
+
+        // The loaded entry, null on a miss.
+        std::unique_ptr< mlir::Block > cached;
+        // Cached declarations by name, and enums by the names of their constants.
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > by_name;
+        llvm::StringMap< operation > enums;
+        llvm::DenseSet< operation > placed;
+
+        std::vector< operation > recorded;
+        std::vector< hl::FuncOp > recorded_bodies;
+    };
+
+} // namespace vast::cg
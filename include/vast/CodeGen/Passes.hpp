@@ -5,11 +5,15 @@
 #include "vast/Util/Warnings.hpp"
 
 #include "vast/Util/Common.hpp"
+#include "vast/Util/PassInstrumentation.hpp"
 
 namespace vast::cg {
 
+    // With `warn_false_sharing`, the diagnostics of `vast-hl-false-sharing`
+    // are emitted for the module.
     logical_result emit_high_level_pass(
-        vast_module mod, mcontext_t *mctx, acontext_t *actx, bool enable_verifier
+        vast_module mod, mcontext_t *mctx, acontext_t *actx, bool enable_verifier,
+        bool warn_false_sharing = false, const pass_manager_config &config = {}
     );
 
 } // namespace vast::cg
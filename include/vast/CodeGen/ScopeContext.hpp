@@ -4,6 +4,13 @@
 
 #include "vast/Util/Warnings.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ScopedHashTable.h>
+#include <llvm/Support/Allocator.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
 #include <gap/core/generator.hpp>
 
 #include <functional>
@@ -11,12 +18,74 @@
 
 namespace vast::cg
 {
-    template< typename From, typename To >
-    struct scoped_table : llvm::ScopedHashTable< From, To >
+    //
+    // Scratch memory of function bodies. While a body is built, entries of
+    // the function-local symbol tables are bump allocated from the arena,
+    // which is released at once after the body, instead of an allocation
+    // per declaration on the heap.
+    //
+    // Scopes of the tables opened during the body have to be closed before
+    // its end, so that no entry outlives the arena.
+    //
+    struct function_arena
+    {
+        struct scope
+        {
+            explicit scope(function_arena &arena) : arena(arena) { ++arena.depth; }
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            ~scope() {
+                // Nested bodies, e.g., materialized on demand, share the
+                // arena of the outermost one.
+                if (--arena.depth == 0) {
+                    arena.memory.Reset();
+                }
+            }
+
+            function_arena &arena;
+        };
+
+        bool active() const { return depth > 0; }
+
+        llvm::BumpPtrAllocator memory;
+        unsigned depth = 0;
+    };
+
+    // Allocates from the arena while a function body is built and from the
+    // heap otherwise, e.g., entries of globals.
+    struct scratch_allocator : llvm::AllocatorBase< scratch_allocator >
+    {
+        explicit scratch_allocator(function_arena &arena) : arena(&arena) {}
+
+        void *Allocate(size_t size, size_t alignment) {
+            if (arena->active()) {
+                return arena->memory.Allocate(size, llvm::Align(alignment));
+            }
+            return llvm::allocate_buffer(size, alignment);
+        }
+
+        void Deallocate(const void *ptr, size_t size, size_t alignment) {
+            if (arena->active() && arena->memory.identifyObject(ptr)) {
+                return;
+            }
+            llvm::deallocate_buffer(const_cast< void * >(ptr), size, alignment);
+        }
+
+        using llvm::AllocatorBase< scratch_allocator >::Allocate;
+        using llvm::AllocatorBase< scratch_allocator >::Deallocate;
+
+      private:
+        function_arena *arena;
+    };
+
+    template< typename From, typename To, typename allocator = llvm::MallocAllocator >
+    struct scoped_table : llvm::ScopedHashTable< From, To, llvm::DenseMapInfo< From >, allocator >
     {
         using value_type = To;
 
-        using base = llvm::ScopedHashTable< From, To >;
+        using base = llvm::ScopedHashTable< From, To, llvm::DenseMapInfo< From >, allocator >;
         using base::base;
 
         using base::count;
@@ -0,0 +1,211 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/DeclVisitor.h>
+#include <clang/AST/StmtVisitor.h>
+#include <clang/AST/TypeVisitor.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/FallBackVisitor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+namespace vast::cg
+{
+    namespace detail
+    {
+        template< typename method_t >
+        struct member_class { using type = void; };
+
+        template< typename result_t, typename class_t, typename ...args_t >
+        struct member_class< result_t (class_t::*)(args_t...) > { using type = class_t; };
+
+        template< typename class_t >
+        constexpr bool is_clang_visitor_base = false;
+
+        template< template< typename > typename ptr, typename impl, typename result_t, typename ...args_t >
+        constexpr bool is_clang_visitor_base< clang::StmtVisitorBase< ptr, impl, result_t, args_t... > > = true;
+
+        template< template< typename > typename ptr, typename impl, typename result_t >
+        constexpr bool is_clang_visitor_base< clang::declvisitor::Base< ptr, impl, result_t > > = true;
+
+        template< typename impl, typename result_t >
+        constexpr bool is_clang_visitor_base< clang::TypeVisitor< impl, result_t > > = true;
+
+    } // namespace detail
+
+    //
+    // A visitor overrides `method` unless the only visible declaration is the default one
+    // from the clang visitor base, which just forwards to the parent class and eventually
+    // returns an empty result. Anything we cannot resolve (overload sets, templates) is
+    // conservatively treated as overridden.
+    //
+    #define VAST_OVERRIDES_VISIT(impl, method) \
+        [] { \
+            if constexpr (requires { &impl::method; }) { \
+                using owner = typename detail::member_class< decltype(&impl::method) >::type; \
+                return !detail::is_clang_visitor_base< owner >; \
+            } else { \
+                return true; \
+            } \
+        }()
+
+    //
+    // Per-kind tables of nodes that a clang-dispatched visitor `impl` might handle. A kind is
+    // handled if the visitor overrides its Visit method or the method of any of its parents.
+    //
+    template< typename impl >
+    struct stmt_kinds
+    {
+        static constexpr bool handles_Stmt() { return VAST_OVERRIDES_VISIT(impl, VisitStmt); }
+
+        #define STMT(CLASS, PARENT) \
+            static constexpr bool handles_##CLASS() { \
+                return VAST_OVERRIDES_VISIT(impl, Visit##CLASS) || handles_##PARENT(); \
+            }
+        #define ABSTRACT_STMT(STMT) STMT
+        #include <clang/AST/StmtNodes.inc>
+
+        static constexpr std::size_t count() {
+            std::size_t size = 0;
+            #define STMT(CLASS, PARENT) size = std::max< std::size_t >(size, clang::Stmt::CLASS##Class + 1);
+            #define ABSTRACT_STMT(STMT)
+            #include <clang/AST/StmtNodes.inc>
+            return size;
+        }
+
+        static constexpr auto make_table() {
+            std::array< bool, count() > table{};
+            #define STMT(CLASS, PARENT) table[clang::Stmt::CLASS##Class] = handles_##CLASS();
+            #define ABSTRACT_STMT(STMT)
+            #include <clang/AST/StmtNodes.inc>
+
+            // `StmtVisitor` dispatches operators by opcode to `VisitBin*` and `VisitUnary*`.
+            table[clang::Stmt::BinaryOperatorClass]         = true;
+            table[clang::Stmt::CompoundAssignOperatorClass] = true;
+            table[clang::Stmt::UnaryOperatorClass]          = true;
+            return table;
+        }
+    };
+
+    template< typename impl >
+    struct decl_kinds
+    {
+        static constexpr bool handles_Decl() { return VAST_OVERRIDES_VISIT(impl, VisitDecl); }
+
+        #define DECL(DERIVED, BASE) \
+            static constexpr bool handles_##DERIVED##Decl() { \
+                return VAST_OVERRIDES_VISIT(impl, Visit##DERIVED##Decl) || handles_##BASE(); \
+            }
+        #define ABSTRACT_DECL(DECL) DECL
+        #include <clang/AST/DeclNodes.inc>
+
+        static constexpr std::size_t count() {
+            std::size_t size = 0;
+            #define DECL(DERIVED, BASE) size = std::max< std::size_t >(size, clang::Decl::DERIVED + 1);
+            #define ABSTRACT_DECL(DECL)
+            #include <clang/AST/DeclNodes.inc>
+            return size;
+        }
+
+        static constexpr auto make_table() {
+            std::array< bool, count() > table{};
+            #define DECL(DERIVED, BASE) table[clang::Decl::DERIVED] = handles_##DERIVED##Decl();
+            #define ABSTRACT_DECL(DECL)
+            #include <clang/AST/DeclNodes.inc>
+            return table;
+        }
+    };
+
+    template< typename impl >
+    struct type_kinds
+    {
+        static constexpr bool handles_Type() { return VAST_OVERRIDES_VISIT(impl, VisitType); }
+
+        #define TYPE(CLASS, PARENT) \
+            static constexpr bool handles_##CLASS##Type() { \
+                return VAST_OVERRIDES_VISIT(impl, Visit##CLASS##Type) || handles_##PARENT(); \
+            }
+        #include <clang/AST/TypeNodes.inc>
+
+        static constexpr std::size_t count() {
+            std::size_t size = 0;
+            #define TYPE(CLASS, PARENT) size = std::max< std::size_t >(size, clang::Type::CLASS + 1);
+            #define ABSTRACT_TYPE(CLASS, PARENT)
+            #include <clang/AST/TypeNodes.inc>
+            return size;
+        }
+
+        static constexpr auto make_table() {
+            std::array< bool, count() > table{};
+            #define TYPE(CLASS, PARENT) table[clang::Type::CLASS] = handles_##CLASS##Type();
+            #define ABSTRACT_TYPE(CLASS, PARENT)
+            #include <clang/AST/TypeNodes.inc>
+            return table;
+        }
+    };
+
+    #undef VAST_OVERRIDES_VISIT
+
+    template< typename kinds >
+    inline constexpr auto kinds_table = kinds::make_table();
+
+    //
+    // table_dispatch_visitor
+    //
+    // Drop-in replacement of `fallback_visitor` that decides at compile time, per clang
+    // node kind, whether the `primary` visitor can produce anything at all. Kinds the
+    // primary visitor never handles go straight to the `fallbacks` chain, without running
+    // the primary dispatch first. Kinds it does handle still fall back on empty results.
+    //
+    // Requires `primary` to expose its clang-dispatched `stmt_visitor`, `decl_visitor` and
+    // `type_visitor`, as `default_visitor` does.
+    //
+    template<
+        typename derived_t,
+        template< typename > typename primary,
+        template< typename > typename ...fallbacks
+    >
+    struct table_dispatch_visitor : fallback_visitor< derived_t, primary, fallbacks... >
+    {
+        using base = fallback_visitor< derived_t, primary, fallbacks... >;
+        using primary_visitor = primary< derived_t >;
+
+        using stmt_table = stmt_kinds< typename primary_visitor::stmt_visitor >;
+        using decl_table = decl_kinds< typename primary_visitor::decl_visitor >;
+        using type_table = type_kinds< typename primary_visitor::type_visitor >;
+
+        using base::Visit;
+
+        operation Visit(const clang::Stmt *stmt) {
+            return dispatch(kinds_table< stmt_table >[stmt->getStmtClass()], stmt);
+        }
+
+        operation Visit(const clang::Decl *decl) {
+            return dispatch(kinds_table< decl_table >[decl->getKind()], decl);
+        }
+
+        mlir_type Visit(const clang::Type *type) {
+            return dispatch(kinds_table< type_table >[type->getTypeClass()], type);
+        }
+
+        auto dispatch(bool primary_handles, auto token) {
+            using result_type = decltype(primary_visitor::Visit(token));
+
+            result_type result;
+            if (primary_handles && (result = primary_visitor::Visit(token))) {
+                return result;
+            }
+
+            ((result = fallbacks< derived_t >::Visit(token)) || ... );
+            return result;
+        }
+    };
+
+} // namespace vast::cg
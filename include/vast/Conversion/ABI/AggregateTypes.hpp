@@ -349,4 +349,72 @@ namespace vast::conv::abi
         return reconstructor_t(state, module_op).run(record_type, rewriter);
     }
 
+    // Aggregates passed through memory.
+    // Pieces of a coerced record follow each other, every piece but the last
+    // one fills a whole eightbyte. Each piece is accessed by a coerced load or
+    // store, i.e. as `*(piece_t *)((char *)&record + offset)`.
+
+    template< typename rewriter_t >
+    mlir::Value coerced_access(rewriter_t &rewriter, loc_t loc, mlir::Value record,
+                               std::size_t byte_offset, mlir_type piece_type)
+    {
+        auto ctx = rewriter.getContext();
+        auto ptr_to = [&](mlir_type type) { return hl::PointerType::get(ctx, type); };
+        auto bitcast = [&](mlir::Value ptr, mlir_type to) -> mlir::Value {
+            return rewriter.template create< hl::CStyleCastOp >(
+                loc, ptr_to(to), ptr, hl::CastKind::BitCast);
+        };
+
+        auto record_type = mlir::cast< hl::LValueType >(record.getType()).getElementType();
+        auto byte_type   = mlir::IntegerType::get(ctx, 8, mlir::IntegerType::Signless);
+
+        mlir::Value addr = rewriter.template create< hl::AddressOf >(
+            loc, ptr_to(record_type), record);
+        addr = bitcast(addr, byte_type);
+
+        if (byte_offset != 0)
+        {
+            auto idx_type = mlir::IntegerType::get(ctx, 64, mlir::IntegerType::Signless);
+            auto idx = rewriter.template create< hl::ConstantOp >(
+                loc, idx_type, llvm::APSInt(llvm::APInt(64, byte_offset), false));
+            auto byte = rewriter.template create< hl::SubscriptOp >(
+                loc, hl::LValueType::get(ctx, byte_type), addr, idx);
+            addr = rewriter.template create< hl::AddressOf >(loc, ptr_to(byte_type), byte);
+        }
+
+        return rewriter.template create< hl::Deref >(
+            loc, hl::LValueType::get(ctx, piece_type), bitcast(addr, piece_type));
+    }
+
+    // Stores `pieces` into `record` (an lvalue).
+    template< typename pattern_t, typename rewriter_t >
+    void store_coerced(const pattern_t &pattern, rewriter_t &rewriter, loc_t loc,
+                       mlir::Value record, const std::vector< mlir::Value > &pieces)
+    {
+        std::size_t offset = 0;
+        for (auto piece : pieces)
+        {
+            auto dst = coerced_access(rewriter, loc, record, offset, piece.getType());
+            rewriter.template create< hl::AssignOp >(loc, dst, piece);
+            offset += pattern.bw(piece) / 8;
+        }
+    }
+
+    // Loads pieces of `types` from `record` (an lvalue).
+    template< typename pattern_t, typename rewriter_t >
+    auto load_coerced(const pattern_t &pattern, rewriter_t &rewriter, loc_t loc,
+                      mlir::Value record, mlir::TypeRange types)
+        -> std::vector< mlir::Value >
+    {
+        std::vector< mlir::Value > out;
+        std::size_t offset = 0;
+        for (auto type : types)
+        {
+            auto src = coerced_access(rewriter, loc, record, offset, type);
+            out.push_back(hl::implicit_cast_lvalue_to_rvalue(rewriter, loc, src));
+            offset += pattern.bw(type) / 8;
+        }
+        return out;
+    }
+
 } // namespace vast::conv::abi
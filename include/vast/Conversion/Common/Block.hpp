@@ -89,7 +89,7 @@ namespace vast::conv
         return std::distance(region.begin(), region.end());
     }
 
-    static inline bool empty(mlir::Block &block) { return size(block) == 0; }
-    static inline bool empty(mlir::Region &region) { return size(region) == 0; }
+    static inline bool empty(mlir::Block &block) { return block.empty(); }
+    static inline bool empty(mlir::Region &region) { return region.empty(); }
 
 } // namespace vast::conv
@@ -5,6 +5,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Transforms/DialectConversion.h"
 VAST_UNRELAX_WARNINGS
 
@@ -12,6 +13,13 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Types.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
 
+#include "vast/Util/Analysis.hpp"
+#include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/PatternProfile.hpp"
+
+#include <memory>
+#include <optional>
+
 namespace vast {
 
     // Inject basic api shared by other mixins:
@@ -47,6 +55,7 @@ namespace vast {
         template< typename config_t >
         auto apply_conversions(config_t config)
         {
+            self().instrument(config.patterns);
             return mlir::applyPartialConversion(self().getOperation(),
                                                 config.target,
                                                 std::move(config.patterns));
@@ -59,9 +68,32 @@ namespace vast {
 
     };
 
+    //
+    // Opt-in pattern profiling shared by the conversion mixins below, enabled by
+    // their `profile-patterns` option. The profile is created once per pass instance
+    // and shared with its clones, so the report covers all runs of the pass.
+    //
+    struct pattern_profiling
+    {
+        void create_profile(string_ref pass, bool requested) {
+            if (!profile && (requested || pattern_profiling_enabled())) {
+                profile = std::make_shared< pattern_profile >(pass);
+            }
+        }
+
+        void instrument(mlir::RewritePatternSet &patterns) const {
+            if (profile) {
+                profile_patterns(patterns, *profile);
+            }
+        }
+
+        std::shared_ptr< pattern_profile > profile;
+    };
+
     //
     // Mixin to define simple module conversion passes. It requires the derived
-    // pass to define two static methods.
+    // pass to define two static methods. Both are used once per pass instance,
+    // in `initialize`, the frozen result is reused by every run of the pass.
     //
     // To specify the legalization and illegalization of operations:
     //
@@ -126,15 +158,57 @@ namespace vast {
         // Override
         void populate_conversions(config_t &){}
 
-        void run_on_operation() {
-            auto &ctx   = getContext();
-            auto config = config_t { rewrite_pattern_set(&ctx),
-                                     derived_t::create_conversion_target(ctx) };
+        struct frozen_config_t
+        {
+            conversion_target target;
+            mlir::FrozenRewritePatternSet patterns;
+        };
+
+        // Shared by clones of the pass, which only read it.
+        std::shared_ptr< const frozen_config_t > frozen;
+
+        template< typename T >
+        using option = typename base::template Option< T >;
+
+        option< bool > profile_patterns{
+            *this, "profile-patterns",
+            llvm::cl::desc("Report match attempts, successes, failures and time per pattern"),
+            llvm::cl::init(false)
+        };
+
+        pattern_profiling profiling;
+
+        void instrument(rewrite_pattern_set &patterns) { profiling.instrument(patterns); }
+
+        ModuleConversionPassMixin() = default;
+
+        // Options are not copyable, their values are copied by `clonePass`.
+        ModuleConversionPassMixin(const ModuleConversionPassMixin &other)
+            : base(other), populate(other), frozen(other.frozen), profiling(other.profiling)
+        {}
+
+        logical_result initialize(mcontext_t *ctx) override {
+            auto config = config_t { rewrite_pattern_set(ctx),
+                                     derived_t::create_conversion_target(*ctx) };
 
             self().populate_conversions(config);
 
-            if (failed(populate::apply_conversions(std::move(config))))
-                return signalPassFailure();
+            profiling.create_profile(this->getArgument(), profile_patterns);
+            instrument(config.patterns);
+
+            frozen = std::make_shared< const frozen_config_t >(frozen_config_t {
+                std::move(config.target), mlir::FrozenRewritePatternSet(std::move(config.patterns))
+            });
+            return mlir::success();
+        }
+
+        void run_on_operation() {
+            // Skips the conversion of modules without an operation to convert.
+            auto op = getOperation();
+            if (util::has_illegal_ops(op, frozen->target)) {
+                if (failed(mlir::applyPartialConversion(op, frozen->target, frozen->patterns)))
+                    return signalPassFailure();
+            }
 
             this->after_operation();
         }
@@ -148,6 +222,9 @@ namespace vast {
     };
 
     // Sibling of the above module for passes that go to the LLVM dialect.
+    // The type converter depends on the converted module, so it is recreated
+    // for every run. Patterns and the conversion target are built by the first
+    // run and reused afterwards.
     // Example usage:
     //
     // struct ExamplePass : ModuleLLVMConversionPassMixin< ExamplePass, ExamplePassBase > {
@@ -216,22 +293,87 @@ namespace vast {
             cfg.patterns.template add< pattern >(cfg.tc);
         }
 
+        //
+        // Patterns and the target refer to the type converter, which is hence
+        // always recreated in the same storage. The cache is not shared with
+        // clones of the pass, as those may run concurrently.
+        //
+        struct cache_t
+        {
+            std::optional< llvm_type_converter > tc;
+            std::optional< conversion_target > target;
+            std::optional< mlir::FrozenRewritePatternSet > patterns;
+        };
+
+        struct cache_ptr
+        {
+            cache_ptr() = default;
+            cache_ptr(const cache_ptr &) : cache_ptr() {}
+            cache_ptr &operator=(const cache_ptr &) { return *this; }
+
+            cache_t *operator->() const { return ptr.get(); }
+
+            std::unique_ptr< cache_t > ptr = std::make_unique< cache_t >();
+        };
+
+        cache_ptr cache;
+
+        template< typename T >
+        using option = typename base::template Option< T >;
+
+        option< bool > profile_patterns{
+            *this, "profile-patterns",
+            llvm::cl::desc("Report match attempts, successes, failures and time per pattern"),
+            llvm::cl::init(false)
+        };
+
+        pattern_profiling profiling;
+
+        void instrument(rewrite_pattern_set &patterns) { profiling.instrument(patterns); }
+
+        ModuleLLVMConversionPassMixin() = default;
+
+        // Options are not copyable, their values are copied by `clonePass`.
+        ModuleLLVMConversionPassMixin(const ModuleLLVMConversionPassMixin &other)
+            : base(other), populate(other), profiling(other.profiling)
+        {}
+
+        logical_result initialize(mcontext_t *) override {
+            profiling.create_profile(this->getArgument(), profile_patterns);
+            return mlir::success();
+        }
+
         void run_on_operation() {
             auto &ctx   = getContext();
-            const auto &dl_analysis = this->template getAnalysis< mlir::DataLayoutAnalysis >();
+            const auto &dl_analysis = this->template getAnalysis< data_layout_analysis >().get();
 
             mlir::LowerToLLVMOptions llvm_options{ &ctx };
             derived_t::set_llvm_opts(llvm_options);
 
-            auto tc = llvm_type_converter(getOperation(), &ctx, llvm_options, &dl_analysis);
-            auto cfg = config(
-                rewrite_pattern_set(&ctx), derived_t::create_conversion_target(ctx, tc), tc
+            cache->tc.reset();
+            auto &tc = cache->tc.emplace(getOperation(), &ctx, llvm_options, &dl_analysis);
+            tc.use_cache(conv::tc::get_conversion_cache(getOperation(), this->getAnalysisManager()));
+            tc.records = get_module_analysis< hl::record_index >(
+                getOperation(), this->getAnalysisManager()
+            );
+            tc.layouts = get_module_analysis< hl::record_layout_analysis >(
+                getOperation(), this->getAnalysisManager()
             );
 
-            // populate all patterns
-            self().populate_conversions(cfg);
+            if (!cache->patterns) {
+                auto cfg = config(
+                    rewrite_pattern_set(&ctx), derived_t::create_conversion_target(ctx, tc), tc
+                );
+
+                // populate all patterns
+                self().populate_conversions(cfg);
+                instrument(cfg.patterns);
+
+                cache->target.emplace(std::move(cfg.target));
+                cache->patterns.emplace(std::move(cfg.patterns));
+            }
 
-            if (failed(populate::apply_conversions(std::move(cfg))))
+            if (failed(mlir::applyPartialConversion(getOperation(), *cache->target, *cache->patterns)))
                 return signalPassFailure();
         }
 
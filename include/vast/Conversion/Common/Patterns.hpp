@@ -127,8 +127,24 @@ namespace vast {
             }
         }
 
+        // Splat of `val` to all lanes of a vector.
+        mlir_value vector_constant(auto &rewriter, auto loc, mlir::VectorType type, auto val) const {
+            auto element = type.getElementType();
+            auto attr = [&] () -> mlir_attr {
+                if (element.isIntOrIndex())
+                    return rewriter.getIntegerAttr(element, val);
+                return rewriter.getFloatAttr(element, val);
+            }();
+
+            return rewriter.template create< mlir::LLVM::ConstantOp >(
+                loc, type, mlir::DenseElementsAttr::get(type, attr)
+            );
+        }
+
         mlir_value constant(auto &rewriter, auto loc, mlir_type type, auto val) const
         {
+            if (auto vector = mlir::dyn_cast< mlir::VectorType >(type))
+                return vector_constant(rewriter, loc, vector, val);
             if (type.isIntOrIndex())
                 return iN(rewriter, loc, type, val);
             if (mlir::isa< mlir::FloatType >(type))
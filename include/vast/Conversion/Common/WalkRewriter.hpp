@@ -0,0 +1,55 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/Visitors.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    //
+    // Driver of passes whose every rewrite is an unconditional one to one
+    // replacement, e.g., `hl.member` to `ll.gep`. Operations are rewritten in
+    // place in a single post-order walk: unlike `applyPartialConversion`
+    // there is no legality, no rollback and no materialization, so rewrites
+    // see the operands as they are and replace the uses right away.
+    //
+    // `rewrite(op, rewriter)` is called for every `op_t` nested in `root`,
+    // with the insertion point before `op`, and may erase or replace `op`.
+    // A failing rewrite interrupts the walk, and the operations rewritten so
+    // far stay rewritten, i.e., the pass is to fail as well.
+    //
+    template< typename op_t, typename rewrite_t >
+    logical_result rewrite_in_place(operation root, rewrite_t &&rewrite) {
+        mlir::IRRewriter rewriter(root->getContext());
+        auto result = root->walk< mlir::WalkOrder::PostOrder >([&] (op_t op) {
+            rewriter.setInsertionPoint(op);
+            if (mlir::failed(rewrite(op, rewriter))) {
+                return mlir::WalkResult::interrupt();
+            }
+            return mlir::WalkResult::advance();
+        });
+        return mlir::failure(result.wasInterrupted());
+    }
+
+    // Rewrites the operations of the body of `mod` alone, for rewrites of
+    // top-level operations the walk needs not to descend into.
+    template< typename op_t, typename rewrite_t >
+    logical_result rewrite_top_level_in_place(vast_module mod, rewrite_t &&rewrite) {
+        mlir::IRRewriter rewriter(mod.getContext());
+        for (auto op : llvm::make_early_inc_range(mod.getOps< op_t >())) {
+            rewriter.setInsertionPoint(op);
+            if (mlir::failed(rewrite(op, rewriter))) {
+                return mlir::failure();
+            }
+        }
+        return mlir::success();
+    }
+
+} // namespace vast::conv
@@ -5,6 +5,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <mlir/Dialect/OpenMP/OpenMPDialect.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 
 #include <mlir/IR/BuiltinOps.h>
@@ -17,10 +18,12 @@ VAST_UNRELAX_WARNINGS
 #include <vast/Dialect/HighLevel/HighLevelDialect.hpp>
 #include <vast/Dialect/HighLevel/HighLevelOps.hpp>
 #include <vast/Dialect/LowLevel/LowLevelDialect.hpp>
+#include <vast/Dialect/LowLevel/LowLevelOps.hpp>
 #include <vast/Dialect/Core/CoreDialect.hpp>
 #include <vast/Dialect/ABI/ABIDialect.hpp>
 
 #include <memory>
+#include <string>
 
 namespace vast
 {
@@ -36,6 +39,40 @@ namespace vast
     // Common
     std::unique_ptr< mlir::Pass > createIRsToLLVMPass();
 
+    struct irs_to_llvm_options
+    {
+        // Attach type-based alias analysis tags to memory accesses.
+        bool tbaa = false;
+        // Emit `llvm.lifetime` markers for variables of nested scopes.
+        bool lifetime_markers = false;
+        // Signed overflow is undefined, i.e., `nsw` arithmetic and `inbounds`
+        // subscripts.
+        bool no_signed_wrap = false;
+        // Scalar parameters are never undefined (`noundef`).
+        bool noundef = false;
+        // Loads of `bool` and enumerations carry their value range.
+        bool value_ranges = false;
+        // Promote scalar local variables to SSA values before the conversion.
+        bool promote_vars = false;
+        // Merge and thread the blocks of ll functions before the conversion.
+        bool simplify_cfg = true;
+        // TLS model of thread-local variables that do not state one, empty
+        // for the general dynamic model.
+        std::string tls_model;
+        // Mark symbols that cannot be preempted as `dso_local`, the remaining
+        // options describe how the module is linked.
+        bool dso_local = false;
+        bool pic = false;
+        bool pie = false;
+        bool semantic_interposition = false;
+        bool no_plt = false;
+        bool direct_access_external_data = false;
+        // Return records larger than two eightbytes through an `sret` slot.
+        bool return_slots = false;
+    };
+
+    std::unique_ptr< mlir::Pass > createIRsToLLVMPass(const irs_to_llvm_options &opts);
+
     // Core
     std::unique_ptr< mlir::Pass > createCoreToLLVMPass();
 
@@ -47,6 +84,8 @@ namespace vast
     // FromHL
     std::unique_ptr< mlir::Pass > createHLToLLCFPass();
 
+    std::unique_ptr< mlir::Pass > createHLToLLCFPass(bool rotate_loops);
+
     std::unique_ptr< mlir::Pass > createHLToLLGEPsPass();
 
     std::unique_ptr< mlir::Pass > createHLToLLVarsPass();
@@ -55,6 +94,19 @@ namespace vast
 
     std::unique_ptr< mlir::Pass > createHLToLLFuncPass();
 
+    std::unique_ptr< mlir::Pass > createHLToLLPass();
+
+    std::unique_ptr< mlir::Pass > createHLToLLPass(bool rotate_loops);
+
+    std::unique_ptr< mlir::Pass > createHLToSCFPass();
+
+    std::unique_ptr< mlir::Pass > createHLToOMPPass();
+
+    // LL
+    std::unique_ptr< mlir::Pass > createLLPromoteVarsPass();
+
+    std::unique_ptr< mlir::Pass > createLLSimplifyCFGPass();
+
     // Generate the code for registering passes.
     #define GEN_PASS_REGISTRATION
     #include "vast/Conversion/Passes.h.inc"
@@ -66,18 +118,28 @@ namespace vast
         pm.addPass(createLowerABIPass());
     }
 
-    static inline void build_to_ll_pipeline(mlir::PassManager &pm)
+    static inline void build_to_ll_pipeline(mlir::PassManager &pm, bool rotate_loops = false)
     {
         pm.addPass(createHLToLLFuncPass());
-        pm.addPass(createHLToLLVarsPass());
-        pm.addPass(createHLToLLCFPass());
-        pm.addPass(createHLEmitLazyRegionsPass());
-        pm.addPass(createHLToLLGEPsPass());
+
+        // Function-local conversions are fused and nested, so that the pass
+        // manager can run them on multiple functions in parallel.
+        pm.nest< ll::FuncOp >().addPass(createHLToLLPass(rotate_loops));
     }
 
-    static inline void build_to_llvm_pipeline(mlir::PassManager &pm)
-    {
-        pm.addPass(createIRsToLLVMPass());
+    static inline void build_to_llvm_pipeline(
+        mlir::PassManager &pm, const irs_to_llvm_options &opts = {}
+    ) {
+        // Merged blocks also let more variables be promoted.
+        if (opts.simplify_cfg) {
+            pm.nest< ll::FuncOp >().addPass(createLLSimplifyCFGPass());
+        }
+
+        if (opts.promote_vars) {
+            pm.nest< ll::FuncOp >().addPass(createLLPromoteVarsPass());
+        }
+
+        pm.addPass(createIRsToLLVMPass(opts));
         pm.addPass(createCoreToLLVMPass());
     }
 
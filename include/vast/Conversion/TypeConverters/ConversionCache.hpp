@@ -0,0 +1,88 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Types.h>
+#include <mlir/Pass/AnalysisManager.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <shared_mutex>
+
+namespace vast::conv::tc {
+
+    //
+    // type_conversion_cache
+    //
+    // Module analysis that memoizes type conversions across passes and across
+    // runs of function passes nested in the module. Entries are partitioned by
+    // a converter domain, i.e., the converter kind and its options. The cache
+    // stays valid as long as the type definitions of the module (records,
+    // typedefs, enums) and module attributes (data layout) do not change,
+    // regardless of the analyses preserved by a pass.
+    //
+    // Lookups and stores are synchronized, so function passes running in
+    // parallel may share the cache of their module.
+    //
+    struct type_conversion_cache
+    {
+        using domain_t = std::size_t;
+
+        explicit type_conversion_cache(operation op);
+
+        maybe_types_t lookup(domain_t domain, mlir_type from) const;
+        void store(domain_t domain, mlir_type from, mlir::ArrayRef< mlir_type > to) const;
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const;
+
+      private:
+        operation mod;
+        llvm::hash_code stamp;
+
+        mutable std::shared_mutex mutex;
+        mutable llvm::DenseMap< std::pair< domain_t, mlir_type >, types_t > entries;
+    };
+
+    // Returns the cache of the converted module, either computed for the module
+    // itself or cached by a module pass when `op` is nested in the module.
+    const type_conversion_cache *get_conversion_cache(operation op, mlir::AnalysisManager am);
+
+    //
+    // Used by type converters to consult the cache before running their own
+    // conversions. Only successful conversions are stored.
+    //
+    struct cached_conversions
+    {
+        void use(const type_conversion_cache *cache, type_conversion_cache::domain_t domain) {
+            this->cache  = cache;
+            this->domain = domain;
+        }
+
+        maybe_types_t convert(mlir_type type, auto &&convert) {
+            if (!cache) {
+                return convert(type);
+            }
+
+            if (auto hit = cache->lookup(domain, type)) {
+                return hit;
+            }
+
+            auto result = convert(type);
+            if (result) {
+                cache->store(domain, type, *result);
+            }
+
+            return result;
+        }
+
+        const type_conversion_cache *cache = nullptr;
+        type_conversion_cache::domain_t domain = 0;
+    };
+
+} // namespace vast::conv::tc
@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/DialectConversion.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
@@ -16,6 +17,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/Core/CoreTypes.hpp"
 
 #include "vast/Conversion/Common/Types.hpp"
+#include "vast/Conversion/TypeConverters/ConversionCache.hpp"
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
 #include "vast/Util/Maybe.hpp"
@@ -156,11 +158,15 @@ namespace vast::conv::tc {
         using Base::convert_type_to_type;
         using Base::convert_type_to_types;
 
-        const mlir::DataLayout &dl;
+        // Builtin types are answered by `builtins` if the module has them.
+        hl::builtin_data_layout dl;
         mlir::MLIRContext &mctx;
 
-        HLToStd(const mlir::DataLayout &dl, mcontext_t &mctx)
-            : base_type_converter(), dl(dl), mctx(mctx) {
+        HLToStd(
+            const mlir::DataLayout &dl, mcontext_t &mctx,
+            const hl::builtin_layout_table *builtins = nullptr
+        )
+            : base_type_converter(), dl(dl, builtins), mctx(mctx) {
             // Fallthrough option - we define it first as it seems the framework
             // goes from the last added conversion.
             addConversion([&](mlir_type t) -> maybe_type_t {
@@ -173,6 +179,7 @@ namespace vast::conv::tc {
 
             // Use provided data layout to get the correct type.
             addConversion([&](hl::ArrayType t) { return this->convert_arr_type(t); });
+            addConversion([&](hl::VectorType t) { return this->convert_vector_type(t); });
             addConversion([&](hl::VoidType t) -> maybe_type_t {
                 return { mlir::NoneType::get(&mctx) };
             });
@@ -181,12 +188,20 @@ namespace vast::conv::tc {
             CoreToStd< HLToStd >::init();
         }
 
+        cached_conversions cached;
+
+        void use_cache(const type_conversion_cache *cache) {
+            cached.use(cache, llvm::hash_value(string_ref("hl-to-std")));
+        }
+
         maybe_types_t convert_type(mlir_type t) {
-            types_t out;
-            if (mlir::succeeded(convertTypes(t, out))) {
-                return { std::move(out) };
-            }
-            return {};
+            return cached.convert(t, [&] (mlir_type type) -> maybe_types_t {
+                types_t out;
+                if (mlir::succeeded(convertTypes(type, out))) {
+                    return { std::move(out) };
+                }
+                return {};
+            });
         }
 
         // TODO(lukas): Take optional to denote that is may be `Signless`.
@@ -265,5 +280,12 @@ namespace vast::conv::tc {
                 .and_then([&](auto t) { return mlir::MemRefType::get({ coerced_dim }, *t); })
                 .take_wrapped< maybe_type_t >();
         }
+
+        maybe_type_t convert_vector_type(hl::VectorType vec) {
+            auto size = static_cast< std::int64_t >(vec.getSize());
+            return Maybe(convert_type_to_type(vec.getElementType()))
+                .and_then([&](auto t) { return mlir::VectorType::get({ size }, *t); })
+                .take_wrapped< maybe_type_t >();
+        }
     };
 } // namespace vast::conv::tc
@@ -11,8 +11,11 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
 #include "vast/Util/Maybe.hpp"
 
+#include "vast/Conversion/TypeConverters/ConversionCache.hpp"
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
 // TODO(lukas): Possibly move this out of Util?
@@ -55,12 +58,18 @@ namespace vast::conv::tc {
         LLVMTypeConverter &operator=(const LLVMTypeConverter &) = delete;
         LLVMTypeConverter &operator=(LLVMTypeConverter &&)      = delete;
 
+        cached_conversions cached;
+
+        void use_cache(const type_conversion_cache *cache) { use_cache(cache, "llvm"); }
+
         maybe_types_t do_conversion(mlir::Type t) {
-            types_t out;
-            if (mlir::succeeded(this->convertTypes(t, out))) {
-                return { std::move(out) };
-            }
-            return {};
+            return cached.convert(t, [&] (mlir_type type) -> maybe_types_t {
+                types_t out;
+                if (mlir::succeeded(this->convertTypes(type, out))) {
+                    return { std::move(out) };
+                }
+                return {};
+            });
         }
 
         auto make_ptr_type() {
@@ -173,6 +182,16 @@ namespace vast::conv::tc {
             }
             return this->convert_type_to_types(t);
         }
+
+      protected:
+        // Conversions depend on the kind of the converter and its options.
+        void use_cache(const type_conversion_cache *cache, string_ref kind) {
+            const auto &opts = getOptions();
+            cached.use(cache, llvm::hash_combine(
+                kind, opts.useBarePtrCallConv, opts.useOpaquePointers, opts.getIndexBitwidth(),
+                opts.dataLayout.getStringRepresentation()
+            ));
+        }
     };
 
     template< typename self_t >
@@ -196,6 +215,8 @@ namespace vast::conv::tc {
             return { std::move(out) };
         }
 
+        maybe_types_t record_body(mlir_type t) { return self().convert_field_types(t); }
+
         template< typename op_t >
         auto convert_recordlike() {
             // We need this prototype to handle recursive types.
@@ -207,7 +228,7 @@ namespace vast::conv::tc {
                 auto bt = stack.drop_back();
 
                 if (core.isOpaque() && std::ranges::find(bt, t) == bt.end()) {
-                    if (auto body = convert_field_types(t)) {
+                    if (auto body = self().record_body(t)) {
                         // Multithreading may cause some issues?
                         auto status = core.setBody(*body, false);
                         VAST_ASSERT(mlir::succeeded(status));
@@ -228,6 +249,32 @@ namespace vast::conv::tc {
 
         vast_module mod;
 
+        // Resolves record definitions if available, instead of scanning `mod`.
+        const hl::record_index *records = nullptr;
+
+        // Layouts of structs, a struct with bitfields is lowered to their
+        // storage units instead of an element per field.
+        const hl::record_layout_analysis *layouts = nullptr;
+
+        // Bitfield as accessed through its storage unit.
+        struct bitfield_access
+        {
+            // Position of the field in the storage unit, in bits.
+            std::uint64_t offset;
+            std::uint32_t width;
+            // Size of the storage unit in bits, and its alignment in bytes.
+            std::uint64_t unit_size;
+            std::uint64_t unit_align;
+            bool is_signed;
+        };
+
+        struct lowered_record
+        {
+            types_t body;
+            // Element of each field, bitfields share the element of their unit.
+            mlir::SmallVector< unsigned > elements;
+        };
+
         template< typename... Args >
         FullLLVMTypeConverter(vast_module mod,
                               Args &&...args)
@@ -237,10 +284,12 @@ namespace vast::conv::tc {
             addConversion(convert_recordlike< hl::RecordType >());
         }
 
-        auto get_field_types(mlir_type t) -> std::optional< gap::generator< mlir_type > > {
+        void use_cache(const type_conversion_cache *cache) { base::use_cache(cache, "full-llvm"); }
+
+        auto get_field_types(mlir_type t) -> std::optional< hl::field_type_range > {
             if (!mlir::isa< hl::RecordType >(t))
                 return {};
-            auto def = hl::definition_of(t, mod);
+            auto def = records ? records->definition_of(t) : hl::definition_of(t, mod);
             // Nothing found, leave the structure opaque.
             if (!def) {
                 return {};
@@ -248,6 +297,127 @@ namespace vast::conv::tc {
             return { hl::field_types(*def) };
         }
 
+        const hl::record_layout *bitfield_layout(mlir_type record) const {
+            auto layout = layouts ? layouts->lookup(record) : nullptr;
+            return layout && !layout->units.empty() ? layout : nullptr;
+        }
+
+        // A storage unit is an integer if it is aligned to its size and the
+        // integer does not raise the alignment of the record, otherwise an
+        // array of bytes, e.g., four 16-bit bitfields followed by an int form
+        // a 64-bit unit in a record aligned to 32 bits. Gaps before storage units and at the end of the
+        // struct are explicit arrays of bytes, as the units do not carry the
+        // alignment of the bitfield types.
+        std::optional< lowered_record > lower_record(mlir_type t) {
+            auto layout = bitfield_layout(t);
+            if (!layout) {
+                return {};
+            }
+
+            auto field_types = get_field_types(t);
+            if (!field_types) {
+                return {};
+            }
+
+            auto &mctx = this->getContext();
+            auto byte  = mlir::IntegerType::get(&mctx, 8);
+
+            lowered_record out;
+            std::uint64_t end = 0;
+            auto pad = [&] (std::uint64_t to) {
+                if (to > end) {
+                    out.body.push_back(LLVM::LLVMArrayType::get(byte, (to - end) / 8));
+                    end = to;
+                }
+            };
+
+            std::optional< unsigned > last_unit;
+            std::size_t idx = 0;
+            for (auto field_type : *field_types) {
+                VAST_CHECK(idx < layout->fields.size(), "Layout does not match the fields of {0}", t);
+                const auto &field = layout->fields[idx++];
+
+                if (field.unit) {
+                    if (field.unit != last_unit) {
+                        const auto &unit = layout->units[*field.unit];
+                        pad(unit.offset);
+                        auto is_int = llvm::isPowerOf2_64(unit.size)
+                            && unit.offset % unit.size == 0
+                            && unit.size <= layout->align;
+                        if (is_int) {
+                            out.body.push_back(mlir::IntegerType::get(&mctx, unsigned(unit.size)));
+                        } else {
+                            out.body.push_back(LLVM::LLVMArrayType::get(byte, unit.size / 8));
+                        }
+                        end = unit.offset + unit.size;
+                        last_unit = field.unit;
+                    }
+                    out.elements.push_back(unsigned(out.body.size() - 1));
+                    continue;
+                }
+
+                // Zero-width bitfields take no storage and are never accessed.
+                if (field.bits) {
+                    out.elements.push_back(unsigned(out.body.size()));
+                    continue;
+                }
+
+                auto converted = this->convert_type_to_type(field_type);
+                VAST_ASSERT(converted);
+                out.elements.push_back(unsigned(out.body.size()));
+                out.body.push_back(*converted);
+                end = field.offset + field.size;
+                last_unit.reset();
+            }
+
+            pad(layout->size);
+            return out;
+        }
+
+        maybe_types_t record_body(mlir_type t) {
+            if (auto lowered = lower_record(t)) {
+                return { std::move(lowered->body) };
+            }
+            return convert_field_types(t);
+        }
+
+        // Element of the llvm struct that holds the field `idx` of `record`.
+        unsigned element_index(mlir_type record, unsigned idx) {
+            if (auto lowered = lower_record(record)) {
+                return lowered->elements[idx];
+            }
+            return idx;
+        }
+
+        std::optional< bitfield_access > bitfield(mlir_type record, unsigned idx) const {
+            auto layout = bitfield_layout(record);
+            if (!layout || idx >= layout->fields.size()) {
+                return {};
+            }
+
+            const auto &field = layout->fields[idx];
+            if (!field.unit) {
+                return {};
+            }
+
+            const auto &unit = layout->units[*field.unit];
+            auto type = field.type;
+            if (auto elaborated = mlir::dyn_cast< hl::ElaboratedType >(type)) {
+                type = elaborated.getElementType();
+            }
+            bool is_signed = (mlir::isa< mlir::IntegerType >(type) || hl::isIntegerType(type))
+                && hl::isSigned(type);
+
+            auto offset_bytes = unit.offset / 8;
+            auto align = offset_bytes == 0
+                ? layout->align / 8
+                : std::min< std::uint64_t >(layout->align / 8, offset_bytes & -offset_bytes);
+
+            return bitfield_access{
+                field.offset - unit.offset, *field.bits, unit.size, align, is_signed
+            };
+        }
+
         maybe_type_t convert_elaborated_type(hl::ElaboratedType t) {
             return this->convert_type_to_type(t.getElementType());
         }
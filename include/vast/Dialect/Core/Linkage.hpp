@@ -6,8 +6,11 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
+#include <clang/Basic/Visibility.h>
 VAST_UNRELAX_WARNINGS
 
+#include <optional>
+
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/Core/CoreDialect.hpp"
 
@@ -21,4 +24,11 @@ namespace vast::core {
 
     core::GlobalLinkageKind get_function_linkage(clang::GlobalDecl glob);
 
+    // Symbol visibility of `decl` other than the default one, as clang sets it:
+    // definitions get the visibility of the declaration (including the one of
+    // `-fvisibility`), declarations only an explicit one.
+    std::optional< clang::Visibility > get_symbol_visibility(
+        const clang::NamedDecl *decl, bool is_definition
+    );
+
 } // namespace vast::core
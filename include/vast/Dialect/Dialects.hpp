@@ -6,6 +6,10 @@
 
 VAST_RELAX_WARNINGS
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Dialect/DLTI/DLTI.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/OpenMP/OpenMPDialect.h"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/ABI/ABIDialect.hpp"
@@ -36,4 +40,21 @@ namespace vast {
         mctx.appendDialectRegistry(registry);
     }
 
+    // Loads only the dialects that codegen and the vast pipelines build directly.
+    // Other registered dialects are loaded on demand, e.g., when a pass declares
+    // them as dependent or the parser encounters them.
+    inline void load_vast_dialects(mcontext_t &mctx) {
+        mctx.loadDialect<
+            vast::abi::ABIDialect,
+            vast::core::CoreDialect,
+            vast::hl::HighLevelDialect,
+            vast::ll::LowLevelDialect,
+            vast::meta::MetaDialect,
+            vast::unsup::UnsupportedDialect,
+            mlir::DLTIDialect,
+            mlir::LLVM::LLVMDialect,
+            mlir::omp::OpenMPDialect
+            >();
+    }
+
 } // namespace vast
@@ -0,0 +1,140 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <array>
+#include <optional>
+
+namespace vast::hl
+{
+    enum class builtin_type : std::uint8_t {
+        bool_type, char_type, short_type, int_type, long_type, long_long_type, int128_type,
+        half_type, bfloat16_type, float_type, double_type, long_double_type, float128_type,
+        pointer_type
+    };
+
+    constexpr std::size_t builtin_type_count = std::size_t(builtin_type::pointer_type) + 1;
+
+    inline std::optional< builtin_type > builtin_type_of(mlir_type type) {
+        auto id = type.getTypeID();
+        if (id == mlir::TypeID::get< hl::IntType >())        return builtin_type::int_type;
+        if (id == mlir::TypeID::get< hl::PointerType >())    return builtin_type::pointer_type;
+        if (id == mlir::TypeID::get< hl::CharType >())       return builtin_type::char_type;
+        if (id == mlir::TypeID::get< hl::LongType >())       return builtin_type::long_type;
+        if (id == mlir::TypeID::get< hl::BoolType >())       return builtin_type::bool_type;
+        if (id == mlir::TypeID::get< hl::ShortType >())      return builtin_type::short_type;
+        if (id == mlir::TypeID::get< hl::LongLongType >())   return builtin_type::long_long_type;
+        if (id == mlir::TypeID::get< hl::DoubleType >())     return builtin_type::double_type;
+        if (id == mlir::TypeID::get< hl::FloatType >())      return builtin_type::float_type;
+        if (id == mlir::TypeID::get< hl::Int128Type >())     return builtin_type::int128_type;
+        if (id == mlir::TypeID::get< hl::LongDoubleType >()) return builtin_type::long_double_type;
+        if (id == mlir::TypeID::get< hl::HalfType >())       return builtin_type::half_type;
+        if (id == mlir::TypeID::get< hl::BFloat16Type >())   return builtin_type::bfloat16_type;
+        if (id == mlir::TypeID::get< hl::Float128Type >())   return builtin_type::float128_type;
+        return std::nullopt;
+    }
+
+    // Size and ABI alignment in bits, as in the data layout entries.
+    struct builtin_layout {
+        std::uint32_t size;
+        std::uint32_t align;
+
+        constexpr bool operator==(const builtin_layout &) const = default;
+    };
+
+    //
+    // Layouts of the builtin scalar types of a target, which are fixed by its
+    // triple. Qualifiers do not change layouts, so a table answers for every
+    // variant of a type without a search of the data layout entries.
+    //
+    // A module gets its table once, by `select_builtin_layout` when its data
+    // layout is emitted, and only if the table agrees with all of its entries,
+    // e.g., not if `-mlong-double-64` changed the entry of `long double`.
+    // Records and modules of other targets are queried through DLTI.
+    //
+    struct builtin_layout_table {
+        static constexpr llvm::StringLiteral attr_name() { return "hl.builtin_layout"; }
+
+        llvm::StringLiteral name;
+        std::array< builtin_layout, builtin_type_count > layouts;
+
+        constexpr builtin_layout operator[](builtin_type type) const {
+            return layouts[std::size_t(type)];
+        }
+
+        std::optional< builtin_layout > lookup(mlir_type type) const {
+            if (auto builtin = builtin_type_of(type)) {
+                return (*this)[*builtin];
+            }
+            return std::nullopt;
+        }
+
+        static const builtin_layout_table *of_target(const llvm::Triple &triple);
+
+        static const builtin_layout_table *by_name(string_ref name);
+
+        // Table selected for the module, null if none was.
+        static const builtin_layout_table *of_module(operation mod);
+    };
+
+    // Attaches the table of the target of `mod` if its data layout agrees
+    // with the table, removes a stale one otherwise.
+    void select_builtin_layout(operation mod);
+
+    //
+    // Data layout queries that answer builtin types from the table of the
+    // module and the rest from `mlir::DataLayout`. Mirrors the queries of
+    // `mlir::DataLayout`, so that code templated on the data layout, e.g.,
+    // the ABI classification, takes either.
+    //
+    struct builtin_data_layout {
+        builtin_data_layout(const mlir::DataLayout &dl, const builtin_layout_table *table)
+            : dl(dl), table(table)
+        {}
+
+        builtin_data_layout(const mlir::DataLayout &dl, operation mod)
+            : builtin_data_layout(dl, builtin_layout_table::of_module(mod))
+        {}
+
+        unsigned getTypeSizeInBits(mlir_type type) const {
+            if (auto layout = builtin(type)) {
+                return layout->size;
+            }
+            return dl.getTypeSizeInBits(type);
+        }
+
+        unsigned getTypeSize(mlir_type type) const {
+            return unsigned(llvm::divideCeil(getTypeSizeInBits(type), 8));
+        }
+
+        unsigned getTypeABIAlignment(mlir_type type) const {
+            if (auto layout = builtin(type)) {
+                return layout->align;
+            }
+            return dl.getTypeABIAlignment(type);
+        }
+
+        const mlir::DataLayout &underlying() const { return dl; }
+
+      private:
+        std::optional< builtin_layout > builtin(mlir_type type) const {
+            return table ? table->lookup(type) : std::nullopt;
+        }
+
+        const mlir::DataLayout &dl;
+        const builtin_layout_table *table;
+    };
+
+} // namespace vast::hl
@@ -0,0 +1,100 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Region.h>
+#include <llvm/ADT/APSInt.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::hl
+{
+    //
+    // Matchers of high-level operations shared by the transformations of the
+    // high-level dialect and the conversions from it.
+    //
+
+    // Implicit or explicit cast of one of the `kinds`.
+    static inline bool is_cast(operation op, auto ...kinds) {
+        if (auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(op)) {
+            return ((cast.getKind() == kinds) || ...);
+        }
+        if (auto cast = mlir::dyn_cast< hl::CStyleCastOp >(op)) {
+            return ((cast.getKind() == kinds) || ...);
+        }
+        return false;
+    }
+
+    static inline bool is_load(operation op) {
+        return is_cast(op, hl::CastKind::LValueToRValue);
+    }
+
+    // Value of an integer or boolean `hl.const`.
+    static inline std::optional< llvm::APSInt > constant_int(mlir_value value) {
+        auto cst = value.getDefiningOp< hl::ConstantOp >();
+        if (!cst) {
+            return std::nullopt;
+        }
+
+        if (auto attr = mlir::dyn_cast< core::IntegerAttr >(cst.getValue())) {
+            return attr.getValue();
+        }
+
+        if (auto attr = mlir::dyn_cast< core::BooleanAttr >(cst.getValue())) {
+            return llvm::APSInt(llvm::APInt(1, attr.getValue()), true);
+        }
+
+        return std::nullopt;
+    }
+
+    // Operations without side effects that may be dropped with the condition
+    // of a folded control flow operation.
+    static inline bool is_pure(operation op) {
+        if (auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(op)) {
+            return cast.getKind() != hl::CastKind::LValueToRValue;
+        }
+
+        return mlir::isa<
+            hl::ConstantOp, hl::CondYieldOp, hl::CStyleCastOp, hl::CmpOp,
+            hl::AddIOp, hl::SubIOp, hl::MulIOp, hl::BinAndOp, hl::BinOrOp, hl::BinXorOp,
+            hl::BinShlOp, hl::BinLShrOp, hl::BinAShrOp, hl::LNotOp
+        >(op);
+    }
+
+    // Jumps into a dropped region would lose their target.
+    static inline bool has_jump_targets(mlir::Region &region) {
+        auto result = region.walk([] (operation op) {
+            if (mlir::isa< hl::LabelStmt, hl::CaseOp, hl::DefaultOp >(op))
+                return mlir::WalkResult::interrupt();
+            return mlir::WalkResult::advance();
+        });
+        return result.wasInterrupted();
+    }
+
+    // Value of a condition region that yields a constant and has no side
+    // effects.
+    static inline std::optional< bool > constant_condition(mlir::Region &cond) {
+        if (!cond.hasOneBlock()) {
+            return std::nullopt;
+        }
+
+        auto yield = mlir::dyn_cast< hl::CondYieldOp >(cond.front().getTerminator());
+        if (!yield || !llvm::all_of(cond.front(), is_pure)) {
+            return std::nullopt;
+        }
+
+        if (auto value = constant_int(yield.getResult())) {
+            return !value->isZero();
+        }
+
+        return std::nullopt;
+    }
+
+} // namespace vast::hl
@@ -12,47 +12,58 @@
 
 #include "gap/core/generator.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include <utility>
+
 /* Contains common utilities often needed to work with hl dialect. */
 
 namespace vast::hl
 {
-    template< typename T >
-    gap::generator< T > top_level_ops(vast_module module_op)
-    {
-        auto body = module_op.getBody();
-        if (!body)
-            co_return;
+    // The helpers below return ranges over the operations in place, they are
+    // called per operation by conversions and allocate nothing.
 
-        for (auto &op : *body)
-            if (auto casted = mlir::dyn_cast< T >(op))
-                co_yield casted;
+    template< typename T >
+    auto top_level_ops(vast_module module_op) {
+        return module_op.getBody()->template getOps< T >();
     }
 
-    using type_generator = gap::generator< mlir::Type >;
     using value_generator = gap::generator< mlir::Value >;
 
-    static inline gap::generator< hl::FieldDeclOp > field_defs(hl::StructDeclOp op)
+    namespace detail
     {
-        for (auto &maybe_field : op.getOps())
-        {
-            // TODO(hl): So normally only `hl.field` should be present here,
-            //           but currently also re-declarations of nested structures
-            //           are here - add hard fail if the conversion fails in the future.
-            if (mlir::isa< hl::StructDeclOp >(maybe_field))
-                continue;
+        // TODO(hl): So normally only `hl.field` should be present here,
+        //           but currently also re-declarations of nested structures
+        //           are here - add hard fail if the conversion fails in the future.
+        static inline bool is_field_def(mlir::Operation &op) {
+            return !mlir::isa< hl::StructDeclOp >(op);
+        }
 
-            auto field_decl = mlir::dyn_cast< hl::FieldDeclOp >(maybe_field);
+        static inline hl::FieldDeclOp as_field_def(mlir::Operation &op) {
+            auto field_decl = mlir::dyn_cast< hl::FieldDeclOp >(op);
             VAST_ASSERT(field_decl);
-            co_yield field_decl;
+            return field_decl;
         }
+
+        static inline mlir_type type_of_field(hl::FieldDeclOp def) { return def.getType(); }
+    } // namespace detail
+
+    static inline auto field_defs(hl::StructDeclOp op) {
+        return llvm::map_range(
+            llvm::make_filter_range(op.getOps(), detail::is_field_def), detail::as_field_def
+        );
     }
 
-    static inline type_generator field_types(hl::StructDeclOp op)
-    {
-        for (auto def : field_defs(op))
-            co_yield def.getType();
+    using field_def_range = decltype(field_defs(std::declval< hl::StructDeclOp >()));
+
+    static inline auto field_types(hl::StructDeclOp op) {
+        return llvm::map_range(field_defs(op), detail::type_of_field);
     }
 
+    using field_type_range = decltype(field_types(std::declval< hl::StructDeclOp >()));
+
     // TODO(hl): This is a placeholder that works in our test cases so far.
     //           In general, we will need generic resolution for scoping that
     //           will be used instead of this function.
@@ -67,18 +78,19 @@ namespace vast::hl
         return {};
     }
 
-    static inline auto type_decls(hl::StructDeclOp struct_decl)
-        -> gap::generator< hl::TypeDeclOp >
-    {
+    static inline auto type_decls(hl::StructDeclOp struct_decl) {
         auto module_op = struct_decl->getParentOfType< vast_module >();
         VAST_ASSERT(module_op);
 
-        for (auto decl : top_level_ops< hl::TypeDeclOp >(module_op))
-            if (decl.getName() == struct_decl.getName())
-                co_yield decl;
+        return llvm::make_filter_range(
+            top_level_ops< hl::TypeDeclOp >(module_op),
+            [name = struct_decl.getName()] (hl::TypeDeclOp decl) {
+                return decl.getName() == name;
+            }
+        );
     }
 
-    static inline type_generator field_types(mlir::Type t, vast_module module_op)
+    static inline field_type_range field_types(mlir::Type t, vast_module module_op)
     {
         auto def = definition_of(t, module_op);
         VAST_CHECK(def, "Was not able to fetch definition of type: {0}", t);
@@ -0,0 +1,97 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <string>
+
+namespace vast::hl
+{
+    //
+    // module_linker
+    //
+    // Merges high-level modules of translation units into one module, e.g., for
+    // whole-program queries or cross translation unit passes. Top-level
+    // operations of each linked module are moved into the destination:
+    //
+    //  - Functions and variables are resolved by name. Declarations merge into
+    //    the definition, and of two definitions the one with a weak or
+    //    link-once linkage (or a tentative variable definition) gives way.
+    //    Two strong definitions are an error.
+    //  - Internal functions and static variables stay distinct, a colliding
+    //    name gets a `.N` suffix together with all references in its module.
+    //  - Records, enums and typedefs that every module re-declares from shared
+    //    headers are kept once if they are equivalent (ignoring locations),
+    //    differing declarations of the same name are renamed as above.
+    //
+    // Modules are linked in order, the first declaration of a name wins.
+    //
+    struct module_linker
+    {
+        struct statistics
+        {
+            std::size_t modules        = 0;
+            std::size_t deduplicated   = 0;
+            std::size_t merged_symbols = 0;
+            std::size_t renamed        = 0;
+        };
+
+        explicit module_linker(vast_module dst);
+
+        // Moves the top-level operations of `src` into the destination module.
+        // Reports the failure, e.g., of a duplicate definition, on the
+        // offending operation.
+        logical_result link(vast_module src);
+
+        const statistics &stats() const { return counts; }
+
+      private:
+        // Names of one module as they were linked.
+        struct renames
+        {
+            llvm::StringMap< std::string > records, enums, typedefs, values, constants;
+
+            bool empty() const {
+                return records.empty() && enums.empty() && typedefs.empty()
+                    && values.empty() && constants.empty();
+            }
+        };
+
+        void index(operation op);
+
+        bool link_type_declaration(operation op, renames &rn);
+        logical_result link_operation(operation op, renames &rn);
+        bool link_type(
+            operation op, llvm::StringMap< operation > &defs,
+            llvm::StringMap< std::string > &renamed, renames &rn
+        );
+        void link_enum_constants(operation op, renames &rn);
+        logical_result link_value(operation op, renames &rn);
+        logical_result merge_value(operation existing, operation incoming);
+
+        void link_module_attributes(vast_module src, const renames &rn);
+
+        void move(operation op);
+
+        vast_module dst;
+
+        // Declarations of the destination by name.
+        llvm::StringSet<> record_names, enum_names;
+        llvm::StringMap< operation > records, enums, typedefs, values;
+        llvm::StringSet<> constants;
+
+        // Values of the module being linked, under their linked names.
+        llvm::StringSet<> own;
+
+        statistics counts;
+    };
+
+} // namespace vast::hl
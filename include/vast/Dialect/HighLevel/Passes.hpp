@@ -11,22 +11,61 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include <vast/Dialect/HighLevel/HighLevelDialect.hpp>
+#include <vast/Dialect/HighLevel/HighLevelOps.hpp>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace vast::hl
 {
     std::unique_ptr< mlir::Pass > createHLLowerTypesPass();
+    std::unique_ptr< mlir::Pass > createHLLowerTypesPass(bool strict_enums);
 
     std::unique_ptr< mlir::Pass > createExportFnInfoPass();
 
     std::unique_ptr< mlir::Pass > createDCEPass();
 
+    std::unique_ptr< mlir::Pass > createHLSymbolDCEPass();
+    std::unique_ptr< mlir::Pass > createHLSymbolDCEPass(llvm::ArrayRef< std::string > roots);
+
     std::unique_ptr< mlir::Pass > createLowerTypeDefsPass();
 
     std::unique_ptr< mlir::Pass > createSpliceTrailingScopes();
 
+    std::unique_ptr< mlir::Pass > createFlattenScopesPass();
+
     std::unique_ptr< mlir::Pass > createHLCanonicalizePass();
 
+    std::unique_ptr< mlir::Pass > createHLInlinePass();
+    std::unique_ptr< mlir::Pass > createHLInlinePass(bool always_inline_only);
+
+    std::unique_ptr< mlir::Pass > createHLInternalizePass();
+    std::unique_ptr< mlir::Pass > createHLInternalizePass(llvm::ArrayRef< std::string > entry_points);
+
+    // Probes of `vast-hl-instrument`.
+    struct instrument_options
+    {
+        bool functions  = false;
+        bool loops      = false;
+        bool timestamps = false;
+        std::vector< std::string > calls;
+
+        bool any() const { return functions || loops || timestamps || !calls.empty(); }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLInstrumentPass();
+    std::unique_ptr< mlir::Pass > createHLInstrumentPass(const instrument_options &opts);
+
+    std::unique_ptr< mlir::Pass > createHLFalseSharingPass();
+
+    std::unique_ptr< mlir::Pass > createHLHeapToStackPass();
+
+    std::unique_ptr< mlir::Pass > createHLFunctionAttrsPass();
+
+    std::unique_ptr< mlir::Pass > createHLPromoteIndirectCallsPass();
+
+    std::unique_ptr< mlir::Pass > createHLConstantGlobalsPass();
+
     void registerHLToLLVMIR(mlir::DialectRegistry &);
     void registerHLToLLVMIR(mlir::MLIRContext &);
 
@@ -34,10 +73,42 @@ namespace vast::hl
     #define GEN_PASS_REGISTRATION
     #include "vast/Dialect/HighLevel/Passes.h.inc"
 
-    static inline void build_simplify_hl_pipeline(mlir::PassManager &pm)
-    {
-        pm.addPass(createHLLowerTypesPass());
-        pm.addPass(createDCEPass());
+    // Without `inline_calls`, only `always_inline` functions are inlined, as
+    // clang does when not optimizing, indirect calls stay indirect and globals
+    // are loaded. With `strict_enums`, loads of enumerations assume their
+    // values are in the range of the enumeration.
+    static inline void build_simplify_hl_pipeline(
+        mlir::PassManager &pm, bool inline_calls = false, bool strict_enums = false
+    ) {
+        if (inline_calls) {
+            pm.addPass(createHLPromoteIndirectCallsPass());
+        }
+        pm.addPass(createHLInlinePass(/* always_inline_only */ !inline_calls));
+        pm.addPass(createHLSymbolDCEPass());
+        if (inline_calls) {
+            pm.addPass(createHLConstantGlobalsPass());
+        }
+        pm.addPass(createHLCanonicalizePass());
+        pm.addPass(createHLHeapToStackPass());
+        pm.addPass(createHLFunctionAttrsPass());
+        pm.addPass(createHLLowerTypesPass(strict_enums));
+        pm.nest< hl::FuncOp >().addPass(createDCEPass());
+        pm.nest< hl::FuncOp >().addPass(createFlattenScopesPass());
+        pm.addPass(createLowerTypeDefsPass());
+    }
+
+    // Passes of `build_simplify_hl_pipeline` the lowering cannot do without:
+    // `always_inline` functions are still inlined, the canonicalization adds
+    // implicit returns and folds type traits, types are lowered and code after
+    // terminators is removed, as the control flow conversion rewrites them in
+    // place.
+    static inline void build_minimal_hl_pipeline(
+        mlir::PassManager &pm, bool strict_enums = false
+    ) {
+        pm.addPass(createHLInlinePass(/* always_inline_only */ true));
+        pm.addPass(createHLCanonicalizePass());
+        pm.addPass(createHLLowerTypesPass(strict_enums));
+        pm.nest< hl::FuncOp >().addPass(createDCEPass());
         pm.addPass(createLowerTypeDefsPass());
     }
 
@@ -0,0 +1,65 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Pass/AnalysisManager.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::hl
+{
+    // Identifies top-level type declarations of the module (including their
+    // operations) and module attributes. Used by analyses that stay valid while
+    // type definitions do not change.
+    llvm::hash_code type_definitions_hash(operation mod);
+
+    //
+    // record_index
+    //
+    // Module analysis that maps record names to their top-level definitions,
+    // and field names to their indices and types, i.e., a cached equivalent of
+    // `hl::definition_of` and `hl::field_idx`. As `definition_of`, the first
+    // definition of a name wins.
+    //
+    // The index is invalidated only when type definitions change, so it remains
+    // valid during conversions that lower other operations, as erased operations
+    // are not destroyed before the conversion finishes.
+    //
+    struct record_index
+    {
+        struct field_info
+        {
+            std::size_t idx;
+            mlir_type type;
+        };
+
+        struct record_info
+        {
+            hl::StructDeclOp decl;
+            llvm::StringMap< field_info > fields;
+        };
+
+        explicit record_index(operation op);
+
+        const record_info *lookup(mlir_type record) const;
+
+        std::optional< hl::StructDeclOp > definition_of(mlir_type record) const;
+        std::optional< std::size_t > field_idx(mlir_type record, string_ref field) const;
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const;
+
+      private:
+        operation mod;
+        llvm::hash_code stamp;
+        llvm::StringMap< record_info > records;
+    };
+
+} // namespace vast::hl
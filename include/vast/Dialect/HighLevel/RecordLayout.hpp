@@ -0,0 +1,89 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <mlir/Pass/AnalysisManager.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::hl
+{
+    //
+    // Layout of a struct definition, all quantities are in bits.
+    //
+    struct record_layout
+    {
+        struct field_layout
+        {
+            mlir_type type;
+            std::uint64_t offset;
+            std::uint64_t size;
+            // Width of a bitfield.
+            std::optional< std::uint32_t > bits;
+            // Storage unit of a bitfield, zero-width bitfields have none.
+            std::optional< unsigned > unit;
+        };
+
+        // Integer through which a run of adjacent bitfields is accessed.
+        struct storage_unit
+        {
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+        std::uint64_t size  = 0;
+        std::uint64_t align = 8;
+        // Bits of the record not covered by any field.
+        std::uint64_t padding = 0;
+        // Some field is placed below its natural alignment, i.e., the record
+        // is packed.
+        bool has_unaligned_fields = false;
+
+        llvm::SmallVector< field_layout > fields;
+        // As in clang, every run of adjacent bitfields shares a storage unit
+        // of the size of the run rounded up to bytes.
+        llvm::SmallVector< storage_unit > units;
+
+        // Returns the first field that covers `offset`.
+        const field_layout *field_containing(std::uint64_t offset) const;
+    };
+
+    //
+    // record_layout_analysis
+    //
+    // Module analysis that lays out every top-level struct definition once,
+    // using the data layout entries of the module (emitted from clang). Size and
+    // alignment of a record are taken from its entry when the module has one,
+    // field offsets are computed following the target rules for natural
+    // alignment and bitfield storage units. Records that do not fit their size
+    // with natural alignment are laid out as packed.
+    //
+    // As `record_index`, the analysis is invalidated only when type
+    // definitions change.
+    //
+    struct record_layout_analysis
+    {
+        explicit record_layout_analysis(operation op);
+
+        // Accepts records wrapped in elaborated types and lvalues.
+        const record_layout *lookup(mlir_type record) const;
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const;
+
+      private:
+        operation mod;
+        llvm::hash_code stamp;
+        llvm::StringMap< record_layout > layouts;
+    };
+
+} // namespace vast::hl
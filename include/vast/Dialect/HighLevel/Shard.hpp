@@ -0,0 +1,28 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // Splits a high-level module into up to `count` self-contained modules
+    // (shards) that can be lowered independently, e.g., by separate processes
+    // of a build farm. Each function definition goes to exactly one shard, so
+    // that the shards are balanced by the number of operations. Variable
+    // definitions and other top-level operations go to the first shard.
+    //
+    // A shard holds copies of the types its definitions need, and declarations
+    // of the functions and variables defined in the other shards. Internal
+    // symbols referenced across shards become external in their shard, their
+    // names are listed in the `shard_internal_attr` of the shard modules, so
+    // that the merge of the lowered shards makes them internal again.
+    //
+    std::vector< owning_module_ref > shard_module(vast_module mod, unsigned count);
+
+    constexpr string_ref shard_internal_attr = "vast.shard.internal";
+
+} // namespace vast::hl
@@ -10,8 +10,14 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/Dialect.h>
 #include <mlir/IR/OperationSupport.h>
 #include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
 VAST_RELAX_WARNINGS
 
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 
 // Pull in the dialect definition.
 #include "vast/Dialect/Meta/MetaDialect.h.inc"
@@ -24,8 +30,43 @@ namespace vast::meta
 
     void remove_identifier(mlir::Operation *op);
 
+    // Identifier of the operation itself or else of its meta location.
+    std::optional< identifier_t > identifier_of(mlir::Operation *op);
+
     std::vector< mlir::Operation * > get_with_identifier(mlir::Operation *scope, identifier_t id);
 
     std::vector< mlir::Operation * > get_with_meta_location(mlir::Operation *scope, identifier_t id);
 
+    //
+    // Operations of a scope by their identifiers and by the identifiers of
+    // their meta locations, built by one walk of the scope. Identifiers added
+    // and removed through the index keep it up to date, so lookups in a loop,
+    // e.g., joins of external metadata, take constant time each instead of a
+    // walk. Lookups find operations in the order of the walk, those
+    // identified later after them.
+    //
+    struct identifier_index
+    {
+        explicit identifier_index(mlir::Operation *scope);
+
+        void add_identifier(mlir::Operation *op, identifier_t id);
+
+        void remove_identifier(mlir::Operation *op);
+
+        llvm::ArrayRef< mlir::Operation * > get_with_identifier(identifier_t id) const;
+
+        llvm::ArrayRef< mlir::Operation * > get_with_meta_location(identifier_t id) const;
+
+      private:
+        using operations = llvm::SmallVector< mlir::Operation *, 1 >;
+
+        static llvm::ArrayRef< mlir::Operation * > lookup(
+            const std::unordered_map< identifier_t, operations > &map, identifier_t id
+        );
+
+        // Identifiers are arbitrary, no value is reserved as a key.
+        std::unordered_map< identifier_t, operations > identified;
+        std::unordered_map< identifier_t, operations > located;
+    };
+
 } // namespace vast::meta
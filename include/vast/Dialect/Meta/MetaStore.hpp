@@ -0,0 +1,91 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace vast::meta
+{
+    //
+    // External metadata of operations, the storage that meta identifiers
+    // relate operations to. A store is a file of opaque blobs keyed by
+    // identifiers, sorted by them, so that it is mapped into memory and
+    // looked up in place without being parsed or copied into the module.
+    //
+    // Layout, little endian:
+    //   "VASTMETA", version, flags, number of entries, size of the blobs
+    //   entries of { identifier, offset of the blob, size of the blob }
+    //   blobs
+    //
+    struct store;
+
+    struct store_builder
+    {
+        // A later blob of the same identifier replaces the former one.
+        void add(identifier_t id, string_ref blob);
+
+        // Adds all blobs of an existing store, e.g., to update it.
+        void add(const store &from);
+
+        void add(const store_builder &from);
+
+        void write(llvm::raw_ostream &os) const;
+
+        std::size_t size() const { return blobs.size(); }
+
+      private:
+        std::map< identifier_t, std::string > blobs;
+    };
+
+    struct store
+    {
+        static std::optional< store > open(string_ref path, std::string *err);
+
+        std::optional< string_ref > lookup(identifier_t id) const;
+
+        std::size_t size() const;
+
+        // Blobs in the order of their identifiers.
+        void for_each(std::function< void(identifier_t, string_ref) > yield) const;
+
+        //
+        // Joins the store with operations of a scope: yields every operation
+        // identified by or located at an identifier of the store, together
+        // with its blob. Each entry is looked up in the index in constant
+        // time, operations of an identifier follow the order of the index.
+        //
+        void for_each_attached(
+            const identifier_index &index,
+            std::function< void(mlir::Operation *, identifier_t, string_ref) > yield
+        ) const;
+
+      private:
+        explicit store(std::unique_ptr< llvm::MemoryBuffer > buffer)
+            : buffer(std::move(buffer))
+        {}
+
+        bool verify(std::string *err) const;
+
+        std::uint64_t read64(std::size_t offset) const;
+
+        identifier_t id_at(std::size_t entry) const;
+        string_ref blob_at(std::size_t entry) const;
+
+        std::unique_ptr< llvm::MemoryBuffer > buffer;
+    };
+
+} // namespace vast::meta
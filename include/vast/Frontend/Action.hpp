@@ -101,6 +101,15 @@ namespace vast::cc {
         virtual void anchor();
     };
 
+    //
+    // Emit LLVM bitcode, with a module summary for ThinLTO
+    //
+    struct emit_bc_action : vast_stream_action {
+        explicit emit_bc_action(const vast_args &vargs);
+    private:
+        virtual void anchor();
+    };
+
     //
     // Emit MLIR
     //
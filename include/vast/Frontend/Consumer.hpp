@@ -7,15 +7,25 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTConsumer.h>
 #include <clang/CodeGen/BackendUtil.h>
+#include <llvm/ADT/StringSet.h>
+#include <mlir/Pass/PassManager.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Frontend/CostReport.hpp"
 #include "vast/Frontend/Diagnostics.hpp"
+#include "vast/Frontend/Fallback.hpp"
 #include "vast/Frontend/FrontendAction.hpp"
 #include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/Remarks.hpp"
+#include "vast/Frontend/Retarget.hpp"
 
 #include "vast/CodeGen/CodeGenContext.hpp"
 #include "vast/CodeGen/CodeGenDriver.hpp"
 
+#include "vast/Util/MemoryReport.hpp"
+
+#include <mutex>
+
 namespace vast::cc {
 
     using output_stream_ptr = std::unique_ptr< llvm::raw_pwrite_stream >;
@@ -27,6 +37,12 @@ namespace vast::cc {
 
     using backend = clang::BackendAction;
 
+    // Hands over a context with dialects already loaded, e.g., by a warm compile
+    // server. The next consumer to initialize adopts it instead of creating and
+    // populating a fresh one. The context is handed over to the consumers of
+    // the calling thread.
+    void preload_mcontext(std::unique_ptr< mcontext_t > mctx);
+
     struct vast_consumer : clang_ast_consumer
     {
         vast_consumer(action_options opts, const vast_args &vargs)
@@ -41,7 +57,7 @@ namespace vast::cc {
 
         void HandleInlineFunctionDefinition(clang::FunctionDecl * /* decl */) override;
 
-        void HandleInterestingDecl(clang::DeclGroupRef /* decl */) override;
+        void HandleInterestingDecl(clang::DeclGroupRef decls) override;
 
         void HandleTranslationUnit(acontext_t &acontext) override;
 
@@ -65,6 +81,10 @@ namespace vast::cc {
 
         void compile_via_vast(vast_module mod, mcontext_t *mctx);
 
+        // With `-vast-start-from=<checkpoint>` the module is read from a
+        // checkpoint of the lowering instead of being generated.
+        bool resuming() const { return vargs.has_option(opt::start_from); }
+
         virtual void anchor() {}
 
         action_options opts;
@@ -80,6 +100,20 @@ namespace vast::cc {
         std::unique_ptr< mcontext_t > mctx = nullptr;
         std::unique_ptr< cg::codegen_context > cgctx = nullptr;
         std::unique_ptr< cg::codegen_driver > codegen = nullptr;
+
+        // Samples of `-vast-memory-report`, null without it.
+        std::unique_ptr< memory_report > memory = nullptr;
+
+        // Remarks of vast passes, null without `-Rpass*` and
+        // `-fsave-optimization-record`.
+        std::unique_ptr< remark_consumer > remarks = nullptr;
+
+        // Codegen of clang for the functions vast does not compile, null
+        // without `-vast-clang-fallback` and its budgets.
+        std::unique_ptr< clang_fallback > fallback = nullptr;
+
+        // Features and phase times of `-vast-cost-report`, null without it.
+        std::unique_ptr< cost_report > cost = nullptr;
     };
 
     struct vast_stream_consumer : vast_consumer {
@@ -91,9 +125,58 @@ namespace vast::cc {
             : base(std::move(opts), vargs), action(act), output_stream(std::move(os))
         {}
 
+        bool HandleTopLevelDecl(clang::DeclGroupRef decls) override;
+
         void HandleTranslationUnit(acontext_t &acontext) override;
 
+        void retarget(std::unique_ptr< retargeting > variants) {
+            retargets = std::move(variants);
+        }
+
       private:
+        //
+        // Streaming of high-level mlir (-vast-stream-mlir)
+        //
+        // Every completed top-level operation is printed right after the
+        // top-level declaration that produced it is handled. A function is
+        // run through the function passes of vast and verified first, and its
+        // body is released once printed, so the module keeps only shells of
+        // the printed definitions. The module is still finalized as a whole,
+        // and operations that were not printed by then are printed at the end.
+        // Operations are tracked by their kind and symbol name, as codegen may
+        // still replace them.
+        //
+        bool streaming() const;
+
+        void stream_module_header();
+        void stream_completed_ops();
+        void stream_remaining_ops();
+        void stream_op(operation op, string_ref key);
+        void print_streamed_op(operation op);
+
+        mlir::OpPrintingFlags stream_printing_flags() const;
+
+        bool stream_header_emitted = false;
+        std::string last_streamed;
+        llvm::StringSet<> streamed;
+        // Operations that can be still completed by later declarations, e.g.,
+        // function declarations followed by a definition.
+        llvm::StringSet<> postponed;
+        std::unique_ptr< mlir::PassManager > stream_passes;
+
+        //
+        // Release of the clang AST once the module is emitted
+        // (-vast-clear-ast-before-lowering or clang's -clear-ast-before-backend)
+        //
+        // Lowering does not look at the AST anymore. As in clang's codegen,
+        // only the memory of the AST allocator is released, the source
+        // manager, target info and identifiers stay valid for diagnostics.
+        //
+        bool clear_ast_before_lowering() const;
+        void clear_ast(acontext_t &actx);
+
+        owning_module_ref load_checkpoint();
+
         void emit_backend_output(
             backend backend_action, owning_module_ref mlir_module, mcontext_t *mctx
         );
@@ -102,6 +185,19 @@ namespace vast::cc {
             target_dialect target, owning_module_ref mod, mcontext_t *mctx
         );
 
+        //
+        // Variants of the module for other targets (-vast-retarget), see
+        // `retargeting`. The dependence on the target is decided while the
+        // AST is alive, the variants are lowered after the module.
+        //
+        logical_result emit_variant(
+            backend backend_action, const target_variant &variant, owning_module_ref mod,
+            std::mutex &diags_lock
+        );
+
+        std::unique_ptr< retargeting > retargets;
+        std::vector< const target_variant * > retargeted;
+
         output_type action;
         output_stream_ptr output_stream;
     };
@@ -0,0 +1,117 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTConsumer.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    // Size of a translation unit as parsed, all of its headers included.
+    struct tu_features
+    {
+        std::uint64_t decls = 0;
+        // Definitions of functions, records and variables.
+        std::uint64_t functions = 0;
+        std::uint64_t records = 0;
+        std::uint64_t globals = 0;
+        // Statements and expressions of function bodies and initializers.
+        std::uint64_t statements = 0;
+        std::uint64_t max_function_statements = 0;
+
+        static tu_features collect(acontext_t &actx);
+
+        void for_each(auto &&yield) const {
+            yield("decls", decls);
+            yield("functions", functions);
+            yield("records", records);
+            yield("globals", globals);
+            yield("statements", statements);
+            yield("max_function_statements", max_function_statements);
+        }
+    };
+
+    //
+    // Linear model of the milliseconds a compilation takes, a coefficient per
+    // feature and an intercept. The built-in coefficients are rough, a model
+    // fitted by `scripts/cost_model.py` to measured compilations is read by
+    // -vast-cost-model=<file>.
+    //
+    struct cost_model
+    {
+        static cost_model load(const vast_args &vargs);
+
+        double predict(const tu_features &features) const;
+
+        double intercept = 5.0;
+        llvm::StringMap< double > coefficients;
+    };
+
+    //
+    // Estimate of the cost of a translation unit for build schedulers
+    // (-vast-cost-report[=<file>], -vast-estimate-cost)
+    //
+    // The features of the parsed unit and the estimate of the model are
+    // written as JSON next to the output, `<output>.cost.json` by default.
+    // A full compilation adds the measured milliseconds of its phases, the
+    // data to fit a model to. `-vast-estimate-cost` stops after parsing and
+    // writes the report only.
+    //
+    struct cost_report
+    {
+        using clock = std::chrono::steady_clock;
+
+        static std::unique_ptr< cost_report > create(const action_options &opts, const vast_args &vargs);
+
+        // Ends the phase that started with the previous one.
+        void phase(string_ref name);
+
+        // Collects the features, the time it takes belongs to no phase.
+        void parsed(acontext_t &actx);
+
+        void write() const;
+
+      private:
+        cost_report(const action_options &opts, std::string path, cost_model model);
+
+        const action_options &opts;
+        std::string path;
+        cost_model model;
+
+        std::optional< tu_features > features;
+
+        clock::time_point start;
+        clock::time_point last;
+        std::vector< std::pair< std::string, clock::duration > > phases;
+    };
+
+    // Consumer of `-vast-estimate-cost`, nothing is generated.
+    struct cost_estimate_consumer : clang::ASTConsumer
+    {
+        cost_estimate_consumer(action_options opts, const vast_args &vargs)
+            : opts(std::move(opts)), report(cost_report::create(this->opts, vargs))
+        {}
+
+        void HandleTranslationUnit(acontext_t &actx) override;
+
+      private:
+        // The report refers to the options.
+        action_options opts;
+        std::unique_ptr< cost_report > report;
+    };
+
+} // namespace vast::cc
@@ -0,0 +1,91 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/GlobalDecl.h>
+#include <clang/CodeGen/ModuleBuilder.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    //
+    // Compilation of functions by clang's codegen instead of vast
+    // (-vast-clang-fallback, -vast-fallback-max-ops=<n>,
+    // -vast-fallback-max-time=<ms>)
+    //
+    // The AST is given to clang's codegen next to vast's. Once the high-level
+    // module is emitted, functions vast does not handle become declarations
+    // in it: functions with an `unsup` operation, with more operations than
+    // the budget, or whose emission took longer than the budget of time.
+    // Their definitions from clang's module are linked into the llvm module
+    // of vast, together with the internal declarations they refer to.
+    // Internal symbols both modules define are shared: the one of vast is
+    // renamed and exported for the link, so that a `static` variable keeps a
+    // single copy, and made internal again once the modules are linked.
+    //
+    struct clang_fallback
+    {
+        using clock = std::chrono::steady_clock;
+
+        static std::unique_ptr< clang_fallback > create(
+            const action_options &opts, const vast_args &vargs
+        );
+
+        // The consumer building clang's module, fed by the vast consumer.
+        clang::ASTConsumer &consumer() { return *codegen; }
+
+        // Emission of the function bodies of a declaration group by vast.
+        void measured(clang::DeclGroupRef decls, clock::duration time);
+
+        // Drops the bodies of the functions compiled by clang, returns their
+        // number. Runs once the module is emitted, before the lowering.
+        std::size_t select(vast_module mod);
+
+        // Links definitions of the selected functions into `mod`.
+        logical_result link(llvm::Module &mod);
+
+      private:
+        clang_fallback(
+            const action_options &opts, std::optional< std::int64_t > max_ops,
+            std::optional< clock::duration > max_time
+        );
+
+        bool over_budget(operation fn) const;
+
+        // Prefers the symbols of vast to internal copies of clang's module,
+        // returns the names the shared symbols are exported under.
+        std::vector< std::string > share_internals(llvm::Module &dst, llvm::Module &src);
+
+        const action_options &opts;
+
+        std::optional< std::int64_t > max_ops;
+        std::optional< clock::duration > max_time;
+
+        std::unique_ptr< llvm::LLVMContext > llvm_context;
+        std::unique_ptr< clang::CodeGenerator > codegen;
+
+        // Symbols of functions whose emission was over the time budget.
+        llvm::StringSet<> slow;
+
+        // Symbols of the selected functions, with the ones that were internal.
+        llvm::StringSet<> selected;
+        llvm::StringSet<> internal;
+    };
+
+} // namespace vast::cc
@@ -20,6 +20,7 @@ namespace vast::cc {
         emit_assembly,
         emit_mlir,
         emit_llvm,
+        emit_bc,
         emit_obj,
         none
     };
@@ -32,7 +33,8 @@ namespace vast::cc {
             .lang    = ci.getLangOpts(),
             .front   = ci.getFrontendOpts(),
             .diags   = ci.getDiagnostics(),
-            .vfs     = ci.getVirtualFileSystem()
+            .vfs     = ci.getVirtualFileSystem(),
+            .pp      = ci.getPreprocessorOpts()
         };
     }
 
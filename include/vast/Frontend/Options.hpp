@@ -10,6 +10,7 @@ VAST_RELAX_WARNINGS
 #include <clang/Basic/LangOptions.h>
 #include <clang/Basic/TargetInfo.h>
 #include <clang/Frontend/FrontendOptions.h>
+#include <clang/Lex/PreprocessorOptions.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
@@ -27,6 +28,7 @@ namespace vast::cc
     using target_options        = clang::TargetOptions;
     using language_options      = clang::LangOptions;
     using frontend_options      = clang::FrontendOptions;
+    using preprocessor_options  = clang::PreprocessorOptions;
 
     using diagnostics_engine    = clang::DiagnosticsEngine;
 
@@ -40,8 +42,13 @@ namespace vast::cc
         const frontend_options &front;
         diagnostics_engine &diags;
         virtual_file_system &vfs;
+        const preprocessor_options &pp;
     };
 
+    // Path of a report next to the output, or to the input if the output is
+    // a stream, with the `extension`, e.g., `a.o` gives `a.cost.json`.
+    std::string report_path(const action_options &opts, string_ref extension);
+
     constexpr string_ref vast_option_prefix = "-vast-";
 
     struct vast_args
@@ -67,23 +74,76 @@ namespace vast::cc
 
     std::pair< vast_args, argv_storage > filter_args(const argv_storage_base &args);
 
+    // Names of a list option, separated by `;` or `,`.
+    std::vector< std::string > parse_names(const vast_args &vargs, string_ref option);
+
     namespace opt {
         constexpr string_ref emit_llvm = "emit-llvm";
         constexpr string_ref emit_obj  = "emit-obj";
+        constexpr string_ref emit_bc   = "emit-bc";
+        constexpr string_ref embed_hl  = "embed-hl";
         constexpr string_ref emit_asm  = "emit-asm";
 
         constexpr string_ref emit_mlir = "emit-mlir";
+        constexpr string_ref emit_mlir_bytecode = "emit-mlir-bytecode";
+        constexpr string_ref stream_mlir = "stream-mlir";
 
         constexpr string_ref show_locs = "show-locs";
         constexpr string_ref locs_as_meta_ids = "locs-as-meta-ids";
+        constexpr string_ref locs = "locs";
 
 
         constexpr string_ref opt_pipeline  = "pipeline";
 
         constexpr string_ref disable_vast_verifier = "disable-vast-verifier";
         constexpr string_ref vast_verify_diags = "verify-diags";
+        constexpr string_ref verify = "verify";
         constexpr string_ref disable_emit_cxx_default = "disable-emit-cxx-default";
 
+        constexpr string_ref cache_dir = "cache-dir";
+        constexpr string_ref remote_cache = "remote-cache";
+        constexpr string_ref function_cache = "function-cache";
+        constexpr string_ref hl_header_cache = "hl-header-cache";
+
+        constexpr string_ref stop_after = "stop-after";
+        constexpr string_ref start_from = "start-from";
+
+        constexpr string_ref verify_threads = "verify-threads";
+        constexpr string_ref backend_threads = "backend-threads";
+        constexpr string_ref translate_threads = "translate-threads";
+        constexpr string_ref emit_decls_only = "emit-decls-only";
+        constexpr string_ref lazy_function_bodies = "lazy-function-bodies";
+        constexpr string_ref emit_reachable_from = "emit-reachable-from";
+        constexpr string_ref codegen_report = "codegen-report";
+        constexpr string_ref elide_unsupported = "elide-unsupported";
+
+        constexpr string_ref pass_timing = "pass-timing";
+        constexpr string_ref pass_statistics = "pass-statistics";
+        constexpr string_ref ir_size_report = "ir-size-report";
+        constexpr string_ref pattern_profile = "pattern-profile";
+        constexpr string_ref trace = "trace";
+        constexpr string_ref memory_report = "memory-report";
+        constexpr string_ref clear_ast_before_lowering = "clear-ast-before-lowering";
+
+        constexpr string_ref raise_loops = "raise-loops";
+        constexpr string_ref rotate_loops = "rotate-loops";
+
+        constexpr string_ref instrument = "instrument";
+        constexpr string_ref instrument_calls = "instrument-calls";
+
+        constexpr string_ref warn_false_sharing = "warn-false-sharing";
+
+        constexpr string_ref retarget = "retarget";
+
+        constexpr string_ref clang_fallback = "clang-fallback";
+        constexpr string_ref fallback_max_ops = "fallback-max-ops";
+        constexpr string_ref fallback_max_time = "fallback-max-time";
+
+        constexpr string_ref cost_report = "cost-report";
+        constexpr string_ref cost_model = "cost-model";
+        constexpr string_ref estimate_cost = "estimate-cost";
+        constexpr string_ref stack_usage = "stack-usage";
+
         bool emit_only_mlir(const vast_args &vargs);
         bool emit_only_llvm(const vast_args &vargs);
     } // namespace opt
@@ -0,0 +1,55 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/Diagnostic.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <mutex>
+#include <optional>
+
+namespace vast::cc {
+
+    //
+    // Parallel object emission (-vast-backend-threads=N)
+    //
+    // The llvm module is split into partitions, local symbols are externalized
+    // with hidden visibility so that references among partitions resolve.
+    // Each partition is optimized and emitted by clang's backend in its own
+    // llvm context, and the objects are combined into one by a relocatable
+    // link of the system linker.
+    //
+
+    // Diagnostics of backends running concurrently, e.g., of the partitions,
+    // reported to the consumer of the compilation one at a time.
+    struct serialized_diagnostics : clang::DiagnosticConsumer {
+        serialized_diagnostics(clang::DiagnosticConsumer *client, std::mutex &lock)
+            : client(client), lock(lock)
+        {}
+
+        void HandleDiagnostic(
+            clang::DiagnosticsEngine::Level level, const clang::Diagnostic &info
+        ) override;
+
+        clang::DiagnosticConsumer *client;
+        std::mutex &lock;
+    };
+
+    // Linker able of `-r`, if there is any.
+    std::optional< std::string > find_relocatable_linker();
+
+    logical_result emit_parallel_object(
+        const action_options &opts, string_ref data_layout, llvm::Module &mod,
+        unsigned partitions, string_ref linker, llvm::raw_pwrite_stream &os,
+        std::mutex &diags_lock
+    );
+
+} // namespace vast::cc
@@ -0,0 +1,82 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+#include <llvm/Remarks/RemarkSerializer.h>
+#include <llvm/Support/Regex.h>
+#include <llvm/Support/ToolOutputFile.h>
+#include <mlir/IR/Diagnostics.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Remarks.hpp"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace vast::cc {
+
+    //
+    // Remarks of vast passes (-Rpass=<regex>, -Rpass-missed=<regex>,
+    // -Rpass-analysis=<regex> and -fsave-optimization-record)
+    //
+    // Remarks of passes whose names match the pattern of their kind are
+    // reported as clang remarks at their source locations. All remarks of
+    // the passes of `-foptimization-record-passes=<regex>` are recorded in
+    // the file of the optimization record, in the format of LLVM remarks.
+    //
+    struct remark_consumer
+    {
+        remark_consumer(
+            const codegen_options &opts, diagnostics_engine &diags, const clang::SourceManager &sm
+        );
+
+        ~remark_consumer();
+
+        static bool enabled(const codegen_options &opts);
+
+        // Takes remarks of vast passes, other diagnostics are left to the
+        // other handlers. Remarks come from the threads of the passes.
+        logical_result handle(mlir::Diagnostic &diag);
+
+        //
+        // The consumer handles remarks of `mctx` for the lifetime of the scope,
+        // ahead of the handlers registered before the scope. Without a
+        // consumer, remarks of vast passes are dropped, so that handlers that
+        // print diagnostics of mlir do not report them unasked.
+        //
+        struct scope
+        {
+            scope(remark_consumer *consumer, mcontext_t *mctx);
+            ~scope();
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+          private:
+            mcontext_t *mctx;
+            mlir::DiagnosticEngine::HandlerID id = 0;
+        };
+
+      private:
+        void report(const remarks::remark_info &info, mlir::Location loc);
+        void record(const remarks::remark_info &info, mlir::Location loc);
+
+        const codegen_options &opts;
+        diagnostics_engine &diags;
+        const clang::SourceManager &sm;
+
+        std::mutex lock;
+
+        std::unique_ptr< llvm::ToolOutputFile > record_file;
+        std::unique_ptr< llvm::remarks::RemarkSerializer > serializer;
+        std::optional< llvm::Regex > record_passes;
+    };
+
+} // namespace vast::cc
@@ -0,0 +1,151 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Lex/PPCallbacks.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    //
+    // Lowering of one high-level module for several targets
+    // (-vast-retarget=<triple>[,<triple>...])
+    //
+    // The source is parsed and its high-level module emitted once, for the
+    // target of the compilation. The module is then cloned for every triple
+    // of the option, given the triple, and lowered and emitted for it in
+    // parallel, into the output of the compilation with the triple before its
+    // extension, e.g., `a.aarch64-linux-gnu.o` next to `a.o`.
+    //
+    // A module is retargeted only if nothing the source was compiled from
+    // differs between the targets:
+    //   - the vendor, the system, the environment and the object format,
+    //   - predefined macros the source expands or tests, e.g., `__x86_64__`
+    //     or `__SIZEOF_LONG__`, and the target builtins it tests,
+    //   - layouts of the builtin types the module refers to, and with them
+    //     `sizeof` and `_Alignof` folded into constant expressions,
+    //   - the signedness of `char`, the layout of bit-fields, of `va_list`
+    //     and the types of wide literals, if the source uses them,
+    //   - inline assembly, builtins of the target and `target` attributes.
+    // Otherwise the source is compiled again for the triple, as if by a
+    // compilation of its own.
+    //
+
+    // Names of the predefined macros the source refers to, and of the
+    // undefined ones it tests, which another target may define.
+    struct macro_references : clang::PPCallbacks
+    {
+        explicit macro_references(const clang::SourceManager &sm) : sm(sm) {}
+
+        void MacroExpands(
+            const clang::Token &name, const clang::MacroDefinition &def,
+            clang::SourceRange range, const clang::MacroArgs *args
+        ) override;
+
+        void Defined(
+            const clang::Token &name, const clang::MacroDefinition &def, clang::SourceRange range
+        ) override;
+
+        void Ifdef(
+            clang::SourceLocation loc, const clang::Token &name, const clang::MacroDefinition &def
+        ) override;
+
+        void Ifndef(
+            clang::SourceLocation loc, const clang::Token &name, const clang::MacroDefinition &def
+        ) override;
+
+        void Elifdef(
+            clang::SourceLocation loc, const clang::Token &name, const clang::MacroDefinition &def
+        ) override;
+
+        void Elifndef(
+            clang::SourceLocation loc, const clang::Token &name, const clang::MacroDefinition &def
+        ) override;
+
+        using clang::PPCallbacks::Elifdef;
+        using clang::PPCallbacks::Elifndef;
+
+        llvm::StringSet<> names;
+
+      private:
+        void reference(const clang::Token &name, const clang::MacroDefinition &def);
+
+        const clang::SourceManager &sm;
+    };
+
+    // Definitions of the predefined macros by their names.
+    using predefined_macros = llvm::StringMap< std::string >;
+
+    struct target_variant
+    {
+        llvm::Triple triple;
+        // Options of the compilation of its own, writing the output of the
+        // variant.
+        std::shared_ptr< clang::CompilerInvocation > invocation;
+        // Target and preprocessor of the invocation, created for their
+        // queries only.
+        std::unique_ptr< compiler_instance > probe;
+        predefined_macros macros;
+
+        string_ref output() const { return probe->getFrontendOpts().OutputFile; }
+
+        const clang::TargetInfo &target() const { return probe->getTarget(); }
+
+        const clang::LangOptions &lang() const { return probe->getLangOpts(); }
+    };
+
+    // Facts of the translation unit the variants are decided by.
+    struct target_code;
+
+    struct retargeting
+    {
+        // Variants of the triples of `-vast-retarget`, the preprocessor of
+        // `ci` is set to record the macros of the source.
+        static std::unique_ptr< retargeting > create(compiler_instance &ci, const vast_args &vargs);
+
+        // Variants the module is lowered for. The others are handed over to
+        // `take_fallbacks`. The AST has to be still alive.
+        std::vector< const target_variant * > plan(acontext_t &actx, vast_module mod);
+
+        std::vector< target_variant > variants;
+
+      private:
+        std::optional< std::string > dependence(
+            const target_variant &variant, const target_code &code,
+            acontext_t &actx, vast_module mod
+        ) const;
+
+        // Owned by the preprocessor of the compilation.
+        macro_references *references = nullptr;
+        predefined_macros macros;
+        bool precompiled = false;
+    };
+
+    // Module of `mod` for the triple, its data layout entries are kept, as
+    // they agree for retargeted modules.
+    owning_module_ref retarget_module(vast_module mod, const llvm::Triple &triple);
+
+    // Invocations of the variants that depend on the target, compiled after
+    // the compilation by the driver. Per thread, as the module context.
+    std::vector< std::shared_ptr< clang::CompilerInvocation > > take_fallbacks();
+
+    // Options of the compilations of the fallbacks.
+    vast_args without_retarget(const vast_args &vargs);
+
+} // namespace vast::cc
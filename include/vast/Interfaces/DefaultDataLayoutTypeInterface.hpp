@@ -18,6 +18,8 @@ namespace vast
     // Shared utility by `DefaultDataLayoutTypeInterface` to correctly
     // filter data layout entries. Once one is selected it will be casted
     // to `DLEntry` and passed `extract` to produce resulting value.
+    // Keys of a data layout spec are unique (DLTI verifies it), so the first
+    // match is the only one. `mlir::DataLayout` caches the results per type.
     // TODO(interface): Return can be generic based on what `extract` returns.
     template< typename ConcreteType, typename Interface, typename Extract >
     unsigned default_dl_query(const Interface &self, Extract &&extract,
@@ -26,29 +28,14 @@ namespace vast
     {
         VAST_CHECK(entries.size() != 0, "Data layout query did not match to any dl entry!");
 
-        std::optional< unsigned > out;
-        auto handle_entry = [&](const auto &entry)
-        {
-            auto current = extract(entry);
-            if (!out)
-                out = current;
-
-            VAST_CHECK(*out == current,
-                       "Inconsistent entries {0} != {1}, total number of entries",
-                       *out, current, entries.size());
-        };
-
         auto casted_self = static_cast< const ConcreteType & >(self);
         for (const auto &entry : entries)
         {
-            auto raw = dl::DLEntry(entry);
-            if (casted_self == raw.type)
-                handle_entry(raw);
+            if (mlir::dyn_cast< mlir_type >(entry.getKey()) == casted_self)
+                return extract(dl::DLEntry(entry));
         }
 
-        VAST_CHECK(out.has_value(), "Data layout query of {0} did not produce a value!",
-                   casted_self);
-        return *out;
+        VAST_UNREACHABLE("Data layout query of {0} did not produce a value!", casted_self);
     }
 
 } // namespace vast
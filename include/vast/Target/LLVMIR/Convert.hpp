@@ -4,13 +4,16 @@
 
 #include "vast/Util/Warnings.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/PassInstrumentation.hpp"
 
 VAST_RELAX_WARNINGS
 #include <mlir/IR/DialectRegistry.h>
 VAST_UNRELAX_WARNINGS
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace llvm
 {
@@ -30,7 +33,9 @@ namespace vast::target::llvmir
     enum class pipeline : uint32_t
     {
         baseline = 0,
-        with_abi = 1
+        with_abi = 1,
+        // Only the passes the lowering depends on, for unoptimized builds.
+        fast     = 2
     };
 
     static inline pipeline default_pipeline()
@@ -38,16 +43,104 @@ namespace vast::target::llvmir
         return pipeline::baseline;
     }
 
+    // Unoptimized builds take the fast pipeline, the optimizations of the
+    // baseline one are enabled by `lowering_options` of the level.
+    static inline pipeline default_pipeline(unsigned optimization_level)
+    {
+        return optimization_level == 0 ? pipeline::fast : pipeline::baseline;
+    }
+
+    // Checkpoints of the lowering pipeline, in order of their passes. The
+    // `abi` stage is a part of the `with_abi` pipeline only.
+    enum class pipeline_stage : uint32_t
+    {
+        simplify = 0,
+        abi      = 1,
+        to_ll    = 2,
+        to_llvm  = 3
+    };
+
+    std::optional< pipeline_stage > parse_pipeline_stage(string_ref name);
+    string_ref to_string(pipeline_stage stage);
+
+    // Module attribute of a module lowered up to a stage, e.g., by
+    // `-vast-stop-after=<stage>`. `lower_hl_module` resumes after the stage.
+    constexpr string_ref checkpoint_attr = "vast.checkpoint";
+
+    struct lowering_options
+    {
+        // Emit type-based alias analysis tags, as clang does when optimizing
+        // without `-fno-strict-aliasing`.
+        bool strict_aliasing = false;
+        // Emit lifetime markers of scoped locals, as clang does when optimizing.
+        bool lifetime_markers = false;
+        // Signed overflow is undefined, as it is without `-fwrapv`.
+        bool signed_overflow_undefined = false;
+        // Mark scalar parameters `noundef`, as clang does unless disabled.
+        bool noundef_params = false;
+        // Emit value ranges of `bool` loads, as clang does when optimizing.
+        bool value_ranges = false;
+        // Value ranges of enumerations apply to their loads (`-fstrict-enums`).
+        bool strict_enums = false;
+        // Keep scalar locals in SSA values instead of allocas.
+        bool promote_vars = false;
+        // Inline small functions, not only `always_inline` ones.
+        bool inline_functions = false;
+        // Raise counted loops to `scf.for` before lowering them.
+        bool raise_loops = false;
+        // Lower loops tested at their end, after a guard, see `vast-hl-to-ll-cf`.
+        bool rotate_loops = false;
+        // Convert loops of OpenMP worksharing directives to `omp.wsloop`.
+        bool openmp = false;
+        // TLS model of `-ftls-model`, empty for the general dynamic one.
+        std::string tls_model;
+        // Infer `dso_local` of symbols from the relocation model, as clang does.
+        bool dso_local = false;
+        // Relocation model is not static.
+        bool pic = false;
+        // Position independent executable (`-fpie`).
+        bool pie = false;
+        // `-fsemantic-interposition`.
+        bool semantic_interposition = false;
+        // `-fno-plt`.
+        bool no_plt = false;
+        // `-fdirect-access-external-data`.
+        bool direct_access_external_data = false;
+        // Return large records through an `sret` pointer, as clang does.
+        bool return_slots = false;
+        // Probes of `-vast-instrument`, see `vast-hl-instrument`: counts of
+        // entries of functions, of iterations of loops, of calls of the listed
+        // functions, and cycles spent in functions.
+        bool instrument_functions  = false;
+        bool instrument_loops      = false;
+        bool instrument_timestamps = false;
+        std::vector< std::string > instrument_calls;
+        // Directory of lowered functions by their structural hash, see
+        // `function_cache`. No caching if empty.
+        std::string function_cache;
+        // Emit line tables, as clang does with `-g` or `-gline-tables-only`.
+        // Without them, locations are stripped before the translation.
+        bool line_tables = true;
+        // Stage to stop the lowering after, the module is then marked by the
+        // `checkpoint_attr`. The whole pipeline runs without one.
+        std::optional< pipeline_stage > stop_after;
+    };
+
     // Lower module into `llvm::Module` - it is expected that `mlir_module` is already
     // lowered as much as possible by vast (for example by calling the `prepare_module`
-    // function).
+    // function). With more than one thread, function bodies are translated in
+    // parallel, see `translate_parallel`.
     std::unique_ptr< llvm::Module > translate(
-        vast_module mlir_module, llvm::LLVMContext &llvm_ctx
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx, unsigned threads = 1
     );
 
     // Run all passes needed to go from a product of vast frontend (module in `hl` dialect)
     // to a module in lowest representation (mostly LLVM dialect right now).
-    void lower_hl_module(mlir::Operation *op, pipeline p);
+    // A module with the `checkpoint_attr` runs only the stages after it.
+    void lower_hl_module(
+        mlir::Operation *op, pipeline p, const pass_manager_config &config = {},
+        const lowering_options &opts = {}
+    );
 
     static inline void lower_hl_module(mlir::Operation *op)
     {
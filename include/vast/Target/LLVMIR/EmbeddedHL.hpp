@@ -0,0 +1,51 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/MemoryBufferRef.h>
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+    class Module;
+} // namespace llvm
+
+namespace vast::target::llvmir
+{
+    //
+    // High-level modules embedded into objects by `-vast-embed-hl`. Each
+    // module is serialized as bytecode in a frame of its own, so that the
+    // sections of objects concatenated by a linker split back into their
+    // modules.
+    //
+    // Frame, little endian:
+    //   "VASTHLBC", size of the bytecode, bytecode
+    //
+    string_ref embedded_hl_section(const llvm::Triple &triple);
+
+    // The frame of `mod`, taken before the module is lowered.
+    std::string serialize_hl_module(vast_module mod);
+
+    // Adds the frame into the section of the target of `llvm_mod`, the global
+    // is kept by the linker.
+    void embed_hl_module(llvm::Module &llvm_mod, string_ref frame);
+
+    bool is_object_file(llvm::MemoryBufferRef buffer);
+
+    // Modules embedded in the object in `buffer`, in the order of their
+    // frames, an object without the section has none.
+    std::optional< std::vector< owning_module_ref > > extract_hl_modules(
+        llvm::MemoryBufferRef buffer, mcontext_t &mctx, std::string *err
+    );
+
+} // namespace vast::target::llvmir
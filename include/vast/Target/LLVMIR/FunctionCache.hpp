@@ -0,0 +1,63 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <mlir/IR/Block.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Target/LLVMIR/Convert.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <string>
+
+namespace vast::target::llvmir
+{
+    //
+    // Cache of lowered functions (-vast-function-cache=<dir>)
+    //
+    // Each externally visible function is keyed by a structural hash of its
+    // high-level body, of the declarations it refers to (types, globals and
+    // the callees), of the module attributes and of the lowering
+    // configuration. When calls are inlined, the callees are followed
+    // transitively, and functions that reach an indirect call or a static
+    // global are not cached, as the simplification decides about those from
+    // the whole module. Bodies of functions with a cached
+    // lowering are dropped before the lowering, so only their declarations go
+    // through the pipelines, and their cached `llvm.func` bodies are moved in
+    // afterwards. Lowered functions that refer only to symbols of the
+    // high-level module are stored for the next compilation.
+    //
+    struct function_cache
+    {
+        function_cache(string_ref dir, pipeline p, const lowering_options &opts);
+
+        // To be run on the high-level module, before the lowering.
+        void drop_cached_bodies(vast_module mod);
+
+        // To be run on the lowered module.
+        void restore_cached_bodies(vast_module mod);
+
+      private:
+        std::unique_ptr< mlir::Block > load(mcontext_t *mctx, string_ref key) const;
+        void store(string_ref key, operation fn) const;
+        std::string entry(string_ref key) const;
+
+        std::string dir;
+        std::string config;
+        bool inlines;
+
+        // Top-level symbols of the high-level module.
+        llvm::StringSet<> known;
+        // Cached lowering of functions with a dropped body, by name.
+        llvm::StringMap< std::unique_ptr< mlir::Block > > hits;
+        // Keys of functions lowered anew, by name.
+        llvm::StringMap< std::string > misses;
+    };
+
+} // namespace vast::target::llvmir
@@ -0,0 +1,33 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+
+namespace llvm
+{
+    class LLVMContext;
+    class Module;
+} // namespace llvm
+
+namespace vast::target::llvmir
+{
+    //
+    // Translates a module in the llvm dialect on up to `threads` threads. Each
+    // function definition goes to one shard, balanced by the number of
+    // operations, globals and other top-level operations go to the first one.
+    // A shard declares the functions and globals defined in the others. The
+    // shards are translated in their own llvm contexts, handed over as bitcode
+    // and linked in order into a module of `llvm_ctx`. Local symbols are
+    // external during the linking and local again afterwards, and functions
+    // are ordered as in `mlir_module`, so that the output does not depend on
+    // the scheduling of the threads. Modules with debug info are translated
+    // serially, as they have a single compile unit.
+    //
+    std::unique_ptr< llvm::Module > translate_parallel(
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx, unsigned threads
+    );
+
+} // namespace vast::target::llvmir
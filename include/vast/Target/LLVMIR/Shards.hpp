@@ -0,0 +1,19 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::target::llvmir
+{
+    //
+    // Merges shards of `hl::shard_module`, lowered to the llvm dialect, into
+    // `dst`. Declarations merge into the definition of their shard. Symbols the
+    // lowering creates in each shard, e.g., globals of string literals, are
+    // renamed with a `.N` suffix when they clash. Symbols promoted by the
+    // sharding become internal again. The first shard supplies the module
+    // attributes, i.e., the data layout and the target.
+    //
+    logical_result merge_shards(vast_module dst, llvm::ArrayRef< vast_module > shards);
+
+} // namespace vast::target::llvmir
@@ -0,0 +1,72 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+    class raw_ostream;
+} // namespace llvm
+
+namespace vast::target::llvmir
+{
+    // Static stack frame of a function lowered to the llvm dialect.
+    struct frame_usage
+    {
+        std::string name;
+        // `file:line:col` of the function, empty without locations.
+        std::string loc;
+
+        // Slots of the allocas, aligned, without the return slots of calls.
+        std::uint64_t locals = 0;
+        // Return slots (`sret`) of calls.
+        std::uint64_t return_slots = 0;
+        // Largest copies of `byval` arguments of a call.
+        std::uint64_t byval = 0;
+        // Estimate of the registers saved by the function: a slot per value
+        // used out of its block, up to the callee saved registers, and the
+        // return address and the frame pointer of a function that calls.
+        std::uint64_t spills = 0;
+        // An alloca outside of the entry block or of a count unknown until
+        // run time, the frame may be larger.
+        bool dynamic = false;
+
+        // Largest alloca, its size and location.
+        std::uint64_t largest_slot = 0;
+        std::string largest_slot_loc;
+
+        std::vector< std::string > callees;
+        bool indirect_calls = false;
+
+        // Worst case of the frames along the calls of the module and the
+        // path of calls it takes. No worst case for recursive functions.
+        std::optional< std::uint64_t > worst_case;
+        std::vector< std::string > worst_case_path;
+        // Calls of functions not defined in the module, or indirect ones,
+        // counted as empty frames.
+        bool incomplete = false;
+
+        std::uint64_t frame() const { return locals + return_slots + byval + spills; }
+    };
+
+    //
+    // Stack usage of the function definitions of a module (-vast-stack-usage).
+    // The worst case of a function follows the direct calls of the module,
+    // a module linked by `vast-link` gives the worst case of the program.
+    //
+    struct stack_usage
+    {
+        static stack_usage collect(vast_module mod);
+
+        void write(llvm::raw_ostream &os, string_ref file) const;
+
+        std::vector< frame_usage > functions;
+    };
+
+} // namespace vast::target::llvmir
@@ -4,10 +4,35 @@
 
 #include "vast/Util/Common.hpp"
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/Func.hpp"
+
 VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Parser/Parser.h>
 #include <mlir/Pass/PassManager.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/ThreadPool.h>
 VAST_UNRELAX_WARNINGS
 
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
 namespace vast::tw {
 
     struct default_loc_rewriter_t
@@ -17,41 +42,103 @@ namespace vast::tw {
         static auto prev(mlir::Operation *op) -> mlir::Operation *;
     };
 
+    //
+    // Keeps provenance in a side table instead of locations. The table is filled
+    // from the mapping of the source operations to their clones, so operations
+    // the passes created anew have no `prev`.
+    //
+    struct side_table_loc_rewriter_t
+    {
+        // Records provenance of operations that remained in `mod` after the
+        // passes ran on the clone described by `mapping`.
+        auto record(const mlir::IRMapping &mapping, vast_module mod) -> void;
+
+        auto prev(mlir::Operation *op) const -> mlir::Operation *;
+
+        // Drops provenance from and to operations that are about to be freed.
+        auto forget(const llvm::DenseSet< mlir::Operation * > &ops) -> void;
+
+      private:
+        llvm::DenseMap< mlir::Operation *, mlir::Operation * > parents;
+    };
+
     using pass_ptr_t = std::unique_ptr< mlir::Pass >;
 
+    //
+    // Intermediate levels are spilled as bytecode into `directory` once the
+    // resident levels own more than `budget` operations, least recently used
+    // first. A spilled level is reloaded when a handle into it is used.
+    //
+    struct storage_config
+    {
+        std::filesystem::path directory;
+        std::size_t budget;
+    };
+
+    //
+    // Levels of the tower share top-level operations. A level owns only the
+    // top-level operations that its pass application changed, all other
+    // operations of its view belong to one of its ancestors. Passes still run
+    // on a complete module assembled from the view of the source level.
+    //
     template< typename loc_rewriter_t >
     struct tower
     {
         using loc_rewriter = loc_rewriter_t;
 
+        static constexpr bool rewrites_locations = requires (operation op) {
+            loc_rewriter::insert(op);
+            loc_rewriter::remove(op);
+        };
+
+        static constexpr bool records_provenance = requires (
+            loc_rewriter &rewriter, const mlir::IRMapping &mapping, vast_module mod
+        ) {
+            rewriter.record(mapping, mod);
+        };
+
+        static constexpr bool forgets_provenance = requires (
+            loc_rewriter &rewriter, const llvm::DenseSet< operation > &ops
+        ) {
+            rewriter.forget(ops);
+        };
+
         struct handle_t
         {
             std::size_t id;
-            vast_module mod;
         };
 
+        using future_handle_t = std::shared_future< handle_t >;
+
         static auto get(mcontext_t &ctx, owning_module_ref mod)
             -> std::tuple< tower, handle_t > {
             tower t(ctx, std::move(mod));
-            handle_t h{ .id = 0, .mod = t._modules[0].get() };
-            return { std::move(t), h };
+            return { std::move(t), handle_t{ .id = 0 } };
         }
 
+        // Applications of passes may run concurrently, with each other and with
+        // queries of existing levels, the passes themselves run outside of the
+        // tower lock. The source level stays resident until the application is
+        // done.
         auto apply(handle_t handle, mlir::PassManager &pm) -> handle_t {
-            handle.mod.walk(loc_rewriter::insert);
+            mlir::IRMapping mapping;
+            auto mod = [&] {
+                std::lock_guard lock(*_mutex);
+                auto &src = resident(handle);
+                ++src.pins;
+                return clone_source(src, mapping, {});
+            }();
 
-            _modules.emplace_back(mlir::cast< vast_module >(handle.mod->clone()));
+            run(pm, mod);
 
-            auto id  = _modules.size() - 1;
-            auto mod = _modules.back().get();
+            std::lock_guard lock(*_mutex);
+            auto &src = resident(handle);
+            --src.pins;
 
-            if (mlir::failed(pm.run(mod))) {
-                VAST_UNREACHABLE("error: some pass in apply() failed");
-            }
-
-            handle.mod.walk(loc_rewriter::remove);
-
-            return { id, mod };
+            auto level = share_unchanged(src, std::move(mod));
+            level.parent   = handle.id;
+            level.pipeline = pm;
+            return push(std::move(level), mapping);
         }
 
         auto apply(handle_t handle, pass_ptr_t pass) -> handle_t {
@@ -60,19 +147,672 @@ namespace vast::tw {
             return apply(handle, pm);
         }
 
-        auto top() -> handle_t { return { _modules.size(), _modules.back().get() }; }
+        //
+        // Applies `pm` on the thread pool of the context, hence independent
+        // branches of the tower are explored in parallel. Falls back to
+        // a synchronous application if the context has multithreading disabled.
+        //
+        // Only other applications may run while some are pending. The tower
+        // must not be moved or destroyed until all of them are finished.
+        //
+        auto apply_async(handle_t handle, std::shared_ptr< mlir::PassManager > pm)
+            -> future_handle_t
+        {
+            if (!_ctx->isMultithreadingEnabled()) {
+                std::promise< handle_t > result;
+                result.set_value(apply(handle, *pm));
+                return result.get_future().share();
+            }
+
+            return _ctx->getThreadPool().async([this, handle, pm] {
+                return apply(handle, *pm);
+            });
+        }
+
+        auto apply_async(handle_t handle, pass_ptr_t pass) -> future_handle_t {
+            auto pm = std::make_shared< mlir::PassManager >(_ctx);
+            pm->addPass(std::move(pass));
+            return apply_async(handle, std::move(pm));
+        }
+
+        auto top() const -> handle_t {
+            std::lock_guard lock(*_mutex);
+            return { _levels.size() - 1 };
+        }
+
+        // Top-level operations of the level, including the shared ones. The view
+        // is valid until the next use of another handle, which might spill it.
+        auto view(handle_t handle) -> llvm::ArrayRef< operation > {
+            std::lock_guard lock(*_mutex);
+            return resident(handle).ops;
+        }
+
+        // Builds a standalone copy of the complete module of the level.
+        auto materialize(handle_t handle) -> owning_module_ref {
+            std::lock_guard lock(*_mutex);
+            mlir::IRMapping mapping;
+            return assemble(resident(handle), mapping);
+        }
+
+        //
+        // Replaces level 0 by `mod`, a new version of the source module, and
+        // replays the recorded pass applications of all levels. Functions that
+        // did not change since the previous version (ignoring locations) are
+        // not lowered again: the replayed pipelines get them as declarations
+        // only, so that references to them resolve, and each level takes its
+        // cached lowering of them instead, including the old locations. The
+        // pipelines therefore run only on the changed functions and the rest
+        // of the module, e.g., types and globals.
+        //
+        // Reuse relies on passes preserving symbol names of the functions and
+        // on function passes not looking into other function bodies. Functions
+        // without external linkage are always replayed, as their declarations
+        // would be malformed, as is a function missing in a cached level from
+        // that level on.
+        //
+        auto rebuild(owning_module_ref mod) -> handle_t {
+            std::lock_guard lock(*_mutex);
+
+            // Cached levels have to stay resident until the rebuild is done.
+            auto storage = std::exchange(_storage, std::nullopt);
+            for (std::size_t id = 0; id < _levels.size(); ++id) {
+                resident({ id });
+            }
+
+            auto cached = std::exchange(_levels, {});
+            _resident = 0;
+
+            // Names of the functions each level reused. A level reuses only
+            // what its source level did, so that the provenance of a reused
+            // operation points to a reused operation as well.
+            llvm::DenseSet< operation > adopted;
+            std::vector< llvm::StringSet<> > reused(cached.size());
+
+            level_t root{ .mod = std::move(mod) };
+            adopt_all(root);
+            reused[0] = reuse_cached(root, cached[0], unchanged_functions(cached[0], root), adopted);
+            root.last_use = ++_uses;
+            _resident += root.size;
+            _levels.push_back(std::move(root));
+
+            for (std::size_t id = 1; id < cached.size(); ++id) {
+                auto &old = cached[id];
+                auto parent = old.parent.value();
+
+                // Only functions the source level reused are passed reduced,
+                // and only if their declaration is valid.
+                llvm::StringSet<> reusable;
+                for (auto op : _levels[parent].ops) {
+                    auto name = symbol_name(op);
+                    if (name && reused[parent].contains(name.getValue()) && is_reducible(op)) {
+                        reusable.insert(name.getValue());
+                    }
+                }
+
+                // Drop the names the cached level does not have.
+                llvm::StringSet<> present;
+                for (auto op : old.ops) {
+                    if (auto name = symbol_name(op); name && reusable.contains(name.getValue())) {
+                        present.insert(name.getValue());
+                    }
+                }
+                reusable = std::move(present);
+
+                mlir::PassManager pm(_ctx);
+                static_cast< mlir::OpPassManager & >(pm) = *old.pipeline;
+
+                mlir::IRMapping mapping;
+                auto mod = clone_source(_levels[parent], mapping, reusable);
+                run(pm, mod);
+
+                auto level = share_unchanged(_levels[parent], std::move(mod));
+                reused[id] = reuse_cached(level, old, reusable, adopted);
+                level.parent   = parent;
+                level.pipeline = std::move(old.pipeline);
+                push(std::move(level), mapping);
+            }
+
+            if constexpr (forgets_provenance) {
+                llvm::DenseSet< operation > freed;
+                for (auto &level : cached) {
+                    level.mod->walk([&] (operation op) {
+                        if (op != level.mod.get()) {
+                            freed.insert(op);
+                        }
+                    });
+                }
+                _rewriter.forget(freed);
+            }
+
+            cached.clear();
+
+            // Reused operations got indexed again with their new levels.
+            _derived.clear();
+            for (const auto &level : _levels) {
+                index(level);
+            }
+
+            _storage = std::move(storage);
+
+            handle_t last = { _levels.size() - 1 };
+            enforce_budget(last.id);
+            return last;
+        }
+
+        // Enables spilling of intermediate levels to disk. Provenance of the
+        // spilled operations is dropped, hence the rewriter needs to support it.
+        auto spill_to_disk(storage_config config) -> void
+            requires forgets_provenance
+        {
+            _storage = std::move(config);
+            enforce_budget(top().id);
+        }
+
+        // Operation of the source level that `op` was derived from.
+        auto prev(operation op) const -> operation { return _rewriter.prev(op); }
+
+        // Operation in the view of `handle` that `op` originates from, or null
+        // if `op` or one of its sources was created anew by a pass.
+        auto origin(handle_t handle, operation op) -> operation {
+            std::lock_guard lock(*_mutex);
+            auto &target = resident(handle);
+            while (op && !visible(target, op)) {
+                op = _rewriter.prev(op);
+            }
+
+            return op;
+        }
+
+        // Operations in the view of `handle` derived from `op` through any number
+        // of levels. Only the levels between the one of `op` and `handle` are
+        // visited, hence the cost is proportional to the size of the answer and
+        // its intermediate steps. Provenance through spilled levels is lost.
+        auto derived_from(handle_t handle, operation op) -> std::vector< operation > {
+            std::lock_guard lock(*_mutex);
+            auto &target = resident(handle);
+
+            std::vector< operation > result;
+            llvm::SmallVector< operation > worklist = { op };
+            llvm::DenseSet< operation > seen = { op };
+            while (!worklist.empty()) {
+                auto current = worklist.pop_back_val();
+                if (visible(target, current)) {
+                    result.push_back(current);
+                }
+
+                auto it = _derived.find(current);
+                if (it == _derived.end()) {
+                    continue;
+                }
+
+                for (auto next : it->second) {
+                    if (leads_to(next, handle.id) && seen.insert(next).second) {
+                        worklist.push_back(next);
+                    }
+                }
+            }
+
+            return result;
+        }
 
       private:
-        using module_storage_t = llvm::SmallVector< owning_module_ref, 2 >;
+        struct level_t
+        {
+            // Module attributes and the top-level operations owned by the level.
+            owning_module_ref mod;
+            // Complete list of top-level operations in the module order.
+            std::vector< operation > ops;
+            // Number of operations owned by the level.
+            std::size_t size = 0;
+            // Last use of the level for the eviction policy.
+            std::size_t last_use = 0;
+            // Bytecode of the complete module of a spilled level.
+            std::optional< std::filesystem::path > spilled = std::nullopt;
+            // Source level and the applied passes, used to replay the level.
+            std::optional< std::size_t > parent = std::nullopt;
+            std::optional< mlir::OpPassManager > pipeline = std::nullopt;
+            // Top-level operations of the view, built by the first query.
+            std::optional< llvm::DenseSet< operation > > members = std::nullopt;
+            // Number of pending applications using the level as their source.
+            std::size_t pins = 0;
+        };
+
+        // Levels keep their addresses while new ones are appended.
+        using level_storage_t = std::deque< level_t >;
 
         mcontext_t *_ctx;
-        module_storage_t _modules;
+        level_storage_t _levels;
+        std::unique_ptr< std::mutex > _mutex = std::make_unique< std::mutex >();
+        loc_rewriter _rewriter;
+
+        // Forward provenance index, the inverse of `prev`.
+        llvm::DenseMap< operation, llvm::SmallVector< operation, 1 > > _derived;
+
+        std::optional< storage_config > _storage = std::nullopt;
+        std::size_t _resident = 0;
+        std::size_t _uses = 0;
 
         tower(mcontext_t &ctx, owning_module_ref mod) : _ctx(&ctx) {
-            _modules.emplace_back(std::move(mod));
+            level_t level{ .mod = std::move(mod) };
+            adopt_all(level);
+            _resident += level.size;
+            _levels.push_back(std::move(level));
+        }
+
+        static auto count_ops(operation op) -> std::size_t {
+            std::size_t count = 0;
+            op->walk([&] (operation) { ++count; });
+            return count;
+        }
+
+        // Makes the level the owner of its whole view.
+        static auto adopt_all(level_t &level) -> void {
+            level.members.reset();
+            level.ops.clear();
+            level.size = 0;
+            for (auto &op : *level.mod->getBody()) {
+                level.ops.push_back(&op);
+                level.size += count_ops(&op);
+            }
+        }
+
+        // Assembles the input module of passes from the view of `src`. Functions
+        // in `reduced` are passed to the pipeline only as declarations. Clones
+        // keep the provenance locations, so the source is restored right away.
+        static auto clone_source(
+            const level_t &src, mlir::IRMapping &mapping, const llvm::StringSet<> &reduced
+        ) -> owning_module_ref {
+            if constexpr (rewrites_locations) {
+                for (auto op : src.ops) {
+                    op->walk(loc_rewriter::insert);
+                }
+            }
+
+            auto mod = assemble(src, mapping, reduced);
+
+            if constexpr (rewrites_locations) {
+                for (auto op : src.ops) {
+                    op->walk(loc_rewriter::remove);
+                }
+            }
+
+            return mod;
+        }
+
+        static auto run(mlir::PassManager &pm, owning_module_ref &mod) -> void {
+            if (mlir::failed(pm.run(mod.get()))) {
+                VAST_UNREACHABLE("error: some pass in apply() failed");
+            }
+        }
+
+        auto push(level_t level, const mlir::IRMapping &mapping) -> handle_t {
+            if constexpr (records_provenance) {
+                _rewriter.record(mapping, level.mod.get());
+            }
+
+            index(level);
+
+            level.last_use = ++_uses;
+            _resident += level.size;
+            _levels.push_back(std::move(level));
+
+            auto id = _levels.size() - 1;
+            enforce_budget(id);
+            return { id };
+        }
+
+        auto resident(handle_t handle) -> level_t & {
+            auto &level = _levels[handle.id];
+            if (level.spilled) {
+                reload(level);
+            }
+
+            level.last_use = ++_uses;
+            enforce_budget(handle.id);
+            return level;
+        }
+
+        auto reload(level_t &level) -> void {
+            auto path = level.spilled->string();
+            auto mod  = mlir::parseSourceFile< mlir::ModuleOp >(path, mlir::ParserConfig(_ctx));
+            VAST_CHECK(mod, "error: cannot reload tower level from {0}", path);
+            llvm::sys::fs::remove(path);
+
+            level.mod = std::move(mod);
+            level.spilled.reset();
+            adopt_all(level);
+            _resident += level.size;
+        }
+
+        // Only towers whose rewriter can drop provenance are ever given a storage.
+        auto enforce_budget(std::size_t keep) -> void {
+            if constexpr (forgets_provenance) {
+                if (!_storage) {
+                    return;
+                }
+
+                while (_resident > _storage->budget) {
+                    std::optional< std::size_t > victim;
+                    for (std::size_t id = 1; id + 1 < _levels.size(); ++id) {
+                        const auto &level = _levels[id];
+                        if (id == keep || level.spilled || level.pins) {
+                            continue;
+                        }
+
+                        if (!victim || level.last_use < _levels[*victim].last_use) {
+                            victim = id;
+                        }
+                    }
+
+                    if (!victim) {
+                        return;
+                    }
+
+                    spill(*victim);
+                }
+            }
+        }
+
+        auto spill(std::size_t id) -> void
+            requires forgets_provenance
+        {
+            auto &level = _levels[id];
+
+            auto path = _storage->directory / llvm::formatv("tower-level-{0}.mlirbc", id).str();
+            {
+                mlir::IRMapping mapping;
+                auto mod = assemble(level, mapping);
+
+                std::error_code ec;
+                llvm::raw_fd_ostream os(path.string(), ec);
+                if (ec || mlir::failed(mlir::writeBytecodeToFile(mod.get(), os))) {
+                    VAST_UNREACHABLE("error: cannot spill tower level to {0}", path.string());
+                }
+            }
+
+            // Operations still shared by other resident levels move over to one
+            // of them, so that their views stay intact.
+            llvm::DenseSet< operation > owned;
+            for (auto &op : *level.mod->getBody()) {
+                owned.insert(&op);
+            }
+
+            for (auto &other : _levels) {
+                if (&other == &level || other.spilled) {
+                    continue;
+                }
+
+                for (auto op : other.ops) {
+                    if (owned.erase(op)) {
+                        auto size = count_ops(op);
+                        op->moveBefore(other.mod->getBody(), other.mod->getBody()->end());
+                        level.size -= size;
+                        other.size += size;
+                    }
+                }
+            }
+
+            llvm::DenseSet< operation > freed;
+            for (auto op : owned) {
+                op->walk([&] (operation nested) { freed.insert(nested); });
+            }
+            _rewriter.forget(freed);
+            forget_derived(freed);
+
+            _resident -= level.size;
+            level.mod = {};
+            level.members.reset();
+            level.ops.clear();
+            level.size = 0;
+            level.spilled = std::move(path);
+        }
+
+        static auto assemble(
+            const level_t &level, mlir::IRMapping &mapping, const llvm::StringSet<> &reduced = {}
+        ) -> owning_module_ref {
+            auto mod = mlir::ModuleOp::create(level.mod->getLoc());
+            mod->setAttrs(level.mod->getAttrDictionary());
+
+            auto body = mod.getBody();
+            for (auto op : level.ops) {
+                auto name = symbol_name(op);
+                if (name && reduced.contains(name.getValue())) {
+                    // Regions are left empty, which makes a declaration of the function.
+                    body->push_back(op->cloneWithoutRegions(mapping));
+                } else {
+                    body->push_back(op->clone(mapping));
+                }
+            }
+
+            return owning_module_ref(mod);
+        }
+
+        static auto symbol_name(operation op) -> mlir::StringAttr {
+            return op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName());
+        }
+
+        // Drops operations of `mod` that the pass left intact and refers to
+        // their counterparts in `src` instead. Shared operations keep their
+        // locations, i.e., `prev` of a shared operation points to the level
+        // below the one that owns it.
+        static auto share_unchanged(const level_t &src, owning_module_ref mod) -> level_t {
+            llvm::StringMap< operation > previous;
+            for (auto op : src.ops) {
+                if (auto name = symbol_name(op)) {
+                    previous.try_emplace(name.getValue(), op);
+                }
+            }
+
+            auto equivalent = [&] (operation op) -> operation {
+                auto name = symbol_name(op);
+                if (!name) {
+                    return nullptr;
+                }
+
+                auto it = previous.find(name.getValue());
+                if (it == previous.end()) {
+                    return nullptr;
+                }
+
+                auto flags = mlir::OperationEquivalence::IgnoreLocations;
+                if (!mlir::OperationEquivalence::isEquivalentTo(op, it->second, flags)) {
+                    return nullptr;
+                }
+
+                return it->second;
+            };
+
+            level_t level{ .mod = std::move(mod), .ops = {} };
+            for (auto &op : llvm::make_early_inc_range(*level.mod->getBody())) {
+                if (auto shared = equivalent(&op)) {
+                    level.ops.push_back(shared);
+                    op.erase();
+                } else {
+                    level.ops.push_back(&op);
+                    level.size += count_ops(&op);
+                }
+            }
+
+            return level;
+        }
+
+        static auto is_function_definition(operation op) -> bool {
+            auto fn = mlir::dyn_cast< mlir::FunctionOpInterface >(op);
+            return fn && !fn.isExternal();
+        }
+
+        // A definition can be passed as a declaration only if its linkage allows
+        // an external declaration, i.e., with the default external linkage of
+        // vast functions.
+        static auto is_reducible(operation op) -> bool {
+            if (!is_function_definition(op)) {
+                return false;
+            }
+
+            auto linkage = op->getAttr(core::getLinkageAttrNameString());
+            if (!linkage) {
+                return true;
+            }
+
+            auto kind = mlir::dyn_cast< core::GlobalLinkageKindAttr >(linkage);
+            return kind && kind.getValue() == core::GlobalLinkageKind::ExternalLinkage;
+        }
+
+        // Names of function definitions of `root` equivalent to their previous
+        // version in `prev`.
+        static auto unchanged_functions(const level_t &prev, const level_t &root)
+            -> llvm::StringSet<>
+        {
+            llvm::StringMap< operation > previous;
+            for (auto op : prev.ops) {
+                if (auto name = symbol_name(op); name && is_reducible(op)) {
+                    previous.try_emplace(name.getValue(), op);
+                }
+            }
+
+            llvm::StringSet<> unchanged;
+            for (auto op : root.ops) {
+                auto name = symbol_name(op);
+                if (!name || !is_reducible(op)) {
+                    continue;
+                }
+
+                auto it = previous.find(name.getValue());
+                auto flags = mlir::OperationEquivalence::IgnoreLocations;
+                if (it != previous.end()
+                    && mlir::OperationEquivalence::isEquivalentTo(op, it->second, flags)
+                ) {
+                    unchanged.insert(name.getValue());
+                }
+            }
+
+            return unchanged;
+        }
+
+        // Replaces operations of the `names` symbols owned by `level` by their
+        // counterparts in `cached`, i.e., the declarations the pipeline got
+        // instead of the unchanged functions by their cached lowering. Cached
+        // functions the pipeline dropped, e.g., unused declarations, are added
+        // back. A cached operation moves over to the level, unless a level
+        // rebuilt earlier has taken it already. Returns the names of the
+        // symbols whose cached operation is in the view of the level.
+        static auto reuse_cached(
+            level_t &level, const level_t &cached, const llvm::StringSet<> &names,
+            llvm::DenseSet< operation > &adopted
+        ) -> llvm::StringSet<> {
+            llvm::StringMap< operation > counterparts;
+            for (auto op : cached.ops) {
+                if (auto name = symbol_name(op); name && names.contains(name.getValue())) {
+                    counterparts.try_emplace(name.getValue(), op);
+                }
+            }
+
+            auto body = level.mod->getBody();
+            auto take = [&] (operation op) {
+                if (adopted.insert(op).second) {
+                    op->moveBefore(body, body->end());
+                    level.size += count_ops(op);
+                }
+                return op;
+            };
+
+            llvm::StringSet<> reused;
+            std::vector< operation > ops;
+            for (auto op : level.ops) {
+                auto name = symbol_name(op);
+                auto it = name ? counterparts.find(name.getValue()) : counterparts.end();
+                if (it == counterparts.end()) {
+                    ops.push_back(op);
+                    continue;
+                }
+
+                // Operations shared with the source level are kept shared.
+                auto owned = op->getParentOp() == level.mod.get();
+                if (op != it->second && !owned) {
+                    ops.push_back(op);
+                    continue;
+                }
+
+                if (owned) {
+                    level.size -= count_ops(op);
+                    op->erase();
+                }
+
+                reused.insert(name.getValue());
+                ops.push_back(take(it->second));
+                counterparts.erase(it);
+            }
+
+            for (auto op : cached.ops) {
+                auto name = symbol_name(op);
+                if (name && counterparts.erase(name.getValue())) {
+                    reused.insert(name.getValue());
+                    ops.push_back(take(op));
+                }
+            }
+
+            level.ops = std::move(ops);
+            level.members.reset();
+            return reused;
+        }
+
+        // Indexes provenance of the operations owned by the level.
+        auto index(const level_t &level) -> void {
+            for (auto op : level.ops) {
+                if (op->getParentOp() != level.mod.get()) {
+                    continue;
+                }
+
+                op->walk([&] (operation nested) {
+                    if (auto src = _rewriter.prev(nested)) {
+                        _derived[src].push_back(nested);
+                    }
+                });
+            }
+        }
+
+        auto forget_derived(const llvm::DenseSet< operation > &freed) -> void {
+            for (auto op : freed) {
+                _derived.erase(op);
+            }
+
+            for (auto &[_, derived] : _derived) {
+                llvm::erase_if(derived, [&] (operation op) { return freed.contains(op); });
+            }
+        }
+
+        static auto top_level(operation op) -> operation {
+            auto parent = op->getParentOp();
+            while (parent && !mlir::isa< mlir::ModuleOp >(parent)) {
+                op = std::exchange(parent, parent->getParentOp());
+            }
+
+            return op;
+        }
+
+        static auto visible(level_t &level, operation op) -> bool {
+            if (!level.members) {
+                level.members.emplace(level.ops.begin(), level.ops.end());
+            }
+
+            return level.members->contains(top_level(op));
+        }
+
+        // Whether `op` belongs to `id` or to one of the levels it derives from.
+        auto leads_to(operation op, std::size_t id) const -> bool {
+            auto mod = top_level(op)->getParentOp();
+
+            for (std::optional< std::size_t > level = id; level; level = _levels[*level].parent) {
+                if (_levels[*level].mod && _levels[*level].mod->getOperation() == mod) {
+                    return true;
+                }
+            }
+
+            return false;
         }
     };
 
     using default_tower = tower< default_loc_rewriter_t >;
+    using side_table_tower = tower< side_table_loc_rewriter_t >;
 
 } // namespace vast::tw
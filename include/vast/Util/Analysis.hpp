@@ -0,0 +1,104 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Pass/AnalysisManager.h>
+#include <llvm/ADT/Hashing.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast {
+
+    //
+    // Returns a module analysis for passes that run either on the module or
+    // on operations nested in it. Nested passes can only reuse the analysis
+    // if a module pass has computed it before, otherwise `nullptr` is returned.
+    //
+    template< typename analysis_t >
+    analysis_t *get_module_analysis(operation op, mlir::AnalysisManager am) {
+        if (mlir::isa< vast_module >(op)) {
+            return &am.getAnalysis< analysis_t >();
+        }
+
+        if (auto mod = op->getParentOfType< vast_module >()) {
+            if (auto cached = am.getCachedParentAnalysis< analysis_t >(mod)) {
+                return &cached->get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    //
+    // data_layout_analysis
+    //
+    // Module analysis that keeps `mlir::DataLayoutAnalysis` across passes.
+    // The data layout of vast types is given by the entries of the module
+    // attributes, so the analysis stays valid as long as they do not change,
+    // regardless of the analyses preserved by a pass.
+    //
+    struct data_layout_analysis
+    {
+        explicit data_layout_analysis(operation op)
+            : mod(op), stamp(op->getAttrDictionary()), analysis(op)
+        {}
+
+        const mlir::DataLayoutAnalysis &get() const { return analysis; }
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const {
+            return mod->getAttrDictionary() != stamp;
+        }
+
+      private:
+        operation mod;
+        mlir::DictionaryAttr stamp;
+        mlir::DataLayoutAnalysis analysis;
+    };
+
+    //
+    // symbol_table_analysis
+    //
+    // Module analysis of the symbol table of the module. The table is
+    // invalidated when a top-level symbol is added, erased or renamed, the
+    // check hashes the top-level operations only, without hashing their
+    // bodies.
+    //
+    struct symbol_table_analysis
+    {
+        explicit symbol_table_analysis(operation op)
+            : mod(op), stamp(symbols_hash(op)), table(op)
+        {}
+
+        template< typename op_t >
+        op_t lookup(auto name) const { return table.template lookup< op_t >(name); }
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const {
+            return symbols_hash(mod) != stamp;
+        }
+
+      private:
+        static llvm::hash_code symbols_hash(operation op) {
+            llvm::hash_code hash = llvm::hash_value(op);
+            for (auto &region : op->getRegions()) {
+                for (auto &nested : region.getOps()) {
+                    if (auto name = mlir::SymbolTable::getSymbolName(&nested)) {
+                        hash = llvm::hash_combine(hash, &nested, name.getAsOpaquePointer());
+                    }
+                }
+            }
+            return hash;
+        }
+
+        operation mod;
+        llvm::hash_code stamp;
+        mlir::SymbolTable table;
+    };
+
+} // namespace vast
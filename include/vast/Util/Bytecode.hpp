@@ -0,0 +1,61 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace vast::util
+{
+    //
+    // Version of the bytecode encoding of a dialect. A dialect writes the
+    // version it encodes and refuses modules written by a newer version,
+    // older versions have to stay readable.
+    //
+    struct bytecode_version final : mlir::DialectVersion
+    {
+        explicit bytecode_version(std::uint64_t value) : value(value) {}
+
+        std::uint64_t value;
+    };
+
+    inline void write_bytecode_version(mlir::DialectBytecodeWriter &writer, std::uint64_t current) {
+        writer.writeVarInt(current);
+    }
+
+    inline std::unique_ptr< mlir::DialectVersion > read_bytecode_version(
+        mlir::DialectBytecodeReader &reader, std::uint64_t current
+    ) {
+        std::uint64_t value;
+        if (mlir::failed(reader.readVarInt(value))) {
+            return nullptr;
+        }
+
+        if (value > current) {
+            reader.emitError() << "bytecode version " << value
+                               << " is newer than the supported version " << current;
+            return nullptr;
+        }
+
+        return std::make_unique< bytecode_version >(value);
+    }
+
+    inline mlir::LogicalResult read_flag(mlir::DialectBytecodeReader &reader, bool &flag) {
+        std::uint64_t value;
+        if (mlir::failed(reader.readVarInt(value))) {
+            return mlir::failure();
+        }
+
+        flag = value != 0;
+        return mlir::success();
+    }
+
+} // namespace vast::util
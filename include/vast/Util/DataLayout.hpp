@@ -14,16 +14,17 @@ VAST_RELAX_WARNINGS
 #include <mlir/Interfaces/DataLayoutInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+
 #include "vast/Util/Common.hpp"
 
 #include <type_traits>
 
 namespace vast::dl {
-    // We are currently using `DLTI` dialect to help encoding data layout information,
-    // however in the future custom attributes will be probably preferable.
-    // Each entry is mapping `hl::Type -> uint32_t` and in the IR it is encoded as
-    // attribute of `ModuleOp`.
-    // TODO(lukas): Add alignment information & possibly ABI lowering relevant info?
+    // We are currently using `DLTI` dialect to help encoding data layout information.
+    // Each entry is mapping `hl::Type -> core::TypeLayoutAttr` and in the IR it is
+    // encoded as attribute of `ModuleOp`.
+    // TODO(lukas): Possibly ABI lowering relevant info?
     struct DLEntry
     {
         using bitwidth_t = uint32_t;
@@ -35,55 +36,30 @@ namespace vast::dl {
         DLEntry(mlir_type type, bitwidth_t bw, bitwidth_t abi_align)
             : type(type), bw(bw), abi_align(abi_align) {}
 
-        DLEntry(mlir_type type, mlir::DictionaryAttr dict_attr)
-            : type(type)
-            , bw(extract(dict_attr, bw_key()))
-            , abi_align(extract(dict_attr, abi_align_key())) {}
+        DLEntry(mlir_type type, core::TypeLayoutAttr layout)
+            : type(type), bw(layout.getWidth()), abi_align(layout.getAbiAlign()) {}
 
         DLEntry(const mlir::DataLayoutEntryInterface &attr)
-            : DLEntry(
-                mlir::dyn_cast< mlir_type >(attr.getKey()),
-                mlir::dyn_cast< mlir::DictionaryAttr >(attr.getValue())
-            ) {
+            : DLEntry(mlir::dyn_cast< mlir_type >(attr.getKey()), layout_of(attr))
+        {
             VAST_ASSERT(type);
         }
 
-      private:
-        static mlir_type bw_type(mcontext_t &mctx) { return mlir::IntegerType::get(&mctx, 32); }
-
-        static llvm::StringRef bw_key() { return "vast.dl.bw"; }
-
-        static llvm::StringRef abi_align_key() { return "vast.abi_align.key"; }
-
-        static bitwidth_t extract(mlir::DictionaryAttr dict_attr, llvm::StringRef key) {
-            // Defensive check as there is path in ctors that does not guarantee this.
-            VAST_ASSERT(dict_attr);
-
-            auto named_attr = dict_attr.getNamed(key);
-            VAST_ASSERT(named_attr);
-
-            auto int_attr = mlir::dyn_cast< mlir::IntegerAttr >(named_attr->getValue());
-            return static_cast< bitwidth_t >(int_attr.getInt());
+        // Entries of other dialects (e.g. LLVM) have their own encoding.
+        static bool is_vast_entry(const mlir::DataLayoutEntryInterface &attr) {
+            return mlir::isa< core::TypeLayoutAttr >(attr.getValue());
         }
 
-        mlir::StringAttr wrap_str(mcontext_t &mctx, llvm::StringRef str_value) const {
-            return mlir::StringAttr::get(&mctx, str_value);
+      private:
+        static core::TypeLayoutAttr layout_of(const mlir::DataLayoutEntryInterface &attr) {
+            auto layout = mlir::dyn_cast< core::TypeLayoutAttr >(attr.getValue());
+            VAST_CHECK(layout, "Unexpected data layout entry value: {0}", attr.getValue());
+            return layout;
         }
 
       public:
         mlir::Attribute create_raw_attr(mcontext_t &mctx) const {
-            // TODO(lukas): There is `UI64Attr` in `IR/OpBase.td` not sure how to include it
-            //              though.
-            auto to_attr = [&](auto what) {
-                return mlir::IntegerAttr::get(bw_type(mctx), llvm::APInt(32, what));
-            };
-
-            std::array< mlir::NamedAttribute, 2 > all = {
-                mlir::NamedAttribute(wrap_str(mctx, bw_key()), to_attr(bw)),
-                mlir::NamedAttribute(wrap_str(mctx, abi_align_key()), to_attr(abi_align))
-            };
-
-            return mlir::DictionaryAttr::get(&mctx, all);
+            return core::TypeLayoutAttr::get(&mctx, bw, abi_align);
         }
 
         // Wrap information in this object as `mlir::Attribute`, which is not attached yet
@@ -3,6 +3,8 @@
 #pragma once
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <mlir/IR/Threading.h>
 #include <mlir/Transforms/DialectConversion.h>
 VAST_UNRELAX_WARNINGS
 
@@ -18,6 +20,61 @@ namespace vast
 
 namespace vast::util
 {
+    // Runs `convert` on every top-level operation of `mod`, in parallel when the
+    // context allows multithreading. `convert` may rewrite only operations nested
+    // in the operation it is given, i.e., it must neither replace the operation
+    // nor create its siblings.
+    template< typename convert_t >
+    logical_result convert_top_level_ops(vast_module mod, convert_t &&convert) {
+        auto ops = llvm::to_vector(
+            llvm::map_range(mod.getOps(), [] (auto &op) -> operation { return &op; })
+        );
+        return mlir::failableParallelForEach(
+            mod.getContext(), ops, std::forward< convert_t >(convert)
+        );
+    }
+
+    // Whether a partial conversion of `root` to `target` rewrites anything, i.e.,
+    // whether `root` or an operation nested in it is illegal for `target`.
+    // Passes with nothing to convert can skip the walk of the conversion.
+    static inline bool has_illegal_ops(operation root, const conversion_target &target) {
+        return root->walk([&] (operation op) {
+            return target.isIllegal(op)
+                ? mlir::WalkResult::interrupt()
+                : mlir::WalkResult::advance();
+        }).wasInterrupted();
+    }
+
+    // Operations of `root` by their name, collected by a single walk, so that
+    // several conversions of `root` can check whether they apply to it.
+    struct op_kinds
+    {
+        explicit op_kinds(operation root) {
+            root->walk([&] (operation op) { ops[op->getName()].push_back(op); });
+        }
+
+        // See `has_illegal_ops`.
+        bool has_illegal(const conversion_target &target) const {
+            using action = conversion_target::LegalizationAction;
+            for (const auto &[name, named] : ops) {
+                switch (target.getOpAction(name).value_or(action::Legal)) {
+                    case action::Illegal:
+                        return true;
+                    case action::Dynamic:
+                        if (llvm::any_of(named, [&] (operation op) { return target.isIllegal(op); })) {
+                            return true;
+                        }
+                        break;
+                    case action::Legal:
+                        break;
+                }
+            }
+            return false;
+        }
+
+        llvm::DenseMap< mlir::OperationName, llvm::SmallVector< operation, 1 > > ops;
+    };
+
     template< typename Op >
     struct State
     {
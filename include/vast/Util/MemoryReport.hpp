@@ -0,0 +1,75 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast {
+
+    // Resident set of the process, zero where it cannot be read.
+    std::size_t resident_set_bytes();
+
+    //
+    // memory_report
+    //
+    // Memory of the process at boundaries of compilation phases
+    // (`-vast-memory-report`): the resident set, its peak so far, bytes
+    // allocated by malloc and the bytes of the clang AST. A sample with
+    // a module attributes it to its operations, blocks and the distinct
+    // types, attributes and locations it uses. Uniqued storage lives in the
+    // context, which never frees it, so those are counts, and operation
+    // bytes are an estimate of their in-memory layout.
+    //
+    struct memory_report
+    {
+        // Bytes held by the clang AST, if there is one.
+        using ast_bytes_fn = std::function< std::size_t() >;
+
+        explicit memory_report(ast_bytes_fn ast_bytes = nullptr)
+            : ast_bytes(std::move(ast_bytes))
+        {}
+
+        void sample(string_ref phase, operation root = nullptr);
+
+        void print(llvm::raw_ostream &os) const;
+
+      private:
+        struct footprint
+        {
+            std::size_t ops = 0;
+            std::size_t op_bytes = 0;
+            std::size_t blocks = 0;
+            std::size_t types = 0;
+            std::size_t attrs = 0;
+            std::size_t locs = 0;
+        };
+
+        struct row
+        {
+            std::string phase;
+            std::size_t rss = 0;
+            std::size_t peak_rss = 0;
+            std::size_t malloc = 0;
+            std::size_t ast = 0;
+            std::optional< footprint > ir;
+        };
+
+        static footprint measure(operation root);
+
+        ast_bytes_fn ast_bytes;
+        std::vector< row > rows;
+    };
+
+} // namespace vast
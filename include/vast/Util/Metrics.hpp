@@ -0,0 +1,206 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vast::metrics {
+
+    //
+    // Metrics of the long-running tools (`vast-front --serve`, `vast-query
+    // --serve` and `vast-lsp-server --c-sources`), exported in the OpenMetrics
+    // text format. Metrics are registered once, under the lock of the registry,
+    // and then updated through the returned references by relaxed atomic
+    // operations only, so updates never block.
+    //
+
+    struct counter
+    {
+        void inc(std::uint64_t n = 1) { cell.fetch_add(n, std::memory_order_relaxed); }
+
+        std::uint64_t value() const { return cell.load(std::memory_order_relaxed); }
+
+      private:
+        std::atomic< std::uint64_t > cell = 0;
+    };
+
+    // A double kept as its bits, additions retry on contention.
+    struct atomic_double
+    {
+        void store(double value);
+        void add(double value);
+        double load() const;
+
+      private:
+        // Bits of `0.0` are zero.
+        std::atomic< std::uint64_t > bits = 0;
+    };
+
+    struct gauge
+    {
+        void set(double value) { cell.store(value); }
+        void add(double value) { cell.add(value); }
+        void inc() { add(1); }
+        void dec() { add(-1); }
+
+        double value() const { return cell.load(); }
+
+      private:
+        atomic_double cell;
+    };
+
+    //
+    // Distribution of observed values, e.g., latencies in seconds, in buckets
+    // of upper bounds. As in OpenMetrics, the exported buckets are cumulative.
+    //
+    struct histogram
+    {
+        explicit histogram(std::vector< double > bounds = latency_bounds());
+
+        void observe(double value);
+
+        // Powers of four from 100us to ~26s.
+        static std::vector< double > latency_bounds();
+
+        const std::vector< double > &upper_bounds() const { return bounds; }
+        // Observations of each bucket, not cumulative, the last one is `+Inf`.
+        std::vector< std::uint64_t > bucket_counts() const;
+        std::uint64_t count() const { return observed.load(std::memory_order_relaxed); }
+        double sum() const { return total.load(); }
+
+      private:
+        std::vector< double > bounds;
+        std::unique_ptr< std::atomic< std::uint64_t >[] > buckets;
+        std::atomic< std::uint64_t > observed = 0;
+        atomic_double total;
+    };
+
+    // Observes the seconds from its construction to its destruction.
+    struct scoped_timer
+    {
+        explicit scoped_timer(histogram &into)
+            : into(into), start(std::chrono::steady_clock::now())
+        {}
+
+        ~scoped_timer() {
+            std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+            into.observe(elapsed.count());
+        }
+
+      private:
+        histogram &into;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    using labels = std::vector< std::pair< std::string, std::string > >;
+
+    //
+    // Families of metrics by name. Registering a metric of the same name and
+    // labels again returns the registered one. Names are given without the
+    // `_total` suffix of counters, which the export adds.
+    //
+    struct registry
+    {
+        static registry &global();
+
+        counter &make_counter(string_ref name, string_ref help, labels by = {});
+        gauge &make_gauge(string_ref name, string_ref help, labels by = {});
+        histogram &make_histogram(
+            string_ref name, string_ref help, labels by = {},
+            std::vector< double > bounds = histogram::latency_bounds()
+        );
+
+        // Gauge computed at every export, e.g., the resident memory.
+        void make_gauge_fn(
+            string_ref name, string_ref help, std::function< double() > fn, labels by = {}
+        );
+
+        void write_openmetrics(llvm::raw_ostream &os) const;
+
+      private:
+        enum class kind { counter, gauge, histogram };
+
+        struct metric
+        {
+            labels by;
+            std::unique_ptr< counter > as_counter;
+            std::unique_ptr< gauge > as_gauge;
+            std::unique_ptr< histogram > as_histogram;
+            std::function< double() > fn;
+        };
+
+        struct family
+        {
+            std::string name;
+            std::string help;
+            kind type;
+            std::vector< metric > metrics;
+        };
+
+        metric &make(string_ref name, string_ref help, kind type, labels by);
+
+        mutable std::mutex mutex;
+        std::vector< family > families;
+    };
+
+    // Gauges of the process: its resident memory and uptime.
+    void register_process_metrics(registry &reg = registry::global());
+
+    //
+    // Publishes a registry: `:<port>` or `<host>:<port>` serves it over http,
+    // every request is answered by the metrics, any other spec is a file
+    // rewritten every few seconds, `<path>[@<seconds>]`, 10 by default.
+    //
+    // A single-threaded process, e.g., a server that forks, polls `fd` with
+    // its other descriptors and calls `poll` when it is readable or the poll
+    // times out after `interval`. Others `start` a thread that does so.
+    //
+    struct exporter
+    {
+        // Returns null and reports the error for a malformed spec.
+        static std::unique_ptr< exporter > make(string_ref spec, registry &reg = registry::global());
+
+        virtual ~exporter();
+
+        // Descriptor that becomes readable when there is work, -1 if none.
+        virtual int fd() const { return -1; }
+
+        virtual void poll() = 0;
+
+        std::chrono::milliseconds interval() const { return period; }
+
+        void start();
+
+        // Joins the thread of `start`, derived exporters stop before they
+        // are destroyed.
+        void stop();
+
+      protected:
+        exporter(registry &reg, std::chrono::milliseconds period) : reg(reg), period(period) {}
+
+        registry &reg;
+        std::chrono::milliseconds period;
+
+      private:
+        std::atomic< bool > stopped = false;
+        std::thread worker;
+    };
+
+} // namespace vast::metrics
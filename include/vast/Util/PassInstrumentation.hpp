@@ -0,0 +1,40 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Pass/PassManager.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast {
+
+    struct memory_report;
+
+    //
+    // Instrumentation of pass managers owned by vast (`-vast-pass-timing`,
+    // `-vast-pass-statistics`, `-vast-ir-size-report`, `-vast-pattern-profile`,
+    // `-vast-trace` and `-vast-memory-report`).
+    // All reports are printed to stderr once the pass manager is destroyed.
+    //
+    struct pass_manager_config
+    {
+        bool timing = false;
+        bool statistics = false;
+        // Number of operations per dialect before and after each pass.
+        bool ir_size_report = false;
+        // Per-pattern statistics of conversion passes, see `pattern_profile`.
+        bool pattern_profile = false;
+        // A time trace scope per pass run, recorded by the time trace profiler
+        // of the thread that runs the pass.
+        bool trace = false;
+        // Sampled after each pass on the root operation, not owned.
+        memory_report *memory = nullptr;
+        // Verify the ir after each pass.
+        bool verify_each = true;
+    };
+
+    void configure_pass_manager(mlir::PassManager &pm, const pass_manager_config &config);
+
+} // namespace vast
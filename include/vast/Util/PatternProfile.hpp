@@ -0,0 +1,83 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/PatternMatch.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vast {
+
+    //
+    // pattern_profile
+    //
+    // Per-pattern match attempts, successes and cumulative time of a conversion
+    // pass (`profile-patterns` pass option or `-vast-pattern-profile`). Patterns
+    // are instrumented by `profile_patterns` before the set is frozen. The time
+    // is exclusive, i.e., it does not contain legalization of the operations
+    // created by the pattern. The report is printed to stderr once the profile
+    // is destroyed, which is when the last clone of the pass goes away.
+    //
+    struct pattern_profile
+    {
+        using clock = std::chrono::steady_clock;
+
+        struct entry
+        {
+            explicit entry(std::string name) : name(std::move(name)) {}
+
+            void record(bool success, clock::duration time) {
+                ++attempts;
+                if (success) {
+                    ++successes;
+                }
+                nanoseconds += std::chrono::duration_cast< std::chrono::nanoseconds >(time).count();
+            }
+
+            std::string name;
+            std::atomic< std::uint64_t > attempts = 0;
+            std::atomic< std::uint64_t > successes = 0;
+            std::atomic< std::int64_t > nanoseconds = 0;
+        };
+
+        explicit pattern_profile(string_ref pass) : pass(pass.str()) {}
+        ~pattern_profile() { print(llvm::errs()); }
+
+        pattern_profile(const pattern_profile &) = delete;
+        pattern_profile &operator=(const pattern_profile &) = delete;
+
+        std::shared_ptr< entry > make_entry(string_ref name);
+
+        // Entries of the same pattern instantiated by multiple clones
+        // of the pass are merged, rows are sorted by time.
+        void print(llvm::raw_ostream &os) const;
+
+      private:
+        std::string pass;
+
+        mutable std::mutex mutex;
+        std::vector< std::shared_ptr< entry > > entries;
+    };
+
+    // Replaces every native pattern of `patterns` by a wrapper that records
+    // its statistics to `profile`.
+    void profile_patterns(mlir::RewritePatternSet &patterns, pattern_profile &profile);
+
+    // Default of `profile-patterns` for passes created afterwards, set by
+    // `-vast-pattern-profile`.
+    void enable_pattern_profiling(bool enable);
+    bool pattern_profiling_enabled();
+
+} // namespace vast
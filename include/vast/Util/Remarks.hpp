@@ -0,0 +1,102 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/Operation.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+#include <string>
+
+namespace vast::remarks {
+
+    //
+    // Optimization remarks of vast passes
+    //
+    // A remark is an mlir remark at the location of the operation, fused with
+    // the metadata of the remark, i.e., its kind, the pass that emits it, its
+    // name and the enclosing function. The message ends with the option that
+    // selects it, as remarks of clang do, e.g.,
+    //
+    //   remark: region is kept, it has jump targets [-Rpass-missed=vast-hl-dce]
+    //
+    // `vast-front` reports remarks as clang remarks of `-Rpass=<regex>`,
+    // `-Rpass-missed=<regex>` and `-Rpass-analysis=<regex>` that match the
+    // name of the pass and records them with `-fsave-optimization-record`.
+    // Passes are named by their arguments, e.g., `vast-hl-dce`.
+    //
+    enum class remark_kind { passed, missed, analysis };
+
+    string_ref to_string(remark_kind kind);
+
+    // The option that selects remarks of the kind, e.g., `-Rpass-missed`.
+    string_ref option(remark_kind kind);
+
+    struct remark_info
+    {
+        remark_kind kind;
+        std::string pass;
+        std::string name;
+        // Empty outside of functions.
+        std::string function;
+        // Without the option of the remark.
+        std::string message;
+    };
+
+    // The remark of a diagnostic emitted by `remark`, nothing for other
+    // diagnostics.
+    std::optional< remark_info > get_remark_info(mlir::Diagnostic &diag);
+
+    //
+    // Builder of a remark, the remark is emitted once the builder goes away,
+    // i.e., at the end of the full expression that streams its message:
+    //
+    //   remarks::missed(op, "vast-hl-dce", "KeptRegion") << "...";
+    //
+    struct remark
+    {
+        remark(remark_kind kind, operation op, string_ref pass, string_ref name);
+        ~remark();
+
+        remark(const remark &) = delete;
+        remark &operator=(const remark &) = delete;
+
+        template< typename T >
+        remark &operator<<(T &&value) {
+            os << std::forward< T >(value);
+            return *this;
+        }
+
+      private:
+        remark_kind kind;
+        operation op;
+        std::string pass;
+        std::string name;
+
+        std::string message;
+        llvm::raw_string_ostream os;
+    };
+
+    // Something was optimized.
+    inline remark passed(operation op, string_ref pass, string_ref name) {
+        return remark(remark_kind::passed, op, pass, name);
+    }
+
+    // Something was left unoptimized, the message says why.
+    inline remark missed(operation op, string_ref pass, string_ref name) {
+        return remark(remark_kind::missed, op, pass, name);
+    }
+
+    // A decision of the pass that explains the code it produces.
+    inline remark analysis(operation op, string_ref pass, string_ref name) {
+        return remark(remark_kind::analysis, op, pass, name);
+    }
+
+} // namespace vast::remarks
@@ -6,6 +6,9 @@
 
 VAST_RELAX_WARNINGS
 #include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/raw_ostream.h>
 VAST_UNRELAX_WARNINGS
 
@@ -14,6 +17,9 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Interfaces/SymbolInterface.hpp"
 
+#include <optional>
+#include <vector>
+
 namespace vast::util
 {
     using vast_symbol_interface   = vast::VastSymbolOpInterface;
@@ -38,6 +44,41 @@ namespace vast::util
         });
     }
 
+    //
+    // Walks of the symbols that live outside of function bodies, i.e.,
+    // functions, global variables and symbol tables. The walks do not descend
+    // into bodies of functions, so a query of a large module visits its
+    // top-level operations instead of all of its operations. A function
+    // itself is yielded, `op` may be one.
+    //
+    void walk_outside_functions(mlir::Operation *op, auto &&yield) {
+        op->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *child) {
+            yield(child);
+            return mlir::isa< mlir::FunctionOpInterface >(child)
+                ? mlir::WalkResult::skip()
+                : mlir::WalkResult::advance();
+        });
+    }
+
+    void global_symbols(mlir::Operation *op, auto &&yield) {
+        walk_outside_functions(op, [&] (mlir::Operation *child) {
+            if (auto symbol = mlir::dyn_cast< vast_symbol_interface >(child)) {
+                yield(symbol);
+            }
+            else if (auto symbol = mlir::dyn_cast< mlir_symbol_interface >(child)) {
+                yield(symbol);
+            }
+        });
+    }
+
+    void global_symbol_tables(mlir::Operation *op, auto &&yield) {
+        walk_outside_functions(op, [&] (mlir::Operation *child) {
+            if (child->hasTrait< mlir::OpTrait::SymbolTable >()) {
+                yield(child);
+            }
+        });
+    }
+
     template< typename Yield >
     void functions(mlir::Operation *op, Yield &&yield) {
         // TODO use mlir::FunctionOpInterface?
@@ -50,28 +91,84 @@ namespace vast::util
 
     static inline auto symbol_name(mlir_symbol_interface value) { return value.getName(); }
 
-    void yield_symbol_users(vast_symbol_interface op, auto scope, auto &&yield) {
-        for (auto user : op->getUsers()) {
-            yield(user);
+    //
+    // Users of symbols, resolved by a single walk of the nearest symbol table
+    // of `root` instead of a walk of the scope for every looked up symbol.
+    // Users of vast symbols are the users of their values, users of mlir
+    // symbols are the operations nested in the scope that refer to them.
+    //
+    struct symbol_user_map
+    {
+        explicit symbol_user_map(mlir::Operation *root)
+            : table(mlir::SymbolTable::getNearestSymbolTable(root))
+        {
+            if (table) {
+                mlir_users.emplace(tables, table);
+            }
         }
-    };
 
-    void yield_symbol_users(mlir_symbol_interface op, auto scope, auto &&yield) {
-        if (auto users = op.getSymbolUses(scope)) {
-            for (auto use : *users) {
-                yield(use.getUser());
+        symbol_user_map(const symbol_user_map &) = delete;
+        symbol_user_map &operator=(const symbol_user_map &) = delete;
+
+        void yield_users(vast_symbol_interface op, mlir::Operation *, auto &&yield) const {
+            for (auto user : op->getUsers()) {
+                yield(user);
+            }
+        }
+
+        void yield_users(mlir_symbol_interface op, mlir::Operation *scope, auto &&yield) const {
+            if (!mlir_users) {
+                return;
+            }
+
+            for (auto user : mlir_users->getUsers(op)) {
+                if (scope->isProperAncestor(user)) {
+                    yield(user);
+                }
             }
         }
+
+      private:
+        mlir::Operation *table;
+        mlir::SymbolTableCollection tables;
+        std::optional< mlir::SymbolUserMap > mlir_users;
     };
 
-    void yield_users(string_ref symbol, auto scope, auto &&yield) {
-        auto filter_symbols = [&](auto op) {
-            if (util::symbol_name(op) == symbol) {
-                yield_symbol_users(op, scope, std::forward< decltype(yield) >(yield));
+    // Users of the symbols of all `names` in `scope` by one walk of the
+    // scope, yielded with the name of their symbol in the order of `names`.
+    // The map may be of an enclosing scope, e.g., kept for many queries.
+    void yield_users(
+        const symbol_user_map &map, llvm::ArrayRef< string_ref > names,
+        mlir::Operation *scope, auto &&yield
+    ) {
+        llvm::StringMap< std::vector< mlir::Operation * > > users;
+        for (auto name : names) {
+            users.try_emplace(name);
+        }
+
+        util::symbols(scope, [&] (auto op) {
+            auto it = users.find(util::symbol_name(op));
+            if (it != users.end()) {
+                map.yield_users(op, scope, [&] (auto user) { it->second.push_back(user); });
             }
-        };
+        });
+
+        for (auto name : names) {
+            for (auto user : users.lookup(name)) {
+                yield(name, user);
+            }
+        }
+    }
+
+    void yield_users(llvm::ArrayRef< string_ref > names, mlir::Operation *scope, auto &&yield) {
+        symbol_user_map map(scope);
+        yield_users(map, names, scope, std::forward< decltype(yield) >(yield));
+    }
 
-        util::symbols(scope, filter_symbols);
+    void yield_users(string_ref symbol, mlir::Operation *scope, auto &&yield) {
+        yield_users(llvm::ArrayRef< string_ref >(symbol), scope, [&] (string_ref, auto user) {
+            yield(user);
+        });
     }
 
     std::string show_location(auto &value) {
@@ -48,7 +48,7 @@ namespace vast
 
             static bool has( mlir::Block &block )
             {
-                if ( std::distance( block.begin(), block.end() ) == 0 )
+                if ( block.empty() )
                     return false;
                 return self_t::is( &block.back() );
             }
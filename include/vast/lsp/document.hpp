@@ -0,0 +1,74 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/Tools/lsp-server-support/Protocol.h>
+#include <llvm/ADT/ArrayRef.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::lsp
+{
+    namespace proto = mlir::lsp;
+
+    //
+    // Document open in the server. Answers are in the positions of its
+    // current text.
+    //
+    struct document
+    {
+        virtual ~document() = default;
+
+        virtual void update(
+            llvm::ArrayRef< proto::TextDocumentContentChangeEvent > changes, std::int64_t version
+        ) = 0;
+
+        virtual std::optional< proto::Hover > hover(proto::Position pos) const = 0;
+        virtual std::vector< proto::Location > definition(proto::Position pos) const = 0;
+        virtual std::vector< proto::Location > references(proto::Position pos, bool declaration) const = 0;
+    };
+
+    using document_ptr = std::unique_ptr< document >;
+
+    // May be called from a background thread of a document.
+    using diagnostics_publisher = std::function< void(const proto::PublishDiagnosticsParams &) >;
+
+    struct identifier
+    {
+        string_ref name;
+        proto::Range range;
+    };
+
+    // Identifier of the text around a position, columns count bytes.
+    std::optional< identifier > identifier_at(string_ref text, proto::Position pos);
+
+    // First file location of `loc`.
+    std::optional< mlir::FileLineColLoc > file_location(mlir::Location loc);
+
+    // Markdown of the operation without its regions.
+    std::string hover_markdown(mlir::Operation *op);
+
+    //
+    // Textual module, parsed by its top-level operations. See
+    // `module_document.cpp`. Documents share the context and parse in it
+    // under `ctx_mutex`.
+    //
+    document_ptr make_module_document(
+        const proto::URIForFile &uri, std::string text, std::int64_t version,
+        mcontext_t &ctx, std::mutex &ctx_mutex, diagnostics_publisher publish
+    );
+
+} // namespace vast::lsp
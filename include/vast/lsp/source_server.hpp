@@ -0,0 +1,29 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/DialectRegistry.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::lsp
+{
+    //
+    // Language server of C and C++ sources. Every open document keeps its
+    // precompiled preamble and the high-level module of its last successful
+    // compilation, hover, definition and references are answered from the
+    // symbols of the module. Textual modules, `.mlir` documents, are parsed
+    // in the dialects of `registry` by their top-level operations and
+    // verified in the background. With `lit_test` messages are delimited by
+    // `// -----` lines as in the tests of MLIR language servers. A non-empty
+    // `metrics_spec` exports metrics of the server, see `metrics::exporter`.
+    //
+    logical_result serve_sources(
+        mlir::DialectRegistry &registry, bool lit_test, string_ref metrics_spec = {}
+    );
+
+} // namespace vast::lsp
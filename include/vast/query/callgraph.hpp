@@ -0,0 +1,98 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::query
+{
+    //
+    // Call graph of a module. Functions are numbered in the order they are
+    // first seen in the module, each pair of a caller and a callee is an
+    // edge once. An indirect call is an edge to every function whose address
+    // is taken in the module, unless there is a direct call as well.
+    //
+    // Strongly connected components are computed when the graph is built
+    // and kept in the index with it, reachability is a walk of the graph.
+    //
+    struct call_graph
+    {
+        struct edge
+        {
+            std::uint32_t caller, callee;
+            bool indirect;
+        };
+
+        // Edges may repeat and come in any order.
+        static call_graph build(std::vector< std::string > functions, std::vector< edge > edges);
+
+        // Graph of an index, edges are sorted and unique.
+        static call_graph load(
+            std::vector< std::string > functions, std::vector< edge > edges,
+            std::vector< std::uint32_t > components
+        );
+
+        std::size_t size() const { return functions.size(); }
+
+        string_ref name(std::uint32_t fn) const { return functions[fn]; }
+
+        std::optional< std::uint32_t > lookup(string_ref name) const;
+
+        llvm::ArrayRef< edge > get_edges() const { return edges; }
+
+        std::uint32_t component(std::uint32_t fn) const { return components[fn]; }
+
+        void for_each_callee(std::uint32_t fn, auto &&yield) const {
+            for (auto e = first_callee[fn]; e < first_callee[fn + 1]; ++e) {
+                yield(edges[e]);
+            }
+        }
+
+        void for_each_caller(std::uint32_t fn, auto &&yield) const {
+            for (auto e = first_caller[fn]; e < first_caller[fn + 1]; ++e) {
+                yield(edges[by_callee[e]]);
+            }
+        }
+
+        // Functions reachable from `entries`, the entries included.
+        std::vector< bool > reachable(llvm::ArrayRef< std::uint32_t > entries) const;
+
+        // Components of more functions or of a function that calls itself,
+        // their functions in increasing order.
+        std::vector< std::vector< std::uint32_t > > recursive_components() const;
+
+      private:
+        call_graph(std::vector< std::string > functions, std::vector< edge > edges)
+            : functions(std::move(functions)), edges(std::move(edges))
+        {}
+
+        void index();
+        void compute_components();
+
+        std::vector< std::string > functions;
+        // Sorted by caller and callee.
+        std::vector< edge > edges;
+        std::vector< std::uint32_t > components;
+
+        // Offsets of the edges of each function as a caller, into `edges`,
+        // and as a callee, into `by_callee`.
+        std::vector< std::uint32_t > first_callee;
+        std::vector< std::uint32_t > first_caller;
+        std::vector< std::uint32_t > by_callee;
+
+        llvm::StringMap< std::uint32_t > ids;
+    };
+
+} // namespace vast::query
@@ -0,0 +1,160 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/query/callgraph.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::query
+{
+    // Kinds a symbol is listed by `--show-symbols`, a symbol may have none
+    // and is then listed only by `--show-symbols=all`.
+    enum symbol_kind : std::uint32_t {
+        function_symbol = 1 << 0,
+        type_symbol     = 1 << 1,
+        record_symbol   = 1 << 2,
+        var_symbol      = 1 << 3,
+        global_symbol   = 1 << 4
+    };
+
+    // Size and modification time of the module an index was built from.
+    struct source_stamp
+    {
+        std::uint64_t size  = 0;
+        std::uint64_t mtime = 0;
+
+        bool operator==(const source_stamp &) const = default;
+    };
+
+    std::optional< source_stamp > get_source_stamp(string_ref path);
+
+    //
+    // Symbol index of a module, answers symbol queries without parsing the
+    // module. The index consists of views, one of the whole module and one
+    // for each scope `--scope` may select, in the order the scopes are
+    // looked up. A view lists its symbols in the order of the module walk,
+    // each with its rendered line, kinds and the rendered users of the
+    // symbol as seen from the scope of the view. The index also keeps the
+    // call graph of the module with its strongly connected components.
+    //
+    // The file is a little-endian header followed by arrays of fixed-size
+    // records of views, symbols, users, functions and calls, and a pool of
+    // strings they refer to by offset and length. It is memory mapped and
+    // read in place.
+    //
+    struct index_builder
+    {
+        void add_view(string_ref scope);
+
+        // Adds a symbol to the last view.
+        void add_symbol(
+            string_ref name, string_ref text, std::uint32_t kinds,
+            const std::vector< std::string > &users
+        );
+
+        void set_call_graph(const call_graph &graph);
+
+        void write(llvm::raw_ostream &os, std::optional< source_stamp > stamp) const;
+
+      private:
+        struct string_entry { std::uint32_t offset, size; };
+
+        string_entry intern(string_ref str);
+
+        struct view_entry { string_entry name; std::uint32_t first, size; };
+        struct symbol_entry {
+            string_entry name, text;
+            std::uint32_t kinds, first, size;
+        };
+
+        struct function_entry { string_entry name; std::uint32_t component; };
+        struct call_entry { std::uint32_t caller, callee, indirect; };
+
+        std::vector< view_entry > views;
+        std::vector< symbol_entry > symbols;
+        std::vector< string_entry > users;
+        std::vector< function_entry > functions;
+        std::vector< call_entry > calls;
+
+        llvm::StringMap< std::uint32_t > interned;
+        std::string strings;
+    };
+
+    struct symbol_index
+    {
+        // Reports the reason in `err` and returns nothing if the file is not
+        // a well-formed index.
+        static std::optional< symbol_index > open(string_ref path, std::string *err);
+
+        // No stamp if the index was built from the standard input.
+        std::optional< source_stamp > stamp() const;
+
+        struct symbol
+        {
+            string_ref name;
+            string_ref text;
+            std::uint32_t kinds;
+            std::vector< string_ref > users;
+        };
+
+        struct view
+        {
+            const symbol_index *index;
+            std::uint32_t first, size;
+
+            void for_each_symbol(auto &&yield) const {
+                for (auto s = first; s < first + size; ++s) {
+                    yield(index->get_symbol(s));
+                }
+            }
+        };
+
+        // View of the module if `scope` is empty, otherwise every view of a
+        // scope of that name.
+        void for_each_view(string_ref scope, auto &&yield) const {
+            for (std::uint32_t v = 0; v < num_views(); ++v) {
+                if (scope.empty() ? v != 0 : view_name(v) != scope) {
+                    continue;
+                }
+
+                auto [first, size] = view_symbols(v);
+                yield(view{ this, first, size });
+            }
+        }
+
+        call_graph get_call_graph() const;
+
+      private:
+        explicit symbol_index(std::unique_ptr< llvm::MemoryBuffer > buffer)
+            : buffer(std::move(buffer))
+        {}
+
+        bool verify(std::string *err) const;
+
+        std::uint32_t read32(std::size_t offset) const;
+        std::uint64_t read64(std::size_t offset) const;
+        string_ref read_string(std::size_t offset) const;
+
+        std::uint32_t num_views() const;
+        string_ref view_name(std::uint32_t v) const;
+        std::pair< std::uint32_t, std::uint32_t > view_symbols(std::uint32_t v) const;
+        symbol get_symbol(std::uint32_t idx) const;
+
+        std::unique_ptr< llvm::MemoryBuffer > buffer;
+    };
+
+} // namespace vast::query
@@ -0,0 +1,53 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Operation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace vast::query
+{
+    //
+    // Structural pattern of `--match`, an operation with constraints on its
+    // attributes, operands and the operations around it:
+    //
+    //   pattern    := names constraint*
+    //   names      := glob ('|' glob)*
+    //   constraint := '!' constraint
+    //               | 'callee' '(' glob ')'
+    //               | 'attr' '(' name ['=' glob] ')'
+    //               | 'operand' '(' index ',' value ')'
+    //               | 'contains' '(' pattern ')'
+    //               | 'inside' '(' pattern ')'
+    //   value      := ['!'] ('const' | pattern)
+    //
+    // E.g., `hl.call callee(memcpy) operand(2, !const)` or
+    // `hl.for|hl.while contains(hl.call)`. A pattern is parsed once and
+    // is immutable, it is matched from any number of threads.
+    //
+    struct op_pattern
+    {
+        static std::optional< op_pattern > parse(string_ref text, std::string *err);
+
+        bool match(operation op) const;
+
+        struct node;
+
+      private:
+        explicit op_pattern(std::shared_ptr< const node > root)
+            : root(std::move(root))
+        {}
+
+        std::shared_ptr< const node > root;
+    };
+
+} // namespace vast::query
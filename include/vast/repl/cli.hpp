@@ -26,11 +26,28 @@ namespace vast::repl
         }
 
         void exec(command_ptr cmd) try {
+            cmd::collect_job(state, false);
+            // Queries of a pending load have no tower to read yet.
+            if (state.job && (!cmd->concurrent() || !state.tower)) {
+                VAST_ERROR(
+                    "error: `{0}` is running, `wait` for it or `cancel` it",
+                    state.job->description
+                );
+            }
             cmd->run(state);
         } catch (std::exception &e) {
             llvm::errs() << "error: " << e.what() << '\n';
         }
 
+        // Reports a job that finished since the last command.
+        void poll() try {
+            cmd::collect_job(state, false);
+        } catch (std::exception &e) {
+            llvm::errs() << "error: " << e.what() << '\n';
+        }
+
+        bool cancel() { return cmd::cancel_job(state); }
+
       private:
         state_t state;
     };
@@ -7,6 +7,7 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
 #include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/PrecompiledPreamble.h>
 #include <clang/Tooling/Tooling.h>
 #include <mlir/IR/Builders.h>
 VAST_UNRELAX_WARNINGS
@@ -15,11 +16,33 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGen.hpp"
 
 #include <filesystem>
+#include <optional>
 
 namespace vast::repl::codegen {
 
     std::unique_ptr< clang::ASTUnit > ast_from_source(string_ref source);
 
-    owning_module_ref emit_module(const std::filesystem::path &source, mcontext_t *ctx);
+    //
+    // Precompiled preamble of the loaded source, its `#include`s and other
+    // directives before the first declaration, kept in memory as clangd keeps
+    // it. A reload that changes only the rest of the source reuses it and
+    // parses the headers no more.
+    //
+    struct preamble_cache
+    {
+        // Empty if the source has no preamble or it cannot be built.
+        const clang::PrecompiledPreamble *get(
+            const clang::CompilerInvocation &invocation, const llvm::MemoryBuffer &buffer,
+            llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem > vfs,
+            clang::DiagnosticsEngine &diags
+        );
+
+      private:
+        std::optional< clang::PrecompiledPreamble > preamble;
+    };
+
+    owning_module_ref emit_module(
+        const std::filesystem::path &source, mcontext_t *ctx, preamble_cache &preamble
+    );
 
 } // namespace vast::repl::codegen
@@ -33,6 +33,10 @@ namespace vast::repl
             using command_params = util::type_list<>;
 
             virtual void run(state_t &) const = 0;
+
+            // Commands that only read the tower may run while a job is pending.
+            virtual bool concurrent() const { return false; }
+
             virtual ~base(){};
         };
 
@@ -44,6 +48,12 @@ namespace vast::repl
 
         void check_and_emit_module(state_t &state);
 
+        // Applies the result of a finished job, or waits for it first.
+        void collect_job(state_t &state, bool block);
+
+        // Returns false if there is no job to cancel.
+        bool cancel_job(state_t &state);
+
         //
         // params
         //
@@ -63,15 +73,28 @@ namespace vast::repl
             VAST_UNREACHABLE("uknnown show kind: {0}", token.str());
         }
 
-        enum class meta_action { add, get };
+        enum class meta_action { add, get, open, blob, attached, put, save };
 
         template< typename enum_type >
         enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, meta_action >) {
-            if (token == "add") return enum_type::add;
-            if (token == "get") return enum_type::get;
+            if (token == "add")      return enum_type::add;
+            if (token == "get")      return enum_type::get;
+            if (token == "open")     return enum_type::open;
+            if (token == "blob")     return enum_type::blob;
+            if (token == "attached") return enum_type::attached;
+            if (token == "put")      return enum_type::put;
+            if (token == "save")     return enum_type::save;
             VAST_UNREACHABLE("uknnown action kind: {0}", token.str());
         }
 
+        enum class timed_command { raise };
+
+        template< typename enum_type >
+        enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, timed_command >) {
+            if (token == "raise") return enum_type::raise;
+            VAST_UNREACHABLE("uknnown timed command: {0}", token.str());
+        }
+
         //
         // named param
         //
@@ -133,6 +156,8 @@ namespace vast::repl
             using base::command_params;
 
             void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
         };
 
         //
@@ -144,18 +169,24 @@ namespace vast::repl
             using base::command_params;
 
             void run(state_t&) const override;
+
+            bool concurrent() const override { return true; }
         };
 
         //
         // load command
         //
+        // `load <file> &` compiles the source on a background thread.
+        //
         struct load : base {
             static constexpr string_ref name() { return "load"; }
 
-            static constexpr inline char source_param[] = "source";
+            static constexpr inline char source_param[]     = "source";
+            static constexpr inline char background_param[] = "&";
 
             using command_params = util::type_list<
-                named_param< source_param, file_param >
+                named_param< source_param, file_param >,
+                named_param< background_param, flag_param >
             >;
 
             using params_storage = command_params::as_tuple;
@@ -187,22 +218,28 @@ namespace vast::repl
 
             void run(state_t &state) const override;
 
+            bool concurrent() const override { return true; }
+
             params_storage params;
         };
 
         //
         // meta command
         //
+        // The second argument is an identifier, or the file of a store for
+        // `open` and `save`, the third one a symbol, or the file of a blob
+        // for `put`.
+        //
         struct meta : base {
             static constexpr string_ref name() { return "meta"; }
 
             static constexpr inline char action_param[] = "meta_action";
-            static constexpr inline char symbol_param[]     = "symbol";
-            static constexpr inline char identifier_param[] = "identifier";
+            static constexpr inline char symbol_param[]   = "symbol";
+            static constexpr inline char argument_param[] = "argument";
 
             using command_params = util::type_list<
                 named_param< action_param, meta_action >,
-                named_param< identifier_param, integer_param >,
+                named_param< argument_param, string_param >,
                 named_param< symbol_param, string_param >
             >;
 
@@ -215,6 +252,13 @@ namespace vast::repl
 
             void add(state_t &state) const;
             void get(state_t &state) const;
+            void open(state_t &state) const;
+            void blob(state_t &state) const;
+            void attached(state_t &state) const;
+            void put(state_t &state) const;
+            void save(state_t &state) const;
+
+            ::vast::meta::identifier_t identifier() const;
 
             params_storage params;
         };
@@ -222,13 +266,19 @@ namespace vast::repl
         //
         // apply command
         //
+        // `raise <pipeline> &` applies the passes on a background thread, the
+        // levels already in the tower can be queried meanwhile.
+        //
         struct raise : base {
             static constexpr string_ref name() { return "raise"; }
 
-            static constexpr inline char pipeline_param[] = "pipeline_name";
+            static constexpr inline char pipeline_param[]   = "pipeline_name";
+            static constexpr inline char background_param[] = "&";
 
-            using command_params =
-                util::type_list< named_param< pipeline_param, string_param > >;
+            using command_params = util::type_list<
+                named_param< pipeline_param, string_param >,
+                named_param< background_param, flag_param >
+            >;
 
             using params_storage = command_params::as_tuple;
 
@@ -240,7 +290,222 @@ namespace vast::repl
             params_storage params;
         };
 
-        using command_list = util::type_list< exit, help, load, show, meta, raise >;
+        //
+        // diff command
+        //
+        // `diff <level> <level>` compares two levels of the tower, the second
+        // derived from the first, by their provenance.
+        //
+        struct diff : base {
+            static constexpr string_ref name() { return "diff"; }
+
+            static constexpr inline char from_param[] = "from_level";
+            static constexpr inline char to_param[]   = "to_level";
+
+            using command_params = util::type_list<
+                named_param< from_param, integer_param >,
+                named_param< to_param, integer_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            diff(const params_storage &params) : params(params) {}
+            diff(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+
+            params_storage params;
+        };
+
+        //
+        // time command
+        //
+        // `time raise <pipeline>` raises the tower as `raise` does and reports
+        // the wall time, operation counts and memory of each step.
+        //
+        struct time : base {
+            static constexpr string_ref name() { return "time"; }
+
+            static constexpr inline char command_param[]  = "timed_command";
+            static constexpr inline char pipeline_param[] = "pipeline_name";
+
+            using command_params = util::type_list<
+                named_param< command_param, timed_command >,
+                named_param< pipeline_param, string_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            time(const params_storage &params) : params(params) {}
+            time(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // profile command
+        //
+        // `profile raise <pipeline>` reports the steps as `time` does and the
+        // time of each pass of a step by the MLIR timing manager.
+        //
+        struct profile : base {
+            static constexpr string_ref name() { return "profile"; }
+
+            static constexpr inline char command_param[]  = "timed_command";
+            static constexpr inline char pipeline_param[] = "pipeline_name";
+
+            using command_params = util::type_list<
+                named_param< command_param, timed_command >,
+                named_param< pipeline_param, string_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            profile(const params_storage &params) : params(params) {}
+            profile(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // run command
+        //
+        // `run <function> [args] [O0-3]` executes a function of the top of the
+        // tower compiled by ORC, `args` are comma separated integers. The
+        // default optimization level is O2.
+        //
+        struct run_function : base {
+            static constexpr string_ref name() { return "run"; }
+
+            static constexpr inline char function_param[] = "function";
+            static constexpr inline char args_param[]     = "args";
+            static constexpr inline char opt_param[]      = "opt_level";
+
+            using command_params = util::type_list<
+                named_param< function_param, string_param >,
+                named_param< args_param, string_param >,
+                named_param< opt_param, string_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            run_function(const params_storage &params) : params(params) {}
+            run_function(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+
+            params_storage params;
+        };
+
+        //
+        // bench command
+        //
+        // `bench <function> <count> [args] [O0-3]` executes the function
+        // `count` times and reports the minimal and the median time.
+        //
+        struct bench_function : base {
+            static constexpr string_ref name() { return "bench"; }
+
+            static constexpr inline char function_param[] = "function";
+            static constexpr inline char count_param[]    = "count";
+            static constexpr inline char args_param[]     = "args";
+            static constexpr inline char opt_param[]      = "opt_level";
+
+            using command_params = util::type_list<
+                named_param< function_param, string_param >,
+                named_param< count_param, integer_param >,
+                named_param< args_param, string_param >,
+                named_param< opt_param, string_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            bench_function(const params_storage &params) : params(params) {}
+            bench_function(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+
+            params_storage params;
+        };
+
+        //
+        // spill command
+        //
+        // `spill <directory> <budget>` writes intermediate levels of the tower
+        // to `directory` once the resident ones exceed `budget` operations.
+        //
+        struct spill : base {
+            static constexpr string_ref name() { return "spill"; }
+
+            static constexpr inline char directory_param[] = "directory";
+            static constexpr inline char budget_param[]    = "budget";
+
+            using command_params = util::type_list<
+                named_param< directory_param, file_param >,
+                named_param< budget_param, integer_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            spill(const params_storage &params) : params(params) {}
+            spill(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // jobs, wait and cancel commands
+        //
+        // `jobs` reports the progress of the background job, `wait` blocks
+        // until it is done and `cancel` stops it after its current step, as
+        // Ctrl-C does at the prompt.
+        //
+        struct jobs : base {
+            static constexpr string_ref name() { return "jobs"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+        };
+
+        struct wait : base {
+            static constexpr string_ref name() { return "wait"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+        };
+
+        struct cancel : base {
+            static constexpr string_ref name() { return "cancel"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool concurrent() const override { return true; }
+        };
+
+        using command_list = util::type_list<
+            exit, help, load, show, meta, raise, diff, time, profile, run_function,
+            bench_function, spill, jobs, wait, cancel
+        >;
 
     } // namespace command
 
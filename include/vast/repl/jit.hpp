@@ -0,0 +1,52 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/repl/common.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace mlir
+{
+    class ExecutionEngine;
+} // namespace mlir
+
+namespace vast::repl::jit {
+
+    //
+    // A function of a module lowered by `lower_hl_module` and compiled by
+    // ORC. Functions of at most four integer parameters and an integer or
+    // void result can be called, the arguments are truncated to the widths
+    // of the parameters and the result is sign extended.
+    //
+    struct compiled_function
+    {
+        static constexpr unsigned max_params = 4;
+
+        // The module is lowered in place.
+        compiled_function(owning_module_ref mod, string_ref name, unsigned opt_level);
+        compiled_function(compiled_function &&);
+        ~compiled_function();
+
+        unsigned params() const { return param_count; }
+
+        // Empty if the function returns void.
+        std::optional< std::int64_t > call(llvm::ArrayRef< std::int64_t > args) const;
+
+      private:
+        std::unique_ptr< mlir::ExecutionEngine > engine;
+        void *address = nullptr;
+        unsigned param_count = 0;
+        // Zero for void functions.
+        unsigned result_width = 0;
+    };
+
+} // namespace vast::repl::jit
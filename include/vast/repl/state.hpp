@@ -2,13 +2,52 @@
 
 #pragma once
 
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Dialect/Meta/MetaStore.hpp"
 #include "vast/Tower/Tower.hpp"
+#include "vast/repl/codegen.hpp"
 #include "vast/repl/common.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
 
 namespace vast::repl {
 
+    struct state_t;
+
+    // Provenance is kept in a side table, so that `spill` can drop the levels
+    // it writes to disk.
+    using tower_t = tw::side_table_tower;
+
+    //
+    // A `load` or `raise` running on a background thread while the repl keeps
+    // reading commands. Results are applied to the state by the main thread
+    // when the job is collected, cancellation is checked between steps.
+    //
+    struct job_t {
+        using finish_t = std::function< void(state_t &) >;
+
+        explicit job_t(std::string description, std::size_t total)
+            : description(std::move(description)), total(total)
+        {}
+
+        std::string description;
+        std::size_t total;
+        std::atomic< std::size_t > done = 0;
+        std::atomic< bool > cancelled = false;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::future< finish_t > result;
+    };
+
     struct state_t {
         explicit state_t(mcontext_t &ctx) : ctx(ctx) {}
 
@@ -16,8 +55,24 @@ namespace vast::repl {
 
         std::optional< std::filesystem::path > source;
 
+        // Preamble of the source, kept across its reloads.
+        codegen::preamble_cache preamble;
+
         mcontext_t &ctx;
-        std::optional< tw::default_tower > tower;
+        std::optional< tower_t > tower;
+
+        // Identifier indices of the modules of the tower, dropped whenever
+        // the tower changes.
+        llvm::DenseMap< mlir::Operation *, meta::identifier_index > identifiers;
+
+        // External metadata opened by `meta open`, and blobs put since, which
+        // `meta save` writes together with the open ones.
+        std::optional< meta::store > metadata;
+        meta::store_builder staged;
+
+        // Declared last, a pending job is joined before the rest of the state
+        // it works with is destroyed.
+        std::unique_ptr< job_t > job;
     };
 
 } // namespace vast::repl
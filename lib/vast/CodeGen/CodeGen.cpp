@@ -4,4 +4,12 @@
 
 namespace vast::cg
 {
+    template struct fallback_visitor<
+        default_visitor_instance, default_visitor, unsup_visitor, unreach_visitor
+    >;
+    template struct table_dispatch_visitor<
+        default_visitor_instance, default_visitor, unsup_visitor, unreach_visitor
+    >;
+    template struct visitor_instance< default_visitor_stack >;
+    template struct codegen_instance< default_visitor_stack >;
 } // namespace vast::cg
@@ -5,10 +5,52 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/Basic/TargetInfo.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <mlir/Pass/PassManager.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+#include <atomic>
+
 namespace vast::cg
 {
+    codegen_driver::codegen_driver(
+        codegen_context &cgctx, cc::action_options &opts, const cc::vast_args &vargs
+    )
+        : cgctx(cgctx)
+        , opts(opts)
+        , vargs(vargs)
+        , verify_threads(parse_verify_threads(vargs))
+        , decls_only(vargs.has_option(cc::opt::emit_decls_only))
+        , reachable_roots(parse_reachable_roots(vargs))
+        , lazy_bodies(
+            vargs.has_option(cc::opt::lazy_function_bodies) || !reachable_roots.empty()
+        )
+        , elide_unsup(vargs.has_option(cc::opt::elide_unsupported))
+        , decl_report(make_codegen_report(cgctx, vargs))
+        , profile(make_codegen_profile(opts))
+        , instrumentation(make_profile_instrumentation(cgctx, opts))
+        , headers(header_cache::make(cgctx, opts, vargs))
+        , meta(make_meta_generator(cgctx, vargs))
+        , codegen(std::make_unique< default_codegen >(cgctx, *meta))
+    {
+        cgctx.headers = headers.get();
+
+        if (decl_report) {
+            codegen->builder.setListener(decl_report.get());
+        }
+    }
+
+    codegen_driver::~codegen_driver() {
+        VAST_ASSERT(deferred_inline_member_func_defs.empty());
+        VAST_ASSERT(deferred_function_bodies.empty());
+    }
+
     defer_handle_of_top_level_decl::defer_handle_of_top_level_decl(
         codegen_driver &codegen, bool emit_deferred
     )
@@ -25,20 +67,110 @@ namespace vast::cg
     }
 
 
+    std::optional< location_detail > parse_location_detail(string_ref value) {
+        return llvm::StringSwitch< std::optional< location_detail > >(value)
+            .Case("none", location_detail::none)
+            .Case("line", location_detail::line)
+            .Case("full", location_detail::full)
+            .Default(std::nullopt);
+    }
+
     meta_generator_ptr make_meta_generator(codegen_context &cgctx, const cc::vast_args &vargs) {
-        // TODO make configurable based on vast args
         if (vargs.has_option(cc::opt::locs_as_meta_ids)) {
             return std::make_unique< id_meta_gen >(&cgctx.actx, &cgctx.mctx);
         }
-        return std::make_unique< default_meta_gen >(&cgctx.actx, &cgctx.mctx);
+
+        auto detail = location_detail::full;
+        if (auto value = vargs.get_option(cc::opt::locs)) {
+            auto parsed = parse_location_detail(value.value());
+            if (!parsed) {
+                VAST_UNREACHABLE("invalid location detail: {0}", value.value());
+            }
+            detail = parsed.value();
+        }
+
+        return std::make_unique< default_meta_gen >(&cgctx.actx, &cgctx.mctx, detail);
+    }
+
+    std::unique_ptr< codegen_report > make_codegen_report(
+        codegen_context &cgctx, const cc::vast_args &vargs
+    ) {
+        if (!vargs.has_option(cc::opt::codegen_report)) {
+            return nullptr;
+        }
+
+        std::size_t limit = 20;
+        if (auto value = vargs.get_option(cc::opt::codegen_report)) {
+            if (value->getAsInteger(10, limit)) {
+                VAST_UNREACHABLE("invalid codegen report size: {0}", value.value());
+            }
+        }
+
+        return std::make_unique< codegen_report >(cgctx.actx, limit);
+    }
+
+    std::unique_ptr< codegen_profile > make_codegen_profile(const cc::action_options &opts) {
+        const auto &codegen = opts.codegen;
+        if (!codegen.hasProfileClangUse()) {
+            return nullptr;
+        }
+
+        return codegen_profile::load(
+            codegen.ProfileInstrumentUsePath, codegen.MainFileName, opts.vfs, opts.diags
+        );
+    }
+
+    std::unique_ptr< profile_instrumentation > make_profile_instrumentation(
+        codegen_context &cgctx, const cc::action_options &opts
+    ) {
+        if (!opts.codegen.hasProfileClangInstr()) {
+            return nullptr;
+        }
+
+        return std::make_unique< profile_instrumentation >(cgctx, opts.codegen.MainFileName);
+    }
+
+    unsigned codegen_driver::parse_verify_threads(const cc::vast_args &vargs) {
+        unsigned threads = 1;
+        if (auto value = vargs.get_option(cc::opt::verify_threads)) {
+            if (value->getAsInteger(10, threads) || threads == 0) {
+                VAST_UNREACHABLE("invalid number of verification threads: {0}", value.value());
+            }
+        }
+        return threads;
+    }
+
+    std::vector< std::string > codegen_driver::parse_reachable_roots(const cc::vast_args &vargs) {
+        std::vector< std::string > roots;
+        if (auto list = vargs.get_options_list(cc::opt::emit_reachable_from)) {
+            for (auto names : list.value()) {
+                llvm::SmallVector< string_ref > split;
+                names.split(split, ',', /* MaxSplit */ -1, /* KeepEmpty */ false);
+                for (auto name : split) {
+                    roots.push_back(name.str());
+                }
+            }
+
+            if (roots.empty()) {
+                VAST_UNREACHABLE("-vast-emit-reachable-from: expected a list of symbols");
+            }
+        }
+        return roots;
     }
 
     void codegen_driver::finalize() {
-        codegen.emit_data_layout();
+        // Deferred bodies need to be built before the data layout is emitted,
+        // as the type visitor collects data layout entries while building them.
+        build_deferred_function_bodies();
+        codegen->emit_data_layout();
         build_deferred();
         // TODO: buildVTablesOpportunistically();
         // TODO: applyGlobalValReplacements();
         apply_replacements();
+        emit_reachable();
+        if (headers) {
+            headers->store();
+        }
         // TODO: checkAliases();
         // TODO: buildMultiVersionFunctions();
         // TODO: buildCXXGlobalInitFunc();
@@ -77,10 +209,16 @@ namespace vast::cg
         // }
 
         // TODO: FINISH THE REST OF THIS
+
+        if (auto report = this->report()) {
+            report->print(llvm::errs());
+        }
+
+        print_elided_report(llvm::errs());
     }
 
     bool codegen_driver::verify_module() const {
-        return codegen.verify_module();
+        return codegen->verify_module();
     }
 
     void codegen_driver::build_deferred_decls() {
@@ -141,7 +279,7 @@ namespace vast::cg
                 break;
             }
             default:
-                codegen.Visit(decl);
+                codegen->Visit(decl);
         }
     }
 
@@ -168,7 +306,7 @@ namespace vast::cg
     }
 
     operation codegen_driver::build_global_function_declaration(clang::GlobalDecl decl) {
-        return codegen.build_function_prototype(decl);
+        return codegen->build_function_prototype(decl);
     }
 
     operation codegen_driver::build_global_function_definition(clang::GlobalDecl decl) {
@@ -181,13 +319,20 @@ namespace vast::cg
             return fn;
         }
 
+        if (emit_decls_only()) {
+            return fn;
+        }
+
+        if (lazy_function_bodies()) {
+            lazy_function_decls.try_emplace(fn.getSymName(), decl);
+            return fn;
+        }
+
         // TODO setGVProperties
         // TODO MaubeHandleStaticInExternC
         // TODO maybeSetTrivialComdat
         // TODO setLLVMFunctionFEnvAttributes
 
-        fn = build_function_body(fn, decl);
-
         // TODO: setNonAliasAttributes
         // TODO: SetLLVMFunctionAttributesForDeclaration
 
@@ -199,18 +344,161 @@ namespace vast::cg
             VAST_UNIMPLEMENTED_MSG("dtor emition");
         }
 
+        if (defer_function_bodies()) {
+            deferred_function_bodies.emplace_back(fn, decl);
+            return fn;
+        }
+
+        return build_function_body(fn, decl);
+    }
+
+    void codegen_driver::build_deferred_function_bodies() {
+        if (deferred_function_bodies.empty()) {
+            return;
+        }
+
+        auto bodies = std::move(deferred_function_bodies);
+        deferred_function_bodies.clear();
+
+        // Clang AST queries used by the visitors (type info, record layouts,
+        // mangling) memoize into unsynchronized caches of the ASTContext, hence
+        // the bodies themselves are built on the consumer thread. Shells were
+        // created in source order, so filling them in place yields the same
+        // module as the eager emission.
+        std::vector< hl::FuncOp > built;
+        built.reserve(bodies.size());
+        for (auto &[fn, decl] : bodies) {
+            // The same definition might have been queued repeatedly.
+            if (!fn.isDeclaration()) {
+                continue;
+            }
+
+            if (auto body = build_function_body(fn, decl, /* verify */ false)) {
+                built.push_back(body);
+            }
+        }
+
+        // Verification of finished bodies needs only the MLIR context and is
+        // distributed over the worker pool.
+        llvm::ThreadPool pool(llvm::hardware_concurrency(verify_threads));
+        std::atomic< bool > failed = false;
+        for (auto fn : built) {
+            pool.async([fn, &failed] () mutable {
+                if (mlir::failed(fn.verifyBody())) {
+                    failed = true;
+                }
+            });
+        }
+        pool.wait();
+
+        VAST_CHECK(!failed, "codegen: malformed function body");
+    }
+
+    hl::FuncOp codegen_driver::materialize(hl::FuncOp fn) {
+        auto it = lazy_function_decls.find(fn.getSymName());
+        if (it == lazy_function_decls.end()) {
+            return fn;
+        }
+
+        auto decl = it->second;
+        lazy_function_decls.erase(it);
+
+        if (!fn.isDeclaration()) {
+            return fn;
+        }
+
+        fn = build_function_body(fn, decl);
+
+        // The body might have referenced declarations that were not needed
+        // by the stubs alone, and introduced new data layout entries.
+        build_deferred();
+        codegen->emit_data_layout();
         return fn;
     }
 
+    void codegen_driver::emit_reachable() {
+        if (reachable_roots.empty()) {
+            return;
+        }
+
+        auto mod = cgctx.mod.get();
+
+        // Variables are not a part of the symbol table of the context, they
+        // are all known by now, as are the prototypes of the functions.
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > variables;
+        for (auto var : mod.getOps< hl::VarDeclOp >()) {
+            variables[var.getName()].push_back(var);
+        }
+
+        llvm::StringSet<> reached;
+        llvm::SmallVector< operation > worklist;
+        auto reach = [&] (string_ref name) {
+            if (reached.contains(name)) {
+                return;
+            }
+
+            if (auto fn = mlir::dyn_cast_or_null< hl::FuncOp >(cgctx.get_global_value(name))) {
+                reached.insert(name);
+                worklist.push_back(materialize(fn));
+            } else if (auto it = variables.find(name); it != variables.end()) {
+                reached.insert(name);
+                worklist.append(it->second.begin(), it->second.end());
+            }
+        };
+
+        for (const auto &root : reachable_roots) {
+            reach(root);
+            VAST_CHECK(reached.contains(root), "-vast-emit-reachable-from: unknown symbol {0}", root);
+        }
+
+        // Names are collected first, materialization adds to the module.
+        llvm::SmallVector< string_ref > names;
+        while (!worklist.empty()) {
+            worklist.pop_back_val()->walk([&] (operation op) {
+                op->getAttrDictionary().walk(
+                    [&] (mlir::StringAttr attr) { names.push_back(attr.getValue()); },
+                    [&] (mlir::FlatSymbolRefAttr attr) { names.push_back(attr.getValue()); }
+                );
+            });
+
+            for (auto name : names) {
+                reach(name);
+            }
+            names.clear();
+        }
+
+        // The symbol dce removes unreached functions and variables, and the
+        // types that only they referred to.
+        mlir::PassManager pm(&cgctx.mctx);
+        pm.addPass(hl::createHLSymbolDCEPass(reachable_roots));
+        VAST_CHECK(mlir::succeeded(pm.run(mod)), "-vast-emit-reachable-from: symbol dce failed");
+
+        llvm::StringSet<> kept;
+        for (auto fn : mod.getOps< hl::FuncOp >()) {
+            kept.insert(fn.getSymName());
+        }
+
+        llvm::SmallVector< string_ref > removed;
+        for (const auto &[name, _] : cgctx.global_symbols) {
+            if (!kept.contains(name)) {
+                removed.push_back(name);
+            }
+        }
+
+        for (auto name : removed) {
+            lazy_function_decls.erase(name);
+            cgctx.replace_global_symbol(name, nullptr);
+        }
+    }
+
     operation codegen_driver::build_global_var_definition(const clang::VarDecl *decl, bool tentative) {
         VAST_UNIMPLEMENTED_IF(lang().OpenCL || lang().OpenMPIsTargetDevice);
 
         VAST_UNIMPLEMENTED_IF(decl->needsDestruction(acontext()) == clang::QualType::DK_cxx_destructor);
 
         VAST_UNIMPLEMENTED_IF(lang().CUDA);
-        VAST_UNIMPLEMENTED_IF(lang().OpenMP);
 
-        return codegen.Visit(decl);
+        return codegen->Visit(decl);
     }
 
     operation codegen_driver::build_global_decl(const clang::GlobalDecl &/* decl */) {
@@ -221,7 +509,9 @@ namespace vast::cg
         const auto *glob = llvm::cast< clang::ValueDecl >(decl.getDecl());
 
         VAST_UNIMPLEMENTED_IF(lang().CUDA);
-        VAST_UNIMPLEMENTED_IF(lang().OpenMP);
+        // Host codegen needs no runtime support for declarations, except for
+        // the offloading ones.
+        VAST_UNIMPLEMENTED_IF(lang().OpenMPIsTargetDevice);
 
         if (const auto *fn = llvm::dyn_cast< clang::FunctionDecl >(glob)) {
             // In contrast to clang codegen we emit also declarations.
@@ -238,7 +528,9 @@ namespace vast::cg
             if (var->isThisDeclarationADefinition() != clang::VarDecl::Definition &&
                 !acontext().isMSStaticDataMemberInlineDefinition(var)
             ) {
-                VAST_UNIMPLEMENTED_IF(lang().OpenMP);
+                VAST_UNIMPLEMENTED_IF(
+                    lang().OpenMP && clang::OMPDeclareTargetDeclAttr::isDeclareTargetDeclaration(var)
+                );
                 // If this declaration may have caused an inline variable definition
                 // to change linkage, make sure that it's emitted.
                 // TODO probably use GetAddrOfGlobalVar(var) below?
@@ -292,7 +584,8 @@ namespace vast::cg
     }
 
     bool codegen_driver::may_be_emitted_eagerly(const clang::ValueDecl *glob) {
-        VAST_UNIMPLEMENTED_IF(lang().OpenMP);
+        // Clang delays threadprivate variables, which vast does not support.
+        VAST_UNIMPLEMENTED_IF(lang().OpenMP && glob->hasAttr< clang::OMPThreadPrivateDeclAttr >());
 
         if (const auto *fn = llvm::dyn_cast< clang::FunctionDecl >(glob)) {
             // Implicit template instantiations may change linkage if they are later
@@ -325,7 +618,7 @@ namespace vast::cg
 
     void codegen_driver::build_deferred() {
         // Emit deferred declare target declarations
-        VAST_UNIMPLEMENTED_IF(lang().OpenMP && !lang().OpenMPSimd);
+        VAST_UNIMPLEMENTED_IF(lang().OpenMPIsTargetDevice);
 
         const auto &deferred_vtables = cgctx.deferred_vtables;
         const auto &deferred_decls_to_emit = cgctx.deferred_decls_to_emit;
@@ -349,6 +642,7 @@ namespace vast::cg
         // work, it will not interfere with this.
         auto curr_decls_to_emit = cgctx.receive_deferred_decls_to_emit();
         for (auto &decl : curr_decls_to_emit) {
+            codegen_report::scope measured(report(), decl.getDecl());
             build_global_decl(decl);
 
             // FIXME: rework to worklist?
@@ -367,6 +661,8 @@ namespace vast::cg
     }
 
     void codegen_driver::apply_replacements() {
+        // A replacement has to be recorded by `cgctx.replace_global_symbol`,
+        // lookups of globals do not scan the module.
         if (!replacements.empty()) {
             VAST_UNIMPLEMENTED_MSG(" function replacement in module release");
         }
@@ -5,8 +5,14 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/Basic/TargetInfo.h>
+#include <llvm/Support/FormatVariadic.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/Dialect/Unsupported/UnsupportedOps.hpp"
+
+#include <algorithm>
+
 namespace vast::cg
 {
     bool codegen_driver::may_drop_function_return(clang::QualType rty) const {
@@ -31,9 +37,9 @@ namespace vast::cg
         // }
 
         if (rty->isVoidType()) {
-            codegen.emit_implicit_void_return(fn, decl);
+            codegen->emit_implicit_void_return(fn, decl);
         } else if (decl->hasImplicitReturnZero()) {
-            codegen.emit_implicit_return_zero(fn, decl);
+            codegen->emit_implicit_return_zero(fn, decl);
         } else if (shoud_emit_unreachable) {
             // C++11 [stmt.return]p2:
             //   Flowing off the end of a function [...] results in undefined behavior
@@ -44,9 +50,9 @@ namespace vast::cg
 
             // TODO: skip if SawAsmBlock
             if (opts.codegen.OptimizationLevel == 0) {
-                codegen.emit_trap(fn, decl);
+                codegen->emit_trap(fn, decl);
             } else {
-                codegen.emit_unreachable(fn, decl);
+                codegen->emit_unreachable(fn, decl);
             }
         } else {
             VAST_UNIMPLEMENTED_MSG("unknown missing return case");
@@ -70,7 +76,7 @@ namespace vast::cg
 
         auto &last_block = fn.getBody().back();
         auto missing_return = [&] (auto &block) {
-            if (codegen.has_insertion_block()) {
+            if (codegen->has_insertion_block()) {
                 if (auto op = get_last_effective_operation(block)) {
                     return !op->template hasTrait< core::return_trait >();
                 }
@@ -95,15 +101,109 @@ namespace vast::cg
         return fn;
     }
 
+    hl::FuncOp codegen_driver::elide_unsupported_body(hl::FuncOp fn) {
+        if (!elide_unsup || fn.isDeclaration()) {
+            return fn;
+        }
+
+        llvm::StringMap< unsigned > kinds;
+        fn.walk([&] (operation op) {
+            if (auto stmt = mlir::dyn_cast< unsup::UnsupportedStmt >(op)) {
+                ++kinds[stmt.getName()];
+            } else if (auto decl = mlir::dyn_cast< unsup::UnsupportedDecl >(op)) {
+                // Names of declarations are `<kind>::<name>`.
+                ++kinds[decl.getName().split("::").first];
+            }
+        });
+
+        if (kinds.empty()) {
+            return fn;
+        }
+
+        ++elided_bodies;
+        for (const auto &entry : kinds) {
+            elided_kinds[entry.getKey()] += entry.getValue();
+        }
+
+        auto &body = fn.getBody();
+        auto types = llvm::to_vector(body.getArgumentTypes());
+        auto locs  = llvm::to_vector(llvm::map_range(body.getArguments(), [] (auto arg) {
+            return arg.getLoc();
+        }));
+
+        body.dropAllReferences();
+        body.getBlocks().clear();
+
+        auto entry = new mlir::Block();
+        entry->addArguments(types, locs);
+        body.push_back(entry);
+
+        mlir::OpBuilder bld(fn.getContext());
+        bld.setInsertionPointToEnd(entry);
+        bld.create< unsup::UnsupportedStmt >(
+            fn.getLoc(), "elided", mlir_type(), std::vector< BuilderCallBackFn >{}
+        );
+        return fn;
+    }
+
+    void codegen_driver::print_elided_report(llvm::raw_ostream &os) const {
+        if (elided_bodies == 0) {
+            return;
+        }
+
+        std::vector< std::pair< string_ref, unsigned > > sorted;
+        for (const auto &entry : elided_kinds) {
+            sorted.emplace_back(entry.getKey(), entry.getValue());
+        }
+        std::sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+
+        os << llvm::formatv("vast elided {0} unsupported function bodies\n", elided_bodies);
+        os << llvm::formatv("{0,10}  {1}\n", "ops", "kind");
+        for (const auto &[kind, count] : sorted) {
+            os << llvm::formatv("{0,10}  {1}\n", count, kind);
+        }
+    }
+
+    header_cache *codegen_driver::headers_of(clang::GlobalDecl decl) const {
+        return cgctx.is_imported(decl.getDecl()) ? headers.get() : nullptr;
+    }
+
+    void codegen_driver::apply_profile(hl::FuncOp fn, clang::GlobalDecl decl) {
+        auto function_decl = clang::cast< clang::FunctionDecl >(decl.getDecl());
+        if (profile) {
+            profile->annotate(fn, function_decl);
+        }
+
+        if (instrumentation) {
+            instrumentation->instrument(fn, function_decl);
+        }
+    }
+
     // This function implements the logic from CodeGenFunction::GenerateCode
-    hl::FuncOp codegen_driver::build_function_body(hl::FuncOp fn, clang::GlobalDecl decl) {
-        fn = codegen.emit_function_prologue(fn, decl, opts);
+    hl::FuncOp codegen_driver::build_function_body(
+        hl::FuncOp fn, clang::GlobalDecl decl, bool verify
+    ) {
+        auto headers = headers_of(decl);
+        if (headers && headers->reuse_body(fn)) {
+            return fn;
+        }
+
+        fn = codegen->emit_function_prologue(fn, decl, opts);
 
-        if (mlir::failed(fn.verifyBody())) {
+        if (!fn || (verify && mlir::failed(fn.verifyBody()))) {
             return nullptr;
         }
 
-        return emit_function_epilogue(fn, decl);
+        fn = elide_unsupported_body(emit_function_epilogue(fn, decl));
+        apply_profile(fn, decl);
+
+        if (headers) {
+            headers->record_body(fn);
+        }
+
+        return fn;
     }
 
 } // namespace vast::cg
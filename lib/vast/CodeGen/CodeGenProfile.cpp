@@ -0,0 +1,798 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/CodeGenProfile.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ExprCXX.h>
+#include <clang/AST/StmtCXX.h>
+#include <clang/AST/StmtObjC.h>
+#include <clang/AST/StmtVisitor.h>
+#include <clang/Basic/DiagnosticFrontend.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/GlobalValue.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MD5.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace vast::cg
+{
+    namespace
+    {
+        using counters = codegen_profile::counters;
+
+        // Statements with a counter of their own, cf. `PGO_HASH_V1` of clang.
+        bool has_counter(const clang::Stmt *stmt) {
+            if (auto bin = clang::dyn_cast< clang::BinaryOperator >(stmt)) {
+                return bin->getOpcode() == clang::BO_LAnd || bin->getOpcode() == clang::BO_LOr;
+            }
+
+            return clang::isa<
+                clang::LabelStmt, clang::WhileStmt, clang::DoStmt, clang::ForStmt,
+                clang::CXXForRangeStmt, clang::ObjCForCollectionStmt, clang::SwitchStmt,
+                clang::SwitchCase, clang::IfStmt, clang::CXXTryStmt, clang::CXXCatchStmt,
+                clang::AbstractConditionalOperator
+            >(stmt);
+        }
+
+        // Pre-order traversal of a function body. Bodies of blocks, lambdas and
+        // captured statements are functions of their own.
+        template< typename callback_t >
+        void traverse(const clang::Stmt *stmt, callback_t &&callback) {
+            if (!stmt || clang::isa< clang::BlockExpr, clang::LambdaExpr, clang::CapturedStmt >(stmt)) {
+                return;
+            }
+
+            callback(stmt);
+            for (auto child : stmt->children()) {
+                traverse(child, callback);
+            }
+        }
+
+        struct counter_map
+        {
+            llvm::DenseMap< const clang::Stmt *, unsigned > indices;
+            unsigned size = 0;
+        };
+
+        counter_map map_counters(const clang::Stmt *body) {
+            counter_map map;
+            map.indices[body] = map.size++;
+            traverse(body, [&] (const clang::Stmt *stmt) {
+                if (has_counter(stmt)) {
+                    map.indices[stmt] = map.size++;
+                }
+            });
+            return map;
+        }
+
+        using weights_t = llvm::SmallVector< std::uint64_t, 2 >;
+
+        //
+        // Propagates counters through the control flow of a function body as
+        // clang's ComputeRegionCounts does. Only the counts needed for branch
+        // weights are kept.
+        //
+        struct region_counts : clang::ConstStmtVisitor< region_counts >
+        {
+            region_counts(const counter_map &map, const counters &counts)
+                : map(map), counts(counts)
+            {}
+
+            struct break_continue
+            {
+                std::uint64_t break_count = 0;
+                std::uint64_t continue_count = 0;
+            };
+
+            const counter_map &map;
+            const counters &counts;
+
+            std::uint64_t current = 0;
+
+            // Innermost loops and switches, targets of `break` and `continue`.
+            llvm::SmallVector< break_continue, 8 > jumps;
+            // Label counts of the switches being visited, the default one first.
+            llvm::SmallVector< weights_t, 4 > switches;
+
+            llvm::DenseMap< const clang::Stmt *, weights_t > weights;
+
+            std::uint64_t region_count(const clang::Stmt *stmt) const {
+                auto it = map.indices.find(stmt);
+                if (it == map.indices.end() || it->second >= counts.size()) {
+                    return 0;
+                }
+                return counts[it->second];
+            }
+
+            std::uint64_t set_count(std::uint64_t count) { return current = count; }
+
+            // Counts of profiles of multithreaded programs are not always
+            // consistent.
+            static std::uint64_t sub(std::uint64_t lhs, std::uint64_t rhs) {
+                return lhs > rhs ? lhs - rhs : 0;
+            }
+
+            // Weights of the body and of the exit, cf. `createProfileWeightsForLoop`.
+            void loop_weights(const clang::Stmt *loop, std::uint64_t body, std::uint64_t cond) {
+                if (cond != 0) {
+                    weights[loop] = { body, sub(std::max(cond, body), body) };
+                }
+            }
+
+            void visit(const clang::Stmt *stmt) {
+                if (stmt) {
+                    Visit(stmt);
+                }
+            }
+
+            void VisitStmt(const clang::Stmt *stmt) {
+                for (auto child : stmt->children()) {
+                    visit(child);
+                }
+            }
+
+            void VisitBlockExpr(const clang::BlockExpr *) {}
+            void VisitLambdaExpr(const clang::LambdaExpr *) {}
+            void VisitCapturedStmt(const clang::CapturedStmt *) {}
+
+            void VisitReturnStmt(const clang::ReturnStmt *stmt) {
+                visit(stmt->getRetValue());
+                set_count(0);
+            }
+
+            void VisitCXXThrowExpr(const clang::CXXThrowExpr *expr) {
+                visit(expr->getSubExpr());
+                set_count(0);
+            }
+
+            void VisitGotoStmt(const clang::GotoStmt *) { set_count(0); }
+
+            void VisitIndirectGotoStmt(const clang::IndirectGotoStmt *stmt) {
+                visit(stmt->getTarget());
+                set_count(0);
+            }
+
+            // The counter of a label counts all entries, including fallthrough.
+            void VisitLabelStmt(const clang::LabelStmt *stmt) {
+                set_count(region_count(stmt));
+                visit(stmt->getSubStmt());
+            }
+
+            void VisitBreakStmt(const clang::BreakStmt *) {
+                VAST_ASSERT(!jumps.empty());
+                jumps.back().break_count += current;
+                set_count(0);
+            }
+
+            void VisitContinueStmt(const clang::ContinueStmt *) {
+                VAST_ASSERT(!jumps.empty());
+                jumps.back().continue_count += current;
+                set_count(0);
+            }
+
+            void VisitWhileStmt(const clang::WhileStmt *stmt) {
+                auto parent = current;
+                jumps.emplace_back();
+                // The body is visited first, so that the condition includes
+                // jumps of the body.
+                auto body = set_count(region_count(stmt));
+                visit(stmt->getBody());
+                auto backedge = current;
+                auto jumped = jumps.pop_back_val();
+                auto cond = set_count(parent + backedge + jumped.continue_count);
+                visit(stmt->getCond());
+                loop_weights(stmt, body, cond);
+                set_count(sub(jumped.break_count + cond, body));
+            }
+
+            void VisitDoStmt(const clang::DoStmt *stmt) {
+                auto loop = region_count(stmt);
+                jumps.emplace_back();
+                set_count(loop + current);
+                visit(stmt->getBody());
+                auto backedge = current;
+                auto jumped = jumps.pop_back_val();
+                auto cond = set_count(backedge + jumped.continue_count);
+                visit(stmt->getCond());
+                loop_weights(stmt, loop, cond);
+                set_count(sub(jumped.break_count + cond, loop));
+            }
+
+            void VisitForStmt(const clang::ForStmt *stmt) {
+                visit(stmt->getInit());
+                auto parent = current;
+                jumps.emplace_back();
+                auto body = set_count(region_count(stmt));
+                visit(stmt->getBody());
+                auto backedge = current;
+                auto jumped = jumps.pop_back_val();
+                if (auto inc = stmt->getInc()) {
+                    set_count(backedge + jumped.continue_count);
+                    visit(inc);
+                }
+                auto cond = set_count(parent + backedge + jumped.continue_count);
+                if (auto cond_expr = stmt->getCond()) {
+                    visit(cond_expr);
+                    loop_weights(stmt, body, cond);
+                }
+                set_count(sub(jumped.break_count + cond, body));
+            }
+
+            void VisitSwitchStmt(const clang::SwitchStmt *stmt) {
+                visit(stmt->getInit());
+                visit(stmt->getCond());
+                set_count(0);
+                jumps.emplace_back();
+                switches.push_back(weights_t{ 0 });
+                visit(stmt->getBody());
+                auto jumped = jumps.pop_back_val();
+                // A switch does not own continues of its body.
+                if (!jumps.empty()) {
+                    jumps.back().continue_count += jumped.continue_count;
+                }
+                weights[stmt] = switches.pop_back_val();
+                // The counter of a switch counts its exits.
+                set_count(region_count(stmt));
+            }
+
+            // The counter of a case counts only jumps from the switch header.
+            void VisitSwitchCase(const clang::SwitchCase *stmt) {
+                auto count = region_count(stmt);
+                set_count(current + count);
+                if (!switches.empty()) {
+                    if (clang::isa< clang::DefaultStmt >(stmt)) {
+                        switches.back().front() = count;
+                    } else {
+                        switches.back().push_back(count);
+                    }
+                }
+                visit(stmt->getSubStmt());
+            }
+
+            void VisitIfStmt(const clang::IfStmt *stmt) {
+                auto parent = current;
+                visit(stmt->getInit());
+                visit(stmt->getCond());
+                auto then = set_count(region_count(stmt));
+                visit(stmt->getThen());
+                auto out = current;
+                auto other = sub(parent, then);
+                if (auto els = stmt->getElse()) {
+                    set_count(other);
+                    visit(els);
+                    out += current;
+                } else {
+                    out += other;
+                }
+                weights[stmt] = { then, other };
+                set_count(out);
+            }
+
+            void VisitAbstractConditionalOperator(const clang::AbstractConditionalOperator *expr) {
+                visit(expr->getCond());
+                auto parent = current;
+                set_count(region_count(expr));
+                visit(expr->getTrueExpr());
+                auto out = current;
+                set_count(sub(parent, region_count(expr)));
+                visit(expr->getFalseExpr());
+                set_count(out + current);
+            }
+
+            void visit_logical(const clang::BinaryOperator *expr) {
+                visit(expr->getLHS());
+                auto parent = current;
+                auto rhs = set_count(region_count(expr));
+                visit(expr->getRHS());
+                set_count(sub(parent + rhs, current));
+            }
+
+            void VisitBinLAnd(const clang::BinaryOperator *expr) { visit_logical(expr); }
+            void VisitBinLOr(const clang::BinaryOperator *expr) { visit_logical(expr); }
+        };
+
+        // Weights have to fit into 32 bits and must not be zero, see
+        // `createProfileWeights` of clang. Branches that were never taken get
+        // no weights.
+        std::optional< llvm::SmallVector< std::uint32_t > > scale(llvm::ArrayRef< std::uint64_t > counts) {
+            if (counts.empty()) {
+                return std::nullopt;
+            }
+
+            auto max = *std::max_element(counts.begin(), counts.end());
+            if (max == 0) {
+                return std::nullopt;
+            }
+
+            constexpr std::uint64_t limit = std::numeric_limits< std::uint32_t >::max();
+            auto factor = max < limit ? 1 : max / limit + 1;
+
+            llvm::SmallVector< std::uint32_t > weights;
+            for (auto count : counts) {
+                weights.push_back(std::uint32_t(count / factor + 1));
+            }
+            return weights;
+        }
+
+        enum class branch_kind { none, if_stmt, while_stmt, do_stmt, for_stmt, switch_stmt };
+
+        branch_kind kind(const clang::Stmt *stmt) {
+            if (clang::isa< clang::IfStmt >(stmt))     return branch_kind::if_stmt;
+            if (clang::isa< clang::WhileStmt >(stmt))  return branch_kind::while_stmt;
+            if (clang::isa< clang::DoStmt >(stmt))     return branch_kind::do_stmt;
+            if (clang::isa< clang::ForStmt >(stmt))    return branch_kind::for_stmt;
+            if (clang::isa< clang::SwitchStmt >(stmt)) return branch_kind::switch_stmt;
+            return branch_kind::none;
+        }
+
+        branch_kind kind(operation op) {
+            if (mlir::isa< hl::IfOp >(op))     return branch_kind::if_stmt;
+            if (mlir::isa< hl::WhileOp >(op))  return branch_kind::while_stmt;
+            if (mlir::isa< hl::DoOp >(op))     return branch_kind::do_stmt;
+            if (mlir::isa< hl::ForOp >(op))    return branch_kind::for_stmt;
+            if (mlir::isa< hl::SwitchOp >(op)) return branch_kind::switch_stmt;
+            return branch_kind::none;
+        }
+
+        bool is_local(core::GlobalLinkageKind linkage) {
+            return linkage == core::GlobalLinkageKind::InternalLinkage
+                || linkage == core::GlobalLinkageKind::PrivateLinkage;
+        }
+
+        llvm::GlobalValue::LinkageTypes pgo_linkage(hl::FuncOp fn) {
+            return is_local(fn.getLinkage())
+                ? llvm::GlobalValue::InternalLinkage
+                : llvm::GlobalValue::ExternalLinkage;
+        }
+
+        // Statements with a counter, as their operations are matched.
+        enum class counted_kind {
+            none, label, while_stmt, do_stmt, for_stmt, switch_stmt, case_stmt,
+            default_stmt, if_stmt, cond, land, lor,
+            // Counted statements without an operation of their own.
+            other
+        };
+
+        counted_kind counted(const clang::Stmt *stmt) {
+            if (!has_counter(stmt))                            return counted_kind::none;
+            if (clang::isa< clang::LabelStmt >(stmt))          return counted_kind::label;
+            if (clang::isa< clang::WhileStmt >(stmt))          return counted_kind::while_stmt;
+            if (clang::isa< clang::DoStmt >(stmt))             return counted_kind::do_stmt;
+            if (clang::isa< clang::ForStmt >(stmt))            return counted_kind::for_stmt;
+            if (clang::isa< clang::SwitchStmt >(stmt))         return counted_kind::switch_stmt;
+            if (clang::isa< clang::CaseStmt >(stmt))           return counted_kind::case_stmt;
+            if (clang::isa< clang::DefaultStmt >(stmt))        return counted_kind::default_stmt;
+            if (clang::isa< clang::IfStmt >(stmt))             return counted_kind::if_stmt;
+            if (clang::isa< clang::ConditionalOperator >(stmt)) return counted_kind::cond;
+            if (auto bin = clang::dyn_cast< clang::BinaryOperator >(stmt)) {
+                return bin->getOpcode() == clang::BO_LAnd ? counted_kind::land : counted_kind::lor;
+            }
+            return counted_kind::other;
+        }
+
+        counted_kind counted(operation op) {
+            if (mlir::isa< hl::LabelStmt >(op))  return counted_kind::label;
+            if (mlir::isa< hl::WhileOp >(op))    return counted_kind::while_stmt;
+            if (mlir::isa< hl::DoOp >(op))       return counted_kind::do_stmt;
+            if (mlir::isa< hl::ForOp >(op))      return counted_kind::for_stmt;
+            if (mlir::isa< hl::SwitchOp >(op))   return counted_kind::switch_stmt;
+            if (mlir::isa< hl::CaseOp >(op))     return counted_kind::case_stmt;
+            if (mlir::isa< hl::DefaultOp >(op))  return counted_kind::default_stmt;
+            if (mlir::isa< hl::IfOp >(op))       return counted_kind::if_stmt;
+            if (mlir::isa< hl::CondOp >(op))     return counted_kind::cond;
+            if (mlir::isa< hl::BinLAndOp >(op))  return counted_kind::land;
+            if (mlir::isa< hl::BinLOrOp >(op))   return counted_kind::lor;
+            return counted_kind::none;
+        }
+
+        // Region whose execution the counter of `op` counts, cf. where clang
+        // increments the counters of statements. Null for the switch, whose
+        // counter counts its exits.
+        mlir::Region *counted_region(operation op) {
+            if (auto label = mlir::dyn_cast< hl::LabelStmt >(op)) return &label.getBody();
+            if (auto loop = mlir::dyn_cast< hl::WhileOp >(op))    return &loop.getBodyRegion();
+            if (auto loop = mlir::dyn_cast< hl::DoOp >(op))       return &loop.getBodyRegion();
+            if (auto loop = mlir::dyn_cast< hl::ForOp >(op))      return &loop.getBodyRegion();
+            if (auto cs = mlir::dyn_cast< hl::CaseOp >(op))       return &cs.getBody();
+            if (auto cs = mlir::dyn_cast< hl::DefaultOp >(op))    return &cs.getBody();
+            if (auto br = mlir::dyn_cast< hl::IfOp >(op))         return &br.getThenRegion();
+            if (auto cond = mlir::dyn_cast< hl::CondOp >(op))     return &cond.getThenRegion();
+            if (auto bin = mlir::dyn_cast< hl::BinLAndOp >(op))   return &bin.getRhs();
+            if (auto bin = mlir::dyn_cast< hl::BinLOrOp >(op))    return &bin.getRhs();
+            return nullptr;
+        }
+
+        //
+        // Structural hash of a function body, `PGOHash` of clang at
+        // `PGO_HASH_V3`. Types of the hashed statements are packed six bits
+        // each into words, words are combined by MD5 once there is more than
+        // one of them.
+        //
+        struct pgo_hash
+        {
+            enum hash_type : unsigned {
+                none = 0,
+                label_stmt, while_stmt, do_stmt, for_stmt, cxx_for_range_stmt,
+                objc_for_collection_stmt, switch_stmt, case_stmt, default_stmt,
+                if_stmt, cxx_try_stmt, cxx_catch_stmt, conditional_operator,
+                binary_operator_land, binary_operator_lor,
+                // Since `PGO_HASH_V2`.
+                end_of_scope, if_then_branch, if_else_branch, goto_stmt,
+                indirect_goto_stmt, break_stmt, continue_stmt, return_stmt,
+                throw_expr, unary_operator_lnot, binary_operator_lt,
+                binary_operator_gt, binary_operator_le, binary_operator_ge,
+                binary_operator_eq, binary_operator_ne
+            };
+
+            static constexpr unsigned bits_per_type = 6;
+            static constexpr unsigned types_per_word = sizeof(std::uint64_t) * 8 / bits_per_type;
+
+            std::uint64_t working = 0;
+            unsigned count = 0;
+            llvm::MD5 md5;
+
+            void flush() {
+                std::uint64_t swapped = llvm::support::endian::byte_swap< std::uint64_t, llvm::support::little >(working);
+                md5.update(llvm::ArrayRef(reinterpret_cast< const std::uint8_t * >(&swapped), sizeof(swapped)));
+                working = 0;
+            }
+
+            void combine(hash_type type) {
+                if (type == none) {
+                    return;
+                }
+
+                if (count && count % types_per_word == 0) {
+                    flush();
+                }
+
+                ++count;
+                working = working << bits_per_type | type;
+            }
+
+            std::uint64_t finalize() {
+                if (count <= types_per_word) {
+                    return working;
+                }
+
+                if (working) {
+                    flush();
+                }
+
+                llvm::MD5::MD5Result result;
+                md5.final(result);
+                return result.low();
+            }
+
+            static hash_type type_of(const clang::Stmt *stmt) {
+                switch (stmt->getStmtClass()) {
+                    case clang::Stmt::LabelStmtClass:             return label_stmt;
+                    case clang::Stmt::WhileStmtClass:             return while_stmt;
+                    case clang::Stmt::DoStmtClass:                return do_stmt;
+                    case clang::Stmt::ForStmtClass:               return for_stmt;
+                    case clang::Stmt::CXXForRangeStmtClass:       return cxx_for_range_stmt;
+                    case clang::Stmt::ObjCForCollectionStmtClass: return objc_for_collection_stmt;
+                    case clang::Stmt::SwitchStmtClass:            return switch_stmt;
+                    case clang::Stmt::CaseStmtClass:              return case_stmt;
+                    case clang::Stmt::DefaultStmtClass:           return default_stmt;
+                    case clang::Stmt::IfStmtClass:                return if_stmt;
+                    case clang::Stmt::CXXTryStmtClass:            return cxx_try_stmt;
+                    case clang::Stmt::CXXCatchStmtClass:          return cxx_catch_stmt;
+                    case clang::Stmt::ConditionalOperatorClass:
+                    case clang::Stmt::BinaryConditionalOperatorClass:
+                        return conditional_operator;
+                    case clang::Stmt::GotoStmtClass:              return goto_stmt;
+                    case clang::Stmt::IndirectGotoStmtClass:      return indirect_goto_stmt;
+                    case clang::Stmt::BreakStmtClass:             return break_stmt;
+                    case clang::Stmt::ContinueStmtClass:          return continue_stmt;
+                    case clang::Stmt::ReturnStmtClass:            return return_stmt;
+                    case clang::Stmt::CXXThrowExprClass:          return throw_expr;
+                    case clang::Stmt::UnaryOperatorClass:
+                        return clang::cast< clang::UnaryOperator >(stmt)->getOpcode() == clang::UO_LNot
+                            ? unary_operator_lnot : none;
+                    case clang::Stmt::BinaryOperatorClass:
+                        switch (clang::cast< clang::BinaryOperator >(stmt)->getOpcode()) {
+                            case clang::BO_LAnd: return binary_operator_land;
+                            case clang::BO_LOr:  return binary_operator_lor;
+                            case clang::BO_LT:   return binary_operator_lt;
+                            case clang::BO_GT:   return binary_operator_gt;
+                            case clang::BO_LE:   return binary_operator_le;
+                            case clang::BO_GE:   return binary_operator_ge;
+                            case clang::BO_EQ:   return binary_operator_eq;
+                            case clang::BO_NE:   return binary_operator_ne;
+                            default:             return none;
+                        }
+                    default:
+                        return none;
+                }
+            }
+
+            // The traversal of `MapRegionCounters`: branches of ifs and ends
+            // of nestable statements are a part of the hash.
+            void hash(const clang::Stmt *stmt) {
+                if (!stmt || clang::isa< clang::BlockExpr, clang::LambdaExpr, clang::CapturedStmt >(stmt)) {
+                    return;
+                }
+
+                combine(type_of(stmt));
+
+                if (auto branch = clang::dyn_cast< clang::IfStmt >(stmt)) {
+                    for (auto child : branch->children()) {
+                        if (!child) {
+                            continue;
+                        }
+
+                        if (child == branch->getThen()) {
+                            combine(if_then_branch);
+                        } else if (child == branch->getElse()) {
+                            combine(if_else_branch);
+                        }
+                        hash(child);
+                    }
+                    combine(end_of_scope);
+                    return;
+                }
+
+                for (auto child : stmt->children()) {
+                    hash(child);
+                }
+
+                if (clang::isa<
+                    clang::WhileStmt, clang::DoStmt, clang::ForStmt, clang::CXXForRangeStmt,
+                    clang::ObjCForCollectionStmt, clang::CXXTryStmt, clang::CXXCatchStmt
+                >(stmt)) {
+                    combine(end_of_scope);
+                }
+            }
+        };
+
+    } // namespace
+
+    std::unique_ptr< codegen_profile > codegen_profile::load(
+        string_ref path, string_ref main_file,
+        llvm::vfs::FileSystem &fs, clang::DiagnosticsEngine &diags
+    ) {
+        auto reader = llvm::IndexedInstrProfReader::create(path, fs);
+        if (auto err = reader.takeError()) {
+            diags.Report(clang::diag::err_reading_profile) << path << llvm::toString(std::move(err));
+            return nullptr;
+        }
+
+        auto profile = std::unique_ptr< codegen_profile >(
+            new codegen_profile(main_file.str(), (*reader)->getVersion())
+        );
+
+        for (const auto &record : **reader) {
+            profile->records[record.Name].push_back(record.Counts);
+        }
+
+        if ((*reader)->hasError()) {
+            auto err = (*reader)->getError();
+            diags.Report(clang::diag::err_reading_profile) << path << llvm::toString(std::move(err));
+            return nullptr;
+        }
+
+        return profile;
+    }
+
+    const codegen_profile::counters *codegen_profile::lookup(hl::FuncOp fn, std::size_t size) const {
+        auto name = llvm::getPGOFuncName(fn.getSymName(), pgo_linkage(fn), main_file, version);
+        auto it = records.find(name);
+        if (it == records.end()) {
+            return nullptr;
+        }
+
+        for (const auto &counts : it->second) {
+            if (counts.size() == size) {
+                return &counts;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void codegen_profile::annotate(hl::FuncOp fn, const clang::FunctionDecl *decl) const {
+        auto body = decl->getBody();
+        if (!body) {
+            return;
+        }
+
+        auto map = map_counters(body);
+        auto counts = lookup(fn, map.size);
+        if (!counts) {
+            return;
+        }
+
+        auto ctx = fn.getContext();
+        fn->setAttr(hl::EntryCountAttr::attr_name(), hl::EntryCountAttr::get(ctx, counts->front()));
+
+        region_counts regions(map, *counts);
+        regions.set_count(counts->front());
+        regions.visit(body);
+
+        // Codegen emits one operation per statement, if the shapes differ
+        // weights could be attached to wrong operations.
+        std::vector< const clang::Stmt * > stmts;
+        traverse(body, [&] (const clang::Stmt *stmt) {
+            if (kind(stmt) != branch_kind::none) {
+                stmts.push_back(stmt);
+            }
+        });
+
+        std::vector< operation > ops;
+        fn->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (kind(op) != branch_kind::none) {
+                ops.push_back(op);
+            }
+        });
+
+        if (stmts.size() != ops.size()) {
+            return;
+        }
+
+        for (auto [stmt, op] : llvm::zip(stmts, ops)) {
+            if (kind(stmt) != kind(op)) {
+                return;
+            }
+        }
+
+        for (auto [stmt, op] : llvm::zip(stmts, ops)) {
+            auto it = regions.weights.find(stmt);
+            if (it == regions.weights.end()) {
+                continue;
+            }
+
+            if (auto weights = scale(it->second)) {
+                op->setAttr(hl::BranchWeightsAttr::attr_name(), hl::BranchWeightsAttr::get(ctx, *weights));
+            }
+        }
+    }
+
+    hl::FuncOp profile_instrumentation::increment_decl() {
+        if (increment) {
+            return increment;
+        }
+
+        auto &mctx = cgctx.mctx;
+        auto i8  = mlir::IntegerType::get(&mctx, 8);
+        auto i32 = mlir::IntegerType::get(&mctx, 32);
+        auto i64 = mlir::IntegerType::get(&mctx, 64);
+        auto ptr = hl::PointerType::get(&mctx, i8);
+
+        // Counters reference their function by the address of its name.
+        auto &target = cgctx.actx.getTargetInfo();
+        auto width = static_cast< dl::DLEntry::bitwidth_t >(target.getPointerWidth(clang::LangAS::Default));
+        auto align = static_cast< dl::DLEntry::bitwidth_t >(target.getPointerAlign(clang::LangAS::Default));
+        cgctx.dl.add(ptr, dl::DLEntry(ptr, width, align));
+
+        auto mod = cgctx.mod.get();
+        auto bld = mlir::OpBuilder::atBlockBegin(mod.getBody());
+        auto type = core::FunctionType::get({ ptr, i64, i32, i32 }, { hl::VoidType::get(&mctx) });
+        increment = bld.create< hl::FuncOp >(mod.getLoc(), "llvm.instrprof.increment", type);
+        increment.setVisibility(mlir::SymbolTable::Visibility::Private);
+        return increment;
+    }
+
+    hl::VarDeclOp profile_instrumentation::name_var(hl::FuncOp fn) {
+        auto linkage = pgo_linkage(fn);
+        auto name = llvm::getPGOFuncName(fn.getSymName(), linkage, main_file);
+        auto var_name = llvm::getPGOFuncNameVarName(name, linkage);
+
+        auto mod = cgctx.mod.get();
+        if (auto var = mod.lookupSymbol< hl::VarDeclOp >(var_name)) {
+            return var;
+        }
+
+        auto &mctx = cgctx.mctx;
+        auto i8 = mlir::IntegerType::get(&mctx, 8);
+        auto array = hl::ArrayType::get(&mctx, name.size(), i8);
+        cgctx.dl.add(array, dl::DLEntry(array, static_cast< dl::DLEntry::bitwidth_t >(name.size() * 8), 8));
+
+        // The name is not null terminated, as the one of clang.
+        llvm::SmallVector< llvm::APInt > chars;
+        for (auto c : name) {
+            chars.emplace_back(8, static_cast< std::uint8_t >(c));
+        }
+        auto init = mlir::DenseElementsAttr::get(
+            mlir::RankedTensorType::get({ std::int64_t(name.size()) }, i8), chars
+        );
+
+        auto bld = mlir::OpBuilder::atBlockBegin(mod.getBody());
+        auto var = bld.create< hl::VarDeclOp >(mod.getLoc(), hl::LValueType::get(&mctx, array), var_name);
+        var.setStorageClass(hl::StorageClass::sc_static);
+        var.setInitialValueAttr(init);
+        return var;
+    }
+
+    void profile_instrumentation::instrument(hl::FuncOp fn, const clang::FunctionDecl *decl) {
+        auto body = decl->getBody();
+        if (!body || fn.isDeclaration() || decl->isImplicit()
+            || decl->hasAttr< clang::NoProfileFunctionAttr >()
+        ) {
+            return;
+        }
+
+        auto map = map_counters(body);
+
+        std::vector< const clang::Stmt * > stmts;
+        traverse(body, [&] (const clang::Stmt *stmt) {
+            if (counted(stmt) != counted_kind::none) {
+                stmts.push_back(stmt);
+            }
+        });
+
+        std::vector< operation > ops;
+        fn->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (counted(op) != counted_kind::none) {
+                ops.push_back(op);
+            }
+        });
+
+        // If the shapes differ, counters could be attached to wrong
+        // operations.
+        if (stmts.size() != ops.size()) {
+            return;
+        }
+
+        for (auto [stmt, op] : llvm::zip(stmts, ops)) {
+            if (counted(stmt) != counted(op)) {
+                return;
+            }
+        }
+
+        pgo_hash hash;
+        hash.hash(body);
+        auto fn_hash = hash.finalize();
+
+        auto &mctx = cgctx.mctx;
+        auto i32 = mlir::IntegerType::get(&mctx, 32);
+        auto i64 = mlir::IntegerType::get(&mctx, 64);
+        auto ptr = hl::PointerType::get(&mctx, mlir::IntegerType::get(&mctx, 8));
+
+        auto increment = increment_decl();
+        auto name = name_var(fn);
+
+        mlir::OpBuilder bld(&mctx);
+        auto emit = [&] (loc_t loc, unsigned idx) {
+            auto ref = bld.create< hl::GlobalRefOp >(loc, name.getType(), name.getName());
+            auto addr = bld.create< hl::ImplicitCastOp >(loc, ptr, ref, hl::CastKind::ArrayToPointerDecay);
+            auto constant = [&] (mlir_type type, std::uint64_t value) -> mlir_value {
+                auto bits = type.getIntOrFloatBitWidth();
+                return bld.create< hl::ConstantOp >(
+                    loc, type, llvm::APSInt(llvm::APInt(bits, value), /* isUnsigned */ true)
+                );
+            };
+            bld.create< hl::CallOp >(loc, increment, mlir::ValueRange{
+                addr, constant(i64, fn_hash), constant(i32, map.size), constant(i32, idx)
+            });
+        };
+
+        bld.setInsertionPointToStart(&fn.getBody().front());
+        emit(fn.getLoc(), map.indices.lookup(body));
+
+        for (auto [stmt, op] : llvm::zip(stmts, ops)) {
+            auto region = counted_region(op);
+            if (!region) {
+                bld.setInsertionPointAfter(op);
+            } else if (region->empty()) {
+                bld.setInsertionPoint(op);
+            } else {
+                bld.setInsertionPointToStart(&region->front());
+            }
+            emit(op->getLoc(), map.indices.lookup(stmt));
+        }
+    }
+
+} // namespace vast::cg
@@ -0,0 +1,124 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/CodeGenReport.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/GlobalDecl.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace vast::cg
+{
+    static std::int64_t allocated_bytes() {
+    #if defined(__GLIBC__)
+    #if __GLIBC_PREREQ(2, 33)
+        return std::int64_t(::mallinfo2().uordblks);
+    #endif
+    #endif
+        return 0;
+    }
+
+    codegen_report::scope::scope(codegen_report *report, const clang::Decl *decl)
+        : report(report)
+    {
+        if (!report) {
+            return;
+        }
+
+        measured.name     = report->name(decl);
+        measured.location = decl->getLocation().printToString(report->actx.getSourceManager());
+
+        parent = std::exchange(report->active, this);
+        if (parent) {
+            parent->pause();
+        }
+
+        start = report->take_sample();
+    }
+
+    codegen_report::scope::~scope() {
+        if (!report) {
+            return;
+        }
+
+        pause();
+        report->entries.push_back(std::move(measured));
+
+        report->active = parent;
+        if (parent) {
+            parent->resume();
+        }
+    }
+
+    void codegen_report::scope::pause() {
+        auto now = report->take_sample();
+        measured.time  += now.time - start.time;
+        measured.ops   += now.ops - start.ops;
+        measured.bytes += now.bytes - start.bytes;
+    }
+
+    void codegen_report::scope::resume() { start = report->take_sample(); }
+
+    codegen_report::codegen_report(acontext_t &actx, std::size_t limit)
+        : actx(actx), limit(limit), mangle_context(actx.createMangleContext())
+    {}
+
+    auto codegen_report::take_sample() const -> scope::sample {
+        return { .time = clock::now(), .ops = inserted, .bytes = allocated_bytes() };
+    }
+
+    std::string codegen_report::name(const clang::Decl *decl) const {
+        auto named = clang::dyn_cast< clang::NamedDecl >(decl);
+        if (!named || named->getDeclName().isEmpty()) {
+            return llvm::formatv("<{0}>", decl->getDeclKindName()).str();
+        }
+
+        auto mangle = [&] (clang::GlobalDecl glob) {
+            std::string out;
+            llvm::raw_string_ostream os(out);
+            mangle_context->mangleName(glob, os);
+            return out;
+        };
+
+        if (mangle_context->shouldMangleDeclName(named)) {
+            if (clang::isa< clang::CXXConstructorDecl, clang::CXXDestructorDecl >(named)) {
+                return named->getQualifiedNameAsString();
+            }
+
+            if (auto fn = clang::dyn_cast< clang::FunctionDecl >(named)) {
+                return mangle(fn);
+            }
+
+            if (auto var = clang::dyn_cast< clang::VarDecl >(named)) {
+                return mangle(var);
+            }
+        }
+
+        return named->getQualifiedNameAsString();
+    }
+
+    void codegen_report::print(llvm::raw_ostream &os) const {
+        auto sorted = entries;
+        std::stable_sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+            return a.time > b.time;
+        });
+
+        auto count = std::min(limit, sorted.size());
+        os << llvm::formatv("vast codegen report: top {0} of {1} declarations\n", count, sorted.size());
+        os << llvm::formatv("{0,12} {1,10} {2,12}  {3}  {4}\n", "time [us]", "ops", "bytes", "name", "location");
+
+        for (const auto &e : llvm::ArrayRef(sorted).take_front(count)) {
+            auto us = std::chrono::duration_cast< std::chrono::microseconds >(e.time).count();
+            os << llvm::formatv("{0,12} {1,10} {2,12}  {3}  {4}\n", us, e.ops, e.bytes, e.name, e.location);
+        }
+    }
+
+} // namespace vast::cg
@@ -2,6 +2,14 @@
 
 #include "vast/CodeGen/CodeGenStmtVisitor.hpp"
 
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Attr.h>
+#include <clang/AST/StmtOpenMP.h>
+#include <clang/Basic/Builtins.h>
+#include <mlir/IR/Builders.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::hl
 {
     CastKind cast_kind(const clang::CastExpr *expr)
@@ -106,4 +114,200 @@ namespace vast::hl
         }
     }
 
+    std::optional< bool > expected_condition(
+        const clang::ASTContext &actx, const clang::Expr *cond, clang::Stmt::Likelihood lh
+    ) {
+        if (cond) {
+            auto call = llvm::dyn_cast< clang::CallExpr >(cond->IgnoreParenImpCasts());
+            if (call && call->getBuiltinCallee() == clang::Builtin::BI__builtin_expect) {
+                clang::Expr::EvalResult expected;
+                if (call->getArg(1)->EvaluateAsInt(expected, actx)) {
+                    return !expected.Val.getInt().isZero();
+                }
+            }
+        }
+
+        switch (lh) {
+            case clang::Stmt::LH_Likely:   return true;
+            case clang::Stmt::LH_Unlikely: return false;
+            case clang::Stmt::LH_None:     return std::nullopt;
+        }
+    }
+
+    FastMathAttr fast_math(
+        mcontext_t &mctx, const clang::ASTContext &actx, const clang::BinaryOperator *expr
+    ) {
+        auto fp = expr->getFPFeaturesInEffect(actx.getLangOpts());
+
+        bool reassoc  = fp.getAllowFPReassociate();
+        bool nnan     = fp.getNoHonorNaNs();
+        bool ninf     = fp.getNoHonorInfs();
+        bool nsz      = fp.getNoSignedZero();
+        bool arcp     = fp.getAllowReciprocal();
+        bool contract = fp.allowFPContractAcrossStatement();
+        bool afn      = fp.getAllowApproxFunc();
+
+        if (!(reassoc || nnan || ninf || nsz || arcp || contract || afn)) {
+            return {};
+        }
+
+        return FastMathAttr::get(&mctx, reassoc, nnan, ninf, nsz, arcp, contract, afn);
+    }
+
+    bool contracts_within_expression(
+        const clang::ASTContext &actx, const clang::BinaryOperator *expr
+    ) {
+        auto fp = expr->getFPFeaturesInEffect(actx.getLangOpts());
+        return fp.allowFPContractWithinStatement() && !fp.allowFPContractAcrossStatement();
+    }
+
+    LoopHintsAttr loop_hints(
+        mcontext_t &mctx, const clang::ASTContext &actx,
+        llvm::ArrayRef< const clang::Attr * > attrs
+    ) {
+        using hint_t = clang::LoopHintAttr;
+
+        mlir::Builder bld(&mctx);
+        mlir::BoolAttr vectorize, unroll, unroll_full;
+        mlir::IntegerAttr vectorize_width, interleave_count, unroll_count;
+
+        auto count = [&] (const hint_t *hint) -> mlir::IntegerAttr {
+            if (auto value = hint->getValue()) {
+                auto evaluated = value->EvaluateKnownConstInt(actx);
+                return bld.getI32IntegerAttr(static_cast< std::int32_t >(evaluated.getZExtValue()));
+            }
+            return {};
+        };
+
+        for (auto attr : attrs) {
+            auto hint = llvm::dyn_cast< hint_t >(attr);
+            if (!hint) {
+                continue;
+            }
+
+            auto state = hint->getState();
+            switch (hint->getOption()) {
+                case hint_t::Vectorize:
+                    vectorize = bld.getBoolAttr(state != hint_t::Disable);
+                    break;
+                case hint_t::VectorizeWidth:
+                    vectorize_width = count(hint);
+                    break;
+                case hint_t::Interleave:
+                    // Disabled interleaving is interleaving by one, as in clang.
+                    if (state == hint_t::Disable) {
+                        interleave_count = bld.getI32IntegerAttr(1);
+                    }
+                    break;
+                case hint_t::InterleaveCount:
+                    interleave_count = count(hint);
+                    break;
+                case hint_t::Unroll:
+                    if (state == hint_t::Full) {
+                        unroll_full = bld.getBoolAttr(true);
+                    } else {
+                        unroll = bld.getBoolAttr(state != hint_t::Disable);
+                    }
+                    break;
+                case hint_t::UnrollCount:
+                    unroll_count = count(hint);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (!vectorize && !vectorize_width && !interleave_count
+            && !unroll && !unroll_full && !unroll_count
+        ) {
+            return {};
+        }
+
+        return LoopHintsAttr::get(
+            &mctx, vectorize, vectorize_width, interleave_count, unroll, unroll_full, unroll_count
+        );
+    }
+
+    WorksharingAttr worksharing(
+        mcontext_t &mctx, const clang::ASTContext &actx, const clang::OMPLoopDirective *dir
+    ) {
+        llvm::StringRef schedule = "static";
+        mlir::IntegerAttr chunk;
+
+        if (auto clause = dir->getSingleClause< clang::OMPScheduleClause >()) {
+            if (clause->getFirstScheduleModifier() != clang::OMPC_SCHEDULE_MODIFIER_unknown
+                || clause->getSecondScheduleModifier() != clang::OMPC_SCHEDULE_MODIFIER_unknown
+            ) {
+                VAST_UNIMPLEMENTED_MSG("OpenMP schedule modifiers");
+            }
+
+            switch (clause->getScheduleKind()) {
+                case clang::OMPC_SCHEDULE_static:  schedule = "static";  break;
+                case clang::OMPC_SCHEDULE_dynamic: schedule = "dynamic"; break;
+                case clang::OMPC_SCHEDULE_guided:  schedule = "guided";  break;
+                case clang::OMPC_SCHEDULE_auto:    schedule = "auto";    break;
+                case clang::OMPC_SCHEDULE_runtime: schedule = "runtime"; break;
+                case clang::OMPC_SCHEDULE_unknown:
+                    VAST_UNREACHABLE("unknown OpenMP schedule kind");
+            }
+
+            if (auto size = clause->getChunkSize()) {
+                auto value = size->getIntegerConstantExpr(actx);
+                if (!value) {
+                    VAST_UNIMPLEMENTED_MSG("OpenMP chunk size that is not a constant");
+                }
+                chunk = mlir::Builder(&mctx).getI64IntegerAttr(value->getExtValue());
+            }
+        }
+
+        auto nowait = dir->getSingleClause< clang::OMPNowaitClause >() != nullptr;
+        return WorksharingAttr::get(&mctx, schedule, chunk, nowait);
+    }
+
+    MemoryOrder memory_order(const clang::ASTContext &actx, const clang::Expr *order) {
+        if (auto value = order->getIntegerConstantExpr(actx)) {
+            if (auto known = symbolizeMemoryOrder(value->getExtValue())) {
+                return *known;
+            }
+        }
+
+        return MemoryOrder::seq_cst;
+    }
+
+    std::optional< RMWKind > rmw_kind(const clang::AtomicExpr *expr) {
+        using clang::AtomicExpr;
+
+        auto is_signed = expr->getValueType()->isSignedIntegerType();
+
+        switch (expr->getOp()) {
+            case AtomicExpr::AO__atomic_exchange_n:
+            case AtomicExpr::AO__atomic_exchange:
+                return RMWKind::xchg;
+            case AtomicExpr::AO__atomic_fetch_add:
+            case AtomicExpr::AO__atomic_add_fetch:
+                return RMWKind::add;
+            case AtomicExpr::AO__atomic_fetch_sub:
+            case AtomicExpr::AO__atomic_sub_fetch:
+                return RMWKind::sub;
+            case AtomicExpr::AO__atomic_fetch_and:
+            case AtomicExpr::AO__atomic_and_fetch:
+                return RMWKind::_and;
+            case AtomicExpr::AO__atomic_fetch_or:
+            case AtomicExpr::AO__atomic_or_fetch:
+                return RMWKind::_or;
+            case AtomicExpr::AO__atomic_fetch_xor:
+            case AtomicExpr::AO__atomic_xor_fetch:
+                return RMWKind::_xor;
+            case AtomicExpr::AO__atomic_fetch_nand:
+            case AtomicExpr::AO__atomic_nand_fetch:
+                return RMWKind::nand;
+            case AtomicExpr::AO__atomic_fetch_max:
+                return is_signed ? RMWKind::max : RMWKind::umax;
+            case AtomicExpr::AO__atomic_fetch_min:
+                return is_signed ? RMWKind::min : RMWKind::umin;
+            default:
+                return std::nullopt;
+        }
+    }
+
 } // namespace vast::hl
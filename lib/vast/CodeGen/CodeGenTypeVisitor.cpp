@@ -1,6 +1,7 @@
 // Copyright (c) 2022-present, Trail of Bits, Inc.
 
 #include "vast/CodeGen/CodeGenTypeVisitor.hpp"
+#include "vast/CodeGen/CodeGenContext.hpp"
 
 namespace vast::cg {
 
@@ -116,4 +117,67 @@ namespace vast::cg {
             });
     }
 
+    bool is_cacheable_type(clang::QualType type) {
+        const auto *ty = type.getTypePtrOrNull();
+        if (!ty) {
+            return false;
+        }
+
+        if (llvm::isa< clang::TypeOfExprType, clang::TypeOfType >(ty)) {
+            return false;
+        }
+
+        if (auto tag = ty->getAsTagDecl(); tag && !tag->getDefinition()) {
+            return false;
+        }
+
+        if (auto ptr = llvm::dyn_cast< clang::PointerType >(ty)) {
+            return is_cacheable_type(ptr->getPointeeType());
+        }
+
+        if (auto ptr = llvm::dyn_cast< clang::BlockPointerType >(ty)) {
+            return is_cacheable_type(ptr->getPointeeType());
+        }
+
+        if (auto ref = llvm::dyn_cast< clang::ReferenceType >(ty)) {
+            return is_cacheable_type(ref->getPointeeTypeAsWritten());
+        }
+
+        if (auto arr = llvm::dyn_cast< clang::ArrayType >(ty)) {
+            // Sizes of variable arrays are expressions emitted at the point of use.
+            return !llvm::isa< clang::VariableArrayType >(arr)
+                && is_cacheable_type(arr->getElementType());
+        }
+
+        if (auto paren = llvm::dyn_cast< clang::ParenType >(ty)) {
+            return is_cacheable_type(paren->getInnerType());
+        }
+
+        if (auto adjusted = llvm::dyn_cast< clang::AdjustedType >(ty)) {
+            return is_cacheable_type(adjusted->getOriginalType())
+                && is_cacheable_type(adjusted->getAdjustedType());
+        }
+
+        if (auto attributed = llvm::dyn_cast< clang::AttributedType >(ty)) {
+            return is_cacheable_type(attributed->getModifiedType());
+        }
+
+        if (auto elaborated = llvm::dyn_cast< clang::ElaboratedType >(ty)) {
+            return is_cacheable_type(elaborated->getNamedType());
+        }
+
+        if (auto fty = llvm::dyn_cast< clang::FunctionType >(ty)) {
+            if (auto proto = llvm::dyn_cast< clang::FunctionProtoType >(fty)) {
+                for (auto param : proto->getParamTypes()) {
+                    if (!is_cacheable_type(param)) {
+                        return false;
+                    }
+                }
+            }
+            return is_cacheable_type(fty->getReturnType());
+        }
+
+        return true;
+    }
+
 } // namespace vast::hl
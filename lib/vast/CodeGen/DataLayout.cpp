@@ -2,17 +2,68 @@
 
 #include "vast/CodeGen/DataLayout.hpp"
 
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::hl
 {
+    namespace
+    {
+        // Types the module refers to, including types nested in other types
+        // and attributes. The data layout of the module itself is skipped.
+        llvm::DenseSet< mlir_type > used_types(operation root) {
+            llvm::DenseSet< mlir_type > used;
+
+            auto add = [&] (mlir_type type) {
+                if (used.insert(type).second) {
+                    type.walk([&] (mlir_type nested) { used.insert(nested); });
+                }
+            };
+
+            root->walk([&] (operation op) {
+                if (op != root) {
+                    op->getAttrDictionary().walk([&] (mlir_type type) { add(type); });
+                }
+
+                for (auto type : op->getResultTypes()) {
+                    add(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto type : block.getArgumentTypes()) {
+                            add(type);
+                        }
+                    }
+                }
+            });
+
+            return used;
+        }
+
+    } // namespace
+
     void emit_data_layout(mcontext_t &ctx, owning_module_ref &mod, const dl::DataLayoutBlueprint &dl) {
+        // The blueprint contains every type the code generator has visited, some
+        // of which (e.g. types of unused declarations) do not make it to the
+        // module.
+        auto used = used_types(mod.get());
+
         std::vector< mlir::DataLayoutEntryInterface > entries;
-        for (const auto &[_, e] : dl.entries) {
-            entries.push_back(e.wrap(ctx));
+        for (const auto &[type, e] : dl.entries) {
+            if (used.contains(type)) {
+                entries.push_back(e.wrap(ctx));
+            }
         }
 
         mod.get()->setAttr(
             mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(&ctx, entries)
         );
+
+        select_builtin_layout(mod.get());
     }
 
 } // namespace vast::hl
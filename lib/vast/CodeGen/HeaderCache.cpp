@@ -0,0 +1,439 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/HeaderCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeReader.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Parser/Parser.h>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/VirtualFileSystem.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Config/config.h"
+
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+namespace vast::cg
+{
+    namespace
+    {
+        struct key_hasher {
+            void add(string_ref data) {
+                hasher.update(data);
+                // Separate the fields, so that "ab" "c" and "a" "bc" differ.
+                hasher.update(string_ref("\0", 1));
+            }
+
+            std::string hex() { return llvm::toHex(hasher.final(), /* LowerCase */ true); }
+
+            llvm::BLAKE3 hasher;
+        };
+
+        string_ref declared_name(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return fn.getSymName();
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >("name")) {
+                return name.getValue();
+            }
+
+            return {};
+        }
+
+        // Names of the declarations the operation depends on: named types,
+        // symbols and enum constants. A `hl.globref` refers to a variable,
+        // which is never cached, and is reported as an unresolvable name.
+        void dependencies(operation root, auto &&yield_type, auto &&yield_symbol, auto &&yield_constant) {
+            auto type_names = [&] (mlir_type type) {
+                type.walk([&] (mlir_type nested) {
+                    if (auto rec = mlir::dyn_cast< hl::RecordType >(nested)) {
+                        yield_type(rec.getName());
+                    } else if (auto en = mlir::dyn_cast< hl::EnumType >(nested)) {
+                        yield_type(en.getName());
+                    } else if (auto def = mlir::dyn_cast< hl::TypedefType >(nested)) {
+                        yield_type(def.getName());
+                    }
+                });
+            };
+
+            root->walk([&] (operation op) {
+                if (auto ref = mlir::dyn_cast< hl::EnumRefOp >(op)) {
+                    yield_constant(ref.getValue());
+                } else if (mlir::isa< hl::GlobalRefOp >(op)) {
+                    yield_symbol(string_ref());
+                }
+
+                op->getAttrDictionary().walk(
+                    [&] (mlir::FlatSymbolRefAttr attr) { yield_symbol(attr.getValue()); },
+                    [&] (mlir_type type) { type_names(type); }
+                );
+
+                for (auto type : op->getResultTypes()) {
+                    type_names(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            type_names(arg.getType());
+                        }
+                    }
+                }
+            });
+        }
+
+        void dependencies(operation root, auto &&yield) {
+            dependencies(root, yield, yield, yield);
+        }
+
+        bool is_type_decl(operation op) {
+            return mlir::isa<
+                hl::TypeDefOp, hl::TypeDeclOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+        void enum_constants(operation op, auto &&yield) {
+            if (auto en = mlir::dyn_cast< hl::EnumDeclOp >(op); en && !en.getConstants().empty()) {
+                for (auto con : en.getConstants().front().getOps< hl::EnumConstantOp >()) {
+                    yield(con.getName());
+                }
+            }
+        }
+
+        // Types the operations refer to, including nested ones.
+        llvm::DenseSet< mlir_type > used_types(mlir::Block &block) {
+            llvm::DenseSet< mlir_type > used;
+            auto add = [&] (mlir_type type) {
+                type.walk([&] (mlir_type nested) { used.insert(nested); });
+            };
+
+            for (auto &root : block) {
+                root.walk([&] (operation op) {
+                    op->getAttrDictionary().walk([&] (mlir_type type) { add(type); });
+                    for (auto type : op->getResultTypes()) {
+                        add(type);
+                    }
+
+                    for (auto &region : op->getRegions()) {
+                        for (auto &nested : region) {
+                            for (auto type : nested.getArgumentTypes()) {
+                                add(type);
+                            }
+                        }
+                    }
+                });
+            }
+
+            return used;
+        }
+
+    } // namespace
+
+    std::unique_ptr< header_cache > header_cache::make(
+        codegen_context &cgctx, const cc::action_options &opts, const cc::vast_args &vargs
+    ) {
+        auto dir = vargs.get_option(cc::opt::hl_header_cache);
+        if (!dir || opts.pp.ImplicitPCHInclude.empty()) {
+            return nullptr;
+        }
+
+        // Options that make the module differ from the visited declarations:
+        // locations by identifiers, a partial module, or one streamed as it
+        // is emitted.
+        if (vargs.has_option(cc::opt::locs_as_meta_ids)
+            || vargs.has_option(cc::opt::emit_reachable_from)
+            || vargs.has_option(cc::opt::stream_mlir)
+            || opts.codegen.hasProfileClangUse()
+            || opts.codegen.hasProfileClangInstr()
+        ) {
+            return nullptr;
+        }
+
+        auto pch = opts.vfs.getBufferForFile(opts.pp.ImplicitPCHInclude);
+        if (!pch) {
+            return nullptr;
+        }
+
+        key_hasher key;
+        key.add(vast::version);
+        key.add((*pch)->getBuffer());
+        key.add(opts.target.Triple);
+        for (auto arg : vargs.args) {
+            if (!string_ref(arg).contains(cc::opt::hl_header_cache)) {
+                key.add(arg);
+            }
+        }
+
+        // Entries are spread over subdirectories by the first byte.
+        auto hash = key.hex();
+        llvm::SmallString< 256 > path(dir.value());
+        llvm::sys::path::append(path, string_ref(hash).take_front(2), hash + ".mlirbc");
+
+        return std::make_unique< header_cache >(cgctx, std::string(path.str()));
+    }
+
+    header_cache::header_cache(codegen_context &cgctx, std::string path)
+        : cgctx(cgctx), path(std::move(path))
+    {
+        load();
+    }
+
+    void header_cache::load() {
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer) {
+            return;
+        }
+
+        auto block = std::make_unique< mlir::Block >();
+        mlir::ParserConfig parser_config(&cgctx.mctx);
+        if (mlir::failed(mlir::readBytecodeFile((*buffer)->getMemBufferRef(), block.get(), parser_config))
+            || block->empty() || !mlir::isa< mlir::ModuleOp >(block->front())
+        ) {
+            return;
+        }
+
+        auto entry = mlir::cast< mlir::ModuleOp >(block->front());
+        for (auto &op : entry.getBody()->getOperations()) {
+            by_name[declared_name(&op)].push_back(&op);
+            enum_constants(&op, [&] (string_ref name) { enums[name] = &op; });
+        }
+
+        if (auto spec = entry->getAttrOfType< mlir::DataLayoutSpecAttr >(
+            mlir::DLTIDialect::kDataLayoutAttrName
+        )) {
+            for (auto e : spec.getEntries()) {
+                if (dl::DLEntry::is_vast_entry(e)) {
+                    cgctx.dl.add(mlir::cast< mlir_type >(e.getKey()), dl::DLEntry(e));
+                }
+            }
+        }
+
+        cached = std::move(block);
+    }
+
+    operation header_cache::place(operation op) {
+        if (!placed.insert(op).second) {
+            return op;
+        }
+
+        op->remove();
+        cgctx.getBodyRegion().front().push_front(op);
+        if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+            cgctx.declare(mangled_name_ref{ fn.getSymName() }, [fn] { return fn; });
+        }
+
+        pull_dependencies(op);
+        return op;
+    }
+
+    void header_cache::pull_dependencies(operation op) {
+        dependencies(op,
+            [&] (string_ref name) {
+                if (auto it = by_name.find(name); it != by_name.end()) {
+                    for (auto dep : it->second) {
+                        if (is_type_decl(dep)) {
+                            place(dep);
+                        }
+                    }
+                }
+            },
+            [&] (string_ref name) {
+                // Functions emitted by the compilation itself win.
+                if (name.empty() || cgctx.get_global_value(name)) {
+                    return;
+                }
+
+                if (auto it = by_name.find(name); it != by_name.end()) {
+                    for (auto dep : it->second) {
+                        if (mlir::isa< hl::FuncOp >(dep)) {
+                            place(dep);
+                        }
+                    }
+                }
+            },
+            [&] (string_ref name) {
+                if (auto en = enums.lookup(name)) {
+                    place(en);
+                }
+            }
+        );
+    }
+
+    operation header_cache::reuse(string_ref kind, string_ref name) {
+        if (!cached) {
+            return nullptr;
+        }
+
+        auto it = by_name.find(name);
+        if (it == by_name.end()) {
+            return nullptr;
+        }
+
+        for (auto op : it->second) {
+            if (op->getName().getStringRef() == kind) {
+                return place(op);
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool header_cache::reuse_body(hl::FuncOp fn) {
+        if (!cached) {
+            return false;
+        }
+
+        auto it = by_name.find(fn.getSymName());
+        if (it == by_name.end()) {
+            return false;
+        }
+
+        for (auto op : it->second) {
+            auto def = mlir::dyn_cast< hl::FuncOp >(op);
+            if (!def || def.isDeclaration() || placed.contains(op)
+                || def.getFunctionType() != fn.getFunctionType()
+            ) {
+                continue;
+            }
+
+            placed.insert(op);
+            pull_dependencies(op);
+            fn.getBody().takeBody(def.getBody());
+            return true;
+        }
+
+        return false;
+    }
+
+    void header_cache::record(operation op) {
+        if (!cached && op && is_type_decl(op)) {
+            recorded.push_back(op);
+        }
+    }
+
+    void header_cache::record_body(hl::FuncOp fn) {
+        // Bodies are built by the driver or by the visitor, the first one wins.
+        if (!cached && fn && !fn.isDeclaration() && !llvm::is_contained(recorded_bodies, fn)) {
+            recorded_bodies.push_back(fn);
+        }
+    }
+
+    void header_cache::store() const {
+        if (cached || (recorded.empty() && recorded_bodies.empty())) {
+            return;
+        }
+
+        auto &mctx = cgctx.mctx;
+        mlir::OpBuilder bld(&mctx);
+        auto entry = mlir::OwningOpRef< mlir::ModuleOp >(mlir::ModuleOp::create(bld.getUnknownLoc()));
+        bld.setInsertionPointToEnd(entry->getBody());
+
+        llvm::StringSet<> declared;
+        for (auto op : recorded) {
+            bld.clone(*op);
+            declared.insert(declared_name(op));
+        }
+
+        for (auto fn : recorded_bodies) {
+            bld.clone(*fn.getOperation());
+            declared.insert(fn.getSymName());
+        }
+
+        // Callees of the cached bodies are cached as declarations.
+        for (auto fn : recorded_bodies) {
+            dependencies(fn, [&] (string_ref name) {
+                auto callee = mlir::dyn_cast_or_null< hl::FuncOp >(cgctx.get_global_value(name));
+                if (callee && declared.insert(name).second) {
+                    bld.insert(callee.cloneWithoutRegions());
+                }
+            });
+        }
+
+        // Drop whatever refers to a declaration outside of the entry, until
+        // nothing does.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            llvm::StringSet<> names, constants;
+            for (auto &op : entry->getBody()->getOperations()) {
+                if (auto name = declared_name(&op); !name.empty()) {
+                    names.insert(name);
+                }
+                enum_constants(&op, [&] (string_ref name) { constants.insert(name); });
+            }
+
+            for (auto &op : llvm::make_early_inc_range(entry->getBody()->getOperations())) {
+                bool resolved = true;
+                auto check = [&] (const llvm::StringSet<> &set) {
+                    return [&] (string_ref name) { resolved &= set.contains(name); };
+                };
+                dependencies(&op, check(names), check(names), check(constants));
+
+                if (!resolved) {
+                    op.erase();
+                    changed = true;
+                }
+            }
+        }
+
+        if (entry->getBody()->empty()) {
+            return;
+        }
+
+        // Data layout of the types of the entry.
+        if (auto spec = cgctx.mod->getOperation()->getAttrOfType< mlir::DataLayoutSpecAttr >(
+            mlir::DLTIDialect::kDataLayoutAttrName
+        )) {
+            auto used = used_types(*entry->getBody());
+            std::vector< mlir::DataLayoutEntryInterface > entries;
+            for (auto e : spec.getEntries()) {
+                auto type = mlir::dyn_cast< mlir_type >(e.getKey());
+                if (type && used.contains(type)) {
+                    entries.push_back(e);
+                }
+            }
+
+            entry->getOperation()->setAttr(
+                mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(&mctx, entries)
+            );
+        }
+
+        if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+            return;
+        }
+
+        // Concurrent compilations must not see a partial entry.
+        int fd = -1;
+        llvm::SmallString< 256 > temporary;
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, temporary)) {
+            return;
+        }
+
+        bool written = false;
+        {
+            llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+            auto serialized = mlir::succeeded(mlir::writeBytecodeToFile(entry->getOperation(), os));
+            os.close();
+            written = serialized && !os.has_error();
+            os.clear_error();
+        }
+
+        if (!written || llvm::sys::fs::rename(temporary, path)) {
+            llvm::sys::fs::remove(temporary);
+        }
+    }
+
+} // namespace vast::cg
@@ -13,12 +13,18 @@ VAST_UNRELAX_WARNINGS
 namespace vast::cg {
 
     logical_result emit_high_level_pass(
-        vast_module mod, mcontext_t *mctx, acontext_t */* actx */, bool enable_verifier
+        vast_module mod, mcontext_t *mctx, acontext_t */* actx */, bool enable_verifier,
+        bool warn_false_sharing, const pass_manager_config &config
     ) {
         mlir::PassManager mgr(mctx);
+        configure_pass_manager(mgr, config);
 
         // TODO: setup vast intermediate codegen passes
-        mgr.addPass(hl::createSpliceTrailingScopes());
+        mgr.nest< hl::FuncOp >().addPass(hl::createSpliceTrailingScopes());
+
+        if (warn_false_sharing) {
+            mgr.addPass(hl::createHLFalseSharingPass());
+        }
 
         mgr.enableVerifier(enable_verifier);
         return mgr.run(mod);
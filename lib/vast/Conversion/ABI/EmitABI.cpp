@@ -14,6 +14,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Rewrite/PatternApplicator.h>
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/TargetParser/Triple.h>
 VAST_UNRELAX_WARNINGS
 
 #include "../PassesDetails.hpp"
@@ -21,6 +22,8 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Patterns.hpp"
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
@@ -30,9 +33,11 @@ VAST_UNRELAX_WARNINGS
 #include "vast/ABI/ABI.hpp"
 #include "vast/ABI/Driver.hpp"
 
+#include "vast/Util/Analysis.hpp"
 #include "vast/Util/Common.hpp"
 #include "vast/Util/Functions.hpp"
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/Remarks.hpp"
 #include "vast/Util/Symbols.hpp"
 
 #include "vast/Dialect/ABI/ABIOps.hpp"
@@ -56,14 +61,25 @@ namespace vast
     using abi_info_map_t = std::unordered_map< std::string, abi::func_info< Op > >;
 
     template< typename R, typename RootOp, typename DL >
-    auto collect_abi_info(RootOp root_op, const DL &dl)
-        -> abi_info_map_t< R >
-    {
+    auto collect_abi_info(
+        RootOp root_op, const DL &dl, const hl::record_layout_analysis *layouts
+    ) -> abi_info_map_t< R > {
         abi_info_map_t< R > out;
+        // Signatures of a module tend to repeat the same types.
+        abi::classification_cache cache;
+
+        llvm::Triple triple;
+        if (auto attr = root_op->template getAttrOfType< mlir::StringAttr >(
+                core::CoreDialect::getTargetTripleAttrName()))
+            triple = llvm::Triple(attr.getValue());
+
         auto gather = [&](R op, const mlir::WalkStage &)
         {
             auto name = op.getName();
-            out.emplace( name.str(), abi::make_x86_64(op, dl) );
+            if (triple.isAArch64())
+                out.emplace( name.str(), abi::make_aarch64(op, dl, layouts, &cache) );
+            else
+                out.emplace( name.str(), abi::make_x86_64(op, dl, layouts, &cache) );
 
             return mlir::WalkResult::advance();
         };
@@ -72,6 +88,43 @@ namespace vast
         return out;
     }
 
+    // The classification keeps the signature as it is, i.e., every argument
+    // and result is passed directly in its own type. Such functions and their
+    // calls need no wrapping.
+    static inline bool is_abi_trivial(const abi::func_info< hl::FuncOp > &info)
+    {
+        auto is_direct_as = [](const abi::arg_info &arg, mlir_type type) {
+            auto style = std::get_if< abi::direct >(&arg.style);
+            return style && style->target_types.size() == 1 && style->target_types.front() == type;
+        };
+
+        auto fn   = info.raw_fn;
+        auto type = fn.getFunctionType();
+
+        if (info.args().size() != type.getInputs().size())
+            return false;
+
+        for (auto [arg, input] : llvm::zip(info.args(), type.getInputs())) {
+            auto lvalue = mlir::dyn_cast< hl::LValueType >(input);
+            if (!is_direct_as(arg, lvalue ? lvalue.getElementType() : input))
+                return false;
+        }
+
+        for (const auto &ret : info.rets()) {
+            if (std::holds_alternative< abi::ignore >(ret.style)) {
+                auto results = type.getResults();
+                if (!llvm::all_of(results, [](auto t) { return mlir::isa< hl::VoidType >(t); }))
+                    return false;
+                continue;
+            }
+
+            if (type.getResults().size() != 1 || !is_direct_as(ret, type.getResults().front()))
+                return false;
+        }
+
+        return true;
+    }
+
     // TODO(conv:abi): Remove as we most likely do not need this.
     struct TypeConverter : conv::tc::mixins< TypeConverter >,
                            conv::tc::identity_type_converter
@@ -200,10 +253,9 @@ namespace vast
 
             abi::FuncOp make()
             {
-                mlir::SmallVector< mlir::DictionaryAttr, 8 > arg_attrs;
                 mlir::SmallVector< mlir::NamedAttribute, 8 > other_attrs;
 
-                op.getAllArgAttrs(arg_attrs);
+                auto arg_attrs = abified_arg_attrs();
                 auto wrapper = rewriter.template create< abi::FuncOp >(
                         op.getLoc(),
                         // Temporal, to avoid verification issues, will be changed once
@@ -223,6 +275,51 @@ namespace vast
                 return wrapper;
             }
 
+            static mlir::Type strip_lvalue(mlir::Type type)
+            {
+                if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type))
+                    return lvalue.getElementType();
+                return type;
+            }
+
+            // Parameters passed as they are keep their attributes, the parts of
+            // coerced ones are marked instead.
+            mlir::SmallVector< mlir::DictionaryAttr, 8 > abified_arg_attrs()
+            {
+                auto ctx     = op.getContext();
+                auto coerced = mlir::DictionaryAttr::get(ctx, {
+                    mlir::NamedAttribute(
+                        mlir::StringAttr::get(ctx, abi::coerced_arg_attr), mlir::UnitAttr::get(ctx)
+                    )
+                });
+
+                mlir::SmallVector< mlir::DictionaryAttr, 8 > out;
+                auto inputs = op.getFunctionType().getInputs();
+                for (auto [idx, info] : llvm::enumerate(abi_info.args()))
+                {
+                    // Scalars may change only their signedness or width.
+                    auto trgs = info.target_types();
+                    auto as_is = [&] {
+                        if (trgs.size() != 1 || idx >= inputs.size())
+                            return false;
+                        auto trg = strip_lvalue(trgs.front());
+                        auto src = strip_lvalue(inputs[idx]);
+                        return trg == src
+                            || (mlir::isa< mlir::IntegerType >(trg) && mlir::isa< mlir::IntegerType >(src));
+                    };
+
+                    if (as_is())
+                    {
+                        auto attrs = op.getArgAttrDict(unsigned(idx));
+                        out.push_back(attrs ? attrs : mlir::DictionaryAttr::get(ctx));
+                        continue;
+                    }
+
+                    out.append(trgs.size(), coerced);
+                }
+                return out;
+            }
+
             auto mk_direct(auto &bld, auto loc, const abi::direct &abi_arg,
                            const mapped_arg_t &entry)
             {
@@ -714,6 +811,34 @@ namespace vast
     } // namespace
 
 
+    // Arguments and results the classification passes in memory, in the
+    // order of the functions of the module.
+    static inline void remark_indirect(
+        mlir::ModuleOp mod, const abi_info_map_t< hl::FuncOp > &abi_info_map, string_ref pass
+    ) {
+        auto is_indirect = [](const abi::arg_info &info) {
+            return std::holds_alternative< abi::indirect >(info.style);
+        };
+
+        mod.walk([&](hl::FuncOp fn) {
+            auto it = abi_info_map.find(fn.getName().str());
+            if (fn.isDeclaration() || it == abi_info_map.end())
+                return;
+
+            const auto &info = it->second;
+            for (const auto &ret : info.rets())
+                if (is_indirect(ret))
+                    remarks::analysis(fn, pass, "IndirectReturn")
+                        << "result of " << fn.getName() << " is returned indirectly through memory";
+
+            for (auto [idx, arg] : llvm::enumerate(info.args()))
+                if (is_indirect(arg))
+                    remarks::analysis(fn, pass, "IndirectArgument")
+                        << "argument " << idx << " of " << fn.getName()
+                        << " is passed indirectly in memory";
+        });
+    }
+
     struct EmitABI : EmitABIBase< EmitABI >
     {
         using target_t = mlir::ConversionTarget;
@@ -726,7 +851,10 @@ namespace vast
 
             mlir::ConversionTarget target(mctx);
             target.markUnknownOpDynamicallyLegal([](auto) { return true; });
-            target.addIllegalOp< hl::CallOp >();
+            target.addDynamicallyLegalOp< hl::CallOp >([&](hl::CallOp op) {
+                auto it = abi_info_map.find(op.getCallee().str());
+                return it != abi_info_map.end() && is_abi_trivial(it->second);
+            });
 
             mlir::RewritePatternSet patterns(&mctx);
             patterns.add< call_op >(tc, abi_info_map, mctx);
@@ -744,6 +872,10 @@ namespace vast
 
             auto should_transform = [&](hl::FuncOp op)
             {
+                auto it = abi_info_map.find(op.getName().str());
+                if (it != abi_info_map.end() && is_abi_trivial(it->second))
+                    return true;
+
                 // TODO(abi): Due to some issues with location info of arguments
                 //            declaration are not yet supported.
                 return op.getName() == "main" && !op.isDeclaration();
@@ -792,23 +924,41 @@ namespace vast
             return mlir::applyPartialConversion(this->getOperation(), trg, std::move(patterns));
         }
 
+        // For phases that rewrite only operations nested in functions (call sites
+        // and returns), functions are converted in parallel.
+        mlir::LogicalResult run_nested(phase_t phase)
+        {
+            const auto &trg = std::get< target_t >(phase);
+            mlir::FrozenRewritePatternSet patterns(std::move(std::get< patterns_t >(phase)));
+
+            return util::convert_top_level_ops(this->getOperation(), [&](operation op) {
+                return mlir::applyPartialConversion(op, trg, patterns);
+            });
+        }
+
         void runOnOperation() override
         {
             auto &mctx = this->getContext();
             mlir::ModuleOp op = this->getOperation();
 
-            const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
+            const auto &dl_analysis = this->getAnalysis< data_layout_analysis >().get();
             auto tc = TypeConverter(dl_analysis.getAtOrAbove(op), mctx);
             auto abi_info_map = collect_abi_info< hl::FuncOp >(
-                    op, dl_analysis.getAtOrAbove(op));
+                    op, hl::builtin_data_layout(dl_analysis.getAtOrAbove(op), op),
+                    get_module_analysis< hl::record_layout_analysis >(op, this->getAnalysisManager()));
+
+            remark_indirect(op, abi_info_map, getArgument());
 
-            if (mlir::failed(run(first_phase(tc, abi_info_map))))
+            // Signatures are classified up front, so call sites can be rewritten
+            // independently of their callees.
+            if (mlir::failed(run_nested(first_phase(tc, abi_info_map))))
                 return signalPassFailure();
 
+            // Creates the abi functions next to the original ones.
             if (mlir::failed(run(second_phase(tc, abi_info_map))))
                 return signalPassFailure();
 
-            if (mlir::failed(run(third_phase(tc, abi_info_map))))
+            if (mlir::failed(run_nested(third_phase(tc, abi_info_map))))
                 return signalPassFailure();
         }
     };
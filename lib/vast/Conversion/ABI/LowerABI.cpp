@@ -74,6 +74,74 @@ namespace vast
             return query_bw(dl, target) == query_bw(dl, type_range);
         }
 
+        bool is_record(mlir_type type)
+        {
+            auto naked = hl::strip_elaborated(hl::strip_value_category(type));
+            return mlir::isa< hl::RecordType >(naked);
+        }
+
+        std::vector< mlir::Value > strip_lvalues(auto &rewriter, loc_t loc,
+                                                 mlir::ValueRange values)
+        {
+            std::vector< mlir::Value > out;
+            for (auto v : values)
+            {
+                if (!mlir::isa< hl::LValueType >(v.getType()))
+                {
+                    out.push_back(v);
+                    continue;
+                }
+
+                out.push_back(hl::implicit_cast_lvalue_to_rvalue(rewriter, loc, v));
+            }
+            return out;
+        }
+
+        // If `direct` passes on a parameter that the function only reads, returns
+        // the pieces the parameter was received in. Forwarding them avoids storing
+        // the record only to split it again.
+        std::optional< frozen_values > forwarded_pieces(abi::DirectOp direct, auto &rewriter)
+        {
+            auto cast = direct.getOperand(0).getDefiningOp< hl::ImplicitCastOp >();
+            if (!cast || cast.getKind() != hl::CastKind::LValueToRValue)
+                return std::nullopt;
+
+            auto param = mlir::dyn_cast< mlir::OpResult >(cast.getOperand());
+            if (!param)
+                return std::nullopt;
+
+            auto prologue = mlir::dyn_cast< abi::PrologueOp >(param.getOwner());
+            if (!prologue)
+                return std::nullopt;
+
+            auto only_read = llvm::all_of(param.getUsers(), [](operation user) {
+                auto load = mlir::dyn_cast< hl::ImplicitCastOp >(user);
+                return load && load.getKind() == hl::CastKind::LValueToRValue;
+            });
+
+            if (!only_read)
+                return std::nullopt;
+
+            auto yield = mlir::dyn_cast< abi::YieldOp >(
+                prologue.getBody().front().getTerminator());
+            VAST_ASSERT(yield);
+
+            auto incoming = yield.getValues()[param.getResultNumber()]
+                                 .getDefiningOp< abi::DirectOp >();
+            if (!incoming)
+                return std::nullopt;
+
+            auto pieces = incoming.getOperands();
+            if (pieces.size() != direct.getNumResults())
+                return std::nullopt;
+
+            for (auto [piece, type] : llvm::zip(pieces, direct.getResultTypes()))
+                if (hl::strip_value_category(piece.getType()) != type)
+                    return std::nullopt;
+
+            return strip_lvalues(rewriter, direct.getLoc(), pieces);
+        }
+
         // [ `current_arg`, offset into `current_arg`, size of `current_arg` ]
         using arg_list_position = std::tuple< std::size_t, std::size_t, std::size_t >;
 
@@ -84,11 +152,15 @@ namespace vast
             using op_t = Op;
 
             const mlir::DataLayout &dl;
+            // Direct records are kept in memory instead of being split
+            // into values.
+            bool through_memory;
 
             template< typename ... Args >
-            abi_pattern_base(const mlir::DataLayout &dl, Args && ... args)
+            abi_pattern_base(const mlir::DataLayout &dl, bool through_memory,
+                             Args && ... args)
                 : base(std::forward< Args >(args) ...),
-                  dl(dl)
+                  dl(dl), through_memory(through_memory)
             {}
 
             using state_capture = match_and_rewrite_state_capture< op_t >;
@@ -199,7 +271,11 @@ namespace vast
 
 
             auto deconstruct_record(hl::RecordType record_type, abi::DirectOp direct)
+                -> std::vector< mlir::Value >
             {
+                if (auto forwarded = forwarded_pieces(direct, state.rewriter))
+                    return std::move(*forwarded);
+
                 auto val = direct.getOperand(0).getDefiningOp();
                 // So we are going to emit a bunch `hl.member` which are
                 // semantically geps. These need an operand, that is lvalue.
@@ -228,6 +304,11 @@ namespace vast
                     VAST_UNREACHABLE("ABI conversion could not make lvalue for {0}", *val);
                 }();
 
+                if (pattern.through_memory)
+                    return conv::abi::load_coerced(pattern, state.rewriter, direct.getLoc(),
+                                                   as_lvalue->getResult(0),
+                                                   direct.getResultTypes());
+
                 return conv::abi::deconstruct_aggregate(pattern, direct, as_lvalue,
                                                         state.rewriter);
             }
@@ -243,27 +324,8 @@ namespace vast
                                          target_type),
                            "Cannot do concat when converting {0}", direct);
 
-                auto stripped_lvalues = [&]()
-                {
-                    std::vector< mlir::Value > out;
-                    for (auto v : direct.getOperands())
-                    {
-                        auto lvalue_type = mlir::dyn_cast< hl::LValueType >(v.getType());
-                        if (!lvalue_type)
-                        {
-                            out.push_back(v);
-                            continue;
-                        }
-
-                        auto cast = state.rewriter.template create< hl::ImplicitCastOp >(
-                                direct.getLoc(),
-                                lvalue_type.getElementType(),
-                                v,
-                                hl::CastKind::LValueToRValue);
-                        out.push_back(cast);
-                    }
-                    return out;
-                }();
+                auto stripped_lvalues = strip_lvalues(state.rewriter, direct.getLoc(),
+                                                      direct.getOperands());
 
                 return state.rewriter.template create< ll::Concat >(
                         direct.getLoc(),
@@ -314,27 +376,8 @@ namespace vast
                 VAST_CHECK(direct.getNumOperands() >= 1,
                            "abi.direct op should have > 1 operands: {0}", direct);
 
-                auto stripped_lvalues = [&]()
-                {
-                    std::vector< mlir::Value > out;
-                    for (auto v : direct.getOperands())
-                    {
-                        auto lvalue_type = mlir::dyn_cast< hl::LValueType >(v.getType());
-                        if (!lvalue_type)
-                        {
-                            out.push_back(v);
-                            continue;
-                        }
-
-                        auto cast = state.rewriter.template create< hl::ImplicitCastOp >(
-                                direct.getLoc(),
-                                lvalue_type.getElementType(),
-                                v,
-                                hl::CastKind::LValueToRValue);
-                        out.push_back(cast);
-                    }
-                    return out;
-                }();
+                auto stripped_lvalues = strip_lvalues(state.rewriter, direct.getLoc(),
+                                                      direct.getOperands());
 
                 // We need to reconstruct the type and we ?know? that arguments
                 // simply need to be concated?
@@ -363,10 +406,44 @@ namespace vast
                 return convert_primitive_type(target_type, direct);
             }
 
+            // The record is assembled in a fresh variable by coerced stores.
+            mlir::Value reconstruct_in_memory(abi::DirectOp direct)
+            {
+                auto res_type = direct.getResult()[0].getType();
+                auto loc = direct.getLoc();
+
+                auto var_type = mlir::isa< hl::LValueType >(res_type)
+                    ? res_type
+                    : hl::LValueType::get(res_type.getContext(), res_type);
+
+                auto var = state.rewriter.template create< ll::UninitializedVar >(loc, var_type);
+
+                conv::abi::store_coerced(pattern, state.rewriter, loc, var,
+                                         strip_lvalues(state.rewriter, loc,
+                                                       direct.getOperands()));
+
+                if (mlir::isa< hl::LValueType >(res_type))
+                    return var;
+                return hl::implicit_cast_lvalue_to_rvalue(state.rewriter, loc, var);
+            }
+
+            bool passes_through_memory(abi::DirectOp direct) const
+            {
+                auto res_type = direct.getResult()[0].getType();
+                return pattern.through_memory && is_record(res_type)
+                    && hl::strip_value_category(res_type) != direct.getOperand(0).getType();
+            }
+
             values handle(abi::DirectOp direct) &
             {
                 // TODO(conv:abi): Can direct have more return types?
                 VAST_ASSERT(direct.getNumResults() == 1 && direct.getNumOperands() > 0);
+
+                if (passes_through_memory(direct))
+                {
+                    co_yield reconstruct_in_memory(direct);
+                    co_return;
+                }
                 // Not invoking yet, since I may do something if value is lvalue.
                 auto convert_values = [&]()
                 {
@@ -607,19 +684,21 @@ namespace vast
             return target;
         }
 
-        void add_patterns(auto &config, const auto &dl)
+        void add_body_patterns(auto &config, const auto &dl)
         {
-            config.patterns.template add< pattern::prologue >(dl, config.getContext());
-            config.patterns.template add< pattern::epilogue >(dl, config.getContext());
+            config.patterns.template add< pattern::prologue >(
+                dl, aggregates_through_memory, config.getContext());
+            config.patterns.template add< pattern::epilogue >(
+                dl, aggregates_through_memory, config.getContext());
 
-            config.patterns.template add< pattern::call_args >(dl, config.getContext());
-            config.patterns.template add< pattern::call_rets >(dl, config.getContext());
+            config.patterns.template add< pattern::call_args >(
+                dl, aggregates_through_memory, config.getContext());
+            config.patterns.template add< pattern::call_rets >(
+                dl, aggregates_through_memory, config.getContext());
 
             config.patterns.template add< pattern::call >(config.getContext());
             config.patterns.template add< pattern::call_exec >(config.getContext());
 
-            config.patterns.template add< pattern::function >(config.getContext());
-
             config.target.template addIllegalOp< abi::PrologueOp >();
             config.target.template addIllegalOp< abi::EpilogueOp >();
 
@@ -628,7 +707,11 @@ namespace vast
 
             config.target.template addIllegalOp< abi::CallOp >();
             config.target.template addIllegalOp< abi::CallExecutionOp >();
+        }
 
+        void add_function_patterns(auto &config)
+        {
+            config.patterns.template add< pattern::function >(config.getContext());
             config.target.template addIllegalOp< abi::FuncOp >();
         }
 
@@ -636,18 +719,38 @@ namespace vast
         template< typename pattern >
         static void add_pattern(config_t &config) {}
 
+        // Bodies only refer to other functions by name, so they are lowered for
+        // each function separately and in parallel. Every function gets its own
+        // patterns, as `mlir::DataLayout` caches queries and cannot be shared
+        // between threads.
+        logical_result lower_bodies()
+        {
+            auto &ctx = getContext();
+            auto mod  = this->getOperation();
+
+            return util::convert_top_level_ops(mod, [&](operation op) {
+                auto config = config_t { rewrite_pattern_set(&ctx),
+                                         create_conversion_target(ctx) };
+                auto dl = mlir::DataLayout(mod);
+
+                add_body_patterns(config, dl);
+                this->instrument(config.patterns);
+                return mlir::applyPartialConversion(op, config.target, std::move(config.patterns));
+            });
+        }
+
         // There is no helper we can use.
         void runOnOperation() override
         {
+            if (mlir::failed(lower_bodies()))
+                return signalPassFailure();
+
+            // Replacing `abi.func` inserts into the module, which stays sequential.
             auto &ctx   = getContext();
             auto config = config_t { rewrite_pattern_set(&ctx),
                                      create_conversion_target(ctx) };
-            auto op     = this->getOperation();
-
-            const auto &dl_analysis = this->template getAnalysis< mlir::DataLayoutAnalysis >();
-            auto dl = dl_analysis.getAtOrAbove(op);
 
-            add_patterns(config, dl);
+            add_function_patterns(config);
 
             if (mlir::failed(base::apply_conversions(std::move(config))))
                 return signalPassFailure();
@@ -0,0 +1,138 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/Matchers.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Helpers to copy and initialize aggregates in memory. As clang does,
+    // copies of larger aggregates go through `llvm.memcpy`, and initializers
+    // that are mostly zero clear the object by `llvm.memset` and store only
+    // the non-zero elements. Sizes are in bytes.
+    //
+    namespace aggregates {
+
+        namespace LLVM = mlir::LLVM;
+
+        // Smaller copies are left as a load and a store, which llvm splits
+        // into scalars anyway.
+        constexpr std::uint64_t memcpy_threshold = 16;
+
+        // Objects larger than the threshold with at most `memset_store_budget`
+        // non-zero scalars are cleared first.
+        constexpr std::uint64_t memset_threshold    = 32;
+        constexpr std::size_t   memset_store_budget = 6;
+
+        static inline bool is_aggregate(mlir_type type) {
+            return mlir::isa< LLVM::LLVMStructType, LLVM::LLVMArrayType >(type);
+        }
+
+        static inline std::size_t number_of_elements(mlir_type type) {
+            if (auto array = mlir::dyn_cast< LLVM::LLVMArrayType >(type)) {
+                return array.getNumElements();
+            }
+            return mlir::cast< LLVM::LLVMStructType >(type).getBody().size();
+        }
+
+        // Negative zero is not all zero bits, so it is not cleared by memset.
+        static inline bool is_zero(mlir_value value) {
+            if (auto list = value.getDefiningOp< hl::InitListExpr >()) {
+                return llvm::all_of(list.getElements(), is_zero);
+            }
+
+            return value.getDefiningOp< LLVM::NullOp >()
+                || mlir::matchPattern(value, mlir::m_Zero())
+                || mlir::matchPattern(value, mlir::m_PosZeroFloat());
+        }
+
+        // The list initializes every element, nested lists included. Missing
+        // elements are implicitly zero.
+        static inline bool is_complete(hl::InitListExpr list) {
+            auto type = list.getType(0);
+            if (is_aggregate(type) && list.getElements().size() < number_of_elements(type)) {
+                return false;
+            }
+
+            return llvm::all_of(list.getElements(), [] (mlir_value element) {
+                auto nested = element.getDefiningOp< hl::InitListExpr >();
+                return !nested || is_complete(nested);
+            });
+        }
+
+        static inline std::size_t nonzero_scalars(hl::InitListExpr list) {
+            std::size_t count = 0;
+            for (auto element : list.getElements()) {
+                if (auto nested = element.getDefiningOp< hl::InitListExpr >()) {
+                    count += nonzero_scalars(nested);
+                } else if (!is_zero(element)) {
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        static inline bool clear_before_init(hl::InitListExpr list, std::uint64_t size) {
+            if (!is_complete(list)) {
+                return true;
+            }
+            return size > memset_threshold && nonzero_scalars(list) <= memset_store_budget;
+        }
+
+        static inline mlir_value bytes(auto &rewriter, auto loc, std::uint64_t size) {
+            auto i64 = rewriter.getI64Type();
+            return rewriter.template create< LLVM::ConstantOp >(
+                loc, i64, rewriter.getIntegerAttr(i64, size)
+            );
+        }
+
+        static inline void memset_zero(auto &rewriter, auto loc, mlir_value dst, std::uint64_t size) {
+            auto i8   = rewriter.getI8Type();
+            auto zero = rewriter.template create< LLVM::ConstantOp >(
+                loc, i8, rewriter.getIntegerAttr(i8, 0)
+            );
+            rewriter.template create< LLVM::MemsetOp >(
+                loc, dst, zero, bytes(rewriter, loc, size), /* is_volatile */ false
+            );
+        }
+
+        // Copies `value` of an aggregate type to `dst`. Values loaded from memory
+        // are copied by memcpy from their source. Returns `false` when the copy
+        // is left to the caller.
+        static inline bool copy(
+            auto &rewriter, auto loc, const mlir::DataLayout &dl, mlir_value value, mlir_value dst
+        ) {
+            if (!is_aggregate(value.getType())) {
+                return false;
+            }
+
+            auto load = value.getDefiningOp< LLVM::LoadOp >();
+            if (!load) {
+                return false;
+            }
+
+            std::uint64_t size = dl.getTypeSize(value.getType());
+            if (size < memcpy_threshold) {
+                return false;
+            }
+
+            rewriter.template create< LLVM::MemcpyOp >(
+                loc, dst, load.getAddr(), bytes(rewriter, loc, size), /* is_volatile */ false
+            );
+            return true;
+        }
+
+    } // namespace aggregates
+
+} // namespace vast::conv::irstollvm
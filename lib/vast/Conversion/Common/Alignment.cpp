@@ -0,0 +1,57 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "Alignment.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        std::optional< std::uint64_t > declared_alignment(
+            mlir_value addr, mlir::SymbolTableCollection &symbols
+        ) {
+            if (auto alloca = addr.getDefiningOp< LLVM::AllocaOp >()) {
+                return alloca.getAlignment();
+            }
+
+            if (auto addr_of = addr.getDefiningOp< LLVM::AddressOfOp >()) {
+                if (auto global = addr_of.getGlobal(symbols)) {
+                    return global.getAlignment();
+                }
+            }
+
+            return std::nullopt;
+        }
+
+    } // namespace
+
+    void align_accesses(vast_module mod) {
+        mlir::SymbolTableCollection symbols;
+
+        auto align = [&] (auto op) {
+            if (op.getAlignment()) {
+                return;
+            }
+
+            if (auto alignment = declared_alignment(op.getAddr(), symbols); alignment && *alignment) {
+                op.setAlignment(*alignment);
+            }
+        };
+
+        mod.walk([&] (operation op) {
+            llvm::TypeSwitch< operation >(op)
+                .Case([&] (LLVM::LoadOp load) { align(load); })
+                .Case([&] (LLVM::StoreOp store) { align(store); });
+        });
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,18 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Sets the alignment of `llvm.load` and `llvm.store` operations of `mod`
+    // that directly access an alloca or a global with an explicit alignment,
+    // i.e., a variable whose alignment is stated in the source. Accesses
+    // through a computed address (fields, elements) keep the default alignment
+    // of the accessed type.
+    //
+    void align_accesses(vast_module mod);
+
+} // namespace vast::conv::irstollvm
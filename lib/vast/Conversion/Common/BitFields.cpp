@@ -0,0 +1,98 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "BitFields.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        bool is_unit_access(operation op) {
+            return op && op->hasAttr(bitfields::unit_access_attr);
+        }
+
+        mlir_value strip_casts(mlir_value addr) {
+            while (auto cast = addr.getDefiningOp< LLVM::BitcastOp >()) {
+                addr = cast.getArg();
+            }
+            return addr;
+        }
+
+        // Each field access computes its own address, two addresses are the
+        // same if they are built by the same geps from the same base.
+        bool same_address(mlir_value a, mlir_value b) {
+            a = strip_casts(a);
+            b = strip_casts(b);
+            if (a == b) {
+                return true;
+            }
+
+            auto lhs = a.getDefiningOp< LLVM::GEPOp >();
+            auto rhs = b.getDefiningOp< LLVM::GEPOp >();
+            if (!lhs || !rhs || lhs.getType() != rhs.getType()) {
+                return false;
+            }
+
+            return lhs.getRawConstantIndices() == rhs.getRawConstantIndices()
+                && llvm::equal(lhs.getDynamicIndices(), rhs.getDynamicIndices())
+                && same_address(lhs.getBase(), rhs.getBase());
+        }
+
+        // Closest operation before (or after) `op` in its block that may
+        // access memory.
+        operation memory_neighbour(operation op, bool forward) {
+            auto next = [&] (operation o) { return forward ? o->getNextNode() : o->getPrevNode(); };
+            for (auto it = next(op); it; it = next(it)) {
+                if (!mlir::isMemoryEffectFree(it)) {
+                    return it;
+                }
+            }
+            return nullptr;
+        }
+
+    } // namespace
+
+    void merge_bitfield_updates(vast_module mod) {
+        llvm::SmallVector< LLVM::LoadOp > loads;
+        llvm::SmallVector< LLVM::StoreOp > stores;
+        mod.walk([&] (operation op) {
+            if (!is_unit_access(op)) {
+                return;
+            }
+
+            if (auto load = mlir::dyn_cast< LLVM::LoadOp >(op)) {
+                loads.push_back(load);
+            } else if (auto store = mlir::dyn_cast< LLVM::StoreOp >(op)) {
+                stores.push_back(store);
+            }
+        });
+
+        for (auto load : loads) {
+            auto store = mlir::dyn_cast_if_present< LLVM::StoreOp >(memory_neighbour(load, false));
+            if (!is_unit_access(store) || store.getValue().getType() != load.getType()) {
+                continue;
+            }
+
+            if (same_address(store.getAddr(), load.getAddr())) {
+                load.replaceAllUsesWith(store.getValue());
+                load.erase();
+            }
+        }
+
+        for (auto store : stores) {
+            auto next = mlir::dyn_cast_if_present< LLVM::StoreOp >(memory_neighbour(store, true));
+            if (is_unit_access(next) && same_address(store.getAddr(), next.getAddr())) {
+                store.erase();
+            }
+        }
+
+        mod.walk([&] (operation op) { op->removeAttr(bitfields::unit_access_attr); });
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,182 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <llvm/ADT/APInt.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Helpers to access bitfields through their storage units, as clang does:
+    // a read is a load of the unit followed by a shift and a mask, a write
+    // loads the unit, replaces the bits of the field and stores it back. The
+    // layout is little-endian, i.e., the first field takes the lowest bits.
+    //
+    namespace bitfields {
+
+        namespace LLVM = mlir::LLVM;
+
+        using access_t = tc::FullLLVMTypeConverter::bitfield_access;
+
+        // Marks accesses of storage units until `merge_updates` is done.
+        constexpr string_ref unit_access_attr = "vast.bitfield_unit";
+
+        // Bitfield accessed through `addr`, an address before the conversion.
+        static inline std::optional< access_t > of(
+            const tc::FullLLVMTypeConverter &tc, mlir_value addr
+        ) {
+            auto gep = addr.getDefiningOp< ll::StructGEPOp >();
+            if (!gep) {
+                return {};
+            }
+            return tc.bitfield(gep.getRecord().getType(), gep.getIdx());
+        }
+
+        static inline mlir::IntegerType unit_type(mcontext_t *mctx, const access_t &field) {
+            return mlir::IntegerType::get(mctx, unsigned(field.unit_size));
+        }
+
+        static inline mlir_value constant(auto &rewriter, auto loc, mlir_type type, llvm::APInt value) {
+            return rewriter.template create< LLVM::ConstantOp >(
+                loc, type, rewriter.getIntegerAttr(type, value)
+            );
+        }
+
+        static inline mlir_value unit_addr(auto &rewriter, auto loc, const access_t &field, mlir_value addr) {
+            auto ptr  = mlir::cast< LLVM::LLVMPointerType >(addr.getType());
+            auto type = LLVM::LLVMPointerType::get(
+                unit_type(rewriter.getContext(), field), ptr.getAddressSpace()
+            );
+
+            if (ptr == type) {
+                return addr;
+            }
+            return rewriter.template create< LLVM::BitcastOp >(loc, type, addr);
+        }
+
+        // Sign or zero extends (or truncates) `value` to the integer `type`.
+        static inline mlir_value resize(auto &rewriter, auto loc, mlir_value value, mlir_type type, bool is_signed) {
+            auto from = mlir::cast< mlir::IntegerType >(value.getType()).getWidth();
+            auto to   = mlir::cast< mlir::IntegerType >(type).getWidth();
+
+            if (from == to) {
+                return value;
+            }
+
+            if (from > to) {
+                return rewriter.template create< LLVM::TruncOp >(loc, type, value);
+            }
+
+            if (is_signed) {
+                return rewriter.template create< LLVM::SExtOp >(loc, type, value);
+            }
+            return rewriter.template create< LLVM::ZExtOp >(loc, type, value);
+        }
+
+        // Value of the field in the loaded storage unit `unit`.
+        static inline mlir_value extract(
+            auto &rewriter, auto loc, const access_t &field, mlir_value unit, mlir_type type
+        ) {
+            auto size = field.unit_size;
+            auto utype = unit.getType();
+            auto shift = [&] (auto op_tag, mlir_value value, std::uint64_t amount) -> mlir_value {
+                if (amount == 0) {
+                    return value;
+                }
+                using op_t = typename decltype(op_tag)::type;
+                auto amt = constant(rewriter, loc, utype, llvm::APInt(unsigned(size), amount));
+                return rewriter.template create< op_t >(loc, value, amt);
+            };
+
+            mlir_value value = unit;
+            if (field.is_signed) {
+                value = shift(std::type_identity< LLVM::ShlOp >{}, value, size - field.offset - field.width);
+                value = shift(std::type_identity< LLVM::AShrOp >{}, value, size - field.width);
+            } else {
+                value = shift(std::type_identity< LLVM::LShrOp >{}, value, field.offset);
+                if (field.width < size) {
+                    auto mask = constant(
+                        rewriter, loc, utype, llvm::APInt::getLowBitsSet(unsigned(size), field.width)
+                    );
+                    value = rewriter.template create< LLVM::AndOp >(loc, value, mask);
+                }
+            }
+
+            return resize(rewriter, loc, value, type, field.is_signed);
+        }
+
+        static inline mlir_value load_unit(auto &rewriter, auto loc, const access_t &field, mlir_value addr) {
+            auto load = rewriter.template create< LLVM::LoadOp >(
+                loc, unit_type(rewriter.getContext(), field), unit_addr(rewriter, loc, field, addr),
+                unsigned(field.unit_align)
+            );
+            load->setAttr(unit_access_attr, rewriter.getUnitAttr());
+            return load;
+        }
+
+        // Reads the field at `addr` (after the conversion) as a `type` value.
+        static inline mlir_value load(
+            auto &rewriter, auto loc, const access_t &field, mlir_value addr, mlir_type type
+        ) {
+            return extract(rewriter, loc, field, load_unit(rewriter, loc, field, addr), type);
+        }
+
+        // Writes `value` to the field at `addr` and returns the value the field
+        // holds afterwards, i.e., `value` truncated to the width of the field.
+        static inline mlir_value store(
+            auto &rewriter, auto loc, const access_t &field, mlir_value addr, mlir_value value
+        ) {
+            auto size  = unsigned(field.unit_size);
+            auto utype = unit_type(rewriter.getContext(), field);
+            auto bits  = resize(rewriter, loc, value, utype, field.is_signed);
+
+            mlir_value unit = bits;
+            if (field.width < size) {
+                auto low = constant(rewriter, loc, utype, llvm::APInt::getLowBitsSet(size, field.width));
+                unit = rewriter.template create< LLVM::AndOp >(loc, unit, low);
+                if (field.offset != 0) {
+                    auto amt = constant(rewriter, loc, utype, llvm::APInt(size, field.offset));
+                    unit = rewriter.template create< LLVM::ShlOp >(loc, unit, amt);
+                }
+
+                auto kept = ~llvm::APInt::getBitsSet(
+                    size, unsigned(field.offset), unsigned(field.offset + field.width)
+                );
+                auto old     = load_unit(rewriter, loc, field, addr);
+                auto cleared = rewriter.template create< LLVM::AndOp >(
+                    loc, old, constant(rewriter, loc, utype, kept)
+                );
+                unit = rewriter.template create< LLVM::OrOp >(loc, cleared, unit);
+            }
+
+            auto st = rewriter.template create< LLVM::StoreOp >(
+                loc, unit, unit_addr(rewriter, loc, field, addr), unsigned(field.unit_align)
+            );
+            st->setAttr(unit_access_attr, rewriter.getUnitAttr());
+
+            return extract(rewriter, loc, field, unit, value.getType());
+        }
+
+    } // namespace bitfields
+
+    //
+    // Merges updates of bitfields in the same storage unit, i.e., a read of
+    // a unit that directly follows a write of it reuses the written value,
+    // and a write that is overwritten before anything reads the memory is
+    // removed. Consecutive assignments of fields in a unit then become a
+    // single store.
+    //
+    void merge_bitfield_updates(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -27,13 +27,14 @@ namespace vast::conv::irstollvm {
 
         auto dl(auto op) const { return tc.getDataLayoutAnalysis()->getAtOrAbove(op); }
 
-        auto mk_alloca(auto &rewriter, mlir_type trg_type, auto loc) const {
+        // Zero `alignment` leaves the alignment to the target.
+        auto mk_alloca(auto &rewriter, mlir_type trg_type, auto loc, unsigned alignment = 0) const {
             auto count = rewriter.template create< LLVM::ConstantOp >(
                 loc, type_converter().convertType(rewriter.getIndexType()),
                 rewriter.getIntegerAttr(rewriter.getIndexType(), 1)
             );
 
-            return rewriter.template create< LLVM::AllocaOp >(loc, trg_type, count, 0);
+            return rewriter.template create< LLVM::AllocaOp >(loc, trg_type, count, alignment);
         }
 
         // Some operations want more fine-grained control, and we really just
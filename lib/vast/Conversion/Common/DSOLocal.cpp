@@ -0,0 +1,163 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "DSOLocal.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace {
+
+        using linkage_kind = core::GlobalLinkageKind;
+
+        // Properties of a symbol that decide whether it can be preempted.
+        struct symbol
+        {
+            bool local;
+            bool extern_weak;
+            bool declaration;
+            bool function;
+            bool thread_local_var;
+            // External definition that is not weak, i.e., the only one in the
+            // link unless it is interposed at runtime.
+            bool strong_definition;
+            bool default_visibility;
+        };
+
+        bool is_local(linkage_kind linkage) {
+            return linkage == linkage_kind::InternalLinkage
+                || linkage == linkage_kind::PrivateLinkage;
+        }
+
+        template< typename func_t >
+        symbol function_symbol(func_t fn) {
+            auto linkage = fn.getLinkage();
+            auto declaration = fn.isDeclaration()
+                || linkage == linkage_kind::AvailableExternallyLinkage;
+            return {
+                .local              = is_local(linkage),
+                .extern_weak        = linkage == linkage_kind::ExternalWeakLinkage,
+                .declaration        = declaration,
+                .function           = true,
+                .thread_local_var   = false,
+                .strong_definition  = !declaration && linkage == linkage_kind::ExternalLinkage,
+                .default_visibility = !fn->hasAttr(hl::VisibilityAttr::attr_name())
+            };
+        }
+
+        symbol variable_symbol(hl::VarDeclOp var) {
+            auto sc  = var.getStorageClass();
+            auto tsc = var.getThreadStorageClass();
+            auto local = !var.isFileVarDecl() || (sc && *sc == hl::StorageClass::sc_static);
+            auto declaration = var.hasExternalStorage();
+            return {
+                .local              = local,
+                .extern_weak        = false,
+                .declaration        = declaration,
+                .function           = false,
+                .thread_local_var   = tsc && *tsc != hl::TSClass::tsc_none,
+                .strong_definition  = !local && !declaration,
+                .default_visibility = !var->hasAttr(hl::VisibilityAttr::attr_name())
+            };
+        }
+
+        bool is_dso_local(const symbol &sym, const llvm::Triple &triple, const dso_local_options &opts) {
+            if (sym.local) {
+                return true;
+            }
+
+            if (!sym.default_visibility && !sym.extern_weak) {
+                return true;
+            }
+
+            if (triple.isOSBinFormatCOFF() || (triple.isOSWindows() && triple.isOSBinFormatMachO())) {
+                return true;
+            }
+
+            if (triple.isOSBinFormatMachO()) {
+                return !opts.pic || sym.strong_definition;
+            }
+
+            if (!triple.isOSBinFormatELF()) {
+                return false;
+            }
+
+            // Shared libraries may bind definitions to themselves only without
+            // semantic interposition, and only functions can use local aliases.
+            if (opts.pic && !opts.pie) {
+                if (!sym.function || !sym.strong_definition || !sym.default_visibility) {
+                    return false;
+                }
+                return !opts.semantic_interposition;
+            }
+
+            // A definition cannot be preempted from an executable.
+            if (!sym.declaration) {
+                return true;
+            }
+
+            // Code sequences that assume a local symbol cannot produce null if
+            // the symbol turns out to be undefined.
+            if (opts.pic && sym.extern_weak) {
+                return false;
+            }
+
+            if (triple.isPPC64()) {
+                return false;
+            }
+
+            if (opts.direct_access_external_data) {
+                // Thread-local variables generally do not support copy relocations.
+                if (!sym.function && !sym.thread_local_var) {
+                    return true;
+                }
+
+                if (sym.function && !opts.no_plt && !opts.pic) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    } // namespace
+
+    void mark_dso_local(vast_module mod, const dso_local_options &opts) {
+        auto ctx = mod.getContext();
+
+        llvm::Triple triple;
+        if (auto attr = mod->getAttrOfType< mlir::StringAttr >(core::CoreDialect::getTargetTripleAttrName())) {
+            triple = llvm::Triple(attr.getValue());
+        }
+
+        auto mark = [&] (operation op, const symbol &sym) {
+            if (is_dso_local(sym, triple, opts)) {
+                op->setAttr(hl::DSOLocalAttr::attr_name(), hl::DSOLocalAttr::get(ctx));
+            } else if (opts.no_plt && sym.function && sym.declaration) {
+                op->setAttr(hl::NonLazyBindAttr::attr_name(), hl::NonLazyBindAttr::get(ctx));
+            }
+        };
+
+        mod.walk([&] (operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                mark(op, function_symbol(fn));
+            } else if (auto fn = mlir::dyn_cast< ll::FuncOp >(op)) {
+                mark(op, function_symbol(fn));
+            } else if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                if (var.hasGlobalStorage()) {
+                    mark(op, variable_symbol(var));
+                }
+            }
+        });
+    }
+
+} // namespace vast::conv::irstollvm
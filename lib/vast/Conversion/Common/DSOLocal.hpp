@@ -0,0 +1,37 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    struct dso_local_options
+    {
+        // Code is position independent, i.e., the relocation model is not static.
+        bool pic = false;
+        // Code is linked into a position independent executable.
+        bool pie = false;
+        // Definitions of a shared library may be preempted
+        // (`-fsemantic-interposition`).
+        bool semantic_interposition = false;
+        // Calls of external functions do not go through the PLT (`-fno-plt`).
+        bool no_plt = false;
+        // External variables may be accessed directly
+        // (`-fdirect-access-external-data`).
+        bool direct_access_external_data = false;
+    };
+
+    //
+    // Marks functions and global variables of `mod` that cannot be preempted
+    // by `hl.dso_local`, following `shouldAssumeDSOLocal` of clang: symbols of
+    // internal linkage or of a non-default visibility, definitions of
+    // executables and, depending on the relocation model, declarations that
+    // may be resolved by copy relocations or canonical PLT entries.
+    //
+    // With `-fno-plt`, declarations of functions that are not marked get
+    // `hl.nonlazybind`.
+    //
+    void mark_dso_local(vast_module mod, const dso_local_options &opts);
+
+} // namespace vast::conv::irstollvm
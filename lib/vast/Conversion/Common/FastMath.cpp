@@ -0,0 +1,111 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "FastMath.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        LLVM::FastmathFlags flags_of(hl::FastMathAttr attr) {
+            auto flags = LLVM::FastmathFlags::none;
+            auto set = [&] (bool present, LLVM::FastmathFlags flag) {
+                if (present) {
+                    flags = flags | flag;
+                }
+            };
+
+            set(attr.getReassoc(), LLVM::FastmathFlags::reassoc);
+            set(attr.getNnan(), LLVM::FastmathFlags::nnan);
+            set(attr.getNinf(), LLVM::FastmathFlags::ninf);
+            set(attr.getNsz(), LLVM::FastmathFlags::nsz);
+            set(attr.getArcp(), LLVM::FastmathFlags::arcp);
+            set(attr.getContract(), LLVM::FastmathFlags::contract);
+            set(attr.getAfn(), LLVM::FastmathFlags::afn);
+            return flags;
+        }
+
+        // The product is fused only if the addition is its single user, as
+        // in the expression it was emitted for.
+        LLVM::FMulOp product_of(mlir_value value, operation addition) {
+            auto mul = value.getDefiningOp< LLVM::FMulOp >();
+            if (!mul || !mul->hasOneUse() || mul->getBlock() != addition->getBlock()) {
+                return {};
+            }
+            return mul;
+        }
+
+        void fuse(operation op) {
+            auto sub = mlir::isa< LLVM::FSubOp >(op);
+            auto lhs = op->getOperand(0);
+            auto rhs = op->getOperand(1);
+            auto loc = op->getLoc();
+            auto type = op->getResult(0).getType();
+
+            mlir::OpBuilder bld(op);
+            auto negate = [&] (mlir_value value) -> mlir_value {
+                return bld.create< LLVM::FNegOp >(loc, type, value);
+            };
+
+            mlir_value fused;
+            LLVM::FMulOp mul;
+            if ((mul = product_of(lhs, op))) {
+                // a * b + c, a * b - c
+                auto addend = sub ? negate(rhs) : rhs;
+                fused = bld.create< LLVM::FMulAddOp >(loc, type, mul.getLhs(), mul.getRhs(), addend);
+            } else if ((mul = product_of(rhs, op))) {
+                // c + a * b, c - a * b
+                auto factor = sub ? negate(mul.getLhs()) : mul.getLhs();
+                fused = bld.create< LLVM::FMulAddOp >(loc, type, factor, mul.getRhs(), lhs);
+            } else {
+                return;
+            }
+
+            op->getResult(0).replaceAllUsesWith(fused);
+            op->erase();
+            mul->erase();
+        }
+
+    } // namespace
+
+    void forward_fast_math(operation from, operation to) {
+        if (auto attr = from->getAttrOfType< hl::FastMathAttr >(hl::FastMathAttr::attr_name())) {
+            if (auto fmf = mlir::dyn_cast< LLVM::FastmathFlagsInterface >(to)) {
+                to->setAttr(
+                    fmf.getFastmathAttrName(),
+                    LLVM::FastmathFlagsAttr::get(to->getContext(), flags_of(attr))
+                );
+            }
+        }
+
+        if (auto contract = from->getAttr(hl::FPContractAttr::attr_name())) {
+            to->setAttr(hl::FPContractAttr::attr_name(), contract);
+        }
+    }
+
+    void form_fmuladds(vast_module mod) {
+        llvm::SmallVector< operation > marked;
+        mod.walk([&] (operation op) {
+            if (op->hasAttr(hl::FPContractAttr::attr_name())) {
+                marked.push_back(op);
+            }
+        });
+
+        for (auto op : marked) {
+            op->removeAttr(hl::FPContractAttr::attr_name());
+            if (mlir::isa< LLVM::FAddOp, LLVM::FSubOp >(op)) {
+                fuse(op);
+            }
+        }
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,23 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Floating-point options of expressions, attached to `hl` operations by
+    // codegen, see `hl.fastmath` and `hl.fp_contract`.
+    //
+    // Sets the fast-math flags of the LLVM operation `to` by the options of
+    // `from`, and copies its `hl.fp_contract` mark.
+    //
+    void forward_fast_math(operation from, operation to);
+
+    // Fuses LLVM additions and subtractions marked by `hl.fp_contract` with
+    // their multiplication operand into `llvm.fmuladd`, as clang does for
+    // `-ffp-contract=on`. The marks are removed.
+    void form_fmuladds(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -12,6 +12,8 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/TargetParser/Triple.h>
 VAST_UNRELAX_WARNINGS
 
 #include "../PassesDetails.hpp"
@@ -21,6 +23,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 
 #include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreDialect.hpp"
 
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
@@ -35,8 +38,19 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 
+#include "Aggregates.hpp"
+#include "Alignment.hpp"
+#include "BitFields.hpp"
 #include "Common.hpp"
+#include "DSOLocal.hpp"
+#include "FastMath.hpp"
 #include "LLCFToLLVM.hpp"
+#include "Lifetime.hpp"
+#include "Overflow.hpp"
+#include "ParamAttrs.hpp"
+#include "ReturnSlots.hpp"
+#include "TailCalls.hpp"
+#include "TBAA.hpp"
 
 namespace vast::conv::irstollvm
 {
@@ -57,9 +71,27 @@ namespace vast::conv::irstollvm
         logical_result matchAndRewrite(
             op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
         ) const override {
-            std::vector< mlir::LLVM::GEPArg > indices{ 0ul, ops.getIdx() };
+            auto record = op.getRecord().getType();
+            auto idx    = this->type_converter().element_index(record, ops.getIdx());
+            std::vector< mlir::LLVM::GEPArg > indices{ 0ul, idx };
+
+            // A bitfield is addressed by its storage unit, which its accesses
+            // shift and mask.
+            if (this->type_converter().bitfield(record, ops.getIdx())) {
+                auto ptr    = mlir::cast< LLVM::LLVMPointerType >(ops.getRecord().getType());
+                auto body   = mlir::cast< LLVM::LLVMStructType >(ptr.getElementType()).getBody();
+                auto unit   = LLVM::LLVMPointerType::get(body[idx], ptr.getAddressSpace());
+                auto gep    = rewriter.create< mlir::LLVM::GEPOp >(
+                    op.getLoc(), unit, ops.getRecord(), indices, /* inbounds */ true
+                );
+                rewriter.replaceOpWithNewOp< LLVM::BitcastOp >(op, convert(op.getType()), gep);
+                return mlir::success();
+            }
+
+            // Fields are always within the record.
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
-                op.getLoc(), convert(op.getType()), ops.getRecord(), indices
+                op.getLoc(), convert(op.getType()), ops.getRecord(), indices,
+                /* inbounds */ true
             );
 
             rewriter.replaceOp(op, gep);
@@ -231,10 +263,11 @@ namespace vast::conv::irstollvm
             auto trg_type = tc.convert_type_to_type(op.getType());
             VAST_PATTERN_CHECK(trg_type, "Could not convert vardecl type");
 
+            auto inbounds = op->hasAttr(hl::NoSignedWrapAttr::attr_name());
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
                     op.getLoc(),
                     *trg_type, ops.getArray(),
-                    ops.getIndex() );
+                    ops.getIndex(), inbounds );
 
             rewriter.replaceOp(op, gep);
             return logical_result::success();
@@ -252,76 +285,216 @@ namespace vast::conv::irstollvm
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
         {
-            auto alloca = mk_alloca(rewriter, convert(op.getType()), op.getLoc());
+            // Fixed-size variables are allocated in the entry block, as clang
+            // does, so they stay static allocas that mem2reg and SROA promote
+            // and that do not grow the stack in loops. Their scope is kept by
+            // the lifetime markers, if any.
+            auto alloca = [&] {
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+                if (has_fixed_size(op)) {
+                    auto fn = op->getParentOfType< mlir::FunctionOpInterface >();
+                    VAST_CHECK(fn, "Local variable outside of a function: {0}", op);
+                    rewriter.setInsertionPointToStart(&fn.getFunctionBody().front());
+                }
+                return mk_alloca(rewriter, convert(op.getType()), op.getLoc(), alignment(op));
+            } ();
+
+            if (auto init = initial_value(op)) {
+                copy_initial_value(op, alloca, init, rewriter);
+            }
             rewriter.replaceOp(op, alloca);
 
             return logical_result::success();
         }
+
+        static mlir::ElementsAttr initial_value(op_t op)
+        {
+            return op->getAttrOfType< mlir::ElementsAttr >(
+                hl::VarDeclOp::getInitialValueAttrName(op->getName())
+            );
+        }
+
+        // Folded elements of a local array are stored once in a private
+        // constant global, the array is copied from it on each entry.
+        void copy_initial_value(
+            op_t op, mlir_value alloca, mlir::ElementsAttr init,
+            conversion_rewriter &rewriter
+        ) const {
+            auto fn  = op->getParentOfType< mlir::FunctionOpInterface >();
+            VAST_CHECK(fn, "Local variable outside of a function: {0}", op);
+            auto mod = fn->template getParentOfType< vast_module >();
+
+            auto ptr_type = mlir::cast< mlir::LLVM::LLVMPointerType >(convert(op.getType()));
+            auto arr_type = ptr_type.getElementType();
+
+            std::string name = ("__const." + fn.getName()).str();
+            for (unsigned i = 1; mlir::SymbolTable::lookupSymbolIn(mod, name); ++i) {
+                name = ("__const." + fn.getName() + "." + llvm::Twine(i)).str();
+            }
+
+            {
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+                rewriter.setInsertionPoint(fn);
+                auto glob = rewriter.create< mlir::LLVM::GlobalOp >(
+                    op.getLoc(), arr_type, /* constant */ true,
+                    mlir::LLVM::Linkage::Private, name, init, alignment(op)
+                );
+                glob.setUnnamedAddr(mlir::LLVM::UnnamedAddr::Global);
+            }
+
+            auto addr = rewriter.create< mlir::LLVM::AddressOfOp >(op.getLoc(), ptr_type, name);
+            auto size = rewriter.create< mlir::LLVM::ConstantOp >(
+                op.getLoc(), rewriter.getI64Type(),
+                rewriter.getI64IntegerAttr(std::int64_t(this->dl(op).getTypeSize(arr_type)))
+            );
+            rewriter.create< mlir::LLVM::MemcpyOp >(
+                op.getLoc(), alloca, addr, size, /* is_volatile */ false
+            );
+        }
+
+        static unsigned alignment(op_t op)
+        {
+            auto align = op->getAttrOfType< hl::AlignmentAttr >(hl::AlignmentAttr::attr_name());
+            return align ? align.getAlignment() : 0;
+        }
+
+        static bool has_fixed_size(op_t op)
+        {
+            auto result = op.getType().walk([](hl::ArrayType arr) {
+                return arr.getSize() ? mlir::WalkResult::advance() : mlir::WalkResult::interrupt();
+            });
+            return !result.wasInterrupted();
+        }
     };
 
-    struct initialize_var : base_pattern< ll::InitializeVar >
+    template< typename op_t, typename trg_t >
+    struct lifetime_marker : base_pattern< op_t >
     {
-        using op_t = ll::InitializeVar;
         using base = base_pattern< op_t >;
         using base::base;
 
-        // TODO(conv:abi): This seems like a weird hack, try to figure out
-        //                 how to make this more sane.
-        // First one is intended to catch the `adaptor`
-        auto erase(auto, auto &) const {}
-        auto erase(hl::InitListExpr op, auto &rewriter) const
+        logical_result matchAndRewrite(
+                op_t op, typename op_t::Adaptor ops,
+                conversion_rewriter &rewriter) const override
         {
+            auto lvalue = mlir::cast< hl::LValueType >(op.getVar().getType());
+            auto size   = this->dl(op).getTypeSize(this->convert(lvalue.getElementType()));
+
+            rewriter.create< trg_t >(op.getLoc(), rewriter.getI64IntegerAttr(size), ops.getVar());
             rewriter.eraseOp(op);
+            return logical_result::success();
         }
+    };
+
+    using lifetime_conversions = util::type_list<
+        lifetime_marker< ll::LifetimeStart, LLVM::LifetimeStartOp >,
+        lifetime_marker< ll::LifetimeEnd, LLVM::LifetimeEndOp >
+    >;
+
+    struct initialize_var : base_pattern< ll::InitializeVar >
+    {
+        using op_t = ll::InitializeVar;
+        using base = base_pattern< op_t >;
+        using base::base;
 
-        static bool points_to_scalar(mlir_type t)
+        static mlir_type pointee(mlir_value ptr)
         {
-            auto ptr = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(t);
-            VAST_ASSERT(ptr);
-            return !mlir::isa< mlir::LLVM::LLVMStructType >(ptr.getElementType());
+            auto type = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(ptr.getType());
+            VAST_ASSERT(type);
+            return type.getElementType();
         }
 
-        void handle_root(typename op_t::Adaptor ops,
+        void handle_root(op_t op, typename op_t::Adaptor ops,
                          auto ptr, auto &rewriter) const
         {
+            // We know it must be only one, aggregates are initialized by a list.
+            auto element = ops.getElements()[0];
+
             // Scalar need special handling, because we won't be doing any GEPs
             // into it - mlir verifier would survive that, but conversion
             // to `llvm::` will complain.
-            if (!points_to_scalar(ptr.getType()))
-                return handle_init_list(ops, ptr, rewriter);
+            if (!aggregates::is_aggregate(pointee(ptr))) {
+                rewriter.template create< LLVM::StoreOp >(element.getLoc(), element, ptr);
+                return;
+            }
 
-            // We know it must be only one if the type is scalar.
-            auto element = ops.getElements()[0];
-            rewriter.template create< LLVM::StoreOp >(
-                    element.getLoc(),
-                    element,
-                    ptr);
+            if (auto list = element.template getDefiningOp< hl::InitListExpr >()) {
+                std::uint64_t size = this->dl(op).getTypeSize(pointee(ptr));
+                auto clear = aggregates::clear_before_init(list, size);
+                if (clear) {
+                    aggregates::memset_zero(rewriter, op.getLoc(), ptr, size);
+                }
+                return handle_init_list(list, ptr, rewriter, clear);
+            }
+
+            // Copy of another object, e.g., `struct S s = t;`.
+            if (!aggregates::copy(rewriter, op.getLoc(), this->dl(op), element, ptr)) {
+                rewriter.template create< LLVM::StoreOp >(element.getLoc(), element, ptr);
+            }
         }
 
-        void handle_init_list(auto init_list, auto ptr, auto &rewriter) const
+        // With `skip_zeros` the memory is already cleared, so only non-zero
+        // elements are stored.
+        void handle_init_list(hl::InitListExpr init_list, auto ptr, auto &rewriter,
+                              bool skip_zeros) const
         {
+            // Fields of structs with bitfields do not map to elements one to one.
+            auto record = [&] () -> mlir_type {
+                auto st = mlir::dyn_cast< LLVM::LLVMStructType >(pointee(ptr));
+                if (!st || !st.isIdentified())
+                    return {};
+                return hl::RecordType::get(rewriter.getContext(), st.getName());
+            } ();
+
             for (auto [i, element] : llvm::enumerate(init_list.getElements()))
             {
+                auto nested = element.template getDefiningOp< hl::InitListExpr >();
+                if (skip_zeros && aggregates::is_zero(element)) {
+                    if (nested)
+                        erase_nested(nested, rewriter);
+                    continue;
+                }
+
+                auto field = record ? this->type_converter().bitfield(record, unsigned(i)) : std::nullopt;
+                auto idx = record ? this->type_converter().element_index(record, unsigned(i)) : i;
+
+                if (field) {
+                    auto st = mlir::cast< LLVM::LLVMStructType >(pointee(ptr));
+                    auto unit = LLVM::LLVMPointerType::get(st.getBody()[idx]);
+                    std::vector< mlir::LLVM::GEPArg > indices { 0ul, idx };
+                    auto gep = rewriter.template create< LLVM::GEPOp >(
+                            element.getLoc(), unit, ptr, indices, /* inbounds */ true);
+                    bitfields::store(rewriter, element.getLoc(), *field, gep, element);
+                    continue;
+                }
+
                 auto e_type = LLVM::LLVMPointerType::get(element.getType());
-                std::vector< mlir::LLVM::GEPArg > indices { 0ul, i };
+                std::vector< mlir::LLVM::GEPArg > indices { 0ul, idx };
 
                 auto gep = rewriter.template create< LLVM::GEPOp >(
-                        element.getLoc(), e_type, ptr, indices);
+                        element.getLoc(), e_type, ptr, indices, /* inbounds */ true);
 
-                if (auto nested = mlir::dyn_cast< hl::InitListExpr >(element.getDefiningOp()))
-                    handle_init_list(nested, gep, rewriter);
+                if (nested)
+                    handle_init_list(nested, gep, rewriter, skip_zeros);
                 else
                     rewriter.template create< LLVM::StoreOp >(element.getLoc(), element, gep);
             }
-            erase(init_list, rewriter);
+            rewriter.eraseOp(init_list);
         }
 
+        void erase_nested(hl::InitListExpr init_list, auto &rewriter) const
+        {
+            for (auto element : init_list.getElements())
+                if (auto nested = element.template getDefiningOp< hl::InitListExpr >())
+                    erase_nested(nested, rewriter);
+            rewriter.eraseOp(init_list);
+        }
 
         logical_result matchAndRewrite(
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
         {
-            handle_root(ops, ops.getVar(), rewriter);
+            handle_root(op, ops, ops.getVar(), rewriter);
             rewriter.replaceOp(op, ops.getVar());
 
             return logical_result::success();
@@ -357,6 +530,26 @@ namespace vast::conv::irstollvm
         }
     };
 
+    // Preemption and visibility of the symbol, see `mark_dso_local`.
+    template< typename llvm_op_t >
+    static void mark_symbol_attrs(operation op, llvm_op_t symbol) {
+        if (op->hasAttr(hl::DSOLocalAttr::attr_name()))
+            symbol.setDsoLocal(true);
+
+        if (auto vis = op->getAttrOfType< hl::VisibilityAttr >(hl::VisibilityAttr::attr_name())) {
+            auto visibility = llvm::StringSwitch< LLVM::Visibility >(vis.getVisibility())
+                .Case("hidden", LLVM::Visibility::Hidden)
+                .Case("protected", LLVM::Visibility::Protected)
+                .Default(LLVM::Visibility::Default);
+            symbol.setVisibility_(visibility);
+        }
+    }
+
+    static bool is_thread_local(hl::VarDeclOp var) {
+        auto tsc = var.getThreadStorageClass();
+        return tsc && *tsc != hl::TSClass::tsc_none;
+    }
+
     struct vardecl : base_pattern< hl::VarDeclOp >
     {
         using op_t = hl::VarDeclOp;
@@ -370,6 +563,38 @@ namespace vast::conv::irstollvm
             auto t = mlir::dyn_cast< hl::LValueType >(op.getType());
             auto target_type = this->convert(t.getElementType());
 
+            // Only const-qualified globals are constant. Unlike literals, distinct
+            // named objects must compare unequal, so they are not `unnamed_addr`.
+            auto is_constant = op->hasAttr(hl::ConstantStorageAttr::attr_name());
+            auto align = op->getAttrOfType< hl::AlignmentAttr >(hl::AlignmentAttr::attr_name());
+            // The model is not an attribute of `llvm.mlir.global`, it is set
+            // by the translation to llvm ir.
+            auto tls_model = op->getAttr(hl::TLSModelAttr::attr_name());
+            auto annotate = [&] (LLVM::GlobalOp gop) {
+                if (is_constant)
+                    gop.setUnnamedAddr(LLVM::UnnamedAddr::Local);
+                if (align)
+                    gop.setAlignment(align.getAlignment());
+                if (is_thread_local(op))
+                    gop.setThreadLocal_(true);
+                if (tls_model)
+                    gop->setAttr(hl::TLSModelAttr::attr_name(), tls_model);
+                for (auto attr : op->getAttrs())
+                    if (auto section = mlir::dyn_cast< hl::SectionAttr >(attr.getValue()))
+                        gop.setSectionAttr(section.getName());
+                mark_symbol_attrs(op, gop);
+            };
+
+            // Initializers folded in codegen become the value of the global.
+            if (auto value = op.getInitialValueAttr()) {
+                auto gop = rewriter.create< mlir::LLVM::GlobalOp >(
+                        op.getLoc(), target_type, is_constant, LLVM::Linkage::Internal,
+                        op.getName(), value);
+                annotate(gop);
+                rewriter.eraseOp(op);
+                return logical_result::success();
+            }
+
             // Sadly, we cannot build `mlir::LLVM::GlobalOp` without
             // providing a value attribute.
             auto dummy_value = rewriter.getIntegerAttr(target_type, 0);
@@ -378,10 +603,10 @@ namespace vast::conv::irstollvm
             auto gop = rewriter.create< mlir::LLVM::GlobalOp >(
                     op.getLoc(),
                     target_type,
-                    // TODO(conv:irstollvm): Constant.
-                    true,
+                    is_constant,
                     LLVM::Linkage::Internal,
                     op.getName(), dummy_value);
+            annotate(gop);
 
             // If we want the global to have a body it cannot have value attribute.
             gop.removeValueAttr();
@@ -467,6 +692,14 @@ namespace vast::conv::irstollvm
             auto new_func = rewriter.create< LLVM::LLVMFuncOp >(
                 func_op.getLoc(), func_op.getName(), target_type, linkage, false, LLVM::CConv::C
             );
+            mark_param_attrs(func_op, new_func);
+            mark_fn_attrs(func_op, new_func);
+            mark_symbol_attrs(func_op, new_func);
+
+            if (auto count = func_op->template getAttrOfType< hl::EntryCountAttr >(
+                    hl::EntryCountAttr::attr_name()))
+                new_func.setFunctionEntryCount(count.getCount());
+
             rewriter.inlineRegionBefore(func_op.getBody(), new_func.getBody(), new_func.end());
             tc::convert_region_types(func_op, new_func, signature);
 
@@ -477,6 +710,130 @@ namespace vast::conv::irstollvm
             return logical_result::success();
         }
 
+        // Parameter attributes are derived from source types and annotations
+        // of parameters. Call sites are not annotated, llvm takes attributes
+        // of the callee declaration into account.
+        void mark_param_attrs(op_t func_op, LLVM::LLVMFuncOp fn) const
+        {
+            auto unit   = mlir::UnitAttr::get(fn.getContext());
+            auto inputs = func_op.getFunctionType().getInputs();
+            for (auto [idx, type] : llvm::enumerate(inputs))
+            {
+                if (idx >= fn.getNumArguments())
+                    break;
+
+                // A `restrict` parameter is the only way to access its object for the
+                // duration of the call, which is what `noalias` promises to LLVM.
+                if (is_restrict(type))
+                    fn.setArgAttr(idx, LLVM::LLVMDialect::getNoAliasAttrName(), unit);
+
+                if (auto ref = mlir::dyn_cast< hl::ReferenceType >(type))
+                    mark_reference_arg(func_op, fn, idx, ref.getElementType());
+
+                if (func_op.getArgAttr(idx, hl::NonNullAttr::attr_name()))
+                    fn.setArgAttr(idx, LLVM::LLVMDialect::getNonNullAttrName(), unit);
+
+                auto align = func_op.template getArgAttrOfType< hl::AlignValueAttr >(
+                    idx, hl::AlignValueAttr::attr_name()
+                );
+                if (align)
+                    set_align(fn, idx, align.getAlignment());
+
+                // Attributes attached before the conversion, e.g., `llvm.noundef`.
+                for (auto attr : func_op.getArgAttrs(idx))
+                    if (attr.getName().strref().starts_with("llvm."))
+                        fn.setArgAttr(idx, attr.getName(), attr.getValue());
+            }
+        }
+
+        template< typename attr_t >
+        static bool has_attr(op_t func_op)
+        {
+            return llvm::any_of(func_op->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        // Attributes of the function itself. `flatten` is not an attribute of
+        // llvm, it is handled by the HL inliner.
+        void mark_fn_attrs(op_t func_op, LLVM::LLVMFuncOp fn) const
+        {
+            auto ctx = fn.getContext();
+
+            llvm::SmallVector< mlir_attr > passthrough;
+            auto pass = [&] (bool present, llvm::StringRef name) {
+                if (present)
+                    passthrough.push_back(mlir::StringAttr::get(ctx, name));
+            };
+
+            pass(has_attr< hl::AlwaysInlineAttr >(func_op), "alwaysinline");
+            pass(has_attr< hl::NoInlineAttr >(func_op), "noinline");
+            pass(has_attr< hl::HotAttr >(func_op), "hot");
+            pass(has_attr< hl::ColdAttr >(func_op), "cold");
+            pass(has_attr< hl::NoReturnAttr >(func_op), "noreturn");
+            pass(has_attr< hl::NoThrowAttr >(func_op), "nounwind");
+            pass(has_attr< hl::NonLazyBindAttr >(func_op), "nonlazybind");
+
+            if (!passthrough.empty())
+                fn.setPassthroughAttr(mlir::ArrayAttr::get(ctx, passthrough));
+
+            // `const` functions do not access memory at all, `pure` ones only
+            // read it.
+            auto memory = [&] (LLVM::ModRefInfo info) {
+                fn.setMemoryAttr(LLVM::MemoryEffectsAttr::get(ctx, { info, info, info }));
+            };
+
+            if (has_attr< hl::ConstAttr >(func_op))
+                memory(LLVM::ModRefInfo::NoModRef);
+            else if (has_attr< hl::PureAttr >(func_op))
+                memory(LLVM::ModRefInfo::Ref);
+        }
+
+        static bool is_restrict(mlir_type type)
+        {
+            auto ptr = mlir::dyn_cast< hl::PointerType >(type);
+            return ptr && ptr.getQuals() && ptr.getQuals().hasRestrict();
+        }
+
+        static void set_align(LLVM::LLVMFuncOp fn, unsigned idx, std::uint64_t align)
+        {
+            auto i64 = mlir::IntegerType::get(fn.getContext(), 64);
+            fn.setArgAttr(idx, LLVM::LLVMDialect::getAlignAttrName(),
+                          mlir::IntegerAttr::get(i64, align));
+        }
+
+        // A reference is bound to a valid object, so it is non-null and the whole
+        // object can be read through it.
+        void mark_reference_arg(
+            op_t func_op, LLVM::LLVMFuncOp fn, unsigned idx, mlir_type referenced
+        ) const {
+            fn.setArgAttr(idx, LLVM::LLVMDialect::getNonNullAttrName(),
+                          mlir::UnitAttr::get(fn.getContext()));
+
+            auto type = this->type_converter().convert_type_to_type(referenced);
+            if (!type || !is_sized(*type))
+                return;
+
+            const auto &layout = this->dl(func_op);
+            std::uint64_t size = layout.getTypeSize(*type);
+            if (size != 0) {
+                auto i64 = mlir::IntegerType::get(fn.getContext(), 64);
+                fn.setArgAttr(idx, LLVM::LLVMDialect::getDereferenceableAttrName(),
+                              mlir::IntegerAttr::get(i64, size));
+            }
+
+            set_align(fn, idx, layout.getTypeABIAlignment(*type));
+        }
+
+        static bool is_sized(mlir_type type)
+        {
+            if (mlir::isa< LLVM::LLVMFunctionType, LLVM::LLVMVoidType >(type))
+                return false;
+            if (auto st = mlir::dyn_cast< LLVM::LLVMStructType >(type))
+                return !st.isOpaque();
+            return true;
+        }
+
         logical_result args_to_allocas(
                 mlir::LLVM::LLVMFuncOp fn,
                 conversion_rewriter &rewriter) const
@@ -535,8 +892,11 @@ namespace vast::conv::irstollvm
 
         static inline constexpr const char *strlit_global_var_prefix = "vast.strlit.constant_";
 
-        std::string next_strlit_name(vast_module mod) const
-        {
+        // Identical literals share a single global of the module, otherwise
+        // returns a fresh name for a new one.
+        std::pair< std::string, bool > strlit_global(
+            vast_module mod, mlir_type type, mlir::StringAttr value
+        ) const {
             std::size_t current = 0;
             for (auto &op : mod.getOps())
             {
@@ -548,12 +908,14 @@ namespace vast::conv::irstollvm
                 if (!name.consume_front(strlit_global_var_prefix))
                     continue;
 
+                if (global.getGlobalType() == type && global.getValueAttr() == value)
+                    return { global.getName().str(), true };
+
                 std::size_t idx = 0;
                 name.getAsInteger(10, idx);
                 current = std::max< std::size_t >(idx, current);
             }
-            return strlit_global_var_prefix + std::to_string(current + 1);
-
+            return { strlit_global_var_prefix + std::to_string(current + 1), false };
         }
 
         logical_result handle_void_const(
@@ -626,19 +988,22 @@ namespace vast::conv::irstollvm
             auto ptr_type = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(target_type);
 
             auto mod = op->getParentOfType< mlir::ModuleOp >();
-            auto name = next_strlit_name(mod);
+            auto [name, exists] = strlit_global(mod, ptr_type.getElementType(), converted_attr);
 
-            rewriter.guarded([&]()
-            {
-                rewriter->setInsertionPoint(&*mod.begin());
-                rewriter->template create< mlir::LLVM::GlobalOp >(
-                    op.getLoc(),
-                    ptr_type.getElementType(),
-                    true, /* is constant */
-                    LLVM::Linkage::Internal,
-                    name,
-                    converted_attr);
-            });
+            if (!exists) {
+                rewriter.guarded([&]()
+                {
+                    rewriter->setInsertionPoint(&*mod.begin());
+                    auto global = rewriter->template create< mlir::LLVM::GlobalOp >(
+                        op.getLoc(),
+                        ptr_type.getElementType(),
+                        true, /* is constant */
+                        LLVM::Linkage::Private,
+                        name,
+                        converted_attr);
+                    global.setUnnamedAddr(LLVM::UnnamedAddr::Global);
+                });
+            }
 
             return rewriter->template create< mlir::LLVM::AddressOfOp >(op.getLoc(),
                                                                         target_type,
@@ -707,7 +1072,15 @@ namespace vast::conv::irstollvm
         };
 
         auto lvalue_to_rvalue = [&] {
-            rewriter.template replaceOpWithNewOp< LLVM::LoadOp >(op, dst_type, src);
+            if (auto field = bitfields::of(pattern.type_converter(), op.getValue())) {
+                rewriter.replaceOp(op, bitfields::load(rewriter, op.getLoc(), *field, src, dst_type));
+                return mlir::success();
+            }
+
+            auto load = rewriter.template replaceOpWithNewOp< LLVM::LoadOp >(op, dst_type, src);
+            if (auto range = op->getAttr(hl::ValueRangeAttr::attr_name())) {
+                load->setAttr(hl::ValueRangeAttr::attr_name(), range);
+            }
             return mlir::success();
         };
 
@@ -817,6 +1190,19 @@ namespace vast::conv::irstollvm
             return mlir::success();
         };
 
+        // Scalar is inserted to the first lane and shuffled to the others.
+        auto vector_splat = [&] {
+            auto loc   = op.getLoc();
+            auto undef = rewriter.template create< LLVM::UndefOp >(loc, dst_type);
+            auto zero  = pattern.iN(rewriter, loc, rewriter.getI32Type(), 0);
+            auto first = rewriter.template create< LLVM::InsertElementOp >(loc, undef, src, zero);
+
+            auto lanes = mlir::cast< mlir::VectorType >(dst_type).getNumElements();
+            llvm::SmallVector< std::int32_t > mask(lanes, 0);
+            rewriter.template replaceOpWithNewOp< LLVM::ShuffleVectorOp >(op, first, first, mask);
+            return mlir::success();
+        };
+
         switch (op.getKind()) {
             case hl::CastKind::BitCast:
                 return bitcast();
@@ -856,7 +1242,8 @@ namespace vast::conv::irstollvm
             case hl::CastKind::ToVoid:
                 return to_void();
 
-            // case hl::CastKind::VectorSplat:
+            case hl::CastKind::VectorSplat:
+                return vector_splat();
             case hl::CastKind::IntegralCast:
                 return integral_cast();
             case hl::CastKind::IntegralToBoolean:
@@ -949,22 +1336,64 @@ namespace vast::conv::irstollvm
     };
 
 
+    // Integer arithmetic that keeps the `hl.nsw` mark of signed operations.
+    template< typename src_t, typename trg_t >
+    struct integer_arithmetic : base_pattern< src_t >
+    {
+        using base = base_pattern< src_t >;
+        using base::base;
+
+        using adaptor_t = typename src_t::Adaptor;
+
+        logical_result
+        matchAndRewrite(src_t op, adaptor_t ops, conversion_rewriter &rewriter) const override {
+            auto target_ty = this->type_converter().convert_type_to_type(op.getType());
+            VAST_PATTERN_CHECK(target_ty, "Could not convert type of: {0}", op);
+
+            auto new_op = rewriter.create< trg_t >(op.getLoc(), *target_ty, ops.getOperands());
+            forward_no_signed_wrap(op, new_op);
+            rewriter.replaceOp(op, new_op);
+            return mlir::success();
+        }
+    };
+
+    // Floating-point arithmetic with the fast-math flags of its expression.
+    template< typename src_t, typename trg_t >
+    struct float_arithmetic : base_pattern< src_t >
+    {
+        using base = base_pattern< src_t >;
+        using base::base;
+
+        using adaptor_t = typename src_t::Adaptor;
+
+        logical_result
+        matchAndRewrite(src_t op, adaptor_t ops, conversion_rewriter &rewriter) const override {
+            auto target_ty = this->type_converter().convert_type_to_type(op.getType());
+            VAST_PATTERN_CHECK(target_ty, "Could not convert type of: {0}", op);
+
+            auto new_op = rewriter.create< trg_t >(op.getLoc(), *target_ty, ops.getOperands());
+            forward_fast_math(op, new_op);
+            rewriter.replaceOp(op, new_op);
+            return mlir::success();
+        }
+    };
+
     using one_to_one_conversions = util::type_list<
-        one_to_one< hl::AddIOp, LLVM::AddOp >,
-        one_to_one< hl::SubIOp, LLVM::SubOp >,
-        one_to_one< hl::MulIOp, LLVM::MulOp >,
+        integer_arithmetic< hl::AddIOp, LLVM::AddOp >,
+        integer_arithmetic< hl::SubIOp, LLVM::SubOp >,
+        integer_arithmetic< hl::MulIOp, LLVM::MulOp >,
 
-        one_to_one< hl::AddFOp, LLVM::FAddOp >,
-        one_to_one< hl::SubFOp, LLVM::FSubOp >,
-        one_to_one< hl::MulFOp, LLVM::FMulOp >,
+        float_arithmetic< hl::AddFOp, LLVM::FAddOp >,
+        float_arithmetic< hl::SubFOp, LLVM::FSubOp >,
+        float_arithmetic< hl::MulFOp, LLVM::FMulOp >,
 
         one_to_one< hl::DivSOp, LLVM::SDivOp >,
         one_to_one< hl::DivUOp, LLVM::UDivOp >,
-        one_to_one< hl::DivFOp, LLVM::FDivOp >,
+        float_arithmetic< hl::DivFOp, LLVM::FDivOp >,
 
         one_to_one< hl::RemSOp, LLVM::SRemOp >,
         one_to_one< hl::RemUOp, LLVM::URemOp >,
-        one_to_one< hl::RemFOp, LLVM::FRemOp >,
+        float_arithmetic< hl::RemFOp, LLVM::FRemOp >,
 
         one_to_one< hl::BinOrOp, LLVM::OrOp >,
         one_to_one< hl::BinAndOp, LLVM::AndOp >,
@@ -994,6 +1423,18 @@ namespace vast::conv::irstollvm
             if (rhs.getType().template isa< hl::LValueType >())
                 return logical_result::failure();
 
+            if constexpr (std::is_same_v< Trg, void >) {
+                if (aggregates::copy(rewriter, op.getLoc(), this->dl(op), rhs, lhs)) {
+                    rewriter.replaceOp(op, rhs);
+                    return logical_result::success();
+                }
+            }
+
+            if (auto field = bitfields::of(this->type_converter(), op.getDst())) {
+                rewriter.replaceOp(op, assign_bitfield(op, *field, lhs, rhs, rewriter));
+                return logical_result::success();
+            }
+
             auto load_lhs = rewriter.create< LLVM::LoadOp >(op.getLoc(), lhs);
             auto target_ty = this->convert(op.getSrc().getType());
 
@@ -1001,10 +1442,14 @@ namespace vast::conv::irstollvm
             // require a lot of boilerplate).
             auto new_op = [&]()
             {
-                if constexpr (!std::is_same_v< Trg, void >)
-                    return rewriter.create< Trg >(op.getLoc(), target_ty, load_lhs, rhs);
-                else
+                if constexpr (!std::is_same_v< Trg, void >) {
+                    auto arith = rewriter.create< Trg >(op.getLoc(), target_ty, load_lhs, rhs);
+                    forward_no_signed_wrap(op, arith);
+                    forward_fast_math(op, arith);
+                    return arith;
+                } else {
                     return rhs;
+                }
             }();
 
             rewriter.create< LLVM::StoreOp >(op.getLoc(), new_op, lhs);
@@ -1013,6 +1458,21 @@ namespace vast::conv::irstollvm
             rewriter.replaceOp(op, new_op);
             return logical_result::success();
         }
+
+        mlir_value assign_bitfield(
+            Src op, const bitfields::access_t &field, mlir_value lhs, mlir_value rhs,
+            conversion_rewriter &rewriter
+        ) const {
+            if constexpr (std::is_same_v< Trg, void >) {
+                return bitfields::store(rewriter, op.getLoc(), field, lhs, rhs);
+            } else {
+                auto old = bitfields::load(rewriter, op.getLoc(), field, lhs, rhs.getType());
+                auto arith = rewriter.create< Trg >(op.getLoc(), rhs.getType(), old, rhs);
+                forward_no_signed_wrap(op, arith);
+                forward_fast_math(op, arith);
+                return bitfields::store(rewriter, op.getLoc(), field, lhs, arith);
+            }
+        }
     };
 
     using assign_conversions = util::type_list<
@@ -1069,7 +1529,10 @@ namespace vast::conv::irstollvm
 
             auto mk_call = [&](auto ... args)
             {
-                return rewriter.create< mlir::LLVM::CallOp >(op.getLoc(), args ...);
+                auto call = rewriter.create< mlir::LLVM::CallOp >(op.getLoc(), args ...);
+                if (auto musttail = op->getAttr(hl::MustTailAttr::attr_name()))
+                    call->setAttr(hl::MustTailAttr::attr_name(), musttail);
+                return call;
             };
 
             if (rtys->empty() || rtys->front().isa< mlir::LLVM::LLVMVoidType >())
@@ -1122,11 +1585,21 @@ namespace vast::conv::irstollvm
             if (is_lvalue(arg))
                 return logical_result::failure();
 
-            auto value = rewriter.create< LLVM::LoadOp >(op.getLoc(), arg);
+            auto field = bitfields::of(this->type_converter(), op.getArg());
+            auto pointee = mlir::cast< LLVM::LLVMPointerType >(arg.getType()).getElementType();
+
+            mlir_value value = field
+                ? bitfields::load(rewriter, op.getLoc(), *field, arg, pointee)
+                : rewriter.create< LLVM::LoadOp >(op.getLoc(), arg);
             auto one = this->constant(rewriter, op.getLoc(), value.getType(), 1);
-            auto adjust = rewriter.create< Trg >(op.getLoc(), value, one);
+            mlir_value adjust = rewriter.create< Trg >(op.getLoc(), value, one);
+            forward_no_signed_wrap(op, adjust.getDefiningOp());
 
-            rewriter.create< LLVM::StoreOp >(op.getLoc(), adjust, arg);
+            if (field) {
+                adjust = bitfields::store(rewriter, op.getLoc(), *field, arg, adjust);
+            } else {
+                rewriter.create< LLVM::StoreOp >(op.getLoc(), adjust, arg);
+            }
 
             auto yielded = [&]() {
                 if constexpr (prefix_yield< YieldAt >())
@@ -1248,6 +1721,17 @@ namespace vast::conv::irstollvm
         ignore_pattern< hl::PlusOp >
     >;
 
+    // Lanes of vector comparisons are all ones if they hold, scalar comparisons
+    // yield one.
+    void replace_with_cmp_result(auto op, auto cmp, mlir_type dst_type, auto &rewriter) {
+        if (mlir::isa< mlir::VectorType >(dst_type)) {
+            rewriter.template replaceOpWithNewOp< LLVM::SExtOp >(op, dst_type, cmp);
+            return;
+        }
+
+        llvm_pattern_utils::replace_with_trunc_or_ext(op, cmp, cmp.getType(), dst_type, rewriter);
+    }
+
     struct cmp : base_pattern< hl::CmpOp >
     {
         using op_t = hl::CmpOp;
@@ -1265,10 +1749,7 @@ namespace vast::conv::irstollvm
                 op.getLoc(), pred, adaptor.getLhs(), adaptor.getRhs()
             );
 
-            auto dst_type = convert(op.getType());
-
-            replace_with_trunc_or_ext(op, new_cmp, new_cmp.getType(), dst_type, rewriter);
-
+            replace_with_cmp_result(op, new_cmp, convert(op.getType()), rewriter);
             return mlir::success();
         }
 
@@ -1289,6 +1770,82 @@ namespace vast::conv::irstollvm
         }
     };
 
+    struct fcmp : base_pattern< hl::FCmpOp >
+    {
+        using op_t = hl::FCmpOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        using adaptor_t = typename op_t::Adaptor;
+
+        logical_result matchAndRewrite(
+            op_t op, adaptor_t adaptor, conversion_rewriter &rewriter
+        ) const override {
+            auto new_cmp = rewriter.create< LLVM::FCmpOp >(
+                op.getLoc(), convert_predicate(op.getPredicate()),
+                adaptor.getLhs(), adaptor.getRhs()
+            );
+            forward_fast_math(op, new_cmp);
+
+            replace_with_cmp_result(op, new_cmp, convert(op.getType()), rewriter);
+            return mlir::success();
+        }
+
+        auto convert_predicate(hl::FPredicate predicate) const -> LLVM::FCmpPredicate {
+            switch (predicate)
+            {
+                case hl::FPredicate::ffalse : return LLVM::FCmpPredicate::_false;
+                case hl::FPredicate::oeq    : return LLVM::FCmpPredicate::oeq;
+                case hl::FPredicate::ogt    : return LLVM::FCmpPredicate::ogt;
+                case hl::FPredicate::oge    : return LLVM::FCmpPredicate::oge;
+                case hl::FPredicate::olt    : return LLVM::FCmpPredicate::olt;
+                case hl::FPredicate::ole    : return LLVM::FCmpPredicate::ole;
+                case hl::FPredicate::one    : return LLVM::FCmpPredicate::one;
+                case hl::FPredicate::ord    : return LLVM::FCmpPredicate::ord;
+                case hl::FPredicate::uno    : return LLVM::FCmpPredicate::uno;
+                case hl::FPredicate::ueq    : return LLVM::FCmpPredicate::ueq;
+                case hl::FPredicate::ugt    : return LLVM::FCmpPredicate::ugt;
+                case hl::FPredicate::uge    : return LLVM::FCmpPredicate::uge;
+                case hl::FPredicate::ult    : return LLVM::FCmpPredicate::ult;
+                case hl::FPredicate::ule    : return LLVM::FCmpPredicate::ule;
+                case hl::FPredicate::une    : return LLVM::FCmpPredicate::une;
+                case hl::FPredicate::ftrue  : return LLVM::FCmpPredicate::_true;
+            }
+        }
+    };
+
+    struct vector_shuffle : base_pattern< hl::VectorShuffleOp >
+    {
+        using op_t = hl::VectorShuffleOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor adaptor, conversion_rewriter &rewriter
+        ) const override {
+            rewriter.replaceOpWithNewOp< LLVM::ShuffleVectorOp >(
+                op, adaptor.getLhs(), adaptor.getRhs(), op.getMask()
+            );
+            return mlir::success();
+        }
+    };
+
+    struct vector_extract : base_pattern< hl::VectorExtractOp >
+    {
+        using op_t = hl::VectorExtractOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor adaptor, conversion_rewriter &rewriter
+        ) const override {
+            rewriter.replaceOpWithNewOp< LLVM::ExtractElementOp >(
+                op, adaptor.getVector(), adaptor.getIndex()
+            );
+            return mlir::success();
+        }
+    };
+
     struct deref : base_pattern< hl::Deref >
     {
         using base = base_pattern< hl::Deref >;
@@ -1390,6 +1947,9 @@ namespace vast::conv::irstollvm
         cstyle_cast,
         call,
         cmp,
+        fcmp,
+        vector_shuffle,
+        vector_extract,
         deref,
         subscript,
         sizeof_pattern,
@@ -1397,6 +1957,507 @@ namespace vast::conv::irstollvm
         value_yield_in_global_var
     >;
 
+    //
+    // Atomics
+    //
+
+    namespace atomics
+    {
+        inline LLVM::AtomicOrdering ordering(hl::MemoryOrder order) {
+            switch (order) {
+                case hl::MemoryOrder::relaxed: return LLVM::AtomicOrdering::monotonic;
+                // llvm has no consume ordering, clang strengthens it as well.
+                case hl::MemoryOrder::consume: return LLVM::AtomicOrdering::acquire;
+                case hl::MemoryOrder::acquire: return LLVM::AtomicOrdering::acquire;
+                case hl::MemoryOrder::release: return LLVM::AtomicOrdering::release;
+                case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::acq_rel;
+                case hl::MemoryOrder::seq_cst: return LLVM::AtomicOrdering::seq_cst;
+            }
+        }
+
+        // Loads cannot release, the release part of the order is dropped.
+        inline LLVM::AtomicOrdering load_ordering(hl::MemoryOrder order) {
+            switch (order) {
+                case hl::MemoryOrder::release: return LLVM::AtomicOrdering::monotonic;
+                case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::acquire;
+                default: return ordering(order);
+            }
+        }
+
+        // Stores cannot acquire, the acquire part of the order is dropped.
+        inline LLVM::AtomicOrdering store_ordering(hl::MemoryOrder order) {
+            switch (order) {
+                case hl::MemoryOrder::consume:
+                case hl::MemoryOrder::acquire: return LLVM::AtomicOrdering::monotonic;
+                case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::release;
+                default: return ordering(order);
+            }
+        }
+
+        inline LLVM::AtomicBinOp bin_op(hl::RMWKind kind) {
+            switch (kind) {
+                case hl::RMWKind::xchg: return LLVM::AtomicBinOp::xchg;
+                case hl::RMWKind::add:  return LLVM::AtomicBinOp::add;
+                case hl::RMWKind::sub:  return LLVM::AtomicBinOp::sub;
+                case hl::RMWKind::_and: return LLVM::AtomicBinOp::_and;
+                case hl::RMWKind::_or:  return LLVM::AtomicBinOp::_or;
+                case hl::RMWKind::_xor: return LLVM::AtomicBinOp::_xor;
+                case hl::RMWKind::nand: return LLVM::AtomicBinOp::nand;
+                case hl::RMWKind::max:  return LLVM::AtomicBinOp::max;
+                case hl::RMWKind::min:  return LLVM::AtomicBinOp::min;
+                case hl::RMWKind::umax: return LLVM::AtomicBinOp::umax;
+                case hl::RMWKind::umin: return LLVM::AtomicBinOp::umin;
+            }
+        }
+
+    } // namespace atomics
+
+    struct atomic_load : base_pattern< hl::AtomicLoadOp >
+    {
+        using op_t = hl::AtomicLoadOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto type = this->convert(op.getType());
+            auto load = rewriter.create< LLVM::LoadOp >(op.getLoc(), type, ops.getAddr());
+            // Atomic accesses need an explicit alignment, objects accessed
+            // by the builtins are naturally aligned.
+            load.setAlignment(this->dl(op).getTypeSize(type));
+            load.setOrdering(atomics::load_ordering(op.getOrder()));
+            rewriter.replaceOp(op, load);
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_store : base_pattern< hl::AtomicStoreOp >
+    {
+        using op_t = hl::AtomicStoreOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto value = ops.getValue();
+            auto store = rewriter.create< LLVM::StoreOp >(op.getLoc(), value, ops.getAddr());
+            store.setAlignment(this->dl(op).getTypeSize(value.getType()));
+            store.setOrdering(atomics::store_ordering(op.getOrder()));
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_rmw : base_pattern< hl::AtomicRMWOp >
+    {
+        using op_t = hl::AtomicRMWOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            rewriter.replaceOpWithNewOp< LLVM::AtomicRMWOp >(
+                op, atomics::bin_op(op.getKind()), ops.getAddr(), ops.getValue(),
+                atomics::ordering(op.getOrder())
+            );
+            return logical_result::success();
+        }
+    };
+
+    //
+    // The previous value of the object is stored to `expected` only if the
+    // exchange failed, a store on success could race with other accesses of
+    // `expected`. Operations after the builtin are split to a block the
+    // outcome branches to, as for `__builtin_unreachable`.
+    //
+    struct atomic_cmpxchg : base_pattern< hl::AtomicCmpXchgOp >
+    {
+        using op_t = hl::AtomicCmpXchgOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc  = op.getLoc();
+            auto type = ops.getDesired().getType();
+
+            auto expected = rewriter.create< LLVM::LoadOp >(loc, type, ops.getExpected());
+
+            auto cmpxchg = rewriter.create< LLVM::AtomicCmpXchgOp >(
+                loc, ops.getAddr(), expected, ops.getDesired(),
+                atomics::ordering(op.getSuccessOrder()),
+                atomics::load_ordering(op.getFailureOrder())
+            );
+
+            if (op.getWeak()) {
+                cmpxchg.setWeak(true);
+            }
+
+            auto field = [&] (std::int64_t idx) -> mlir::Value {
+                return rewriter.create< LLVM::ExtractValueOp >(
+                    loc, cmpxchg, llvm::ArrayRef< std::int64_t >(idx)
+                );
+            };
+
+            auto old     = field(0);
+            auto success = field(1);
+
+            auto exchanged = success;
+            auto result    = this->convert(op.getType());
+            if (result != exchanged.getType()) {
+                exchanged = rewriter.create< LLVM::ZExtOp >(loc, result, exchanged);
+            }
+
+            auto block = op->getBlock();
+            auto rest  = rewriter.splitBlock(block, std::next(op->getIterator()));
+
+            auto failure = rewriter.createBlock(rest);
+            rewriter.create< LLVM::StoreOp >(loc, old, ops.getExpected());
+            rewriter.create< LLVM::BrOp >(loc, mlir::ValueRange(), rest);
+
+            rewriter.setInsertionPointToEnd(block);
+            rewriter.create< LLVM::CondBrOp >(loc, success, rest, failure);
+
+            rewriter.replaceOp(op, exchanged);
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_fence : base_pattern< hl::AtomicFenceOp >
+    {
+        using op_t = hl::AtomicFenceOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor, conversion_rewriter &rewriter
+        ) const override {
+            // Relaxed fences order nothing.
+            if (op.getOrder() == hl::MemoryOrder::relaxed) {
+                rewriter.eraseOp(op);
+                return logical_result::success();
+            }
+
+            rewriter.create< LLVM::FenceOp >(
+                op.getLoc(), atomics::ordering(op.getOrder()),
+                op.getSingleThread() ? "singlethread" : ""
+            );
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    using atomic_conversions = util::type_list<
+        atomic_load, atomic_store, atomic_rmw, atomic_cmpxchg, atomic_fence
+    >;
+
+    namespace builtins
+    {
+        mlir_value trunc_or_ext(auto &rewriter, auto loc, mlir_value value, mlir_type type) {
+            auto src_bw = value.getType().getIntOrFloatBitWidth();
+            auto dst_bw = type.getIntOrFloatBitWidth();
+            if (src_bw > dst_bw) {
+                return rewriter.template create< LLVM::TruncOp >(loc, type, value);
+            }
+            if (src_bw < dst_bw) {
+                return rewriter.template create< LLVM::ZExtOp >(loc, type, value);
+            }
+            return value;
+        }
+    } // namespace builtins
+
+    template< typename op_t, typename intrinsic_t >
+    struct builtin_mem : base_pattern< op_t >
+    {
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc = op.getLoc();
+            auto dst = ops.getDst();
+            // Source of `memcpy`, byte of `memset`.
+            mlir_value src = ops.getOperands()[1];
+
+            if constexpr (std::is_same_v< intrinsic_t, LLVM::MemsetOp >) {
+                src = builtins::trunc_or_ext(rewriter, loc, src, rewriter.getI8Type());
+            }
+
+            auto len = builtins::trunc_or_ext(rewriter, loc, ops.getSize(), rewriter.getI64Type());
+            rewriter.create< intrinsic_t >(loc, dst, src, len, /* is_volatile */ false);
+            rewriter.replaceOp(op, dst);
+            return logical_result::success();
+        }
+    };
+
+    // Intrinsics of bit manipulation yield the type of their argument, the
+    // builtins may yield a different one (e.g., `int` of `__builtin_clzll`).
+    template< typename op_t, typename intrinsic_t >
+    struct builtin_bit : base_pattern< op_t >
+    {
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc = op.getLoc();
+            auto arg = ops.getArg();
+
+            auto value = [&] () -> mlir_value {
+                if constexpr (std::is_same_v< intrinsic_t, LLVM::CtPopOp >
+                           || std::is_same_v< intrinsic_t, LLVM::ByteSwapOp >
+                ) {
+                    return rewriter.create< intrinsic_t >(loc, arg.getType(), arg);
+                } else {
+                    // Zero argument is undefined for the builtins.
+                    auto poison = this->iN(rewriter, loc, rewriter.getI1Type(), 1);
+                    return rewriter.create< intrinsic_t >(loc, arg.getType(), arg, poison);
+                }
+            }();
+
+            auto result = this->convert(op.getType());
+            rewriter.replaceOp(op, builtins::trunc_or_ext(rewriter, loc, value, result));
+            return logical_result::success();
+        }
+    };
+
+    struct builtin_prefetch : base_pattern< hl::BuiltinPrefetchOp >
+    {
+        using op_t = hl::BuiltinPrefetchOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc = op.getLoc();
+            auto i32 = [&] (auto val) { return this->iN(rewriter, loc, rewriter.getI32Type(), val); };
+
+            // Builtin prefetches the data cache.
+            rewriter.create< LLVM::Prefetch >(
+                loc, ops.getAddr(), i32(op.getRw()), i32(op.getLocality()), i32(1)
+            );
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    struct builtin_assume : base_pattern< hl::BuiltinAssumeOp >
+    {
+        using op_t = hl::BuiltinAssumeOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc  = op.getLoc();
+            auto cond = ops.getCond();
+            if (!cond.getType().isInteger(1)) {
+                auto zero = this->constant(rewriter, loc, cond.getType(), 0);
+                cond = rewriter.create< LLVM::ICmpOp >(loc, LLVM::ICmpPredicate::ne, cond, zero);
+            }
+
+            rewriter.create< LLVM::AssumeOp >(loc, cond);
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    //
+    // Operations after the builtin are split to a block without predecessors,
+    // so that `llvm.unreachable` terminates the block of the builtin.
+    //
+    struct builtin_unreachable : base_pattern< hl::BuiltinUnreachableOp >
+    {
+        using op_t = hl::BuiltinUnreachableOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor, conversion_rewriter &rewriter
+        ) const override {
+            auto block = op->getBlock();
+            if (std::next(op->getIterator()) != block->end()) {
+                rewriter.splitBlock(block, std::next(op->getIterator()));
+            }
+
+            rewriter.replaceOpWithNewOp< LLVM::UnreachableOp >(op);
+            return logical_result::success();
+        }
+    };
+
+    //
+    // Variadic arguments. The builtins take the address of the `va_list`, the
+    // intrinsics take it as `i8 *`.
+    //
+    static mlir_value va_list_ptr(auto &rewriter, auto loc, mlir_value list) {
+        auto ptr = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+        if (list.getType() == ptr) {
+            return list;
+        }
+        return rewriter.template create< LLVM::BitcastOp >(loc, ptr, list);
+    }
+
+    template< typename op_t, typename trg_t >
+    struct builtin_va : base_pattern< op_t >
+    {
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            llvm::SmallVector< mlir_value, 2 > lists;
+            for (auto list : ops.getOperands()) {
+                lists.push_back(va_list_ptr(rewriter, op.getLoc(), list));
+            }
+
+            rewriter.create< trg_t >(op.getLoc(), mlir::TypeRange{}, lists);
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    //
+    // As clang does, `va_arg` of scalars on x86-64 System V reads the register
+    // save area or the overflow area inline. The sequence is branchless: both
+    // addresses are computed and selected by whether a register of the class
+    // is left. Other types and targets use `llvm.va_arg`.
+    //
+    struct builtin_va_arg : base_pattern< hl::BuiltinVAArgOp >
+    {
+        using op_t = hl::BuiltinVAArgOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        enum class reg_class { none, gp, fp };
+
+        static reg_class classify(mlir_type type) {
+            if (mlir::isa< LLVM::LLVMPointerType >(type)) {
+                return reg_class::gp;
+            }
+
+            if (auto int_type = mlir::dyn_cast< mlir::IntegerType >(type)) {
+                return int_type.getWidth() <= 64 ? reg_class::gp : reg_class::none;
+            }
+
+            return type.isF32() || type.isF64() ? reg_class::fp : reg_class::none;
+        }
+
+        static bool is_sysv_x86_64(operation op) {
+            auto mod  = op->getParentOfType< vast_module >();
+            auto attr = mod ? mod->getAttrOfType< mlir::StringAttr >(
+                core::CoreDialect::getTargetTripleAttrName()
+            ) : nullptr;
+
+            if (!attr) {
+                return false;
+            }
+
+            llvm::Triple triple(attr.getValue());
+            return triple.getArch() == llvm::Triple::x86_64 && !triple.isOSWindows();
+        }
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc  = op.getLoc();
+            auto type = this->convert(op.getType());
+            auto cls  = classify(type);
+
+            if (cls == reg_class::none || !is_sysv_x86_64(op)) {
+                rewriter.replaceOpWithNewOp< LLVM::VaArgOp >(
+                    op, type, va_list_ptr(rewriter, loc, ops.getList())
+                );
+                return logical_result::success();
+            }
+
+            rewriter.replaceOp(op, sysv_va_arg(rewriter, loc, ops.getList(), type, cls));
+            return logical_result::success();
+        }
+
+        // struct __va_list_tag {
+        //     unsigned gp_offset; unsigned fp_offset;
+        //     void *overflow_arg_area; void *reg_save_area;
+        // };
+        mlir_value sysv_va_arg(
+            conversion_rewriter &rewriter, loc_t loc, mlir_value list, mlir_type type, reg_class cls
+        ) const {
+            auto i32  = rewriter.getI32Type();
+            auto ptr  = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+            auto tag  = LLVM::LLVMStructType::getLiteral(rewriter.getContext(), { i32, i32, ptr, ptr });
+            auto args = rewriter.create< LLVM::BitcastOp >(loc, LLVM::LLVMPointerType::get(tag), list);
+
+            auto field = [&] (std::int32_t idx, mlir_type field_type) -> mlir_value {
+                return rewriter.create< LLVM::GEPOp >(
+                    loc, LLVM::LLVMPointerType::get(field_type), args,
+                    llvm::ArrayRef< LLVM::GEPArg >{ 0, idx }, /* inbounds */ true
+                );
+            };
+
+            auto i32_const = [&] (std::int64_t value) { return this->iN(rewriter, loc, i32, value); };
+
+            // The save area holds 6 general purpose registers of 8 bytes,
+            // followed by 8 vector registers of 16 bytes.
+            bool gp    = cls == reg_class::gp;
+            auto step  = gp ? 8 : 16;
+            auto limit = gp ? 48 : 176;
+
+            auto offset_ptr = field(gp ? 0 : 1, i32);
+            mlir_value offset = rewriter.create< LLVM::LoadOp >(loc, i32, offset_ptr);
+            mlir_value fits = rewriter.create< LLVM::ICmpOp >(
+                loc, LLVM::ICmpPredicate::ule, offset, i32_const(limit - step)
+            );
+
+            auto save_area = rewriter.create< LLVM::LoadOp >(loc, ptr, field(3, ptr));
+            auto in_regs   = rewriter.create< LLVM::GEPOp >(
+                loc, ptr, save_area, llvm::ArrayRef< LLVM::GEPArg >{ offset }
+            );
+
+            // Scalars take an 8 byte slot of the overflow area.
+            auto overflow_ptr = field(2, ptr);
+            mlir_value overflow = rewriter.create< LLVM::LoadOp >(loc, ptr, overflow_ptr);
+            mlir_value next_overflow = rewriter.create< LLVM::GEPOp >(
+                loc, ptr, overflow, llvm::ArrayRef< LLVM::GEPArg >{ 8 }
+            );
+
+            mlir_value next_offset = rewriter.create< LLVM::AddOp >(loc, offset, i32_const(step));
+            rewriter.create< LLVM::StoreOp >(
+                loc, rewriter.create< LLVM::SelectOp >(loc, fits, next_offset, offset), offset_ptr
+            );
+            rewriter.create< LLVM::StoreOp >(
+                loc, rewriter.create< LLVM::SelectOp >(loc, fits, overflow, next_overflow), overflow_ptr
+            );
+
+            auto addr = rewriter.create< LLVM::SelectOp >(loc, fits, in_regs, overflow);
+            auto slot = rewriter.create< LLVM::BitcastOp >(loc, LLVM::LLVMPointerType::get(type), addr);
+            return rewriter.create< LLVM::LoadOp >(loc, type, slot);
+        }
+    };
+
+    using builtin_conversions = util::type_list<
+        builtin_mem< hl::BuiltinMemcpyOp, LLVM::MemcpyOp >,
+        builtin_mem< hl::BuiltinMemsetOp, LLVM::MemsetOp >,
+        builtin_bit< hl::BuiltinPopcountOp, LLVM::CtPopOp >,
+        builtin_bit< hl::BuiltinClzOp, LLVM::CountLeadingZerosOp >,
+        builtin_bit< hl::BuiltinCtzOp, LLVM::CountTrailingZerosOp >,
+        builtin_bit< hl::BuiltinBswapOp, LLVM::ByteSwapOp >,
+        builtin_prefetch,
+        builtin_assume,
+        builtin_unreachable,
+        builtin_va< hl::BuiltinVAStartOp, LLVM::VaStartOp >,
+        builtin_va< hl::BuiltinVAEndOp, LLVM::VaEndOp >,
+        builtin_va< hl::BuiltinVACopyOp, LLVM::VaCopyOp >,
+        builtin_va_arg
+    >;
+
     // Drop types of operations that will be processed by pass for core(lazy) operations.
     template< typename LazyOp >
     struct lazy_op_type : base_pattern< LazyOp >
@@ -1410,8 +2471,9 @@ namespace vast::conv::irstollvm
         {
             auto lower_res_type = [&]()
             {
-                auto result = op.getResult();
-                result.setType(this->convert(result.getType()));
+                for (auto result : op->getResults()) {
+                    result.setType(this->convert(result.getType()));
+                }
             };
 
             rewriter.updateRootInPlace(op, lower_res_type);
@@ -1460,14 +2522,50 @@ namespace vast::conv::irstollvm
         lazy_op_type< core::LazyOp >,
         lazy_op_type< core::BinLAndOp >,
         lazy_op_type< core::BinLOrOp >,
+        lazy_op_type< core::SelectOp >,
         fixup_yield_types< hl::ValueYieldOp >
     >;
 
+    // Thread-local variables that do not state their model get `model`.
+    static void mark_default_tls_model(vast_module mod, llvm::StringRef model) {
+        auto attr = hl::TLSModelAttr::get(mod.getContext(), model);
+        mod.walk([&] (hl::VarDeclOp var) {
+            if (is_thread_local(var) && !var->hasAttr(hl::TLSModelAttr::attr_name()))
+                var->setAttr(hl::TLSModelAttr::attr_name(), attr);
+        });
+    }
+
+    // Value ranges of loads are kept by type lowering regardless of whether
+    // they are lowered to metadata.
+    static void drop_value_ranges(vast_module mod) {
+        mod.walk([] (hl::ImplicitCastOp cast) {
+            cast->removeAttr(hl::ValueRangeAttr::attr_name());
+        });
+    }
+
     struct IRsToLLVMPass : ModuleLLVMConversionPassMixin< IRsToLLVMPass, IRsToLLVMBase >
     {
         using base = ModuleLLVMConversionPassMixin< IRsToLLVMPass, IRsToLLVMBase >;
         using config = typename base::config;
 
+        IRsToLLVMPass() = default;
+
+        explicit IRsToLLVMPass(const irs_to_llvm_options &opts) {
+            this->tbaa = opts.tbaa;
+            this->lifetime_markers = opts.lifetime_markers;
+            this->no_signed_wrap = opts.no_signed_wrap;
+            this->noundef = opts.noundef;
+            this->value_ranges = opts.value_ranges;
+            this->tls_model = opts.tls_model;
+            this->dso_local = opts.dso_local;
+            this->pic = opts.pic;
+            this->pie = opts.pie;
+            this->semantic_interposition = opts.semantic_interposition;
+            this->no_plt = opts.no_plt;
+            this->direct_access_external_data = opts.direct_access_external_data;
+            this->return_slots = opts.return_slots;
+        }
+
         static conversion_target create_conversion_target(mcontext_t &context, auto &tc) {
             conversion_target target(context);
 
@@ -1485,6 +2583,12 @@ namespace vast::conv::irstollvm
             legal_with_llvm_ret_type( core::BinLOrOp{} );
             legal_with_llvm_ret_type( hl::ValueYieldOp{} );
 
+            target.addDynamicallyLegalOp< core::SelectOp >([&] (core::SelectOp op) {
+                return llvm::none_of(op.getResultTypes(), [&] (mlir_type type) {
+                    return contains_subtype(type, get_is_illegal(tc));
+                });
+            });
+
 
             target.addDynamicallyLegalOp< hl::InitListExpr >(
                 get_has_only_legal_types< hl::InitListExpr >(tc)
@@ -1506,9 +2610,12 @@ namespace vast::conv::irstollvm
                 sign_conversions,
                 init_conversions,
                 base_op_conversions,
+                atomic_conversions,
+                builtin_conversions,
                 ignore_patterns,
                 label_patterns,
                 lazy_op_type_conversions,
+                lifetime_conversions,
                 ll_generic_patterns,
                 ll_cf::conversions
             >(cfg);
@@ -1518,6 +2625,51 @@ namespace vast::conv::irstollvm
             llvm_options.useBarePtrCallConv = true;
         }
 
+        void runOnOperation() override {
+            if (lifetime_markers) {
+                emit_lifetime_markers(getOperation());
+            }
+
+            if (no_signed_wrap) {
+                mark_no_signed_wrap(getOperation());
+            }
+
+            if (noundef) {
+                mark_noundef_params(getOperation());
+            }
+
+            if (!value_ranges) {
+                drop_value_ranges(getOperation());
+            }
+
+            if (!tls_model.empty()) {
+                mark_default_tls_model(getOperation(), tls_model);
+            }
+
+            if (dso_local) {
+                mark_dso_local(getOperation(), {
+                    .pic = pic,
+                    .pie = pie,
+                    .semantic_interposition = semantic_interposition,
+                    .no_plt = no_plt,
+                    .direct_access_external_data = direct_access_external_data
+                });
+            }
+
+            base::run_on_operation();
+
+            form_fmuladds(getOperation());
+            merge_bitfield_updates(getOperation());
+            if (return_slots) {
+                use_return_slots(getOperation());
+            }
+            align_accesses(getOperation());
+            mark_tail_calls(getOperation());
+
+            if (tbaa) {
+                attach_tbaa_tags(getOperation());
+            }
+        }
     };
 } // namespace vast::conv
 
@@ -1526,3 +2678,8 @@ std::unique_ptr< mlir::Pass > vast::createIRsToLLVMPass()
 {
     return std::make_unique< vast::conv::irstollvm::IRsToLLVMPass >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createIRsToLLVMPass(const irs_to_llvm_options &opts)
+{
+    return std::make_unique< vast::conv::irstollvm::IRsToLLVMPass >(opts);
+}
@@ -9,6 +9,7 @@ VAST_RELAX_WARNINGS
 #include <llvm/ADT/APFloat.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "vast/Util/Symbols.hpp"
@@ -21,6 +22,76 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::conv::irstollvm::ll_cf
 {
+    // Same weights as clang emits for `__builtin_expect`.
+    static constexpr std::uint32_t likely_branch_weight   = 2000;
+    static constexpr std::uint32_t unlikely_branch_weight = 1;
+
+    using branch_weights_t = std::optional< std::pair< std::uint32_t, std::uint32_t > >;
+
+    // Weights of the `true` and `false` successors of a conditional branch.
+    // Profile weights take precedence over the expected outcome.
+    inline branch_weights_t branch_weights(operation op) {
+        auto profile = op->getAttrOfType< hl::BranchWeightsAttr >(
+            hl::BranchWeightsAttr::attr_name()
+        );
+
+        if (profile && profile.getWeights().size() == 2) {
+            return std::make_pair(profile.getWeights()[0], profile.getWeights()[1]);
+        }
+
+        auto attr = op->getAttrOfType< hl::BranchLikelihoodAttr >(
+            hl::BranchLikelihoodAttr::attr_name()
+        );
+
+        if (!attr) {
+            return std::nullopt;
+        }
+
+        if (attr.getLikely()) {
+            return std::make_pair(likely_branch_weight, unlikely_branch_weight);
+        }
+        return std::make_pair(unlikely_branch_weight, likely_branch_weight);
+    }
+
+    // Translates loop pragmas recorded in codegen to `llvm.loop` metadata.
+    inline LLVM::LoopAnnotationAttr loop_annotation(operation op) {
+        auto hints = op->getAttrOfType< hl::LoopHintsAttr >(hl::LoopHintsAttr::attr_name());
+        if (!hints) {
+            return {};
+        }
+
+        auto ctx = op->getContext();
+
+        LLVM::LoopVectorizeAttr vectorize;
+        if (hints.getVectorize() || hints.getVectorizeWidth()) {
+            auto disable = hints.getVectorize()
+                ? mlir::BoolAttr::get(ctx, !hints.getVectorize().getValue())
+                : mlir::BoolAttr();
+            vectorize = LLVM::LoopVectorizeAttr::get(
+                ctx, disable, {}, {}, hints.getVectorizeWidth(), {}, {}, {}
+            );
+        }
+
+        LLVM::LoopInterleaveAttr interleave;
+        if (auto count = hints.getInterleaveCount()) {
+            interleave = LLVM::LoopInterleaveAttr::get(ctx, count);
+        }
+
+        LLVM::LoopUnrollAttr unroll;
+        if (hints.getUnroll() || hints.getUnrollFull() || hints.getUnrollCount()) {
+            auto disable = hints.getUnroll()
+                ? mlir::BoolAttr::get(ctx, !hints.getUnroll().getValue())
+                : mlir::BoolAttr();
+            unroll = LLVM::LoopUnrollAttr::get(
+                ctx, disable, hints.getUnrollCount(), {}, hints.getUnrollFull(), {}, {}, {}
+            );
+        }
+
+        return LLVM::LoopAnnotationAttr::get(
+            ctx, {}, vectorize, interleave, unroll, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}
+        );
+    }
+
     struct br : base_pattern< ll::Br >
     {
         using base = base_pattern< ll::Br >;
@@ -33,7 +104,10 @@ namespace vast::conv::irstollvm::ll_cf
                     op_t op, adaptor_t ops,
                     conversion_rewriter &rewriter) const override
         {
-            rewriter.create< LLVM::BrOp >(op.getLoc(), ops.getOperands(), op.getDest());
+            auto br = rewriter.create< LLVM::BrOp >(op.getLoc(), ops.getOperands(), op.getDest());
+            if (auto annotation = loop_annotation(op)) {
+                br.setLoopAnnotationAttr(annotation);
+            }
             rewriter.eraseOp(op);
 
             return mlir::success();
@@ -57,7 +131,42 @@ namespace vast::conv::irstollvm::ll_cf
                 op.getLoc(),
                 ops.getCond(),
                 op.getTrueDest() , ops.getTrueOperands(),
-                op.getFalseDest(), ops.getFalseOperands()
+                op.getFalseDest(), ops.getFalseOperands(),
+                branch_weights(op)
+            );
+            rewriter.eraseOp( op );
+
+            return mlir::success();
+        }
+
+    };
+
+    struct switch_op : base_pattern< ll::Switch >
+    {
+        using base = base_pattern< ll::Switch >;
+        using base::base;
+
+        using op_t = ll::Switch;
+        using adaptor_t = typename op_t::Adaptor;
+
+        logical_result matchAndRewrite(
+            op_t op, adaptor_t ops,
+            conversion_rewriter &rewriter) const override
+        {
+            llvm::SmallVector< mlir::ValueRange > case_operands(op.getCaseDests().size());
+
+            llvm::SmallVector< std::int32_t > weights;
+            if (auto attr = op->getAttrOfType< hl::BranchWeightsAttr >(hl::BranchWeightsAttr::attr_name())) {
+                for (auto weight : attr.getWeights())
+                    weights.push_back(std::int32_t(weight));
+            }
+
+            rewriter.create< LLVM::SwitchOp >(
+                op.getLoc(),
+                ops.getValue(),
+                op.getDefaultDest(), mlir::ValueRange(),
+                op.getCaseValues(), op.getCaseDests(), case_operands,
+                weights
             );
             rewriter.eraseOp( op );
 
@@ -91,10 +200,15 @@ namespace vast::conv::irstollvm::ll_cf
                 make_after_op< LLVM::BrOp >(rewriter, &last, last.getLoc(),
                                             no_vals, &start);
             } else if (auto ret = mlir::dyn_cast< ll::CondScopeRet >(last)) {
-                make_after_op< LLVM::CondBrOp >(rewriter, &last, last.getLoc(),
-                                                ret.getCond(),
-                                                ret.getDest(), ret.getDestOperands(),
-                                                &end, no_vals);
+                auto br = make_after_op< LLVM::CondBrOp >(rewriter, &last, last.getLoc(),
+                                                          ret.getCond(),
+                                                          ret.getDest(), ret.getDestOperands(),
+                                                          &end, no_vals,
+                                                          branch_weights(ret));
+                // The back edge of a rotated loop.
+                if (auto annotation = loop_annotation(ret)) {
+                    br.setLoopAnnotationAttr(annotation);
+                }
             } else {
                 // Nothing to do (do not erase, since it is a standard branching).
                 return mlir::success();
@@ -172,6 +286,7 @@ namespace vast::conv::irstollvm::ll_cf
     using conversions = util::type_list<
           cond_br
         , br
+        , switch_op
         , scope
     >;
 
@@ -0,0 +1,90 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "Lifetime.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace {
+
+        bool may_bypass_declarations(operation fn) {
+            auto result = fn->walk([] (operation op) {
+                if (mlir::isa< hl::LabelStmt, hl::GotoStmt, hl::IndirectGotoStmt, hl::SwitchOp >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool is_scope(operation op) { return mlir::isa< core::ScopeOp, ll::Scope >(op); }
+
+        bool is_marked(ll::UninitializedVar var) {
+            return llvm::any_of(var->getUsers(), [] (operation user) {
+                return mlir::isa< ll::LifetimeStart >(user);
+            });
+        }
+
+        // Points where control leaves `scope` to the code that follows it.
+        void for_each_scope_exit(operation scope, auto &&yield) {
+            for (auto &block : scope->getRegion(0)) {
+                if (block.empty()) {
+                    yield(&block, block.end());
+                    continue;
+                }
+
+                auto &last = block.back();
+                if (mlir::isa< ll::ScopeRet >(last)) {
+                    yield(&block, mlir::Block::iterator(&last));
+                } else if (mlir::isa< core::ScopeOp >(scope) && !last.hasTrait< mlir::OpTrait::IsTerminator >()) {
+                    // Falls through to the end of the scope.
+                    yield(&block, block.end());
+                }
+            }
+        }
+
+        void mark(ll::UninitializedVar var, mlir::OpBuilder &bld) {
+            auto loc = var.getLoc();
+
+            bld.setInsertionPointAfter(var);
+            bld.create< ll::LifetimeStart >(loc, var);
+
+            for_each_scope_exit(var->getParentOp(), [&] (mlir::Block *block, mlir::Block::iterator point) {
+                bld.setInsertionPoint(block, point);
+                bld.create< ll::LifetimeEnd >(loc, var);
+            });
+        }
+
+    } // namespace
+
+    void emit_lifetime_markers(vast_module mod) {
+        mlir::OpBuilder bld(mod.getContext());
+
+        mod.walk([&] (mlir::FunctionOpInterface fn) {
+            if (fn.isExternal() || may_bypass_declarations(fn.getOperation())) {
+                return;
+            }
+
+            llvm::SmallVector< ll::UninitializedVar > vars;
+            fn->walk([&] (ll::UninitializedVar var) {
+                if (is_scope(var->getParentOp()) && !is_marked(var)) {
+                    vars.push_back(var);
+                }
+            });
+
+            for (auto var : vars) {
+                mark(var, bld);
+            }
+        });
+    }
+
+} // namespace vast::conv::irstollvm
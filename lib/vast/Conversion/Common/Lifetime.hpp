@@ -0,0 +1,21 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Marks lifetimes of variables declared in nested scopes (`core.scope` and
+    // `ll.scope`) by `ll.lifetime.start` at the declaration and `ll.lifetime.end`
+    // at each exit that leaves the scope normally. Exits without a marker (e.g.
+    // returns, or conditional scope returns) keep the variable alive longer,
+    // which is always correct.
+    //
+    // As clang does, functions where a jump may bypass a declaration (labels,
+    // switches) are left without markers.
+    //
+    void emit_lifetime_markers(vast_module mod);
+
+} // namespace vast::conv::irstollvm
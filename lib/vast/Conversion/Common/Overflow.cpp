@@ -0,0 +1,65 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "Overflow.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/BuiltinTypes.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace {
+
+        // Operands narrower than `int` are promoted, the arithmetic wraps
+        // only when the result is converted back, which is defined.
+        bool is_signed_arithmetic(operation op, unsigned int_width) {
+            if (!mlir::isa<
+                hl::AddIOp, hl::SubIOp, hl::MulIOp,
+                hl::AddIAssignOp, hl::SubIAssignOp, hl::MulIAssignOp,
+                hl::PreIncOp, hl::PostIncOp, hl::PreDecOp, hl::PostDecOp
+            >(op)) {
+                return false;
+            }
+
+            auto type = mlir::dyn_cast< mlir::IntegerType >(op->getResult(0).getType());
+            return type && type.isSigned() && type.getWidth() >= int_width;
+        }
+
+        // Results of the `*_fetch` builtins are computed from the previous
+        // value of the object, they wrap as the atomic operation does.
+        bool is_fetched(operation op) {
+            return op->getNumOperands() > 0
+                && op->getOperand(0).getDefiningOp< hl::AtomicRMWOp >();
+        }
+
+        unsigned int_width(vast_module mod) {
+            if (auto table = hl::builtin_layout_table::of_module(mod)) {
+                return (*table)[hl::builtin_type::int_type].size;
+            }
+            return 32;
+        }
+
+    } // namespace
+
+    void mark_no_signed_wrap(vast_module mod) {
+        auto nsw   = hl::NoSignedWrapAttr::get(mod.getContext());
+        auto width = int_width(mod);
+        mod.walk([&] (operation op) {
+            if ((is_signed_arithmetic(op, width) && !is_fetched(op)) || mlir::isa< hl::SubscriptOp >(op)) {
+                op->setAttr(hl::NoSignedWrapAttr::attr_name(), nsw);
+            }
+        });
+    }
+
+    void forward_no_signed_wrap(operation from, operation to) {
+        if (auto nsw = from->getAttr(hl::NoSignedWrapAttr::attr_name())) {
+            to->setAttr(hl::NoSignedWrapAttr::attr_name(), nsw);
+        }
+    }
+
+} // namespace vast::conv::irstollvm
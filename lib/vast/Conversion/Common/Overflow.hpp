@@ -0,0 +1,25 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Marks signed integer additions, subtractions and multiplications of
+    // `mod` (including compound assignments, increments and decrements) and
+    // array subscripts by `hl.nsw`. The mark is forwarded by the conversion to
+    // the created LLVM arithmetic and translated to its `nsw` flag, subscripts
+    // become `inbounds` address computations.
+    //
+    // Signedness of integers is lost after the conversion, so the operations
+    // are marked while still in the `hl` dialect. It is up to the caller to
+    // decide, whether signed overflow is undefined (i.e. without `-fwrapv`).
+    //
+    void mark_no_signed_wrap(vast_module mod);
+
+    // Copies the `hl.nsw` mark of `from` to `to`.
+    void forward_no_signed_wrap(operation from, operation to);
+
+} // namespace vast::conv::irstollvm
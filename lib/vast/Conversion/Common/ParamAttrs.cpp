@@ -0,0 +1,38 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "ParamAttrs.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/BuiltinTypes.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/ABI/ABI.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace {
+
+        bool is_noundef(mlir_type type) {
+            return mlir::isa<
+                mlir::IntegerType, mlir::FloatType, hl::PointerType, hl::ReferenceType
+            >(type);
+        }
+
+    } // namespace
+
+    void mark_noundef_params(vast_module mod) {
+        auto noundef = mlir::UnitAttr::get(mod.getContext());
+        mod.walk([&] (mlir::FunctionOpInterface fn) {
+            for (auto [idx, type] : llvm::enumerate(fn.getArgumentTypes())) {
+                if (is_noundef(type) && !fn.getArgAttr(unsigned(idx), abi::coerced_arg_attr)) {
+                    fn.setArgAttr(idx, mlir::LLVM::LLVMDialect::getNoUndefAttrName(), noundef);
+                }
+            }
+        });
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,23 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Marks scalar parameters (integers, floats, pointers and references) of
+    // functions in `mod` by `llvm.noundef`, as clang does for values it passes
+    // directly. The mark is attached while parameter types are still the
+    // source ones, the function conversion forwards all `llvm` argument
+    // attributes to the created `llvm.func`.
+    //
+    // Records are left unmarked, their padding may be undefined, and so are
+    // the integers the lowering of the ABI passes records as. Return values
+    // are not marked, since C makes only the use of an undefined return value
+    // undefined.
+    //
+    void mark_noundef_params(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,237 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "../PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    namespace
+    {
+        // Jumps to labels may enter a block in the middle, past the stores
+        // that precede the label.
+        bool has_labels(operation fn) {
+            auto result = fn->walk([] (operation op) {
+                if (mlir::isa< hl::LabelStmt, hl::GotoStmt, hl::IndirectGotoStmt >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool is_scalar(mlir_type type) {
+            return mlir::isa< mlir::IntegerType, mlir::FloatType, hl::PointerType >(type);
+        }
+
+        using hl::is_load;
+
+        //
+        // Accesses of a local variable that does not escape, i.e., its storage
+        // is only read by `LValueToRValue` casts and written by its initializer
+        // and plain assignments.
+        //
+        struct promotable_var
+        {
+            ll::UninitializedVar var;
+            ll::InitializeVar init;
+
+            llvm::SmallVector< hl::DeclRefOp >    refs;
+            llvm::SmallVector< hl::ImplicitCastOp > loads;
+            llvm::SmallVector< operation >        stores;
+            llvm::SmallVector< operation >        markers;
+
+            mlir_type element_type() const {
+                return mlir::cast< hl::LValueType >(var.getType()).getElementType();
+            }
+
+            mlir::Block *block() const { return var->getBlock(); }
+
+            static std::optional< promotable_var > analyze(ll::UninitializedVar var) {
+                auto lvalue = mlir::dyn_cast< hl::LValueType >(var.getType());
+                if (!lvalue || !is_scalar(lvalue.getElementType())) {
+                    return std::nullopt;
+                }
+
+                promotable_var self{ var, {} };
+                if (!self.collect_users(var)) {
+                    return std::nullopt;
+                }
+
+                if (self.init && !self.collect_users(self.init.getResult())) {
+                    return std::nullopt;
+                }
+
+                for (auto ref : self.refs) {
+                    if (!self.collect_accesses(ref)) {
+                        return std::nullopt;
+                    }
+                }
+
+                return self;
+            }
+
+            bool collect_users(mlir_value storage) {
+                for (auto user : storage.getUsers()) {
+                    if (auto ref = mlir::dyn_cast< hl::DeclRefOp >(user)) {
+                        refs.push_back(ref);
+                    } else if (mlir::isa< ll::LifetimeStart, ll::LifetimeEnd >(user)) {
+                        markers.push_back(user);
+                    } else if (auto init = mlir::dyn_cast< ll::InitializeVar >(user)) {
+                        if (!is_initializer(init)) {
+                            return false;
+                        }
+                        this->init = init;
+                        stores.push_back(init);
+                    } else {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool is_initializer(ll::InitializeVar op) const {
+                return !init && op.getVar() == var.getResult()
+                    && op->getBlock() == block()
+                    && op.getElements().size() == 1
+                    && op.getElements()[0].getType() == element_type();
+            }
+
+            bool collect_accesses(hl::DeclRefOp ref) {
+                for (auto user : ref->getUsers()) {
+                    if (is_load(user) && user->getResult(0).getType() == element_type()) {
+                        loads.push_back(mlir::cast< hl::ImplicitCastOp >(user));
+                    } else if (auto assign = mlir::dyn_cast< hl::AssignOp >(user)) {
+                        if (assign.getDst() != ref.getResult()
+                            || assign.getSrc().getType() != element_type()
+                            || assign->getBlock() != block()
+                        ) {
+                            return false;
+                        }
+                        stores.push_back(assign);
+                    } else {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            static mlir_value stored_value(operation store) {
+                if (auto init = mlir::dyn_cast< ll::InitializeVar >(store)) {
+                    return init.getElements()[0];
+                }
+                return mlir::cast< hl::AssignOp >(store).getSrc();
+            }
+
+            // The value stored last before `load`. Stores are in the block of the
+            // variable, so it is the last store preceding the operation that
+            // encloses `load` in that block. Expects `stores` in block order.
+            mlir_value reaching_value(hl::ImplicitCastOp load) const {
+                auto point = block()->findAncestorOpInBlock(*load);
+                if (!point) {
+                    return {};
+                }
+
+                auto next = llvm::partition_point(stores, [&] (operation store) {
+                    return store->isBeforeInBlock(point);
+                });
+
+                return next != stores.begin() ? stored_value(*std::prev(next)) : mlir_value();
+            }
+
+            logical_result promote() {
+                // Sorted once, so that a variable of many loads and stores,
+                // e.g., the state of a generated state machine, is promoted
+                // in `O((loads + stores) log stores)`.
+                llvm::sort(stores, [] (operation a, operation b) {
+                    return a->isBeforeInBlock(b);
+                });
+
+                llvm::SmallVector< mlir_value > values;
+                for (auto load : loads) {
+                    auto value = reaching_value(load);
+                    // Reads of an uninitialized variable keep the variable in memory.
+                    if (!value) {
+                        return mlir::failure();
+                    }
+                    values.push_back(value);
+                }
+
+                for (auto [load, value] : llvm::zip(loads, values)) {
+                    load.getResult().replaceAllUsesWith(value);
+                    load->erase();
+                }
+
+                for (auto store : stores) {
+                    // `hl.assign` yields the assigned value.
+                    if (auto assign = mlir::dyn_cast< hl::AssignOp >(store)) {
+                        assign.getResult().replaceAllUsesWith(assign.getSrc());
+                    }
+                }
+
+                for (auto store : stores) {
+                    if (store != init.getOperation()) {
+                        store->erase();
+                    }
+                }
+
+                for (auto ref : refs) {
+                    ref->erase();
+                }
+
+                for (auto marker : markers) {
+                    marker->erase();
+                }
+
+                if (init) {
+                    init->erase();
+                }
+
+                var->erase();
+                return mlir::success();
+            }
+        };
+
+    } // namespace
+
+    struct LLPromoteVarsPass : LLPromoteVarsBase< LLPromoteVarsPass >
+    {
+        void runOnOperation() override {
+            getOperation()->walk([] (mlir::FunctionOpInterface fn) {
+                if (fn.isExternal() || has_labels(fn.getOperation())) {
+                    return;
+                }
+
+                llvm::SmallVector< ll::UninitializedVar > vars;
+                fn->walk([&] (ll::UninitializedVar var) { vars.push_back(var); });
+
+                for (auto var : vars) {
+                    if (auto promotable = promotable_var::analyze(var)) {
+                        std::ignore = promotable->promote();
+                    }
+                }
+            });
+        }
+    };
+
+} // namespace vast::conv
+
+std::unique_ptr< mlir::Pass > vast::createLLPromoteVarsPass()
+{
+    return std::make_unique< vast::conv::LLPromoteVarsPass >();
+}
@@ -0,0 +1,270 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "ReturnSlots.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        // Records up to two eightbytes are returned in registers by the x86-64
+        // System V convention.
+        constexpr std::uint64_t max_register_return_size = 16;
+
+        struct slot_function
+        {
+            LLVM::LLVMFuncOp fn;
+            LLVM::LLVMStructType record;
+            LLVM::LLVMPointerType slot;
+        };
+
+        bool is_direct_call(operation user) {
+            auto call = mlir::dyn_cast< LLVM::CallOp >(user);
+            return call && !call->hasAttr(hl::MustTailAttr::attr_name());
+        }
+
+        std::optional< slot_function > returns_in_memory(
+            LLVM::LLVMFuncOp fn, vast_module mod, const mlir::DataLayout &dl
+        ) {
+            auto type   = fn.getFunctionType();
+            auto record = mlir::dyn_cast< LLVM::LLVMStructType >(type.getReturnType());
+            if (!record || record.isOpaque() || type.isVarArg()) {
+                return std::nullopt;
+            }
+
+            if (dl.getTypeSize(record) <= max_register_return_size) {
+                return std::nullopt;
+            }
+
+            auto uses = mlir::SymbolTable::getSymbolUses(fn, mod);
+            if (!uses || !llvm::all_of(*uses, [] (auto use) { return is_direct_call(use.getUser()); })) {
+                return std::nullopt;
+            }
+
+            return slot_function{ fn, record, LLVM::LLVMPointerType::get(record) };
+        }
+
+        // The address is used other than to access the memory it points to.
+        bool is_captured(mlir_value addr) {
+            return llvm::any_of(addr.getUses(), [] (auto &use) {
+                auto user = use.getOwner();
+                if (mlir::isa<
+                    LLVM::LoadOp, LLVM::LifetimeStartOp, LLVM::LifetimeEndOp,
+                    LLVM::MemcpyOp, LLVM::MemmoveOp, LLVM::MemsetOp
+                >(user)) {
+                    return false;
+                }
+
+                if (auto store = mlir::dyn_cast< LLVM::StoreOp >(user)) {
+                    return store.getValue() == use.get();
+                }
+
+                if (mlir::isa< LLVM::GEPOp, LLVM::BitcastOp >(user)) {
+                    return is_captured(user->getResult(0));
+                }
+
+                return true;
+            });
+        }
+
+        bool is_entry_alloca(LLVM::AllocaOp alloca) {
+            auto fn = alloca->getParentOfType< LLVM::LLVMFuncOp >();
+            return fn && alloca->getBlock() == &fn.front();
+        }
+
+        // Store of the call result to a local that the callee cannot access,
+        // the local is then the return slot of the call.
+        LLVM::StoreOp initialized_local(LLVM::CallOp call, LLVM::LLVMPointerType slot) {
+            auto result = call.getResult();
+            if (!result.hasOneUse()) {
+                return {};
+            }
+
+            auto store = mlir::dyn_cast< LLVM::StoreOp >(*result.getUsers().begin());
+            if (!store || store.getValue() != result || store->getBlock() != call->getBlock()) {
+                return {};
+            }
+
+            auto local = store.getAddr().getDefiningOp< LLVM::AllocaOp >();
+            if (!local || local.getType() != slot || !is_entry_alloca(local) || is_captured(local)) {
+                return {};
+            }
+
+            if (local->getBlock() == call->getBlock() && !local->isBeforeInBlock(call)) {
+                return {};
+            }
+
+            // Nothing may read the previous value of the local meanwhile.
+            for (auto op = call->getNextNode(); op != store; op = op->getNextNode()) {
+                if (!mlir::isMemoryEffectFree(op)) {
+                    return {};
+                }
+            }
+
+            return store;
+        }
+
+        mlir_value make_temporary(LLVM::CallOp call, LLVM::LLVMPointerType slot) {
+            auto caller = call->getParentOfType< LLVM::LLVMFuncOp >();
+            auto bld = mlir::OpBuilder::atBlockBegin(&caller.front());
+
+            auto loc   = call.getLoc();
+            auto i64   = bld.getI64Type();
+            auto count = bld.create< LLVM::ConstantOp >(loc, i64, bld.getIntegerAttr(i64, 1));
+            return bld.create< LLVM::AllocaOp >(loc, slot, count, 0);
+        }
+
+        void call_with_slot(LLVM::CallOp call, LLVM::LLVMPointerType slot) {
+            auto store = initialized_local(call, slot);
+            auto dst   = store ? store.getAddr() : make_temporary(call, slot);
+
+            mlir::OpBuilder bld(call);
+            llvm::SmallVector< mlir_value > args = { dst };
+            llvm::append_range(args, call.getOperands());
+
+            auto replacement = bld.create< LLVM::CallOp >(
+                call.getLoc(), mlir::TypeRange{}, call.getCalleeAttr(), args
+            );
+            for (auto attr : call->getAttrs()) {
+                if (attr.getName() != call.getCalleeAttrName()) {
+                    replacement->setAttr(attr.getName(), attr.getValue());
+                }
+            }
+
+            if (store) {
+                store.erase();
+            } else {
+                call.getResult().replaceAllUsesWith(bld.create< LLVM::LoadOp >(call.getLoc(), dst));
+            }
+            call.erase();
+        }
+
+        // Local read by every return of `fn`, if there is one.
+        LLVM::AllocaOp returned_local(const slot_function &sf) {
+            LLVM::AllocaOp local;
+            auto result = sf.fn.walk([&] (LLVM::ReturnOp ret) {
+                auto load   = ret.getOperand(0).getDefiningOp< LLVM::LoadOp >();
+                auto alloca = load ? load.getAddr().getDefiningOp< LLVM::AllocaOp >() : nullptr;
+                if (!alloca || (local && alloca != local)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                local = alloca;
+                return mlir::WalkResult::advance();
+            });
+
+            if (result.wasInterrupted() || !local) {
+                return {};
+            }
+
+            if (local.getType() != sf.slot || !is_entry_alloca(local)) {
+                return {};
+            }
+            return local;
+        }
+
+        void add_slot_param(const slot_function &sf) {
+            auto fn   = sf.fn;
+            auto ctx  = fn.getContext();
+            auto type = fn.getFunctionType();
+
+            llvm::SmallVector< mlir_type > params = { sf.slot };
+            llvm::append_range(params, type.getParams());
+            fn.setFunctionTypeAttr(mlir::TypeAttr::get(
+                LLVM::LLVMFunctionType::get(LLVM::LLVMVoidType::get(ctx), params, false)
+            ));
+
+            if (auto attrs = fn.getArgAttrsAttr()) {
+                llvm::SmallVector< mlir_attr > shifted = { mlir::DictionaryAttr::get(ctx) };
+                llvm::append_range(shifted, attrs);
+                fn.setArgAttrsAttr(mlir::ArrayAttr::get(ctx, shifted));
+            }
+            fn.removeResAttrsAttr();
+
+            fn.setArgAttr(0, LLVM::LLVMDialect::getStructRetAttrName(), mlir::TypeAttr::get(sf.record));
+            fn.setArgAttr(0, LLVM::LLVMDialect::getNoAliasAttrName(), mlir::UnitAttr::get(ctx));
+        }
+
+        void return_through_slot(const slot_function &sf) {
+            auto fn = sf.fn;
+            auto local = returned_local(sf);
+
+            add_slot_param(sf);
+            if (fn.isExternal()) {
+                return;
+            }
+
+            auto slot = fn.front().insertArgument(0u, sf.slot, fn.getLoc());
+
+            if (local) {
+                for (auto user : llvm::make_early_inc_range(local->getUsers())) {
+                    if (mlir::isa< LLVM::LifetimeStartOp, LLVM::LifetimeEndOp >(user)) {
+                        user->erase();
+                    }
+                }
+                local.replaceAllUsesWith(slot);
+                local.erase();
+            }
+
+            llvm::SmallVector< LLVM::ReturnOp > rets;
+            fn.walk([&] (LLVM::ReturnOp ret) { rets.push_back(ret); });
+
+            for (auto ret : rets) {
+                mlir::OpBuilder bld(ret);
+                auto value = ret.getOperand(0);
+                if (!local) {
+                    bld.create< LLVM::StoreOp >(ret.getLoc(), value, slot);
+                }
+                bld.create< LLVM::ReturnOp >(ret.getLoc(), mlir::ValueRange());
+                ret.erase();
+
+                // The returned local is the slot already.
+                if (auto load = value.getDefiningOp< LLVM::LoadOp >(); local && load && load->use_empty()) {
+                    load.erase();
+                }
+            }
+        }
+
+    } // namespace
+
+    void use_return_slots(vast_module mod) {
+        mlir::DataLayout dl(mod);
+
+        llvm::SmallVector< slot_function > fns;
+        for (auto fn : mod.getOps< LLVM::LLVMFuncOp >()) {
+            if (auto sf = returns_in_memory(fn, mod, dl)) {
+                fns.push_back(*sf);
+            }
+        }
+
+        // Calls first, so that a returned call result becomes a returned
+        // local which the caller then builds in its own slot.
+        for (const auto &sf : fns) {
+            llvm::SmallVector< LLVM::CallOp > calls;
+            for (auto use : *mlir::SymbolTable::getSymbolUses(sf.fn, mod)) {
+                calls.push_back(mlir::cast< LLVM::CallOp >(use.getUser()));
+            }
+
+            for (auto call : calls) {
+                call_with_slot(call, sf.slot);
+            }
+        }
+
+        for (const auto &sf : fns) {
+            return_through_slot(sf);
+        }
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,24 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Returns records larger than two eightbytes through a pointer to the
+    // memory of the caller, i.e., an `llvm.sret` parameter, as the x86-64
+    // System V calling convention does. Other targets classify records
+    // differently, the frontend enables the rewrite only for x86-64 System V
+    // targets. A function whose every return reads the same local builds that
+    // local in the return slot directly (NRVO), and a call whose result only
+    // initializes a local that does not escape writes to it directly. Other
+    // calls pass a temporary.
+    //
+    // Only functions that are never used other than by direct calls are
+    // changed, the type of their address stays intact.
+    //
+    void use_return_slots(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,206 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Block.h>
+#include <mlir/IR/Region.h>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "../PassesDetails.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    namespace
+    {
+        // Regions whose blocks are plain control flow. Other regions, e.g., of
+        // `hl.for`, give meaning to their blocks by position.
+        bool is_cfg_region(mlir::Region &region) {
+            return mlir::isa< ll::FuncOp, ll::Scope, core::ScopeOp >(region.getParentOp());
+        }
+
+        // Blocks that must stay in place: the entry, and the start block of
+        // an `ll.scope`, i.e., its second block, where `ll.scope_recurse` jumps.
+        bool is_pinned(mlir::Block &block) {
+            auto region = block.getParent();
+            if (&block == &region->front()) {
+                return true;
+            }
+
+            if (mlir::isa< ll::Scope >(region->getParentOp())) {
+                return &block == &*std::next(region->begin());
+            }
+
+            return false;
+        }
+
+        // Blocks of `core.scope` may end without a terminator.
+        operation terminator(mlir::Block &block) {
+            if (block.empty() || !block.back().hasTrait< mlir::OpTrait::IsTerminator >()) {
+                return nullptr;
+            }
+            return &block.back();
+        }
+
+        // Target of a block that does nothing but branch, if any.
+        mlir::Block *forwarded_to(mlir::Block *block) {
+            if (block->getNumArguments() != 0 || !llvm::hasSingleElement(*block)) {
+                return nullptr;
+            }
+
+            auto br = mlir::dyn_cast< ll::Br >(block->front());
+            if (!br || !br.getOperands().empty() || br.getDest() == block) {
+                return nullptr;
+            }
+            return br.getDest();
+        }
+
+        // Last block of a chain of forwarding blocks that starts at `block`.
+        mlir::Block *thread(mlir::Block *block) {
+            llvm::SmallPtrSet< mlir::Block *, 4 > seen = { block };
+            while (auto next = forwarded_to(block)) {
+                if (!seen.insert(next).second) {
+                    break;
+                }
+                block = next;
+            }
+            return block;
+        }
+
+        bool thread_branches(mlir::Region &region) {
+            bool changed = false;
+            for (auto &block : region) {
+                auto term = terminator(block);
+                if (!term) {
+                    continue;
+                }
+
+                for (unsigned idx = 0; idx < term->getNumSuccessors(); ++idx) {
+                    auto succ = term->getSuccessor(idx);
+                    if (succ->getNumArguments() != 0) {
+                        continue;
+                    }
+
+                    if (auto target = thread(succ); target != succ) {
+                        term->setSuccessor(target, idx);
+                        changed = true;
+                    }
+                }
+            }
+            return changed;
+        }
+
+        bool erase_unreachable(mlir::Region &region) {
+            bool changed = false;
+            for (auto &block : llvm::make_early_inc_range(llvm::drop_begin(region))) {
+                if (block.hasNoPredecessors() && !is_pinned(block)) {
+                    block.dropAllDefinedValueUses();
+                    block.erase();
+                    changed = true;
+                }
+            }
+            return changed;
+        }
+
+        // Merges blocks into their single predecessor, if it branches only to them.
+        bool merge_blocks(mlir::Region &region) {
+            bool changed = false;
+            for (auto &block : llvm::make_early_inc_range(region)) {
+                if (is_pinned(block) || block.getNumArguments() != 0) {
+                    continue;
+                }
+
+                auto pred = block.getSinglePredecessor();
+                if (!pred || pred == &block) {
+                    continue;
+                }
+
+                auto br = mlir::dyn_cast_if_present< ll::Br >(terminator(*pred));
+                if (!br || br.getDest() != &block) {
+                    continue;
+                }
+
+                br.erase();
+                pred->getOperations().splice(pred->end(), block.getOperations());
+                block.erase();
+                changed = true;
+            }
+            return changed;
+        }
+
+        void simplify(mlir::Region &region) {
+            if (region.empty() || region.hasOneBlock()) {
+                return;
+            }
+
+            // Every step removes a branch or a block, so the loop terminates.
+            bool changed = true;
+            while (changed) {
+                changed = thread_branches(region);
+                changed |= erase_unreachable(region);
+                changed |= merge_blocks(region);
+            }
+        }
+
+        bool is_empty_scope(operation op) {
+            if (auto scope = mlir::dyn_cast< core::ScopeOp >(op)) {
+                auto &body = scope.getBody();
+                return body.empty() || (body.hasOneBlock() && body.front().empty());
+            }
+
+            if (auto scope = mlir::dyn_cast< ll::Scope >(op)) {
+                auto &body = scope.getBody();
+                if (body.empty()) {
+                    return true;
+                }
+                return body.hasOneBlock()
+                    && llvm::hasSingleElement(body.front())
+                    && mlir::isa< ll::ScopeRet >(body.front().front());
+            }
+
+            return false;
+        }
+
+    } // namespace
+
+    struct LLSimplifyCFG : LLSimplifyCFGBase< LLSimplifyCFG >
+    {
+        void runOnOperation() override
+        {
+            // Nested regions first, so that a scope emptied by the
+            // simplification of its body is removed as well.
+            llvm::SmallVector< mlir::Region * > regions;
+            getOperation()->walk([&] (operation op) {
+                for (auto &region : op->getRegions()) {
+                    if (is_cfg_region(region)) {
+                        regions.push_back(&region);
+                    }
+                }
+            });
+
+            for (auto region : regions) {
+                simplify(*region);
+
+                auto parent = region->getParentOp();
+                if (parent != getOperation() && is_empty_scope(parent)) {
+                    parent->erase();
+                }
+            }
+        }
+    };
+
+} // namespace vast::conv
+
+std::unique_ptr< mlir::Pass > vast::createLLSimplifyCFGPass()
+{
+    return std::make_unique< vast::conv::LLSimplifyCFG >();
+}
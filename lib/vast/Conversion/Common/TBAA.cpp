@@ -0,0 +1,105 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "TBAA.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        struct tbaa_tree
+        {
+            explicit tbaa_tree(mcontext_t *ctx)
+                : ctx(ctx)
+                , root(LLVM::TBAARootAttr::get(ctx, mlir::StringAttr::get(ctx, "Simple C/C++ TBAA")))
+                , omnipotent_char(node("omnipotent char", root))
+            {}
+
+            // Name of the node clang uses for the scalar type.
+            static std::optional< string_ref > scalar_name(mlir_type type) {
+                using result_t = std::optional< string_ref >;
+                return llvm::TypeSwitch< mlir_type, result_t >(type)
+                    .Case([] (mlir::IntegerType t) -> result_t {
+                        switch (t.getWidth()) {
+                            case 1:   return "_Bool";
+                            case 8:   return "omnipotent char";
+                            case 16:  return "short";
+                            case 32:  return "int";
+                            case 64:  return "long";
+                            case 128: return "__int128";
+                            default:  return std::nullopt;
+                        }
+                    })
+                    .Case([] (mlir::Float32Type) { return "float"; })
+                    .Case([] (mlir::Float64Type) { return "double"; })
+                    .Case< mlir::Float80Type, mlir::Float128Type >([] (auto) {
+                        return "long double";
+                    })
+                    .Case([] (LLVM::LLVMPointerType) { return "any pointer"; })
+                    .Default([] (auto) { return std::nullopt; });
+            }
+
+            LLVM::TBAATagAttr tag(mlir_type type) {
+                if (auto it = tags.find(type); it != tags.end()) {
+                    return it->second;
+                }
+
+                LLVM::TBAATagAttr out;
+                if (auto name = scalar_name(type)) {
+                    auto desc = *name == "omnipotent char" ? omnipotent_char : node(*name, omnipotent_char);
+                    out = LLVM::TBAATagAttr::get(ctx, desc, desc, /* offset */ 0, /* constant */ false);
+                }
+
+                return tags.try_emplace(type, out).first->second;
+            }
+
+          private:
+            LLVM::TBAATypeDescriptorAttr node(string_ref name, LLVM::TBAANodeAttr parent) {
+                return LLVM::TBAATypeDescriptorAttr::get(
+                    ctx, name, LLVM::TBAAMemberAttr::get(ctx, parent, /* offset */ 0)
+                );
+            }
+
+            mcontext_t *ctx;
+            LLVM::TBAARootAttr root;
+            LLVM::TBAATypeDescriptorAttr omnipotent_char;
+
+            llvm::DenseMap< mlir_type, LLVM::TBAATagAttr > tags;
+        };
+
+        bool is_reinterpreted(mlir::Value addr) {
+            return addr.getDefiningOp< LLVM::BitcastOp >();
+        }
+
+    } // namespace
+
+    void attach_tbaa_tags(vast_module mod) {
+        tbaa_tree tree(mod.getContext());
+
+        auto attach = [&] (auto op, mlir_type accessed) {
+            if (is_reinterpreted(op.getAddr())) {
+                return;
+            }
+
+            if (auto tag = tree.tag(accessed)) {
+                op.setTbaaAttr(mlir::ArrayAttr::get(mod.getContext(), { tag }));
+            }
+        };
+
+        mod.walk([&] (operation op) {
+            llvm::TypeSwitch< operation >(op)
+                .Case([&] (LLVM::LoadOp load) { attach(load, load.getType()); })
+                .Case([&] (LLVM::StoreOp store) { attach(store, store.getValue().getType()); });
+        });
+    }
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,22 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Attaches type-based alias analysis tags to `llvm.load` and `llvm.store`
+    // operations of `mod`. The type tree mirrors the one clang emits for C:
+    // scalar types hang below `omnipotent char`, which aliases everything.
+    //
+    // HL scalar types are already lowered to builtin types at this point, so
+    // types are recognized by their width (e.g. `long` and `long long` share
+    // a node), which only makes the tree more conservative. Accesses of
+    // aggregates and accesses through a reinterpreted pointer (coerced ABI
+    // accesses, type punning) are not tagged, i.e. they may alias anything.
+    //
+    void attach_tbaa_tags(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -0,0 +1,87 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "TailCalls.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+
+namespace vast::conv::irstollvm {
+
+    namespace LLVM = mlir::LLVM;
+
+    namespace {
+
+        // The address of the alloca is used other than to load and store its value.
+        bool is_captured(LLVM::AllocaOp alloca) {
+            return llvm::any_of(alloca->getUses(), [] (auto &use) {
+                auto user = use.getOwner();
+                if (mlir::isa< LLVM::LoadOp, LLVM::LifetimeStartOp, LLVM::LifetimeEndOp >(user)) {
+                    return false;
+                }
+
+                if (auto store = mlir::dyn_cast< LLVM::StoreOp >(user)) {
+                    return store.getValue() == use.get();
+                }
+
+                return true;
+            });
+        }
+
+        bool has_captured_allocas(LLVM::LLVMFuncOp fn) {
+            auto result = fn.walk([] (LLVM::AllocaOp alloca) {
+                return is_captured(alloca) ? mlir::WalkResult::interrupt()
+                                           : mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool is_tail_position(LLVM::CallOp call) {
+            auto ret = mlir::dyn_cast_or_null< LLVM::ReturnOp >(call->getNextNode());
+            if (!ret) {
+                return false;
+            }
+
+            if (ret.getNumOperands() == 0) {
+                return call.getNumResults() == 0;
+            }
+
+            return call.getNumResults() == 1 && ret.getOperand(0) == call.getResult();
+        }
+
+    } // namespace
+
+    void mark_tail_calls(vast_module mod) {
+        llvm::DenseMap< operation, bool > captures;
+        auto has_captures = [&] (LLVM::LLVMFuncOp fn) {
+            auto [it, inserted] = captures.try_emplace(fn, false);
+            if (inserted) {
+                it->second = has_captured_allocas(fn);
+            }
+            return it->second;
+        };
+
+        auto ctx = mod.getContext();
+        mod.walk([&] (LLVM::CallOp call) {
+            auto tail = is_tail_position(call);
+            if (call->hasAttr(hl::MustTailAttr::attr_name())) {
+                if (!tail) {
+                    call->removeAttr(hl::MustTailAttr::attr_name());
+                }
+                return;
+            }
+
+            auto fn = call->getParentOfType< LLVM::LLVMFuncOp >();
+            if (tail && fn && !has_captures(fn)) {
+                call->setAttr(hl::TailCallAttr::attr_name(), hl::TailCallAttr::get(ctx));
+            }
+        });
+    }
+
+} // namespace vast::conv::irstollvm
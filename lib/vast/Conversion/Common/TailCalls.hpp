@@ -0,0 +1,22 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv::irstollvm {
+
+    //
+    // Marks `llvm.call` operations of `mod` whose result is immediately
+    // returned by `hl.tail`, i.e., calls followed by `llvm.return` without
+    // any cleanups in between. A call is marked only if no alloca of the caller
+    // escapes, since a tail call must not access the stack frame of its caller.
+    //
+    // Calls of `[[clang::musttail]]` returns keep their `hl.musttail`, which
+    // is dropped if the call is not in a tail position after the conversion.
+    // The LLVM dialect has no notion of tail calls, both marks are lowered
+    // by the translation to llvm ir.
+    //
+    void mark_tail_calls(vast_module mod);
+
+} // namespace vast::conv::irstollvm
@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/IR/IRMapping.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
 #include <iterator>
@@ -29,12 +30,89 @@ namespace vast
         namespace LLVM = mlir::LLVM;
 
 
+        // Lazy operands of at most this many operations are evaluated eagerly
+        // when they are speculatable.
+        constexpr std::size_t eager_budget = 8;
+
+        // Loads from locals and globals cannot trap, other operations must be
+        // free of side effects. Divisions are pure in the llvm dialect, but
+        // trap on zero.
+        static inline bool is_speculatable(operation op) {
+            if (auto load = mlir::dyn_cast< LLVM::LoadOp >(op)) {
+                auto addr = load.getAddr().getDefiningOp();
+                return !load.getVolatile_()
+                    && mlir::isa_and_nonnull< LLVM::AllocaOp, LLVM::AddressOfOp >(addr);
+            }
+
+            if (mlir::isa< LLVM::SDivOp, LLVM::UDivOp, LLVM::SRemOp, LLVM::URemOp >(op)) {
+                return false;
+            }
+
+            return mlir::isa< hl::ValueYieldOp >(op) || mlir::isPure(op);
+        }
+
+        // The lazy region is a single block of cheap speculatable operations
+        // that yields a value, i.e., it can be evaluated without a branch.
+        static inline bool is_eager(mlir_value lazy) {
+            auto op = lazy.getDefiningOp< core::LazyOp >();
+            if (!op || !op.getLazy().hasOneBlock()) {
+                return false;
+            }
+
+            auto &block = op.getLazy().front();
+            if (block.empty() || !mlir::isa< hl::ValueYieldOp >(block.back())) {
+                return false;
+            }
+
+            return block.getOperations().size() <= eager_budget + 1
+                && llvm::all_of(block, [] (auto &op) { return is_speculatable(&op); });
+        }
+
         template< typename Op >
         struct lazy_base : operation_conversion_pattern< Op >, llvm_pattern_utils
         {
             using base = operation_conversion_pattern< Op >;
             using base::base;
 
+            using llvm_pattern_utils::iN;
+            using llvm_pattern_utils::fN;
+            using llvm_pattern_utils::null_ptr;
+
+            // Evaluates the lazy region in place of `lazy_op`.
+            auto lazy_inline(Operation* lazy_op, conversion_rewriter &rewriter) const
+            {
+                auto &block = dyn_cast< core::LazyOp >(*lazy_op).getLazy().front();
+
+                auto &yield = block.back();
+                auto res = dyn_cast< hl::ValueYieldOp >(yield).getResult();
+                rewriter.eraseOp(&yield);
+
+                rewriter.inlineBlockBefore(&block, lazy_op, std::nullopt);
+                rewriter.eraseOp(lazy_op);
+
+                return res;
+            }
+
+            mlir_value to_bool(conversion_rewriter &rewriter, auto loc, mlir_value value) const
+            {
+                auto type = value.getType();
+                if (mlir::isa< LLVM::LLVMPointerType >(type)) {
+                    return rewriter.create< LLVM::ICmpOp >(
+                        loc, LLVM::ICmpPredicate::ne, value, null_ptr(rewriter, loc, type)
+                    );
+                }
+
+                if (mlir::isa< mlir::FloatType >(type)) {
+                    return rewriter.create< LLVM::FCmpOp >(
+                        loc, LLVM::FCmpPredicate::une, value, fN(rewriter, loc, type, 0.0)
+                    );
+                }
+
+                return rewriter.create< LLVM::ICmpOp >(
+                    loc, LLVM::ICmpPredicate::ne, value, iN(rewriter, loc, type, 0)
+                );
+            }
+
             auto lazy_into_block(
                 Operation* lazy_op, Block* target, conversion_rewriter &rewriter) const
             {
@@ -66,6 +144,7 @@ namespace vast
             using base::base;
             using adaptor_t = typename LOp::Adaptor;
             using base::lazy_into_block;
+            using base::lazy_inline;
             using base::iN;
 
             void cond_br_lhs(
@@ -78,9 +157,39 @@ namespace vast
                 }
             }
 
+            // Both sides are evaluated and combined by a select, which unlike
+            // a bitwise operation does not propagate poison of the right side,
+            // e.g., of an `add nsw`, when the left side decides the result.
+            logical_result eager(LOp op, adaptor_t ops, conversion_rewriter &rewriter) const
+            {
+                auto lhs_res = lazy_inline(ops.getLhs().getDefiningOp(), rewriter);
+                auto rhs_res = lazy_inline(ops.getRhs().getDefiningOp(), rewriter);
+
+                auto lhs = this->to_bool(rewriter, op.getLoc(), lhs_res);
+                auto rhs = this->to_bool(rewriter, op.getLoc(), rhs_res);
+
+                auto i1  = rewriter.getI1Type();
+                auto res = [&] () -> mlir_value {
+                    if constexpr (short_on_true) {
+                        auto t = iN(rewriter, op.getLoc(), i1, 1);
+                        return rewriter.create< LLVM::SelectOp >(op.getLoc(), lhs, t, rhs);
+                    } else {
+                        auto f = iN(rewriter, op.getLoc(), i1, 0);
+                        return rewriter.create< LLVM::SelectOp >(op.getLoc(), lhs, rhs, f);
+                    }
+                } ();
+
+                rewriter.replaceOpWithNewOp< LLVM::ZExtOp >(op, op.getResult().getType(), res);
+                return logical_result::success();
+            }
+
             logical_result matchAndRewrite(
                 LOp op, adaptor_t ops, conversion_rewriter &rewriter) const override
             {
+                if (is_eager(ops.getLhs()) && is_eager(ops.getRhs())) {
+                    return eager(op, ops, rewriter);
+                }
+
                 /* Splitting the block at the place of the logical operation.
                  * It is divided into 3 parts:
                  *   1) the operations that happen before the logical operation, to this
@@ -127,9 +236,69 @@ namespace vast
             }
         };
 
+        //
+        // Lowers the conditional operator. Speculatable sides are evaluated
+        // both and chosen by `llvm.select`, otherwise the condition branches
+        // to the evaluation of one of them.
+        //
+        struct select_op : lazy_base< core::SelectOp >
+        {
+            using base = lazy_base< core::SelectOp >;
+            using base::base;
+            using adaptor_t = typename core::SelectOp::Adaptor;
+            using base::lazy_into_block;
+            using base::lazy_inline;
+
+            logical_result matchAndRewrite(
+                core::SelectOp op, adaptor_t ops, conversion_rewriter &rewriter) const override
+            {
+                VAST_PATTERN_CHECK(op.getNumResults() == 1, "Unsupported void select: {0}", op);
+
+                auto then_lazy = ops.getThenRegion().getDefiningOp< core::LazyOp >();
+                auto else_lazy = ops.getElseRegion().getDefiningOp< core::LazyOp >();
+                VAST_PATTERN_CHECK(then_lazy && else_lazy, "Select of non-lazy values: {0}", op);
+
+                auto cond = this->to_bool(rewriter, op.getLoc(), ops.getCond());
+
+                if (is_eager(then_lazy.getResult()) && is_eager(else_lazy.getResult())) {
+                    auto then_res = lazy_inline(then_lazy, rewriter);
+                    auto else_res = lazy_inline(else_lazy, rewriter);
+                    rewriter.replaceOpWithNewOp< LLVM::SelectOp >(op, cond, then_res, else_res);
+                    return logical_result::success();
+                }
+
+                auto curr_block = op->getBlock();
+                auto then_block = curr_block->splitBlock(op);
+                auto else_block = then_block->splitBlock(op);
+                auto end_block  = else_block->splitBlock(op);
+
+                auto then_res = lazy_into_block(then_lazy, then_block, rewriter);
+                auto else_res = lazy_into_block(else_lazy, else_block, rewriter);
+
+                auto end_arg = end_block->addArgument(op.getResult(0).getType(), op.getLoc());
+
+                rewriter.setInsertionPointToEnd(curr_block);
+                rewriter.create< LLVM::CondBrOp >(
+                    op.getLoc(), cond, then_block, std::nullopt, else_block, std::nullopt
+                );
+
+                // Sides may have been lowered to multiple blocks already, the
+                // branch to the end is inserted to the last one of each.
+                rewriter.setInsertionPointToEnd(&*std::prev(else_block->getIterator()));
+                rewriter.create< LLVM::BrOp >(op.getLoc(), then_res, end_block);
+
+                rewriter.setInsertionPointToEnd(&*std::prev(end_block->getIterator()));
+                rewriter.create< LLVM::BrOp >(op.getLoc(), else_res, end_block);
+
+                rewriter.replaceOp(op, end_arg);
+                return logical_result::success();
+            }
+        };
+
         using bin_lop_conversions = util::type_list<
             lazy_bin_logical< core::BinLAndOp, false >,
-            lazy_bin_logical< core::BinLOrOp, true >
+            lazy_bin_logical< core::BinLOrOp, true >,
+            select_op
         >;
 
     } //namespace pattern
@@ -0,0 +1,304 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include <llvm/ADT/APSInt.h>
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    //
+    // Matching of counted `hl.for` loops shared by the conversions that raise
+    // them to loop operations of other dialects.
+    //
+    namespace loops
+    {
+        using hl::constant_int;
+        using hl::is_load;
+
+        // Declaration loaded by `value`, i.e., `value` is a load of a reference
+        // to a variable or a parameter.
+        static inline mlir_value loaded_decl(mlir_value value) {
+            auto load = value.getDefiningOp();
+            if (!load || !is_load(load)) {
+                return {};
+            }
+
+            auto ref = load->getOperand(0).getDefiningOp< hl::DeclRefOp >();
+            return ref ? ref.getDecl() : mlir_value();
+        }
+
+        // The reference is only loaded or assigned to, i.e., its address does
+        // not escape.
+        static inline bool is_loaded_or_assigned(operation ref) {
+            return llvm::all_of(ref->getUsers(), [&] (operation user) {
+                if (auto assign = mlir::dyn_cast< hl::AssignOp >(user)) {
+                    return assign.getDst() == ref->getResult(0);
+                }
+                return is_load(user);
+            });
+        }
+
+        // Every reference to `decl` is only loaded.
+        static inline bool is_read_only(mlir_value decl) {
+            return llvm::all_of(decl.getUsers(), [] (operation user) {
+                auto ref = mlir::dyn_cast< hl::DeclRefOp >(user);
+                return ref && llvm::all_of(ref->getUsers(), is_load);
+            });
+        }
+
+        static inline mlir_value load(Builder &bld, Location loc, mlir_value decl) {
+            auto lvalue = mlir::cast< hl::LValueType >(decl.getType());
+            auto ref = bld.create< hl::DeclRefOp >(loc, lvalue, decl);
+            return bld.create< hl::ImplicitCastOp >(
+                loc, lvalue.getElementType(), ref, hl::CastKind::LValueToRValue
+            );
+        }
+
+        // The jump leaves the loop, i.e., it does not target a statement nested
+        // in the loop.
+        template< typename... targets_t >
+        static inline bool leaves(operation jump, operation loop) {
+            for (auto parent = jump->getParentOp(); parent != loop; parent = parent->getParentOp()) {
+                if (mlir::isa< targets_t... >(parent)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //
+        // A counted loop of the form
+        //
+        //   for (...; i < bound; ++i | i++ | i += step) body
+        //
+        // where `i` is a local integer variable that is not written by the body
+        // and not used after the loop, `bound` is a constant or a variable that
+        // is never written, and `step` is a positive constant. The body is left
+        // only at its end.
+        //
+        struct counted_loop
+        {
+            hl::ForOp op;
+            hl::VarDeclOp iv;
+            mlir_value bound;
+            std::uint64_t step = 1;
+
+            static std::optional< counted_loop > match(hl::ForOp op) {
+                counted_loop loop{ op, {}, {} };
+                if (!loop.match_cond() || !loop.match_incr() || !loop.match_body()) {
+                    return std::nullopt;
+                }
+                return loop;
+            }
+
+            mlir_type iv_type() const {
+                return mlir::cast< hl::LValueType >(iv.getType()).getElementType();
+            }
+
+            bool match_cond() {
+                auto &region = op.getCondRegion();
+                if (!region.hasOneBlock()) {
+                    return false;
+                }
+
+                auto &block = region.front();
+                auto yield = mlir::dyn_cast< hl::CondYieldOp >(block.back());
+                if (!yield) {
+                    return false;
+                }
+
+                auto cmp = yield.getResult().getDefiningOp< hl::CmpOp >();
+                if (!cmp || cmp.getPredicate() != hl::Predicate::slt) {
+                    return false;
+                }
+
+                auto var = loaded_decl(cmp.getLhs());
+                iv = var ? var.getDefiningOp< hl::VarDeclOp >() : hl::VarDeclOp();
+                if (!iv || !mlir::isa< mlir::IntegerType >(iv_type())) {
+                    return false;
+                }
+
+                bound = cmp.getRhs();
+                if (bound.getType() != iv_type()) {
+                    return false;
+                }
+
+                // The condition consists of the loads, the comparison and the
+                // yield, or of a constant bound instead of its load.
+                if (constant_int(bound)) {
+                    return block.getOperations().size() == 5;
+                }
+
+                auto decl = loaded_decl(bound);
+                return decl && decl != iv.getResult() && is_read_only(decl)
+                    && block.getOperations().size() == 6;
+            }
+
+            bool match_incr() {
+                auto &region = op.getIncrRegion();
+                if (!region.hasOneBlock()) {
+                    return false;
+                }
+
+                std::size_t updates = 0;
+                for (auto &inner : region.front()) {
+                    if (auto ref = mlir::dyn_cast< hl::DeclRefOp >(inner)) {
+                        if (ref.getDecl() != iv.getResult()) {
+                            return false;
+                        }
+                    } else if (mlir::isa< hl::PreIncOp, hl::PostIncOp >(inner)) {
+                        ++updates;
+                    } else if (auto add = mlir::dyn_cast< hl::AddIAssignOp >(inner)) {
+                        auto value = constant_int(add.getSrc());
+                        if (!value || !value->isStrictlyPositive()) {
+                            return false;
+                        }
+                        step = value->getZExtValue();
+                        ++updates;
+                    } else if (!mlir::isa< hl::ConstantOp >(inner)) {
+                        return false;
+                    }
+                }
+
+                return updates == 1;
+            }
+
+            bool match_body() {
+                if (!op.getBodyRegion().hasOneBlock()) {
+                    return false;
+                }
+
+                auto escapes = op.getBodyRegion().walk([&] (operation inner) {
+                    if (mlir::isa< hl::ReturnOp, hl::GotoStmt, hl::IndirectGotoStmt, hl::LabelStmt >(inner)) {
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    if (mlir::isa< hl::BreakOp >(inner)
+                        && leaves< hl::ForOp, hl::WhileOp, hl::DoOp, hl::SwitchOp >(inner, op)
+                    ) {
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    if (mlir::isa< hl::ContinueOp >(inner)
+                        && leaves< hl::ForOp, hl::WhileOp, hl::DoOp >(inner, op)
+                    ) {
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    return mlir::WalkResult::advance();
+                });
+
+                if (escapes.wasInterrupted()) {
+                    return false;
+                }
+
+                return uses_of_iv_are_raisable();
+            }
+
+            // The variable is read only in the body and it is dead after the
+            // loop, so it is enough to store the induction variable to it at
+            // the start of each iteration. References before the loop may only
+            // load or assign the variable, an escaped address could be written
+            // through in the body.
+            bool uses_of_iv_are_raisable() const {
+                auto &incr = op.getIncrRegion();
+                return llvm::all_of(iv->getUsers(), [&] (operation user) {
+                    auto ref = mlir::dyn_cast< hl::DeclRefOp >(user);
+                    if (!ref) {
+                        return false;
+                    }
+
+                    if (incr.isAncestor(ref->getParentRegion())) {
+                        return true;
+                    }
+
+                    if (op->isAncestor(ref)) {
+                        return llvm::all_of(ref->getUsers(), is_load);
+                    }
+
+                    auto point = op->getBlock()->findAncestorOpInBlock(*ref);
+                    return point && point->isBeforeInBlock(op) && is_loaded_or_assigned(ref);
+                });
+            }
+
+            // Loop operations of other dialects take signless integers, the
+            // lowered types of hl are signed. Values pass between them through
+            // casts, which the lowering reconciles once both are llvm integers.
+            mlir_type signless_type() const {
+                auto type = mlir::cast< mlir::IntegerType >(iv_type());
+                return mlir::IntegerType::get(type.getContext(), type.getWidth());
+            }
+
+            mlir_value cast(Builder &bld, mlir_value value, mlir_type type) const {
+                if (value.getType() == type) {
+                    return value;
+                }
+                return bld.create< mlir::UnrealizedConversionCastOp >(op.getLoc(), type, value)
+                    .getResult(0);
+            }
+
+            mlir_value to_signless(Builder &bld, mlir_value value) const {
+                return cast(bld, value, signless_type());
+            }
+
+            // Bounds and step of the raised loop, they are materialized before the
+            // loop as signless integers. The lower bound is the value of the
+            // variable after the initialization.
+            mlir_value lower_bound(Builder &bld) const {
+                return to_signless(bld, load(bld, op.getLoc(), iv.getResult()));
+            }
+
+            mlir_value upper_bound(Builder &bld) const {
+                if (auto decl = loaded_decl(bound)) {
+                    return to_signless(bld, load(bld, op.getLoc(), decl));
+                }
+                return to_signless(bld, bld.clone(*bound.getDefiningOp())->getResult(0));
+            }
+
+            mlir_value step_value(Builder &bld) const {
+                return constant(bld, llvm::APInt(signless_width(), step));
+            }
+
+            // Constant of the loop, e.g., a chunk of a schedule, as a signless
+            // integer.
+            mlir_value constant(Builder &bld, const llvm::APInt &value) const {
+                auto type = mlir::cast< mlir::IntegerType >(iv_type());
+                auto cst  = bld.create< hl::ConstantOp >(
+                    op.getLoc(), type, llvm::APSInt(value.zextOrTrunc(type.getWidth()), false)
+                );
+                return to_signless(bld, cst);
+            }
+
+            unsigned signless_width() const {
+                return mlir::cast< mlir::IntegerType >(iv_type()).getWidth();
+            }
+
+            // Moves the body to `block` before `point`, preceded by the store of
+            // the signless induction variable `value` to the loop variable.
+            void move_body(mlir::Block *block, mlir::Block::iterator point, mlir_value value) {
+                Builder bld(block, point);
+                auto ref = bld.create< hl::DeclRefOp >(op.getLoc(), iv.getType(), iv.getResult());
+                bld.create< hl::AssignOp >(op.getLoc(), ref, cast(bld, value, iv_type()));
+
+                block->getOperations().splice(point, op.getBodyRegion().front().getOperations());
+            }
+        };
+
+    } // namespace loops
+
+} // namespace vast::conv
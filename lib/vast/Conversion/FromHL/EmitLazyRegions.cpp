@@ -124,6 +124,21 @@ namespace vast
         cond_op
     >;
 
+    namespace conv
+    {
+        void legalize_hl_emit_lazy_regions(conversion_target &target) {
+            target.addLegalDialect< vast::core::CoreDialect >();
+            legalize_patterns< bin_lop_conversions >(target);
+        }
+
+        void populate_hl_emit_lazy_regions(
+            mlir::RewritePatternSet &patterns, conversion_target &target
+        ) {
+            target.addLegalDialect< vast::core::CoreDialect >();
+            add_patterns< bin_lop_conversions >(patterns, target);
+        }
+    } // namespace conv
+
     struct HLEmitLazyRegionsPass
         : ModuleConversionPassMixin< HLEmitLazyRegionsPass, HLEmitLazyRegionsBase >
     {
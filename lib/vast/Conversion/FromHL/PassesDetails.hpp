@@ -4,3 +4,66 @@
 
 // TODO(conv): Provide tablegen file for each category of conversions separately.
 #include "../PassesDetails.hpp"
+
+#include "vast/Conversion/Common/Patterns.hpp"
+#include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+
+namespace vast::conv
+{
+    template< typename list >
+    void add_patterns(mlir::RewritePatternSet &patterns, conversion_target &target) {
+        if constexpr ( !list::empty ) {
+            using pattern = typename list::head;
+            patterns.add< pattern >(patterns.getContext());
+            if constexpr ( has_legalize< pattern > )
+                pattern::legalize(target);
+            add_patterns< typename list::tail >(patterns, target);
+        }
+    }
+
+    template< typename list >
+    void legalize_patterns(conversion_target &target) {
+        if constexpr ( !list::empty ) {
+            using pattern = typename list::head;
+            if constexpr ( has_legalize< pattern > )
+                pattern::legalize(target);
+            legalize_patterns< typename list::tail >(target);
+        }
+    }
+
+    // Patterns and legality of the individual hl to ll conversions, which the
+    // fused `vast-hl-to-ll` pass applies together.
+    void populate_hl_to_ll_func(mlir::RewritePatternSet &patterns, conversion_target &target);
+
+    void populate_hl_to_ll_vars(
+        mlir::RewritePatternSet &patterns, conversion_target &target,
+        tc::LLVMTypeConverter &type_converter
+    );
+
+    // Loops are rotated with `rotate_loops`, see `vast-hl-to-ll-cf`.
+    void populate_hl_to_ll_cf(
+        mlir::RewritePatternSet &patterns, conversion_target &target, bool rotate_loops = false
+    );
+
+    void populate_hl_emit_lazy_regions(mlir::RewritePatternSet &patterns, conversion_target &target);
+
+    // Uses `records` to resolve member indices if available.
+    void populate_hl_to_ll_geps(
+        mlir::RewritePatternSet &patterns, conversion_target &target,
+        const hl::record_index *records = nullptr
+    );
+
+    // Legality of the conversions alone, the operations they make illegal are
+    // the ones they convert. The fused pass leaves out conversions without any
+    // such operation in the function.
+    void legalize_hl_to_ll_func(conversion_target &target);
+    void legalize_hl_to_ll_vars(conversion_target &target);
+    void legalize_hl_to_ll_cf(conversion_target &target);
+    void legalize_hl_emit_lazy_regions(conversion_target &target);
+    void legalize_hl_to_ll_geps(conversion_target &target);
+
+    // Removes blocks the control flow conversion left unreachable.
+    void cleanup_hl_to_ll_cf(operation op);
+
+} // namespace vast::conv
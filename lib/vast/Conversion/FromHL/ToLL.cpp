@@ -0,0 +1,98 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
+#include <mlir/Transforms/DialectConversion.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Util/Analysis.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/DialectConversion.hpp"
+
+namespace vast::conv
+{
+    //
+    // Applies patterns of all hl to ll conversions in a single dialect conversion,
+    // instead of a walk and legality check per conversion. Conversions without
+    // an operation to convert in the function are left out, and so is the
+    // whole dialect conversion if none of them applies.
+    //
+    struct HLToLL : HLToLLBase< HLToLL >
+    {
+        HLToLL() = default;
+
+        explicit HLToLL(bool rotate_loops) {
+            this->rotate_loops = rotate_loops;
+        }
+
+        void runOnOperation() override
+        {
+            auto op = this->getOperation();
+            auto &mctx = this->getContext();
+
+            util::op_kinds kinds(op);
+            auto applies = [&] (auto legalize) {
+                conversion_target illegal(mctx);
+                legalize(illegal);
+                return kinds.has_illegal(illegal);
+            };
+
+            bool func  = applies(legalize_hl_to_ll_func);
+            bool vars  = applies(legalize_hl_to_ll_vars);
+            bool cf    = applies(legalize_hl_to_ll_cf);
+            bool lazy  = applies(legalize_hl_emit_lazy_regions);
+            bool geps  = applies(legalize_hl_to_ll_geps);
+
+            if (!func && !vars && !cf && !lazy && !geps)
+                return markAllAnalysesPreserved();
+
+            conversion_target trg(mctx);
+            trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
+
+            auto dl_module = get_module_analysis< data_layout_analysis >(op, getAnalysisManager());
+            const auto &dl_analysis = dl_module
+                ? dl_module->get() : this->getAnalysis< mlir::DataLayoutAnalysis >();
+
+            mlir::LowerToLLVMOptions llvm_options(&mctx);
+            llvm_options.useBarePtrCallConv = true;
+            tc::LLVMTypeConverter type_converter(&mctx, llvm_options, &dl_analysis);
+            type_converter.use_cache(tc::get_conversion_cache(op, getAnalysisManager()));
+
+            mlir::RewritePatternSet patterns(&mctx);
+            if (func)
+                populate_hl_to_ll_func(patterns, trg);
+            if (vars)
+                populate_hl_to_ll_vars(patterns, trg, type_converter);
+            if (cf)
+                populate_hl_to_ll_cf(patterns, trg, rotate_loops);
+            if (lazy)
+                populate_hl_emit_lazy_regions(patterns, trg);
+            if (geps) {
+                populate_hl_to_ll_geps(
+                    patterns, trg, get_module_analysis< hl::record_index >(op, getAnalysisManager())
+                );
+            }
+
+            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
+                return signalPassFailure();
+
+            if (cf)
+                cleanup_hl_to_ll_cf(op);
+        }
+    };
+
+} // namespace vast::conv
+
+std::unique_ptr< mlir::Pass > vast::createHLToLLPass()
+{
+    return std::make_unique< vast::conv::HLToLL >();
+}
+
+std::unique_ptr< mlir::Pass > vast::createHLToLLPass(bool rotate_loops)
+{
+    return std::make_unique< vast::conv::HLToLL >(rotate_loops);
+}
@@ -17,6 +17,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/Remarks.hpp"
 #include "vast/Util/Terminator.hpp"
 #include "vast/Util/TypeList.hpp"
 
@@ -24,11 +25,15 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Rewriter.hpp"
 
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
 #include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
-#include "../PassesDetails.hpp"
+#include "PassesDetails.hpp"
 
 namespace vast::conv
 {
@@ -36,6 +41,9 @@ namespace vast::conv
     {
         static inline const char *tie_fail = "base_pattern::tie failed.";
 
+        // Patterns report remarks in the name of the pass.
+        constexpr llvm::StringLiteral pass_name = "vast-hl-to-ll-cf";
+
         auto coerce_condition(auto op, conversion_rewriter &rewriter)
             -> std::optional< mlir::Value >
         {
@@ -47,6 +55,14 @@ namespace vast::conv
             if (int_type == i1)
                 return { op };
 
+            // A comparison that only feeds the condition yields `i1` itself,
+            // rather than an integer compared against zero again.
+            auto def = op.getDefiningOp();
+            if (def && mlir::isa< hl::CmpOp, hl::FCmpOp >(def) && op.hasOneUse()) {
+                rewriter.updateRootInPlace(def, [&] { op.setType(i1); });
+                return { op };
+            }
+
             auto coerced = rewriter.create< hl::ImplicitCastOp >(
                 op.getLoc(), i1, op, hl::CastKind::IntegralCast);
             return { coerced };
@@ -125,10 +141,22 @@ namespace vast::conv
             mlir::Block *entry;
             mlir::Block *exit;
 
+            // Whether `break`/`continue` belong to the handled operation. A
+            // `hl.switch` owns breaks of its body, but not continues.
+            bool breaks    = true;
+            bool continues = true;
+
             handle_terminators( bld_t &bld, mlir::Block *entry, mlir::Block *exit )
                 : bld( bld ), entry( entry ), exit( exit )
             {}
 
+            static handle_terminators for_switch( bld_t &bld )
+            {
+                auto out = handle_terminators( bld, nullptr, nullptr );
+                out.continues = false;
+                return out;
+            }
+
             result_t run( mlir::Region &region )
             {
                 // Go instructions by instruction.
@@ -154,12 +182,30 @@ namespace vast::conv
                 if ( starts_cf_scope( op ) )
                     return mlir::success();
 
+                if ( mlir::isa< hl::SwitchOp >( op ) )
+                    return run_in_switch( op );
+
                 for ( auto &region : op->getRegions() )
                     if ( mlir::failed( run( region ) ) )
                         return mlir::failure();
                 return mlir::success();
             }
 
+            // Breaks of a nested switch are left to the switch itself, continues
+            // still refer to the enclosing loop.
+            result_t run_in_switch( mlir::Operation *op )
+            {
+                if ( !continues )
+                    return mlir::success();
+
+                auto nested = *this;
+                nested.breaks = false;
+                for ( auto &region : op->getRegions() )
+                    if ( mlir::failed( nested.run( region ) ) )
+                        return mlir::failure();
+                return mlir::success();
+            }
+
             bool starts_cf_scope( mlir::Operation *op )
             {
                 // TODO( conv:hltollcf ): Define & use some trait instead.
@@ -170,6 +216,9 @@ namespace vast::conv
             // TODO( conv:hltollcf ): Refactor using wrapper once we have it finalized.
             maybe_op_t do_replace( hl::ContinueOp op )
             {
+                if ( !continues )
+                    return {};
+
                 auto g = mlir::OpBuilder::InsertionGuard( bld );
                 bld.setInsertionPointAfter( op );
                 if ( entry )
@@ -186,6 +235,9 @@ namespace vast::conv
 
             maybe_op_t do_replace( hl::BreakOp op )
             {
+                if ( !breaks )
+                    return {};
+
                 auto g = mlir::OpBuilder::InsertionGuard( bld );
                 bld.setInsertionPointAfter( op );
                 if ( exit )
@@ -241,6 +293,90 @@ namespace vast::conv
 
                 return std::make_tuple( cond_yield, value );
             }
+
+            static void forward_attr( operation from, operation to, llvm::StringRef name )
+            {
+                if ( auto attr = from->getAttr( name ) )
+                    to->setAttr( name, attr );
+            }
+
+            // Keeps the expected outcome of the condition and its profile
+            // weights for branch weights.
+            static void forward_likelihood( operation from, operation to )
+            {
+                forward_attr( from, to, hl::BranchLikelihoodAttr::attr_name() );
+                forward_attr( from, to, hl::BranchWeightsAttr::attr_name() );
+            }
+
+            // Loop metadata belongs to the backedge, that is the branch from
+            // `latch` to the loop `header`.
+            static void forward_loop_hints( operation loop, mlir::Block &latch,
+                                            mlir::Block &header )
+            {
+                if ( latch.empty() )
+                    return;
+
+                auto br = mlir::dyn_cast< ll::Br >( latch.back() );
+                if ( br && br.getDest() == &header )
+                    forward_attr( loop, br, hl::LoopHintsAttr::attr_name() );
+            }
+        };
+
+        //
+        // Loops are lowered to a header that tests the condition on every
+        // iteration and a back edge to it from the end of the body:
+        //
+        //   entry -> cond -> body -> cond
+        //
+        // A rotated loop tests a copy of the condition once to enter the loop,
+        // and the condition again at the end of each iteration, where the back
+        // edge is the conditional branch of the latch:
+        //
+        //   entry -> guard -> body -> latch -> body
+        //
+        // That saves a branch per iteration without loop rotation of llvm,
+        // e.g., at -O0, at the cost of a copy of the condition.
+        //
+        template< typename op_t >
+        struct loop_pattern : base_pattern< op_t >
+        {
+            using parent_t = base_pattern< op_t >;
+
+            loop_pattern( mcontext_t *mctx, bool rotate = false )
+                : parent_t( mctx ), rotate( rotate )
+            {}
+
+            // Copy of the condition region at the end of the scope.
+            static mlir::Block *clone_region( conversion_rewriter &rewriter,
+                                              mlir::Region &region, mlir::Region &dest )
+            {
+                VAST_CHECK( region.hasOneBlock(), "Region has more than one block" );
+                rewriter.cloneRegionBefore( region, dest, dest.end() );
+                return &dest.back();
+            }
+
+            // Ends `cond_block` by a branch to `body_block` if the condition
+            // holds, leaving the scope otherwise.
+            static logical_result exit_unless( auto &bld, conversion_rewriter &rewriter,
+                                               op_t op, mlir::Block &cond_block,
+                                               mlir::Block &body_block,
+                                               bool backedge = false )
+            {
+                auto [ cond_yield, value ] = parent_t::fetch_cond_yield( bld, cond_block );
+                if ( !value )
+                    return mlir::failure();
+
+                auto ret = bld.template make_at_end< ll::CondScopeRet >( &cond_block,
+                                                                         op.getLoc(), *value,
+                                                                         &body_block );
+                parent_t::forward_likelihood( op, ret );
+                if ( backedge )
+                    parent_t::forward_attr( op, ret, hl::LoopHintsAttr::attr_name() );
+                rewriter.eraseOp( cond_yield );
+                return mlir::success();
+            }
+
+            bool rotate;
         };
 
         struct if_op : base_pattern< hl::IfOp >
@@ -273,9 +409,10 @@ namespace vast::conv
                 auto true_block = inline_region_before( rewriter,
                                                         op.getThenRegion(), tail_block );
 
-                bld.make_at_end< ll::CondBr >( cond_block,
-                                               op.getLoc(), cond_value,
-                                               true_block, false_block );
+                auto br = bld.make_at_end< ll::CondBr >( cond_block,
+                                                         op.getLoc(), cond_value,
+                                                         true_block, false_block );
+                parent_t::forward_likelihood( op, br );
                 rewriter.eraseOp( cond_yield_op );
 
 
@@ -315,9 +452,9 @@ namespace vast::conv
 
         };
 
-        struct while_op : base_pattern< hl::WhileOp >
+        struct while_op : loop_pattern< hl::WhileOp >
         {
-            using parent_t = base_pattern< hl::WhileOp >;
+            using parent_t = loop_pattern< hl::WhileOp >;
             using parent_t::parent_t;
 
             mlir::LogicalResult matchAndRewrite(
@@ -325,6 +462,9 @@ namespace vast::conv
                 hl::WhileOp::Adaptor ops,
                 conversion_rewriter &rewriter) const override
             {
+                if ( rotate )
+                    return rewrite_rotated( op, rewriter );
+
                 auto bld = rewriter_wrapper_t( rewriter );
 
                 auto scope = rewriter.create< ll::Scope >( op.getLoc() );
@@ -340,23 +480,67 @@ namespace vast::conv
                     return mlir::failure();
                 }
 
-                auto body_block = inline_region( rewriter,
-                                                 body_region, scope.getBody() );
-
                 // Condition block cannot be entry because entry block cannot have
-                // predecessors and body block will jump to it.
+                // predecessors and body block will jump to it. It is the start
+                // block of the scope, where `continue` jumps.
                 auto cond_block = inline_region( rewriter, cond_region, scope.getBody() );
 
+                auto body_block = inline_region( rewriter,
+                                                 body_region, scope.getBody() );
+
                 auto [ cond_yield, value ] = fetch_cond_yield( bld, *cond_block );
                 VAST_CHECK( value, "Condition region yield unexpected type" );
 
-                bld.make_at_end< ll::CondScopeRet >( cond_block,
-                                                     op.getLoc(), *value, body_block );
+                auto ret = bld.make_at_end< ll::CondScopeRet >( cond_block,
+                                                                op.getLoc(), *value,
+                                                                body_block );
+                parent_t::forward_likelihood( op, ret );
                 rewriter.eraseOp( cond_yield );
 
                 VAST_PATTERN_CHECK(parent_t::tie( bld, op.getLoc(),
                                                    *scope_entry, *cond_block ),
                                    tie_fail);
+                VAST_PATTERN_CHECK(parent_t::tie( bld, op.getLoc(),
+                                                   *body_block, *cond_block ),
+                                   tie_fail);
+                parent_t::forward_loop_hints( op, *body_block, *cond_block );
+
+                rewriter.eraseOp( op );
+                return mlir::success();
+            }
+
+            // `continue` jumps to the latch, which tests the condition again.
+            mlir::LogicalResult rewrite_rotated( hl::WhileOp op,
+                                                 conversion_rewriter &rewriter ) const
+            {
+                auto bld = rewriter_wrapper_t( rewriter );
+
+                auto scope = rewriter.create< ll::Scope >( op.getLoc() );
+                auto scope_entry = rewriter.createBlock( &scope.getBody() );
+
+                auto guard_block = clone_region( rewriter, op.getCondRegion(), scope.getBody() );
+                auto body_block  = inline_region( rewriter, op.getBodyRegion(), scope.getBody() );
+                auto latch_block = inline_region( rewriter, op.getCondRegion(), scope.getBody() );
+
+                if ( mlir::failed( handle_terminators( rewriter,
+                                                       latch_block,
+                                                       nullptr ).run( *body_block ) ) )
+                {
+                    return mlir::failure();
+                }
+
+                VAST_PATTERN_CHECK( exit_unless( bld, rewriter, op, *guard_block, *body_block ),
+                                    "Condition region yield unexpected type" );
+                VAST_PATTERN_CHECK( exit_unless( bld, rewriter, op, *latch_block, *body_block,
+                                                 /* backedge */ true ),
+                                    "Condition region yield unexpected type" );
+
+                VAST_PATTERN_CHECK(parent_t::tie( bld, op.getLoc(),
+                                                   *scope_entry, *guard_block ),
+                                   tie_fail);
+                VAST_PATTERN_CHECK(parent_t::tie( bld, op.getLoc(),
+                                                   *body_block, *latch_block ),
+                                   tie_fail);
 
                 rewriter.eraseOp( op );
                 return mlir::success();
@@ -368,10 +552,10 @@ namespace vast::conv
             }
         };
 
-        struct for_op : base_pattern< hl::ForOp >
+        struct for_op : loop_pattern< hl::ForOp >
         {
             using op_t = hl::ForOp;
-            using parent_t = base_pattern< op_t >;
+            using parent_t = loop_pattern< op_t >;
             using parent_t::parent_t;
 
             mlir::LogicalResult matchAndRewrite(
@@ -379,6 +563,9 @@ namespace vast::conv
                 typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
             {
+                if ( rotate )
+                    return rewrite_rotated( op, rewriter );
+
                 auto bld = rewriter_wrapper_t( rewriter );
                 auto scope = rewriter.create< ll::Scope >( op.getLoc() );
                 auto scope_entry = rewriter.createBlock( &scope.getBody() );
@@ -404,8 +591,10 @@ namespace vast::conv
                 auto [ cond_yield, value ] = fetch_cond_yield( bld, *cond_block );
                 VAST_PATTERN_CHECK( value, "Condition region yield unexpected type" );
 
-                bld.make_at_end< ll::CondScopeRet >( cond_block,
-                                                     op.getLoc(), *value, body_block );
+                auto ret = bld.make_at_end< ll::CondScopeRet >( cond_block,
+                                                                op.getLoc(), *value,
+                                                                body_block );
+                parent_t::forward_likelihood( op, ret );
                 rewriter.eraseOp( cond_yield );
 
                 auto mk_tie = [ & ]( auto &from, auto &to )
@@ -416,18 +605,360 @@ namespace vast::conv
                 VAST_PATTERN_CHECK( mk_tie( *scope_entry, *cond_block ), tie_fail );
                 VAST_PATTERN_CHECK( mk_tie( *body_block, *inc_block ), tie_fail );
                 VAST_PATTERN_CHECK( mk_tie( *inc_block, *cond_block ), tie_fail );
+                parent_t::forward_loop_hints( op, *inc_block, *cond_block );
 
                 rewriter.eraseOp( op );
 
                 return mlir::success();
             }
 
+            // `continue` jumps to the increment, which is followed by the latch.
+            mlir::LogicalResult rewrite_rotated( op_t op, conversion_rewriter &rewriter ) const
+            {
+                auto bld = rewriter_wrapper_t( rewriter );
+                auto scope = rewriter.create< ll::Scope >( op.getLoc() );
+                auto scope_entry = rewriter.createBlock( &scope.getBody() );
+
+                auto guard_block = clone_region( rewriter, op.getCondRegion(), scope.getBody() );
+                auto body_block  = inline_region( rewriter, op.getBodyRegion(), scope.getBody() );
+                auto inc_block   = inline_region( rewriter, op.getIncrRegion(), scope.getBody() );
+                auto latch_block = inline_region( rewriter, op.getCondRegion(), scope.getBody() );
+
+                if ( mlir::failed( handle_terminators( rewriter,
+                                                       inc_block,
+                                                       nullptr ).run( *body_block ) ) )
+                {
+                    return mlir::failure();
+                }
+
+                VAST_PATTERN_CHECK( exit_unless( bld, rewriter, op, *guard_block, *body_block ),
+                                    "Condition region yield unexpected type" );
+                VAST_PATTERN_CHECK( exit_unless( bld, rewriter, op, *latch_block, *body_block,
+                                                 /* backedge */ true ),
+                                    "Condition region yield unexpected type" );
+
+                auto mk_tie = [ & ]( auto &from, auto &to )
+                {
+                    return parent_t::tie( bld, op.getLoc(), from, to );
+                };
+
+                VAST_PATTERN_CHECK( mk_tie( *scope_entry, *guard_block ), tie_fail );
+                VAST_PATTERN_CHECK( mk_tie( *body_block, *inc_block ), tie_fail );
+                VAST_PATTERN_CHECK( mk_tie( *inc_block, *latch_block ), tie_fail );
+
+                rewriter.eraseOp( op );
+                return mlir::success();
+            }
+
             static void legalize( conversion_target &trg )
             {
                 trg.addIllegalOp< hl::ForOp >();
             }
         };
 
+        //
+        // `hl.switch` is lowered into a scope that dispatches on the condition
+        // with `ll.switch`. Every case label starts a new block and a block that
+        // does not end with a terminator falls through to the following label.
+        // Breaks leave the scope.
+        //
+        // Only labels that directly precede a statement of the switch body,
+        // possibly through other labels, are supported. Case values have to be
+        // integer constants.
+        //
+        struct switch_op : base_pattern< hl::SwitchOp >
+        {
+            using op_t = hl::SwitchOp;
+            using parent_t = base_pattern< op_t >;
+            using parent_t::parent_t;
+
+            struct label_t
+            {
+                operation op;
+                // Empty for `hl.default`.
+                std::optional< llvm::APInt > value;
+            };
+
+            static bool is_label( operation op )
+            {
+                return mlir::isa< hl::CaseOp, hl::DefaultOp >( op );
+            }
+
+            static mlir::Block &label_body( operation op )
+            {
+                if ( auto case_op = mlir::dyn_cast< hl::CaseOp >( op ) )
+                    return case_op.getBody().front();
+                return mlir::cast< hl::DefaultOp >( op ).getBody().front();
+            }
+
+            static std::optional< llvm::APSInt > fold_integer( mlir_value value )
+            {
+                auto def = value.getDefiningOp();
+                if ( !def )
+                    return std::nullopt;
+
+                if ( auto cst = mlir::dyn_cast< hl::ConstantOp >( def ) )
+                {
+                    if ( auto attr = mlir::dyn_cast< core::IntegerAttr >( cst.getValue() ) )
+                        return attr.getValue();
+                    return std::nullopt;
+                }
+
+                auto fold_cast = [] ( auto cast ) -> std::optional< llvm::APSInt >
+                {
+                    auto kind = cast.getKind();
+                    if ( kind != hl::CastKind::IntegralCast && kind != hl::CastKind::NoOp )
+                        return std::nullopt;
+
+                    auto type = mlir::dyn_cast< mlir::IntegerType >( cast.getType() );
+                    auto arg  = fold_integer( cast.getValue() );
+                    if ( !type || !arg )
+                        return std::nullopt;
+                    return arg->extOrTrunc( type.getWidth() );
+                };
+
+                if ( auto cast = mlir::dyn_cast< hl::ImplicitCastOp >( def ) )
+                    return fold_cast( cast );
+                if ( auto cast = mlir::dyn_cast< hl::CStyleCastOp >( def ) )
+                    return fold_cast( cast );
+                return std::nullopt;
+            }
+
+            static std::optional< llvm::APInt > case_value( hl::CaseOp op, unsigned width )
+            {
+                auto &lhs = op.getLhs();
+                if ( !lhs.hasOneBlock() )
+                    return std::nullopt;
+
+                auto yield = terminator_t< hl::ValueYieldOp >::get( lhs.front() );
+                if ( !yield )
+                    return std::nullopt;
+
+                if ( auto value = fold_integer( yield.op().getResult() ) )
+                    return value->extOrTrunc( width );
+                return std::nullopt;
+            }
+
+            // Labels of the switch body in the source order, labels nested in
+            // other labels follow them.
+            static void collect_labels( mlir::Block &block, std::vector< operation > &labels )
+            {
+                for ( auto &op : block )
+                {
+                    if ( !is_label( &op ) )
+                        continue;
+                    labels.push_back( &op );
+                    collect_labels( label_body( &op ), labels );
+                }
+            }
+
+            // Labels nested in other statements of the switch body.
+            static std::size_t count_labels( mlir::Block &block )
+            {
+                std::size_t count = 0;
+                for ( auto &op : block )
+                {
+                    op.walk< mlir::WalkOrder::PreOrder >( [&] ( operation nested ) {
+                        if ( mlir::isa< hl::SwitchOp >( nested ) )
+                            return mlir::WalkResult::skip();
+                        if ( is_label( nested ) )
+                            ++count;
+                        return mlir::WalkResult::advance();
+                    } );
+                }
+                return count;
+            }
+
+            // Statements before the first label are never executed, only
+            // declarations that are visible to the labels may appear there.
+            static bool is_declaration( operation op )
+            {
+                if ( auto var = mlir::dyn_cast< hl::VarDeclOp >( op ) )
+                    return var.getInitializer().empty();
+                return false;
+            }
+
+            // The body of a switch is usually a compound statement, its scope
+            // is subsumed by the scope of the lowered switch.
+            static mlir::Region &body_region( op_t op )
+            {
+                auto &cases = op.getCases().front();
+                auto &block = cases.front();
+                if ( !block.empty() && std::next( block.begin() ) == block.end() )
+                {
+                    if ( auto scope = mlir::dyn_cast< core::ScopeOp >( block.front() ) )
+                        return scope.getBody();
+                }
+                return cases;
+            }
+
+            static logical_result match( op_t op )
+            {
+                auto cases = op.getCases();
+                if ( cases.size() != 1 || !cases.front().hasOneBlock() )
+                    return mlir::failure();
+
+                if ( !op.getCondRegion().hasOneBlock() )
+                    return mlir::failure();
+
+                auto yield = terminator_t< hl::ValueYieldOp >::get( op.getCondRegion().front() );
+                if ( !yield || !mlir::isa< mlir::IntegerType >( yield.op().getResult().getType() ) )
+                    return mlir::failure();
+
+                auto &body = body_region( op );
+                return mlir::success( body.hasOneBlock() );
+            }
+
+            static logical_result missed( op_t op, string_ref reason )
+            {
+                remarks::missed( op, pass_name, "SwitchNotLowered" )
+                    << "switch is not lowered to a dispatch, " << reason;
+                return mlir::failure();
+            }
+
+            mlir::LogicalResult matchAndRewrite(
+                op_t op,
+                typename op_t::Adaptor ops,
+                conversion_rewriter &rewriter) const override
+            {
+                if ( mlir::failed( match( op ) ) )
+                    return missed( op, "its body is not a single block" );
+
+                auto &cond_region = op.getCondRegion();
+                auto cond_yield   = terminator_t< hl::ValueYieldOp >::get( cond_region.front() ).op();
+                auto cond         = cond_yield.getResult();
+                auto width        = mlir::cast< mlir::IntegerType >( cond.getType() ).getWidth();
+
+                auto &body_region = switch_op::body_region( op );
+                auto &body        = body_region.front();
+
+                std::vector< operation > label_ops;
+                collect_labels( body, label_ops );
+                if ( count_labels( body ) != label_ops.size() )
+                    return missed( op, "labels are nested in its statements" );
+
+                for ( auto &stmt : body )
+                {
+                    if ( is_label( &stmt ) )
+                        break;
+                    if ( !is_declaration( &stmt ) )
+                        return missed( op, "statements precede its first label" );
+                }
+
+                std::vector< label_t > labels;
+                for ( auto label : label_ops )
+                {
+                    if ( auto case_op = mlir::dyn_cast< hl::CaseOp >( label ) )
+                    {
+                        auto value = case_value( case_op, width );
+                        if ( !value )
+                            return missed( op, "a case value is not an integer constant" );
+                        labels.push_back( { label, value } );
+                    } else {
+                        labels.push_back( { label, std::nullopt } );
+                    }
+                }
+
+                // `continue` in the body belongs to an enclosing loop, which
+                // has already been lowered.
+                auto terminators = handle_terminators< conversion_rewriter >::for_switch( rewriter );
+                if ( mlir::failed( terminators.run( body_region ) ) )
+                    return mlir::failure();
+
+                auto bld = rewriter_wrapper_t( rewriter );
+                auto loc = op.getLoc();
+
+                auto scope = rewriter.create< ll::Scope >( loc );
+                auto scope_entry = rewriter.createBlock( &scope.getBody() );
+
+                auto cond_block = inline_region( rewriter, cond_region, scope.getBody() );
+                auto body_block = inline_region( rewriter, body_region, scope.getBody() );
+
+                llvm::SmallVector< llvm::APInt > case_values;
+                llvm::SmallVector< mlir::Block * > case_dests;
+                mlir::Block *default_dest = nullptr;
+
+                for ( const auto &label : labels )
+                {
+                    auto from = label.op->getBlock();
+                    auto dest = rewriter.splitBlock( from, mlir::Block::iterator( label.op ) );
+                    // Declarations before the first label do not fall through.
+                    if ( from != body_block )
+                        VAST_PATTERN_CHECK( parent_t::tie( bld, loc, *from, *dest ), tie_fail );
+
+                    // The label stays in front of its statement until it is erased.
+                    rewriter.inlineBlockBefore(
+                        &label_body( label.op ), dest, std::next( dest->begin() )
+                    );
+                    rewriter.eraseOp( label.op );
+
+                    if ( label.value ) {
+                        case_values.push_back( *label.value );
+                        case_dests.push_back( dest );
+                    } else {
+                        default_dest = dest;
+                    }
+                }
+
+                // Falls through the end of the switch.
+                auto &last = scope.getBody().back();
+                if ( &last != body_block && !any_terminator_t::has( last ) )
+                    bld.make_at_end< ll::ScopeRet >( &last, loc );
+
+                // Dispatch after the declarations of the body.
+                rewriter.eraseOp( cond_yield );
+                rewriter.mergeBlocks( body_block, cond_block, std::nullopt );
+
+                if ( !default_dest && !case_dests.empty() )
+                {
+                    default_dest = rewriter.createBlock( &scope.getBody(), scope.getBody().end() );
+                    bld.make_at_end< ll::ScopeRet >( default_dest, loc );
+                }
+
+                if ( case_dests.empty() )
+                {
+                    if ( default_dest )
+                        bld.make_at_end< ll::Br >( cond_block, loc, default_dest );
+                    else
+                        bld.make_at_end< ll::ScopeRet >( cond_block, loc );
+                } else {
+                    auto type   = mlir::VectorType::get(
+                        { static_cast< std::int64_t >( case_values.size() ) }, cond.getType()
+                    );
+                    auto values = mlir::cast< mlir::DenseIntElementsAttr >(
+                        mlir::DenseElementsAttr::get( type, case_values )
+                    );
+                    auto dispatch = bld.make_at_end< ll::Switch >(
+                        cond_block, loc, cond, values, default_dest, case_dests
+                    );
+
+                    // Weights of the default label and of the cases in the
+                    // order of the labels.
+                    auto weights = op->getAttrOfType< hl::BranchWeightsAttr >(
+                        hl::BranchWeightsAttr::attr_name()
+                    );
+                    if ( weights && weights.getWeights().size() == case_dests.size() + 1 )
+                        dispatch->setAttr( hl::BranchWeightsAttr::attr_name(), weights );
+
+                    remarks::passed( op, pass_name, "SwitchLowered" )
+                        << "switch of " << case_values.size() << " cases is lowered to ll.switch";
+                }
+
+                VAST_PATTERN_CHECK( parent_t::tie( bld, loc, *scope_entry, *cond_block ),
+                                    tie_fail );
+
+                rewriter.eraseOp( op );
+                return mlir::success();
+            }
+
+            static void legalize( conversion_target &trg )
+            {
+                trg.addIllegalOp< hl::SwitchOp >();
+                trg.addIllegalOp< hl::CaseOp >();
+                trg.addIllegalOp< hl::DefaultOp >();
+            }
+        };
+
         template< typename op_t, typename trg_t >
         struct replace : base_pattern< op_t >
         {
@@ -456,11 +987,52 @@ namespace vast::conv
               if_op
             , while_op
             , for_op
+            , switch_op
+            , replace< hl::ReturnOp, ll::ReturnOp >
+        >;
+
+        // Patterns of `cf_patterns` other than loops, which take the option
+        // of rotation.
+        using non_loop_patterns = util::make_list<
+              if_op
+            , switch_op
             , replace< hl::ReturnOp, ll::ReturnOp >
         >;
 
     } // namespace pattern
 
+    void legalize_hl_to_ll_cf(conversion_target &target) {
+        target.addIllegalOp< hl::ContinueOp >();
+        target.addIllegalOp< hl::BreakOp >();
+        target.addIllegalOp< hl::ReturnOp >();
+        target.addLegalOp< mlir::cf::BranchOp >();
+
+        legalize_patterns< pattern::cf_patterns >(target);
+    }
+
+    void populate_hl_to_ll_cf(
+        mlir::RewritePatternSet &patterns, conversion_target &target, bool rotate_loops
+    ) {
+        legalize_hl_to_ll_cf(target);
+        add_patterns< pattern::non_loop_patterns >(patterns, target);
+        patterns.add< pattern::while_op, pattern::for_op >(patterns.getContext(), rotate_loops);
+    }
+
+    void cleanup_hl_to_ll_cf(operation op)
+    {
+        // `eraseUnreachableBlocks` recurses into the regions nested in the
+        // function by itself, cleaning every nested scope over again would
+        // make the cleanup quadratic in the depth of the nesting.
+        mlir::IRRewriter rewriter{ op->getContext() };
+        op->walk< mlir::WalkOrder::PreOrder >([&](operation nested) {
+            if (!mlir::isa< hl::FuncOp, ll::Scope >(nested))
+                return mlir::WalkResult::advance();
+            // We really don't care if anything ws remove or not.
+            std::ignore = mlir::eraseUnreachableBlocks(rewriter, nested->getRegions());
+            return mlir::WalkResult::skip();
+        });
+    }
+
     struct HLToLLCF : ModuleConversionPassMixin< HLToLLCF, HLToLLCFBase >
     {
         using base = ModuleConversionPassMixin< HLToLLCF, HLToLLCFBase >;
@@ -481,28 +1053,20 @@ namespace vast::conv
             return trg;
         }
 
-        static void populate_conversions(config_t &config)
+        HLToLLCF() = default;
+
+        explicit HLToLLCF(bool rotate_loops) {
+            this->rotate_loops = rotate_loops;
+        }
+
+        void populate_conversions(config_t &config)
         {
-            base::populate_conversions_base< pattern::cf_patterns >(config);
+            populate_hl_to_ll_cf(config.patterns, config.target, rotate_loops);
         }
 
         void after_operation() override
         {
-            auto clean_scopes = [&](ll::Scope scope)
-            {
-                mlir::IRRewriter rewriter{ &this->getContext() };
-                // We really don't care if anything ws remove or not.
-                std::ignore = mlir::eraseUnreachableBlocks(rewriter, scope.getBody());
-            };
-            this->getOperation().walk(clean_scopes);
-
-            auto clean_functions = [&](hl::FuncOp fn)
-            {
-                mlir::IRRewriter rewriter{ &this->getContext() };
-                // We really don't care if anything ws remove or not.
-                std::ignore = mlir::eraseUnreachableBlocks(rewriter, fn.getBody());
-            };
-            this->getOperation().walk(clean_functions);
+            cleanup_hl_to_ll_cf(this->getOperation());
         }
     };
 
@@ -512,3 +1076,8 @@ std::unique_ptr< mlir::Pass > vast::createHLToLLCFPass()
 {
     return std::make_unique< vast::conv::HLToLLCF >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createHLToLLCFPass(bool rotate_loops)
+{
+    return std::make_unique< vast::conv::HLToLLCF >(rotate_loops);
+}
@@ -5,9 +5,12 @@
 
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
+#include "vast/Conversion/Common/WalkRewriter.hpp"
 
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
 
@@ -15,6 +18,28 @@ namespace vast::conv::hltollfunc
 {
     namespace pattern
     {
+        // Shared by the conversion pattern and the in-place rewrite of the
+        // pass, the attributes of functions are not converted.
+        static logical_result replace_by_ll_func(hl::FuncOp op, mlir::RewriterBase &rewriter) {
+            llvm::SmallVector< mlir::DictionaryAttr > arg_attrs;
+            llvm::SmallVector< mlir::DictionaryAttr > res_attrs;
+            op.getAllArgAttrs(arg_attrs);
+            op.getAllResultAttrs(res_attrs);
+
+            auto fn = rewriter.create< ll::FuncOp >(
+                op.getLoc(),
+                op.getSymName(),
+                op.getFunctionType(),
+                op.getLinkage(),
+                op->getAttrs(),
+                arg_attrs,
+                res_attrs
+            );
+            rewriter.updateRootInPlace(fn.getOperation(), [&](){fn.getBody().takeBody(op.getBody());});
+            rewriter.replaceOp(op, fn->getOpResults());
+            return logical_result::success();
+        }
+
         struct func_op : operation_conversion_pattern< hl::FuncOp >
         {
             using base = operation_conversion_pattern< hl::FuncOp >;
@@ -22,26 +47,9 @@ namespace vast::conv::hltollfunc
             using adaptor_t = hl::FuncOp::Adaptor;
 
             logical_result matchAndRewrite(
-                hl::FuncOp op, adaptor_t adaptor, conversion_rewriter &rewriter) const override
+                hl::FuncOp op, adaptor_t, conversion_rewriter &rewriter) const override
             {
-                llvm::SmallVector< mlir::DictionaryAttr > arg_attrs;
-                llvm::SmallVector< mlir::DictionaryAttr > res_attrs;
-                op.getAllArgAttrs(arg_attrs);
-                op.getAllResultAttrs(res_attrs);
-
-                auto fn = rewriter.create< ll::FuncOp >(
-                    op.getLoc(),
-                    adaptor.getSymName(),
-                    adaptor.getFunctionType(),
-                    adaptor.getLinkage(),
-                    op->getAttrs(),
-                    arg_attrs,
-                    res_attrs
-                );
-                rewriter.updateRootInPlace(fn.getOperation(), [&](){fn.getBody().takeBody(op.getBody());});
-                rewriter.replaceOp(op, fn->getOpResults());
-                return logical_result::success();
-
+                return replace_by_ll_func(op, rewriter);
             }
 
             static void legalize(conversion_target &target) {
@@ -52,22 +60,37 @@ namespace vast::conv::hltollfunc
         };
     } // namespace pattern
 
-    struct HLToLLFunc : ModuleConversionPassMixin< HLToLLFunc, HLToLLFuncBase > {
-        using base = ModuleConversionPassMixin< HLToLLFunc, HLToLLFuncBase >;
+    // Every function is replaced as is, in a single pass over the module. The
+    // fused lowering converts them by the pattern instead.
+    struct HLToLLFunc : HLToLLFuncBase< HLToLLFunc > {
+        void runOnOperation() override {
+            auto status = rewrite_top_level_in_place< hl::FuncOp >(
+                getOperation(), pattern::replace_by_ll_func
+            );
 
-        static conversion_target create_conversion_target(mcontext_t &context) {
-            conversion_target target(context);
-            return target;
-        }
+            if (mlir::failed(status)) {
+                return signalPassFailure();
+            }
 
-        static void populate_conversions(config_t &config) {
-            base::populate_conversions_base<
-                util::type_list< pattern::func_op>
-            >(config);
+            // Function passes nested below may reuse only analyses cached
+            // on the module, so they are created here.
+            getAnalysis< tc::type_conversion_cache >();
+            getAnalysis< hl::record_index >();
         }
     };
 } // namespace vast::conv::hltollfunc
 
+namespace vast::conv
+{
+    void legalize_hl_to_ll_func(conversion_target &target) {
+        legalize_patterns< util::type_list< hltollfunc::pattern::func_op > >(target);
+    }
+
+    void populate_hl_to_ll_func(mlir::RewritePatternSet &patterns, conversion_target &target) {
+        add_patterns< util::type_list< hltollfunc::pattern::func_op > >(patterns, target);
+    }
+} // namespace vast::conv
+
 
 std::unique_ptr< mlir::Pass > vast::createHLToLLFuncPass()
 {
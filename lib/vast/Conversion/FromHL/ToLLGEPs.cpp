@@ -15,6 +15,9 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Conversion/Common/WalkRewriter.hpp"
+
+#include "vast/Util/Analysis.hpp"
 #include "vast/Util/Symbols.hpp"
 #include "vast/Util/DialectConversion.hpp"
 
@@ -22,64 +25,101 @@ namespace vast
 {
     namespace pattern
     {
-        template< typename T >
-        struct DoConversion {};
+        static std::optional< std::size_t > field_idx(
+            hl::RecordMemberOp op, mlir_type record, const hl::record_index *records
+        ) {
+            if (records)
+                return records->field_idx(record, op.getName());
 
-        template<>
-        struct DoConversion< hl::RecordMemberOp > : util::State< hl::RecordMemberOp >
-        {
-            using util::State< hl::RecordMemberOp >::State;
+            auto module_op = op->getParentOfType< vast_module >();
+            if (!module_op)
+                return {};
 
-            mlir::LogicalResult convert()
-            {
-                auto parent_type = operands.getRecord().getType();
+            auto struct_decl = hl::definition_of(record, module_op);
+            if (!struct_decl)
+                return {};
 
-                auto module_op = op->getParentOfType< vast_module >();
-                if (!module_op)
-                    return mlir::failure();
+            return hl::field_idx(op.getName(), *struct_decl);
+        }
 
-                auto struct_decl = hl::definition_of(parent_type, module_op);
-                if (!struct_decl)
-                    return mlir::failure();
+        // Shared by the conversion pattern and the in-place rewrite of the
+        // pass, `record` is the operand as seen by the rewriter.
+        static logical_result replace_by_gep(
+            hl::RecordMemberOp op, mlir_value record, mlir::RewriterBase &rewriter,
+            const hl::record_index *records
+        ) {
+            auto idx = field_idx(op, record.getType(), records);
+            if (!idx)
+                return mlir::failure();
+
+            auto gep = rewriter.create< ll::StructGEPOp >(
+                    op.getLoc(),
+                    op.getType(),
+                    record,
+                    rewriter.getI32IntegerAttr(*idx),
+                    op.getNameAttr());
+            rewriter.replaceOp( op, gep);
+
+            return mlir::success();
+        }
 
-                auto idx = hl::field_idx(op.getName(), *struct_decl);
-                if (!idx)
-                    return mlir::failure();
+        struct record_member_op : mlir::OpConversionPattern< hl::RecordMemberOp >
+        {
+            using base = mlir::OpConversionPattern< hl::RecordMemberOp >;
+            using adaptor_t = typename hl::RecordMemberOp::Adaptor;
 
-                auto gep = rewriter.create< ll::StructGEPOp >(
-                        op.getLoc(),
-                        op.getType(),
-                        operands.getRecord(),
-                        rewriter.getI32IntegerAttr(*idx),
-                        op.getNameAttr());
-                rewriter.replaceOp( op, gep);
+            record_member_op(mcontext_t *mctx, const hl::record_index *records)
+                : base(mctx), records(records)
+            {}
 
-                return mlir::success();
+            mlir::LogicalResult matchAndRewrite(
+                hl::RecordMemberOp op, adaptor_t operands, conversion_rewriter &rewriter
+            ) const override {
+                return replace_by_gep(op, operands.getRecord(), rewriter, records);
             }
 
+            const hl::record_index *records;
         };
 
-        using record_member_op = util::BasePattern< hl::RecordMemberOp, DoConversion >;
-
     } // namespace pattern
 
+    namespace conv
+    {
+        void legalize_hl_to_ll_geps(conversion_target &target) {
+            target.addIllegalOp< hl::RecordMemberOp >();
+        }
+
+        void populate_hl_to_ll_geps(
+            mlir::RewritePatternSet &patterns, conversion_target &target,
+            const hl::record_index *records
+        ) {
+            legalize_hl_to_ll_geps(target);
+            patterns.add< vast::pattern::record_member_op >(patterns.getContext(), records);
+        }
+    } // namespace conv
+
     struct HLToLLGEPsPass : HLToLLGEPsBase< HLToLLGEPsPass >
     {
         void runOnOperation() override
         {
             auto op = this->getOperation();
-            auto &mctx = this->getContext();
-
-            mlir::ConversionTarget trg(mctx);
-            trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
-            trg.addIllegalOp< hl::RecordMemberOp >();
 
-            mlir::RewritePatternSet patterns(&mctx);
-
-            patterns.add< pattern::record_member_op >(&mctx);
-
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
+            // Every access is replaced as is, in a single walk. The fused
+            // lowering converts them by the pattern instead.
+            bool changed = false;
+            auto records = get_module_analysis< hl::record_index >(op, getAnalysisManager());
+            auto status = conv::rewrite_in_place< hl::RecordMemberOp >(op,
+                [&] (hl::RecordMemberOp member, mlir::RewriterBase &rewriter) {
+                    changed = true;
+                    return pattern::replace_by_gep(member, member.getRecord(), rewriter, records);
+                }
+            );
+
+            if (mlir::failed(status))
                 return signalPassFailure();
+
+            if (!changed)
+                return markAllAnalysesPreserved();
         }
     };
 } // namespace vast
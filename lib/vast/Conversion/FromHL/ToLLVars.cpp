@@ -13,9 +13,11 @@ VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Util/Analysis.hpp"
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
@@ -67,6 +69,11 @@ namespace vast
 
                 auto uninit_var = rewriter.create< ll::UninitializedVar >(op.getLoc(),
                                                                           trg_type);
+                if (auto align = op->getAttr(hl::AlignmentAttr::attr_name()))
+                    uninit_var->setAttr(hl::AlignmentAttr::attr_name(), align);
+
+                if (auto init = op.getInitialValueAttr())
+                    uninit_var->setAttr(op.getInitialValueAttrName(), init);
 
                 if (op.getInitializer().empty())
                 {
@@ -108,6 +115,26 @@ namespace vast
 
     } // namespace pattern
 
+    namespace conv
+    {
+        void legalize_hl_to_ll_vars(conversion_target &target) {
+            target.addDynamicallyLegalOp< hl::VarDeclOp >([&](hl::VarDeclOp op)
+            {
+                // TODO(conv): `!ast_node->isLocalVarDeclOrParam()` should maybe be ported
+                //             to the mlir op?
+                return mlir::isa< vast_module >(op->getParentOp());
+            });
+        }
+
+        void populate_hl_to_ll_vars(
+            mlir::RewritePatternSet &patterns, conversion_target &target,
+            tc::LLVMTypeConverter &type_converter
+        ) {
+            legalize_hl_to_ll_vars(target);
+            patterns.add< vast::pattern::vardecl_op >(type_converter);
+        }
+    } // namespace conv
+
     struct HLToLLVarsPass : HLToLLVarsBase< HLToLLVarsPass >
     {
         void runOnOperation() override
@@ -117,22 +144,23 @@ namespace vast
 
             mlir::ConversionTarget trg(mctx);
             trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
-            trg.addDynamicallyLegalOp< hl::VarDeclOp >([&](hl::VarDeclOp op)
-            {
-                // TODO(conv): `!ast_node->isLocalVarDeclOrParam()` should maybe be ported
-                //             to the mlir op?
-                return mlir::isa< vast_module >(op->getParentOp());
-            });
 
-            const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
+            conversion_target illegal(mctx);
+            conv::legalize_hl_to_ll_vars(illegal);
+            if (!util::has_illegal_ops(op, illegal))
+                return markAllAnalysesPreserved();
+
+            auto dl_module = get_module_analysis< data_layout_analysis >(op, getAnalysisManager());
+            const auto &dl_analysis = dl_module
+                ? dl_module->get() : this->getAnalysis< mlir::DataLayoutAnalysis >();
 
             mlir::LowerToLLVMOptions llvm_options(&mctx);
             llvm_options.useBarePtrCallConv = true;
             conv::tc::LLVMTypeConverter type_converter(&mctx, llvm_options, &dl_analysis);
+            type_converter.use_cache(conv::tc::get_conversion_cache(op, getAnalysisManager()));
 
             mlir::RewritePatternSet patterns(&mctx);
-
-            patterns.add< pattern::vardecl_op >(type_converter);
+            conv::populate_hl_to_ll_vars(patterns, trg, type_converter);
 
             if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
                 return signalPassFailure();
@@ -0,0 +1,106 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/OpenMP/OpenMPDialect.h>
+#include <mlir/IR/Builders.h>
+
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "CountedLoop.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    namespace
+    {
+        namespace omp = mlir::omp;
+
+        // Each thread of the team needs its own copy of the loop variable.
+        bool has_private_iv(const loops::counted_loop &counted) {
+            auto team = counted.op->getParentOfType< omp::ParallelOp >();
+            return counted.iv->getParentOfType< omp::ParallelOp >() == team;
+        }
+
+        void to_wsloop(loops::counted_loop &counted, hl::WorksharingAttr ws) {
+            auto op = counted.op;
+            Builder bld(op);
+
+            auto lb   = counted.lower_bound(bld);
+            auto ub   = counted.upper_bound(bld);
+            auto step = counted.step_value(bld);
+
+            // Operands of the loop are defined before it.
+            auto chunk = ws.getChunk()
+                ? counted.constant(bld, ws.getChunk().getValue()) : mlir_value();
+
+            auto loop = bld.create< omp::WsLoopOp >(
+                op.getLoc(), mlir::ValueRange(lb), mlir::ValueRange(ub), mlir::ValueRange(step)
+            );
+
+            auto kind = omp::symbolizeClauseScheduleKind(ws.getSchedule());
+            VAST_CHECK(kind, "unknown schedule kind: {0}", ws.getSchedule());
+            loop.setScheduleValAttr(omp::ClauseScheduleKindAttr::get(bld.getContext(), *kind));
+
+            if (chunk) {
+                loop.getScheduleChunkVarMutable().assign(chunk);
+            }
+
+            if (ws.getNowait()) {
+                loop.setNowaitAttr(bld.getUnitAttr());
+            }
+
+            auto body = bld.createBlock(
+                &loop.getRegion(), {}, { counted.signless_type() }, { op.getLoc() }
+            );
+            bld.create< omp::YieldOp >(op.getLoc(), mlir::ValueRange());
+
+            counted.move_body(body, std::prev(body->end()), body->getArgument(0));
+
+            op->erase();
+        }
+
+    } // namespace
+
+    //
+    // Converts loops of OpenMP worksharing directives, which codegen marks by
+    // `hl.worksharing`, to `omp.wsloop`. Unlike for `vast-hl-to-scf`, a marked
+    // loop that is not counted is an error, since every thread of the team
+    // would run all of its iterations.
+    //
+    struct HLToOMP : HLToOMPBase< HLToOMP >
+    {
+        void runOnOperation() override {
+            llvm::SmallVector< hl::ForOp > fors;
+            getOperation()->walk([&] (hl::ForOp op) {
+                if (op->hasAttr(hl::WorksharingAttr::attr_name())) {
+                    fors.push_back(op);
+                }
+            });
+
+            for (auto op : fors) {
+                auto ws = op->getAttrOfType< hl::WorksharingAttr >(hl::WorksharingAttr::attr_name());
+                auto loop = loops::counted_loop::match(op);
+                if (!loop || !has_private_iv(*loop)) {
+                    op.emitError("unsupported form of an OpenMP worksharing loop");
+                    return signalPassFailure();
+                }
+
+                to_wsloop(*loop, ws);
+            }
+        }
+    };
+
+} // namespace vast::conv
+
+std::unique_ptr< mlir::Pass > vast::createHLToOMPPass()
+{
+    return std::make_unique< vast::conv::HLToOMP >();
+}
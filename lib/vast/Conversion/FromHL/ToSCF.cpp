@@ -0,0 +1,67 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/IR/Builders.h>
+
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "CountedLoop.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    namespace
+    {
+        void raise(loops::counted_loop &counted) {
+            auto op = counted.op;
+            Builder bld(op);
+
+            auto lb   = counted.lower_bound(bld);
+            auto ub   = counted.upper_bound(bld);
+            auto step = counted.step_value(bld);
+
+            auto loop = bld.create< mlir::scf::ForOp >(op.getLoc(), lb, ub, step);
+
+            auto body = loop.getBody();
+            counted.move_body(body, std::prev(body->end()), loop.getInductionVar());
+
+            op->erase();
+        }
+
+    } // namespace
+
+    //
+    // Raises counted `hl.for` loops to `scf.for`, so that loop transformations
+    // of mlir apply to them. The loop variable stays in memory, it is assigned
+    // the induction variable at the start of each iteration.
+    //
+    struct HLToSCF : HLToSCFBase< HLToSCF >
+    {
+        void runOnOperation() override {
+            llvm::SmallVector< hl::ForOp > fors;
+            getOperation()->walk([&] (hl::ForOp op) { fors.push_back(op); });
+
+            // Inner loops are visited first, outer loops may contain raised
+            // loops in their bodies.
+            for (auto op : fors) {
+                if (auto loop = loops::counted_loop::match(op)) {
+                    raise(*loop);
+                }
+            }
+        }
+    };
+
+} // namespace vast::conv
+
+std::unique_ptr< mlir::Pass > vast::createHLToSCFPass()
+{
+    return std::make_unique< vast::conv::HLToSCF >();
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Conversion/TypeConverters/ConversionCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+#include "vast/Util/Analysis.hpp"
+
+#include <mutex>
+
+namespace vast::conv::tc
+{
+    type_conversion_cache::type_conversion_cache(operation op)
+        : mod(op), stamp(hl::type_definitions_hash(op))
+    {}
+
+    maybe_types_t type_conversion_cache::lookup(domain_t domain, mlir_type from) const {
+        std::shared_lock lock(mutex);
+        if (auto it = entries.find({ domain, from }); it != entries.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    void type_conversion_cache::store(
+        domain_t domain, mlir_type from, mlir::ArrayRef< mlir_type > to
+    ) const {
+        std::unique_lock lock(mutex);
+        entries.try_emplace({ domain, from }, to.begin(), to.end());
+    }
+
+    bool type_conversion_cache::isInvalidated(
+        const mlir::AnalysisManager::PreservedAnalyses &
+    ) const {
+        return hl::type_definitions_hash(mod) != stamp;
+    }
+
+    const type_conversion_cache *get_conversion_cache(operation op, mlir::AnalysisManager am) {
+        return get_module_analysis< type_conversion_cache >(op, am);
+    }
+
+} // namespace vast::conv::tc
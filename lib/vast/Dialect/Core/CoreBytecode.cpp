@@ -0,0 +1,256 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreTypes.hpp"
+
+#include "vast/Util/Bytecode.hpp"
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+#include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/APSInt.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::core
+{
+    namespace
+    {
+        constexpr std::uint64_t bytecode_version = 1;
+
+        // Codes are part of the encoding, new kinds are only appended.
+        enum class type_code : std::uint64_t { function_type };
+
+        enum class attr_code : std::uint64_t
+        {
+            boolean, integer, floating, string_literal, void_value, type_layout, source_language
+        };
+
+    } // namespace
+
+    //
+    // Compact encoding of core types and literal attributes. Values of
+    // integer and floating literals are written with the width and semantics
+    // that precede them, so no textual constant is parsed back.
+    //
+    struct CoreBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        mcontext_t *context() const { return getDialect()->getContext(); }
+
+        void writeVersion(mlir::DialectBytecodeWriter &writer) const final {
+            util::write_bytecode_version(writer, bytecode_version);
+        }
+
+        std::unique_ptr< mlir::DialectVersion > readVersion(
+            mlir::DialectBytecodeReader &reader
+        ) const final {
+            return util::read_bytecode_version(reader, bytecode_version);
+        }
+
+        mlir::LogicalResult writeType(
+            mlir_type type, mlir::DialectBytecodeWriter &writer
+        ) const final {
+            return llvm::TypeSwitch< mlir_type, mlir::LogicalResult >(type)
+                .Case([&] (FunctionType ty) {
+                    writer.writeVarInt(std::uint64_t(type_code::function_type));
+                    writer.writeTypes(ty.getInputs());
+                    writer.writeTypes(ty.getResults());
+                    writer.writeVarInt(ty.getVarArg());
+                    return mlir::success();
+                })
+                .Default([] (mlir_type) { return mlir::failure(); });
+        }
+
+        mlir_type readType(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            switch (type_code(code)) {
+                case type_code::function_type: {
+                    llvm::SmallVector< mlir_type > inputs, results;
+                    bool vararg;
+                    if (mlir::failed(reader.readTypes(inputs))
+                        || mlir::failed(reader.readTypes(results))
+                        || mlir::failed(util::read_flag(reader, vararg))
+                    ) {
+                        return {};
+                    }
+                    return FunctionType::get(context(), inputs, results, vararg);
+                }
+            }
+
+            reader.emitError() << "unknown core type code " << code;
+            return {};
+        }
+
+        mlir::LogicalResult writeAttribute(
+            mlir_attr attr, mlir::DialectBytecodeWriter &writer
+        ) const final {
+            auto kind = [&] (attr_code code) { writer.writeVarInt(std::uint64_t(code)); };
+
+            return llvm::TypeSwitch< mlir_attr, mlir::LogicalResult >(attr)
+                .Case([&] (BooleanAttr lit) {
+                    kind(attr_code::boolean);
+                    writer.writeType(lit.getType());
+                    writer.writeVarInt(lit.getValue());
+                    return mlir::success();
+                })
+                .Case([&] (IntegerAttr lit) {
+                    const auto &value = lit.getValue();
+                    kind(attr_code::integer);
+                    writer.writeType(lit.getType());
+                    writer.writeVarInt(value.getBitWidth());
+                    writer.writeVarInt(value.isUnsigned());
+                    writer.writeAPIntWithKnownWidth(value);
+                    return mlir::success();
+                })
+                .Case([&] (FloatAttr lit) {
+                    const auto &value = lit.getValue();
+                    kind(attr_code::floating);
+                    writer.writeType(lit.getType());
+                    writer.writeVarInt(llvm::APFloatBase::SemanticsToEnum(value.getSemantics()));
+                    writer.writeAPFloatWithKnownSemantics(value);
+                    return mlir::success();
+                })
+                .Case([&] (StringLiteralAttr lit) {
+                    kind(attr_code::string_literal);
+                    writer.writeOwnedString(lit.getValue());
+                    writer.writeType(lit.getType());
+                    return mlir::success();
+                })
+                .Case([&] (VoidAttr lit) {
+                    kind(attr_code::void_value);
+                    writer.writeType(lit.getType());
+                    return mlir::success();
+                })
+                .Case([&] (TypeLayoutAttr layout) {
+                    kind(attr_code::type_layout);
+                    writer.writeVarInt(layout.getWidth());
+                    writer.writeVarInt(layout.getAbiAlign());
+                    return mlir::success();
+                })
+                .Case([&] (SourceLanguageAttr lang) {
+                    kind(attr_code::source_language);
+                    writer.writeVarInt(std::uint64_t(lang.getValue()));
+                    return mlir::success();
+                })
+                .Default([] (mlir_attr) { return mlir::failure(); });
+        }
+
+        mlir_attr readAttribute(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            auto ctx = context();
+            switch (attr_code(code)) {
+                case attr_code::boolean: {
+                    mlir_type type;
+                    bool value;
+                    if (mlir::failed(reader.readType(type))
+                        || mlir::failed(util::read_flag(reader, value))
+                    ) {
+                        return {};
+                    }
+                    return BooleanAttr::get(ctx, type, value);
+                }
+                case attr_code::integer: {
+                    mlir_type type;
+                    std::uint64_t width;
+                    bool is_unsigned;
+                    if (mlir::failed(reader.readType(type))
+                        || mlir::failed(reader.readVarInt(width))
+                        || mlir::failed(util::read_flag(reader, is_unsigned))
+                    ) {
+                        return {};
+                    }
+
+                    auto value = reader.readAPIntWithKnownWidth(unsigned(width));
+                    if (mlir::failed(value)) {
+                        return {};
+                    }
+                    return IntegerAttr::get(ctx, type, llvm::APSInt(*value, is_unsigned));
+                }
+                case attr_code::floating: {
+                    mlir_type type;
+                    std::uint64_t semantics;
+                    if (mlir::failed(reader.readType(type))
+                        || mlir::failed(reader.readVarInt(semantics))
+                    ) {
+                        return {};
+                    }
+
+                    if (semantics > llvm::APFloatBase::S_MaxSemantics) {
+                        reader.emitError() << "unknown floating point semantics " << semantics;
+                        return {};
+                    }
+
+                    auto value = reader.readAPFloatWithKnownSemantics(
+                        llvm::APFloatBase::EnumToSemantics(
+                            llvm::APFloatBase::Semantics(semantics)
+                        )
+                    );
+                    if (mlir::failed(value)) {
+                        return {};
+                    }
+                    return FloatAttr::get(ctx, type, *value);
+                }
+                case attr_code::string_literal: {
+                    // The value is stored escaped already.
+                    string_ref value;
+                    mlir_type type;
+                    if (mlir::failed(reader.readString(value))
+                        || mlir::failed(reader.readType(type))
+                    ) {
+                        return {};
+                    }
+                    return StringLiteralAttr::get(ctx, value, type);
+                }
+                case attr_code::void_value: {
+                    mlir_type type;
+                    if (mlir::failed(reader.readType(type))) {
+                        return {};
+                    }
+                    return VoidAttr::get(ctx, type);
+                }
+                case attr_code::type_layout: {
+                    std::uint64_t width, abi_align;
+                    if (mlir::failed(reader.readVarInt(width))
+                        || mlir::failed(reader.readVarInt(abi_align))
+                    ) {
+                        return {};
+                    }
+                    return TypeLayoutAttr::get(ctx, unsigned(width), unsigned(abi_align));
+                }
+                case attr_code::source_language: {
+                    std::uint64_t lang;
+                    if (mlir::failed(reader.readVarInt(lang))) {
+                        return {};
+                    }
+
+                    auto value = symbolizeSourceLanguage(std::uint32_t(lang));
+                    if (!value) {
+                        reader.emitError() << "unknown source language " << lang;
+                        return {};
+                    }
+                    return SourceLanguageAttr::get(ctx, *value);
+                }
+            }
+
+            reader.emitError() << "unknown core attribute code " << code;
+            return {};
+        }
+    };
+
+    void CoreDialect::registerBytecodeInterface() {
+        addInterfaces< CoreBytecodeDialectInterface >();
+    }
+
+} // namespace vast::core
@@ -63,6 +63,7 @@ namespace vast::core
         >();
 
         addInterfaces< CoreOpAsmDialectInterface >();
+        registerBytecodeInterface();
     }
 
     using OpBuilder = mlir::OpBuilder;
@@ -133,6 +133,26 @@ namespace vast::core {
         return false;
     }
 
+    std::optional< clang::Visibility > get_symbol_visibility(
+        const clang::NamedDecl *decl, bool is_definition
+    ) {
+        if (!decl->isExternallyVisible()) {
+            return std::nullopt;
+        }
+
+        auto info = decl->getLinkageAndVisibility();
+        const auto &opts = decl->getASTContext().getLangOpts();
+        if (!info.isVisibilityExplicit() && !is_definition && !opts.SetVisibilityForExternDecls) {
+            return std::nullopt;
+        }
+
+        if (info.getVisibility() == clang::DefaultVisibility) {
+            return std::nullopt;
+        }
+
+        return info.getVisibility();
+    }
+
     // adapted from getMLIRVisibilityFromCIRLinkage
     Visibility get_visibility_from_linkage(GlobalLinkageKind linkage) {
         switch (linkage) {
@@ -0,0 +1,135 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Util/DataLayout.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // In the order of `builtin_type`: bool, char, short, int, long,
+        // long long, __int128, _Float16, __bf16, float, double, long double,
+        // __float128 and pointers.
+
+        // x86-64 and AArch64 System V (Linux, BSDs), x86-64 Darwin.
+        constexpr builtin_layout_table lp64 = { "lp64", {{
+            { 8, 8 }, { 8, 8 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 64, 64 }, { 128, 128 },
+            { 16, 16 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 128, 128 }, { 128, 128 },
+            { 64, 64 }
+        }} };
+
+        // AArch64 Darwin, long double is double.
+        constexpr builtin_layout_table lp64_double_long_double = { "lp64-double-long-double", {{
+            { 8, 8 }, { 8, 8 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 64, 64 }, { 128, 128 },
+            { 16, 16 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 64, 64 }, { 128, 128 },
+            { 64, 64 }
+        }} };
+
+        // 64-bit Windows, long is 32 bits and long double is double.
+        constexpr builtin_layout_table llp64 = { "llp64", {{
+            { 8, 8 }, { 8, 8 }, { 16, 16 }, { 32, 32 }, { 32, 32 }, { 64, 64 }, { 128, 128 },
+            { 16, 16 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 64, 64 }, { 128, 128 },
+            { 64, 64 }
+        }} };
+
+        constexpr const builtin_layout_table *tables[] = {
+            &lp64, &lp64_double_long_double, &llp64
+        };
+
+    } // namespace
+
+    const builtin_layout_table *builtin_layout_table::of_target(const llvm::Triple &triple) {
+        if (!triple.isX86_64() && !triple.isAArch64()) {
+            return nullptr;
+        }
+
+        // ILP32 ABIs of 64-bit targets.
+        if (triple.isArch32Bit()
+            || triple.getEnvironment() == llvm::Triple::GNUX32
+            || triple.getEnvironment() == llvm::Triple::GNUILP32
+        ) {
+            return nullptr;
+        }
+
+        if (triple.isOSWindows()) {
+            // MinGW keeps the x87 long double.
+            return triple.isWindowsGNUEnvironment() ? nullptr : &llp64;
+        }
+
+        if (triple.isAArch64() && triple.isOSDarwin()) {
+            return &lp64_double_long_double;
+        }
+
+        return &lp64;
+    }
+
+    const builtin_layout_table *builtin_layout_table::by_name(string_ref name) {
+        for (auto table : tables) {
+            if (table->name == name) {
+                return table;
+            }
+        }
+        return nullptr;
+    }
+
+    const builtin_layout_table *builtin_layout_table::of_module(operation mod) {
+        if (auto attr = mod->getAttrOfType< mlir::StringAttr >(attr_name())) {
+            return by_name(attr.getValue());
+        }
+        return nullptr;
+    }
+
+    // Entries of types the module does not use are not emitted, the table
+    // still answers for them as the target would.
+    static bool agrees_with_entries(const builtin_layout_table &table, operation mod) {
+        auto spec = mod->getAttrOfType< mlir::DataLayoutSpecAttr >(
+            mlir::DLTIDialect::kDataLayoutAttrName
+        );
+
+        if (!spec) {
+            return true;
+        }
+
+        for (auto entry : spec.getEntries()) {
+            if (!dl::DLEntry::is_vast_entry(entry)) {
+                continue;
+            }
+
+            dl::DLEntry dl_entry(entry);
+            auto layout = table.lookup(dl_entry.type);
+            if (layout && *layout != builtin_layout{ dl_entry.bw, dl_entry.abi_align }) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void select_builtin_layout(operation mod) {
+        mod->removeAttr(builtin_layout_table::attr_name());
+
+        auto triple = mod->getAttrOfType< mlir::StringAttr >(
+            core::CoreDialect::getTargetTripleAttrName()
+        );
+
+        if (!triple) {
+            return;
+        }
+
+        auto table = builtin_layout_table::of_target(llvm::Triple(triple.getValue()));
+        if (table && agrees_with_entries(*table, mod)) {
+            mod->setAttr(
+                builtin_layout_table::attr_name(),
+                mlir::StringAttr::get(mod->getContext(), table->name)
+            );
+        }
+    }
+
+} // namespace vast::hl
@@ -12,8 +12,80 @@ VAST_RELAX_WARNINGS
 #define GET_ATTRDEF_CLASSES
 #include "vast/Dialect/HighLevel/HighLevelAttributes.cpp.inc"
 
+#include <array>
+
 namespace vast::hl
 {
+    namespace
+    {
+        // Qualifiers are parsed in any order, printed in the order of the
+        // parameters.
+        template< std::size_t n >
+        std::array< bool, n > parse_qualifiers(
+            mlir::AsmParser &parser, const std::array< llvm::StringRef, n > &keywords
+        ) {
+            std::array< bool, n > set = {};
+            do {
+                llvm::StringRef keyword;
+                if (mlir::failed(parser.parseOptionalKeyword(&keyword, keywords))) {
+                    break;
+                }
+                set[std::size_t(llvm::find(keywords, keyword) - keywords.begin())] = true;
+            } while (mlir::succeeded(parser.parseOptionalComma()));
+            return set;
+        }
+
+        template< std::size_t n >
+        void print_qualifiers(
+            mlir::AsmPrinter &printer,
+            const std::array< llvm::StringRef, n > &keywords,
+            const std::array< bool, n > &set
+        ) {
+            auto &os = printer.getStream();
+            os << ' ';
+            bool first = true;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (set[i]) {
+                    os << (first ? "" : ", ") << keywords[i];
+                    first = false;
+                }
+            }
+            os << ' ';
+        }
+
+        constexpr std::array< llvm::StringRef, 2 > cv_keywords  = { "const", "volatile" };
+        constexpr std::array< llvm::StringRef, 3 > ucv_keywords = { "unsigned", "const", "volatile" };
+        constexpr std::array< llvm::StringRef, 3 > cvr_keywords = { "const", "volatile", "restrict" };
+
+    } // namespace
+
+    mlir::Attribute CVQualifiersAttr::parse(mlir::AsmParser &parser, mlir::Type) {
+        auto [c, v] = parse_qualifiers(parser, cv_keywords);
+        return get(parser.getContext(), c, v);
+    }
+
+    void CVQualifiersAttr::print(mlir::AsmPrinter &printer) const {
+        print_qualifiers(printer, cv_keywords, { getIsConst(), getIsVolatile() });
+    }
+
+    mlir::Attribute UCVQualifiersAttr::parse(mlir::AsmParser &parser, mlir::Type) {
+        auto [u, c, v] = parse_qualifiers(parser, ucv_keywords);
+        return get(parser.getContext(), u, c, v);
+    }
+
+    void UCVQualifiersAttr::print(mlir::AsmPrinter &printer) const {
+        print_qualifiers(printer, ucv_keywords, { getIsUnsigned(), getIsConst(), getIsVolatile() });
+    }
+
+    mlir::Attribute CVRQualifiersAttr::parse(mlir::AsmParser &parser, mlir::Type) {
+        auto [c, v, r] = parse_qualifiers(parser, cvr_keywords);
+        return get(parser.getContext(), c, v, r);
+    }
+
+    void CVRQualifiersAttr::print(mlir::AsmPrinter &printer) const {
+        print_qualifiers(printer, cvr_keywords, { getIsConst(), getIsVolatile(), getIsRestrict() });
+    }
+
     void HighLevelDialect::registerAttributes()
     {
         addAttributes<
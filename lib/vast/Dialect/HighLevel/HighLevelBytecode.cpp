@@ -0,0 +1,401 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "vast/Util/Bytecode.hpp"
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::hl
+{
+    namespace
+    {
+        constexpr std::uint64_t bytecode_version = 1;
+
+        // Codes are part of the encoding, new kinds are only appended.
+        enum class type_code : std::uint64_t
+        {
+            void_type, bool_type,
+            char_type, short_type, int_type, long_type, longlong_type, int128_type,
+            half_type, bfloat16_type, float_type, double_type, longdouble_type, float128_type,
+            record_type, enum_type, typedef_type, typeof_expr_type,
+            elaborated_type, pointer_type, typeof_type,
+            lvalue_type, rvalue_type, reference_type, paren_type, decayed_type, attributed_type,
+            adjusted_type, array_type, vector_type, label_type
+        };
+
+        enum class attr_code : std::uint64_t
+        {
+            cv_qualifiers, ucv_qualifiers, cvr_qualifiers, value_range
+        };
+
+        //
+        // Qualifiers are encoded as a single varint, zero for the absent
+        // qualifiers attribute, otherwise the mask of set qualifiers shifted
+        // above a presence bit.
+        //
+        std::uint64_t qualifiers_mask(CVQualifiersAttr quals) {
+            return std::uint64_t(quals.getIsConst()) | std::uint64_t(quals.getIsVolatile()) << 1;
+        }
+
+        std::uint64_t qualifiers_mask(UCVQualifiersAttr quals) {
+            return std::uint64_t(quals.getIsUnsigned())
+                | std::uint64_t(quals.getIsConst()) << 1
+                | std::uint64_t(quals.getIsVolatile()) << 2;
+        }
+
+        std::uint64_t qualifiers_mask(CVRQualifiersAttr quals) {
+            return std::uint64_t(quals.getIsConst())
+                | std::uint64_t(quals.getIsVolatile()) << 1
+                | std::uint64_t(quals.getIsRestrict()) << 2;
+        }
+
+        template< typename quals_t >
+        void write_qualifiers(mlir::DialectBytecodeWriter &writer, quals_t quals) {
+            writer.writeVarInt(quals ? qualifiers_mask(quals) << 1 | 1 : 0);
+        }
+
+        template< typename quals_t >
+        quals_t qualifiers_from_mask(mcontext_t *ctx, std::uint64_t mask) {
+            if constexpr (std::is_same_v< quals_t, CVQualifiersAttr >) {
+                return CVQualifiersAttr::get(ctx, mask & 1, mask & 2);
+            } else if constexpr (std::is_same_v< quals_t, UCVQualifiersAttr >) {
+                return UCVQualifiersAttr::get(ctx, mask & 1, mask & 2, mask & 4);
+            } else {
+                static_assert(std::is_same_v< quals_t, CVRQualifiersAttr >);
+                return CVRQualifiersAttr::get(ctx, mask & 1, mask & 2, mask & 4);
+            }
+        }
+
+        template< typename quals_t >
+        mlir::FailureOr< quals_t > read_qualifiers(
+            mcontext_t *ctx, mlir::DialectBytecodeReader &reader
+        ) {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return mlir::failure();
+            }
+
+            if (code == 0) {
+                return quals_t();
+            }
+
+            return qualifiers_from_mask< quals_t >(ctx, code >> 1);
+        }
+
+        // Standalone qualifiers are always present and encoded by their mask.
+        template< typename quals_t >
+        mlir_attr read_qualifiers_attr(mcontext_t *ctx, mlir::DialectBytecodeReader &reader) {
+            std::uint64_t mask;
+            if (mlir::failed(reader.readVarInt(mask))) {
+                return {};
+            }
+            return qualifiers_from_mask< quals_t >(ctx, mask);
+        }
+
+        // Reads the qualifiers trailing the other parameters of `type_t`.
+        template< typename type_t, typename ...params_t >
+        mlir_type read_qualified(
+            mcontext_t *ctx, mlir::DialectBytecodeReader &reader, params_t ...params
+        ) {
+            using quals_t = decltype(std::declval< type_t >().getQuals());
+            auto quals = read_qualifiers< quals_t >(ctx, reader);
+            if (mlir::failed(quals)) {
+                return {};
+            }
+            return type_t::get(ctx, params..., *quals);
+        }
+
+        template< typename type_t >
+        mlir_type read_named(mcontext_t *ctx, mlir::DialectBytecodeReader &reader) {
+            string_ref name;
+            if (mlir::failed(reader.readString(name))) {
+                return {};
+            }
+            return read_qualified< type_t >(ctx, reader, name);
+        }
+
+        template< typename type_t >
+        mlir_type read_wrapped(mcontext_t *ctx, mlir::DialectBytecodeReader &reader) {
+            mlir_type element;
+            if (mlir::failed(reader.readType(element))) {
+                return {};
+            }
+
+            if constexpr (requires (type_t ty) { ty.getQuals(); }) {
+                return read_qualified< type_t >(ctx, reader, element);
+            } else {
+                return type_t::get(ctx, element);
+            }
+        }
+
+    } // namespace
+
+    //
+    // Compact encoding of high-level types and of the attributes they are
+    // built from. Kinds without an encoding are written in their textual
+    // form by the bytecode writer.
+    //
+    struct HighLevelBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        mcontext_t *context() const { return getDialect()->getContext(); }
+
+        void writeVersion(mlir::DialectBytecodeWriter &writer) const final {
+            util::write_bytecode_version(writer, bytecode_version);
+        }
+
+        std::unique_ptr< mlir::DialectVersion > readVersion(
+            mlir::DialectBytecodeReader &reader
+        ) const final {
+            return util::read_bytecode_version(reader, bytecode_version);
+        }
+
+        mlir::LogicalResult writeType(
+            mlir_type type, mlir::DialectBytecodeWriter &writer
+        ) const final {
+            auto kind = [&] (type_code code) { writer.writeVarInt(std::uint64_t(code)); };
+
+            auto qualified = [&] (type_code code, auto ty) {
+                kind(code);
+                write_qualifiers(writer, ty.getQuals());
+                return mlir::success();
+            };
+
+            auto named = [&] (type_code code, auto ty) {
+                kind(code);
+                writer.writeOwnedString(ty.getName());
+                write_qualifiers(writer, ty.getQuals());
+                return mlir::success();
+            };
+
+            auto wrapped = [&] (type_code code, auto ty, mlir_type element) {
+                kind(code);
+                writer.writeType(element);
+                if constexpr (requires { ty.getQuals(); }) {
+                    write_qualifiers(writer, ty.getQuals());
+                }
+                return mlir::success();
+            };
+
+            using tc = type_code;
+            return llvm::TypeSwitch< mlir_type, mlir::LogicalResult >(type)
+                .Case([&] (VoidType ty)       { return qualified(tc::void_type, ty); })
+                .Case([&] (BoolType ty)       { return qualified(tc::bool_type, ty); })
+                .Case([&] (CharType ty)       { return qualified(tc::char_type, ty); })
+                .Case([&] (ShortType ty)      { return qualified(tc::short_type, ty); })
+                .Case([&] (IntType ty)        { return qualified(tc::int_type, ty); })
+                .Case([&] (LongType ty)       { return qualified(tc::long_type, ty); })
+                .Case([&] (LongLongType ty)   { return qualified(tc::longlong_type, ty); })
+                .Case([&] (Int128Type ty)     { return qualified(tc::int128_type, ty); })
+                .Case([&] (HalfType ty)       { return qualified(tc::half_type, ty); })
+                .Case([&] (BFloat16Type ty)   { return qualified(tc::bfloat16_type, ty); })
+                .Case([&] (FloatType ty)      { return qualified(tc::float_type, ty); })
+                .Case([&] (DoubleType ty)     { return qualified(tc::double_type, ty); })
+                .Case([&] (LongDoubleType ty) { return qualified(tc::longdouble_type, ty); })
+                .Case([&] (Float128Type ty)   { return qualified(tc::float128_type, ty); })
+                .Case([&] (RecordType ty)     { return named(tc::record_type, ty); })
+                .Case([&] (EnumType ty)       { return named(tc::enum_type, ty); })
+                .Case([&] (TypedefType ty)    { return named(tc::typedef_type, ty); })
+                .Case([&] (TypeOfExprType ty) { return named(tc::typeof_expr_type, ty); })
+                .Case([&] (ElaboratedType ty) {
+                    return wrapped(tc::elaborated_type, ty, ty.getElementType());
+                })
+                .Case([&] (PointerType ty) {
+                    return wrapped(tc::pointer_type, ty, ty.getElementType());
+                })
+                .Case([&] (TypeOfTypeType ty) {
+                    return wrapped(tc::typeof_type, ty, ty.getUnmodifiedType());
+                })
+                .Case([&] (LValueType ty) {
+                    return wrapped(tc::lvalue_type, ty, ty.getElementType());
+                })
+                .Case([&] (RValueType ty) {
+                    return wrapped(tc::rvalue_type, ty, ty.getElementType());
+                })
+                .Case([&] (ReferenceType ty) {
+                    return wrapped(tc::reference_type, ty, ty.getElementType());
+                })
+                .Case([&] (ParenType ty) {
+                    return wrapped(tc::paren_type, ty, ty.getElementType());
+                })
+                .Case([&] (DecayedType ty) {
+                    return wrapped(tc::decayed_type, ty, ty.getElementType());
+                })
+                .Case([&] (AttributedType ty) {
+                    return wrapped(tc::attributed_type, ty, ty.getElementType());
+                })
+                .Case([&] (AdjustedType ty) {
+                    kind(tc::adjusted_type);
+                    writer.writeType(ty.getOriginal());
+                    writer.writeType(ty.getAdjusted());
+                    return mlir::success();
+                })
+                .Case([&] (ArrayType ty) {
+                    // Zero stands for an array of unknown size.
+                    kind(tc::array_type);
+                    auto size = ty.getSize();
+                    writer.writeVarInt(size ? *size + 1 : 0);
+                    writer.writeType(ty.getElementType());
+                    write_qualifiers(writer, ty.getQuals());
+                    return mlir::success();
+                })
+                .Case([&] (VectorType ty) {
+                    kind(tc::vector_type);
+                    writer.writeVarInt(ty.getSize());
+                    writer.writeType(ty.getElementType());
+                    write_qualifiers(writer, ty.getQuals());
+                    return mlir::success();
+                })
+                .Case([&] (LabelType) {
+                    kind(tc::label_type);
+                    return mlir::success();
+                })
+                .Default([] (mlir_type) { return mlir::failure(); });
+        }
+
+        mlir_type readType(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            auto ctx = context();
+            switch (type_code(code)) {
+                case type_code::void_type:        return read_qualified< VoidType >(ctx, reader);
+                case type_code::bool_type:        return read_qualified< BoolType >(ctx, reader);
+                case type_code::char_type:        return read_qualified< CharType >(ctx, reader);
+                case type_code::short_type:       return read_qualified< ShortType >(ctx, reader);
+                case type_code::int_type:         return read_qualified< IntType >(ctx, reader);
+                case type_code::long_type:        return read_qualified< LongType >(ctx, reader);
+                case type_code::longlong_type:    return read_qualified< LongLongType >(ctx, reader);
+                case type_code::int128_type:      return read_qualified< Int128Type >(ctx, reader);
+                case type_code::half_type:        return read_qualified< HalfType >(ctx, reader);
+                case type_code::bfloat16_type:    return read_qualified< BFloat16Type >(ctx, reader);
+                case type_code::float_type:       return read_qualified< FloatType >(ctx, reader);
+                case type_code::double_type:      return read_qualified< DoubleType >(ctx, reader);
+                case type_code::longdouble_type:  return read_qualified< LongDoubleType >(ctx, reader);
+                case type_code::float128_type:    return read_qualified< Float128Type >(ctx, reader);
+                case type_code::record_type:      return read_named< RecordType >(ctx, reader);
+                case type_code::enum_type:        return read_named< EnumType >(ctx, reader);
+                case type_code::typedef_type:     return read_named< TypedefType >(ctx, reader);
+                case type_code::typeof_expr_type: return read_named< TypeOfExprType >(ctx, reader);
+                case type_code::elaborated_type:  return read_wrapped< ElaboratedType >(ctx, reader);
+                case type_code::pointer_type:     return read_wrapped< PointerType >(ctx, reader);
+                case type_code::typeof_type:      return read_wrapped< TypeOfTypeType >(ctx, reader);
+                case type_code::lvalue_type:      return read_wrapped< LValueType >(ctx, reader);
+                case type_code::rvalue_type:      return read_wrapped< RValueType >(ctx, reader);
+                case type_code::reference_type:   return read_wrapped< ReferenceType >(ctx, reader);
+                case type_code::paren_type:       return read_wrapped< ParenType >(ctx, reader);
+                case type_code::decayed_type:     return read_wrapped< DecayedType >(ctx, reader);
+                case type_code::attributed_type:  return read_wrapped< AttributedType >(ctx, reader);
+                case type_code::adjusted_type: {
+                    mlir_type original, adjusted;
+                    if (mlir::failed(reader.readType(original))
+                        || mlir::failed(reader.readType(adjusted))
+                    ) {
+                        return {};
+                    }
+                    return AdjustedType::get(ctx, original, adjusted);
+                }
+                case type_code::array_type: {
+                    std::uint64_t size;
+                    mlir_type element;
+                    if (mlir::failed(reader.readVarInt(size))
+                        || mlir::failed(reader.readType(element))
+                    ) {
+                        return {};
+                    }
+                    auto dim = size ? SizeParam(size - 1) : unknown_size;
+                    return read_qualified< ArrayType >(ctx, reader, dim, element);
+                }
+                case type_code::vector_type: {
+                    std::uint64_t size;
+                    mlir_type element;
+                    if (mlir::failed(reader.readVarInt(size))
+                        || mlir::failed(reader.readType(element))
+                    ) {
+                        return {};
+                    }
+                    return read_qualified< VectorType >(ctx, reader, unsigned(size), element);
+                }
+                case type_code::label_type:
+                    return LabelType::get(ctx);
+            }
+
+            reader.emitError() << "unknown high-level type code " << code;
+            return {};
+        }
+
+        mlir::LogicalResult writeAttribute(
+            mlir_attr attr, mlir::DialectBytecodeWriter &writer
+        ) const final {
+            auto kind = [&] (attr_code code) { writer.writeVarInt(std::uint64_t(code)); };
+
+            return llvm::TypeSwitch< mlir_attr, mlir::LogicalResult >(attr)
+                .Case([&] (CVQualifiersAttr quals) {
+                    kind(attr_code::cv_qualifiers);
+                    writer.writeVarInt(qualifiers_mask(quals));
+                    return mlir::success();
+                })
+                .Case([&] (UCVQualifiersAttr quals) {
+                    kind(attr_code::ucv_qualifiers);
+                    writer.writeVarInt(qualifiers_mask(quals));
+                    return mlir::success();
+                })
+                .Case([&] (CVRQualifiersAttr quals) {
+                    kind(attr_code::cvr_qualifiers);
+                    writer.writeVarInt(qualifiers_mask(quals));
+                    return mlir::success();
+                })
+                .Case([&] (ValueRangeAttr range) {
+                    kind(attr_code::value_range);
+                    writer.writeSignedVarInt(range.getLow());
+                    writer.writeSignedVarInt(range.getHigh());
+                    return mlir::success();
+                })
+                .Default([] (mlir_attr) { return mlir::failure(); });
+        }
+
+        mlir_attr readAttribute(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            auto ctx = context();
+            switch (attr_code(code)) {
+                case attr_code::cv_qualifiers:
+                    return read_qualifiers_attr< CVQualifiersAttr >(ctx, reader);
+                case attr_code::ucv_qualifiers:
+                    return read_qualifiers_attr< UCVQualifiersAttr >(ctx, reader);
+                case attr_code::cvr_qualifiers:
+                    return read_qualifiers_attr< CVRQualifiersAttr >(ctx, reader);
+                case attr_code::value_range: {
+                    std::int64_t low, high;
+                    if (mlir::failed(reader.readSignedVarInt(low))
+                        || mlir::failed(reader.readSignedVarInt(high))
+                    ) {
+                        return {};
+                    }
+                    return ValueRangeAttr::get(ctx, low, high);
+                }
+            }
+
+            reader.emitError() << "unknown high-level attribute code " << code;
+            return {};
+        }
+    };
+
+    void HighLevelDialect::registerBytecodeInterface() {
+        addInterfaces< HighLevelBytecodeDialectInterface >();
+    }
+
+} // namespace vast::hl
@@ -55,6 +55,7 @@ namespace vast::hl
         >();
 
         addInterfaces< HighLevelOpAsmDialectInterface >();
+        registerBytecodeInterface();
     }
 
     using DialectParser = mlir::AsmParser;
@@ -369,6 +369,129 @@ namespace vast::hl
         build_region(bld, st, expr);
     }
 
+    //===----------------------------------------------------------------------===//
+    // Memory effects
+    //===----------------------------------------------------------------------===//
+
+    using effects_t = llvm::SmallVectorImpl<
+        mlir::SideEffects::EffectInstance< mlir::MemoryEffects::Effect >
+    >;
+
+    namespace
+    {
+        // Loads of volatile objects are observable, so are the ones through
+        // types whose qualifiers are known only from their declaration.
+        bool has_observable_loads(mlir_type type) {
+            if (mlir::isa< TypedefType, TypeOfExprType, TypeOfType, AttributedType, ParenType >(type)) {
+                return true;
+            }
+
+            bool observable = false;
+            type.walkImmediateSubElements(
+                [&] (mlir::Attribute attr) {
+                    if (auto quals = mlir::dyn_cast< VolatileQualifierInterface >(attr)) {
+                        observable |= quals.hasVolatile();
+                    }
+                },
+                [&] (mlir_type sub) {
+                    if (mlir::isa< ElaboratedType >(type)) {
+                        observable |= has_observable_loads(sub);
+                    }
+                }
+            );
+            return observable;
+        }
+
+        bool is_load(CastKind kind) {
+            return kind == CastKind::LValueToRValue
+                || kind == CastKind::ToVoid
+                || kind == CastKind::AtomicToNonAtomic
+                || kind == CastKind::NonAtomicToAtomic;
+        }
+
+        // Conversions that run user code or the runtime.
+        bool is_opaque(CastKind kind) {
+            return kind == CastKind::Dynamic
+                || kind == CastKind::UserDefinedConversion
+                || kind == CastKind::ConstructorConversion
+                || kind == CastKind::ARCProduceObject
+                || kind == CastKind::ARCConsumeObject
+                || kind == CastKind::ARCReclaimReturnedObject
+                || kind == CastKind::ARCExtendBlockObject
+                || kind == CastKind::CopyAndAutoreleaseBlockObject;
+        }
+
+        void cast_effects(mlir_value value, CastKind kind, effects_t &effects) {
+            auto resource = mlir::SideEffects::DefaultResource::get();
+            if (is_opaque(kind)) {
+                effects.emplace_back(mlir::MemoryEffects::Read::get(), resource);
+                effects.emplace_back(mlir::MemoryEffects::Write::get(), resource);
+                return;
+            }
+
+            auto lvalue = mlir::dyn_cast< LValueType >(value.getType());
+            if (!lvalue || !is_load(kind)) {
+                return;
+            }
+
+            auto observable = kind != CastKind::LValueToRValue
+                || has_observable_loads(lvalue.getElementType());
+
+            // Discarded values are loaded only from volatile objects.
+            if (kind == CastKind::ToVoid && !observable) {
+                return;
+            }
+
+            effects.emplace_back(mlir::MemoryEffects::Read::get(), value, resource);
+            // Atomic and volatile loads are neither merged nor removed.
+            if (observable) {
+                effects.emplace_back(mlir::MemoryEffects::Write::get(), value, resource);
+            }
+        }
+
+        // Loads may fault, the other casts may be hoisted.
+        mlir::Speculation::Speculatability cast_speculatability(mlir_value value, CastKind kind) {
+            llvm::SmallVector< mlir::SideEffects::EffectInstance< mlir::MemoryEffects::Effect >, 2 > effects;
+            cast_effects(value, kind, effects);
+            return effects.empty() ? mlir::Speculation::Speculatable : mlir::Speculation::NotSpeculatable;
+        }
+
+    } // namespace
+
+    void ImplicitCastOp::getEffects(effects_t &effects) {
+        cast_effects(getValue(), getKind(), effects);
+    }
+
+    void CStyleCastOp::getEffects(effects_t &effects) {
+        cast_effects(getValue(), getKind(), effects);
+    }
+
+    void BuiltinBitCastOp::getEffects(effects_t &effects) {
+        cast_effects(getValue(), getKind(), effects);
+    }
+
+    mlir::Speculation::Speculatability ImplicitCastOp::getSpeculatability() {
+        return cast_speculatability(getValue(), getKind());
+    }
+
+    mlir::Speculation::Speculatability CStyleCastOp::getSpeculatability() {
+        return cast_speculatability(getValue(), getKind());
+    }
+
+    mlir::Speculation::Speculatability BuiltinBitCastOp::getSpeculatability() {
+        return cast_speculatability(getValue(), getKind());
+    }
+
+    //===----------------------------------------------------------------------===//
+    // Loops
+    //===----------------------------------------------------------------------===//
+
+    // Invariant code is hoisted from the bodies, conditions and increments
+    // are evaluated between the iterations.
+    Region &WhileOp::getLoopBody() { return getBodyRegion(); }
+    Region &ForOp::getLoopBody() { return getBodyRegion(); }
+    Region &DoOp::getLoopBody() { return getBodyRegion(); }
+
     FuncOp getCallee(CallOp call)
     {
         auto coi = mlir::cast<mlir::CallOpInterface>(call.getOperation());
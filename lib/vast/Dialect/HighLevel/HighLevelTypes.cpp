@@ -158,6 +158,40 @@ namespace vast::hl
 
 using StringRef = llvm::StringRef; // to fix missing namespace in generated file
 
+namespace vast::hl
+{
+    //
+    // Hand-written format of the scalar types, `(`<` $quals^ `>`)?`. The
+    // qualifiers are parsed directly, without a detour through the generic
+    // attribute parser.
+    //
+    template< typename type_t >
+    mlir_type parse_qualified_type(mlir::AsmParser &parser) {
+        using quals_t = decltype(std::declval< type_t >().getQuals());
+
+        auto ctx = parser.getContext();
+        if (mlir::failed(parser.parseOptionalLess())) {
+            return type_t::get(ctx);
+        }
+
+        auto quals = mlir::cast< quals_t >(quals_t::parse(parser, mlir_type()));
+        if (mlir::failed(parser.parseGreater())) {
+            return {};
+        }
+        return type_t::get(ctx, quals);
+    }
+
+    template< typename type_t >
+    void print_qualified_type(mlir::AsmPrinter &printer, type_t type) {
+        if (auto quals = type.getQuals()) {
+            printer << '<';
+            quals.print(printer);
+            printer << '>';
+        }
+    }
+
+} // namespace vast::hl
+
 #define  GET_TYPEDEF_CLASSES
 #include "vast/Dialect/HighLevel/HighLevelTypes.cpp.inc"
 
@@ -0,0 +1,495 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Linker.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/IR/SymbolTable.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        string_ref declared_name(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return fn.getSymName();
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >("name")) {
+                return name.getValue();
+            }
+
+            return {};
+        }
+
+        void set_declared_name(operation op, string_ref name) {
+            if (mlir::isa< hl::FuncOp >(op)) {
+                mlir::SymbolTable::setSymbolName(op, name);
+            } else {
+                op->setAttr("name", mlir::StringAttr::get(op->getContext(), name));
+            }
+        }
+
+        // Linkage names get a `.N` suffix, which is not a valid C identifier,
+        // so they do not clash with names of the sources.
+        std::string unique_name(string_ref base, auto &&taken) {
+            for (unsigned i = 1;; ++i) {
+                auto name = (llvm::Twine(base) + "." + llvm::Twine(i)).str();
+                if (!taken(name)) {
+                    return name;
+                }
+            }
+        }
+
+        bool is_local(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                auto linkage = fn.getLinkage();
+                return linkage == core::GlobalLinkageKind::InternalLinkage
+                    || linkage == core::GlobalLinkageKind::PrivateLinkage;
+            }
+
+            auto var = mlir::cast< hl::VarDeclOp >(op);
+            return var.getStorageClass() == StorageClass::sc_static;
+        }
+
+        bool has_initializer(hl::VarDeclOp var) {
+            return !var.getInitializer().empty() || var.getInitialValue();
+        }
+
+        bool is_definition(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return !fn.isDeclaration();
+            }
+
+            auto var = mlir::cast< hl::VarDeclOp >(op);
+            return !var.hasExternalStorage() || has_initializer(var);
+        }
+
+        // Definitions that give way to another definition of the name, as
+        // weak symbols and tentative definitions do in the system linker.
+        bool is_overridable(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                using enum core::GlobalLinkageKind;
+                switch (fn.getLinkage()) {
+                    case AvailableExternallyLinkage:
+                    case LinkOnceAnyLinkage:
+                    case LinkOnceODRLinkage:
+                    case WeakAnyLinkage:
+                    case WeakODRLinkage:
+                    case CommonLinkage:
+                    case ExternalWeakLinkage:
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            return !has_initializer(mlir::cast< hl::VarDeclOp >(op));
+        }
+
+        // Rewrites names of the module being linked in `root`: named types,
+        // symbol references of calls, and `hl.globref` and `hl.enumref`.
+        void apply_renames(operation root, const auto &rn) {
+            mlir::AttrTypeReplacer replacer;
+            auto rename = [] (const llvm::StringMap< std::string > &map, string_ref name) {
+                auto it = map.find(name);
+                return it != map.end() ? std::optional< string_ref >(it->second) : std::nullopt;
+            };
+
+            replacer.addReplacement([&] (mlir_type type) -> std::optional< mlir_type > {
+                if (auto rec = mlir::dyn_cast< hl::RecordType >(type)) {
+                    if (auto name = rename(rn.records, rec.getName())) {
+                        return hl::RecordType::get(type.getContext(), *name, rec.getQuals());
+                    }
+                } else if (auto en = mlir::dyn_cast< hl::EnumType >(type)) {
+                    if (auto name = rename(rn.enums, en.getName())) {
+                        return hl::EnumType::get(type.getContext(), *name, en.getQuals());
+                    }
+                } else if (auto def = mlir::dyn_cast< hl::TypedefType >(type)) {
+                    if (auto name = rename(rn.typedefs, def.getName())) {
+                        return hl::TypedefType::get(type.getContext(), *name, def.getQuals());
+                    }
+                }
+                return std::nullopt;
+            });
+
+            replacer.addReplacement([&] (mlir::Attribute attr) -> std::optional< mlir::Attribute > {
+                if (auto ref = mlir::dyn_cast< mlir::FlatSymbolRefAttr >(attr)) {
+                    if (auto name = rename(rn.values, ref.getValue())) {
+                        return mlir::FlatSymbolRefAttr::get(attr.getContext(), *name);
+                    }
+                }
+                return std::nullopt;
+            });
+
+            replacer.recursivelyReplaceElementsIn(
+                root, /* replaceAttrs */ true, /* replaceLocs */ false, /* replaceTypes */ true
+            );
+
+            // Other string attributes are not names, e.g., of string literals.
+            root->walk([&] (operation op) {
+                if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                    if (auto name = rename(rn.values, ref.getGlobal())) {
+                        ref.setGlobal(*name);
+                    }
+                } else if (auto ref = mlir::dyn_cast< hl::EnumRefOp >(op)) {
+                    if (auto name = rename(rn.constants, ref.getValue())) {
+                        ref.setValue(*name);
+                    }
+                }
+            });
+        }
+
+        bool is_type_declaration(operation op) {
+            return mlir::isa<
+                hl::TypeDeclOp, hl::TypeDefOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+        auto enum_constants(hl::EnumDeclOp decl) {
+            return decl.getConstants().front().getOps< hl::EnumConstantOp >();
+        }
+
+    } // namespace
+
+    module_linker::module_linker(vast_module dst) : dst(dst) {
+        for (auto &op : dst.getBody()->getOperations()) {
+            index(&op);
+        }
+    }
+
+    void module_linker::index(operation op) {
+        auto name = declared_name(op);
+        llvm::TypeSwitch< operation >(op)
+            .Case< hl::TypeDeclOp >([&] (auto) { record_names.insert(name); })
+            .Case< hl::StructDeclOp, hl::UnionDeclOp >([&] (auto) {
+                record_names.insert(name);
+                records.try_emplace(name, op);
+            })
+            .Case< hl::EnumDeclOp >([&] (auto decl) {
+                enum_names.insert(name);
+                if (decl.getType()) {
+                    enums.try_emplace(name, op);
+                    for (auto constant : enum_constants(decl)) {
+                        constants.insert(constant.getName());
+                    }
+                }
+            })
+            .Case< hl::TypeDefOp >([&] (auto) { typedefs.try_emplace(name, op); })
+            .Case< hl::FuncOp, hl::VarDeclOp >([&] (auto) {
+                // A definition replaces the declarations of the name.
+                auto [it, inserted] = values.try_emplace(name, op);
+                if (!inserted && !is_definition(it->second)) {
+                    it->second = op;
+                }
+            });
+    }
+
+    void module_linker::move(operation op) {
+        op->moveBefore(dst.getBody(), dst.getBody()->end());
+        index(op);
+    }
+
+    logical_result module_linker::link(vast_module src) {
+        auto triple = core::CoreDialect::getTargetTripleAttrName();
+        auto lang   = core::CoreDialect::getLanguageAttrName();
+        for (const auto &attr : { triple, lang }) {
+            auto lhs = dst->getAttr(attr);
+            auto rhs = src->getAttr(attr);
+            if (lhs && rhs && lhs != rhs) {
+                return src.emitError() << "cannot link modules of different " << attr
+                                       << ": " << lhs << " and " << rhs;
+            }
+        }
+
+        renames rn;
+        own.clear();
+
+        // Types go first, as operations may refer to records declared later,
+        // e.g., a variable of a pointer to a forward declared record.
+        llvm::SmallVector< operation > linked_types;
+        for (auto &op : llvm::make_early_inc_range(src.getBody()->getOperations())) {
+            if (!is_type_declaration(&op)) {
+                continue;
+            }
+
+            if (!rn.empty()) {
+                apply_renames(&op, rn);
+            }
+
+            if (link_type_declaration(&op, rn)) {
+                linked_types.push_back(&op);
+            }
+        }
+
+        // Records may refer to the records renamed after them.
+        if (!rn.empty()) {
+            for (auto op : linked_types) {
+                apply_renames(op, rn);
+            }
+        }
+
+        // Names of values are decided in order, C declares them before use.
+        for (auto &op : llvm::make_early_inc_range(src.getBody()->getOperations())) {
+            if (!rn.empty()) {
+                apply_renames(&op, rn);
+            }
+
+            if (mlir::failed(link_operation(&op, rn))) {
+                return mlir::failure();
+            }
+        }
+
+        link_module_attributes(src, rn);
+        ++counts.modules;
+        return mlir::success();
+    }
+
+    bool module_linker::link_type_declaration(operation op, renames &rn) {
+        auto name = declared_name(op);
+
+        // Forward declarations are kept only for names unknown so far.
+        auto link_forward_declaration = [&] (const llvm::StringSet<> &names) {
+            if (names.contains(name)) {
+                op->erase();
+                ++counts.deduplicated;
+                return false;
+            }
+
+            move(op);
+            return true;
+        };
+
+        return llvm::TypeSwitch< operation, bool >(op)
+            .Case< hl::TypeDeclOp >([&] (auto) { return link_forward_declaration(record_names); })
+            .Case< hl::StructDeclOp, hl::UnionDeclOp >([&] (auto) {
+                return link_type(op, records, rn.records, rn);
+            })
+            .Case< hl::EnumDeclOp >([&] (auto decl) {
+                return decl.getType()
+                    ? link_type(op, enums, rn.enums, rn)
+                    : link_forward_declaration(enum_names);
+            })
+            .Case< hl::TypeDefOp >([&] (auto) { return link_type(op, typedefs, rn.typedefs, rn); });
+    }
+
+    logical_result module_linker::link_operation(operation op, renames &rn) {
+        if (mlir::isa< hl::FuncOp, hl::VarDeclOp >(op)) {
+            return link_value(op, rn);
+        }
+
+        op->moveBefore(dst.getBody(), dst.getBody()->end());
+        return mlir::success();
+    }
+
+    bool module_linker::link_type(
+        operation op, llvm::StringMap< operation > &defs,
+        llvm::StringMap< std::string > &renamed, renames &rn
+    ) {
+        auto name = declared_name(op).str();
+        if (auto it = defs.find(name); it != defs.end()) {
+            if (mlir::OperationEquivalence::isEquivalentTo(
+                    it->second, op, mlir::OperationEquivalence::IgnoreLocations
+                )
+            ) {
+                op->erase();
+                ++counts.deduplicated;
+                return false;
+            }
+
+            auto linked = unique_name(name, [&] (string_ref n) { return defs.contains(n); });
+            renamed[name] = linked;
+            set_declared_name(op, linked);
+            // Recursive references of the declaration itself.
+            apply_renames(op, rn);
+            ++counts.renamed;
+        }
+
+        if (auto decl = mlir::dyn_cast< hl::EnumDeclOp >(op)) {
+            link_enum_constants(decl, rn);
+        }
+
+        move(op);
+        return true;
+    }
+
+    void module_linker::link_enum_constants(operation op, renames &rn) {
+        bool renamed = false;
+        for (auto constant : enum_constants(mlir::cast< hl::EnumDeclOp >(op))) {
+            auto name = constant.getName();
+            if (!constants.contains(name)) {
+                continue;
+            }
+
+            auto linked = unique_name(name, [&] (string_ref n) { return constants.contains(n); });
+            rn.constants[name] = linked;
+            constant.setName(linked);
+            renamed = true;
+            ++counts.renamed;
+        }
+
+        // Initializers of constants refer to the previous constants.
+        if (renamed) {
+            apply_renames(op, rn);
+        }
+    }
+
+    logical_result module_linker::link_value(operation op, renames &rn) {
+        auto name = declared_name(op).str();
+
+        // Declared before in this module under another name.
+        if (auto it = rn.values.find(name); it != rn.values.end()) {
+            name = it->second;
+            set_declared_name(op, name);
+        }
+
+        auto existing = values.lookup(name);
+        if (!existing) {
+            move(op);
+            own.insert(name);
+            return mlir::success();
+        }
+
+        if (own.contains(name)) {
+            return merge_value(existing, op);
+        }
+
+        auto taken = [&] (string_ref n) { return values.contains(n); };
+        if (is_local(op)) {
+            auto linked = unique_name(name, taken);
+            rn.values[name] = linked;
+            set_declared_name(op, linked);
+            apply_renames(op, rn);
+            move(op);
+            own.insert(linked);
+            ++counts.renamed;
+            return mlir::success();
+        }
+
+        // An external symbol takes the name of a local symbol of a module
+        // linked before, which is renamed in its whole module, the only one
+        // referring to it.
+        if (is_local(existing)) {
+            auto linked = unique_name(name, taken);
+            renames local;
+            local.values[name] = linked;
+            apply_renames(dst.getOperation(), local);
+            set_declared_name(existing, linked);
+            values.erase(name);
+            values[linked] = existing;
+
+            move(op);
+            own.insert(name);
+            ++counts.renamed;
+            return mlir::success();
+        }
+
+        return merge_value(existing, op);
+    }
+
+    logical_result module_linker::merge_value(operation existing, operation incoming) {
+        auto name = declared_name(incoming);
+        if (existing->getName() != incoming->getName()) {
+            return incoming->emitError() << "symbol '" << name
+                                         << "' is linked with a different kind of declaration";
+        }
+
+        ++counts.merged_symbols;
+
+        auto keep_existing = [&] {
+            if (!incoming->use_empty()) {
+                incoming->replaceAllUsesWith(existing);
+            }
+            incoming->erase();
+            return mlir::success();
+        };
+
+        auto keep_incoming = [&] {
+            incoming->moveBefore(existing);
+            if (!existing->use_empty()) {
+                existing->replaceAllUsesWith(incoming);
+            }
+            existing->erase();
+            values[name] = incoming;
+            return mlir::success();
+        };
+
+        if (!is_definition(incoming)) {
+            return keep_existing();
+        }
+
+        if (!is_definition(existing)) {
+            return keep_incoming();
+        }
+
+        if (is_overridable(incoming)) {
+            return keep_existing();
+        }
+
+        if (is_overridable(existing)) {
+            return keep_incoming();
+        }
+
+        auto diag = incoming->emitError() << "redefinition of symbol '" << name << "'";
+        diag.attachNote(existing->getLoc()) << "previous definition is here";
+        return mlir::failure();
+    }
+
+    // The data layout of a module lists the types it uses, the linked module
+    // needs all of them. The table of builtin layouts is selected anew for the
+    // merged entries.
+    void module_linker::link_module_attributes(vast_module src, const renames &rn) {
+        for (auto attr : src->getAttrs()) {
+            if (attr.getName() != mlir::SymbolTable::getSymbolAttrName()
+                && attr.getName() != mlir::DLTIDialect::kDataLayoutAttrName
+                && attr.getName() != builtin_layout_table::attr_name()
+                && !dst->hasAttr(attr.getName())
+            ) {
+                dst->setAttr(attr.getName(), attr.getValue());
+            }
+        }
+
+        auto src_spec = src->getAttrOfType< mlir::DataLayoutSpecAttr >(
+            mlir::DLTIDialect::kDataLayoutAttrName
+        );
+        if (!src_spec) {
+            return select_builtin_layout(dst);
+        }
+
+        // Entries of renamed types describe the renamed declarations.
+        if (!rn.empty()) {
+            renames types = { rn.records, rn.enums, rn.typedefs, {}, {} };
+            apply_renames(src.getOperation(), types);
+            src_spec = src->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                mlir::DLTIDialect::kDataLayoutAttrName
+            );
+        }
+
+        llvm::SetVector< mlir::DataLayoutEntryInterface > entries;
+        if (auto dst_spec = dst->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                mlir::DLTIDialect::kDataLayoutAttrName
+            )
+        ) {
+            entries.insert(dst_spec.getEntries().begin(), dst_spec.getEntries().end());
+        }
+        entries.insert(src_spec.getEntries().begin(), src_spec.getEntries().end());
+
+        dst->setAttr(
+            mlir::DLTIDialect::kDataLayoutAttrName,
+            mlir::DataLayoutSpecAttr::get(dst.getContext(), entries.getArrayRef())
+        );
+        select_builtin_layout(dst);
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,85 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+
+namespace vast::hl
+{
+    // Operations, attributes and types are compared by identity, as attributes
+    // and types are uniqued.
+    llvm::hash_code type_definitions_hash(operation mod) {
+        auto hash = llvm::hash_value(mod->getAttrDictionary().getAsOpaquePointer());
+
+        for (auto &region : mod->getRegions()) {
+            for (auto &op : region.getOps()) {
+                if (!mlir::isa<
+                    hl::TypeDeclOp, hl::TypeDefOp, hl::EnumDeclOp,
+                    hl::StructDeclOp, hl::UnionDeclOp, hl::ClassDeclOp, hl::CxxStructDeclOp
+                >(op)) {
+                    continue;
+                }
+
+                op.walk([&] (operation nested) {
+                    hash = llvm::hash_combine(
+                        hash, nested,
+                        nested->getName().getAsOpaquePointer(),
+                        nested->getAttrDictionary().getAsOpaquePointer()
+                    );
+                });
+            }
+        }
+
+        return hash;
+    }
+
+    record_index::record_index(operation op)
+        : mod(op), stamp(type_definitions_hash(op))
+    {
+        for (auto &region : op->getRegions()) {
+            for (auto decl : region.getOps< hl::StructDeclOp >()) {
+                auto [it, inserted] = records.try_emplace(decl.getName());
+                if (!inserted) {
+                    continue;
+                }
+
+                auto &info = it->second;
+                info.decl = decl;
+
+                std::size_t idx = 0;
+                for (auto field : field_defs(decl)) {
+                    info.fields.try_emplace(field.getName(), field_info{ idx++, field.getType() });
+                }
+            }
+        }
+    }
+
+    auto record_index::lookup(mlir_type record) const -> const record_info * {
+        auto name = hl::name_of_record(record);
+        VAST_CHECK(name, "hl::name_of_record failed with {0}", record);
+
+        auto it = records.find(*name);
+        return it != records.end() ? &it->second : nullptr;
+    }
+
+    std::optional< hl::StructDeclOp > record_index::definition_of(mlir_type record) const {
+        if (auto info = lookup(record)) {
+            return info->decl;
+        }
+        return std::nullopt;
+    }
+
+    std::optional< std::size_t > record_index::field_idx(mlir_type record, string_ref field) const {
+        if (auto info = lookup(record)) {
+            if (auto it = info->fields.find(field); it != info->fields.end()) {
+                return it->second.idx;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool record_index::isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &) const {
+        return type_definitions_hash(mod) != stamp;
+    }
+
+} // namespace vast::hl
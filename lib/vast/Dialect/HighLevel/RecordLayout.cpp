@@ -0,0 +1,220 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/Support/MathExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/HighLevel/RecordIndex.hpp"
+#include "vast/Interfaces/DefaultDataLayoutTypeInterface.hpp"
+
+#include "vast/Util/DataLayout.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        struct size_and_align
+        {
+            std::uint64_t size;
+            std::uint64_t align;
+        };
+
+        // Entries of vast types are in bits (as in clang), builtin types follow
+        // mlir and report alignment in bytes.
+        std::uint64_t abi_align(const mlir::DataLayout &dl, mlir_type type) {
+            auto align = dl.getTypeABIAlignment(type);
+            return mlir::isa< DefaultDataLayoutTypeInterface >(type) ? align : align * 8;
+        }
+
+        bool is_packed(hl::StructDeclOp decl) {
+            return llvm::any_of(decl->getAttrs(), [] (auto attr) {
+                return mlir::isa< hl::PackedAttr >(attr.getValue());
+            });
+        }
+
+        // Record entries of the module data layout, records that are never used
+        // as a value do not have one.
+        llvm::StringMap< size_and_align > record_entries(operation op) {
+            llvm::StringMap< size_and_align > out;
+
+            auto mod = mlir::dyn_cast< vast_module >(op);
+            if (!mod || !mod.getDataLayoutSpec()) {
+                return out;
+            }
+
+            for (auto entry : mod.getDataLayoutSpec().getEntries()) {
+                auto type = mlir::dyn_cast< mlir_type >(entry.getKey());
+                if (!type || !dl::DLEntry::is_vast_entry(entry)) {
+                    continue;
+                }
+
+                if (auto name = hl::name_of_record(type)) {
+                    auto raw = dl::DLEntry(entry);
+                    out.try_emplace(*name, size_and_align{ raw.bw, raw.abi_align });
+                }
+            }
+
+            return out;
+        }
+
+        struct layout_builder
+        {
+            const mlir::DataLayout &dl;
+            const llvm::StringMap< hl::StructDeclOp > &decls;
+            const llvm::StringMap< size_and_align > &entries;
+            llvm::StringMap< record_layout > &layouts;
+
+            const record_layout &layout_of(hl::StructDeclOp decl) {
+                if (auto it = layouts.find(decl.getName()); it != layouts.end()) {
+                    return it->second;
+                }
+
+                auto entry = entries.find(decl.getName());
+                auto has_entry = entry != entries.end();
+
+                auto layout = compute(decl, is_packed(decl));
+                // Packed through a pragma or an attribute that is not attached
+                // to the definition.
+                if (has_entry && layout.size > entry->second.size) {
+                    layout = compute(decl, true);
+                }
+
+                if (has_entry) {
+                    // Clang's layout is authoritative, it accounts for attributes
+                    // that are not represented in the definition.
+                    layout.size  = entry->second.size;
+                    layout.align = entry->second.align;
+                }
+
+                std::uint64_t used = 0;
+                for (const auto &field : layout.fields) {
+                    used += field.size;
+                }
+                layout.padding = layout.size > used ? layout.size - used : 0;
+
+                assign_storage_units(layout);
+
+                return layouts.try_emplace(decl.getName(), std::move(layout)).first->second;
+            }
+
+            size_and_align field_size_and_align(mlir_type type) {
+                if (auto name = hl::name_of_record(type)) {
+                    if (auto it = decls.find(*name); it != decls.end()) {
+                        const auto &nested = layout_of(it->second);
+                        return { nested.size, nested.align };
+                    }
+                }
+
+                return { dl.getTypeSizeInBits(type), abi_align(dl, type) };
+            }
+
+            // A run ends at a field that is not a bitfield, at a zero-width
+            // bitfield, and where a bitfield is moved to the next storage unit
+            // of its type.
+            static void assign_storage_units(record_layout &layout) {
+                std::optional< std::uint64_t > run_end;
+                for (auto &field : layout.fields) {
+                    if (!field.bits || *field.bits == 0) {
+                        run_end.reset();
+                        continue;
+                    }
+
+                    if (!run_end || *run_end != field.offset) {
+                        layout.units.push_back({ llvm::alignDown(field.offset, 8), 0 });
+                    }
+
+                    auto &unit = layout.units.back();
+                    run_end    = field.offset + *field.bits;
+                    unit.size  = llvm::alignTo(*run_end - unit.offset, 8);
+                    field.unit = unsigned(layout.units.size() - 1);
+                }
+            }
+
+            record_layout compute(hl::StructDeclOp decl, bool packed) {
+                record_layout layout;
+
+                std::uint64_t offset = 0;
+                for (auto field : field_defs(decl)) {
+                    auto type = field.getType();
+                    auto [size, align] = field_size_and_align(type);
+                    std::uint64_t placement = packed ? 8 : align;
+
+                    if (auto bits = field.getBits()) {
+                        // A bitfield must not straddle a storage unit of its type,
+                        // a zero-width bitfield starts a new storage unit.
+                        if (!packed && (*bits == 0 || offset % size + *bits > size)) {
+                            offset = llvm::alignTo(offset, align);
+                        }
+
+                        layout.fields.push_back({ type, offset, *bits, bits, std::nullopt });
+                        offset += *bits;
+                    } else {
+                        offset = llvm::alignTo(offset, placement);
+                        if (offset % align != 0) {
+                            layout.has_unaligned_fields = true;
+                        }
+
+                        layout.fields.push_back({ type, offset, size, std::nullopt, std::nullopt });
+                        offset += size;
+                    }
+
+                    layout.align = std::max(layout.align, placement);
+                }
+
+                layout.size = llvm::alignTo(offset, layout.align);
+                return layout;
+            }
+        };
+
+    } // namespace
+
+    auto record_layout::field_containing(std::uint64_t offset) const -> const field_layout * {
+        for (const auto &field : fields) {
+            if (field.offset <= offset && offset < field.offset + field.size) {
+                return &field;
+            }
+        }
+        return nullptr;
+    }
+
+    record_layout_analysis::record_layout_analysis(operation op)
+        : mod(op), stamp(type_definitions_hash(op))
+    {
+        llvm::StringMap< hl::StructDeclOp > decls;
+        for (auto &region : op->getRegions()) {
+            for (auto decl : region.getOps< hl::StructDeclOp >()) {
+                decls.try_emplace(decl.getName(), decl);
+            }
+        }
+
+        auto entries = record_entries(op);
+        auto dl = mlir::DataLayout::closest(op);
+
+        layout_builder builder{ dl, decls, entries, layouts };
+        for (const auto &[_, decl] : decls) {
+            builder.layout_of(decl);
+        }
+    }
+
+    const record_layout *record_layout_analysis::lookup(mlir_type record) const {
+        auto name = hl::name_of_record(record);
+        if (!name) {
+            return nullptr;
+        }
+
+        auto it = layouts.find(*name);
+        return it != layouts.end() ? &it->second : nullptr;
+    }
+
+    bool record_layout_analysis::isInvalidated(
+        const mlir::AnalysisManager::PreservedAnalyses &
+    ) const {
+        return type_definitions_hash(mod) != stamp;
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,346 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Shard.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace vast::hl
+{
+    namespace
+    {
+        string_ref declared_name(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return fn.getSymName();
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >("name")) {
+                return name.getValue();
+            }
+
+            return {};
+        }
+
+        bool is_value(operation op) { return mlir::isa< hl::FuncOp, hl::VarDeclOp >(op); }
+
+        bool is_type_declaration(operation op) {
+            return mlir::isa<
+                hl::TypeDeclOp, hl::TypeDefOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+        bool has_initializer(hl::VarDeclOp var) {
+            return !var.getInitializer().empty() || var.getInitialValue();
+        }
+
+        bool is_definition(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return !fn.isDeclaration();
+            }
+
+            auto var = mlir::cast< hl::VarDeclOp >(op);
+            return !var.hasExternalStorage() || has_initializer(var);
+        }
+
+        // Symbols that do not outlive their shard, or may be dropped by the
+        // lowering when nothing in their shard refers to them.
+        bool is_shard_local(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                using enum core::GlobalLinkageKind;
+                switch (fn.getLinkage()) {
+                    case InternalLinkage:
+                    case PrivateLinkage:
+                    case LinkOnceAnyLinkage:
+                    case LinkOnceODRLinkage:
+                    case AvailableExternallyLinkage:
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            return mlir::cast< hl::VarDeclOp >(op).getStorageClass() == StorageClass::sc_static;
+        }
+
+        // Names the operation refers to, as the symbol dce of hl sees them.
+        // Only the signature of a declaration copy is walked, not its body.
+        void referenced_names(operation root, bool regions, auto &&yield) {
+            auto type_names = [&] (mlir_type type) {
+                type.walk([&] (mlir_type nested) {
+                    if (auto rec = mlir::dyn_cast< hl::RecordType >(nested)) {
+                        yield(rec.getName());
+                    } else if (auto en = mlir::dyn_cast< hl::EnumType >(nested)) {
+                        yield(en.getName());
+                    } else if (auto def = mlir::dyn_cast< hl::TypedefType >(nested)) {
+                        yield(def.getName());
+                    }
+                });
+            };
+
+            auto names = [&] (operation op) {
+                op->getAttrDictionary().walk(
+                    [&] (mlir::StringAttr attr) { yield(attr.getValue()); },
+                    [&] (mlir::FlatSymbolRefAttr attr) { yield(attr.getValue()); },
+                    [&] (mlir_type type) { type_names(type); }
+                );
+
+                for (auto type : op->getResultTypes()) {
+                    type_names(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            type_names(arg.getType());
+                        }
+                    }
+                }
+            };
+
+            if (regions) {
+                root->walk(names);
+            } else {
+                names(root);
+            }
+        }
+
+        std::size_t size(operation op) {
+            std::size_t ops = 0;
+            op->walk([&] (operation) { ++ops; });
+            return ops;
+        }
+
+        // How an operation of the source module is copied into a shard.
+        enum class copy_kind { whole, declaration };
+
+        struct shard_builder
+        {
+            explicit shard_builder(vast_module mod) : mod(mod) {
+                for (auto &op : mod.getBody()->getOperations()) {
+                    if (auto name = declared_name(&op); !name.empty()) {
+                        by_name[name].push_back(&op);
+                    }
+
+                    // Enumerators are referenced by name through `hl.enumref`.
+                    if (auto en = mlir::dyn_cast< hl::EnumDeclOp >(op)) {
+                        for (auto &constant : en.getConstants().getOps()) {
+                            by_name[declared_name(&constant)].push_back(&op);
+                        }
+                    }
+                }
+            }
+
+            // Largest functions first, each to the least loaded shard.
+            unsigned assign(unsigned count) {
+                std::vector< operation > fns;
+                for (auto fn : mod.getOps< hl::FuncOp >()) {
+                    if (!fn.isDeclaration()) {
+                        fns.push_back(fn);
+                    }
+                }
+
+                count = std::clamp< unsigned >(count, 1, std::max< std::size_t >(fns.size(), 1));
+
+                std::vector< std::size_t > sizes;
+                for (auto fn : fns) {
+                    sizes.push_back(size(fn));
+                }
+
+                std::vector< std::size_t > order(fns.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&] (auto a, auto b) {
+                    return sizes[a] > sizes[b];
+                });
+
+                std::vector< std::size_t > loads(count, 0);
+                for (auto i : order) {
+                    auto least = std::min_element(loads.begin(), loads.end()) - loads.begin();
+                    owner[fns[i]] = unsigned(least);
+                    loads[least] += sizes[i];
+                }
+
+                for (auto &op : mod.getBody()->getOperations()) {
+                    if (mlir::isa< hl::FuncOp >(op) || is_type_declaration(&op)) {
+                        continue;
+                    }
+
+                    if (!is_value(&op) || is_definition(&op)) {
+                        owner[&op] = 0;
+                    }
+                }
+
+                return count;
+            }
+
+            // Operations of shard `idx` and how to copy them.
+            llvm::DenseMap< operation, copy_kind > collect(unsigned idx) {
+                llvm::DenseMap< operation, copy_kind > copies;
+                llvm::SmallVector< operation > worklist;
+
+                for (auto &op : mod.getBody()->getOperations()) {
+                    if (auto it = owner.find(&op); it != owner.end() && it->second == idx) {
+                        copies[&op] = copy_kind::whole;
+                        worklist.push_back(&op);
+                    }
+                }
+
+                auto require = [&] (operation op) {
+                    auto owned = owner.find(op);
+                    bool elsewhere = is_value(op) && owned != owner.end() && owned->second != idx;
+                    auto kind = elsewhere ? copy_kind::declaration : copy_kind::whole;
+                    if (!copies.try_emplace(op, kind).second) {
+                        return;
+                    }
+
+                    if (elsewhere && is_shard_local(op)) {
+                        promoted.insert(declared_name(op));
+                    }
+
+                    if (!elsewhere) {
+                        worklist.push_back(op);
+                    } else {
+                        referenced_names(op, /* regions */ false, [&] (string_ref name) {
+                            visit(name, worklist, copies, idx);
+                        });
+                    }
+                };
+
+                while (!worklist.empty()) {
+                    auto op = worklist.pop_back_val();
+                    referenced_names(op, /* regions */ true, [&] (string_ref name) {
+                        auto it = by_name.find(name);
+                        if (it == by_name.end()) {
+                            return;
+                        }
+
+                        for (auto ref : it->second) {
+                            require(ref);
+                        }
+                    });
+                }
+
+                return copies;
+            }
+
+            // Signatures of declaration copies refer only to types.
+            void visit(
+                string_ref name, llvm::SmallVectorImpl< operation > &worklist,
+                llvm::DenseMap< operation, copy_kind > &copies, unsigned idx
+            ) {
+                auto it = by_name.find(name);
+                if (it == by_name.end()) {
+                    return;
+                }
+
+                for (auto ref : it->second) {
+                    if (is_value(ref)) {
+                        continue;
+                    }
+
+                    if (copies.try_emplace(ref, copy_kind::whole).second) {
+                        worklist.push_back(ref);
+                    }
+                }
+            }
+
+            owning_module_ref build(const llvm::DenseMap< operation, copy_kind > &copies) {
+                auto shard = owning_module_ref(vast_module::create(mod.getLoc()));
+                shard->getOperation()->setAttrs(mod->getAttrDictionary());
+
+                mlir::OpBuilder bld(shard->getBodyRegion());
+                bld.setInsertionPointToEnd(shard->getBody());
+
+                for (auto &op : mod.getBody()->getOperations()) {
+                    auto it = copies.find(&op);
+                    if (it == copies.end()) {
+                        continue;
+                    }
+
+                    bool promote = is_value(&op) && promoted.contains(declared_name(&op));
+                    if (it->second == copy_kind::whole) {
+                        auto copy = bld.clone(op);
+                        if (promote) {
+                            make_external(copy);
+                        }
+                        continue;
+                    }
+
+                    auto copy = op.cloneWithoutRegions();
+                    bld.insert(copy);
+                    make_declaration(copy);
+                }
+
+                return shard;
+            }
+
+            void make_external(operation op) {
+                if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                    fn.setLinkage(core::GlobalLinkageKind::ExternalLinkage);
+                } else {
+                    mlir::cast< hl::VarDeclOp >(op).setStorageClass(StorageClass::sc_none);
+                }
+            }
+
+            void make_declaration(operation op) {
+                if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                    fn.setLinkage(core::GlobalLinkageKind::ExternalLinkage);
+                } else {
+                    auto var = mlir::cast< hl::VarDeclOp >(op);
+                    var.setStorageClass(StorageClass::sc_extern);
+                    var.removeInitialValueAttr();
+                }
+            }
+
+            vast_module mod;
+            llvm::StringMap< llvm::SmallVector< operation, 1 > > by_name;
+            // Shard of each definition and non-declaration operation.
+            llvm::DenseMap< operation, unsigned > owner;
+            // Names of local symbols referenced across shards.
+            llvm::SetVector< string_ref > promoted;
+        };
+
+    } // namespace
+
+    std::vector< owning_module_ref > shard_module(vast_module mod, unsigned count) {
+        shard_builder builder(mod);
+        count = builder.assign(count);
+
+        // All shards are collected first, a symbol is promoted in its own
+        // shard when another one refers to it.
+        std::vector< llvm::DenseMap< operation, copy_kind > > copies;
+        for (unsigned idx = 0; idx < count; ++idx) {
+            copies.push_back(builder.collect(idx));
+        }
+
+        std::vector< owning_module_ref > shards;
+        for (const auto &shard_copies : copies) {
+            shards.push_back(builder.build(shard_copies));
+        }
+
+        if (!builder.promoted.empty()) {
+            llvm::SmallVector< mlir::Attribute > names;
+            for (auto name : builder.promoted) {
+                names.push_back(mlir::StringAttr::get(mod.getContext(), name));
+            }
+
+            auto list = mlir::ArrayAttr::get(mod.getContext(), names);
+            for (auto &shard : shards) {
+                shard->getOperation()->setAttr(shard_internal_attr, list);
+            }
+        }
+
+        return shards;
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,235 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Remarks.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        template< typename attr_t >
+        bool has_attr(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        bool is_volatile(mlir_type type) {
+            bool result = false;
+            type.walkImmediateSubElements(
+                [&] (mlir::Attribute attr) {
+                    if (auto quals = mlir::dyn_cast< VolatileQualifierInterface >(attr)) {
+                        result |= quals.hasVolatile();
+                    }
+                },
+                [] (mlir_type) {}
+            );
+            return result;
+        }
+
+        // Operations of an initializer that compute the same value wherever
+        // they are copied to, i.e., that neither read nor refer to memory.
+        bool is_constant_expression(operation op) {
+            if (op->getNumRegions() != 0 || !mlir::isMemoryEffectFree(op)) {
+                return false;
+            }
+            if (mlir::isa< hl::DeclRefOp, hl::GlobalRefOp, hl::FuncRefOp, hl::AddressOf >(op)) {
+                return false;
+            }
+            return llvm::none_of(op->getResultTypes(), [] (mlir_type type) {
+                return mlir::isa< hl::LValueType >(type);
+            });
+        }
+
+        // Symbols of globals are scoped by translation units of linked modules.
+        operation scope_of(operation op) {
+            if (auto tu = op->getParentOfType< hl::TranslationUnitOp >()) {
+                return tu;
+            }
+            return op->getParentOfType< mlir::ModuleOp >();
+        }
+
+    } // namespace
+
+    //
+    // Replaces loads of internal globals that are never written by their
+    // initial value. Internal globals are visible to the module only, so a
+    // global whose every reference is a load keeps its initial value for the
+    // whole run of the program.
+    //
+    struct HLConstantGlobals : HLConstantGlobalsBase< HLConstantGlobals >
+    {
+        using base = HLConstantGlobalsBase< HLConstantGlobals >;
+
+        struct candidate
+        {
+            hl::VarDeclOp var;
+            std::vector< hl::GlobalRefOp > refs;
+            bool written = false;
+        };
+
+        using key_t = std::pair< operation, mlir::StringAttr >;
+
+        llvm::MapVector< key_t, candidate > candidates;
+
+        bool is_candidate(hl::VarDeclOp var) {
+            if (!var.isFileVarDecl() || var.getStorageClass() != StorageClass::sc_static) {
+                return false;
+            }
+
+            if (var.getThreadStorageClass() != TSClass::tsc_none || has_attr< hl::SectionAttr >(var)) {
+                return false;
+            }
+
+            auto lvalue = mlir::dyn_cast< hl::LValueType >(var.getType());
+            if (!lvalue || is_volatile(lvalue.getElementType())) {
+                return false;
+            }
+
+            auto type  = lvalue.getElementType();
+            auto naked = getBottomTypedefType(type, getOperation());
+            if (!isIntegerType(naked) && !isBoolType(naked) && !isFloatingType(naked)) {
+                return false;
+            }
+
+            auto &init = var.getInitializer();
+            if (init.empty()) {
+                // Floats of tentative definitions are left alone, zero is
+                // materialized only for integers and booleans.
+                return !isFloatingType(naked);
+            }
+
+            if (!init.hasOneBlock()) {
+                return false;
+            }
+
+            auto &block = init.front();
+            auto yield  = mlir::dyn_cast< hl::ValueYieldOp >(block.getTerminator());
+            if (!yield || yield.getResult().getType() != type) {
+                return false;
+            }
+
+            return llvm::all_of(block.without_terminator(), [] (auto &op) {
+                return is_constant_expression(&op);
+            });
+        }
+
+        void collect() {
+            candidates.clear();
+
+            getOperation().walk([&] (hl::VarDeclOp var) {
+                if (is_candidate(var)) {
+                    key_t key = { var->getParentOp(), var.getNameAttr() };
+                    candidates[key].var = var;
+                }
+            });
+
+            getOperation().walk([&] (hl::GlobalRefOp ref) {
+                auto name = ref.getGlobalAttr();
+                auto it   = candidates.find({ scope_of(ref), name });
+                if (it == candidates.end()) {
+                    it = candidates.find({ getOperation(), name });
+                }
+                if (it == candidates.end()) {
+                    return;
+                }
+
+                // Loads are replaced by values of the type of the variable.
+                auto &c = it->second;
+                auto type = mlir::cast< hl::LValueType >(c.var.getType()).getElementType();
+                c.refs.push_back(ref);
+                if (!llvm::all_of(ref->getUsers(), [&] (operation user) {
+                    return is_load(user) && user->getResult(0).getType() == type;
+                })) {
+                    c.written = true;
+                }
+            });
+        }
+
+        mlir_value zero(Builder &bld, loc_t loc, mlir_type type) {
+            auto naked = getBottomTypedefType(type, getOperation());
+            if (isBoolType(naked)) {
+                return bld.create< hl::ConstantOp >(loc, type, false);
+            }
+
+            mlir::DataLayout dl(getOperation());
+            auto bits = dl.getTypeSizeInBits(naked);
+            return bld.create< hl::ConstantOp >(
+                loc, type, llvm::APSInt(llvm::APInt(bits, 0), isUnsigned(naked))
+            );
+        }
+
+        mlir_value initial_value(Builder &bld, hl::VarDeclOp var, mlir_type type, loc_t loc) {
+            auto &init = var.getInitializer();
+            if (init.empty()) {
+                return zero(bld, loc, type);
+            }
+
+            mlir::IRMapping mapping;
+            auto &block = init.front();
+            for (auto &op : block.without_terminator()) {
+                bld.clone(op, mapping);
+            }
+
+            auto yield = mlir::cast< hl::ValueYieldOp >(block.getTerminator());
+            return mapping.lookupOrDefault(yield.getResult());
+        }
+
+        std::size_t propagate(candidate &c) {
+            std::size_t loads = 0;
+            for (auto ref : c.refs) {
+                for (auto user : llvm::make_early_inc_range(ref->getUsers())) {
+                    Builder bld(user);
+                    auto value = initial_value(bld, c.var, user->getResult(0).getType(), user->getLoc());
+                    user->getResult(0).replaceAllUsesWith(value);
+                    user->erase();
+                    ++loads;
+                }
+                ref.erase();
+            }
+            return loads;
+        }
+
+        void runOnOperation() override {
+            collect();
+
+            for (auto &[key, c] : candidates) {
+                if (c.written || c.refs.empty()) {
+                    continue;
+                }
+
+                auto loads = propagate(c);
+                remarks::passed(c.var, getArgument(), "ConstantGlobal")
+                    << "global '" << c.var.getName() << "' is never written, "
+                    << loads << " loads are replaced by its initial value";
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLConstantGlobalsPass()
+    {
+        return std::make_unique< HLConstantGlobals >();
+    }
+
+} // namespace vast::hl
@@ -15,10 +15,13 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/Remarks.hpp"
 #include "vast/Util/Terminator.hpp"
 #include "vast/Util/TypeList.hpp"
 
+#include "vast/Dialect/Core/CoreOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
@@ -58,12 +61,15 @@ namespace vast::hl
 
         bool is_terminator_like( mlir::Operation *op )
         {
-            return is_one_of< hl::ReturnOp, hl::BreakOp, hl::ContinueOp >( op );
+            return is_one_of< hl::ReturnOp, hl::BreakOp, hl::ContinueOp, hl::BuiltinUnreachableOp >( op );
         }
 
         void simplify( mlir::Block &block )
         {
             auto breakpoint = simplify_until_terminator( block );
+            if ( breakpoint != block.end() )
+                remarks::passed( &*breakpoint, getArgument(), "UnreachableCode" )
+                    << "code after " << std::prev( breakpoint )->getName() << " is removed";
             while ( breakpoint != block.end() )
                 to_erase.emplace_back( &*( breakpoint++ ) );
         }
@@ -75,11 +81,111 @@ namespace vast::hl
             {
                 if ( is_terminator_like( &*it ) )
                     return std::next( it );
+                if ( prune( &*it ) )
+                    continue;
                 simplify( &*it );
             }
             return block.end();
         }
 
+        // Control flow of a constant condition is kept if its regions have
+        // jump targets, code outside of the region may jump into it.
+        bool kept_for_jumps( mlir::Operation *op, bool has_jumps )
+        {
+            if ( has_jumps )
+                remarks::missed( op, getArgument(), "KeptRegion" )
+                    << op->getName() << " of a constant condition is kept, its regions have jump targets";
+            return has_jumps;
+        }
+
+        // Control flow with a constant condition keeps only the code that
+        // executes. Returns true if `op` is going to be erased.
+        bool prune( mlir::Operation *op )
+        {
+            if ( auto if_op = mlir::dyn_cast< hl::IfOp >( op ) )
+                return prune_if( if_op );
+            if ( auto cond = mlir::dyn_cast< hl::CondOp >( op ) )
+                return prune_cond( cond );
+            if ( auto loop = mlir::dyn_cast< hl::WhileOp >( op ) )
+                return prune_loop( op, loop.getCondRegion() );
+            if ( auto loop = mlir::dyn_cast< hl::ForOp >( op ) )
+                return prune_loop( op, loop.getCondRegion() );
+            return false;
+        }
+
+        // The taken branch keeps its own scope.
+        bool prune_if( hl::IfOp op )
+        {
+            auto cond = constant_condition( op.getCondRegion() );
+            if ( !cond )
+                return false;
+
+            auto &taken   = *cond ? op.getThenRegion() : op.getElseRegion();
+            auto &dropped = *cond ? op.getElseRegion() : op.getThenRegion();
+            if ( kept_for_jumps( op, has_jump_targets( taken ) || has_jump_targets( dropped ) ) )
+                return false;
+
+            remarks::passed( op, getArgument(), "ConstantCondition" )
+                << "condition is always " << ( *cond ? "true" : "false" ) << ", the "
+                << ( *cond ? "else" : "then" ) << " branch is removed";
+
+            if ( !taken.empty() )
+            {
+                mlir::OpBuilder bld( op );
+                auto scope = bld.create< core::ScopeOp >( op.getLoc() );
+                scope.getBody().takeBody( taken );
+                simplify( scope );
+            }
+
+            to_erase.emplace_back( op );
+            return true;
+        }
+
+        // The taken arm is inlined in place of the conditional operator.
+        bool prune_cond( hl::CondOp op )
+        {
+            auto cond = constant_condition( op.getCondRegion() );
+            if ( !cond )
+                return false;
+
+            auto &taken = *cond ? op.getThenRegion() : op.getElseRegion();
+            if ( !taken.hasOneBlock() || kept_for_jumps( op, has_jump_targets( taken ) ) )
+                return false;
+
+            auto &block = taken.front();
+            auto yield  = mlir::dyn_cast< hl::ValueYieldOp >( block.getTerminator() );
+            if ( !yield )
+                return false;
+
+            auto value = yield.getResult();
+            op->getBlock()->getOperations().splice(
+                op->getIterator(), block.getOperations(), block.begin(), yield->getIterator()
+            );
+            op.getResult().replaceAllUsesWith( value );
+
+            to_erase.emplace_back( op );
+            return true;
+        }
+
+        // Loops whose condition is false on entry never execute, `do` loops
+        // always run their body once and are kept.
+        bool prune_loop( mlir::Operation *op, mlir::Region &cond_region )
+        {
+            auto cond = constant_condition( cond_region );
+            if ( !cond || *cond )
+                return false;
+
+            for ( auto &region : op->getRegions() )
+                if ( kept_for_jumps( op, has_jump_targets( region ) ) )
+                    return false;
+
+            remarks::passed( op, getArgument(), "DeadLoop" )
+                << "condition is false on entry, the loop is removed";
+
+            to_erase.emplace_back( op );
+            return true;
+        }
+
         void runOnOperation() override
         {
             auto root = getOperation();
@@ -3,10 +3,16 @@
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/Support/EndianStream.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/JSON.h>
+#include <llvm/Support/MathExtras.h>
 #include <llvm/Support/MemoryBuffer.h>
-#include <mlir/Analysis/DataLayoutAnalysis.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
 #include <mlir/Target/LLVMIR/Dialect/All.h>
 VAST_UNRELAX_WARNINGS
 
@@ -14,44 +20,141 @@ VAST_UNRELAX_WARNINGS
 
 #include <vast/Dialect/HighLevel/HighLevelDialect.hpp>
 #include <vast/Dialect/HighLevel/HighLevelOps.hpp>
+#include <vast/Dialect/HighLevel/RecordLayout.hpp>
 #include <vast/Util/Symbols.hpp>
 #include <vast/Util/TypeSwitch.hpp>
 
+#include <optional>
+
 namespace vast::hl
 {
-    llvm::json::Object json_type_entry(const mlir::DataLayout &dl, mlir::Type type);
+    static constexpr std::uint32_t no_index = ~std::uint32_t(0);
+
+    //
+    // Entry of the interned type table. Types refer to their element and
+    // field types by their indices in the table, so that every type is
+    // described once however many functions use it.
+    //
+    struct type_info {
+        std::string type;
+        std::optional< std::uint64_t > size;
+        std::optional< std::string > name;
+        std::uint32_t element = no_index;
+
+        struct field_info {
+            std::uint32_t type;
+            std::uint64_t offset;
+            std::optional< std::uint32_t > bits;
+        };
+
+        // Layout of a record definition, declarations have none.
+        bool has_layout = false;
+        std::uint64_t align   = 0;
+        std::uint64_t padding = 0;
+        llvm::SmallVector< field_info > fields;
+    };
+
+    struct function_info {
+        std::string name;
+        llvm::SmallVector< std::uint32_t > args;
+        llvm::SmallVector< std::uint32_t > rets;
+    };
+
+    // Lvalues and elaborated types are described as their element types.
+    static mlir::Type canonical_type(mlir::Type type) {
+        while (true) {
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type)) {
+                type = lvalue.getElementType();
+            } else if (auto elaborated = mlir::dyn_cast< hl::ElaboratedType >(type)) {
+                type = elaborated.getElementType();
+            } else {
+                return type;
+            }
+        }
+    }
+
+    //
+    // Types of the functions of a module in the order they are first seen,
+    // along with the types they refer to. Built by a single walk, after which
+    // it is only read, so that entries are computed in parallel.
+    //
+    struct type_table {
+        explicit type_table(const record_layout_analysis &records) : records(records) {}
+
+        std::uint32_t add(mlir::Type root) {
+            llvm::SmallVector< mlir::Type > worklist = { canonical_type(root) };
+            while (!worklist.empty()) {
+                auto type = worklist.pop_back_val();
+                if (!indices.try_emplace(type, std::uint32_t(types.size())).second) {
+                    continue;
+                }
+                types.push_back(type);
+
+                if (auto ptr = mlir::dyn_cast< hl::PointerType >(type)) {
+                    worklist.push_back(canonical_type(ptr.getElementType()));
+                } else if (auto record = records.lookup(type)) {
+                    for (const auto &field : record->fields) {
+                        worklist.push_back(canonical_type(field.type));
+                    }
+                }
+            }
+
+            return index_of(root);
+        }
+
+        std::uint32_t index_of(mlir::Type type) const {
+            auto it = indices.find(canonical_type(type));
+            VAST_CHECK(it != indices.end(), "type is not in the table");
+            return it->second;
+        }
+
+        llvm::ArrayRef< mlir::Type > entries() const { return types; }
+
+        const record_layout_analysis &records;
+
+      private:
+        llvm::DenseMap< mlir::Type, std::uint32_t > indices;
+        std::vector< mlir::Type > types;
+    };
+
+    //
+    // sizes of types and layouts of records
+    //
+    struct layout_info {
+        const mlir::DataLayout &dl;
+        const record_layout_analysis &records;
+        const type_table &types;
+    };
 
     //
     // generic type entry
     //
     struct TypeEntryBase {
-        llvm::json::Object raw;
+        type_info raw;
         mlir::Type type;
 
         TypeEntryBase(mlir::Type type) : type(type) {}
 
-        llvm::json::Object take() && { return std::move(raw); }
+        type_info take() && { return std::move(raw); }
 
         TypeEntryBase &name(const std::string &name) {
-            raw["type"] = name;
+            raw.type = name;
             return *this;
         }
 
-        TypeEntryBase &size(const mlir::DataLayout &dl) {
-            raw["size"] = dl.getTypeSizeInBits(type);
+        TypeEntryBase &size(const layout_info &layout) {
+            raw.size = layout.dl.getTypeSizeInBits(type);
             return *this;
         }
 
         TypeEntryBase &size(std::uint64_t s) {
-            raw["size"] = s;
+            raw.size = s;
             return *this;
         }
 
         TypeEntryBase &emit() { return *this; }
     };
 
-    TypeEntryBase type_entry(const mlir::DataLayout &dl, mlir::Type type);
-
     //
     // dialect type entry emits type mnemonic name
     //
@@ -63,7 +166,7 @@ namespace vast::hl
         DialectType in_dialect() { return type.cast< DialectType >(); }
 
         DialectTypeEntry &name() {
-            raw["type"] = in_dialect().getMnemonic();
+            raw.type = in_dialect().getMnemonic();
             return *this;
         }
 
@@ -120,8 +223,8 @@ namespace vast::hl
         using Base = WithModifiersEntry< DialectType >;
         ScalarTypeEntry(DialectType t) : Base(t) {}
 
-        TypeEntryBase &emit(const mlir::DataLayout &dl) {
-            return Base::emit().size(dl);
+        TypeEntryBase &emit(const layout_info &layout) {
+            return Base::emit().size(layout);
         }
     };
 
@@ -139,18 +242,13 @@ namespace vast::hl
         using Base::in_dialect;
         using Base::raw;
 
-        template< typename ElementTypeEntry >
-        WithElementType &element_type(ElementTypeEntry &&elem) {
-            raw["element_type"] = std::forward< ElementTypeEntry >(elem);
+        WithElementType &element_type(const layout_info &layout) {
+            raw.element = layout.types.index_of(in_dialect().getElementType());
             return *this;
         }
 
-        WithElementType &element_type(const mlir::DataLayout &dl) {
-            return element_type(json_type_entry(dl, in_dialect().getElementType()));
-        }
-
-        TypeEntryBase &emit(const mlir::DataLayout &dl) {
-            return element_type(dl).Base::emit();
+        TypeEntryBase &emit(const layout_info &layout) {
+            return element_type(layout).Base::emit();
         }
     };
 
@@ -172,80 +270,334 @@ namespace vast::hl
     PointerTypeEntry(DialectType) -> PointerTypeEntry< DialectType >;
 
     //
-    // lvalue type entry
+    // record entry with layout of its fields
     //
     template< typename DialectType >
-    struct LValueTypeEntry : DialectTypeEntry< DialectType > {
-        using Base = DialectTypeEntry< DialectType >;
-        LValueTypeEntry(DialectType t) : Base(t) {}
+    struct RecordTypeEntry : WithModifiersEntry< DialectType > {
+        using Base = WithModifiersEntry< DialectType >;
+        RecordTypeEntry(DialectType t) : Base(t) {}
 
-        using Base::raw;
         using Base::in_dialect;
+        using Base::raw;
+
+        RecordTypeEntry &fields(const layout_info &layout, const record_layout &record) {
+            for (const auto &field : record.fields) {
+                raw.fields.push_back({
+                    layout.types.index_of(field.type), field.offset, field.bits
+                });
+            }
+            return *this;
+        }
+
+        TypeEntryBase &emit(const layout_info &layout) {
+            Base::emit();
+            raw.name = in_dialect().getName().str();
+
+            // Declarations without a definition have no layout.
+            if (auto record = layout.records.lookup(in_dialect())) {
+                raw.size       = record->size;
+                raw.has_layout = true;
+                raw.align      = record->align;
+                raw.padding    = record->padding;
+                fields(layout, *record);
+            }
 
-        TypeEntryBase &emit(const mlir::DataLayout &dl) {
-            raw = type_entry(dl, in_dialect().getElementType()).raw;
             return *this;
         }
     };
 
+    template< typename DialectType >
+    RecordTypeEntry(DialectType) -> RecordTypeEntry< DialectType >;
+
     //
-    // type entry dispatcher
+    // type entry dispatcher, types are canonical
     //
-    TypeEntryBase type_entry(const mlir::DataLayout &dl, mlir::Type type) {
-        auto ptr_entry    = [&](auto ty) { return PointerTypeEntry(ty).emit(dl); };
-        auto lvalue_entry = [&](auto ty) { return LValueTypeEntry(ty).emit(dl); };
+    type_info type_entry(const layout_info &layout, mlir::Type type) {
+        auto ptr_entry    = [&](auto ty) { return PointerTypeEntry(ty).emit(layout); };
         auto void_entry   = [&](auto ty) { return VoidTypeEntry(ty).emit(); };
-        auto scalar_entry = [&](auto ty) { return ScalarTypeEntry(ty).emit(dl); };
+        auto scalar_entry = [&](auto ty) { return ScalarTypeEntry(ty).emit(layout); };
+        auto record_entry = [&](auto ty) { return RecordTypeEntry(ty).emit(layout); };
 
-        return TypeSwitch< mlir::Type, TypeEntryBase >(type)
-            .Case< hl::LValueType >(lvalue_entry)
+        TypeEntryBase entry = TypeSwitch< mlir::Type, TypeEntryBase >(type)
             .Case< hl::PointerType >(ptr_entry)
             .Case< hl::VoidType >(void_entry)
+            .Case< hl::RecordType >(record_entry)
             .Case(scalar_types{}, scalar_entry);
+        return std::move(entry).take();
     }
 
-    llvm::json::Object json_type_entry(const mlir::DataLayout &dl, mlir::Type type) {
-        return type_entry(dl, type).take();
-    }
+    //
+    // JSON output, an object of functions by their names. Records are
+    // expanded at every use, except in their own fields.
+    //
+    struct json_writer {
+        llvm::json::OStream json;
+        llvm::ArrayRef< type_info > types;
+        llvm::DenseSet< std::uint32_t > expanding = {};
+
+        // Keys are written sorted, as `llvm::json::Object` prints them.
+        void type(std::uint32_t idx, const type_info::field_info *field = nullptr) {
+            const auto &entry = types[idx];
+            json.object([&] {
+                if (entry.has_layout) {
+                    json.attribute("align", entry.align);
+                }
+
+                if (field && field->bits) {
+                    json.attribute("bits", *field->bits);
+                }
+
+                if (entry.element != no_index) {
+                    json.attributeBegin("element_type");
+                    type(entry.element);
+                    json.attributeEnd();
+                }
+
+                if (entry.has_layout && expanding.insert(idx).second) {
+                    json.attributeArray("fields", [&] {
+                        for (const auto &f : entry.fields) {
+                            type(f.type, &f);
+                        }
+                    });
+                    expanding.erase(idx);
+                }
+
+                if (entry.name) {
+                    json.attribute("name", *entry.name);
+                }
+
+                if (field) {
+                    json.attribute("offset", field->offset);
+                }
+
+                if (entry.has_layout) {
+                    json.attribute("padding", entry.padding);
+                }
+
+                if (entry.size) {
+                    json.attribute("size", *entry.size);
+                }
+
+                json.attribute("type", entry.type);
+            });
+        }
+
+        void write(llvm::ArrayRef< function_info > functions) {
+            // As keys of an object, a later function of the same name wins.
+            llvm::StringMap< const function_info * > by_name;
+            for (const auto &fn : functions) {
+                by_name[fn.name] = &fn;
+            }
+
+            std::vector< const function_info * > sorted;
+            for (const auto &entry : by_name) {
+                sorted.push_back(entry.second);
+            }
+            llvm::sort(sorted, [] (auto a, auto b) { return a->name < b->name; });
+
+            json.object([&] {
+                for (auto fn : sorted) {
+                    json.attributeObject(fn->name, [&] {
+                        json.attributeArray("args", [&] {
+                            for (auto arg : fn->args) { type(arg); }
+                        });
+                        json.attributeArray("rets", [&] {
+                            for (auto ret : fn->rets) { type(ret); }
+                        });
+                    });
+                }
+            });
+        }
+    };
+
+    //
+    // Binary output, columns of little endian integers, unaligned:
+    //
+    //   "VASTFNFO", version, number of functions, parameters, types,
+    //   fields and bytes of strings
+    //   functions: name offset, name size, first parameter, number of
+    //              arguments and of results, a column each
+    //   parameters: type, arguments of a function followed by its results
+    //   types: kind offset, kind size, name offset, name size, flags,
+    //          element, first field, number of fields, size, align, padding
+    //   fields: type, bits, offset
+    //   strings
+    //
+    // Strings are interned and referred to by their offset and size, absent
+    // indices are ~0. Functions are in the order of the module.
+    //
+    struct binary_writer {
+        static constexpr llvm::StringLiteral magic = "VASTFNFO";
+        static constexpr std::uint32_t version     = 1;
+
+        enum type_flags : std::uint32_t {
+            has_size   = 1 << 0,
+            has_layout = 1 << 1,
+            has_name   = 1 << 2,
+        };
+
+        llvm::raw_ostream &os;
+
+        struct string_entry { std::uint32_t offset, size; };
+
+        string_entry intern(string_ref str) {
+            auto [it, inserted] = interned.try_emplace(str, std::uint32_t(strings.size()));
+            if (inserted) {
+                strings.append(str.begin(), str.end());
+            }
+            return { it->second, std::uint32_t(str.size()) };
+        }
+
+        void write(llvm::ArrayRef< function_info > functions, llvm::ArrayRef< type_info > types) {
+            llvm::support::endian::Writer out(os, llvm::support::little);
+
+            auto column = [&] (auto &&range, auto &&value) {
+                for (const auto &elem : range) {
+                    out.write(value(elem));
+                }
+            };
+
+            std::vector< string_entry > fn_names, kinds, names;
+            std::vector< std::uint32_t > first_params, first_fields;
+            std::uint32_t params = 0, fields = 0;
+            for (const auto &fn : functions) {
+                fn_names.push_back(intern(fn.name));
+                first_params.push_back(params);
+                params += std::uint32_t(fn.args.size() + fn.rets.size());
+            }
+
+            for (const auto &ty : types) {
+                kinds.push_back(intern(ty.type));
+                names.push_back(ty.name ? intern(*ty.name) : string_entry{ no_index, 0 });
+                first_fields.push_back(fields);
+                fields += std::uint32_t(ty.fields.size());
+            }
+
+            os << magic;
+            out.write< std::uint32_t >({
+                version, std::uint32_t(functions.size()), params,
+                std::uint32_t(types.size()), fields, std::uint32_t(strings.size())
+            });
+
+            column(fn_names, [] (auto name) { return name.offset; });
+            column(fn_names, [] (auto name) { return name.size; });
+            column(first_params, [] (auto first) { return first; });
+            column(functions, [] (const auto &fn) { return std::uint32_t(fn.args.size()); });
+            column(functions, [] (const auto &fn) { return std::uint32_t(fn.rets.size()); });
+
+            for (const auto &fn : functions) {
+                out.write< std::uint32_t >(fn.args);
+                out.write< std::uint32_t >(fn.rets);
+            }
+
+            column(kinds, [] (auto kind) { return kind.offset; });
+            column(kinds, [] (auto kind) { return kind.size; });
+            column(names, [] (auto name) { return name.offset; });
+            column(names, [] (auto name) { return name.size; });
+            column(types, [] (const auto &ty) {
+                return std::uint32_t((ty.size ? has_size : 0)
+                    | (ty.has_layout ? has_layout : 0)
+                    | (ty.name ? has_name : 0));
+            });
+            column(types, [] (const auto &ty) { return ty.element; });
+            column(first_fields, [] (auto first) { return first; });
+            column(types, [] (const auto &ty) { return std::uint32_t(ty.fields.size()); });
+            column(types, [] (const auto &ty) { return std::uint64_t(ty.size.value_or(0)); });
+            column(types, [] (const auto &ty) { return ty.align; });
+            column(types, [] (const auto &ty) { return ty.padding; });
+
+            for (const auto &ty : types) {
+                column(ty.fields, [] (const auto &f) { return f.type; });
+            }
+            for (const auto &ty : types) {
+                column(ty.fields, [] (const auto &f) { return f.bits.value_or(no_index); });
+            }
+            for (const auto &ty : types) {
+                column(ty.fields, [] (const auto &f) { return f.offset; });
+            }
+
+            os << strings;
+        }
+
+      private:
+        llvm::StringMap< std::uint32_t > interned;
+        std::string strings;
+    };
 
     struct ExportFnInfo : ExportFnInfoBase< ExportFnInfo > {
+        // Types of a chunk share a data layout, whose caches are not safe
+        // to query concurrently.
+        static constexpr std::size_t chunk_size = 256;
+
         void runOnOperation() override {
             mlir::ModuleOp mod = this->getOperation();
 
-            llvm::json::Object top;
+            if (format != "json" && format != "binary") {
+                mod.emitError() << "unknown format of function info: " << format;
+                return signalPassFailure();
+            }
+
+            const auto &records = this->getAnalysis< record_layout_analysis >();
 
             // TODO use FunctionOpInterface instead of specific operation
+            std::vector< FuncOp > fns;
+            type_table table(records);
             util::functions(mod, [&](FuncOp fn) {
-                const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
-                const auto &dl          = dl_analysis.getAtOrAbove(mod);
-
-                llvm::json::Array args;
-                for (auto &arg_type : fn.getArgumentTypes()) {
-                    args.push_back(json_type_entry(dl, arg_type));
+                for (auto type : fn.getArgumentTypes()) {
+                    table.add(type);
                 }
-
-                llvm::json::Array rets;
-                for (auto &ret_type : fn.getResultTypes()) {
-                    rets.push_back(json_type_entry(dl, ret_type));
+                for (auto type : fn.getResultTypes()) {
+                    table.add(type);
                 }
+                fns.push_back(fn);
+            });
 
-                llvm::json::Object current;
-                current["rets"] = std::move(rets);
-                current["args"] = std::move(args);
+            auto entries = table.entries();
+            std::vector< type_info > types(entries.size());
+            auto chunks = llvm::divideCeil(entries.size(), chunk_size);
+            mlir::parallelFor(&getContext(), 0, chunks, [&] (std::size_t chunk) {
+                mlir::DataLayout dl(mod);
+                layout_info layout{ dl, records, table };
 
-                top[fn.getName().str()] = std::move(current);
+                auto end = std::min(entries.size(), (chunk + 1) * chunk_size);
+                for (auto idx = chunk * chunk_size; idx < end; ++idx) {
+                    types[idx] = type_entry(layout, entries[idx]);
+                }
             });
 
-            auto value = llvm::formatv("{0:2}", llvm::json::Value(std::move(top)));
+            std::vector< function_info > functions(fns.size());
+            mlir::parallelFor(&getContext(), 0, fns.size(), [&] (std::size_t idx) {
+                auto fn = fns[idx];
+                auto &info = functions[idx];
+                info.name = fn.getName().str();
+                for (auto type : fn.getArgumentTypes()) {
+                    info.args.push_back(table.index_of(type));
+                }
+                for (auto type : fn.getResultTypes()) {
+                    info.rets.push_back(table.index_of(type));
+                }
+            });
+
+            auto write = [&] (llvm::raw_ostream &os) {
+                if (format == "binary") {
+                    binary_writer{ os }.write(functions, types);
+                } else {
+                    json_writer{ llvm::json::OStream(os, 2), types }.write(functions);
+                }
+            };
+
             // If destination filename was supplied by the user.
             if (!this->o.empty()) {
                 std::error_code ec;
-
-                llvm::raw_fd_ostream out(this->o, ec, llvm::sys::fs::OF_Text);
-                VAST_ASSERT(!ec);
-                out << std::move(value);
+                auto flags = format == "binary" ? llvm::sys::fs::OF_None : llvm::sys::fs::OF_Text;
+                llvm::raw_fd_ostream out(this->o, ec, flags);
+                if (ec) {
+                    mod.emitError() << "cannot write function info to " << o << ": " << ec.message();
+                    return signalPassFailure();
+                }
+                write(out);
             } else {
-                llvm::outs() << std::move(value);
+                write(llvm::outs());
             }
         }
     };
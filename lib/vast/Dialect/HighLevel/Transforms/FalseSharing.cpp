@@ -0,0 +1,311 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Diagnostics.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/ADT/StringSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Functions that take a lock are assumed to run concurrently with
+        // other threads that take it.
+        bool is_lock(string_ref callee) {
+            return llvm::StringSwitch< bool >(callee)
+                .Cases("pthread_mutex_lock", "pthread_mutex_trylock", "pthread_mutex_timedlock", true)
+                .Cases("pthread_spin_lock", "pthread_spin_trylock", true)
+                .Cases("pthread_rwlock_wrlock", "pthread_rwlock_rdlock", true)
+                .Cases("mtx_lock", "mtx_trylock", "mtx_timedlock", true)
+                .Cases("EnterCriticalSection", "AcquireSRWLockExclusive", true)
+                .Default(false);
+        }
+
+        bool is_atomic(operation op) {
+            return mlir::isa<
+                hl::AtomicLoadOp, hl::AtomicStoreOp, hl::AtomicRMWOp,
+                hl::AtomicCmpXchgOp, hl::AtomicFenceOp
+            >(op);
+        }
+
+        // Address of the object an operation writes, if any.
+        std::optional< mlir_value > written_address(operation op) {
+            if (auto store = mlir::dyn_cast< hl::AtomicStoreOp >(op)) {
+                return store.getAddr();
+            }
+            if (auto rmw = mlir::dyn_cast< hl::AtomicRMWOp >(op)) {
+                return rmw.getAddr();
+            }
+            if (auto xchg = mlir::dyn_cast< hl::AtomicCmpXchgOp >(op)) {
+                return xchg.getAddr();
+            }
+
+            if (mlir::isa< hl::PostIncOp, hl::PostDecOp, hl::PreIncOp, hl::PreDecOp >(op)) {
+                return op->getOperand(0);
+            }
+
+            // Assignments, compound ones included, are `src to dst`.
+            if (op->getName().getDialectNamespace() == hl::HighLevelDialect::getDialectNamespace()
+                && op->getName().stripDialect().starts_with("assign")
+            ) {
+                return op->getOperand(1);
+            }
+
+            return std::nullopt;
+        }
+
+        // Field an address points into, e.g., `s.counts[i]` and `&p->count`.
+        hl::RecordMemberOp written_member(mlir_value addr) {
+            while (auto op = addr.getDefiningOp()) {
+                if (auto member = mlir::dyn_cast< hl::RecordMemberOp >(op)) {
+                    return member;
+                }
+
+                if (auto subscript = mlir::dyn_cast< hl::SubscriptOp >(op)) {
+                    addr = subscript.getArray();
+                    continue;
+                }
+
+                if (!mlir::isa< hl::ImplicitCastOp, hl::CStyleCastOp, hl::AddressOf >(op)) {
+                    break;
+                }
+                addr = op->getOperand(0);
+            }
+            return {};
+        }
+
+        struct field_writes
+        {
+            std::uint64_t count = 0;
+            // Written by an atomic operation or from a concurrent function.
+            bool concurrent = false;
+        };
+
+    } // namespace
+
+    //
+    // Reports fields that are written concurrently, by atomic operations or
+    // from functions that take locks or use thread-local storage, and share a
+    // cache line with other written fields of their record. As the line bounces
+    // between the cores that write either field, the writes of one thread slow
+    // down those of the others, although they never touch the same data.
+    //
+    // Global arrays of small records written concurrently are reported as
+    // well: unless an element fills whole cache lines, neighbouring elements,
+    // e.g., counters of different threads, share lines.
+    //
+    // The pass only emits warnings, the module is left as it is.
+    //
+    struct HLFalseSharing : HLFalseSharingBase< HLFalseSharing >
+    {
+        using base = HLFalseSharingBase< HLFalseSharing >;
+
+        // Writes of fields by record and field name.
+        llvm::StringMap< llvm::StringMap< field_writes > > writes;
+
+        // Members of `p->field` are of a pointer to the record.
+        std::optional< std::string > record_of(mlir_type type, vast_module mod) const {
+            type = hl::getBottomTypedefType(hl::strip_value_category(type), mod);
+            if (auto ptr = mlir::dyn_cast< hl::PointerType >(hl::strip_elaborated(type))) {
+                type = hl::getBottomTypedefType(ptr.getElementType(), mod);
+            }
+            return hl::name_of_record(type);
+        }
+
+        llvm::StringSet<> thread_locals(vast_module mod) const {
+            llvm::StringSet<> out;
+            mod.walk([&] (hl::VarDeclOp var) {
+                if (var.getStorageDuration() == StorageDuration::sd_thread) {
+                    out.insert(var.getName());
+                }
+            });
+            return out;
+        }
+
+        bool is_concurrent(hl::FuncOp fn, const llvm::StringSet<> &tls) const {
+            auto result = fn.walk([&] (operation op) {
+                if (is_atomic(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                if (auto call = mlir::dyn_cast< hl::CallOp >(op); call && is_lock(call.getCallee())) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op); ref && tls.contains(ref.getGlobal())) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        void collect_writes(vast_module mod) {
+            auto tls = thread_locals(mod);
+            mod.walk([&] (hl::FuncOp fn) {
+                bool concurrent = is_concurrent(fn, tls);
+                fn.walk([&] (operation op) {
+                    auto addr = written_address(op);
+                    if (!addr) {
+                        return;
+                    }
+
+                    auto member = written_member(*addr);
+                    if (!member) {
+                        return;
+                    }
+
+                    auto record = record_of(member.getRecord().getType(), mod);
+                    if (!record) {
+                        return;
+                    }
+
+                    auto &field = writes[*record][member.getName()];
+                    ++field.count;
+                    field.concurrent |= concurrent || is_atomic(op);
+                });
+            });
+        }
+
+        const field_writes *writes_of(string_ref record, string_ref field) const {
+            auto fields = writes.find(record);
+            if (fields == writes.end()) {
+                return nullptr;
+            }
+
+            auto it = fields->second.find(field);
+            return it != fields->second.end() ? &it->second : nullptr;
+        }
+
+        bool has_concurrent_writes(string_ref record) const {
+            auto fields = writes.find(record);
+            return fields != writes.end() && llvm::any_of(fields->second, [] (const auto &field) {
+                return field.getValue().concurrent;
+            });
+        }
+
+        // Written fields by the cache lines they cover, a field may cover more.
+        void check_record(hl::StructDeclOp decl, const record_layout &layout) {
+            std::uint64_t line_bits = cache_line * 8;
+
+            llvm::MapVector< std::uint64_t, llvm::SmallVector< hl::FieldDeclOp, 4 > > lines;
+            auto placed = layout.fields.begin();
+            for (auto field : field_defs(decl)) {
+                if (placed == layout.fields.end()) {
+                    break;
+                }
+                const auto &at = *placed++;
+
+                if (!writes_of(decl.getName(), field.getName()) || at.size == 0) {
+                    continue;
+                }
+
+                auto first = at.offset / line_bits;
+                auto last  = (at.offset + at.size - 1) / line_bits;
+                for (auto line = first; line <= last; ++line) {
+                    lines[line].push_back(field);
+                }
+            }
+
+            for (const auto &[line, fields] : lines) {
+                if (fields.size() < 2) {
+                    continue;
+                }
+
+                auto concurrent = llvm::find_if(fields, [&] (auto field) {
+                    return writes_of(decl.getName(), field.getName())->concurrent;
+                });
+
+                if (concurrent == fields.end()) {
+                    continue;
+                }
+
+                auto field = *concurrent;
+                auto diag  = mlir::emitWarning(field.getLoc())
+                    << "field '" << field.getName() << "' of '" << decl.getName()
+                    << "' is written concurrently and shares cache line " << line
+                    << " with other written fields (false sharing)";
+
+                for (auto other : fields) {
+                    if (other != field) {
+                        diag.attachNote(other.getLoc())
+                            << "'" << other.getName() << "' written "
+                            << writes_of(decl.getName(), other.getName())->count << " times";
+                    }
+                }
+                diag.attachNote(decl.getLoc()) << "consider aligning '" << field.getName()
+                    << "' to " << cache_line << " bytes, e.g., with alignas(" << cache_line << ")";
+            }
+        }
+
+        void check_array(hl::VarDeclOp var, const record_layout_analysis &layouts, vast_module mod) {
+            auto type  = hl::getBottomTypedefType(hl::strip_elaborated(var.getType()), mod);
+            auto array = mlir::dyn_cast< hl::ArrayType >(hl::strip_elaborated(type));
+            if (!array) {
+                return;
+            }
+
+            auto element = hl::getBottomTypedefType(array.getElementType(), mod);
+            auto record  = record_of(element, mod);
+            auto layout  = layouts.lookup(element);
+            if (!record || !layout || !has_concurrent_writes(*record)) {
+                return;
+            }
+
+            std::uint64_t line_bits = cache_line * 8;
+            if (layout->size >= line_bits || layout->size == 0 || layout->align >= line_bits) {
+                return;
+            }
+
+            auto diag = mlir::emitWarning(var.getLoc())
+                << "elements of '" << var.getName() << "' (" << layout->size / 8
+                << " bytes of '" << *record << "') are written concurrently and share "
+                << cache_line << " byte cache lines (false sharing)";
+            diag.attachNote(var.getLoc()) << "consider padding '" << *record << "' to "
+                << cache_line << " bytes, e.g., with alignas(" << cache_line << ")";
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            writes.clear();
+            collect_writes(mod);
+
+            const auto &layouts = getAnalysis< record_layout_analysis >();
+            for (auto decl : mod.getOps< hl::StructDeclOp >()) {
+                if (auto layout = layouts.lookup(hl::RecordType::get(&getContext(), decl.getName()))) {
+                    check_record(decl, *layout);
+                }
+            }
+
+            mod.walk([&] (hl::VarDeclOp var) {
+                if (var.hasGlobalStorage() && var.getStorageDuration() != StorageDuration::sd_thread) {
+                    check_array(var, layouts, mod);
+                }
+            });
+
+            markAllAnalysesPreserved();
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLFalseSharingPass()
+    {
+        return std::make_unique< HLFalseSharing >();
+    }
+
+} // namespace vast::hl
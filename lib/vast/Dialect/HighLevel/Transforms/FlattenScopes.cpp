@@ -0,0 +1,96 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Block.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Terminator.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Operations whose meaning depends on the scope they are in, i.e.,
+        // variables with a lifetime, labels and local types.
+        bool is_scoped(operation op) {
+            return mlir::isa<
+                hl::VarDeclOp, hl::LabelDeclOp, hl::LabelStmt,
+                hl::TypeDeclOp, hl::TypeDefOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+    } // namespace
+
+    struct FlattenScopes : FlattenScopesBase< FlattenScopes >
+    {
+        using base = FlattenScopesBase< FlattenScopes >;
+
+        static bool is_last(operation op) {
+            return op->getNextNode() == nullptr;
+        }
+
+        // A scope is inlined into its parent block if nothing in it depends
+        // on the scope. A scope that leaves the parent, e.g., by `hl.return`
+        // or `hl.break`, is inlined only at the end of the parent block, so
+        // that the terminator stays last.
+        static bool can_flatten(core::ScopeOp scope) {
+            auto &body = scope.getBody();
+            if (body.empty()) {
+                return true;
+            }
+
+            if (!body.hasOneBlock()) {
+                return false;
+            }
+
+            for (auto &op : body.front()) {
+                if (is_scoped(&op)) {
+                    return false;
+                }
+
+                if (any_terminator_t::is(&op) && !is_last(scope)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        static void flatten(core::ScopeOp scope) {
+            auto &body = scope.getBody();
+            if (!body.empty()) {
+                auto &ops = scope->getBlock()->getOperations();
+                ops.splice(scope->getIterator(), body.front().getOperations());
+            }
+            scope.erase();
+        }
+
+        void runOnOperation() override
+        {
+            // Innermost scopes come first, so that a scope is checked once its
+            // nested scopes are already inlined into it.
+            std::vector< core::ScopeOp > scopes;
+            getOperation()->walk([&] (core::ScopeOp scope) { scopes.push_back(scope); });
+
+            for (auto scope : scopes) {
+                if (can_flatten(scope)) {
+                    flatten(scope);
+                }
+            }
+        }
+    };
+} // namespace vast::hl
+
+std::unique_ptr< mlir::Pass > vast::hl::createFlattenScopesPass()
+{
+    return std::make_unique< vast::hl::FlattenScopes >();
+}
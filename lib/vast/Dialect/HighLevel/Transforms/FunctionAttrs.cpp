@@ -0,0 +1,449 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Analysis/CallGraph.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/StringExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Analysis.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Remarks.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Accesses of the memory a pointer parameter points to.
+        struct param_info
+        {
+            bool read    = false;
+            bool write   = false;
+            bool capture = false;
+
+            static param_info unknown() { return { true, true, true }; }
+
+            void join(const param_info &other) {
+                read    |= other.read;
+                write   |= other.write;
+                capture |= other.capture;
+            }
+
+            bool operator==(const param_info &) const = default;
+        };
+
+        // Effects of a function on memory that is not its own, i.e., on
+        // anything but its locals and parameters.
+        struct function_info
+        {
+            bool read      = false;
+            bool write     = false;
+            bool may_throw = false;
+            std::vector< param_info > params;
+
+            static function_info unknown(std::size_t params) {
+                return { true, true, true, std::vector< param_info >(params, param_info::unknown()) };
+            }
+
+            bool operator==(const function_info &) const = default;
+        };
+
+        template< typename attr_t >
+        bool has_attr(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        // Definitions that may be replaced at link time say nothing about
+        // the function that is called.
+        bool is_interposable(hl::FuncOp fn) {
+            switch (fn.getLinkage()) {
+                case core::GlobalLinkageKind::LinkOnceAnyLinkage:
+                case core::GlobalLinkageKind::WeakAnyLinkage:
+                case core::GlobalLinkageKind::ExternalWeakLinkage:
+                case core::GlobalLinkageKind::CommonLinkage:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Types that the ABI lowering passes as they are, so that indices of
+        // source parameters stay the indices of the llvm ones.
+        bool is_direct(mlir_type type) {
+            return mlir::isa<
+                hl::VoidType, hl::BoolType, hl::CharType, hl::ShortType, hl::IntType,
+                hl::LongType, hl::LongLongType, hl::FloatType, hl::DoubleType, hl::PointerType
+            >(type);
+        }
+
+        bool has_direct_signature(hl::FuncOp fn) {
+            auto type = fn.getFunctionType();
+            return llvm::all_of(type.getInputs(), is_direct) && llvm::all_of(type.getResults(), is_direct);
+        }
+
+        bool is_store(operation op) { return mlir::isa< hl::AssignOp >(op); }
+
+        // Assignments that read their destination as well.
+        bool is_update(operation op) {
+            return mlir::isa<
+                hl::AddIAssignOp, hl::AddFAssignOp, hl::SubIAssignOp, hl::SubFAssignOp,
+                hl::MulIAssignOp, hl::MulFAssignOp, hl::DivSAssignOp, hl::DivUAssignOp,
+                hl::DivFAssignOp, hl::RemSAssignOp, hl::RemUAssignOp, hl::RemFAssignOp,
+                hl::BinAndAssignOp, hl::BinOrAssignOp, hl::BinXorAssignOp,
+                hl::BinShlAssignOp, hl::BinLShrAssignOp, hl::BinAShrAssignOp,
+                hl::PostIncOp, hl::PostDecOp, hl::PreIncOp, hl::PreDecOp
+            >(op);
+        }
+
+        // Destination of a store or an update.
+        mlir_value destination(operation op) {
+            if (mlir::isa< hl::PostIncOp, hl::PostDecOp, hl::PreIncOp, hl::PreDecOp >(op)) {
+                return op->getOperand(0);
+            }
+            // Assignments take the source first.
+            return op->getOperand(1);
+        }
+
+        // Pointer arithmetic yields a pointer into the same object.
+        bool is_pointer_arith(operation op) {
+            return mlir::isa< hl::AddIOp, hl::SubIOp >(op)
+                && mlir::isa< hl::PointerType >(op->getResult(0).getType());
+        }
+
+        // Whether an lvalue or the object a pointer points to is a local of
+        // the function, i.e., a local variable or a parameter.
+        bool is_local_lvalue(mlir_value lvalue);
+
+        bool is_local_pointer(mlir_value ptr) {
+            auto def = ptr.getDefiningOp();
+            if (!def) {
+                return false;
+            }
+
+            if (is_cast(def, hl::CastKind::BitCast, hl::CastKind::NoOp)) {
+                return is_local_pointer(def->getOperand(0));
+            }
+            if (is_cast(def, hl::CastKind::ArrayToPointerDecay) || mlir::isa< hl::AddressOf >(def)) {
+                return is_local_lvalue(def->getOperand(0));
+            }
+            if (is_pointer_arith(def)) {
+                auto base = llvm::find_if(def->getOperands(), [] (mlir_value operand) {
+                    return mlir::isa< hl::PointerType >(operand.getType());
+                });
+                return base != def->operand_end() && is_local_pointer(*base);
+            }
+            return false;
+        }
+
+        bool is_local_lvalue(mlir_value lvalue) {
+            auto def = lvalue.getDefiningOp();
+            if (!def) {
+                return false;
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::DeclRefOp >(def)) {
+                if (mlir::isa< mlir::BlockArgument >(ref.getDecl())) {
+                    return true;
+                }
+                auto var = ref.getDecl().getDefiningOp< hl::VarDeclOp >();
+                return var && var.hasLocalStorage();
+            }
+            if (mlir::isa< hl::RecordMemberOp >(def)) {
+                return is_local_lvalue(def->getOperand(0));
+            }
+            if (mlir::isa< hl::SubscriptOp, hl::Deref >(def)) {
+                return is_local_pointer(def->getOperand(0));
+            }
+            return false;
+        }
+
+        // Operations that access no memory by themselves: structure, control
+        // flow and pure computations. Memory accesses of nested operations
+        // are found by the walk.
+        bool is_inert(operation op) {
+            return mlir::isMemoryEffectFree(op)
+                || op->getNumRegions() != 0
+                || op->hasTrait< mlir::OpTrait::IsTerminator >()
+                || mlir::isa< hl::BuiltinUnreachableOp, hl::BuiltinAssumeOp, hl::BuiltinPrefetchOp >(op);
+        }
+
+    } // namespace
+
+    struct HLFunctionAttrs : HLFunctionAttrsBase< HLFunctionAttrs >
+    {
+        using base = HLFunctionAttrsBase< HLFunctionAttrs >;
+
+        llvm::DenseMap< operation, function_info > summaries;
+
+        const symbol_table_analysis *symbols = nullptr;
+
+        hl::FuncOp callee(hl::CallOp call) {
+            return symbols->lookup< hl::FuncOp >(call.getCallee());
+        }
+
+        // What a call of `fn` does, by the summary of a definition or by the
+        // attributes of a declaration.
+        function_info effects_of(hl::FuncOp fn) {
+            auto params = fn ? fn.getFunctionType().getInputs().size() : 0;
+            if (fn) {
+                if (auto it = summaries.find(fn); it != summaries.end()) {
+                    return it->second;
+                }
+            }
+
+            auto info = function_info::unknown(params);
+            if (!fn) {
+                return info;
+            }
+
+            if (has_attr< hl::ConstAttr >(fn)) {
+                info.read = info.write = false;
+            } else if (has_attr< hl::PureAttr >(fn)) {
+                info.write = false;
+            }
+            info.may_throw = !has_attr< hl::NoThrowAttr >(fn);
+            return info;
+        }
+
+        // Uses of an lvalue of the memory a pointer parameter points to.
+        void lvalue_uses(mlir_value lvalue, param_info &info) {
+            for (auto &use : lvalue.getUses()) {
+                auto user = use.getOwner();
+
+                if (is_load(user)) {
+                    info.read = true;
+                } else if (is_store(user) && destination(user) == lvalue) {
+                    info.write = true;
+                } else if (is_update(user) && destination(user) == lvalue) {
+                    info.read = info.write = true;
+                } else if (is_store(user) || is_update(user)) {
+                    // An lvalue source is read.
+                    info.read = true;
+                } else if (mlir::isa< hl::RecordMemberOp >(user)) {
+                    lvalue_uses(user->getResult(0), info);
+                } else if (is_cast(user, hl::CastKind::ArrayToPointerDecay) || mlir::isa< hl::AddressOf >(user)) {
+                    pointer_uses(user->getResult(0), info);
+                } else {
+                    info.join(param_info::unknown());
+                }
+            }
+        }
+
+        // Uses of a pointer derived from a pointer parameter.
+        void pointer_uses(mlir_value ptr, param_info &info) {
+            for (auto &use : ptr.getUses()) {
+                auto user = use.getOwner();
+                auto idx  = use.getOperandNumber();
+
+                if (is_cast(user, hl::CastKind::BitCast, hl::CastKind::NoOp) || is_pointer_arith(user)) {
+                    pointer_uses(user->getResult(0), info);
+                } else if (is_cast(user, hl::CastKind::PointerToBoolean) || mlir::isa< hl::CmpOp, hl::LNotOp >(user)) {
+                    continue;
+                } else if (mlir::isa< hl::SubscriptOp >(user) && idx == 0) {
+                    lvalue_uses(user->getResult(0), info);
+                } else if (mlir::isa< hl::Deref >(user)) {
+                    lvalue_uses(user->getResult(0), info);
+                } else if (mlir::isa< hl::BuiltinMemsetOp >(user) && idx == 0 && user->use_empty()) {
+                    info.write = true;
+                } else if (mlir::isa< hl::BuiltinMemcpyOp >(user) && idx < 2 && user->use_empty()) {
+                    (idx == 0 ? info.write : info.read) = true;
+                } else if (auto call = mlir::dyn_cast< hl::CallOp >(user)) {
+                    auto callee_info = effects_of(callee(call));
+                    info.join(idx < callee_info.params.size() ? callee_info.params[idx] : param_info::unknown());
+                } else {
+                    info.join(param_info::unknown());
+                }
+            }
+        }
+
+        // A pointer parameter that is only read keeps the pointer it was
+        // called with, anything else learns nothing.
+        param_info analyze_param(hl::FuncOp fn, unsigned idx) {
+            if (!mlir::isa< hl::PointerType >(fn.getFunctionType().getInputs()[idx])) {
+                return {};
+            }
+
+            param_info info;
+            for (auto user : fn.getArgument(idx).getUsers()) {
+                if (!mlir::isa< hl::DeclRefOp >(user)) {
+                    return param_info::unknown();
+                }
+                for (auto load : user->getUsers()) {
+                    if (!is_load(load)) {
+                        return param_info::unknown();
+                    }
+                    pointer_uses(load->getResult(0), info);
+                }
+            }
+            return info;
+        }
+
+        function_info analyze(hl::FuncOp fn) {
+            auto params = fn.getFunctionType().getInputs().size();
+            if (is_interposable(fn) || fn.isVarArg()) {
+                return function_info::unknown(params);
+            }
+
+            function_info info;
+            auto access = [&] (mlir_value lvalue, bool read, bool write) {
+                if (!is_local_lvalue(lvalue)) {
+                    info.read  |= read;
+                    info.write |= write;
+                }
+            };
+
+            fn.getBody().walk([&] (operation op) {
+                if (is_load(op)) {
+                    access(op->getOperand(0), true, false);
+                } else if (is_store(op)) {
+                    access(destination(op), false, true);
+                } else if (is_update(op)) {
+                    access(destination(op), true, true);
+                } else if (auto call = mlir::dyn_cast< hl::CallOp >(op)) {
+                    auto callee_info = effects_of(callee(call));
+                    info.read      |= callee_info.read;
+                    info.write     |= callee_info.write;
+                    info.may_throw |= callee_info.may_throw;
+                } else if (mlir::isa< hl::BuiltinMemsetOp, hl::BuiltinMemcpyOp >(op)) {
+                    if (!is_local_pointer(op->getOperand(0))) {
+                        info.write = true;
+                    }
+                    if (mlir::isa< hl::BuiltinMemcpyOp >(op) && !is_local_pointer(op->getOperand(1))) {
+                        info.read = true;
+                    }
+                } else if (!is_inert(op)) {
+                    info.read = info.write = true;
+                    info.may_throw |= mlir::isa< hl::IndirectCallOp >(op);
+                }
+            });
+
+            for (unsigned idx = 0; idx < params; ++idx) {
+                info.params.push_back(analyze_param(fn, idx));
+            }
+            return info;
+        }
+
+        // Functions of a cycle of calls start from no effects and are
+        // reanalyzed until their summaries are stable, the summaries only
+        // grow.
+        void analyze(llvm::ArrayRef< hl::FuncOp > scc) {
+            for (auto fn : scc) {
+                summaries[fn] = function_info{
+                    false, false, false, std::vector< param_info >(fn.getFunctionType().getInputs().size())
+                };
+            }
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto fn : scc) {
+                    auto info = analyze(fn);
+                    if (info != summaries[fn]) {
+                        summaries[fn] = std::move(info);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        void annotate(hl::FuncOp fn, const function_info &info) {
+            auto ctx = &getContext();
+            llvm::SmallVector< string_ref, 4 > inferred;
+
+            if (!info.read && !info.write && !has_attr< hl::ConstAttr >(fn)) {
+                fn->setAttr("const", hl::ConstAttr::get(ctx));
+                inferred.push_back("const");
+            } else if (!info.write && !has_attr< hl::ConstAttr >(fn) && !has_attr< hl::PureAttr >(fn)) {
+                fn->setAttr("pure", hl::PureAttr::get(ctx));
+                inferred.push_back("pure");
+            }
+
+            if (!info.may_throw && !has_attr< hl::NoThrowAttr >(fn)) {
+                fn->setAttr("nothrow", hl::NoThrowAttr::get(ctx));
+                inferred.push_back("nothrow");
+            }
+
+            if (has_direct_signature(fn)) {
+                auto unit = mlir::UnitAttr::get(ctx);
+                for (auto [idx, param] : llvm::enumerate(info.params)) {
+                    if (!mlir::isa< hl::PointerType >(fn.getFunctionType().getInputs()[idx])) {
+                        continue;
+                    }
+
+                    if (!param.capture) {
+                        fn.setArgAttr(idx, mlir::LLVM::LLVMDialect::getNoCaptureAttrName(), unit);
+                    }
+                    if (!param.read && !param.write) {
+                        fn.setArgAttr(idx, mlir::LLVM::LLVMDialect::getReadnoneAttrName(), unit);
+                    } else if (!param.write) {
+                        fn.setArgAttr(idx, mlir::LLVM::LLVMDialect::getReadonlyAttrName(), unit);
+                    } else if (!param.read) {
+                        fn.setArgAttr(idx, mlir::LLVM::LLVMDialect::getWriteOnlyAttrName(), unit);
+                    }
+                }
+            }
+
+            if (!inferred.empty()) {
+                remarks::passed(fn, getArgument(), "InferredAttrs")
+                    << "function '" << fn.getName() << "' is inferred "
+                    << llvm::join(inferred, ", ");
+            }
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+            symbols = &getAnalysis< symbol_table_analysis >();
+            summaries.clear();
+
+            // The call graph is visited bottom-up, callees before callers.
+            mlir::CallGraph cg(mod);
+            llvm::SmallVector< hl::FuncOp > order;
+            using scc_iterator = llvm::scc_iterator< const mlir::CallGraph * >;
+            for (auto it = scc_iterator::begin(&cg); !it.isAtEnd(); ++it) {
+                llvm::SmallVector< hl::FuncOp > scc;
+                for (auto node : *it) {
+                    if (node->isExternal()) {
+                        continue;
+                    }
+                    auto fn = mlir::dyn_cast< hl::FuncOp >(node->getCallableRegion()->getParentOp());
+                    if (fn && !fn.isDeclaration()) {
+                        scc.push_back(fn);
+                    }
+                }
+
+                analyze(scc);
+                order.append(scc.begin(), scc.end());
+            }
+
+            for (auto fn : order) {
+                if (!is_interposable(fn)) {
+                    annotate(fn, summaries[fn]);
+                }
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLFunctionAttrsPass()
+    {
+        return std::make_unique< HLFunctionAttrs >();
+    }
+
+} // namespace vast::hl
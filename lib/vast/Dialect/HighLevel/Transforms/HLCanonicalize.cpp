@@ -4,30 +4,344 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/PatternMatch.h>
+#include <llvm/ADT/APSInt.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/TypeSwitch.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
+#include "vast/Util/DataLayout.hpp"
 #include "vast/Util/DialectConversion.hpp"
 
 #include "vast/Conversion/Common/Types.hpp"
 #include "vast/Conversion/Common/Rewriter.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
 #include "vast/Dialect/Core/CoreOps.hpp"
 
 #include "PassesDetails.hpp"
 
 namespace vast::hl
 {
+    namespace
+    {
+        std::optional< llvm::APInt > fold_binary(
+            operation op, const llvm::APInt &lhs, const llvm::APInt &rhs
+        ) {
+            using result_t = std::optional< llvm::APInt >;
+            auto width = lhs.getBitWidth();
+            auto valid_shift = rhs.ult(width);
+
+            return llvm::TypeSwitch< operation, result_t >(op)
+                .Case< hl::AddIOp >([&] (auto) { return lhs + rhs; })
+                .Case< hl::SubIOp >([&] (auto) { return lhs - rhs; })
+                .Case< hl::MulIOp >([&] (auto) { return lhs * rhs; })
+                .Case< hl::DivSOp >([&] (auto) -> result_t {
+                    if (rhs.isZero() || (lhs.isMinSignedValue() && rhs.isAllOnes()))
+                        return std::nullopt;
+                    return lhs.sdiv(rhs);
+                })
+                .Case< hl::DivUOp >([&] (auto) -> result_t {
+                    if (rhs.isZero())
+                        return std::nullopt;
+                    return lhs.udiv(rhs);
+                })
+                .Case< hl::RemSOp >([&] (auto) -> result_t {
+                    if (rhs.isZero() || (lhs.isMinSignedValue() && rhs.isAllOnes()))
+                        return std::nullopt;
+                    return lhs.srem(rhs);
+                })
+                .Case< hl::RemUOp >([&] (auto) -> result_t {
+                    if (rhs.isZero())
+                        return std::nullopt;
+                    return lhs.urem(rhs);
+                })
+                .Case< hl::BinAndOp >([&] (auto) { return lhs & rhs; })
+                .Case< hl::BinOrOp >([&] (auto) { return lhs | rhs; })
+                .Case< hl::BinXorOp >([&] (auto) { return lhs ^ rhs; })
+                .Case< hl::BinShlOp >([&] (auto) -> result_t {
+                    return valid_shift ? result_t(lhs.shl(rhs)) : std::nullopt;
+                })
+                .Case< hl::BinLShrOp >([&] (auto) -> result_t {
+                    return valid_shift ? result_t(lhs.lshr(rhs)) : std::nullopt;
+                })
+                .Case< hl::BinAShrOp >([&] (auto) -> result_t {
+                    return valid_shift ? result_t(lhs.ashr(rhs)) : std::nullopt;
+                })
+                .Default([] (auto) { return std::nullopt; });
+        }
+
+        bool compare(hl::Predicate predicate, const llvm::APInt &lhs, const llvm::APInt &rhs) {
+            switch (predicate) {
+                case hl::Predicate::eq:  return lhs.eq(rhs);
+                case hl::Predicate::ne:  return lhs.ne(rhs);
+                case hl::Predicate::slt: return lhs.slt(rhs);
+                case hl::Predicate::sle: return lhs.sle(rhs);
+                case hl::Predicate::sgt: return lhs.sgt(rhs);
+                case hl::Predicate::sge: return lhs.sge(rhs);
+                case hl::Predicate::ult: return lhs.ult(rhs);
+                case hl::Predicate::ule: return lhs.ule(rhs);
+                case hl::Predicate::ugt: return lhs.ugt(rhs);
+                case hl::Predicate::uge: return lhs.uge(rhs);
+            }
+            VAST_UNREACHABLE("unknown predicate");
+        }
+
+    } // namespace
 
     struct HLCanonicalize : HLCanonicalizeBase< HLCanonicalize > {
         using base = HLCanonicalizeBase< HLCanonicalize >;
         using rewriter_t = conv::rewriter_wrapper_t< mlir::IRRewriter >;
 
         std::vector< operation > to_remove;
+
+        struct size_and_align
+        {
+            std::uint64_t size;
+            std::uint64_t align;
+        };
+
+        // Module data layout entries of vast types, in bits.
+        llvm::DenseMap< mlir_type, size_and_align > layouts;
+
+        void collect_layouts(operation op) {
+            auto mod = mlir::dyn_cast< vast_module >(op);
+            if (!mod || !mod.getDataLayoutSpec())
+                return;
+
+            for (auto entry : mod.getDataLayoutSpec().getEntries()) {
+                if (!mlir::isa< mlir_type >(entry.getKey()) || !dl::DLEntry::is_vast_entry(entry))
+                    continue;
+                auto raw = dl::DLEntry(entry);
+                layouts.try_emplace(raw.type, size_and_align{ raw.bw, raw.abi_align });
+            }
+        }
+
+        // Arrays of a known size need no entry of their own.
+        std::optional< size_and_align > layout_of(mlir_type type) const {
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type))
+                return layout_of(lvalue.getElementType());
+
+            if (auto it = layouts.find(type); it != layouts.end())
+                return it->second;
+
+            if (auto array = mlir::dyn_cast< hl::ArrayType >(type)) {
+                auto element = layout_of(array.getElementType());
+                if (!element || !array.getSize())
+                    return std::nullopt;
+                return size_and_align{ element->size * *array.getSize(), element->align };
+            }
+
+            return std::nullopt;
+        }
+
+        static mlir_type argument_type(auto op) {
+            if constexpr (std::is_same_v< decltype(op), hl::SizeOfTypeOp >
+                       || std::is_same_v< decltype(op), hl::AlignOfTypeOp >
+            ) {
+                return op.getArg();
+            } else {
+                auto &block = op.getExpr().front();
+                if (block.empty() || block.back().getNumOperands() != 1)
+                    return {};
+                return block.back().getOperand(0).getType();
+            }
+        }
+
+        // Replaces the trait by a constant, the argument of an expression trait
+        // is not evaluated. Variable length arrays have no entry and are kept.
+        template< typename op_t >
+        void fold_trait(op_t op, rewriter_t &rewriter, bool is_size) {
+            auto type = argument_type(op);
+            if (!type)
+                return;
+
+            auto layout = layout_of(type);
+            auto result = layout_of(op.getType());
+            if (!layout || !result)
+                return;
+
+            auto bytes = (is_size ? layout->size : layout->align) / 8;
+            auto value = llvm::APSInt(llvm::APInt(unsigned(result->size), bytes), true);
+
+            auto g = rewriter.guard();
+            rewriter->setInsertionPoint(op);
+            auto folded = rewriter->create< hl::ConstantOp >(op.getLoc(), op.getType(), value);
+            op.getResult().replaceAllUsesWith(folded.getResult());
+            to_remove.emplace_back(op);
+        }
+
+        // Returns true if the operation was folded and must not be visited.
+        bool fold_type_traits(operation op, rewriter_t &rewriter) {
+            auto before = to_remove.size();
+            if (auto size = mlir::dyn_cast< hl::SizeOfTypeOp >(op))
+                fold_trait(size, rewriter, true);
+            else if (auto size = mlir::dyn_cast< hl::SizeOfExprOp >(op))
+                fold_trait(size, rewriter, true);
+            else if (auto align = mlir::dyn_cast< hl::AlignOfTypeOp >(op))
+                fold_trait(align, rewriter, false);
+            else if (auto align = mlir::dyn_cast< hl::AlignOfExprOp >(op))
+                fold_trait(align, rewriter, false);
+            return to_remove.size() != before;
+        }
+
+        std::optional< unsigned > int_width(mlir_type type) const {
+            if (!hl::isIntegerType(type))
+                return std::nullopt;
+            if (auto layout = layout_of(type))
+                return unsigned(layout->size);
+            return std::nullopt;
+        }
+
+        void replace_by_constant(
+            operation op, mlir_type type, const llvm::APInt &value, rewriter_t &rewriter
+        ) {
+            auto g = rewriter.guard();
+            rewriter->setInsertionPoint(op);
+            auto folded = [&] {
+                if (hl::isBoolType(type))
+                    return rewriter->create< hl::ConstantOp >(op->getLoc(), type, !value.isZero());
+                auto is_unsigned = !hl::isSigned(type);
+                return rewriter->create< hl::ConstantOp >(
+                    op->getLoc(), type, llvm::APSInt(value, is_unsigned)
+                );
+            } ();
+            op->getResult(0).replaceAllUsesWith(folded.getResult());
+            to_remove.emplace_back(op);
+        }
+
+        void replace_by_value(operation op, mlir_value value) {
+            op->getResult(0).replaceAllUsesWith(value);
+            to_remove.emplace_back(op);
+        }
+
+        void fold_arithmetic(operation op, rewriter_t &rewriter) {
+            auto type  = op->getResult(0).getType();
+            auto width = int_width(type);
+            auto lhs   = constant_int(op->getOperand(0));
+            auto rhs   = constant_int(op->getOperand(1));
+            if (!width || !lhs || !rhs || lhs->getBitWidth() != *width)
+                return;
+
+            // Shift amounts have a type of their own.
+            auto amount = rhs->extOrTrunc(*width);
+            if (auto value = fold_binary(op, *lhs, amount)) {
+                replace_by_constant(op, type, *value, rewriter);
+            }
+        }
+
+        void fold_compare(hl::CmpOp op, rewriter_t &rewriter) {
+            auto type = op.getType();
+            auto lhs  = constant_int(op.getLhs());
+            auto rhs  = constant_int(op.getRhs());
+            if (!lhs || !rhs || lhs->getBitWidth() != rhs->getBitWidth())
+                return;
+
+            auto width = hl::isBoolType(type) ? std::optional< unsigned >(1) : int_width(type);
+            if (!width)
+                return;
+
+            auto result = compare(op.getPredicate(), *lhs, *rhs);
+            replace_by_constant(op, type, llvm::APInt(*width, result), rewriter);
+        }
+
+        template< typename cast_t >
+        void fold_cast(cast_t op, rewriter_t &rewriter) {
+            auto type = op.getType();
+            auto kind = op.getKind();
+
+            if (kind == hl::CastKind::IntegralToBoolean) {
+                if (auto value = constant_int(op.getValue()))
+                    replace_by_constant(op, type, llvm::APInt(1, !value->isZero()), rewriter);
+                return;
+            }
+
+            if (kind != hl::CastKind::IntegralCast)
+                return;
+
+            auto width = int_width(type);
+            if (!width)
+                return;
+
+            if (auto value = constant_int(op.getValue())) {
+                // Extension of the source follows its signedness.
+                replace_by_constant(op, type, value->extOrTrunc(*width), rewriter);
+                return;
+            }
+
+            // A round trip through a wider type, e.g., int to long to int.
+            auto inner = op.getValue().template getDefiningOp< cast_t >();
+            if (!inner || inner.getKind() != hl::CastKind::IntegralCast)
+                return;
+
+            auto source = inner.getValue();
+            auto inner_width  = int_width(inner.getType());
+            auto source_width = int_width(source.getType());
+            if (source.getType() == type && inner_width && source_width && *inner_width >= *source_width) {
+                replace_by_value(op, source);
+            }
+        }
+
+        void fold_address(operation op) {
+            // *&x is x
+            if (auto deref = mlir::dyn_cast< hl::Deref >(op)) {
+                auto addr = deref.getAddr().getDefiningOp< hl::AddressOf >();
+                if (addr && addr.getValue().getType() == deref.getType())
+                    replace_by_value(op, addr.getValue());
+            }
+
+            // &*p is p
+            if (auto addr = mlir::dyn_cast< hl::AddressOf >(op)) {
+                auto deref = addr.getValue().getDefiningOp< hl::Deref >();
+                if (deref && deref.getAddr().getType() == addr.getType())
+                    replace_by_value(op, deref.getAddr());
+            }
+        }
+
+        void fold(operation op, rewriter_t &rewriter) {
+            llvm::TypeSwitch< operation >(op)
+                .Case< hl::AddIOp, hl::SubIOp, hl::MulIOp,
+                       hl::DivSOp, hl::DivUOp, hl::RemSOp, hl::RemUOp,
+                       hl::BinAndOp, hl::BinOrOp, hl::BinXorOp,
+                       hl::BinShlOp, hl::BinLShrOp, hl::BinAShrOp
+                >([&] (auto) { fold_arithmetic(op, rewriter); })
+                .Case< hl::CmpOp >([&] (auto cmp) { fold_compare(cmp, rewriter); })
+                .Case< hl::ImplicitCastOp, hl::CStyleCastOp >([&] (auto cast) {
+                    fold_cast(cast, rewriter);
+                })
+                .Case< hl::Deref, hl::AddressOf >([&] (auto) { fold_address(op); })
+                .Case< hl::IfOp >([&] (auto if_op) { ifs.push_back(if_op); });
+        }
+
+        std::vector< hl::IfOp > ifs;
+
+        // The taken branch keeps its scope, the other one is dropped.
+        void fold_if(hl::IfOp op, rewriter_t &rewriter) {
+            auto cond = constant_condition(op.getCondRegion());
+            if (!cond)
+                return;
+
+            auto &taken   = *cond ? op.getThenRegion() : op.getElseRegion();
+            auto &dropped = *cond ? op.getElseRegion() : op.getThenRegion();
+            if (has_jump_targets(taken) || has_jump_targets(dropped))
+                return;
+
+            if (!taken.empty()) {
+                auto g = rewriter.guard();
+                rewriter->setInsertionPoint(op);
+                auto scope = rewriter->create< core::ScopeOp >(op.getLoc());
+                scope.getBody().takeBody(taken);
+            }
+
+            op->erase();
+        }
         void insert_void_return(hl::FuncOp &op, rewriter_t &rewriter ) {
             auto g = rewriter.guard();
             rewriter->setInsertionPointToEnd(&op.getBody().back());
@@ -52,6 +366,10 @@ namespace vast::hl
                 return;
             }
 
+            if (fold_type_traits(op, rewriter)) {
+                return;
+            }
+
             if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
                 canonicalize_func_op(fn, rewriter);
             }
@@ -59,6 +377,8 @@ namespace vast::hl
             for (auto &region : op->getRegions()) {
                 run(&region, rewriter);
             }
+
+            fold(op, rewriter);
         }
 
         void run(Region *region, rewriter_t &rewriter) {
@@ -77,10 +397,20 @@ namespace vast::hl
             auto rewriter = mlir::IRRewriter(&getContext());
             auto bld = rewriter_t(rewriter);
 
+            // A pass instance is reused for every module of the pass manager.
+            to_remove.clear();
+            layouts.clear();
+            ifs.clear();
+
+            collect_layouts(op);
             run(op, bld);
 
             for (auto op : to_remove)
                 op->erase();
+
+            // Erased after folded operations, some of them may be nested.
+            for (auto op : ifs)
+                fold_if(op, bld);
         }
     };
 
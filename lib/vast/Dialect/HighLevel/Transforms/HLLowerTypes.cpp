@@ -9,6 +9,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinAttributeInterfaces.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <llvm/ADT/StringMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
@@ -22,6 +23,9 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Conversion/Common/Types.hpp"
 
+#include "vast/Interfaces/TypeQualifiersInterfaces.hpp"
+
+#include "vast/Util/Analysis.hpp"
 #include "vast/Util/Maybe.hpp"
 #include "vast/Util/TypeUtils.hpp"
 
@@ -40,14 +44,112 @@ namespace vast::hl
         using lower_type = conv::tc::hl_type_converting_pattern< type_converter_t >;
     } // namespace pattern
 
+    namespace {
+        template< typename qualifier_interface >
+        bool has_qualifier(mlir_type type, auto &&query) {
+            bool result = false;
+            type.walkImmediateSubElements(
+                [&] (mlir::Attribute attr) {
+                    if (auto quals = mlir::dyn_cast< qualifier_interface >(attr))
+                        result |= query(quals);
+                },
+                [] (mlir_type) {}
+            );
+            return result;
+        }
+
+        // Qualifiers of an array are the ones of its elements.
+        bool is_constant_storage(mlir_type type) {
+            while (auto array = mlir::dyn_cast< hl::ArrayType >(type)) {
+                type = array.getElementType();
+            }
+
+            auto is_const = has_qualifier< ConstQualifierInterface >(type, [] (auto quals) {
+                return quals.hasConst();
+            });
+            auto is_volatile = has_qualifier< VolatileQualifierInterface >(type, [] (auto quals) {
+                return quals.hasVolatile();
+            });
+            return is_const && !is_volatile;
+        }
+
+        // Qualifiers are dropped with the types, keep the ones globals are lowered by.
+        void mark_constant_globals(operation op) {
+            auto mark = [] (hl::VarDeclOp var) {
+                auto lvalue = mlir::dyn_cast< hl::LValueType >(var.getType());
+                auto type   = lvalue ? lvalue.getElementType() : var.getType();
+                if (is_constant_storage(type)) {
+                    var->setAttr(ConstantStorageAttr::attr_name(), ConstantStorageAttr::get(var.getContext()));
+                }
+            };
+
+            for (auto &region : op->getRegions()) {
+                for (auto var : region.getOps< hl::VarDeclOp >()) {
+                    mark(var);
+                }
+            }
+        }
+
+        // Enumerations are found by their name, a name shared by enumerations
+        // of different ranges gives no range.
+        llvm::StringMap< ValueRangeAttr > enum_value_ranges(vast_module mod) {
+            llvm::StringMap< ValueRangeAttr > ranges;
+            mod->walk([&] (hl::EnumDeclOp decl) {
+                auto range = decl->getAttrOfType< ValueRangeAttr >(ValueRangeAttr::attr_name());
+                auto [it, inserted] = ranges.try_emplace(decl.getName(), range);
+                if (!inserted && it->second != range) {
+                    it->second = {};
+                }
+            });
+            return ranges;
+        }
+
+        // Types are dropped with the `bool` and enumeration types, keep the
+        // values their loads may produce.
+        void mark_value_ranges(vast_module mod, bool strict_enums) {
+            auto ranges = strict_enums
+                ? enum_value_ranges(mod) : llvm::StringMap< ValueRangeAttr >();
+            auto bool_range = ValueRangeAttr::get(mod.getContext(), 0, 2);
+
+            mod->walk([&] (hl::ImplicitCastOp cast) {
+                if (cast.getKind() != CastKind::LValueToRValue) {
+                    return;
+                }
+
+                auto type = strip_elaborated(getBottomTypedefType(cast.getType(), mod));
+                if (mlir::isa< hl::BoolType >(type)) {
+                    cast->setAttr(ValueRangeAttr::attr_name(), bool_range);
+                } else if (auto en = mlir::dyn_cast< hl::EnumType >(type)) {
+                    if (auto range = ranges.lookup(en.getName())) {
+                        cast->setAttr(ValueRangeAttr::attr_name(), range);
+                    }
+                }
+            });
+        }
+    } // namespace
+
     struct HLLowerTypesPass : HLLowerTypesBase< HLLowerTypesPass >
     {
+        using base = HLLowerTypesBase< HLLowerTypesPass >;
+
+        HLLowerTypesPass() = default;
+
+        explicit HLLowerTypesPass(bool strict_enums) {
+            this->strict_enums = strict_enums;
+        }
+
         void runOnOperation() override {
             auto op    = this->getOperation();
             auto &mctx = this->getContext();
 
-            const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
-            type_converter_t type_converter(dl_analysis.getAtOrAbove(op), mctx);
+            mark_constant_globals(op);
+            mark_value_ranges(op, strict_enums);
+
+            const auto &dl_analysis = this->getAnalysis< data_layout_analysis >().get();
+            type_converter_t type_converter(
+                dl_analysis.getAtOrAbove(op), mctx, builtin_layout_table::of_module(op)
+            );
+            type_converter.use_cache(conv::tc::get_conversion_cache(op, getAnalysisManager()));
 
             mlir::ConversionTarget trg(mctx);
             auto is_legal = type_converter.get_is_type_conversion_legal();
@@ -67,3 +169,7 @@ namespace vast::hl
 std::unique_ptr< mlir::Pass > vast::hl::createHLLowerTypesPass() {
     return std::make_unique< HLLowerTypesPass >();
 }
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLLowerTypesPass(bool strict_enums) {
+    return std::make_unique< HLLowerTypesPass >(strict_enums);
+}
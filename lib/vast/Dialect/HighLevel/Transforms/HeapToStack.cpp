@@ -0,0 +1,523 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/Builtins.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/DataLayout.hpp"
+#include "vast/Util/Remarks.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Alignment of the memory `malloc` returns, i.e., of `max_align_t`.
+        constexpr unsigned malloc_alignment = 16;
+
+        enum class allocator { malloc, calloc, free, memset, memcpy };
+
+        // Library functions the module declares, by their builtin identity,
+        // so that a function of the same name that is not the library one,
+        // e.g., with `-fno-builtin`, is left alone.
+        llvm::StringMap< allocator > allocators(mlir::ModuleOp mod) {
+            llvm::StringMap< allocator > result;
+            for (auto fn : mod.getOps< hl::FuncOp >()) {
+                auto builtin = fn->getAttrOfType< hl::BuiltinAttr >(hl::BuiltinAttr::attr_name());
+                if (!builtin) {
+                    continue;
+                }
+
+                switch (builtin.getID()) {
+                    case clang::Builtin::BImalloc: result[fn.getName()] = allocator::malloc; break;
+                    case clang::Builtin::BIcalloc: result[fn.getName()] = allocator::calloc; break;
+                    case clang::Builtin::BIfree:   result[fn.getName()] = allocator::free;   break;
+                    case clang::Builtin::BImemset: result[fn.getName()] = allocator::memset; break;
+                    case clang::Builtin::BImemcpy: result[fn.getName()] = allocator::memcpy; break;
+                    default: break;
+                }
+            }
+            return result;
+        }
+
+        // Casts that change neither the value nor the pointee object.
+        bool is_pointer_cast(operation op) {
+            return is_cast(op, hl::CastKind::BitCast, hl::CastKind::NoOp);
+        }
+
+        mlir_value strip_casts(mlir_value value, auto ...kinds) {
+            while (auto def = value.getDefiningOp()) {
+                if (!is_cast(def, kinds...)) {
+                    break;
+                }
+                value = def->getOperand(0);
+            }
+            return value;
+        }
+
+        std::optional< std::uint64_t > constant_size(mlir_value value) {
+            auto cst = constant_int(strip_casts(value, hl::CastKind::IntegralCast, hl::CastKind::NoOp));
+            if (!cst || cst->isNegative() || cst->getActiveBits() > 64) {
+                return std::nullopt;
+            }
+            return cst->getZExtValue();
+        }
+
+        bool is_assign(operation op) {
+            return mlir::isa<
+                hl::AssignOp,
+                hl::AddIAssignOp, hl::AddFAssignOp, hl::SubIAssignOp, hl::SubFAssignOp,
+                hl::MulIAssignOp, hl::MulFAssignOp, hl::DivSAssignOp, hl::DivUAssignOp,
+                hl::DivFAssignOp, hl::RemSAssignOp, hl::RemUAssignOp, hl::RemFAssignOp,
+                hl::BinAndAssignOp, hl::BinOrAssignOp, hl::BinXorAssignOp,
+                hl::BinShlAssignOp, hl::BinLShrAssignOp, hl::BinAShrAssignOp,
+                hl::PostIncOp, hl::PostDecOp, hl::PreIncOp, hl::PreDecOp
+            >(op);
+        }
+
+        // Loads of the variable, through casts that keep the pointer.
+        bool is_load_of(mlir_value value, hl::VarDeclOp var) {
+            value = strip_casts(value, hl::CastKind::BitCast, hl::CastKind::NoOp, hl::CastKind::PointerToBoolean);
+            auto load = value.getDefiningOp< hl::ImplicitCastOp >();
+            if (!load || load.getKind() != hl::CastKind::LValueToRValue) {
+                return false;
+            }
+            auto ref = load.getValue().getDefiningOp< hl::DeclRefOp >();
+            return ref && ref.getDecl() == var.getResult();
+        }
+
+        bool is_null(mlir_value value) {
+            value = strip_casts(value,
+                hl::CastKind::BitCast, hl::CastKind::NoOp, hl::CastKind::NullToPointer, hl::CastKind::IntegralCast
+            );
+            auto cst = constant_int(value);
+            return cst && cst->isZero();
+        }
+
+        // `if (!p)` or `if (p == NULL)` without an else. Its body never runs
+        // once `p` is on the stack, so it may leave the function.
+        bool is_null_test(operation op, hl::VarDeclOp var) {
+            auto branch = mlir::dyn_cast< hl::IfOp >(op);
+            if (!branch || !branch.getElseRegion().empty() || !branch.getCondRegion().hasOneBlock()) {
+                return false;
+            }
+
+            auto yield = mlir::dyn_cast< hl::CondYieldOp >(branch.getCondRegion().front().getTerminator());
+            if (!yield) {
+                return false;
+            }
+
+            auto cond = strip_casts(yield.getResult(), hl::CastKind::IntegralCast, hl::CastKind::NoOp);
+            if (auto lnot = cond.getDefiningOp< hl::LNotOp >()) {
+                return is_load_of(lnot.getArg(), var);
+            }
+            if (auto cmp = cond.getDefiningOp< hl::CmpOp >(); cmp && cmp.getPredicate() == hl::Predicate::eq) {
+                return (is_load_of(cmp.getLhs(), var) && is_null(cmp.getRhs()))
+                    || (is_load_of(cmp.getRhs(), var) && is_null(cmp.getLhs()));
+            }
+            return false;
+        }
+
+        template< typename ...ops_t >
+        operation enclosing(operation op) {
+            for (op = op->getParentOp(); op; op = op->getParentOp()) {
+                if (mlir::isa< ops_t... >(op)) {
+                    return op;
+                }
+            }
+            return nullptr;
+        }
+
+        struct candidate
+        {
+            hl::VarDeclOp var;
+            hl::CallOp alloc;
+            allocator kind;
+            std::uint64_t size;
+        };
+
+    } // namespace
+
+    struct HLHeapToStack : HLHeapToStackBase< HLHeapToStack >
+    {
+        using base = HLHeapToStackBase< HLHeapToStack >;
+
+        llvm::StringMap< allocator > known;
+
+        std::optional< allocator > allocator_of(operation op) {
+            auto call = mlir::dyn_cast< hl::CallOp >(op);
+            if (!call) {
+                return std::nullopt;
+            }
+            if (auto it = known.find(call.getCallee()); it != known.end()) {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+        // A local variable initialized by an allocation of a constant size,
+        // e.g., `int *p = malloc(16 * sizeof(int))` once sizeof is folded.
+        std::optional< candidate > match(hl::VarDeclOp var) {
+            if (!var.hasLocalStorage() || var.getInitializer().empty()) {
+                return std::nullopt;
+            }
+
+            auto &init = var.getInitializer();
+            if (!init.hasOneBlock()) {
+                return std::nullopt;
+            }
+
+            auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.front().getTerminator());
+            if (!yield) {
+                return std::nullopt;
+            }
+
+            auto value = strip_casts(yield.getResult(), hl::CastKind::BitCast, hl::CastKind::NoOp);
+            auto call  = value.getDefiningOp< hl::CallOp >();
+            if (!call || !call->hasOneUse()) {
+                return std::nullopt;
+            }
+
+            auto kind = allocator_of(call);
+            auto args = call.getArgOperands();
+            if (kind == allocator::malloc && args.size() == 1) {
+                if (auto size = constant_size(args[0])) {
+                    return candidate{ var, call, *kind, *size };
+                }
+            }
+
+            if (kind == allocator::calloc && args.size() == 2) {
+                auto count = constant_size(args[0]);
+                auto size  = constant_size(args[1]);
+                if (count && size && (*size == 0 || *count <= max_size / *size)) {
+                    return candidate{ var, call, *kind, *count * *size };
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Uses of an lvalue inside of the allocation, i.e., of an element or
+        // a field, access the memory and do not take its address.
+        bool accesses_only(mlir_value lvalue) {
+            for (auto user : lvalue.getUsers()) {
+                if (is_cast(user, hl::CastKind::LValueToRValue) || is_assign(user)) {
+                    continue;
+                }
+
+                if (mlir::isa< hl::SubscriptOp >(user) && user->getOperand(0) == lvalue) {
+                    // Subscript of an array field.
+                    return false;
+                }
+
+                if (mlir::isa< hl::RecordMemberOp >(user)) {
+                    if (!accesses_only(user->getResult(0))) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                return false;
+            }
+            return true;
+        }
+
+        // Uses of the pointer to the allocation that do not let it outlive
+        // the function: accesses of the memory, comparisons, and the calls of
+        // `free`, which are collected.
+        bool does_not_escape(mlir_value ptr, llvm::SmallVectorImpl< hl::CallOp > &frees) {
+            for (auto &use : ptr.getUses()) {
+                auto user = use.getOwner();
+
+                if (is_pointer_cast(user)) {
+                    if (!does_not_escape(user->getResult(0), frees)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                if (is_cast(user, hl::CastKind::PointerToBoolean) || mlir::isa< hl::CmpOp, hl::LNotOp >(user)) {
+                    continue;
+                }
+
+                if (mlir::isa< hl::SubscriptOp >(user) && use.getOperandNumber() == 0) {
+                    if (!accesses_only(user->getResult(0))) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                if (mlir::isa< hl::Deref >(user)) {
+                    if (!accesses_only(user->getResult(0))) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                // The copies yield their destination, which must be unused.
+                if (mlir::isa< hl::BuiltinMemsetOp >(user) && use.getOperandNumber() == 0 && user->use_empty()) {
+                    continue;
+                }
+                if (mlir::isa< hl::BuiltinMemcpyOp >(user) && use.getOperandNumber() < 2 && user->use_empty()) {
+                    continue;
+                }
+
+                if (auto kind = allocator_of(user)) {
+                    if (*kind == allocator::free) {
+                        frees.push_back(mlir::cast< hl::CallOp >(user));
+                        continue;
+                    }
+                    if (*kind == allocator::memset && use.getOperandNumber() == 0 && user->use_empty()) {
+                        continue;
+                    }
+                    if (*kind == allocator::memcpy && use.getOperandNumber() < 2 && user->use_empty()) {
+                        continue;
+                    }
+                }
+
+                return false;
+            }
+            return true;
+        }
+
+        // The variable is only read, so the pointer it holds is the allocation.
+        bool does_not_escape(hl::VarDeclOp var, llvm::SmallVectorImpl< hl::CallOp > &frees) {
+            for (auto user : var->getUsers()) {
+                auto ref = mlir::dyn_cast< hl::DeclRefOp >(user);
+                if (!ref) {
+                    return false;
+                }
+
+                for (auto load : ref->getUsers()) {
+                    if (!is_cast(load, hl::CastKind::LValueToRValue)) {
+                        return false;
+                    }
+                    if (!does_not_escape(load->getResult(0), frees)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Every path from the variable reaches the `free`: it follows the
+        // variable in its block, and nothing in between leaves the block or
+        // jumps into it, except for the body of a null test of the pointer.
+        bool freed_on_all_paths(hl::VarDeclOp var, hl::CallOp free) {
+            if (free->getBlock() != var->getBlock() || !var->isBeforeInBlock(free)) {
+                return false;
+            }
+
+            auto leaves = [&] (operation op) {
+                if (mlir::isa< hl::ReturnOp, hl::GotoStmt, hl::IndirectGotoStmt, hl::LabelStmt >(op)) {
+                    return true;
+                }
+
+                operation target = nullptr;
+                if (mlir::isa< hl::BreakOp >(op)) {
+                    target = enclosing< hl::WhileOp, hl::ForOp, hl::DoOp, hl::SwitchOp >(op);
+                } else if (mlir::isa< hl::ContinueOp >(op)) {
+                    target = enclosing< hl::WhileOp, hl::ForOp, hl::DoOp >(op);
+                } else if (mlir::isa< hl::CaseOp, hl::DefaultOp >(op)) {
+                    target = enclosing< hl::SwitchOp >(op);
+                } else {
+                    return false;
+                }
+
+                return !target || target->isProperAncestor(var);
+            };
+
+            for (auto it = std::next(var->getIterator()); &*it != free.getOperation(); ++it) {
+                if (is_null_test(&*it, var)) {
+                    continue;
+                }
+
+                auto result = it->walk([&] (operation op) {
+                    return leaves(op) ? mlir::WalkResult::interrupt() : mlir::WalkResult::advance();
+                });
+                if (result.wasInterrupted()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool is_removable(operation op) {
+            return is_pure(op) || is_cast(op, hl::CastKind::LValueToRValue) || mlir::isa< hl::DeclRefOp >(op);
+        }
+
+        // Erases `op` and then the operations that only computed its operands.
+        static void erase_with_operands(operation op) {
+            llvm::SmallVector< operation > worklist{ op };
+            while (!worklist.empty()) {
+                auto current = worklist.pop_back_val();
+
+                llvm::SmallSetVector< operation, 4 > defs;
+                for (auto operand : current->getOperands()) {
+                    if (auto def = operand.getDefiningOp()) {
+                        defs.insert(def);
+                    }
+                }
+
+                current->erase();
+                for (auto def : defs) {
+                    if (def->use_empty() && is_removable(def)) {
+                        worklist.push_back(def);
+                    }
+                }
+            }
+        }
+
+        mlir_value constant(mlir::OpBuilder &bld, loc_t loc, mlir_type type, std::uint64_t value) {
+            mlir::DataLayout dl(getOperation());
+            auto bits = dl.getTypeSizeInBits(type);
+            return bld.create< hl::ConstantOp >(
+                loc, type, llvm::APSInt(llvm::APInt(bits, value), /* isUnsigned */ true)
+            );
+        }
+
+        // The types of the stack object are new to the data layout.
+        void add_data_layout(mlir::ModuleOp mod, llvm::ArrayRef< dl::DLEntry > added) {
+            auto ctx  = &getContext();
+            auto spec = mod->getAttrOfType< mlir::DataLayoutSpecAttr >(mlir::DLTIDialect::kDataLayoutAttrName);
+
+            std::vector< mlir::DataLayoutEntryInterface > entries;
+            llvm::DenseSet< mlir_type > present;
+            if (spec) {
+                for (auto entry : spec.getEntries()) {
+                    entries.push_back(entry);
+                    if (auto type = mlir::dyn_cast< mlir_type >(entry.getKey())) {
+                        present.insert(type);
+                    }
+                }
+            }
+
+            for (const auto &entry : added) {
+                if (present.insert(entry.type).second) {
+                    entries.push_back(entry.wrap(*ctx));
+                }
+            }
+
+            mod->setAttr(mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(ctx, entries));
+        }
+
+        void promote(const candidate &c, hl::CallOp free, std::vector< dl::DLEntry > &layout) {
+            auto ctx  = &getContext();
+            auto var  = c.var;
+            auto loc  = c.alloc.getLoc();
+            auto size = c.size ? c.size : 1;
+
+            auto byte    = hl::CharType::get(ctx);
+            auto array   = hl::ArrayType::get(ctx, size, byte);
+            auto pointer = hl::PointerType::get(ctx, byte);
+
+            mlir::DataLayout dl(getOperation());
+            auto pointer_size = static_cast< dl::DLEntry::bitwidth_t >(
+                dl.getTypeSizeInBits(c.alloc.getResult(0).getType())
+            );
+            layout.emplace_back(array, static_cast< dl::DLEntry::bitwidth_t >(size * 8), 8);
+            layout.emplace_back(pointer, pointer_size, pointer_size);
+
+            mlir::OpBuilder bld(var);
+            auto stack = bld.create< hl::VarDeclOp >(
+                var.getLoc(), hl::LValueType::get(ctx, array), (var.getName() + ".stack").str()
+            );
+            if (auto sc = var.getStorageClassAttr()) {
+                stack.setStorageClassAttr(sc);
+            }
+            stack->setAttr(hl::AlignmentAttr::attr_name(), hl::AlignmentAttr::get(ctx, malloc_alignment));
+
+            bld.setInsertionPoint(c.alloc);
+            auto ref     = bld.create< hl::DeclRefOp >(loc, stack.getType(), stack);
+            auto decayed = bld.create< hl::ImplicitCastOp >(loc, pointer, ref, hl::CastKind::ArrayToPointerDecay);
+
+            if (c.kind == allocator::calloc) {
+                // The fill byte is of the type of the size, which the data
+                // layout is known to have.
+                auto size_type = c.alloc.getArgOperands()[0].getType();
+                bld.create< hl::BuiltinMemsetOp >(loc, pointer, decayed,
+                    constant(bld, loc, size_type, 0), constant(bld, loc, size_type, c.size)
+                );
+            }
+
+            auto result = bld.create< hl::ImplicitCastOp >(
+                loc, c.alloc.getResult(0).getType(), decayed, hl::CastKind::BitCast
+            );
+
+            c.alloc.getResult(0).replaceAllUsesWith(result);
+            erase_with_operands(c.alloc);
+            erase_with_operands(free);
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+            known = allocators(mod);
+            if (known.empty()) {
+                return;
+            }
+
+            llvm::SmallVector< candidate > candidates;
+            mod.walk([&] (hl::VarDeclOp var) {
+                if (auto c = match(var)) {
+                    candidates.push_back(*c);
+                }
+            });
+
+            std::vector< dl::DLEntry > layout;
+            for (const auto &c : candidates) {
+                auto missed = [&] (string_ref reason) {
+                    remarks::missed(c.alloc, getArgument(), "HeapToStack")
+                        << "allocation of '" << c.var.getName() << "' stays on the heap, " << reason;
+                };
+
+                if (c.size > max_size) {
+                    missed("it is larger than " + std::to_string(max_size) + " bytes");
+                    continue;
+                }
+
+                llvm::SmallVector< hl::CallOp > frees;
+                if (!does_not_escape(c.var, frees)) {
+                    missed("its pointer escapes");
+                    continue;
+                }
+
+                if (frees.size() != 1 || !freed_on_all_paths(c.var, frees.front())) {
+                    missed("it is not freed on all paths");
+                    continue;
+                }
+
+                remarks::passed(c.alloc, getArgument(), "HeapToStack")
+                    << "allocation of " << c.size << " bytes of '" << c.var.getName()
+                    << "' is moved to the stack";
+                promote(c, frees.front(), layout);
+            }
+
+            if (!layout.empty()) {
+                add_data_layout(mod, layout);
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLHeapToStackPass()
+    {
+        return std::make_unique< HLHeapToStack >();
+    }
+
+} // namespace vast::hl
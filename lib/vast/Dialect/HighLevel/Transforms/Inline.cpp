@@ -0,0 +1,239 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/SymbolTable.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Budgets in the number of operations of the callee body. Functions
+        // that are not visible outside of the module (e.g., `static` and
+        // `inline` ones) get the larger one, as clang's inline hint does.
+        constexpr std::size_t inline_threshold      = 16;
+        constexpr std::size_t inline_hint_threshold = 64;
+
+        template< typename attr_t >
+        bool has_attr(hl::FuncOp fn) {
+            return llvm::any_of(fn->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        bool has_inline_hint(hl::FuncOp fn) {
+            return fn.getLinkage() != core::GlobalLinkageKind::ExternalLinkage;
+        }
+
+        // Block that holds the statements of the function, trailing scopes
+        // of the body are looked through.
+        mlir::Block *statements(hl::FuncOp fn) {
+            auto *block = &fn.getBody().front();
+            while (block->getOperations().size() == 1) {
+                auto scope = mlir::dyn_cast< core::ScopeOp >(block->front());
+                if (!scope || !scope.getBody().hasOneBlock()) {
+                    break;
+                }
+                block = &scope.getBody().front();
+            }
+            return block;
+        }
+
+        //
+        // The callee returns only at the end of its statements. Returns from
+        // nested regions, jumps and static locals would need rewriting that HL
+        // cannot express without control flow of the low-level dialects.
+        //
+        std::optional< std::size_t > inlinable_body_size(hl::FuncOp fn) {
+            if (fn.isDeclaration() || fn.isVarArg() || !fn.getBody().hasOneBlock()) {
+                return std::nullopt;
+            }
+
+            auto *block = statements(fn);
+            if (block->empty() || !core::is_return(&block->back())) {
+                return std::nullopt;
+            }
+
+            operation ret = &block->back();
+            std::size_t size = 0;
+            auto result = fn->walk([&] (operation op) {
+                if (op == fn.getOperation()) {
+                    return mlir::WalkResult::advance();
+                }
+
+                if (op != ret && core::is_return(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                if (mlir::isa< hl::LabelStmt, hl::GotoStmt, hl::IndirectGotoStmt >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                    if (var.getStorageClass() == StorageClass::sc_static) {
+                        return mlir::WalkResult::interrupt();
+                    }
+                }
+
+                ++size;
+                return mlir::WalkResult::advance();
+            });
+
+            if (result.wasInterrupted()) {
+                return std::nullopt;
+            }
+
+            return size;
+        }
+
+        // Parameters are copied into variables, so the call has to be at the
+        // level of statements, not inside of an expression region.
+        bool is_statement_level(hl::CallOp call) {
+            auto &last = call->getBlock()->back();
+            return !mlir::isa< hl::ValueYieldOp, hl::CondYieldOp >(last);
+        }
+
+        bool has_matching_signature(hl::CallOp call, hl::FuncOp callee) {
+            auto &entry = callee.getBody().front();
+            if (entry.getNumArguments() != call.getArgOperands().size()) {
+                return false;
+            }
+
+            for (auto [param, arg] : llvm::zip(entry.getArguments(), call.getArgOperands())) {
+                auto lvalue = mlir::dyn_cast< hl::LValueType >(param.getType());
+                if (!lvalue || lvalue.getElementType() != arg.getType()) {
+                    return false;
+                }
+            }
+
+            auto ret = &statements(callee)->back();
+            return ret->getNumOperands() == call.getNumResults();
+        }
+
+    } // namespace
+
+    //
+    // Inlines calls of small functions defined in the module. `noinline`
+    // functions are never inlined and `always_inline` ones regardless of
+    // their size, as are all calls in a `flatten` function. Each parameter becomes a local variable initialized by the
+    // argument, so the inlined body refers to it exactly as to the parameter.
+    //
+    // Calls are inlined in a single sweep, calls in the inlined bodies are
+    // left as they are, so recursive functions cannot make the pass diverge.
+    //
+    struct HLInline : HLInlineBase< HLInline >
+    {
+        using base = HLInlineBase< HLInline >;
+
+        HLInline() = default;
+
+        explicit HLInline(bool always_inline_only) {
+            this->always_inline_only = always_inline_only;
+        }
+
+        bool should_inline(hl::CallOp call, hl::FuncOp callee) {
+            if (has_attr< hl::NoInlineAttr >(callee)) {
+                return false;
+            }
+
+            auto caller = call->getParentOfType< hl::FuncOp >();
+            if (!caller || caller == callee) {
+                return false;
+            }
+
+            auto size = inlinable_body_size(callee);
+            if (!size || !is_statement_level(call) || !has_matching_signature(call, callee)) {
+                return false;
+            }
+
+            // Calls of a `flatten` function are inlined as if the callees
+            // were `always_inline`.
+            if (has_attr< hl::AlwaysInlineAttr >(callee) || has_attr< hl::FlattenAttr >(caller)) {
+                return true;
+            }
+
+            if (always_inline_only) {
+                return false;
+            }
+
+            auto budget = has_inline_hint(callee) ? inline_hint_threshold : inline_threshold;
+            return *size <= budget;
+        }
+
+        void inline_call(hl::CallOp call, hl::FuncOp callee) {
+            mlir::OpBuilder bld(call);
+            mlir::IRMapping mapping;
+
+            auto &entry = callee.getBody().front();
+            for (auto [idx, param, arg] : llvm::enumerate(entry.getArguments(), call.getArgOperands())) {
+                auto name = (callee.getSymName() + ".arg" + llvm::Twine(idx)).str();
+                auto var = bld.create< hl::VarDeclOp >(
+                    param.getLoc(), param.getType(), name,
+                    [arg = arg] (Builder &bld, Location loc) {
+                        bld.create< hl::ValueYieldOp >(loc, arg);
+                    }
+                );
+                mapping.map(param, var.getResult());
+            }
+
+            auto *block = statements(callee);
+            operation ret = &block->back();
+            for (auto &op : *block) {
+                if (&op != ret) {
+                    bld.clone(op, mapping);
+                }
+            }
+
+            for (auto [result, value] : llvm::zip(call.getResults(), ret->getOperands())) {
+                result.replaceAllUsesWith(mapping.lookupOrDefault(value));
+            }
+
+            call->erase();
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            llvm::SmallVector< hl::CallOp > calls;
+            mod->walk([&] (hl::CallOp call) { calls.push_back(call); });
+
+            for (auto call : calls) {
+                auto callee = mlir::SymbolTable::lookupNearestSymbolFrom< hl::FuncOp >(
+                    call, call.getCalleeAttr()
+                );
+
+                if (callee && should_inline(call, callee)) {
+                    inline_call(call, callee);
+                }
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLInlinePass()
+{
+    return std::make_unique< vast::hl::HLInline >();
+}
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLInlinePass(bool always_inline_only)
+{
+    return std::make_unique< vast::hl::HLInline >(always_inline_only);
+}
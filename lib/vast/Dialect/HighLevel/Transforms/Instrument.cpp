@@ -0,0 +1,362 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/DataLayout.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        template< typename attr_t >
+        bool has_attr(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        // Functions of a few operations without loops and calls, e.g.,
+        // accessors of record fields, would mostly count their inlining.
+        bool is_trivial(hl::FuncOp fn) {
+            constexpr std::size_t max_trivial_size = 8;
+
+            std::size_t size = 0;
+            auto result = fn.getBody().walk([&] (operation op) {
+                if (mlir::isa< hl::CallOp, hl::ForOp, hl::WhileOp, hl::DoOp >(op)
+                    || ++size > max_trivial_size
+                ) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return !result.wasInterrupted();
+        }
+
+        unsigned line_of(loc_t loc) {
+            if (auto file = loc->findInstanceOf< mlir::FileLineColLoc >()) {
+                return file.getLine();
+            }
+            return 0;
+        }
+
+        mlir::Region *loop_body(operation op) {
+            if (auto loop = mlir::dyn_cast< hl::ForOp >(op)) {
+                return &loop.getBodyRegion();
+            }
+            if (auto loop = mlir::dyn_cast< hl::WhileOp >(op)) {
+                return &loop.getBodyRegion();
+            }
+            if (auto loop = mlir::dyn_cast< hl::DoOp >(op)) {
+                return &loop.getBodyRegion();
+            }
+            return nullptr;
+        }
+
+    } // namespace
+
+    //
+    // Inserts execution counters of functions, loops and call sites. The
+    // counters of a module are an array of 64-bit integers, the record of
+    // the module in the `vast_prof` section:
+    //
+    //   [ counters, words of labels, counter..., labels... ]
+    //
+    // Labels are the newline separated names of the counters, e.g.,
+    // `main:loop:12`, packed into the 64-bit words of the record. The runtime
+    // (`vast_rt_profile`) walks the records of the section at exit. With
+    // timestamps, instrumented functions also sum the cycles spent in them,
+    // measured by the runtime.
+    //
+    struct HLInstrument : HLInstrumentBase< HLInstrument >
+    {
+        using base = HLInstrumentBase< HLInstrument >;
+
+        static constexpr llvm::StringLiteral counters_name = "__vast_prof_data";
+        static constexpr llvm::StringLiteral section_name  = "vast_prof";
+        static constexpr llvm::StringLiteral enter_name    = "__vast_prof_enter";
+        static constexpr llvm::StringLiteral exit_name     = "__vast_prof_exit";
+
+        // Counters of the record precede the labels.
+        static constexpr std::size_t header_size = 2;
+
+        HLInstrument() = default;
+
+        explicit HLInstrument(const instrument_options &opts) {
+            this->functions  = opts.functions;
+            this->loops      = opts.loops;
+            this->timestamps = opts.timestamps;
+            this->calls      = opts.calls;
+        }
+
+        // Counters are incremented before the operation `at`.
+        struct probe {
+            operation at;
+            std::string label;
+        };
+
+        std::vector< probe > probes;
+        // Functions whose cycles are summed, with the index of the sum.
+        std::vector< std::pair< hl::FuncOp, std::size_t > > timed;
+
+        mlir_type counter_type() { return mlir::IntegerType::get(&getContext(), 64); }
+
+        std::size_t add_probe(operation at, std::string label) {
+            probes.push_back({ at, std::move(label) });
+            return probes.size() - 1;
+        }
+
+        void collect(hl::FuncOp fn, const llvm::StringSet<> &callees) {
+            auto name = fn.getSymName();
+            auto &entry = fn.getBody().front();
+
+            if (functions) {
+                add_probe(&entry.front(), (name + ":entry").str());
+            }
+
+            if (timestamps) {
+                timed.emplace_back(fn, add_probe(&entry.front(), (name + ":cycles").str()));
+            }
+
+            fn.getBody().walk([&] (operation op) {
+                if (loops) {
+                    if (auto body = loop_body(op); body && !body->empty() && !body->front().empty()) {
+                        add_probe(&body->front().front(),
+                            llvm::formatv("{0}:loop:{1}", name, line_of(op->getLoc())).str()
+                        );
+                    }
+                }
+
+                if (auto call = mlir::dyn_cast< hl::CallOp >(op); call && callees.contains(call.getCallee())) {
+                    add_probe(op,
+                        llvm::formatv("{0}:call:{1}:{2}", name, call.getCallee(), line_of(op->getLoc())).str()
+                    );
+                }
+            });
+        }
+
+        // Packs the labels into words of the target byte order.
+        std::vector< std::uint64_t > pack_labels(bool little_endian) const {
+            std::string labels;
+            for (const auto &p : probes) {
+                labels += p.label;
+                labels += '\n';
+            }
+            labels.resize(llvm::alignTo(labels.size(), sizeof(std::uint64_t)), '\0');
+
+            std::vector< std::uint64_t > words;
+            for (std::size_t i = 0; i < labels.size(); i += sizeof(std::uint64_t)) {
+                auto ptr = labels.data() + i;
+                words.push_back(little_endian
+                    ? llvm::support::endian::read64le(ptr)
+                    : llvm::support::endian::read64be(ptr)
+                );
+            }
+            return words;
+        }
+
+        hl::VarDeclOp make_counters(mlir::ModuleOp mod, const llvm::Triple &triple) {
+            auto labels = pack_labels(triple.isLittleEndian());
+
+            std::vector< llvm::APInt > values;
+            values.emplace_back(64, probes.size());
+            values.emplace_back(64, labels.size());
+            values.resize(header_size + probes.size(), llvm::APInt(64, 0));
+            for (auto word : labels) {
+                values.emplace_back(64, word);
+            }
+
+            auto ctx   = &getContext();
+            auto array = hl::ArrayType::get(ctx, values.size(), counter_type());
+            auto init  = mlir::DenseElementsAttr::get(
+                mlir::RankedTensorType::get({ std::int64_t(values.size()) }, counter_type()), values
+            );
+
+            mlir::OpBuilder bld(ctx);
+            bld.setInsertionPointToStart(mod.getBody());
+            auto var = bld.create< hl::VarDeclOp >(
+                mod.getLoc(), hl::LValueType::get(ctx, array), counters_name
+            );
+            var.setStorageClass(StorageClass::sc_static);
+            var.setInitialValueAttr(init);
+            var->setAttr("section", hl::SectionAttr::get(ctx, section_name));
+
+            add_data_layout(mod, array, triple);
+            return var;
+        }
+
+        // Types of the counters are new to the data layout of the module.
+        void add_data_layout(mlir::ModuleOp mod, hl::ArrayType array, const llvm::Triple &triple) {
+            auto ctx = &getContext();
+            auto spec = mod->getAttrOfType< mlir::DataLayoutSpecAttr >(mlir::DLTIDialect::kDataLayoutAttrName);
+
+            std::vector< mlir::DataLayoutEntryInterface > entries;
+            if (spec) {
+                entries.assign(spec.getEntries().begin(), spec.getEntries().end());
+            }
+
+            auto words = static_cast< dl::DLEntry::bitwidth_t >(array.getSize().value_or(0));
+            auto pointer_size = triple.isArch64Bit() ? 64u : triple.isArch32Bit() ? 32u : 16u;
+            entries.push_back(dl::DLEntry(array, words * 64, 64).wrap(*ctx));
+            entries.push_back(
+                dl::DLEntry(hl::PointerType::get(ctx, counter_type()), pointer_size, pointer_size).wrap(*ctx)
+            );
+
+            mod->setAttr(mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(ctx, entries));
+        }
+
+        hl::FuncOp declare_runtime(mlir::ModuleOp mod, string_ref name) {
+            if (auto fn = mod.lookupSymbol< hl::FuncOp >(name)) {
+                return fn;
+            }
+
+            auto ctx = &getContext();
+            auto type = core::FunctionType::get(
+                { hl::PointerType::get(ctx, counter_type()) }, { hl::VoidType::get(ctx) }
+            );
+
+            mlir::OpBuilder bld(ctx);
+            bld.setInsertionPointToStart(mod.getBody());
+            auto fn = bld.create< hl::FuncOp >(mod.getLoc(), name, type);
+            fn.setVisibility(mlir::SymbolTable::Visibility::Private);
+            return fn;
+        }
+
+        mlir_value counter(mlir::OpBuilder &bld, loc_t loc, hl::VarDeclOp counters, std::size_t idx) {
+            auto ctx = &getContext();
+            auto ptr = hl::PointerType::get(ctx, counter_type());
+
+            auto ref = bld.create< hl::GlobalRefOp >(loc, counters.getType(), counters.getName());
+            auto decayed = bld.create< hl::ImplicitCastOp >(loc, ptr, ref, CastKind::ArrayToPointerDecay);
+            auto offset = bld.create< hl::ConstantOp >(
+                loc, counter_type(), llvm::APSInt(llvm::APInt(64, header_size + idx), /* isUnsigned */ true)
+            );
+            return bld.create< hl::SubscriptOp >(loc, hl::LValueType::get(ctx, counter_type()), decayed, offset);
+        }
+
+        mlir_value counter_addr(mlir::OpBuilder &bld, loc_t loc, hl::VarDeclOp counters, std::size_t idx) {
+            auto ptr = hl::PointerType::get(&getContext(), counter_type());
+            return bld.create< hl::AddressOf >(loc, ptr, counter(bld, loc, counters, idx));
+        }
+
+        void increment(mlir::OpBuilder &bld, loc_t loc, hl::VarDeclOp counters, std::size_t idx) {
+            bld.create< hl::PreIncOp >(loc, counter_type(), counter(bld, loc, counters, idx));
+        }
+
+        void call_runtime(mlir::OpBuilder &bld, loc_t loc, hl::FuncOp fn, mlir_value arg) {
+            bld.create< hl::CallOp >(loc, fn, mlir::ValueRange{ arg });
+        }
+
+        void time(hl::FuncOp fn, hl::VarDeclOp counters, std::size_t idx, hl::FuncOp enter, hl::FuncOp exit) {
+            auto &entry = fn.getBody().front();
+
+            mlir::OpBuilder bld(&getContext());
+            bld.setInsertionPointToStart(&entry);
+            call_runtime(bld, fn.getLoc(), enter, counter_addr(bld, fn.getLoc(), counters, idx));
+
+            llvm::SmallVector< hl::ReturnOp > returns;
+            fn.getBody().walk([&] (hl::ReturnOp ret) { returns.push_back(ret); });
+            for (auto ret : returns) {
+                bld.setInsertionPoint(ret);
+                call_runtime(bld, ret.getLoc(), exit, counter_addr(bld, ret.getLoc(), counters, idx));
+            }
+
+            // Functions that fall off their end return without `hl.return`.
+            if (entry.empty() || !mlir::isa< hl::ReturnOp >(entry.back())) {
+                bld.setInsertionPointToEnd(&entry);
+                call_runtime(bld, fn.getLoc(), exit, counter_addr(bld, fn.getLoc(), counters, idx));
+            }
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            // The module is already instrumented.
+            if (mod.lookupSymbol(counters_name)) {
+                return;
+            }
+
+            llvm::StringSet<> callees;
+            for (const auto &name : calls) {
+                callees.insert(name);
+            }
+
+            probes.clear();
+            timed.clear();
+
+            llvm::SmallVector< hl::FuncOp > fns;
+            mod.walk([&] (hl::FuncOp fn) { fns.push_back(fn); });
+            for (auto fn : fns) {
+                if (fn.isDeclaration() || fn.getBody().front().empty()
+                    || has_attr< hl::NoInstrumentFunctionAttr >(fn)
+                    || has_attr< hl::AlwaysInlineAttr >(fn)
+                    || is_trivial(fn)
+                ) {
+                    continue;
+                }
+                collect(fn, callees);
+            }
+
+            if (probes.empty()) {
+                return;
+            }
+
+            auto triple_attr = mod->getAttrOfType< mlir::StringAttr >(core::CoreDialect::getTargetTripleAttrName());
+            auto triple = llvm::Triple(triple_attr ? triple_attr.getValue() : "");
+            auto counters = make_counters(mod, triple);
+
+            // Cycles are summed by the runtime, they are not counted.
+            llvm::DenseSet< std::size_t > cycles;
+            for (const auto &entry : timed) {
+                cycles.insert(entry.second);
+            }
+
+            mlir::OpBuilder bld(&getContext());
+            for (auto [idx, p] : llvm::enumerate(probes)) {
+                if (cycles.contains(idx)) {
+                    continue;
+                }
+
+                bld.setInsertionPoint(p.at);
+                increment(bld, p.at->getLoc(), counters, idx);
+            }
+
+            if (!timed.empty()) {
+                auto enter = declare_runtime(mod, enter_name);
+                auto exit  = declare_runtime(mod, exit_name);
+                for (auto [fn, idx] : timed) {
+                    time(fn, counters, idx, enter, exit);
+                }
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLInstrumentPass()
+    {
+        return std::make_unique< HLInstrument >();
+    }
+
+    std::unique_ptr< mlir::Pass > createHLInstrumentPass(const instrument_options &opts)
+    {
+        return std::make_unique< HLInstrument >(opts);
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,133 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        template< typename attr_t >
+        bool has_attr(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        bool has_initializer(hl::VarDeclOp var) {
+            return !var.getInitializer().empty() || var.getInitialValue();
+        }
+
+        // Functions available externally are copies of a definition elsewhere,
+        // they are dropped by the dce once unused.
+        bool is_internalizable(core::GlobalLinkageKind linkage) {
+            using enum core::GlobalLinkageKind;
+            switch (linkage) {
+                case InternalLinkage:
+                case PrivateLinkage:
+                case AvailableExternallyLinkage:
+                case ExternalWeakLinkage:
+                    return false;
+                default:
+                    return true;
+            }
+        }
+
+    } // namespace
+
+    //
+    // Internalizes definitions of a whole program that are not its entry
+    // points. Once internal, the symbol dce of hl removes every definition not
+    // reachable from the entry points, across the linked translation units.
+    // Objects placed in an explicit section, e.g., interrupt vector tables of
+    // firmware, are referenced by the linker script and stay visible.
+    //
+    struct HLInternalize : HLInternalizeBase< HLInternalize >
+    {
+        using base = HLInternalizeBase< HLInternalize >;
+
+        HLInternalize() = default;
+
+        explicit HLInternalize(llvm::ArrayRef< std::string > entry_points) {
+            this->entry_points = entry_points;
+        }
+
+        llvm::StringSet<> exported;
+
+        bool is_exported(string_ref name, operation op) const {
+            return exported.contains(name) || has_attr< hl::SectionAttr >(op);
+        }
+
+        void internalize(mlir::Block &scope) {
+            for (auto &op : scope) {
+                if (auto tu = mlir::dyn_cast< hl::TranslationUnitOp >(op)) {
+                    internalize(tu.getBody().front());
+                    continue;
+                }
+
+                if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                    if (!fn.isDeclaration() && is_internalizable(fn.getLinkage())
+                        && !is_exported(fn.getSymName(), fn)
+                    ) {
+                        fn.setLinkage(core::GlobalLinkageKind::InternalLinkage);
+                    }
+                    continue;
+                }
+
+                if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                    // Tentative definitions become zero-initialized statics.
+                    bool definition = !var.hasExternalStorage() || has_initializer(var);
+                    if (definition && var.getStorageClass() != StorageClass::sc_static
+                        && !is_exported(var.getName(), var)
+                    ) {
+                        var.setStorageClass(StorageClass::sc_static);
+                    }
+                }
+            }
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            exported.clear();
+            if (entry_points.empty()) {
+                exported.insert("main");
+            }
+            for (const auto &name : entry_points) {
+                exported.insert(name);
+            }
+
+            internalize(*mod.getBody());
+
+            mlir::OpPassManager pm(mlir::ModuleOp::getOperationName());
+            pm.addPass(createHLSymbolDCEPass());
+            if (mlir::failed(runPipeline(pm, mod))) {
+                return signalPassFailure();
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLInternalizePass()
+    {
+        return std::make_unique< HLInternalize >();
+    }
+
+    std::unique_ptr< mlir::Pass > createHLInternalizePass(llvm::ArrayRef< std::string > entry_points)
+    {
+        return std::make_unique< HLInternalize >(entry_points);
+    }
+
+} // namespace vast::hl
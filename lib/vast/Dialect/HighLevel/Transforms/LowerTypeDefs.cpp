@@ -3,26 +3,15 @@
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
 VAST_RELAX_WARNINGS
-#include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
-#include <mlir/Dialect/Func/IR/FuncOps.h>
-
-#include <mlir/Rewrite/FrozenRewritePatternSet.h>
-#include <mlir/Transforms/DialectConversion.h>
-#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/AttrTypeSubElements.h>
 VAST_UNRELAX_WARNINGS
 
-#include "vast/Conversion/Common/Passes.hpp"
-#include "vast/Conversion/Common/Patterns.hpp"
-#include "vast/Conversion/Common/Rewriter.hpp"
-
-#include "vast/Conversion/TypeConverters/DataLayout.hpp"
-#include "vast/Conversion/TypeConverters/TypeConvertingPattern.hpp"
+#include "vast/Conversion/Common/WalkRewriter.hpp"
 
 #include "vast/Util/Common.hpp"
-#include "vast/Util/DialectConversion.hpp"
 #include "vast/Util/TypeUtils.hpp"
 
-
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
@@ -30,93 +19,100 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::hl {
     namespace {
-        using type_map = std::map< mlir_type, mlir_type >;
-
-        namespace pattern {
-            struct type_converter
-                : conv::tc::base_type_converter
-                , conv::tc::mixins< type_converter >
-            {
-                vast_module mod;
-                mcontext_t &mctx;
-
-                type_converter(mcontext_t &mctx, vast_module mod)
-                    : conv::tc::base_type_converter(),
-                      mod(mod), mctx(mctx)
-                {
-                    addConversion([&](mlir_type t) { return this->convert(t); });
-                }
-
-                maybe_types_t do_conversion(mlir_type type) {
-                    types_t out;
-                    if (mlir::succeeded(this->convertTypes(type, out))) {
-                        return { std::move(out) };
-                    }
-                    return {};
+        using replacement_t = std::optional< std::pair< mlir_type, mlir::WalkResult > >;
+
+        //
+        // Replaces typedefs by their fully resolved types, i.e., without any
+        // typedef nested in them, in place. Every typedef of the module is
+        // resolved once, typedefs used by the definition of another typedef
+        // first, so every typedef of a chain is visited only once.
+        //
+        struct typedef_resolver
+        {
+            explicit typedef_resolver(vast_module mod) {
+                llvm::StringMap< hl::TypeDefOp > defs;
+                for (auto def : mod.getOps< hl::TypeDefOp >()) {
+                    defs.try_emplace(def.getName(), def);
                 }
 
-                // TODO(conv): This may need to be precomputed instead.
-                maybe_type_t nested_type(mlir_type type) {
-                    return hl::getBottomTypedefType(type, mod);
+                for (const auto &[name, _] : defs) {
+                    resolve(name, defs);
                 }
 
-                maybe_type_t convert(mlir_type type) {
-                    mlir::AttrTypeReplacer replacer;
-                    replacer.addReplacement([this] (mlir_type t) {
-                        return nested_type(t);
-                    });
-                    return replacer.replace(type);
-                }
-            };
-
-            struct resolve_typedef : conv::tc::hl_type_converting_pattern< type_converter > {
-                using base = conv::tc::hl_type_converting_pattern< type_converter >;
-                using base::base;
-
-                logical_result matchAndRewrite(
-                    operation op, mlir::ArrayRef< mlir::Value > ops,
-                    conversion_rewriter &rewriter
-                ) const override {
-                    auto status = base::matchAndRewrite(op, ops, rewriter);
+                replacer.addReplacement([this] (mlir_type t) -> replacement_t {
+                    if (auto def = mlir::dyn_cast< hl::TypedefType >(strip_elaborated(t))) {
+                        auto it = resolved.find(def.getName());
+                        VAST_CHECK(it != resolved.end(), "unknown typedef name {0}", def.getName());
+                        return std::make_pair(it->second, mlir::WalkResult::skip());
+                    }
+                    return std::nullopt;
+                });
+            }
 
-                    if (mlir::isa< hl::TypeDefOp >(op))
-                        rewriter.eraseOp(op);
+            // Result types, block arguments and attributes of `op`, not of
+            // the operations nested in it.
+            void replace_in(operation op) {
+                replacer.replaceElementsIn(
+                    op, /* replaceAttrs */ true, /* replaceLocs */ false, /* replaceTypes */ true
+                );
+            }
 
-                    return status;
+          private:
+            mlir_type resolve(string_ref name, const llvm::StringMap< hl::TypeDefOp > &defs) {
+                if (auto it = resolved.find(name); it != resolved.end()) {
+                    return it->second;
                 }
-            };
 
-        } // namespace pattern
-    } // namespace
+                auto def = defs.find(name);
+                VAST_CHECK(def != defs.end(), "unknown typedef name {0}", name);
 
-    struct LowerTypeDefs : ModuleConversionPassMixin< LowerTypeDefs, LowerTypeDefsBase >
-    {
-        using base     = ModuleConversionPassMixin< LowerTypeDefs, LowerTypeDefsBase >;
-        using config_t = typename base::config_t;
+                mlir::AttrTypeReplacer nested_replacer;
+                nested_replacer.addReplacement([&] (mlir_type t) -> replacement_t {
+                    if (auto nested = mlir::dyn_cast< hl::TypedefType >(strip_elaborated(t))) {
+                        return std::make_pair(
+                            resolve(nested.getName(), defs), mlir::WalkResult::skip()
+                        );
+                    }
+                    return std::nullopt;
+                });
 
-        static auto create_conversion_target(mcontext_t &mctx) {
-            mlir::ConversionTarget trg(mctx);
+                auto type = nested_replacer.replace(def->second.getType());
+                resolved[name] = type;
+                return type;
+            }
 
-            trg.markUnknownOpDynamicallyLegal([](operation op) {
-                return !has_type_somewhere< hl::TypedefType >(op);
-            });
+            llvm::StringMap< mlir_type > resolved;
 
-            trg.addIllegalOp< hl::TypeDefOp >();
+            // Caches replaced types and attributes, so that a type shared by
+            // many operations is rebuilt once.
+            mlir::AttrTypeReplacer replacer;
+        };
 
-            return trg;
-        }
+    } // namespace
 
+    //
+    // Every rewrite is an unconditional replacement of types, so the pass
+    // rewrites the module in place, in a single walk, rather than by the
+    // dialect conversion.
+    //
+    struct LowerTypeDefs : LowerTypeDefsBase< LowerTypeDefs >
+    {
         void runOnOperation() override {
-            auto &mctx     = getContext();
-            auto target    = create_conversion_target(mctx);
-            vast_module op = getOperation();
-
-            rewrite_pattern_set patterns(&mctx);
+            vast_module mod = getOperation();
 
-            auto tc = pattern::type_converter(mctx, op);
-            patterns.template add< pattern::resolve_typedef >(tc, mctx);
+            typedef_resolver resolver(mod);
+            auto status = conv::rewrite_in_place< operation >(mod,
+                [&] (operation op, mlir::RewriterBase &rewriter) {
+                    if (mlir::isa< hl::TypeDefOp >(op)) {
+                        rewriter.eraseOp(op);
+                    } else if (op != mod) {
+                        rewriter.updateRootInPlace(op, [&] { resolver.replace_in(op); });
+                    }
+                    return mlir::success();
+                }
+            );
 
-            if (mlir::failed(mlir::applyPartialConversion(op, target, std::move(patterns)))) {
+            if (mlir::failed(status)) {
                 return signalPassFailure();
             }
         }
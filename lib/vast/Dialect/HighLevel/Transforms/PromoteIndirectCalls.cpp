@@ -0,0 +1,399 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Analysis.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Remarks.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelMatchers.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+
+#include "PassesDetails.hpp"
+
+#include <functional>
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Casts between function pointers keep the function.
+        mlir_value strip_function_casts(mlir_value value) {
+            while (auto def = value.getDefiningOp()) {
+                if (!is_cast(def, hl::CastKind::BitCast, hl::CastKind::NoOp, hl::CastKind::FunctionToPointerDecay)) {
+                    break;
+                }
+                value = def->getOperand(0);
+            }
+            return value;
+        }
+
+        mlir_type strip_type(mlir_type type, vast_module mod) {
+            return strip_elaborated(getBottomTypedefType(strip_value_category(type), mod));
+        }
+
+        std::optional< std::string > record_name(mlir_type type, vast_module mod) {
+            return name_of_record(getBottomTypedefType(strip_value_category(type), mod));
+        }
+
+        // Statements of a block, not the value of an expression region.
+        bool is_statement_level(operation op) {
+            auto &last = op->getBlock()->back();
+            return !mlir::isa< hl::ValueYieldOp, hl::CondYieldOp >(last);
+        }
+
+    } // namespace
+
+    //
+    // A slot is a place that holds function pointers: a global variable (with
+    // the elements of a global array), a local variable, or a field of a
+    // record, which stands for the field of all objects of the record.
+    //
+    struct HLPromoteIndirectCalls : HLPromoteIndirectCallsBase< HLPromoteIndirectCalls >
+    {
+        using base = HLPromoteIndirectCallsBase< HLPromoteIndirectCalls >;
+
+        using targets_t = llvm::SetVector< mlir::StringAttr >;
+
+        llvm::StringMap< targets_t > slots;
+
+        vast_module mod() { return getOperation(); }
+
+        std::optional< std::string > slot_of(mlir_value lvalue) {
+            auto def = lvalue.getDefiningOp();
+            if (!def) {
+                return std::nullopt;
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(def)) {
+                return ("@" + ref.getGlobal()).str();
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::DeclRefOp >(def)) {
+                if (auto var = ref.getDecl().getDefiningOp< hl::VarDeclOp >()) {
+                    return slot_of(var);
+                }
+                return std::nullopt;
+            }
+
+            if (auto member = mlir::dyn_cast< hl::RecordMemberOp >(def)) {
+                if (auto name = record_name(member.getRecord().getType(), mod())) {
+                    return *name + "." + member.getName().str();
+                }
+                return std::nullopt;
+            }
+
+            // Elements of an array share the slot of the array.
+            if (auto subscript = mlir::dyn_cast< hl::SubscriptOp >(def)) {
+                auto base = subscript.getArray().getDefiningOp();
+                if (base && is_cast(base, hl::CastKind::ArrayToPointerDecay)) {
+                    return slot_of(base->getOperand(0));
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        std::string slot_of(hl::VarDeclOp var) {
+            if (!var.hasLocalStorage()) {
+                return ("@" + var.getName()).str();
+            }
+            return llvm::formatv("%{0}", var.getOperation()).str();
+        }
+
+        void store(string_ref slot, mlir_value value) {
+            if (auto ref = strip_function_casts(value).getDefiningOp< hl::FuncRefOp >()) {
+                slots[slot].insert(ref.getFunctionAttr().getAttr());
+            }
+        }
+
+        // Initializers store into the slots of the elements and fields they
+        // initialize, e.g., `struct ops ops = { .open = f }` into `ops.open`.
+        void initialize(string_ref slot, mlir_value value, mlir_type type) {
+            auto list = value.getDefiningOp< hl::InitListExpr >();
+            if (!list) {
+                store(slot, value);
+                return;
+            }
+
+            auto naked = strip_type(type, mod());
+            if (auto array = mlir::dyn_cast< hl::ArrayType >(naked)) {
+                for (auto element : list.getElements()) {
+                    initialize(slot, element, array.getElementType());
+                }
+                return;
+            }
+
+            auto name = record_name(naked, mod());
+            if (!name) {
+                return;
+            }
+
+            auto def = definition_of(naked, mod());
+            if (!def) {
+                return;
+            }
+
+            auto elements = list.getElements();
+            std::size_t idx = 0;
+            for (auto field : field_defs(*def)) {
+                if (idx == elements.size()) {
+                    break;
+                }
+                initialize(*name + "." + field.getName().str(), elements[idx++], field.getType());
+            }
+        }
+
+        void collect() {
+            mod().walk([&] (operation op) {
+                if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                    auto &init = var.getInitializer();
+                    if (init.empty() || !init.hasOneBlock()) {
+                        return;
+                    }
+                    if (auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.front().getTerminator())) {
+                        initialize(slot_of(var), yield.getResult(), var.getType());
+                    }
+                    return;
+                }
+
+                if (auto assign = mlir::dyn_cast< hl::AssignOp >(op)) {
+                    if (auto slot = slot_of(assign.getDst())) {
+                        store(*slot, assign.getSrc());
+                    }
+                }
+            });
+        }
+
+        // Functions the callee may be, as far as stores of function pointers
+        // tell. A callee that is a function itself is the only target.
+        targets_t targets(hl::IndirectCallOp call) {
+            auto callee = strip_function_casts(call.getCallee());
+
+            // `(*fp)(...)` calls the function `fp` points to.
+            if (auto deref = callee.getDefiningOp< hl::Deref >()) {
+                callee = strip_function_casts(deref.getAddr());
+            }
+
+            if (auto ref = callee.getDefiningOp< hl::FuncRefOp >()) {
+                targets_t result;
+                result.insert(ref.getFunctionAttr().getAttr());
+                return result;
+            }
+
+            auto load = callee.getDefiningOp();
+            if (!load || !is_cast(load, hl::CastKind::LValueToRValue)) {
+                return {};
+            }
+
+            if (auto slot = slot_of(load->getOperand(0))) {
+                if (auto it = slots.find(*slot); it != slots.end()) {
+                    return it->second;
+                }
+            }
+            return {};
+        }
+
+        // The direct call takes the arguments of the indirect one as they are.
+        bool is_compatible(hl::IndirectCallOp call, hl::FuncOp fn) {
+            if (!fn || fn.isVarArg()) {
+                return false;
+            }
+
+            auto type = fn.getFunctionType();
+            if (type.getInputs().size() != call.getArgOperands().size()
+                || !llvm::equal(type.getResults(), call.getResultTypes())
+            ) {
+                return false;
+            }
+
+            for (auto [param, arg] : llvm::zip(type.getInputs(), call.getArgOperands())) {
+                auto lvalue = mlir::dyn_cast< hl::LValueType >(param);
+                if ((lvalue ? lvalue.getElementType() : param) != arg.getType()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        mlir_value is_target(Builder &bld, loc_t loc, hl::IndirectCallOp call, hl::FuncOp fn) {
+            auto ctx = &getContext();
+            auto callee = call.getCallee();
+
+            auto ref = bld.create< hl::FuncRefOp >(
+                loc, hl::LValueType::get(ctx, fn.getFunctionType()), mlir::FlatSymbolRefAttr::get(fn)
+            );
+            auto ptr = bld.create< hl::ImplicitCastOp >(
+                loc, callee.getType(), ref, hl::CastKind::FunctionToPointerDecay
+            );
+            return bld.create< hl::CmpOp >(loc, hl::IntType::get(ctx), hl::Predicate::eq, callee, ptr);
+        }
+
+        operation clone_indirect(Builder &bld, hl::IndirectCallOp call) {
+            return bld.clone(*call.getOperation());
+        }
+
+        // `if (fp == f) f(...); else if (fp == g) g(...); else fp(...);` with
+        // the result, if any, kept in `store`.
+        void emit_statements(
+            Builder &bld, loc_t loc, hl::IndirectCallOp call,
+            llvm::ArrayRef< hl::FuncOp > fns, std::function< void(Builder &, mlir_value) > store
+        ) {
+            if (fns.empty()) {
+                auto indirect = clone_indirect(bld, call);
+                if (store) {
+                    store(bld, indirect->getResult(0));
+                }
+                return;
+            }
+
+            bld.create< hl::IfOp >(loc,
+                [&] (Builder &bld, Location loc) {
+                    bld.create< hl::CondYieldOp >(loc, is_target(bld, loc, call, fns.front()));
+                },
+                [&] (Builder &bld, Location loc) {
+                    auto direct = bld.create< hl::CallOp >(loc, fns.front(), call.getArgOperands());
+                    if (store) {
+                        store(bld, direct.getResult(0));
+                    }
+                },
+                [&] (Builder &bld, Location loc) {
+                    emit_statements(bld, loc, call, fns.drop_front(), store);
+                }
+            );
+        }
+
+        // `fp == f ? f(...) : fp == g ? g(...) : fp(...)` inside of
+        // expressions.
+        mlir_value emit_expression(
+            Builder &bld, loc_t loc, hl::IndirectCallOp call, llvm::ArrayRef< hl::FuncOp > fns
+        ) {
+            if (fns.empty()) {
+                return clone_indirect(bld, call)->getResult(0);
+            }
+
+            auto cond = bld.create< hl::CondOp >(loc, call.getResult(0).getType(),
+                [&] (Builder &bld, Location loc) {
+                    bld.create< hl::CondYieldOp >(loc, is_target(bld, loc, call, fns.front()));
+                },
+                [&] (Builder &bld, Location loc) {
+                    auto direct = bld.create< hl::CallOp >(loc, fns.front(), call.getArgOperands());
+                    bld.create< hl::ValueYieldOp >(loc, direct.getResult(0));
+                },
+                [&] (Builder &bld, Location loc) {
+                    bld.create< hl::ValueYieldOp >(loc, emit_expression(bld, loc, call, fns.drop_front()));
+                }
+            );
+            return cond.getResult();
+        }
+
+        void promote(hl::IndirectCallOp call, llvm::ArrayRef< hl::FuncOp > fns) {
+            auto ctx = &getContext();
+            auto loc = call.getLoc();
+            Builder bld(call);
+
+            if (call->getNumResults() != 1) {
+                return;
+            }
+
+            auto result = call.getResult(0);
+            if (!is_statement_level(call)) {
+                result.replaceAllUsesWith(emit_expression(bld, loc, call, fns));
+                call.erase();
+                return;
+            }
+
+            // The result of a statement call goes through a variable, so that
+            // the direct calls stay statements the inliner takes.
+            if (result.use_empty() || mlir::isa< hl::VoidType >(result.getType())) {
+                if (!result.use_empty()) {
+                    result.replaceAllUsesWith(emit_expression(bld, loc, call, fns));
+                } else {
+                    emit_statements(bld, loc, call, fns, nullptr);
+                }
+                call.erase();
+                return;
+            }
+
+            auto type = hl::LValueType::get(ctx, result.getType());
+            auto var  = bld.create< hl::VarDeclOp >(loc, type, "icp.result");
+            emit_statements(bld, loc, call, fns, [&] (Builder &bld, mlir_value value) {
+                auto ref = bld.create< hl::DeclRefOp >(loc, type, var);
+                bld.create< hl::AssignOp >(loc, ref, value);
+            });
+
+            auto ref  = bld.create< hl::DeclRefOp >(loc, type, var);
+            auto load = bld.create< hl::ImplicitCastOp >(loc, result.getType(), ref, hl::CastKind::LValueToRValue);
+            result.replaceAllUsesWith(load.getResult());
+            call.erase();
+        }
+
+        void runOnOperation() override {
+            slots.clear();
+            collect();
+
+            const auto &symbols = getAnalysis< symbol_table_analysis >();
+
+            llvm::SmallVector< hl::IndirectCallOp > calls;
+            mod().walk([&] (hl::IndirectCallOp call) { calls.push_back(call); });
+
+            for (auto call : calls) {
+                auto names = targets(call);
+                if (names.empty()) {
+                    continue;
+                }
+
+                if (names.size() > max_targets) {
+                    remarks::missed(call, getArgument(), "TooManyTargets")
+                        << "indirect call is not promoted, it has " << names.size() << " targets";
+                    continue;
+                }
+
+                llvm::SmallVector< hl::FuncOp > fns;
+                for (auto name : names) {
+                    auto fn = symbols.lookup< hl::FuncOp >(name);
+                    if (!is_compatible(call, fn)) {
+                        fns.clear();
+                        break;
+                    }
+                    fns.push_back(fn);
+                }
+
+                if (fns.empty()) {
+                    remarks::missed(call, getArgument(), "IncompatibleTarget")
+                        << "indirect call is not promoted, a target does not match its signature";
+                    continue;
+                }
+
+                llvm::SmallVector< string_ref > listed;
+                for (auto fn : fns) {
+                    listed.push_back(fn.getName());
+                }
+
+                remarks::passed(call, getArgument(), "PromotedCall")
+                    << "indirect call is promoted to guarded calls of " << llvm::join(listed, ", ");
+                promote(call, fns);
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLPromoteIndirectCallsPass()
+    {
+        return std::make_unique< HLPromoteIndirectCalls >();
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,223 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Mirrors `llvm::GlobalValue::isDiscardableIfUnused`.
+        bool is_discardable(core::GlobalLinkageKind linkage) {
+            using enum core::GlobalLinkageKind;
+            switch (linkage) {
+                case InternalLinkage:
+                case PrivateLinkage:
+                case LinkOnceAnyLinkage:
+                case LinkOnceODRLinkage:
+                case AvailableExternallyLinkage:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool is_discardable(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return is_discardable(fn.getLinkage());
+            }
+
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                return var.getStorageClass() == StorageClass::sc_static;
+            }
+
+            return mlir::isa<
+                hl::TypeDeclOp, hl::TypeDefOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+        bool is_declaration(operation op) {
+            return mlir::isa<
+                hl::FuncOp, hl::VarDeclOp,
+                hl::TypeDeclOp, hl::TypeDefOp, hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp
+            >(op);
+        }
+
+        string_ref declared_name(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return fn.getSymName();
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >("name")) {
+                return name.getValue();
+            }
+
+            return {};
+        }
+
+    } // namespace
+
+    //
+    // Removes top-level declarations that no live operation refers to. Roots are
+    // all operations that cannot be discarded, i.e., externally visible functions
+    // and variables, and everything that is not a declaration. HL refers to other
+    // declarations by name (callee symbols, `hl.globref`, `hl.enumref`) and by
+    // named types (`!hl.record`, `!hl.enum`, `!hl.typedef`), so any name mentioned
+    // by a live operation keeps all declarations of that name alive.
+    //
+    struct HLSymbolDCE : HLSymbolDCEBase< HLSymbolDCE >
+    {
+        using base = HLSymbolDCEBase< HLSymbolDCE >;
+
+        HLSymbolDCE() = default;
+
+        explicit HLSymbolDCE(llvm::ArrayRef< std::string > roots) {
+            this->roots = roots;
+        }
+
+        // Explicit roots of the `roots` option.
+        llvm::StringSet<> kept;
+
+        bool is_root(operation op) const {
+            if (kept.empty()) {
+                return !is_discardable(op);
+            }
+
+            return !is_declaration(op) || kept.contains(declared_name(op));
+        }
+
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > by_name;
+        llvm::DenseSet< operation > live;
+        llvm::SmallVector< operation > worklist;
+
+        void mark(string_ref name) {
+            auto it = by_name.find(name);
+            if (it == by_name.end()) {
+                return;
+            }
+
+            for (auto op : it->second) {
+                if (live.insert(op).second) {
+                    worklist.push_back(op);
+                }
+            }
+        }
+
+        void mark(mlir_type type) {
+            type.walk([&] (mlir_type nested) {
+                if (auto rec = mlir::dyn_cast< hl::RecordType >(nested)) {
+                    mark(rec.getName());
+                } else if (auto en = mlir::dyn_cast< hl::EnumType >(nested)) {
+                    mark(en.getName());
+                } else if (auto def = mlir::dyn_cast< hl::TypedefType >(nested)) {
+                    mark(def.getName());
+                }
+            });
+        }
+
+        void mark_references(operation root) {
+            root->walk([&] (operation op) {
+                op->getAttrDictionary().walk(
+                    [&] (mlir::StringAttr attr) { mark(attr.getValue()); },
+                    [&] (mlir::FlatSymbolRefAttr attr) { mark(attr.getValue()); },
+                    [&] (mlir_type type) { mark(type); }
+                );
+
+                for (auto type : op->getResultTypes()) {
+                    mark(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArgumentTypes()) {
+                            mark(arg);
+                        }
+                    }
+                }
+            });
+        }
+
+        void collect(mlir::Block &scope, llvm::SmallVectorImpl< operation > &live_roots) {
+            for (auto &op : scope) {
+                if (auto tu = mlir::dyn_cast< hl::TranslationUnitOp >(op)) {
+                    collect(tu.getBody().front(), live_roots);
+                    continue;
+                }
+
+                if (is_root(&op) || !op.use_empty()) {
+                    live_roots.push_back(&op);
+                    continue;
+                }
+
+                by_name[declared_name(&op)].push_back(&op);
+
+                // Enumerators are referenced by name through `hl.enumref`.
+                if (auto en = mlir::dyn_cast< hl::EnumDeclOp >(op)) {
+                    for (auto &constant : en.getConstants().getOps()) {
+                        by_name[declared_name(&constant)].push_back(&op);
+                    }
+                }
+            }
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            kept.clear();
+            for (const auto &name : roots) {
+                kept.insert(name);
+            }
+
+            llvm::SmallVector< operation > live_roots;
+            collect(*mod.getBody(), live_roots);
+
+            mod->getAttrDictionary().walk([&] (mlir_type type) { mark(type); });
+            for (auto root : live_roots) {
+                mark_references(root);
+            }
+
+            while (!worklist.empty()) {
+                mark_references(worklist.pop_back_val());
+            }
+
+            for (auto &[_, ops] : by_name) {
+                for (auto op : ops) {
+                    if (!live.contains(op)) {
+                        // An enum is registered under each of its enumerators.
+                        live.insert(op);
+                        op->erase();
+                    }
+                }
+            }
+
+            by_name.clear();
+            live.clear();
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createHLSymbolDCEPass()
+    {
+        return std::make_unique< HLSymbolDCE >();
+    }
+
+    std::unique_ptr< mlir::Pass > createHLSymbolDCEPass(llvm::ArrayRef< std::string > roots)
+    {
+        return std::make_unique< HLSymbolDCE >(roots);
+    }
+
+} // namespace vast::hl
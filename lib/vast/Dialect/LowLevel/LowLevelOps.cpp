@@ -24,6 +24,16 @@ namespace vast::ll
         return mlir::SuccessorOperands( getOperandsMutable() );
     }
 
+    logical_result Switch::verify()
+    {
+        auto values = getCaseValues();
+        if ( values.getNumElements() != static_cast< std::int64_t >( getCaseDests().size() ) )
+            return emitOpError( "requires a successor for each case value" );
+        if ( values.getElementType() != getValue().getType() )
+            return emitOpError( "requires case values of the switched value type" );
+        return mlir::success();
+    }
+
     // This is currently stolen from HighLevel/HighLevelOps.cpp.
     // Do we need a separate version?
 
@@ -0,0 +1,76 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
+
+#include "vast/Util/Bytecode.hpp"
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::meta
+{
+    namespace
+    {
+        constexpr std::uint64_t bytecode_version = 1;
+
+        // Codes are part of the encoding, new kinds are only appended.
+        enum class attr_code : std::uint64_t { identifier };
+
+    } // namespace
+
+    struct MetaBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        void writeVersion(mlir::DialectBytecodeWriter &writer) const final {
+            util::write_bytecode_version(writer, bytecode_version);
+        }
+
+        std::unique_ptr< mlir::DialectVersion > readVersion(
+            mlir::DialectBytecodeReader &reader
+        ) const final {
+            return util::read_bytecode_version(reader, bytecode_version);
+        }
+
+        mlir::LogicalResult writeAttribute(
+            mlir_attr attr, mlir::DialectBytecodeWriter &writer
+        ) const final {
+            return llvm::TypeSwitch< mlir_attr, mlir::LogicalResult >(attr)
+                .Case([&] (IdentifierAttr id) {
+                    writer.writeVarInt(std::uint64_t(attr_code::identifier));
+                    writer.writeVarInt(id.getValue());
+                    return mlir::success();
+                })
+                .Default([] (mlir_attr) { return mlir::failure(); });
+        }
+
+        mlir_attr readAttribute(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            switch (attr_code(code)) {
+                case attr_code::identifier: {
+                    identifier_t value;
+                    if (mlir::failed(reader.readVarInt(value))) {
+                        return {};
+                    }
+                    return IdentifierAttr::get(getDialect()->getContext(), value);
+                }
+            }
+
+            reader.emitError() << "unknown meta attribute code " << code;
+            return {};
+        }
+    };
+
+    void MetaDialect::registerBytecodeInterface() {
+        addInterfaces< MetaBytecodeDialectInterface >();
+    }
+
+} // namespace vast::meta
@@ -5,6 +5,12 @@
 
 #include "vast/Util/Symbols.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include <optional>
+
 namespace vast::meta
 {
     void MetaDialect::initialize() {
@@ -15,6 +21,8 @@ namespace vast::meta
             #define GET_OP_LIST
             #include "vast/Dialect/Meta/Meta.cpp.inc"
         >();
+
+        registerBytecodeInterface();
     }
 
     static constexpr std::string_view identifier_name = "meta_identifier";
@@ -66,6 +74,85 @@ namespace vast::meta
         return get_with_meta_location(scope, IdentifierAttr::get(ctx, id));
     }
 
+    static std::optional< identifier_t > get_identifier(mlir::Operation *op) {
+        if (auto attr = op->getAttrOfType< IdentifierAttr >(identifier_name)) {
+            return attr.getValue();
+        }
+        return std::nullopt;
+    }
+
+    std::optional< identifier_t > identifier_of(mlir::Operation *op) {
+        if (auto id = get_identifier(op)) {
+            return id;
+        }
+
+        if (auto loc = op->getLoc().dyn_cast< mlir::FusedLoc >()) {
+            if (auto id = loc.getMetadata().dyn_cast_or_null< IdentifierAttr >()) {
+                return id.getValue();
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    identifier_index::identifier_index(mlir::Operation *scope) {
+        util::symbols(scope, [&] (auto symbol) {
+            if (auto id = get_identifier(symbol)) {
+                identified[*id].push_back(symbol);
+            }
+        });
+
+        scope->walk([&](mlir::Operation *op) {
+            if (auto loc = op->getLoc().dyn_cast< mlir::FusedLoc >()) {
+                if (auto id = loc.getMetadata().dyn_cast_or_null< IdentifierAttr >()) {
+                    located[id.getValue()].push_back(op);
+                }
+            }
+        });
+    }
+
+    void identifier_index::add_identifier(mlir::Operation *op, identifier_t id) {
+        remove_identifier(op);
+        meta::add_identifier(op, id);
+        identified[id].push_back(op);
+    }
+
+    void identifier_index::remove_identifier(mlir::Operation *op) {
+        auto id = get_identifier(op);
+        if (!id) {
+            return;
+        }
+
+        meta::remove_identifier(op);
+        auto it = identified.find(*id);
+        if (it == identified.end()) {
+            return;
+        }
+
+        llvm::erase_value(it->second, op);
+        if (it->second.empty()) {
+            identified.erase(it);
+        }
+    }
+
+    llvm::ArrayRef< mlir::Operation * > identifier_index::lookup(
+        const std::unordered_map< identifier_t, operations > &map, identifier_t id
+    ) {
+        auto it = map.find(id);
+        if (it == map.end()) {
+            return {};
+        }
+        return it->second;
+    }
+
+    llvm::ArrayRef< mlir::Operation * > identifier_index::get_with_identifier(identifier_t id) const {
+        return lookup(identified, id);
+    }
+
+    llvm::ArrayRef< mlir::Operation * > identifier_index::get_with_meta_location(identifier_t id) const {
+        return lookup(located, id);
+    }
+
 } // namespace vast::meta
 
 #include "vast/Dialect/Meta/MetaDialect.cpp.inc"
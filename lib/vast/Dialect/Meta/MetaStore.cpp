@@ -0,0 +1,185 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Meta/MetaStore.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::meta
+{
+    namespace
+    {
+        constexpr llvm::StringLiteral magic = "VASTMETA";
+        constexpr std::uint32_t version     = 1;
+
+        // Offsets of the header fields.
+        constexpr std::size_t version_offset     = 8;
+        constexpr std::size_t num_entries_offset = 16;
+        constexpr std::size_t blobs_offset       = 24;
+        constexpr std::size_t header_size        = 32;
+
+        constexpr std::size_t entry_size = 3 * sizeof(std::uint64_t);
+
+    } // namespace
+
+    //
+    // store_builder
+    //
+    void store_builder::add(identifier_t id, string_ref blob) {
+        blobs.insert_or_assign(id, blob.str());
+    }
+
+    void store_builder::add(const store &from) {
+        from.for_each([&] (identifier_t id, string_ref blob) { add(id, blob); });
+    }
+
+    void store_builder::add(const store_builder &from) {
+        for (const auto &[id, blob] : from.blobs) {
+            blobs.insert_or_assign(id, blob);
+        }
+    }
+
+    void store_builder::write(llvm::raw_ostream &os) const {
+        llvm::support::endian::Writer out(os, llvm::support::little);
+
+        std::uint64_t total = 0;
+        for (const auto &[id, blob] : blobs) {
+            total += blob.size();
+        }
+
+        os << magic;
+        out.write< std::uint32_t >(version);
+        out.write< std::uint32_t >(0);
+        out.write< std::uint64_t >(blobs.size());
+        out.write< std::uint64_t >(total);
+
+        std::uint64_t offset = 0;
+        for (const auto &[id, blob] : blobs) {
+            out.write< std::uint64_t >({ id, offset, std::uint64_t(blob.size()) });
+            offset += blob.size();
+        }
+
+        for (const auto &[id, blob] : blobs) {
+            os << blob;
+        }
+    }
+
+    //
+    // store
+    //
+    std::optional< store > store::open(string_ref path, std::string *err) {
+        auto buffer = llvm::MemoryBuffer::getFile(
+            path, /* IsText */ false, /* RequiresNullTerminator */ false
+        );
+
+        if (!buffer) {
+            *err = llvm::formatv("cannot open store '{0}': {1}", path, buffer.getError().message()).str();
+            return std::nullopt;
+        }
+
+        store result(std::move(*buffer));
+        if (!result.verify(err)) {
+            *err = llvm::formatv("malformed store '{0}': {1}", path, *err).str();
+            return std::nullopt;
+        }
+
+        return result;
+    }
+
+    std::uint64_t store::read64(std::size_t offset) const {
+        return llvm::support::endian::read64le(buffer->getBufferStart() + offset);
+    }
+
+    // Lookups rely on the entries being sorted and the blobs in bounds, both
+    // are checked once here.
+    bool store::verify(std::string *err) const {
+        auto size = buffer->getBufferSize();
+        if (size < header_size || !buffer->getBuffer().starts_with(magic)) {
+            *err = "not a metadata store";
+            return false;
+        }
+
+        if (llvm::support::endian::read32le(buffer->getBufferStart() + version_offset) != version) {
+            *err = "unsupported version";
+            return false;
+        }
+
+        auto entries = read64(num_entries_offset);
+        auto blobs   = read64(blobs_offset);
+        if (entries > (size - header_size) / entry_size
+            || header_size + entries * entry_size + blobs != size
+        ) {
+            *err = "truncated store";
+            return false;
+        }
+
+        for (std::uint64_t e = 0; e < entries; ++e) {
+            auto at = header_size + e * entry_size;
+            auto offset = read64(at + 8), blob_size = read64(at + 16);
+            if (offset > blobs || blob_size > blobs - offset) {
+                *err = "invalid blob";
+                return false;
+            }
+
+            if (e > 0 && !(read64(at - entry_size) < read64(at))) {
+                *err = "unsorted identifiers";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::size_t store::size() const { return read64(num_entries_offset); }
+
+    identifier_t store::id_at(std::size_t entry) const {
+        return read64(header_size + entry * entry_size);
+    }
+
+    string_ref store::blob_at(std::size_t entry) const {
+        auto at = header_size + entry * entry_size;
+        auto blobs_start = header_size + size() * entry_size;
+        return { buffer->getBufferStart() + blobs_start + read64(at + 8), read64(at + 16) };
+    }
+
+    std::optional< string_ref > store::lookup(identifier_t id) const {
+        std::size_t lo = 0, hi = size();
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (id_at(mid) < id) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo == size() || id_at(lo) != id) {
+            return std::nullopt;
+        }
+        return blob_at(lo);
+    }
+
+    void store::for_each(std::function< void(identifier_t, string_ref) > yield) const {
+        for (std::size_t e = 0, n = size(); e < n; ++e) {
+            yield(id_at(e), blob_at(e));
+        }
+    }
+
+    void store::for_each_attached(
+        const identifier_index &index,
+        std::function< void(mlir::Operation *, identifier_t, string_ref) > yield
+    ) const {
+        for_each([&] (identifier_t id, string_ref blob) {
+            for (auto op : index.get_with_identifier(id)) {
+                yield(op, id, blob);
+            }
+            for (auto op : index.get_with_meta_location(id)) {
+                yield(op, id, blob);
+            }
+        });
+    }
+
+} // namespace vast::meta
@@ -30,14 +30,24 @@ namespace vast::cc {
 
     } // namespace opt
 
-    static std::string get_output_stream_suffix(output_type act) {
+    static bool emits_bytecode(output_type act, const vast_args &vargs) {
+        return act == output_type::emit_mlir && vargs.has_option(opt::emit_mlir_bytecode);
+    }
+
+    static bool emits_binary(output_type act, const vast_args &vargs) {
+        return emits_bytecode(act, vargs) || act == output_type::emit_bc;
+    }
+
+    static std::string get_output_stream_suffix(output_type act, const vast_args &vargs) {
         switch (act) {
             case output_type::emit_assembly:
                 return "s";
             case output_type::emit_mlir:
-                return "mlir";
+                return emits_bytecode(act, vargs) ? "mlirbc" : "mlir";
             case output_type::emit_llvm:
                 return "ll";
+            case output_type::emit_bc:
+                return "bc";
             case output_type::emit_obj:
                 return "o";
             case output_type::none:
@@ -47,14 +57,25 @@ namespace vast::cc {
         VAST_UNREACHABLE("unsupported action type");
     }
 
-    static auto get_output_stream(compiler_instance &ci, string_ref in, output_type act)
-        -> output_stream_ptr
-    {
+    static auto get_output_stream(
+        compiler_instance &ci, string_ref in, output_type act, const vast_args &vargs
+    ) -> output_stream_ptr {
         if (act == output_type::none) {
             return nullptr;
         }
 
-        return ci.createDefaultOutputFile(false, in, get_output_stream_suffix(act));
+        return ci.createDefaultOutputFile(
+            emits_binary(act, vargs), in, get_output_stream_suffix(act, vargs)
+        );
+    }
+
+    // Declarations-only mode never looks at function bodies, so clang does
+    // not need to parse them either. Neither does a lowering resumed from a
+    // checkpoint, it needs the translation unit only for the target.
+    static void skip_function_bodies_if_requested(compiler_instance &ci, const vast_args &vargs) {
+        if (vargs.has_option(opt::emit_decls_only) || vargs.has_option(opt::start_from)) {
+            ci.getFrontendOpts().SkipFunctionBodies = true;
+        }
     }
 
     vast_stream_action::vast_stream_action(output_type act, const vast_args &vargs)
@@ -69,15 +90,27 @@ namespace vast::cc {
     auto vast_stream_action::CreateASTConsumer(compiler_instance &ci, string_ref input)
         -> std::unique_ptr< clang::ASTConsumer >
     {
+        // The estimate needs the parsed translation unit only, nothing is
+        // generated and no output is written.
+        if (vargs.has_option(opt::estimate_cost)) {
+            return std::make_unique< cost_estimate_consumer >(options(ci), vargs);
+        }
+
+        skip_function_bodies_if_requested(ci, vargs);
+
         auto out = ci.takeOutputStream();
         if (!out) {
-            out = get_output_stream(ci, input, action);
+            out = get_output_stream(ci, input, action, vargs);
         }
 
         auto result = std::make_unique< vast_stream_consumer >(
             action, options(ci), vargs, std::move(out)
         );
 
+        if (vargs.has_option(opt::retarget)) {
+            result->retarget(retargeting::create(ci, vargs));
+        }
+
         consumer = result.get();
 
         // Enable generating macro debug info only when debug info is not disabled and
@@ -111,6 +144,8 @@ namespace vast::cc {
     auto vast_module_action::CreateASTConsumer(compiler_instance &ci, string_ref input)
         -> std::unique_ptr< clang::ASTConsumer >
     {
+        skip_function_bodies_if_requested(ci, vargs);
+
         auto result = std::make_unique< vast_consumer >(options(ci), vargs);
         consumer = result.get();
         return result;
@@ -143,6 +178,13 @@ namespace vast::cc {
         : vast_stream_action(output_type::emit_llvm, vargs)
     {}
 
+    // emit_bc
+    void emit_bc_action::anchor() {}
+
+    emit_bc_action::emit_bc_action(const vast_args &vargs)
+        : vast_stream_action(output_type::emit_bc, vargs)
+    {}
+
     // emit_mlir
     void emit_mlir_action::anchor() {}
 
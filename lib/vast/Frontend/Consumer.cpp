@@ -3,7 +3,22 @@
 #include "vast/Frontend/Consumer.hpp"
 
 VAST_RELAX_WARNINGS
+#include <clang/AST/DeclOpenMP.h>
+
+#include <llvm/ADT/ScopeExit.h>
+#include <clang/Basic/DiagnosticFrontend.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Signals.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/ToolOutputFile.h>
+#include <llvm/TargetParser/Triple.h>
+
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/InitAllDialects.h>
+#include <mlir/Parser/Parser.h>
 
 #include <mlir/Target/LLVMIR/Dialect/All.h>
 #include <mlir/Target/LLVMIR/LLVMTranslationInterface.h>
@@ -16,9 +31,20 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenContext.hpp"
 #include "vast/CodeGen/CodeGenDriver.hpp"
 
+#include "vast/Frontend/ParallelBackend.hpp"
+#include "vast/Frontend/Retarget.hpp"
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
 #include "vast/Util/Common.hpp"
+#include "vast/Util/PassInstrumentation.hpp"
 
 #include "vast/Target/LLVMIR/Convert.hpp"
+#include "vast/Target/LLVMIR/EmbeddedHL.hpp"
+#include "vast/Target/LLVMIR/StackUsage.hpp"
+
+#include <atomic>
 
 namespace vast::cc {
 
@@ -28,12 +54,41 @@ namespace vast::cc {
 
     [[nodiscard]] target_dialect parse_target_dialect(const vast_args::maybe_option_list &list);
 
-    [[nodiscard]] pipeline parse_pipeline(const vast_args::maybe_option_list &list);
+    [[nodiscard]] pipeline parse_pipeline(
+        const vast_args::maybe_option_list &list, unsigned optimization_level
+    );
 
     [[nodiscard]] pipeline parse_pipeline(string_ref from);
 
     [[nodiscard]] target_dialect parse_target_dialect(string_ref from);
 
+    [[nodiscard]] pass_manager_config get_pass_manager_config(
+        const vast_args &vargs, memory_report *memory
+    );
+
+    [[nodiscard]] unsigned parse_backend_threads(const vast_args &vargs);
+
+    [[nodiscard]] unsigned parse_translate_threads(const vast_args &vargs);
+
+    // Report of -vast-stack-usage[=<file>] of a module lowered to the llvm
+    // dialect, `<output>.stack.json` by default.
+    void write_stack_usage(const action_options &opts, const vast_args &vargs, vast_module mod);
+
+    // When the module is verified: never, once after codegen, or also after
+    // each pass.
+    enum class verify_mode { never, once, every_pass };
+
+    [[nodiscard]] verify_mode get_verify_mode(const vast_args &vargs);
+
+    [[nodiscard]] llvmir::lowering_options get_lowering_options(
+        const vast_args &vargs, const action_options &opts
+    );
+
+    [[nodiscard]] std::string tls_model(clang::CodeGenOptions::TLSModel model);
+
+    // Probes of `-vast-instrument[=<probes>]` and `-vast-instrument-calls=<names>`.
+    void set_instrumentation(const vast_args &vargs, llvmir::lowering_options &lowering);
+
     [[nodiscard]] std::string to_string(target_dialect target);
 
     void emit_mlir_output(target_dialect target, owning_module_ref mod, mcontext_t *mctx);
@@ -42,14 +97,54 @@ namespace vast::cc {
 
     source_language get_source_language(const cc::language_options &opts);
 
+    // Per thread, for jobs compiled in one process.
+    static thread_local std::unique_ptr< mcontext_t > preloaded_mcontext = nullptr;
+
+    void preload_mcontext(std::unique_ptr< mcontext_t > mctx) {
+        preloaded_mcontext = std::move(mctx);
+    }
+
     void vast_consumer::Initialize(acontext_t &actx) {
         VAST_CHECK(!mctx, "initialized multiple times");
-        mctx = std::make_unique< mcontext_t >();
+
+        // A resumed compilation does not parse function bodies.
+        if (!resuming()) {
+            cost = cost_report::create(opts, vargs);
+        }
+
+        mctx = preloaded_mcontext
+            ? std::move(preloaded_mcontext)
+            : std::make_unique< mcontext_t >();
+
+        // The time trace profiler records only its own thread, nested passes
+        // have to run on it to be in the trace.
+        if (vargs.has_option(opt::trace)) {
+            mctx->disableMultithreading();
+        }
+
+        if (vargs.has_option(opt::memory_report)) {
+            memory = std::make_unique< memory_report >([&actx] {
+                return actx.getASTAllocatedMemory() + actx.getSideTableAllocatedMemory();
+            });
+        }
+        if (remark_consumer::enabled(opts.codegen)) {
+            remarks = std::make_unique< remark_consumer >(
+                opts.codegen, opts.diags, actx.getSourceManager()
+            );
+        }
+
         cgctx = std::make_unique< cg::codegen_context >(
             *mctx, actx, get_source_language(opts.lang)
         );
 
         codegen = std::make_unique< cg::codegen_driver >(*cgctx, opts, vargs);
+
+        if (!resuming()) {
+            fallback = clang_fallback::create(opts, vargs);
+        }
+        if (fallback) {
+            fallback->consumer().Initialize(actx);
+        }
     }
 
     bool vast_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
@@ -58,11 +153,28 @@ namespace vast::cc {
             "LLVM IR generation of declaration"
         );
 
-        if (opts.diags.hasErrorOccurred()) {
+        if (fallback) {
+            fallback->consumer().HandleTopLevelDecl(decls);
+        }
+
+        if (opts.diags.hasErrorOccurred() || resuming()) {
             return true;
         }
 
-        return codegen->handle_top_level_decl(decls), true;
+        llvm::TimeTraceScope traced("HandleTopLevelDecl", [&] {
+            if (auto named = clang::dyn_cast< clang::NamedDecl >(*decls.begin())) {
+                return named->getQualifiedNameAsString();
+            }
+            return std::string((*decls.begin())->getDeclKindName());
+        });
+
+        cg::codegen_report::scope measured(codegen->report(), *decls.begin());
+        auto start = clang_fallback::clock::now();
+        codegen->handle_top_level_decl(decls);
+        if (fallback) {
+            fallback->measured(decls, clang_fallback::clock::now() - start);
+        }
+        return true;
     }
 
     void vast_consumer::HandleCXXStaticMemberVarInstantiation(clang::VarDecl * /* decl */) {
@@ -73,23 +185,50 @@ namespace vast::cc {
         VAST_UNIMPLEMENTED;
     }
 
-    void vast_consumer::HandleInterestingDecl(clang::DeclGroupRef /* decl */) {
-        VAST_UNIMPLEMENTED;
+    // Declarations deserialized from a precompiled header or preamble, e.g.,
+    // definitions of its inline functions, are handled as parsed ones.
+    void vast_consumer::HandleInterestingDecl(clang::DeclGroupRef decls) {
+        HandleTopLevelDecl(decls);
     }
 
     void vast_consumer::HandleTranslationUnit(acontext_t &actx) {
         // Note that this method is called after `HandleTopLevelDecl` has already
         // ran all over the top level decls. Here clang mostly wraps defered and
         // global codegen, followed by running vast passes.
-        codegen->finalize();
+        if (fallback) {
+            fallback->consumer().HandleTranslationUnit(actx);
+        }
+
+        if (memory) {
+            // Declarations are emitted as they are parsed.
+            memory->sample("parse and codegen", cgctx->mod.get());
+        }
+
+        {
+            llvm::TimeTraceScope traced("codegen_driver::finalize");
+            codegen->finalize();
+        }
+
+        if (memory) {
+            memory->sample("codegen_driver::finalize", cgctx->mod.get());
+        }
+
+        if (cost) {
+            cost->phase("codegen_driver::finalize");
+        }
 
-        if (!vargs.has_option(opt::disable_vast_verifier)) {
+        if (get_verify_mode(vargs) != verify_mode::never) {
+            llvm::TimeTraceScope traced("verify module");
             if (!codegen->verify_module()) {
                 VAST_UNREACHABLE("codegen: module verification error before running vast passes");
             }
         }
 
         compile_via_vast(cgctx->mod.get(), mctx.get());
+
+        if (cost) {
+            cost->phase("emit_high_level_pass");
+        }
     }
 
     void vast_consumer::HandleTagDeclDefinition(clang::TagDecl *decl) {
@@ -99,10 +238,16 @@ namespace vast::cc {
             "vast generation of declaration"
         );
 
-        if (opts.diags.hasErrorOccurred()) {
+        if (fallback) {
+            fallback->consumer().HandleTagDeclDefinition(decl);
+        }
+
+        if (opts.diags.hasErrorOccurred() || resuming()) {
             return;
         }
 
+        cg::codegen_report::scope measured(codegen->report(), decl);
+
         // Don't allow re-entrant calls to generator triggered by PCH
         // deserialization to emit deferred decls.
         cg::defer_handle_of_top_level_decl handling_decl(
@@ -117,7 +262,11 @@ namespace vast::cc {
 
         // For OpenMP emit declare reduction functions, if required.
         if (actx.getLangOpts().OpenMP) {
-            VAST_UNIMPLEMENTED;
+            for (auto member : decl->decls()) {
+                if (clang::isa< clang::OMPDeclareReductionDecl, clang::OMPDeclareMapperDecl >(member)) {
+                    VAST_UNIMPLEMENTED_MSG("OpenMP declare reduction and mapper");
+                }
+            }
         }
     }
 
@@ -126,6 +275,13 @@ namespace vast::cc {
     // }
 
     void vast_consumer::CompleteTentativeDefinition(clang::VarDecl *decl) {
+        if (fallback) {
+            fallback->consumer().CompleteTentativeDefinition(decl);
+        }
+
+        if (resuming()) {
+            return;
+        }
         codegen->handle_top_level_decl(decl);
     }
 
@@ -147,9 +303,60 @@ namespace vast::cc {
     // vast stream consumer
     //
 
+    bool vast_stream_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
+        auto result = base::HandleTopLevelDecl(decls);
+        if (streaming()) {
+            stream_completed_ops();
+        }
+        return result;
+    }
+
     void vast_stream_consumer::HandleTranslationUnit(acontext_t &actx) {
-        base::HandleTranslationUnit(actx);
-        auto mod = result();
+        // Printed here, the consumer is not destroyed with `-disable-free`.
+        auto print_memory_report = llvm::make_scope_exit([&] {
+            if (memory) {
+                memory->print(llvm::errs());
+            }
+        });
+
+        // The report covers the output, whichever it is.
+        auto write_cost_report = llvm::make_scope_exit([&] {
+            if (cost) {
+                cost->phase("output");
+                cost->write();
+            }
+        });
+
+        if (cost) {
+            // Declarations are emitted as they are parsed.
+            cost->phase("parse and codegen");
+            cost->parsed(actx);
+        }
+
+        // Lowering into the llvm dialect and to llvm ir reports remarks
+        // with no other handler.
+        remark_consumer::scope remark_scope(remarks.get(), mctx.get());
+
+        if (streaming()) {
+            base::HandleTranslationUnit(actx);
+            return stream_remaining_ops();
+        }
+
+        owning_module_ref mod;
+        if (resuming()) {
+            mod = load_checkpoint();
+        } else {
+            base::HandleTranslationUnit(actx);
+            mod = result();
+        }
+
+        if (retargets) {
+            retargeted = retargets->plan(actx, mod.get());
+        }
+
+        if (clear_ast_before_lowering()) {
+            clear_ast(actx);
+        }
 
         switch (action) {
             case output_type::emit_assembly:
@@ -164,6 +371,12 @@ namespace vast::cc {
                 return emit_backend_output(
                     backend::Backend_EmitLL, std::move(mod), mctx.get()
                 );
+            // The summary of `-flto=thin` and the module flags of both kinds
+            // of `-flto` are added by the backend of clang.
+            case output_type::emit_bc:
+                return emit_backend_output(
+                    backend::Backend_EmitBC, std::move(mod), mctx.get()
+                );
             case output_type::emit_obj:
                 return emit_backend_output(
                     backend::Backend_EmitObj, std::move(mod), mctx.get()
@@ -173,20 +386,455 @@ namespace vast::cc {
         }
     }
 
+    owning_module_ref vast_stream_consumer::load_checkpoint() {
+        auto path = vargs.get_option(opt::start_from).value();
+
+        // The checkpoint may be at any stage of the lowering.
+        mlir::DialectRegistry registry;
+        mlir::registerAllDialects(registry);
+        vast::registerAllDialects(registry);
+        mctx->appendDialectRegistry(registry);
+
+        auto mod = mlir::parseSourceFile< vast_module >(path, mlir::ParserConfig(mctx.get()));
+        VAST_CHECK(mod, "cannot read the checkpoint {0}", path);
+        VAST_CHECK(mod->getOperation()->hasAttr(llvmir::checkpoint_attr),
+            "{0} is not a checkpoint of -vast-stop-after", path
+        );
+        return mod;
+    }
+
+    bool vast_stream_consumer::clear_ast_before_lowering() const {
+        return opts.codegen.ClearASTBeforeBackend
+            || vargs.has_option(opt::clear_ast_before_lowering);
+    }
+
+    void vast_stream_consumer::clear_ast(acontext_t &actx) {
+        llvm::TimeTraceScope traced("clear ast");
+
+        // Tables of the codegen refer to declarations and types.
+        codegen.reset();
+
+        actx.cleanup();
+        actx.getAllocator().Reset();
+
+        if (memory) {
+            memory->sample("clear ast");
+        }
+    }
+
+    bool vast_stream_consumer::streaming() const {
+        if (action != output_type::emit_mlir || !vargs.has_option(opt::stream_mlir)) {
+            return false;
+        }
+
+        auto trg = parse_target_dialect(vargs.get_options_list(opt::emit_mlir));
+        VAST_CHECK(trg == target_dialect::high_level,
+            "Streaming is supported only for high-level mlir output."
+        );
+        VAST_CHECK(!vargs.has_option(opt::emit_mlir_bytecode),
+            "Streaming is supported only for textual mlir output."
+        );
+        VAST_CHECK(!vargs.has_option(opt::emit_reachable_from),
+            "Streaming cannot emit only the reachable declarations."
+        );
+        VAST_CHECK(!resuming(), "Streaming cannot resume from a checkpoint.");
+        // Both look into bodies at the end of the translation unit, which are
+        // released by then.
+        VAST_CHECK(!vargs.has_option(opt::warn_false_sharing),
+            "Streaming cannot warn about false sharing."
+        );
+        VAST_CHECK(!vargs.has_option(opt::hl_header_cache),
+            "Streaming cannot use the header cache."
+        );
+
+        return true;
+    }
+
+    mlir::OpPrintingFlags vast_stream_consumer::stream_printing_flags() const {
+        mlir::OpPrintingFlags flags;
+        flags.enableDebugInfo(vargs.has_option(opt::show_locs), /* prettyForm */ true);
+        // Do not walk the whole module to number values of a single operation.
+        flags.useLocalScope();
+        return flags;
+    }
+
+    void vast_stream_consumer::stream_module_header() {
+        // The data layout is emitted only when the translation unit is finished,
+        // therefore it is not part of the streamed module attributes.
+        auto mod = cgctx->mod.get();
+
+        auto &os = *output_stream;
+        os << "module";
+        if (auto name = mod.getSymName()) {
+            os << " " << mlir::FlatSymbolRefAttr::get(mctx.get(), name.value());
+        }
+
+        mlir::NamedAttrList attrs(mod->getAttrDictionary());
+        attrs.erase(mlir::SymbolTable::getSymbolAttrName());
+        if (!attrs.empty()) {
+            os << " attributes " << attrs.getDictionary(mctx.get());
+        }
+
+        os << " {\n";
+        stream_header_emitted = true;
+    }
+
+    // Kind and symbol name of a top-level operation, empty if it has no name.
+    static std::string stream_key(operation op) {
+        auto name = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName());
+        if (!name) {
+            name = op->getAttrOfType< mlir::StringAttr >("name");
+        }
+
+        if (!name) {
+            return {};
+        }
+
+        return (op->getName().getStringRef() + "@" + name.getValue()).str();
+    }
+
+    void vast_stream_consumer::stream_completed_ops() {
+        if (!output_stream || opts.diags.hasErrorOccurred()) {
+            return;
+        }
+
+        // Operations of the module are not finished until all deferred
+        // declarations are emitted.
+        if (codegen->has_pending_emission()) {
+            return;
+        }
+
+        if (!stream_header_emitted) {
+            stream_module_header();
+        }
+
+        // New operations are appended, so the last streamed one is found close
+        // to the end. If it is gone, the module is scanned from the start.
+        auto &body = *cgctx->mod->getBody();
+        auto it = body.begin();
+        if (!last_streamed.empty()) {
+            for (auto &op : llvm::reverse(body)) {
+                if (stream_key(&op) == last_streamed) {
+                    it = std::next(op.getIterator());
+                    break;
+                }
+            }
+        }
+
+        // Operations without a name are printed at the end.
+        for (; it != body.end(); ++it) {
+            if (auto key = stream_key(&*it); !key.empty()) {
+                stream_op(&*it, key);
+                last_streamed = std::move(key);
+            }
+        }
+    }
+
+    void vast_stream_consumer::stream_remaining_ops() {
+        if (!output_stream) {
+            return;
+        }
+
+        if (!stream_header_emitted) {
+            stream_module_header();
+        }
+
+        // Catch operations that were not appended to the end of the module.
+        std::vector< operation > completed;
+        for (auto &op : cgctx->mod->getBody()->getOperations()) {
+            auto key = stream_key(&op);
+            if (key.empty()) {
+                print_streamed_op(&op);
+            } else if (postponed.contains(key)) {
+                completed.push_back(&op);
+            } else {
+                stream_op(&op, key);
+            }
+        }
+
+        // Postponed operations are printed last, as later declarations left
+        // them.
+        for (auto op : completed) {
+            print_streamed_op(op);
+        }
+        postponed.clear();
+
+        *output_stream << "}\n";
+    }
+
+    static bool may_be_completed_later(operation op) {
+        if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+            return fn.isDeclaration();
+        }
+
+        if (auto decl = mlir::dyn_cast< hl::EnumDeclOp >(op)) {
+            return !decl.getType();
+        }
+
+        return false;
+    }
+
+    void vast_stream_consumer::stream_op(operation op, string_ref key) {
+        if (!streamed.insert(key).second) {
+            return;
+        }
+
+        if (may_be_completed_later(op)) {
+            postponed.insert(key);
+            return;
+        }
+
+        print_streamed_op(op);
+    }
+
+    // Replaces the body of a printed definition by a single unreachable. The
+    // function still is a definition to codegen, which never emits it again,
+    // and to the finalization of the module.
+    static void release_body(hl::FuncOp fn) {
+        auto &body = fn.getBody();
+        body.dropAllReferences();
+        while (!body.hasOneBlock()) {
+            body.back().erase();
+        }
+
+        auto &entry = body.front();
+        entry.clear();
+        mlir::OpBuilder::atBlockEnd(&entry).create< hl::UnreachableOp >(fn.getLoc());
+    }
+
+    void vast_stream_consumer::print_streamed_op(operation op) {
+        auto fn = mlir::dyn_cast< hl::FuncOp >(op);
+        if (fn && !fn.isDeclaration()) {
+            // The function part of the vast passes run by `compile_via_vast`.
+            if (!stream_passes) {
+                stream_passes = std::make_unique< mlir::PassManager >(
+                    mctx.get(), hl::FuncOp::getOperationName()
+                );
+                configure_pass_manager(*stream_passes, get_pass_manager_config(vargs, memory.get()));
+                stream_passes->addPass(hl::createSpliceTrailingScopes());
+                stream_passes->enableVerifier(get_verify_mode(vargs) == verify_mode::every_pass);
+            }
+
+            if (mlir::failed(stream_passes->run(fn))) {
+                VAST_UNREACHABLE("codegen: MLIR pass manager fails when running vast passes");
+            }
+        }
+
+        if (get_verify_mode(vargs) != verify_mode::never) {
+            if (mlir::failed(mlir::verify(op))) {
+                VAST_UNREACHABLE("codegen: verification error of streamed operation");
+            }
+        }
+
+        op->print(*output_stream, stream_printing_flags());
+        *output_stream << "\n";
+
+        if (fn && !fn.isDeclaration()) {
+            release_body(fn);
+        }
+    }
+
     void vast_stream_consumer::emit_backend_output(
         backend backend_action, owning_module_ref mlir_module, mcontext_t *mctx
     ) {
+        VAST_CHECK(!vargs.has_option(opt::stop_after),
+            "-vast-stop-after writes a checkpoint of mlir, use -vast-emit-mlir=llvm"
+        );
+
         llvm::LLVMContext llvm_context;
         llvmir::register_vast_to_llvm_ir(*mctx);
-        auto pipeline = parse_pipeline(vargs.get_options_list(opt::opt_pipeline));
-        llvmir::lower_hl_module(mlir_module.get(), pipeline);
+        auto pipeline = parse_pipeline(
+            vargs.get_options_list(opt::opt_pipeline), opts.codegen.OptimizationLevel
+        );
+
+        if (fallback) {
+            fallback->select(mlir_module.get());
+        }
+
+        // The module is lowered in place, its high-level form is kept aside.
+        std::optional< std::string > embedded_hl;
+        if (vargs.has_option(opt::embed_hl)) {
+            embedded_hl = llvmir::serialize_hl_module(mlir_module.get());
+        }
+
+        std::vector< owning_module_ref > variants;
+        for (auto variant : retargeted) {
+            variants.push_back(retarget_module(mlir_module.get(), variant->triple));
+        }
+
+        {
+            llvm::TimeTraceScope traced("lower_hl_module");
+            llvmir::lower_hl_module(
+                mlir_module.get(), pipeline, get_pass_manager_config(vargs, memory.get()),
+                get_lowering_options(vargs, opts)
+            );
+        }
+
+        write_stack_usage(opts, vargs, mlir_module.get());
+
+        if (cost) {
+            cost->phase("lower_hl_module");
+        }
+
+        // The lowering has loaded its dialects, the variants are lowered and
+        // emitted concurrently with the module, unless the context is not
+        // thread safe.
+        std::mutex diags_lock;
+        std::atomic_bool variants_failed = false;
+        auto concurrent = !variants.empty() && mctx->isMultithreadingEnabled();
+        llvm::ThreadPool pool(llvm::hardware_concurrency(concurrent ? variants.size() : 1));
+        for (std::size_t i = 0; i < variants.size(); ++i) {
+            auto emit = [&, i] {
+                if (mlir::failed(emit_variant(
+                    backend_action, *retargeted[i], std::move(variants[i]), diags_lock
+                ))) {
+                    variants_failed = true;
+                }
+            };
+
+            if (concurrent) {
+                pool.async(emit);
+            } else {
+                emit();
+            }
+        }
+
+        std::unique_ptr< llvm::Module > mod;
+        {
+            llvm::TimeTraceScope traced("translate to llvm ir");
+            mod = llvmir::translate(
+                mlir_module.get(), llvm_context, parse_translate_threads(vargs)
+            );
+        }
+
+        if (memory) {
+            // The llvm module coexists with the mlir one.
+            memory->sample("translate to llvm ir", mlir_module.get());
+        }
+
+        if (cost) {
+            cost->phase("translate to llvm ir");
+        }
+
+        // The backend is the peak of memory, the mlir module is freed before
+        // it. Types and attributes stay uniqued in the context, which the
+        // variants and the handlers of remarks still use.
+        if (mod) {
+            llvm::TimeTraceScope traced("free mlir module");
+            mlir_module = nullptr;
+        }
+
+        if (memory) {
+            memory->sample("free mlir module");
+        }
+
+        if (fallback) {
+            llvm::TimeTraceScope traced("link functions of clang");
+            VAST_CHECK(mlir::succeeded(fallback->link(*mod)),
+                "cannot link the functions compiled by clang"
+            );
+        }
+
+        if (embedded_hl) {
+            llvmir::embed_hl_module(*mod, *embedded_hl);
+        }
+
+        {
+            llvm::TimeTraceScope traced("EmitBackendOutput");
+            auto dl = cgctx->actx.getTargetInfo().getDataLayoutString();
+
+            // Only objects can be combined after a parallel emission.
+            auto threads = parse_backend_threads(vargs);
+            auto linker  = threads > 1 && backend_action == backend::Backend_EmitObj
+                ? find_relocatable_linker() : std::nullopt;
+            if (linker) {
+                VAST_CHECK(mlir::succeeded(emit_parallel_object(
+                    opts, dl, *mod, threads, *linker, *output_stream, diags_lock
+                )), "cannot emit object file on {0} threads", threads);
+                output_stream.reset();
+            } else {
+                serialized_diagnostics client(opts.diags.getClient(), diags_lock);
+                clang::DiagnosticsEngine serialized(
+                    opts.diags.getDiagnosticIDs(), &opts.diags.getDiagnosticOptions(),
+                    &client, /* ShouldOwnClient */ false
+                );
+
+                clang::EmitBackendOutput(
+                    concurrent ? serialized : opts.diags, opts.headers, opts.codegen,
+                    opts.target, opts.lang, dl, mod.get(), backend_action, &opts.vfs,
+                    std::move(output_stream)
+                );
+            }
+        }
+
+        if (memory) {
+            memory->sample("EmitBackendOutput");
+        }
+
+        if (cost) {
+            cost->phase("EmitBackendOutput");
+        }
+
+        pool.wait();
+        VAST_CHECK(!variants_failed, "cannot emit the outputs of -vast-retarget");
+    }
+
+    logical_result vast_stream_consumer::emit_variant(
+        backend backend_action, const target_variant &variant, owning_module_ref mlir_module,
+        std::mutex &diags_lock
+    ) {
+        auto pipeline = parse_pipeline(
+            vargs.get_options_list(opt::opt_pipeline), opts.codegen.OptimizationLevel
+        );
+
+        std::optional< std::string > embedded_hl;
+        if (vargs.has_option(opt::embed_hl)) {
+            embedded_hl = llvmir::serialize_hl_module(mlir_module.get());
+        }
+
+        // Memory is sampled for the module of the compilation only and the
+        // function cache is not shared among threads.
+        auto lowering = get_lowering_options(vargs, opts);
+        lowering.function_cache.clear();
+        llvmir::lower_hl_module(
+            mlir_module.get(), pipeline, get_pass_manager_config(vargs, nullptr), lowering
+        );
 
+        llvm::LLVMContext llvm_context;
         auto mod = llvmir::translate(mlir_module.get(), llvm_context);
-        auto dl  = cgctx->actx.getTargetInfo().getDataLayoutString();
+        if (!mod) {
+            return mlir::failure();
+        }
+        mlir_module = nullptr;
+
+        if (embedded_hl) {
+            llvmir::embed_hl_module(*mod, *embedded_hl);
+        }
+
+        auto text = backend_action == backend::Backend_EmitAssembly
+            || backend_action == backend::Backend_EmitLL;
+
+        std::error_code ec;
+        auto os = std::make_unique< llvm::raw_fd_ostream >(
+            variant.output(), ec, text ? llvm::sys::fs::OF_Text : llvm::sys::fs::OF_None
+        );
+        if (ec) {
+            return mlir::failure();
+        }
+
+        serialized_diagnostics client(opts.diags.getClient(), diags_lock);
+        clang::DiagnosticsEngine diags(
+            opts.diags.getDiagnosticIDs(), &opts.diags.getDiagnosticOptions(),
+            &client, /* ShouldOwnClient */ false
+        );
+
         clang::EmitBackendOutput(
-            opts.diags, opts.headers, opts.codegen, opts.target, opts.lang, dl, mod.get(),
-            backend_action, &opts.vfs, std::move(output_stream)
+            diags, opts.headers, opts.codegen, variant.probe->getTargetOpts(), variant.lang(),
+            variant.target().getDataLayoutString(), mod.get(), backend_action, &opts.vfs,
+            std::move(os)
         );
+
+        return mlir::failure(diags.hasErrorOccurred());
     }
 
     void vast_stream_consumer::emit_mlir_output(
@@ -197,14 +845,21 @@ namespace vast::cc {
         }
 
         auto setup_pipeline_and_execute = [&] {
-            auto pipeline = parse_pipeline(vargs.get_options_list(opt::opt_pipeline));
+            auto pipeline = parse_pipeline(
+                vargs.get_options_list(opt::opt_pipeline), opts.codegen.OptimizationLevel
+            );
             switch (target) {
                 case target_dialect::high_level:
                     break;
                 case target_dialect::llvm: {
                     // TODO: These should probably be moved outside of `target::llvmir`.
                     llvmir::register_vast_to_llvm_ir(*mctx);
-                    llvmir::lower_hl_module(mod.get(), pipeline);
+                    llvm::TimeTraceScope traced("lower_hl_module");
+                    llvmir::lower_hl_module(
+                        mod.get(), pipeline, get_pass_manager_config(vargs, memory.get()),
+                        get_lowering_options(vargs, opts)
+                    );
+                    write_stack_usage(opts, vargs, mod.get());
                     break;
                 }
                 default:
@@ -226,6 +881,7 @@ namespace vast::cc {
 
         if (vargs.has_option(opt::vast_verify_diags)) {
             mlir::SourceMgrDiagnosticVerifierHandler src_mgr_handler(mlir_src_mgr, mctx);
+            remark_consumer::scope remark_scope(remarks.get(), mctx);
             mctx->printOpOnDiagnostic(false);
             setup_pipeline_and_execute();
 
@@ -237,6 +893,7 @@ namespace vast::cc {
             }
         } else {
             mlir::SourceMgrDiagnosticHandler src_mgr_handler(mlir_src_mgr, mctx);
+            remark_consumer::scope remark_scope(remarks.get(), mctx);
             setup_pipeline_and_execute();
         }
 
@@ -245,16 +902,42 @@ namespace vast::cc {
         //     generator->build_default_methods();
         // }
 
+        // Bytecode always keeps locations, so that it can be read back as is.
+        if (vargs.has_option(opt::emit_mlir_bytecode)) {
+            mlir::BytecodeWriterConfig config("VAST");
+            VAST_CHECK(mlir::succeeded(mlir::writeBytecodeToFile(mod.get(), *output_stream, config)),
+                "cannot write mlir bytecode"
+            );
+            return;
+        }
+
         // FIXME: we cannot roundtrip prettyForm=true right now.
         mlir::OpPrintingFlags flags;
         flags.enableDebugInfo(vargs.has_option(opt::show_locs), /* prettyForm */ true);
 
+        llvm::TimeTraceScope traced("print module");
         mod->print(*output_stream, flags);
     }
 
     void vast_consumer::compile_via_vast(vast_module mod, mcontext_t *mctx) {
-        const bool enable_vast_verifier = !vargs.has_option(opt::disable_vast_verifier);
-        auto pass = cg::emit_high_level_pass(mod, mctx, &cgctx->actx, enable_vast_verifier);
+        const bool enable_vast_verifier = get_verify_mode(vargs) == verify_mode::every_pass;
+        const bool warn_false_sharing   = vargs.has_option(opt::warn_false_sharing);
+
+        // Warnings refer to the sources by their file locations, the handler
+        // reads the files to show the lines. Without a handler, mlir drops
+        // warnings.
+        llvm::SourceMgr mlir_src_mgr;
+        std::optional< mlir::SourceMgrDiagnosticHandler > src_mgr_handler;
+        if (warn_false_sharing) {
+            src_mgr_handler.emplace(mlir_src_mgr, mctx);
+        }
+        remark_consumer::scope remark_scope(remarks.get(), mctx);
+
+        llvm::TimeTraceScope traced("emit_high_level_pass");
+        auto pass = cg::emit_high_level_pass(
+            mod, mctx, &cgctx->actx, enable_vast_verifier, warn_false_sharing,
+            get_pass_manager_config(vargs, memory.get())
+        );
         if (pass.failed()) {
             VAST_UNREACHABLE("codegen: MLIR pass manager fails when running vast passes");
         }
@@ -287,9 +970,9 @@ namespace vast::cc {
         return parse_target_dialect(list->front());
     }
 
-    pipeline parse_pipeline(const vast_args::maybe_option_list &list) {
+    pipeline parse_pipeline(const vast_args::maybe_option_list &list, unsigned optimization_level) {
         if (!list) {
-            return llvmir::default_pipeline();
+            return llvmir::default_pipeline(optimization_level);
         }
 
         if (list->size() != 1) {
@@ -307,10 +990,182 @@ namespace vast::cc {
         if (trg == "baseline") {
             return pipeline::baseline;
         }
+        if (trg == "fast") {
+            return pipeline::fast;
+        }
 
         VAST_UNREACHABLE("Unknown option of pipeline to use: {0}", trg);
     }
 
+    pass_manager_config get_pass_manager_config(const vast_args &vargs, memory_report *memory) {
+        return {
+            .timing         = vargs.has_option(opt::pass_timing),
+            .statistics     = vargs.has_option(opt::pass_statistics),
+            .ir_size_report = vargs.has_option(opt::ir_size_report),
+            .pattern_profile = vargs.has_option(opt::pattern_profile),
+            // Passes are traced with `-ftime-trace` as well.
+            .trace           = llvm::timeTraceProfilerEnabled(),
+            .memory          = memory,
+            .verify_each     = get_verify_mode(vargs) == verify_mode::every_pass
+        };
+    }
+
+    unsigned parse_backend_threads(const vast_args &vargs) {
+        unsigned threads = 1;
+        if (auto value = vargs.get_option(opt::backend_threads)) {
+            if (value->getAsInteger(10, threads) || threads == 0) {
+                VAST_UNREACHABLE("invalid number of backend threads: {0}", value.value());
+            }
+        }
+        return threads;
+    }
+
+    unsigned parse_translate_threads(const vast_args &vargs) {
+        unsigned threads = 1;
+        if (auto value = vargs.get_option(opt::translate_threads)) {
+            if (value->getAsInteger(10, threads) || threads == 0) {
+                VAST_UNREACHABLE("invalid number of translation threads: {0}", value.value());
+            }
+        }
+        return threads;
+    }
+
+    void write_stack_usage(const action_options &opts, const vast_args &vargs, vast_module mod) {
+        // A checkpoint is not lowered to the llvm dialect yet.
+        if (!vargs.has_option(opt::stack_usage) || mod->hasAttr(llvmir::checkpoint_attr)) {
+            return;
+        }
+
+        auto value = vargs.get_option(opt::stack_usage);
+        auto path  = value ? value->str() : report_path(opts, "stack.json");
+
+        std::error_code ec;
+        llvm::ToolOutputFile file(path, ec, llvm::sys::fs::OF_Text);
+        if (ec) {
+            opts.diags.Report(clang::diag::err_fe_unable_to_open_output) << path << ec.message();
+            return;
+        }
+
+        auto input = opts.front.Inputs.empty() ? string_ref() : opts.front.Inputs.front().getFile();
+        llvmir::stack_usage::collect(mod).write(file.os(), input);
+        file.keep();
+    }
+
+    verify_mode get_verify_mode(const vast_args &vargs) {
+        if (vargs.has_option(opt::disable_vast_verifier)) {
+            return verify_mode::never;
+        }
+
+        auto value = vargs.get_option(opt::verify);
+        if (!value) {
+            return verify_mode::every_pass;
+        }
+
+        if (*value == "never") {
+            return verify_mode::never;
+        }
+        if (*value == "once") {
+            return verify_mode::once;
+        }
+        if (*value == "every-pass") {
+            return verify_mode::every_pass;
+        }
+        VAST_UNREACHABLE("Unknown option of verification: {0}", value.value());
+    }
+
+    // Model of `-ftls-model`, the general dynamic one is the default of llvm.
+    std::string tls_model(clang::CodeGenOptions::TLSModel model) {
+        switch (model) {
+            case clang::CodeGenOptions::GeneralDynamicTLSModel: return "";
+            case clang::CodeGenOptions::LocalDynamicTLSModel: return "local-dynamic";
+            case clang::CodeGenOptions::InitialExecTLSModel: return "initial-exec";
+            case clang::CodeGenOptions::LocalExecTLSModel: return "local-exec";
+        }
+        VAST_UNREACHABLE("unknown tls model");
+    }
+
+    std::optional< llvmir::pipeline_stage > get_stop_after(const vast_args &vargs) {
+        auto name = vargs.get_option(opt::stop_after);
+        if (!name) {
+            return std::nullopt;
+        }
+
+        if (auto stage = llvmir::parse_pipeline_stage(name.value())) {
+            return stage;
+        }
+        VAST_UNREACHABLE("unknown stage of the lowering: {0}", name.value());
+    }
+
+    void set_instrumentation(const vast_args &vargs, llvmir::lowering_options &lowering) {
+        lowering.instrument_calls = parse_names(vargs, opt::instrument_calls);
+        if (!vargs.has_option(opt::instrument)) {
+            return;
+        }
+
+        auto probes = parse_names(vargs, opt::instrument);
+        if (probes.empty()) {
+            probes.push_back("functions");
+        }
+
+        for (const auto &probe : probes) {
+            if (probe == "functions") {
+                lowering.instrument_functions = true;
+            } else if (probe == "loops") {
+                lowering.instrument_loops = true;
+            } else if (probe == "timestamps") {
+                lowering.instrument_timestamps = true;
+            } else {
+                VAST_UNREACHABLE("unknown probe of -vast-instrument: {0}", probe);
+            }
+        }
+    }
+
+    // The return slots follow the x86-64 System V rule, records larger than
+    // two eightbytes are returned in memory. Other conventions differ, e.g.,
+    // aarch64 returns homogeneous aggregates of up to 32 bytes in registers,
+    // Windows x64 returns only records of 1, 2, 4 or 8 bytes in a register.
+    bool has_sysv_return_slots(const cc::target_options &target) {
+        llvm::Triple triple(target.Triple);
+        return triple.getArch() == llvm::Triple::x86_64 && !triple.isOSWindows();
+    }
+
+    llvmir::lowering_options get_lowering_options(
+        const vast_args &vargs, const action_options &opts
+    ) {
+        const auto &codegen = opts.codegen;
+        // Clang emits TBAA and lifetime markers only when optimizing.
+        auto optimize = codegen.OptimizationLevel > 0;
+        llvmir::lowering_options lowering = {
+            .strict_aliasing  = optimize && !codegen.RelaxedAliasing,
+            .lifetime_markers = optimize && !codegen.DisableLifetimeMarkers,
+            .signed_overflow_undefined = !opts.lang.isSignedOverflowDefined(),
+            .noundef_params   = !codegen.DisableNoundefAttrs,
+            .value_ranges     = optimize,
+            .strict_enums     = codegen.StrictEnums,
+            .promote_vars     = optimize,
+            .inline_functions = optimize
+                && codegen.getInlining() != clang::CodeGenOptions::OnlyAlwaysInlining,
+            .raise_loops      = vargs.has_option(opt::raise_loops),
+            .rotate_loops     = vargs.has_option(opt::rotate_loops),
+            .openmp           = opts.lang.OpenMP != 0,
+            .tls_model        = tls_model(codegen.getDefaultTLSModel()),
+            .dso_local        = true,
+            .pic              = codegen.RelocationModel != llvm::Reloc::Static,
+            .pie              = opts.lang.PIE,
+            .semantic_interposition = opts.lang.SemanticInterposition
+                || opts.lang.HalfNoSemanticInterposition,
+            .no_plt           = codegen.NoPLT,
+            .direct_access_external_data = codegen.DirectAccessExternalData,
+            .return_slots     = has_sysv_return_slots(opts.target),
+            .line_tables      = codegen.getDebugInfo() != llvm::codegenoptions::NoDebugInfo,
+            .function_cache   = vargs.get_option(opt::function_cache).value_or("").str(),
+            .stop_after       = get_stop_after(vargs)
+        };
+
+        set_instrumentation(vargs, lowering);
+        return lowering;
+    }
+
     target_dialect parse_target_dialect(string_ref from) {
         auto trg = from.lower();
         if (trg == "hl" || trg == "high_level") {
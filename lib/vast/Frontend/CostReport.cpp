@@ -0,0 +1,204 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/CostReport.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Basic/DiagnosticFrontend.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/ToolOutputFile.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+namespace vast::cc {
+
+    namespace {
+
+        struct feature_collector : clang::RecursiveASTVisitor< feature_collector >
+        {
+            using base = clang::RecursiveASTVisitor< feature_collector >;
+
+            // Instantiations are generated as any other function.
+            bool shouldVisitTemplateInstantiations() const { return true; }
+
+            bool TraverseDecl(clang::Decl *decl) {
+                auto fn = clang::dyn_cast_or_null< clang::FunctionDecl >(decl);
+                if (!fn || !fn->doesThisDeclarationHaveABody()) {
+                    return base::TraverseDecl(decl);
+                }
+
+                auto before = features.statements;
+                auto result = base::TraverseDecl(decl);
+                features.max_function_statements = std::max(
+                    features.max_function_statements, features.statements - before
+                );
+                return result;
+            }
+
+            bool VisitDecl(clang::Decl *) {
+                ++features.decls;
+                return true;
+            }
+
+            bool VisitFunctionDecl(clang::FunctionDecl *fn) {
+                features.functions += fn->doesThisDeclarationHaveABody();
+                return true;
+            }
+
+            bool VisitRecordDecl(clang::RecordDecl *decl) {
+                features.records += decl->isThisDeclarationADefinition();
+                return true;
+            }
+
+            bool VisitVarDecl(clang::VarDecl *var) {
+                features.globals += var->hasGlobalStorage()
+                    && var->isThisDeclarationADefinition() != clang::VarDecl::DeclarationOnly;
+                return true;
+            }
+
+            bool VisitStmt(clang::Stmt *) {
+                ++features.statements;
+                return true;
+            }
+
+            tu_features features;
+        };
+
+        double milliseconds(cost_report::clock::duration time) {
+            return std::chrono::duration< double, std::milli >(time).count();
+        }
+
+    } // namespace
+
+    tu_features tu_features::collect(acontext_t &actx) {
+        feature_collector collector;
+        collector.TraverseDecl(actx.getTranslationUnitDecl());
+        return collector.features;
+    }
+
+    cost_model cost_model::load(const vast_args &vargs) {
+        cost_model model;
+        model.coefficients = {
+            { "decls", 0.002 },
+            { "functions", 0.05 },
+            { "records", 0.01 },
+            { "globals", 0.005 },
+            { "statements", 0.01 },
+            { "max_function_statements", 0.002 }
+        };
+
+        auto path = vargs.get_option(opt::cost_model);
+        if (!path) {
+            return model;
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(*path);
+        VAST_CHECK(buffer, "cannot read the cost model {0}: {1}", *path, buffer.getError().message());
+
+        auto value = llvm::json::parse((*buffer)->getBuffer());
+        auto object = value ? value->getAsObject() : nullptr;
+        VAST_CHECK(object, "the cost model {0} is not a JSON object", *path);
+
+        if (auto intercept = object->getNumber("intercept")) {
+            model.intercept = *intercept;
+        }
+
+        // Features the model does not name keep their coefficients.
+        if (auto coefficients = object->getObject("coefficients")) {
+            for (const auto &entry : *coefficients) {
+                auto name   = entry.first.str();
+                auto number = entry.second.getAsNumber();
+                VAST_CHECK(number, "the coefficient of {0} in {1} is not a number", name, *path);
+                model.coefficients[name] = *number;
+            }
+        }
+
+        return model;
+    }
+
+    double cost_model::predict(const tu_features &features) const {
+        double cost = intercept;
+        features.for_each([&] (string_ref name, std::uint64_t value) {
+            cost += coefficients.lookup(name) * double(value);
+        });
+        return std::max(cost, 0.0);
+    }
+
+    std::unique_ptr< cost_report > cost_report::create(const action_options &opts, const vast_args &vargs) {
+        if (!vargs.has_option(opt::cost_report) && !vargs.has_option(opt::estimate_cost)) {
+            return nullptr;
+        }
+
+        auto path = vargs.get_option(opt::cost_report);
+        return std::unique_ptr< cost_report >(new cost_report(
+            opts, path ? path->str() : report_path(opts, "cost.json"), cost_model::load(vargs)
+        ));
+    }
+
+    cost_report::cost_report(const action_options &opts, std::string path, cost_model model)
+        : opts(opts), path(std::move(path)), model(std::move(model))
+        , start(clock::now()), last(start)
+    {}
+
+    void cost_report::phase(string_ref name) {
+        auto now = clock::now();
+        phases.emplace_back(name.str(), now - last);
+        last = now;
+    }
+
+    void cost_report::parsed(acontext_t &actx) {
+        auto before = clock::now();
+        features = tu_features::collect(actx);
+        auto after = clock::now();
+
+        start += after - before;
+        last = after;
+    }
+
+    void cost_report::write() const {
+        std::error_code ec;
+        llvm::ToolOutputFile file(path, ec, llvm::sys::fs::OF_Text);
+        if (ec) {
+            opts.diags.Report(clang::diag::err_fe_unable_to_open_output) << path << ec.message();
+            return;
+        }
+
+        llvm::json::OStream json(file.os(), /* IndentSize */ 2);
+        json.object([&] {
+            json.attribute("file", opts.front.Inputs.empty() ? string_ref() : opts.front.Inputs.front().getFile());
+
+            json.attributeObject("features", [&] {
+                if (features) {
+                    features->for_each([&] (string_ref name, std::uint64_t value) {
+                        json.attribute(name, value);
+                    });
+                }
+            });
+
+            json.attribute("estimate_ms", features ? model.predict(*features) : 0.0);
+
+            // Phases of a full compilation in the order they ran, the total
+            // is their sum.
+            if (!phases.empty()) {
+                json.attributeObject("measured_ms", [&] {
+                    for (const auto &[name, time] : phases) {
+                        json.attribute(name, milliseconds(time));
+                    }
+                    json.attribute("total", milliseconds(last - start));
+                });
+            }
+        });
+        file.os() << "\n";
+        file.keep();
+    }
+
+    void cost_estimate_consumer::HandleTranslationUnit(acontext_t &actx) {
+        report->parsed(actx);
+        report->write();
+    }
+
+} // namespace vast::cc
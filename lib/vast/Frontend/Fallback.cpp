@@ -0,0 +1,305 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Fallback.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/Unsupported/UnsupportedDialect.hpp"
+
+#include "vast/Util/Remarks.hpp"
+
+namespace vast::cc {
+
+    namespace {
+
+        constexpr string_ref remark_pass = "clang-fallback";
+
+        std::optional< std::int64_t > parse_budget(const vast_args &vargs, string_ref option) {
+            auto value = vargs.get_option(option);
+            if (!value) {
+                return std::nullopt;
+            }
+
+            std::int64_t budget = 0;
+            if (value->getAsInteger(10, budget) || budget <= 0) {
+                VAST_UNREACHABLE("invalid budget of -vast-{0}: {1}", option, value.value());
+            }
+            return budget;
+        }
+
+        bool is_unsupported(mlir::Dialect *dialect) {
+            return dialect && mlir::isa< unsup::UnsupportedDialect >(dialect);
+        }
+
+        bool has_unsupported(hl::FuncOp fn) {
+            auto result = fn.walk([] (operation op) {
+                if (is_unsupported(op->getDialect())) {
+                    return mlir::WalkResult::interrupt();
+                }
+                for (auto type : op->getResultTypes()) {
+                    if (is_unsupported(&type.getDialect())) {
+                        return mlir::WalkResult::interrupt();
+                    }
+                }
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool is_local(core::GlobalLinkageKind linkage) {
+            return linkage == core::GlobalLinkageKind::InternalLinkage
+                || linkage == core::GlobalLinkageKind::PrivateLinkage;
+        }
+
+        void drop_body(hl::FuncOp fn) {
+            auto &body = fn.getBody();
+            body.dropAllReferences();
+            body.getBlocks().clear();
+        }
+
+        // Makes `gv` a declaration, so that the linker resolves it to the
+        // definition of the destination.
+        void drop_definition(llvm::GlobalValue *gv) {
+            if (auto fn = llvm::dyn_cast< llvm::Function >(gv)) {
+                fn->deleteBody();
+            } else if (auto var = llvm::dyn_cast< llvm::GlobalVariable >(gv)) {
+                var->setInitializer(nullptr);
+            }
+
+            if (auto obj = llvm::dyn_cast< llvm::GlobalObject >(gv)) {
+                obj->setComdat(nullptr);
+            }
+            gv->setLinkage(llvm::GlobalValue::ExternalLinkage);
+        }
+
+        void export_hidden(llvm::GlobalValue *gv, const std::string &name) {
+            gv->setName(name);
+            gv->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            gv->setVisibility(llvm::GlobalValue::HiddenVisibility);
+            gv->setDSOLocal(true);
+        }
+
+    } // namespace
+
+    std::unique_ptr< clang_fallback > clang_fallback::create(
+        const action_options &opts, const vast_args &vargs
+    ) {
+        auto max_ops  = parse_budget(vargs, opt::fallback_max_ops);
+        auto max_time = parse_budget(vargs, opt::fallback_max_time);
+        if (!vargs.has_option(opt::clang_fallback) && !max_ops && !max_time) {
+            return nullptr;
+        }
+
+        // Only the llvm outputs of the compilation have functions of clang.
+        if (opt::emit_only_mlir(vargs) || vargs.has_option(opt::stream_mlir)) {
+            return nullptr;
+        }
+
+        VAST_CHECK(!vargs.has_option(opt::retarget),
+            "-vast-clang-fallback cannot be combined with -vast-retarget"
+        );
+
+        std::optional< clock::duration > time;
+        if (max_time) {
+            time = std::chrono::milliseconds(*max_time);
+        }
+
+        return std::unique_ptr< clang_fallback >(new clang_fallback(opts, max_ops, time));
+    }
+
+    clang_fallback::clang_fallback(
+        const action_options &opts, std::optional< std::int64_t > max_ops,
+        std::optional< clock::duration > max_time
+    )
+        : opts(opts), max_ops(max_ops), max_time(max_time)
+        , llvm_context(std::make_unique< llvm::LLVMContext >())
+    {
+        codegen.reset(clang::CreateLLVMCodeGen(
+            opts.diags, opts.codegen.MainFileName,
+            llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem >(&opts.vfs),
+            opts.headers, opts.pp, opts.codegen, *llvm_context
+        ));
+    }
+
+    void clang_fallback::measured(clang::DeclGroupRef decls, clock::duration time) {
+        if (!max_time || time <= *max_time) {
+            return;
+        }
+
+        for (auto decl : decls) {
+            auto fn = clang::dyn_cast< clang::FunctionDecl >(decl);
+            if (fn && fn->doesThisDeclarationHaveABody()) {
+                slow.insert(codegen->GetMangledName(clang::GlobalDecl(fn)));
+            }
+        }
+    }
+
+    bool clang_fallback::over_budget(operation fn) const {
+        if (!max_ops) {
+            return false;
+        }
+
+        std::int64_t ops = 0;
+        auto result = fn->walk([&] (operation) {
+            return ++ops > *max_ops ? mlir::WalkResult::interrupt() : mlir::WalkResult::advance();
+        });
+        return result.wasInterrupted();
+    }
+
+    std::size_t clang_fallback::select(vast_module mod) {
+        for (auto fn : llvm::make_early_inc_range(mod.getOps< hl::FuncOp >())) {
+            if (fn.isDeclaration()) {
+                continue;
+            }
+
+            string_ref reason;
+            if (has_unsupported(fn)) {
+                reason = "it has unsupported constructs";
+            } else if (over_budget(fn)) {
+                reason = "it has more operations than the budget";
+            } else if (slow.contains(fn.getSymName())) {
+                reason = "its codegen took longer than the budget";
+            } else {
+                continue;
+            }
+
+            remarks::analysis(fn, remark_pass, "Fallback")
+                << "function is compiled by clang, " << reason;
+
+            selected.insert(fn.getSymName());
+
+            // Declarations are external, the definition of clang has a name
+            // unique to the translation unit, see `share_internals`.
+            if (is_local(fn.getLinkage())) {
+                internal.insert(fn.getSymName());
+                fn.setLinkage(core::GlobalLinkageKind::ExternalLinkage);
+            }
+            drop_body(fn);
+        }
+
+        return selected.size();
+    }
+
+    std::vector< std::string > clang_fallback::share_internals(llvm::Module &dst, llvm::Module &src) {
+        std::vector< std::string > exported;
+        auto unique = [&] (string_ref name) {
+            exported.push_back(llvm::formatv("{0}.vast.fallback", name).str());
+            return exported.back();
+        };
+
+        // Internal functions compiled by clang are declared by vast.
+        for (const auto &entry : internal) {
+            auto name = entry.getKey();
+            auto def  = src.getNamedValue(name);
+            auto decl = dst.getNamedValue(name);
+            if (!def || !decl || def->isDeclaration()) {
+                continue;
+            }
+
+            auto shared = unique(name);
+            export_hidden(def, shared);
+            export_hidden(decl, shared);
+        }
+
+        // Internal definitions of both modules are the ones of vast, e.g., a
+        // `static` variable that both a function of clang and vast use.
+        for (auto &gv : src.global_values()) {
+            if (!gv.hasInternalLinkage() || gv.isDeclaration() || internal.contains(gv.getName())) {
+                continue;
+            }
+
+            if (!llvm::isa< llvm::Function, llvm::GlobalVariable >(gv)) {
+                continue;
+            }
+
+            auto own = dst.getNamedValue(gv.getName());
+            if (!own || own->isDeclaration() || !own->hasInternalLinkage()
+                || own->getValueType() != gv.getValueType()
+            ) {
+                continue;
+            }
+
+            auto shared = unique(gv.getName());
+            export_hidden(own, shared);
+            drop_definition(&gv);
+            gv.setName(shared);
+        }
+
+        return exported;
+    }
+
+    logical_result clang_fallback::link(llvm::Module &dst) {
+        auto built = std::unique_ptr< llvm::Module >(codegen->ReleaseModule());
+        if (selected.empty()) {
+            return mlir::success();
+        }
+
+        if (!built) {
+            return mlir::failure();
+        }
+
+        // The module moves to the context of `dst` as bitcode.
+        llvm::SmallVector< char, 0 > buffer;
+        {
+            llvm::raw_svector_ostream os(buffer);
+            llvm::WriteBitcodeToFile(*built, os);
+        }
+        built.reset();
+
+        auto parsed = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(string_ref(buffer.data(), buffer.size()), "clang-fallback"),
+            dst.getContext()
+        );
+        if (!parsed) {
+            llvm::consumeError(parsed.takeError());
+            return mlir::failure();
+        }
+
+        auto src = std::move(*parsed);
+        src->setDataLayout(dst.getDataLayout());
+        src->setTargetTriple(dst.getTargetTriple());
+
+        // Constructors, used symbols and module flags are emitted by vast for
+        // the whole translation unit.
+        for (auto name : { "llvm.global_ctors", "llvm.global_dtors", "llvm.used", "llvm.compiler.used" }) {
+            if (auto gv = src->getNamedGlobal(name)) {
+                gv->eraseFromParent();
+            }
+        }
+
+        for (auto name : { "llvm.module.flags", "llvm.ident" }) {
+            if (auto md = src->getNamedMetadata(name)) {
+                src->eraseNamedMetadata(md);
+            }
+        }
+
+        auto shared = share_internals(dst, *src);
+
+        // Only definitions `dst` declares are linked, with what they refer to.
+        if (llvm::Linker::linkModules(dst, std::move(src), llvm::Linker::LinkOnlyNeeded)) {
+            return mlir::failure();
+        }
+
+        // The shared symbols are exported only for the link, other translation
+        // units may share symbols of the same names.
+        for (const auto &name : shared) {
+            if (auto gv = dst.getNamedValue(name)) {
+                gv->setVisibility(llvm::GlobalValue::DefaultVisibility);
+                gv->setLinkage(llvm::GlobalValue::InternalLinkage);
+            }
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::cc
@@ -4,6 +4,9 @@
 
 VAST_RELAX_WARNINGS
 #include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/Path.h>
 VAST_UNRELAX_WARNINGS
 
 
@@ -18,19 +21,42 @@ namespace vast::cc {
 
         std::optional< string_ref > get_option_impl(argv_t args, string_ref name) {
             auto is_opt_with_name = [] (auto name) {
+                return [name] (auto arg) {
+                    return name_and_value_view(arg).split('=').first == name;
+                };
+            };
+
+            auto is_opt_with_prefix = [] (auto name) {
                 return [name] (auto arg) {
                     return name_and_value_view(arg).startswith(name);
                 };
             };
 
+            // An option of the exact name wins over a longer one it prefixes,
+            // e.g., `-vast-verify=once` over `-vast-verify-diags`.
             if (auto it = llvm::find_if(args, is_opt_with_name(name)); it != args.end()) {
                 return string_ref(*it).drop_front(vast_option_prefix.size());
             }
 
+            if (auto it = llvm::find_if(args, is_opt_with_prefix(name)); it != args.end()) {
+                return string_ref(*it).drop_front(vast_option_prefix.size());
+            }
+
             return std::nullopt;
         }
     } // detail
 
+    std::string report_path(const action_options &opts, string_ref extension) {
+        llvm::SmallString< 128 > path(opts.front.OutputFile);
+        if (path.empty() || path == "-") {
+            path = opts.front.Inputs.empty()
+                ? string_ref("-") : llvm::sys::path::filename(opts.front.Inputs.front().getFile());
+        }
+
+        llvm::sys::path::replace_extension(path, extension);
+        return path.str().str();
+    }
+
     bool vast_args::has_option(string_ref name) const {
         return detail::get_option_impl(args, name).has_value();
     }
@@ -66,6 +92,21 @@ namespace vast::cc {
         args.push_back(arg);
     }
 
+    // Names of a list option, separated by `;` or `,`.
+    std::vector< std::string > parse_names(const vast_args &vargs, string_ref option) {
+        std::vector< std::string > names;
+        if (auto list = vargs.get_options_list(option)) {
+            for (auto items : list.value()) {
+                llvm::SmallVector< string_ref > split;
+                items.split(split, ',', /* MaxSplit */ -1, /* KeepEmpty */ false);
+                for (auto name : split) {
+                    names.push_back(name.str());
+                }
+            }
+        }
+        return names;
+    }
+
     std::pair< vast_args, argv_storage > filter_args(const argv_storage_base &args) {
         vast_args vargs;
         argv_storage rest;
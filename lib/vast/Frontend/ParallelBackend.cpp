@@ -0,0 +1,163 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/ParallelBackend.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/Diagnostic.h>
+#include <clang/CodeGen/BackendUtil.h>
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+VAST_UNRELAX_WARNINGS
+
+#include <atomic>
+
+namespace vast::cc {
+
+    namespace {
+
+        using bitcode = llvm::SmallString< 0 >;
+
+        // Partitions live in the context of the module, which is not thread
+        // safe. They are handed over to the workers as bitcode.
+        //
+        // Local symbols stay local, users of a local symbol go to the same
+        // partition. Promoted ones would stay global after `ld -r` and clash
+        // with the ones of other objects, e.g., `.str`.
+        std::vector< bitcode > split(llvm::Module &mod, unsigned partitions) {
+            std::vector< bitcode > parts;
+            llvm::SplitModule(mod, partitions, [&] (std::unique_ptr< llvm::Module > part) {
+                llvm::raw_svector_ostream os(parts.emplace_back());
+                llvm::WriteBitcodeToFile(*part, os);
+            }, /* PreserveLocals */ true);
+            return parts;
+        }
+
+        logical_result emit_partition(
+            const action_options &opts, string_ref data_layout, const bitcode &part,
+            string_ref path, std::mutex &diags_lock
+        ) {
+            llvm::LLVMContext lctx;
+            auto mod = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(part.str(), "vast-partition"), lctx
+            );
+            if (!mod) {
+                llvm::consumeError(mod.takeError());
+                return mlir::failure();
+            }
+
+            std::error_code ec;
+            auto os = std::make_unique< llvm::raw_fd_ostream >(path, ec, llvm::sys::fs::OF_None);
+            if (ec) {
+                return mlir::failure();
+            }
+
+            serialized_diagnostics client(opts.diags.getClient(), diags_lock);
+            clang::DiagnosticsEngine diags(
+                opts.diags.getDiagnosticIDs(), &opts.diags.getDiagnosticOptions(),
+                &client, /* ShouldOwnClient */ false
+            );
+
+            clang::EmitBackendOutput(
+                diags, opts.headers, opts.codegen, opts.target, opts.lang, data_layout,
+                mod->get(), clang::Backend_EmitObj, &opts.vfs, std::move(os)
+            );
+
+            return mlir::failure(diags.hasErrorOccurred());
+        }
+
+        logical_result link_relocatable(
+            string_ref linker, const std::vector< std::string > &objects, string_ref output
+        ) {
+            std::vector< string_ref > args = { linker, "-r", "-o", output };
+            args.insert(args.end(), objects.begin(), objects.end());
+
+            std::string error;
+            auto code = llvm::sys::ExecuteAndWait(
+                linker, args, /* Env */ std::nullopt, /* Redirects */ {},
+                /* SecondsToWait */ 0, /* MemoryLimit */ 0, &error
+            );
+            return mlir::success(code == 0);
+        }
+
+    } // namespace
+
+    std::optional< std::string > find_relocatable_linker() {
+        for (auto name : { "ld.lld", "ld" }) {
+            if (auto path = llvm::sys::findProgramByName(name)) {
+                return path.get();
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void serialized_diagnostics::HandleDiagnostic(
+        clang::DiagnosticsEngine::Level level, const clang::Diagnostic &info
+    ) {
+        clang::DiagnosticConsumer::HandleDiagnostic(level, info);
+        if (client) {
+            std::scoped_lock guard(lock);
+            client->HandleDiagnostic(level, info);
+        }
+    }
+
+    logical_result emit_parallel_object(
+        const action_options &opts, string_ref data_layout, llvm::Module &mod,
+        unsigned partitions, string_ref linker, llvm::raw_pwrite_stream &os,
+        std::mutex &diags_lock
+    ) {
+        auto parts = split(mod, partitions);
+
+        // Objects of the partitions followed by the linked one.
+        std::vector< std::string > temporaries;
+        auto cleanup = llvm::make_scope_exit([&] {
+            for (const auto &path : temporaries) {
+                llvm::sys::fs::remove(path);
+            }
+        });
+
+        for (std::size_t i = 0; i <= parts.size(); ++i) {
+            llvm::SmallString< 128 > path;
+            if (llvm::sys::fs::createTemporaryFile("vast-partition", "o", path)) {
+                return mlir::failure();
+            }
+            temporaries.emplace_back(path.str());
+        }
+
+        std::vector< std::string > objects(temporaries.begin(), std::prev(temporaries.end()));
+        const auto &linked = temporaries.back();
+
+        std::atomic_bool failed = false;
+
+        llvm::ThreadPool pool(llvm::hardware_concurrency(partitions));
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            pool.async([&, i] {
+                if (mlir::failed(emit_partition(opts, data_layout, parts[i], objects[i], diags_lock))) {
+                    failed = true;
+                }
+            });
+        }
+        pool.wait();
+
+        if (failed || mlir::failed(link_relocatable(linker, objects, linked))) {
+            return mlir::failure();
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(linked);
+        if (!buffer) {
+            return mlir::failure();
+        }
+
+        os << buffer.get()->getBuffer();
+        return mlir::success();
+    }
+
+} // namespace vast::cc
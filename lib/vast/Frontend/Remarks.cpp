@@ -0,0 +1,175 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Remarks.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/DiagnosticDriver.h>
+#include <clang/Basic/DiagnosticFrontend.h>
+#include <clang/Basic/FileManager.h>
+#include <llvm/Remarks/Remark.h>
+#include <llvm/Remarks/RemarkFormat.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/MLIRContext.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::cc {
+
+    namespace {
+
+        const codegen_options::OptRemark &pattern(const codegen_options &opts, remarks::remark_kind kind) {
+            switch (kind) {
+                case remarks::remark_kind::passed:   return opts.OptimizationRemark;
+                case remarks::remark_kind::missed:   return opts.OptimizationRemarkMissed;
+                case remarks::remark_kind::analysis: return opts.OptimizationRemarkAnalysis;
+            }
+            VAST_UNREACHABLE("unknown remark kind");
+        }
+
+        unsigned diag_id(remarks::remark_kind kind) {
+            switch (kind) {
+                case remarks::remark_kind::passed:
+                    return clang::diag::remark_fe_backend_optimization_remark;
+                case remarks::remark_kind::missed:
+                    return clang::diag::remark_fe_backend_optimization_remark_missed;
+                case remarks::remark_kind::analysis:
+                    return clang::diag::remark_fe_backend_optimization_remark_analysis;
+            }
+            VAST_UNREACHABLE("unknown remark kind");
+        }
+
+        llvm::remarks::Type remark_type(remarks::remark_kind kind) {
+            switch (kind) {
+                case remarks::remark_kind::passed:   return llvm::remarks::Type::Passed;
+                case remarks::remark_kind::missed:   return llvm::remarks::Type::Missed;
+                case remarks::remark_kind::analysis: return llvm::remarks::Type::Analysis;
+            }
+            VAST_UNREACHABLE("unknown remark kind");
+        }
+
+        mlir::FileLineColLoc file_location(mlir::Location loc) {
+            return loc->findInstanceOf< mlir::FileLineColLoc >();
+        }
+
+    } // namespace
+
+    remark_consumer::remark_consumer(
+        const codegen_options &opts, diagnostics_engine &diags, const clang::SourceManager &sm
+    )
+        : opts(opts), diags(diags), sm(sm)
+    {
+        if (opts.OptRecordFile.empty()) {
+            return;
+        }
+
+        string_ref format_name = opts.OptRecordFormat.empty() ? "yaml" : opts.OptRecordFormat;
+        auto format = llvm::remarks::parseFormat(format_name);
+        if (!format) {
+            llvm::consumeError(format.takeError());
+            diags.Report(clang::diag::err_drv_invalid_value)
+                << "-fsave-optimization-record" << format_name;
+            return;
+        }
+
+        std::error_code ec;
+        record_file = std::make_unique< llvm::ToolOutputFile >(
+            opts.OptRecordFile, ec, llvm::sys::fs::OF_TextWithCRLF
+        );
+        if (ec) {
+            diags.Report(clang::diag::err_fe_unable_to_open_output)
+                << opts.OptRecordFile << ec.message();
+            record_file.reset();
+            return;
+        }
+
+        auto serializer = llvm::remarks::createRemarkSerializer(
+            *format, llvm::remarks::SerializerMode::Separate, record_file->os()
+        );
+        if (!serializer) {
+            diags.Report(clang::diag::err_drv_invalid_value)
+                << "-fsave-optimization-record" << llvm::toString(serializer.takeError());
+            record_file.reset();
+            return;
+        }
+        this->serializer = std::move(*serializer);
+
+        if (!opts.OptRecordPasses.empty()) {
+            record_passes.emplace(opts.OptRecordPasses);
+        }
+    }
+
+    remark_consumer::~remark_consumer() {
+        if (record_file) {
+            record_file->keep();
+        }
+    }
+
+    bool remark_consumer::enabled(const codegen_options &opts) {
+        return opts.OptimizationRemark.hasValidPattern()
+            || opts.OptimizationRemarkMissed.hasValidPattern()
+            || opts.OptimizationRemarkAnalysis.hasValidPattern()
+            || !opts.OptRecordFile.empty();
+    }
+
+    logical_result remark_consumer::handle(mlir::Diagnostic &diag) {
+        auto info = remarks::get_remark_info(diag);
+        if (!info) {
+            return mlir::failure();
+        }
+
+        std::lock_guard< std::mutex > guard(lock);
+        const auto &selected = pattern(opts, info->kind);
+        if (selected.hasValidPattern() && selected.patternMatches(info->pass)) {
+            report(*info, diag.getLocation());
+        }
+
+        if (serializer && (!record_passes || record_passes->match(info->pass))) {
+            record(*info, diag.getLocation());
+        }
+
+        return mlir::success();
+    }
+
+    void remark_consumer::report(const remarks::remark_info &info, mlir::Location loc) {
+        clang::SourceLocation source;
+        if (auto file = file_location(loc)) {
+            auto &files = sm.getFileManager();
+            if (auto entry = files.getOptionalFileRef(file.getFilename().getValue())) {
+                source = sm.translateFileLineCol(
+                    &entry->getFileEntry(), file.getLine(), file.getColumn()
+                );
+            }
+        }
+
+        diags.Report(source, diag_id(info.kind))
+            << clang::AddFlagValue(info.pass) << info.message;
+    }
+
+    void remark_consumer::record(const remarks::remark_info &info, mlir::Location loc) {
+        llvm::remarks::Remark remark;
+        remark.RemarkType   = remark_type(info.kind);
+        remark.PassName     = info.pass;
+        remark.RemarkName   = info.name;
+        remark.FunctionName = info.function;
+
+        if (auto file = file_location(loc)) {
+            remark.Loc = llvm::remarks::RemarkLocation{
+                file.getFilename().getValue(), file.getLine(), file.getColumn()
+            };
+        }
+
+        remark.Args.push_back({ "String", info.message, std::nullopt });
+        serializer->emit(remark);
+    }
+
+    remark_consumer::scope::scope(remark_consumer *consumer, mcontext_t *mctx) : mctx(mctx) {
+        id = mctx->getDiagEngine().registerHandler([consumer] (mlir::Diagnostic &diag) {
+            if (!consumer) {
+                return mlir::success(remarks::get_remark_info(diag).has_value());
+            }
+            return consumer->handle(diag);
+        });
+    }
+
+    remark_consumer::scope::~scope() { mctx->getDiagEngine().eraseHandler(id); }
+
+} // namespace vast::cc
@@ -0,0 +1,553 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Retarget.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Basic/Builtins.h>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Lex/MacroInfo.h>
+#include <clang/Lex/Preprocessor.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/BuiltinLayout.hpp"
+#include "vast/Util/DataLayout.hpp"
+#include "vast/Util/Triple.hpp"
+
+#include <utility>
+
+namespace vast::cc {
+
+    //
+    // macro_references
+    //
+    void macro_references::reference(const clang::Token &name, const clang::MacroDefinition &def) {
+        auto info = def.getMacroInfo();
+        if (!info || info->isBuiltinMacro() || sm.isWrittenInBuiltinFile(info->getDefinitionLoc())) {
+            names.insert(name.getIdentifierInfo()->getName());
+        }
+    }
+
+    void macro_references::MacroExpands(
+        const clang::Token &name, const clang::MacroDefinition &def,
+        clang::SourceRange, const clang::MacroArgs *
+    ) {
+        reference(name, def);
+    }
+
+    void macro_references::Defined(
+        const clang::Token &name, const clang::MacroDefinition &def, clang::SourceRange
+    ) {
+        reference(name, def);
+    }
+
+    void macro_references::Ifdef(
+        clang::SourceLocation, const clang::Token &name, const clang::MacroDefinition &def
+    ) {
+        reference(name, def);
+    }
+
+    void macro_references::Ifndef(
+        clang::SourceLocation, const clang::Token &name, const clang::MacroDefinition &def
+    ) {
+        reference(name, def);
+    }
+
+    void macro_references::Elifdef(
+        clang::SourceLocation, const clang::Token &name, const clang::MacroDefinition &def
+    ) {
+        reference(name, def);
+    }
+
+    void macro_references::Elifndef(
+        clang::SourceLocation, const clang::Token &name, const clang::MacroDefinition &def
+    ) {
+        reference(name, def);
+    }
+
+    struct target_code
+    {
+        // Code that depends on the target whatever the target is.
+        std::optional< std::string > reason;
+        bool bitfields     = false;
+        bool wide_literals = false;
+        bool va_list       = false;
+    };
+
+    namespace {
+
+        // Per thread, for jobs compiled in one process.
+        thread_local std::vector< std::shared_ptr< clang::CompilerInvocation > > fallbacks;
+
+        // Function-like builtin macros that answer differently per target.
+        constexpr llvm::StringLiteral target_builtin_macros[] = {
+            "__has_builtin", "__is_target_arch", "__is_target_vendor", "__is_target_os",
+            "__is_target_environment", "__is_target_variant_os", "__is_target_variant_environment"
+        };
+
+        // Macros that give the types of wide literals.
+        constexpr llvm::StringLiteral wide_literal_macros[] = {
+            "__WCHAR_TYPE__", "__CHAR16_TYPE__", "__CHAR32_TYPE__"
+        };
+
+        predefined_macros parse_predefines(string_ref predefines) {
+            predefined_macros macros;
+
+            llvm::SmallVector< string_ref > lines;
+            predefines.split(lines, '\n');
+            for (auto line : lines) {
+                if (line.consume_front("#define ")) {
+                    auto end = line.find_first_of(" (");
+                    macros.insert_or_assign(line.substr(0, end), line.substr(end).str());
+                } else if (line.consume_front("#undef ")) {
+                    macros.erase(line.trim());
+                }
+            }
+
+            return macros;
+        }
+
+        bool same_definition(
+            const predefined_macros &lhs, const predefined_macros &rhs, string_ref name
+        ) {
+            auto l = lhs.find(name), r = rhs.find(name);
+            if (l == lhs.end() || r == rhs.end()) {
+                return (l == lhs.end()) == (r == rhs.end());
+            }
+            return l->second == r->second;
+        }
+
+        // The driver of clang passes `-fno-signed-char` to the compilations
+        // of the targets that are not signed by default.
+        bool is_char_signed_by_default(const llvm::Triple &triple) {
+            switch (triple.getArch()) {
+                case llvm::Triple::aarch64:
+                case llvm::Triple::aarch64_32:
+                case llvm::Triple::aarch64_be:
+                case llvm::Triple::arm:
+                case llvm::Triple::armeb:
+                case llvm::Triple::thumb:
+                case llvm::Triple::thumbeb:
+                    return triple.isOSDarwin() || triple.isOSWindows();
+                case llvm::Triple::ppc:
+                case llvm::Triple::ppc64:
+                    return triple.isOSDarwin();
+                case llvm::Triple::hexagon:
+                case llvm::Triple::ppcle:
+                case llvm::Triple::ppc64le:
+                case llvm::Triple::riscv32:
+                case llvm::Triple::riscv64:
+                case llvm::Triple::systemz:
+                case llvm::Triple::xcore:
+                    return false;
+                default:
+                    return true;
+            }
+        }
+
+        bool same_platform(const llvm::Triple &lhs, const llvm::Triple &rhs) {
+            return lhs.getVendor() == rhs.getVendor()
+                && lhs.getOS() == rhs.getOS()
+                && lhs.getOSVersion() == rhs.getOSVersion()
+                && lhs.getEnvironment() == rhs.getEnvironment()
+                && lhs.getObjectFormat() == rhs.getObjectFormat();
+        }
+
+        struct target_layout
+        {
+            std::uint64_t size = 0;
+            std::uint64_t align = 0;
+            const llvm::fltSemantics *format = nullptr;
+
+            bool operator==(const target_layout &) const = default;
+        };
+
+        std::optional< target_layout > layout_of(const clang::TargetInfo &target, hl::builtin_type type) {
+            using enum hl::builtin_type;
+            switch (type) {
+                case bool_type:
+                    return target_layout{ target.getBoolWidth(), target.getBoolAlign() };
+                case char_type:
+                    return target_layout{ target.getCharWidth(), target.getCharAlign() };
+                case short_type:
+                    return target_layout{ target.getShortWidth(), target.getShortAlign() };
+                case int_type:
+                    return target_layout{ target.getIntWidth(), target.getIntAlign() };
+                case long_type:
+                    return target_layout{ target.getLongWidth(), target.getLongAlign() };
+                case long_long_type:
+                    return target_layout{ target.getLongLongWidth(), target.getLongLongAlign() };
+                // Targets that have `__int128` lay it out alike.
+                case int128_type:
+                    if (!target.hasInt128Type()) {
+                        return std::nullopt;
+                    }
+                    return target_layout{ 128, 128 };
+                case half_type:
+                    return target_layout{
+                        target.getHalfWidth(), target.getHalfAlign(), &target.getHalfFormat()
+                    };
+                case bfloat16_type:
+                    if (!target.hasBFloat16Type()) {
+                        return std::nullopt;
+                    }
+                    return target_layout{
+                        target.getBFloat16Width(), target.getBFloat16Align(),
+                        &target.getBFloat16Format()
+                    };
+                case float_type:
+                    return target_layout{
+                        target.getFloatWidth(), target.getFloatAlign(), &target.getFloatFormat()
+                    };
+                case double_type:
+                    return target_layout{
+                        target.getDoubleWidth(), target.getDoubleAlign(), &target.getDoubleFormat()
+                    };
+                case long_double_type:
+                    return target_layout{
+                        target.getLongDoubleWidth(), target.getLongDoubleAlign(),
+                        &target.getLongDoubleFormat()
+                    };
+                case float128_type:
+                    if (!target.hasFloat128Type()) {
+                        return std::nullopt;
+                    }
+                    return target_layout{
+                        target.getFloat128Width(), target.getFloat128Align(),
+                        &target.getFloat128Format()
+                    };
+                case pointer_type:
+                    return target_layout{
+                        target.getPointerWidth(clang::LangAS::Default),
+                        target.getPointerAlign(clang::LangAS::Default)
+                    };
+            }
+
+            VAST_UNREACHABLE("unknown builtin type");
+        }
+
+        string_ref builtin_name(hl::builtin_type type) {
+            constexpr llvm::StringLiteral names[] = {
+                "bool", "char", "short", "int", "long", "long long", "__int128",
+                "half", "__bf16", "float", "double", "long double", "__float128",
+                "pointers"
+            };
+            return names[std::size_t(type)];
+        }
+
+        bool same_bitfield_layout(const clang::TargetInfo &lhs, const clang::TargetInfo &rhs) {
+            return lhs.useBitFieldTypeAlignment() == rhs.useBitFieldTypeAlignment()
+                && lhs.useZeroLengthBitfieldAlignment() == rhs.useZeroLengthBitfieldAlignment()
+                && lhs.useExplicitBitFieldAlignment() == rhs.useExplicitBitFieldAlignment()
+                && lhs.getZeroLengthBitfieldBoundary() == rhs.getZeroLengthBitfieldBoundary();
+        }
+
+        struct target_code_finder : clang::RecursiveASTVisitor< target_code_finder >
+        {
+            explicit target_code_finder(acontext_t &actx) : actx(actx) {}
+
+            bool VisitGCCAsmStmt(clang::GCCAsmStmt *) {
+                return found("it contains inline assembly");
+            }
+
+            bool VisitMSAsmStmt(clang::MSAsmStmt *) {
+                return found("it contains inline assembly");
+            }
+
+            bool VisitFileScopeAsmDecl(clang::FileScopeAsmDecl *) {
+                return found("it contains inline assembly");
+            }
+
+            bool VisitCallExpr(clang::CallExpr *call) {
+                if (auto id = call->getBuiltinCallee(); id && actx.BuiltinInfo.isTSBuiltin(id)) {
+                    return found(llvm::formatv(
+                        "it calls the target builtin {0}", actx.BuiltinInfo.getName(id)
+                    ).str());
+                }
+                return true;
+            }
+
+            bool VisitFunctionDecl(clang::FunctionDecl *fn) {
+                if (fn->hasAttr< clang::TargetAttr >()
+                    || fn->hasAttr< clang::TargetVersionAttr >()
+                    || fn->hasAttr< clang::TargetClonesAttr >()
+                    || fn->hasAttr< clang::CPUSpecificAttr >()
+                    || fn->hasAttr< clang::CPUDispatchAttr >()
+                ) {
+                    return found(llvm::formatv(
+                        "{0} has a target attribute", fn->getNameAsString()
+                    ).str());
+                }
+                return true;
+            }
+
+            bool VisitFieldDecl(clang::FieldDecl *field) {
+                code.bitfields |= field->isBitField();
+                return true;
+            }
+
+            bool VisitStringLiteral(clang::StringLiteral *lit) {
+                code.wide_literals |= !lit->isOrdinary() && !lit->isUTF8();
+                return true;
+            }
+
+            bool VisitCharacterLiteral(clang::CharacterLiteral *lit) {
+                auto kind = lit->getKind();
+                code.wide_literals |= kind != clang::CharacterLiteral::Ascii
+                    && kind != clang::CharacterLiteral::UTF8;
+                return true;
+            }
+
+            bool VisitVAArgExpr(clang::VAArgExpr *) {
+                code.va_list = true;
+                return true;
+            }
+
+            bool found(std::string reason) {
+                code.reason = std::move(reason);
+                return false;
+            }
+
+            acontext_t &actx;
+            target_code code;
+        };
+
+        target_code find_target_code(acontext_t &actx) {
+            target_code_finder finder(actx);
+            finder.TraverseDecl(actx.getTranslationUnitDecl());
+            finder.code.va_list |= actx.getBuiltinVaListDecl()->isReferenced();
+            return finder.code;
+        }
+
+        // Named after the output of the compilation, with the triple before
+        // its extension.
+        std::string variant_output(string_ref output, const llvm::Triple &triple) {
+            llvm::SmallString< 128 > path(output);
+            llvm::sys::path::replace_extension(
+                path, triple.str() + llvm::sys::path::extension(output).str()
+            );
+            return path.str().str();
+        }
+
+        std::optional< target_variant > make_variant(
+            compiler_instance &ci, const llvm::Triple &triple, bool default_char
+        ) {
+            target_variant variant;
+            variant.triple     = triple;
+            variant.invocation = std::make_shared< clang::CompilerInvocation >(ci.getInvocation());
+            variant.probe      = std::make_unique< compiler_instance >();
+
+            auto &probe = *variant.probe;
+            probe.setInvocation(variant.invocation);
+
+            // Options of the architecture of the compilation do not carry
+            // over, the target gets its defaults.
+            auto &target = probe.getTargetOpts();
+            target.Triple = triple.str();
+            target.CPU.clear();
+            target.TuneCPU.clear();
+            target.ABI.clear();
+            target.FPMath.clear();
+            target.FeaturesAsWritten.clear();
+            target.Features.clear();
+
+            if (default_char) {
+                probe.getLangOpts().CharIsSigned = is_char_signed_by_default(triple);
+            }
+
+            probe.getFrontendOpts().OutputFile = variant_output(ci.getFrontendOpts().OutputFile, triple);
+
+            // Dependencies are written by the compilation of the source only.
+            probe.getDependencyOutputOpts() = clang::DependencyOutputOptions();
+
+            probe.createDiagnostics(new clang::IgnoringDiagConsumer(), /* ShouldOwnClient */ true);
+            if (!probe.createTarget()) {
+                return std::nullopt;
+            }
+
+            probe.createFileManager();
+            probe.createSourceManager(probe.getFileManager());
+            probe.createPreprocessor(clang::TU_Complete);
+            variant.macros = parse_predefines(probe.getPreprocessor().getPredefines());
+            return variant;
+        }
+
+    } // namespace
+
+    //
+    // retargeting
+    //
+    std::unique_ptr< retargeting > retargeting::create(compiler_instance &ci, const vast_args &vargs) {
+        const auto &output = ci.getFrontendOpts().OutputFile;
+        VAST_CHECK(!output.empty() && output != "-",
+            "-vast-retarget names its outputs after the output file, use -o <file>"
+        );
+
+        for (auto option : { opt::emit_mlir, opt::stream_mlir, opt::start_from, opt::stop_after }) {
+            VAST_CHECK(!vargs.has_option(option),
+                "-vast-retarget emits llvm for every target, it does not combine with -vast-{0}",
+                option
+            );
+        }
+
+        auto result = std::make_unique< retargeting >();
+
+        auto &pp = ci.getPreprocessor();
+        auto references = std::make_unique< macro_references >(ci.getSourceManager());
+        result->references = references.get();
+        pp.addPPCallbacks(std::move(references));
+        result->macros = parse_predefines(pp.getPredefines());
+
+        // The precompiled declarations are of the target of the compilation,
+        // their macros are not seen.
+        result->precompiled = !ci.getPreprocessorOpts().ImplicitPCHInclude.empty()
+            || ci.getLangOpts().Modules;
+
+        // Without `-f[no-]signed-char`, `char` is of the default of the target.
+        const auto &triple = ci.getTarget().getTriple();
+        auto default_char  = ci.getLangOpts().CharIsSigned == is_char_signed_by_default(triple);
+
+        for (const auto &name : parse_names(vargs, opt::retarget)) {
+            llvm::Triple variant_triple(llvm::Triple::normalize(name));
+            auto variant = make_variant(ci, variant_triple, default_char);
+            VAST_CHECK(variant, "-vast-retarget: unknown target triple '{0}'", name);
+            result->variants.push_back(std::move(*variant));
+        }
+
+        return result;
+    }
+
+    std::vector< const target_variant * > retargeting::plan(acontext_t &actx, vast_module mod) {
+        auto code = find_target_code(actx);
+
+        std::vector< const target_variant * > retargeted;
+        for (const auto &variant : variants) {
+            if (auto reason = dependence(variant, code, actx, mod)) {
+                auto input = variant.probe->getFrontendOpts().Inputs.front().getFile();
+                llvm::errs() << "remark: " << input << " is compiled again for "
+                             << variant.triple.str() << ", " << *reason << '\n';
+                fallbacks.push_back(variant.invocation);
+            } else {
+                retargeted.push_back(&variant);
+            }
+        }
+
+        return retargeted;
+    }
+
+    std::optional< std::string > retargeting::dependence(
+        const target_variant &variant, const target_code &code, acontext_t &actx, vast_module mod
+    ) const {
+        const auto &target = actx.getTargetInfo();
+        const auto &other  = variant.target();
+
+        if (!same_platform(target.getTriple(), variant.triple)) {
+            return "the targets differ in more than the architecture";
+        }
+
+        if (precompiled) {
+            return "it uses precompiled declarations";
+        }
+
+        if (target.isBigEndian() != other.isBigEndian()) {
+            return "the targets differ in endianness";
+        }
+
+        if (code.reason) {
+            return code.reason;
+        }
+
+        // Entries of the data layout are of the types the module refers to.
+        if (auto spec = mod->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                mlir::DLTIDialect::kDataLayoutAttrName
+        )) {
+            for (auto entry : spec.getEntries()) {
+                if (!dl::DLEntry::is_vast_entry(entry)) {
+                    continue;
+                }
+
+                auto type = hl::builtin_type_of(dl::DLEntry(entry).type);
+                if (!type) {
+                    continue;
+                }
+
+                if (*type == hl::builtin_type::char_type
+                    && actx.getLangOpts().CharIsSigned != variant.lang().CharIsSigned
+                ) {
+                    return "the targets differ in the signedness of char";
+                }
+
+                if (layout_of(target, *type) != layout_of(other, *type)) {
+                    return llvm::formatv(
+                        "the targets differ in the layout of {0}", builtin_name(*type)
+                    ).str();
+                }
+            }
+        }
+
+        if (code.bitfields && !same_bitfield_layout(target, other)) {
+            return "the targets differ in the layout of bit-fields";
+        }
+
+        if (code.va_list && target.getBuiltinVaListKind() != other.getBuiltinVaListKind()) {
+            return "the targets differ in va_list";
+        }
+
+        if (code.wide_literals) {
+            for (auto name : wide_literal_macros) {
+                if (!same_definition(macros, variant.macros, name)) {
+                    return "the targets differ in the types of wide literals";
+                }
+            }
+        }
+
+        // The first of the names, so that the reason does not change from
+        // one compilation to another.
+        std::optional< string_ref > differing;
+        for (const auto &entry : references->names) {
+            auto name = entry.getKey();
+            auto differs = llvm::is_contained(target_builtin_macros, name)
+                || !same_definition(macros, variant.macros, name);
+            if (differs && (!differing || name < *differing)) {
+                differing = name;
+            }
+        }
+
+        if (differing) {
+            return llvm::formatv("it refers to the predefined macro {0}", *differing).str();
+        }
+
+        return std::nullopt;
+    }
+
+    owning_module_ref retarget_module(vast_module mod, const llvm::Triple &triple) {
+        owning_module_ref clone(mod.clone());
+        set_triple(clone.get(), triple.str());
+        hl::select_builtin_layout(clone.get());
+        return clone;
+    }
+
+    std::vector< std::shared_ptr< clang::CompilerInvocation > > take_fallbacks() {
+        return std::exchange(fallbacks, {});
+    }
+
+    vast_args without_retarget(const vast_args &vargs) {
+        vast_args result;
+        for (auto arg : vargs.args) {
+            auto name = string_ref(arg).drop_front(vast_option_prefix.size()).split('=').first;
+            if (name != opt::retarget) {
+                result.push_back(arg);
+            }
+        }
+        return result;
+    }
+
+} // namespace vast::cc
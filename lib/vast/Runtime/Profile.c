@@ -0,0 +1,110 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//
+// Runtime of the counters emitted by `-vast-instrument`.
+//
+// Each instrumented module places one record into the `vast_prof` section:
+//
+//   [ n, label_words, counter_0 ... counter_n-1, labels ... ]
+//
+// where the labels are `label_words` words of newline-separated names of the
+// counters. The linker concatenates the records of all modules between
+// `__start_vast_prof` and `__stop_vast_prof`; at exit, the counters are
+// written to `$VAST_PROF_FILE` (`vast.prof` by default), one `count\tlabel`
+// line per counter.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern uint64_t __start_vast_prof[] __attribute__((weak));
+extern uint64_t __stop_vast_prof[] __attribute__((weak));
+
+static uint64_t vast_prof_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t) hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// Timestamps of the active instrumented calls of a thread. Deeper calls are
+// not timed, their exits are still balanced by `depth`.
+#define VAST_PROF_MAX_DEPTH 256
+
+static _Thread_local uint64_t stack[VAST_PROF_MAX_DEPTH];
+static _Thread_local unsigned depth;
+
+void __vast_prof_enter(uint64_t *cycles) {
+    (void) cycles;
+    if (depth < VAST_PROF_MAX_DEPTH) {
+        stack[depth] = vast_prof_cycles();
+    }
+    ++depth;
+}
+
+void __vast_prof_exit(uint64_t *cycles) {
+    if (depth == 0) {
+        return;
+    }
+
+    if (--depth < VAST_PROF_MAX_DEPTH) {
+        __atomic_fetch_add(cycles, vast_prof_cycles() - stack[depth], __ATOMIC_RELAXED);
+    }
+}
+
+static void vast_prof_dump_record(FILE *out, const uint64_t *record, uint64_t n, uint64_t words) {
+    const uint64_t *counters = record + 2;
+    const char *label = (const char *) (counters + n);
+    const char *end   = label + words * sizeof(uint64_t);
+
+    for (uint64_t i = 0; i < n && label < end; ++i) {
+        const char *next = memchr(label, '\n', (size_t) (end - label));
+        int len = (int) ((next ? next : end) - label);
+        fprintf(out, "%llu\t%.*s\n", (unsigned long long) counters[i], len, label);
+        label = next ? next + 1 : end;
+    }
+}
+
+__attribute__((destructor)) static void vast_prof_dump(void) {
+    const uint64_t *it  = __start_vast_prof;
+    const uint64_t *end = __stop_vast_prof;
+    if (!it || it == end) {
+        return;
+    }
+
+    const char *path = getenv("VAST_PROF_FILE");
+    FILE *out = fopen(path && *path ? path : "vast.prof", "w");
+    if (!out) {
+        return;
+    }
+
+    // Records are aligned to words, the linker may pad between them.
+    while (it + 2 <= end) {
+        uint64_t n = it[0], words = it[1];
+        if (n == 0 && words == 0) {
+            ++it;
+            continue;
+        }
+
+        if (it + 2 + n + words > end) {
+            break;
+        }
+
+        vast_prof_dump_record(out, it, n, words);
+        it += 2 + n + words;
+    }
+
+    fclose(out);
+}
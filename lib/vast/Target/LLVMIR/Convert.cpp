@@ -5,6 +5,11 @@
 VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinOps.h>
 
+#include <mlir/Conversion/ArithToLLVM/ArithToLLVM.h>
+#include <mlir/Conversion/ControlFlowToLLVM/ControlFlowToLLVM.h>
+#include <mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h>
+#include <mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h>
+
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/Dialect/LLVMIR/Transforms/Passes.h>
 
@@ -12,48 +17,181 @@ VAST_RELAX_WARNINGS
 #include <mlir/Target/LLVMIR/Export.h>
 #include <mlir/Target/LLVMIR/Dialect/All.h>
 #include <mlir/Target/LLVMIR/LLVMTranslationInterface.h>
+#include <mlir/Target/LLVMIR/ModuleTranslation.h>
 #include <mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h>
+#include <mlir/Target/LLVMIR/Dialect/OpenMP/OpenMPToLLVMIRTranslation.h>
 
 #include <mlir/Pass/PassManager.h>
+#include <mlir/Transforms/Passes.h>
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Operator.h>
 
+#include <llvm/ADT/StringSwitch.h>
 #include <llvm/ADT/TypeSwitch.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
+#include "vast/Target/LLVMIR/FunctionCache.hpp"
+#include "vast/Target/LLVMIR/ParallelTranslation.hpp"
+
 namespace vast::target::llvmir
 {
     namespace
     {
-        // TODO(target): Unify with tower and opt.
-        void populate_pm(mlir::PassManager &pm, pipeline p)
+        irs_to_llvm_options irs_to_llvm(const lowering_options &opts)
+        {
+            return {
+                .tbaa             = opts.strict_aliasing,
+                .lifetime_markers = opts.lifetime_markers,
+                .no_signed_wrap   = opts.signed_overflow_undefined,
+                .noundef          = opts.noundef_params,
+                .value_ranges     = opts.value_ranges,
+                .promote_vars     = opts.promote_vars,
+                .tls_model        = opts.tls_model,
+                .dso_local        = opts.dso_local,
+                .pic              = opts.pic,
+                .pie              = opts.pie,
+                .semantic_interposition      = opts.semantic_interposition,
+                .no_plt                      = opts.no_plt,
+                .direct_access_external_data = opts.direct_access_external_data,
+                .return_slots                = opts.return_slots
+            };
+        }
+
+        hl::instrument_options instrument(const lowering_options &opts)
+        {
+            return {
+                .functions  = opts.instrument_functions,
+                .loops      = opts.instrument_loops,
+                .timestamps = opts.instrument_timestamps,
+                .calls      = opts.instrument_calls
+            };
+        }
+
+        void populate_simplify_pm(mlir::PassManager &pm, pipeline p, const lowering_options &opts)
+        {
+            // Probes are inserted before the inlining, so that they count
+            // functions of the source.
+            if (auto probes = instrument(opts); probes.any()) {
+                pm.addPass(hl::createHLInstrumentPass(probes));
+            }
+
+            if (p == pipeline::fast) {
+                hl::build_minimal_hl_pipeline(pm, opts.strict_enums);
+                if (opts.openmp) {
+                    pm.addPass(createHLToOMPPass());
+                }
+                return;
+            }
+
+            hl::build_simplify_hl_pipeline(pm, opts.inline_functions, opts.strict_enums);
+            // Worksharing loops are converted first, so that they are not
+            // raised to `scf.for`.
+            if (opts.openmp) {
+                pm.addPass(createHLToOMPPass());
+            }
+            if (opts.raise_loops) {
+                pm.addPass(createHLToSCFPass());
+            }
+        }
+
+        // Raised loops are lowered to branches once the rest of the function
+        // is in ll, so that the structured lowering of ll does not see them.
+        void populate_to_llvm_pm(mlir::PassManager &pm, pipeline p, const lowering_options &opts)
         {
+            if (opts.raise_loops) {
+                pm.addPass(mlir::createConvertSCFToCFPass());
+            }
+
+            auto irs_opts = irs_to_llvm(opts);
+            if (p == pipeline::fast) {
+                irs_opts.simplify_cfg = false;
+                irs_opts.promote_vars = false;
+            }
+            build_to_llvm_pipeline(pm, irs_opts);
+
+            if (opts.raise_loops) {
+                pm.addPass(mlir::createArithToLLVMConversionPass());
+                pm.addPass(mlir::cf::createConvertControlFlowToLLVMPass());
+            }
+
+            // Casts between signed and signless integers of raised and
+            // worksharing loops, see `loops::counted_loop`.
+            if (opts.raise_loops || opts.openmp) {
+                pm.addPass(mlir::createReconcileUnrealizedCastsPass());
+            }
+        }
+
+        std::vector< pipeline_stage > stages(pipeline p)
+        {
+            using enum pipeline_stage;
             switch (p)
             {
-                case pipeline::baseline:
-                {
-                    hl::build_simplify_hl_pipeline(pm);
-                    build_to_ll_pipeline(pm);
-                    build_to_llvm_pipeline(pm);
-                    return;
+                case pipeline::baseline: return { simplify, to_ll, to_llvm };
+                case pipeline::with_abi: return { simplify, abi, to_ll, to_llvm };
+                case pipeline::fast:     return { simplify, to_ll, to_llvm };
+            }
+            VAST_UNREACHABLE("unknown pipeline");
+        }
+
+        void populate_stage(
+            mlir::PassManager &pm, pipeline p, pipeline_stage stage, const lowering_options &opts
+        ) {
+            switch (stage)
+            {
+                case pipeline_stage::simplify: return populate_simplify_pm(pm, p, opts);
+                case pipeline_stage::abi:      return build_abi_pipeline(pm);
+                case pipeline_stage::to_ll:    return build_to_ll_pipeline(pm, opts.rotate_loops);
+                case pipeline_stage::to_llvm:  return populate_to_llvm_pm(pm, p, opts);
+            }
+        }
+
+        // Populates the stages after `resume_after` up to `opts.stop_after`.
+        // Returns true if the module ends up in the llvm dialect.
+        // TODO(target): Unify with tower and opt.
+        bool populate_pm(
+            mlir::PassManager &pm, pipeline p, const lowering_options &opts,
+            std::optional< pipeline_stage > resume_after
+        ) {
+            auto all = stages(p);
+            auto check_stage = [&] (std::optional< pipeline_stage > stage) {
+                VAST_CHECK(!stage || llvm::is_contained(all, *stage),
+                    "stage {0} is not a part of the lowering pipeline", to_string(*stage)
+                );
+            };
+            check_stage(resume_after);
+            check_stage(opts.stop_after);
+            VAST_CHECK(!resume_after || !opts.stop_after || *resume_after < *opts.stop_after,
+                "cannot stop after {0}, the module is already lowered after {1}",
+                to_string(*opts.stop_after), to_string(*resume_after)
+            );
+
+            bool run = !resume_after;
+            for (auto stage : all) {
+                if (run) {
+                    populate_stage(pm, p, stage, opts);
+                    if (stage == opts.stop_after) {
+                        return stage == pipeline_stage::to_llvm;
+                    }
                 }
-                case pipeline::with_abi:
-                {
-                    hl::build_simplify_hl_pipeline(pm);
-                    build_abi_pipeline(pm);
-                    build_to_ll_pipeline(pm);
-                    build_to_llvm_pipeline(pm);
-                    return;
+
+                if (stage == resume_after) {
+                    run = true;
                 }
             }
 
+            return run && resume_after != pipeline_stage::to_llvm;
         }
     } // namespace
 
@@ -74,6 +212,80 @@ namespace vast::target::llvmir
                     return mlir::failure();
                 });
         }
+
+        mlir::LogicalResult amendOperation(mlir::Operation *op, mlir::NamedAttribute attr,
+                                           mlir::LLVM::ModuleTranslation &state) const final
+        {
+            if (attr.getName() == hl::NoSignedWrapAttr::attr_name()) {
+                set_no_signed_wrap(op, state);
+            }
+            if (attr.getName() == hl::ValueRangeAttr::attr_name()) {
+                set_value_range(op, mlir::cast< hl::ValueRangeAttr >(attr.getValue()), state);
+            }
+            if (attr.getName() == hl::TailCallAttr::attr_name()) {
+                set_tail_call_kind(op, llvm::CallInst::TCK_Tail, state);
+            }
+            if (attr.getName() == hl::MustTailAttr::attr_name()) {
+                set_tail_call_kind(op, llvm::CallInst::TCK_MustTail, state);
+            }
+            return mlir::success();
+        }
+
+      private:
+        // Arithmetic of constant operands may be folded by the ir builder.
+        static void set_no_signed_wrap(mlir::Operation *op, mlir::LLVM::ModuleTranslation &state)
+        {
+            auto value = op->getNumResults() == 1 ? state.lookupValue(op->getResult(0)) : nullptr;
+            if (llvm::isa_and_nonnull< llvm::OverflowingBinaryOperator >(value)) {
+                if (auto inst = llvm::dyn_cast< llvm::Instruction >(value)) {
+                    inst->setHasNoSignedWrap(true);
+                }
+            }
+        }
+
+        // A range that covers all values of the loaded type, e.g., of a `bool`
+        // loaded as `i1`, is not valid metadata, the load is still `noundef`.
+        static void set_value_range(
+            mlir::Operation *op, hl::ValueRangeAttr range, mlir::LLVM::ModuleTranslation &state
+        ) {
+            if (!mlir::isa< mlir::LLVM::LoadOp >(op)) {
+                return;
+            }
+
+            auto load = llvm::dyn_cast_or_null< llvm::LoadInst >(state.lookupValue(op->getResult(0)));
+            if (!load || !load->getType()->isIntegerTy()) {
+                return;
+            }
+
+            auto &ctx  = load->getContext();
+            auto width = load->getType()->getIntegerBitWidth();
+            llvm::APInt low(width, range.getLow(), /* isSigned */ true);
+            llvm::APInt high(width, range.getHigh(), /* isSigned */ true);
+            if (low != high) {
+                load->setMetadata(llvm::LLVMContext::MD_range, llvm::MDBuilder(ctx).createRange(low, high));
+            }
+            load->setMetadata(llvm::LLVMContext::MD_noundef, llvm::MDNode::get(ctx, {}));
+        }
+
+        // Calls without a result are not mapped to values, but the call is the
+        // last instruction of its block while its attributes are amended.
+        static void set_tail_call_kind(
+            mlir::Operation *op, llvm::CallInst::TailCallKind kind,
+            mlir::LLVM::ModuleTranslation &state
+        ) {
+            if (!mlir::isa< mlir::LLVM::CallOp >(op)) {
+                return;
+            }
+
+            auto block = state.lookupBlock(op->getBlock());
+            if (!block || block->empty()) {
+                return;
+            }
+
+            if (auto call = llvm::dyn_cast< llvm::CallInst >(&block->back())) {
+                call->setTailCallKind(kind);
+            }
+        }
     };
 
     // TODO: move to translation passes that erase specific types from module
@@ -100,8 +312,32 @@ namespace vast::target::llvmir
         );
     }
 
+    llvm::GlobalValue::ThreadLocalMode tls_mode(llvm::StringRef model) {
+        return llvm::StringSwitch< llvm::GlobalValue::ThreadLocalMode >(model)
+            .Case("global-dynamic", llvm::GlobalValue::GeneralDynamicTLSModel)
+            .Case("local-dynamic", llvm::GlobalValue::LocalDynamicTLSModel)
+            .Case("initial-exec", llvm::GlobalValue::InitialExecTLSModel)
+            .Case("local-exec", llvm::GlobalValue::LocalExecTLSModel)
+            .Default(llvm::GlobalValue::GeneralDynamicTLSModel);
+    }
+
+    // The LLVM dialect has no notion of TLS models, the models of thread-local
+    // globals are set on the translated module.
+    void set_tls_models(vast_module mlir_module, llvm::Module &mod) {
+        mlir_module.walk([&] (mlir::LLVM::GlobalOp op) {
+            auto model = op->getAttrOfType< hl::TLSModelAttr >(hl::TLSModelAttr::attr_name());
+            if (!model) {
+                return;
+            }
+
+            if (auto global = mod.getNamedGlobal(op.getSymName())) {
+                global->setThreadLocalMode(tls_mode(model.getModel()));
+            }
+        });
+    }
+
     std::unique_ptr< llvm::Module > translate(
-        vast_module mlir_module, llvm::LLVMContext &llvm_ctx
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx, unsigned threads
     ) {
         clean_up_data_layout(mlir_module);
 
@@ -114,22 +350,68 @@ namespace vast::target::llvmir
 
         mlir::registerBuiltinDialectTranslation(*mlir_module.getContext());
         mlir::registerLLVMDialectTranslation(*mlir_module.getContext());
+        mlir::registerOpenMPDialectTranslation(*mlir_module.getContext());
+
+        auto mod = threads > 1
+            ? translate_parallel(mlir_module, llvm_ctx, threads)
+            : mlir::translateModuleToLLVMIR(mlir_module, llvm_ctx);
+        if (mod) {
+            set_tls_models(mlir_module, *mod);
+        }
+        return mod;
+    }
 
-        return mlir::translateModuleToLLVMIR(mlir_module, llvm_ctx);
+    std::optional< pipeline_stage > parse_pipeline_stage(string_ref name)
+    {
+        return llvm::StringSwitch< std::optional< pipeline_stage > >(name)
+            .Case("simplify", pipeline_stage::simplify)
+            .Case("abi", pipeline_stage::abi)
+            .Case("to-ll", pipeline_stage::to_ll)
+            .Case("to-llvm", pipeline_stage::to_llvm)
+            .Default(std::nullopt);
     }
 
-    void lower_hl_module(mlir::Operation *op, pipeline p)
+    string_ref to_string(pipeline_stage stage)
     {
+        switch (stage)
+        {
+            case pipeline_stage::simplify: return "simplify";
+            case pipeline_stage::abi:      return "abi";
+            case pipeline_stage::to_ll:    return "to-ll";
+            case pipeline_stage::to_llvm:  return "to-llvm";
+        }
+        VAST_UNREACHABLE("unknown pipeline stage");
+    }
+
+    void lower_hl_module(
+        mlir::Operation *op, pipeline p, const pass_manager_config &config,
+        const lowering_options &opts
+    ) {
+        std::optional< pipeline_stage > resume_after;
+        if (auto checkpoint = op->getAttrOfType< mlir::StringAttr >(checkpoint_attr)) {
+            resume_after = parse_pipeline_stage(checkpoint.getValue());
+            VAST_CHECK(resume_after, "unknown checkpoint of the lowering: {0}", checkpoint.getValue());
+            op->removeAttr(checkpoint_attr);
+        }
+
         auto mctx = op->getContext();
         mlir::PassManager pm(mctx);
-        populate_pm(pm, p);
+        configure_pass_manager(pm, config);
+        auto to_llvm = populate_pm(pm, p, opts, resume_after);
 
         // This is necessary to have line tables emitted and basic
         // debugger working. In the future we will add proper debug information
         // emission directly from our frontend.
-        pm.addNestedPass<mlir::LLVM::LLVMFuncOp>(
-            mlir::LLVM::createDIScopeForLLVMFuncOpPass()
-        );
+        //
+        // Without debug info, no location reaches the llvm module, they are
+        // dropped instead of being carried through the translation.
+        if (to_llvm && opts.line_tables) {
+            pm.addNestedPass<mlir::LLVM::LLVMFuncOp>(
+                mlir::LLVM::createDIScopeForLLVMFuncOpPass()
+            );
+        } else if (to_llvm) {
+            pm.addPass(mlir::createStripDebugInfoPass());
+        }
 
         pm.enableIRPrinting([](auto *, auto *) { return false; }, // before
                             [](auto *, auto *) { return true; }, //after
@@ -139,14 +421,32 @@ namespace vast::target::llvmir
                             llvm::errs());
 
 
+        // Cached bodies are lowered by the whole pipeline.
+        std::optional< function_cache > cache;
+        if (!opts.function_cache.empty() && !resume_after && !opts.stop_after) {
+            cache.emplace(opts.function_cache, p, opts);
+            cache->drop_cached_bodies(mlir::cast< vast_module >(op));
+        }
+
         auto run_result = pm.run(op);
 
         VAST_CHECK(mlir::succeeded(run_result), "Some pass in prepare_module() failed");
+
+        if (cache) {
+            cache->restore_cached_bodies(mlir::cast< vast_module >(op));
+        }
+
+        if (opts.stop_after) {
+            op->setAttr(checkpoint_attr, mlir::StringAttr::get(mctx, to_string(*opts.stop_after)));
+        }
     }
 
     void register_vast_to_llvm_ir(mlir::DialectRegistry &registry)
     {
         registry.insert< hl::HighLevelDialect >();
+        registry.addExtension(+[] (mcontext_t *, hl::HighLevelDialect *dialect) {
+            dialect->addInterfaces< ToLLVMIR >();
+        });
         mlir::registerAllToLLVMIRTranslations(registry);
     }
 
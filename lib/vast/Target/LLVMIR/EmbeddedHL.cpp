@@ -0,0 +1,168 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Target/LLVMIR/EmbeddedHL.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Parser/Parser.h>
+
+#include <llvm/BinaryFormat/Magic.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::target::llvmir
+{
+    namespace
+    {
+        constexpr llvm::StringLiteral frame_magic = "VASTHLBC";
+
+        constexpr std::size_t frame_header_size = 16;
+
+        // Mach-O names the segment along with the section, objects list the
+        // section alone.
+        string_ref section_name(string_ref section) {
+            auto [segment, name] = section.split(',');
+            return name.empty() ? segment : name;
+        }
+
+        logical_result split_frames(
+            string_ref data, mcontext_t &mctx, std::vector< owning_module_ref > &modules,
+            std::string *err
+        ) {
+            while (!data.empty()) {
+                if (data.size() < frame_header_size || !data.consume_front(frame_magic)) {
+                    *err = "malformed frame of an embedded module";
+                    return mlir::failure();
+                }
+
+                auto size = llvm::support::endian::read64le(data.data());
+                data = data.drop_front(sizeof(std::uint64_t));
+                if (size > data.size()) {
+                    *err = "truncated frame of an embedded module";
+                    return mlir::failure();
+                }
+
+                // The bytecode reader needs an aligned buffer of its own.
+                llvm::SourceMgr source_mgr;
+                source_mgr.AddNewSourceBuffer(
+                    llvm::MemoryBuffer::getMemBufferCopy(data.take_front(size), "embedded hl module"),
+                    llvm::SMLoc()
+                );
+
+                auto mod = mlir::parseSourceFile< vast_module >(source_mgr, &mctx);
+                if (!mod) {
+                    *err = llvm::formatv("cannot read embedded module {0}", modules.size()).str();
+                    return mlir::failure();
+                }
+
+                modules.push_back(std::move(mod));
+                data = data.drop_front(size);
+            }
+
+            return mlir::success();
+        }
+
+    } // namespace
+
+    string_ref embedded_hl_section(const llvm::Triple &triple) {
+        return triple.isOSBinFormatMachO() ? "__VAST,__vast_hl" : ".vast_hl";
+    }
+
+    std::string serialize_hl_module(vast_module mod) {
+        std::string frame;
+        llvm::raw_string_ostream os(frame);
+        llvm::support::endian::Writer out(os, llvm::support::little);
+
+        std::string bytecode;
+        llvm::raw_string_ostream bc(bytecode);
+        mlir::BytecodeWriterConfig config("VAST");
+        VAST_CHECK(mlir::succeeded(mlir::writeBytecodeToFile(mod, bc, config)),
+            "cannot write the embedded hl module"
+        );
+
+        os << frame_magic;
+        out.write< std::uint64_t >(bytecode.size());
+        os << bytecode;
+        return frame;
+    }
+
+    void embed_hl_module(llvm::Module &llvm_mod, string_ref frame) {
+        auto data = llvm::ConstantDataArray::getString(
+            llvm_mod.getContext(), frame, /* AddNull */ false
+        );
+
+        auto global = new llvm::GlobalVariable(
+            llvm_mod, data->getType(), /* isConstant */ true,
+            llvm::GlobalValue::PrivateLinkage, data, "vast.embedded.hl"
+        );
+
+        global->setSection(embedded_hl_section(llvm::Triple(llvm_mod.getTargetTriple())));
+        global->setAlignment(llvm::Align(1));
+        llvm::appendToCompilerUsed(llvm_mod, { global });
+    }
+
+    bool is_object_file(llvm::MemoryBufferRef buffer) {
+        using magic = llvm::file_magic;
+        switch (llvm::identify_magic(buffer.getBuffer())) {
+            case magic::elf_relocatable:
+            case magic::elf_executable:
+            case magic::elf_shared_object:
+            case magic::macho_object:
+            case magic::macho_executable:
+            case magic::macho_dynamically_linked_shared_lib:
+            case magic::macho_bundle:
+            case magic::coff_object:
+            case magic::pecoff_executable:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::optional< std::vector< owning_module_ref > > extract_hl_modules(
+        llvm::MemoryBufferRef buffer, mcontext_t &mctx, std::string *err
+    ) {
+        auto object = llvm::object::ObjectFile::createObjectFile(buffer);
+        if (!object) {
+            *err = llvm::toString(object.takeError());
+            return std::nullopt;
+        }
+
+        auto name = section_name(embedded_hl_section((*object)->makeTriple()));
+
+        std::vector< owning_module_ref > modules;
+        for (const auto &section : (*object)->sections()) {
+            auto current = section.getName();
+            if (!current) {
+                llvm::consumeError(current.takeError());
+                continue;
+            }
+
+            if (*current != name) {
+                continue;
+            }
+
+            auto contents = section.getContents();
+            if (!contents) {
+                *err = llvm::toString(contents.takeError());
+                return std::nullopt;
+            }
+
+            if (mlir::failed(split_frames(*contents, mctx, modules, err))) {
+                return std::nullopt;
+            }
+        }
+
+        return modules;
+    }
+
+} // namespace vast::target::llvmir
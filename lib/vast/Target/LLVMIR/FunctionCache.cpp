@@ -0,0 +1,331 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Target/LLVMIR/FunctionCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeReader.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Parser/Parser.h>
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Config/config.h"
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+namespace vast::target::llvmir
+{
+    namespace
+    {
+        struct key_hasher {
+            void add(string_ref data) {
+                hasher.update(data);
+                // Separate the fields, so that "ab" "c" and "a" "bc" differ.
+                hasher.update(string_ref("\0", 1));
+            }
+
+            std::string hex() { return llvm::toHex(hasher.final(), /* LowerCase */ true); }
+
+            llvm::BLAKE3 hasher;
+        };
+
+        std::string describe(pipeline p, const lowering_options &opts) {
+            std::string out;
+            llvm::raw_string_ostream os(out);
+            os << vast::version << ';' << static_cast< uint32_t >(p)
+               << ';' << opts.strict_aliasing << opts.lifetime_markers
+               << opts.signed_overflow_undefined << opts.noundef_params << opts.value_ranges
+               << opts.strict_enums << opts.promote_vars << opts.inline_functions
+               << opts.raise_loops << opts.openmp << ';' << opts.tls_model
+               << ';' << opts.dso_local << opts.pic << opts.pie << opts.semantic_interposition
+               << opts.no_plt << opts.direct_access_external_data << opts.return_slots
+               << ';' << opts.instrument_functions << opts.instrument_loops << opts.instrument_timestamps
+               << ';' << opts.line_tables;
+            for (const auto &callee : opts.instrument_calls) {
+                os << ';' << callee;
+            }
+            return out;
+        }
+
+        // Locations are a part of the text, they end up in the debug info.
+        std::string print(operation op) {
+            std::string out;
+            llvm::raw_string_ostream os(out);
+            auto flags = mlir::OpPrintingFlags()
+                .enableDebugInfo(/* enable */ true, /* prettyForm */ false)
+                .printGenericOpForm()
+                .useLocalScope();
+            op->print(os, flags);
+            return out;
+        }
+
+        string_ref declared_name(operation op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                return fn.getSymName();
+            }
+
+            if (auto name = op->getAttrOfType< mlir::StringAttr >("name")) {
+                return name.getValue();
+            }
+
+            return {};
+        }
+
+        // Names the operation refers to, as the symbol dce of hl sees them:
+        // callee symbols, names in attributes and named types.
+        void referenced_names(operation root, auto &&yield) {
+            auto type_names = [&] (mlir_type type) {
+                type.walk([&] (mlir_type nested) {
+                    if (auto rec = mlir::dyn_cast< hl::RecordType >(nested)) {
+                        yield(rec.getName());
+                    } else if (auto en = mlir::dyn_cast< hl::EnumType >(nested)) {
+                        yield(en.getName());
+                    } else if (auto def = mlir::dyn_cast< hl::TypedefType >(nested)) {
+                        yield(def.getName());
+                    }
+                });
+            };
+
+            root->walk([&] (operation op) {
+                op->getAttrDictionary().walk(
+                    [&] (mlir::StringAttr attr) { yield(attr.getValue()); },
+                    [&] (mlir::FlatSymbolRefAttr attr) { yield(attr.getValue()); },
+                    [&] (mlir_type type) { type_names(type); }
+                );
+
+                for (auto type : op->getResultTypes()) {
+                    type_names(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            type_names(arg.getType());
+                        }
+                    }
+                }
+            });
+        }
+
+        template< typename attr_t >
+        bool has_attr(hl::FuncOp fn) {
+            return llvm::any_of(fn->getAttrs(), [] (auto attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        // Functions that may be dropped by the lowering or exist only to be
+        // inlined would leave a dangling cached body behind.
+        bool is_cacheable(hl::FuncOp fn) {
+            return !fn.isDeclaration()
+                && fn.getLinkage() == core::GlobalLinkageKind::ExternalLinkage
+                && !has_attr< hl::AlwaysInlineAttr >(fn);
+        }
+
+        // With inlining, the simplification of hl looks at the whole module:
+        // indirect calls are promoted to the functions whose address is stored
+        // anywhere, and loads of static globals that no function writes are
+        // replaced by their initializers. Functions that reach either depend on
+        // more than their key.
+        bool depends_on_module(operation op) {
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                return var.getStorageClass() == hl::StorageClass::sc_static;
+            }
+
+            return op->walk([] (hl::IndirectCallOp) {
+                return mlir::WalkResult::interrupt();
+            }).wasInterrupted();
+        }
+
+        constexpr string_ref cached_uses_attr = "vast.function_cache.uses";
+
+    } // namespace
+
+    function_cache::function_cache(string_ref dir, pipeline p, const lowering_options &opts)
+        : dir(dir.str()), config(describe(p, opts)), inlines(opts.inline_functions)
+    {}
+
+    std::string function_cache::entry(string_ref key) const {
+        // Entries are spread over subdirectories by the first byte.
+        llvm::SmallString< 256 > path(dir);
+        llvm::sys::path::append(path, key.take_front(2), key + ".mlirbc");
+        return std::string(path.str());
+    }
+
+    std::unique_ptr< mlir::Block > function_cache::load(mcontext_t *mctx, string_ref key) const {
+        auto buffer = llvm::MemoryBuffer::getFile(entry(key));
+        if (!buffer) {
+            return nullptr;
+        }
+
+        auto block = std::make_unique< mlir::Block >();
+        mlir::ParserConfig parser_config(mctx);
+        if (mlir::failed(mlir::readBytecodeFile((*buffer)->getMemBufferRef(), block.get(), parser_config))
+            || block->empty() || !mlir::isa< mlir::LLVM::LLVMFuncOp >(block->front())
+        ) {
+            return nullptr;
+        }
+
+        return block;
+    }
+
+    void function_cache::store(string_ref key, operation fn) const {
+        auto path = entry(key);
+        if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+            return;
+        }
+
+        // Concurrent compilations must not see a partial entry.
+        int fd = -1;
+        llvm::SmallString< 256 > temporary;
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, temporary)) {
+            return;
+        }
+
+        bool written = false;
+        {
+            llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+            auto serialized = mlir::succeeded(mlir::writeBytecodeToFile(fn, os));
+            os.close();
+            written = serialized && !os.has_error();
+            os.clear_error();
+        }
+
+        if (!written || llvm::sys::fs::rename(temporary, path)) {
+            llvm::sys::fs::remove(temporary);
+        }
+    }
+
+    void function_cache::drop_cached_bodies(vast_module mod) {
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > by_name;
+        for (auto &op : mod.getBody()->getOperations()) {
+            if (auto name = declared_name(&op); !name.empty()) {
+                by_name[name].push_back(&op);
+                known.insert(name);
+            }
+        }
+
+        // Data layout and target of the module.
+        std::string module_attrs;
+        {
+            llvm::raw_string_ostream os(module_attrs);
+            os << mod->getAttrDictionary();
+        }
+
+        for (auto fn : mod.getOps< hl::FuncOp >()) {
+            if (!is_cacheable(fn)) {
+                continue;
+            }
+
+            key_hasher key;
+            key.add(config);
+            key.add(module_attrs);
+            key.add(print(fn));
+
+            // Declarations the function depends on, transitively. The callees
+            // are followed only if they may be inlined, otherwise their own
+            // dependencies do not reach the caller.
+            bool cacheable = !inlines || !depends_on_module(fn);
+            llvm::DenseSet< operation > seen = { fn.getOperation() };
+            llvm::SmallVector< operation > worklist = { fn.getOperation() };
+            while (cacheable && !worklist.empty()) {
+                referenced_names(worklist.pop_back_val(), [&] (string_ref name) {
+                    auto it = by_name.find(name);
+                    if (it == by_name.end()) {
+                        return;
+                    }
+
+                    for (auto op : it->second) {
+                        if (!seen.insert(op).second) {
+                            continue;
+                        }
+
+                        if (inlines && depends_on_module(op)) {
+                            cacheable = false;
+                        }
+
+                        key.add(print(op));
+                        if (inlines || !mlir::isa< hl::FuncOp >(op)) {
+                            worklist.push_back(op);
+                        }
+                    }
+                });
+            }
+
+            if (!cacheable) {
+                continue;
+            }
+
+            auto hash = key.hex();
+            auto cached = load(mod.getContext(), hash);
+            if (!cached) {
+                misses[fn.getSymName()] = hash;
+                continue;
+            }
+
+            // Static declarations the cached body refers to must outlive the
+            // symbol dce of hl, which keeps alive any name in an attribute.
+            llvm::SmallVector< mlir::Attribute > uses;
+            cached->front().walk([&] (operation op) {
+                op->getAttrDictionary().walk([&] (mlir::FlatSymbolRefAttr attr) {
+                    uses.push_back(attr.getAttr());
+                });
+            });
+            fn->setAttr(cached_uses_attr, mlir::ArrayAttr::get(mod.getContext(), uses));
+
+            auto &body = fn.getBody();
+            body.dropAllReferences();
+            body.getBlocks().clear();
+
+            hits[fn.getSymName()] = std::move(cached);
+        }
+    }
+
+    void function_cache::restore_cached_bodies(vast_module mod) {
+        llvm::StringMap< mlir::LLVM::LLVMFuncOp > lowered;
+        for (auto fn : mod.getOps< mlir::LLVM::LLVMFuncOp >()) {
+            lowered[fn.getSymName()] = fn;
+        }
+
+        for (auto &[name, block] : hits) {
+            auto fn     = lowered.lookup(name);
+            auto cached = mlir::cast< mlir::LLVM::LLVMFuncOp >(block->front());
+            VAST_CHECK(fn && fn.isExternal(), "function cache: missing lowered declaration of {0}", name);
+
+            fn.getBody().takeBody(cached.getBody());
+            fn->setAttrs(cached->getAttrDictionary());
+            fn->setLoc(cached->getLoc());
+        }
+
+        for (const auto &[name, key] : misses) {
+            auto fn = lowered.lookup(name);
+            if (!fn || fn.isExternal()) {
+                continue;
+            }
+
+            // Symbols created by the lowering, e.g., globals of string
+            // literals, would not exist next to a cached body.
+            bool self_contained = true;
+            fn->walk([&] (operation op) {
+                op->getAttrDictionary().walk([&] (mlir::FlatSymbolRefAttr attr) {
+                    self_contained &= known.contains(attr.getValue());
+                });
+            });
+
+            if (self_contained) {
+                store(key, fn);
+            }
+        }
+    }
+
+} // namespace vast::target::llvmir
@@ -0,0 +1,259 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Target/LLVMIR/ParallelTranslation.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/Target/LLVMIR/Export.h>
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include <atomic>
+
+namespace vast::target::llvmir
+{
+    namespace
+    {
+        namespace LLVM = mlir::LLVM;
+
+        using bitcode = llvm::SmallString< 0 >;
+
+        std::optional< llvm::GlobalValue::LinkageTypes > local_linkage(LLVM::Linkage linkage) {
+            switch (linkage) {
+                case LLVM::Linkage::Internal: return llvm::GlobalValue::InternalLinkage;
+                case LLVM::Linkage::Private:  return llvm::GlobalValue::PrivateLinkage;
+                default: return std::nullopt;
+            }
+        }
+
+        std::size_t size(LLVM::LLVMFuncOp fn) {
+            std::size_t ops = 0;
+            fn.walk([&] (operation) { ++ops; });
+            return ops;
+        }
+
+        struct shard_plan {
+            // Shard of every function definition.
+            llvm::DenseMap< operation, unsigned > owner;
+            // Local symbols, external while the shards are linked.
+            llvm::StringMap< llvm::GlobalValue::LinkageTypes > promoted;
+            unsigned shards = 0;
+        };
+
+        // Definitions go, in order of the module, to the least loaded shard.
+        shard_plan plan_shards(vast_module mod, unsigned threads) {
+            shard_plan plan;
+
+            std::vector< std::size_t > load;
+            for (auto fn : mod.getOps< LLVM::LLVMFuncOp >()) {
+                if (auto linkage = local_linkage(fn.getLinkage())) {
+                    plan.promoted[fn.getName()] = *linkage;
+                }
+
+                if (fn.isExternal()) {
+                    continue;
+                }
+
+                if (load.size() < threads) {
+                    plan.owner[fn] = static_cast< unsigned >(load.size());
+                    load.push_back(size(fn));
+                    continue;
+                }
+
+                auto shard = static_cast< unsigned >(
+                    std::distance(load.begin(), llvm::min_element(load))
+                );
+                plan.owner[fn] = shard;
+                load[shard] += size(fn);
+            }
+
+            for (auto glob : mod.getOps< LLVM::GlobalOp >()) {
+                if (auto linkage = local_linkage(glob.getLinkage())) {
+                    plan.promoted[glob.getSymName()] = *linkage;
+                }
+            }
+
+            plan.shards = static_cast< unsigned >(load.size());
+            return plan;
+        }
+
+        // Appending globals, e.g., `llvm.global_ctors`, link only with each
+        // other and are not referenced by functions.
+        bool is_appending(operation op) {
+            auto glob = mlir::dyn_cast< LLVM::GlobalOp >(op);
+            return glob && glob.getLinkage() == LLVM::Linkage::Appending;
+        }
+
+        // Declarations of symbols defined in another shard.
+        void declare(mlir::OpBuilder &bld, operation op) {
+            auto decl = bld.cloneWithoutRegions(*op);
+            decl->removeAttr("comdat");
+            if (auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(decl)) {
+                fn.setLinkage(LLVM::Linkage::External);
+            } else if (auto glob = mlir::dyn_cast< LLVM::GlobalOp >(decl)) {
+                glob->removeAttr("value");
+                glob.setLinkage(LLVM::Linkage::External);
+            }
+        }
+
+        void promote(operation op, const shard_plan &plan) {
+            if (auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(op)) {
+                if (plan.promoted.contains(fn.getName())) {
+                    fn.setLinkage(LLVM::Linkage::External);
+                }
+            } else if (auto glob = mlir::dyn_cast< LLVM::GlobalOp >(op)) {
+                if (plan.promoted.contains(glob.getSymName())) {
+                    glob.setLinkage(LLVM::Linkage::External);
+                }
+            }
+        }
+
+        owning_module_ref build_shard(vast_module mod, const shard_plan &plan, unsigned shard) {
+            owning_module_ref part(vast_module::create(mod.getLoc()));
+            part->getOperation()->setAttrs(mod->getAttrDictionary());
+
+            mlir::OpBuilder bld(mod.getContext());
+            bld.setInsertionPointToEnd(part->getBody());
+
+            for (auto &op : mod.getBody()->getOperations()) {
+                auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(op);
+                auto defined_here = fn
+                    ? fn.isExternal() || plan.owner.lookup(fn) == shard
+                    : shard == 0 || mlir::isa< LLVM::ComdatOp >(op);
+
+                if (defined_here) {
+                    promote(bld.clone(op), plan);
+                } else if (fn || (mlir::isa< LLVM::GlobalOp >(op) && !is_appending(&op))) {
+                    declare(bld, &op);
+                }
+            }
+
+            return part;
+        }
+
+        // Each shard would get its own compile unit, the llvm linker does not
+        // merge them.
+        bool has_debug_info(vast_module mod) {
+            for (auto fn : mod.getOps< LLVM::LLVMFuncOp >()) {
+                if (fn->getLoc()->findInstanceOf< mlir::FusedLocWith< LLVM::DISubprogramAttr > >()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Functions created by the translation, e.g., declarations of
+        // intrinsics, come first, by their name.
+        void order_functions(vast_module mlir_module, llvm::Module &mod) {
+            llvm::SmallVector< llvm::Function * > order;
+            for (auto fn : mlir_module.getOps< LLVM::LLVMFuncOp >()) {
+                if (auto f = mod.getFunction(fn.getName())) {
+                    order.push_back(f);
+                }
+            }
+
+            llvm::SmallPtrSet< llvm::Function *, 16 > known(order.begin(), order.end());
+            llvm::SmallVector< llvm::Function * > created;
+            for (auto &f : mod) {
+                if (!known.contains(&f)) {
+                    created.push_back(&f);
+                }
+            }
+
+            llvm::sort(created, [] (auto a, auto b) { return a->getName() < b->getName(); });
+
+            auto &functions = mod.getFunctionList();
+            for (auto f : llvm::concat< llvm::Function * >(created, order)) {
+                functions.splice(functions.end(), functions, f->getIterator());
+            }
+        }
+
+    } // namespace
+
+    std::unique_ptr< llvm::Module > translate_parallel(
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx, unsigned threads
+    ) {
+        auto mctx = mlir_module.getContext();
+        auto plan = plan_shards(mlir_module, threads);
+        if (plan.shards < 2 || !mctx->isMultithreadingEnabled() || has_debug_info(mlir_module)) {
+            return mlir::translateModuleToLLVMIR(mlir_module, llvm_ctx);
+        }
+
+        std::vector< owning_module_ref > shards;
+        for (unsigned i = 0; i < plan.shards; ++i) {
+            shards.push_back(build_shard(mlir_module, plan, i));
+        }
+
+        // Diagnostics of the shards are reported in their order.
+        mlir::ParallelDiagnosticHandler diagnostics(mctx);
+
+        // The llvm context is not thread safe, shards are handed over as bitcode.
+        std::vector< bitcode > parts(shards.size());
+        std::atomic_bool failed = false;
+
+        llvm::ThreadPool pool(llvm::hardware_concurrency(plan.shards));
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            pool.async([&, i] {
+                diagnostics.setOrderIDForThread(i);
+                llvm::LLVMContext lctx;
+                if (auto part = mlir::translateModuleToLLVMIR(shards[i].get(), lctx)) {
+                    llvm::raw_svector_ostream os(parts[i]);
+                    llvm::WriteBitcodeToFile(*part, os);
+                } else {
+                    failed = true;
+                }
+                diagnostics.eraseOrderIDForThread();
+            });
+        }
+        pool.wait();
+
+        if (failed) {
+            return nullptr;
+        }
+
+        auto parse = [&] (const bitcode &part) -> std::unique_ptr< llvm::Module > {
+            auto mod = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(part.str(), "vast-translation-shard"), llvm_ctx
+            );
+            if (!mod) {
+                llvm::consumeError(mod.takeError());
+                return nullptr;
+            }
+            return std::move(mod.get());
+        };
+
+        auto mod = parse(parts.front());
+        for (std::size_t i = 1; mod && i < parts.size(); ++i) {
+            auto part = parse(parts[i]);
+            if (!part || llvm::Linker::linkModules(*mod, std::move(part))) {
+                return nullptr;
+            }
+        }
+
+        if (!mod) {
+            return nullptr;
+        }
+
+        for (const auto &promoted : plan.promoted) {
+            if (auto gv = mod->getNamedValue(promoted.getKey())) {
+                gv->setLinkage(promoted.getValue());
+            }
+        }
+
+        order_functions(mlir_module, *mod);
+        return mod;
+    }
+
+} // namespace vast::target::llvmir
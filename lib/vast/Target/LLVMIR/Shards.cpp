@@ -0,0 +1,154 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Target/LLVMIR/Shards.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/SymbolTable.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/Shard.hpp"
+
+namespace vast::target::llvmir
+{
+    namespace
+    {
+        namespace LLVM = mlir::LLVM;
+
+        bool is_definition(operation op) {
+            if (auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(op)) {
+                return !fn.isExternal();
+            }
+
+            if (auto glob = mlir::dyn_cast< LLVM::GlobalOp >(op)) {
+                return glob.getValueOrNull() || !glob.getInitializerRegion().empty();
+            }
+
+            return true;
+        }
+
+        bool is_local(LLVM::Linkage linkage) {
+            return linkage == LLVM::Linkage::Internal || linkage == LLVM::Linkage::Private;
+        }
+
+        bool is_local(operation op) {
+            if (auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(op)) {
+                return is_local(fn.getLinkage());
+            }
+
+            if (auto glob = mlir::dyn_cast< LLVM::GlobalOp >(op)) {
+                return is_local(glob.getLinkage());
+            }
+
+            return false;
+        }
+
+        void make_internal(operation op) {
+            if (auto fn = mlir::dyn_cast< LLVM::LLVMFuncOp >(op)) {
+                fn.setLinkage(LLVM::Linkage::Internal);
+            } else if (auto glob = mlir::dyn_cast< LLVM::GlobalOp >(op)) {
+                glob.setLinkage(LLVM::Linkage::Internal);
+            }
+        }
+
+        string_ref symbol_name(operation op) {
+            auto name = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName());
+            return name ? name.getValue() : string_ref();
+        }
+
+        std::string unique_name(string_ref base, auto &&taken) {
+            for (unsigned i = 1;; ++i) {
+                auto name = (llvm::Twine(base) + "." + llvm::Twine(i)).str();
+                if (!taken(name)) {
+                    return name;
+                }
+            }
+        }
+
+    } // namespace
+
+    logical_result merge_shards(vast_module dst, llvm::ArrayRef< vast_module > shards) {
+        if (shards.empty()) {
+            return mlir::success();
+        }
+
+        auto mctx = dst.getContext();
+
+        mlir::NamedAttrList attrs(shards.front()->getAttrDictionary());
+        attrs.erase(hl::shard_internal_attr);
+        dst->setAttrs(attrs.getDictionary(mctx));
+
+        llvm::StringMap< operation > symbols;
+        for (auto &op : dst.getBody()->getOperations()) {
+            if (auto name = symbol_name(&op); !name.empty()) {
+                symbols[name] = &op;
+            }
+        }
+
+        llvm::StringSet<> internal;
+        for (auto shard : shards) {
+            if (auto names = shard->getAttrOfType< mlir::ArrayAttr >(hl::shard_internal_attr)) {
+                for (auto name : names.getAsValueRange< mlir::StringAttr >()) {
+                    internal.insert(name);
+                }
+            }
+
+            for (auto &op : llvm::make_early_inc_range(shard.getBody()->getOperations())) {
+                auto name = symbol_name(&op);
+                auto it = name.empty() ? symbols.end() : symbols.find(name);
+                if (it == symbols.end()) {
+                    continue;
+                }
+
+                if (!is_definition(&op)) {
+                    op.erase();
+                    continue;
+                }
+
+                if (!is_definition(it->second)) {
+                    it->second->erase();
+                    symbols.erase(it);
+                    continue;
+                }
+
+                // Local symbols created by the lowering of each shard.
+                if (is_local(&op) && !internal.contains(name)) {
+                    auto fresh = unique_name(name, [&] (string_ref candidate) {
+                        return symbols.contains(candidate)
+                            || mlir::SymbolTable::lookupSymbolIn(shard, candidate);
+                    });
+
+                    auto fresh_attr = mlir::StringAttr::get(mctx, fresh);
+                    if (mlir::failed(mlir::SymbolTable::replaceAllSymbolUses(&op, fresh_attr, shard))) {
+                        return op.emitError() << "cannot rename the uses of '" << name << "'";
+                    }
+                    mlir::SymbolTable::setSymbolName(&op, fresh_attr);
+                    continue;
+                }
+
+                return op.emitError() << "duplicate definition of '" << name << "' in the shards";
+            }
+
+            auto &body = *dst.getBody();
+            for (auto &op : llvm::make_early_inc_range(shard.getBody()->getOperations())) {
+                op.moveBefore(&body, body.end());
+                if (auto name = symbol_name(&op); !name.empty()) {
+                    symbols[name] = &op;
+                }
+            }
+        }
+
+        for (const auto &name : internal) {
+            if (auto op = symbols.lookup(name.getKey())) {
+                make_internal(op);
+            }
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::target::llvmir
@@ -0,0 +1,285 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Target/LLVMIR/StackUsage.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Matchers.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+namespace vast::target::llvmir
+{
+    namespace
+    {
+        namespace LLVM = mlir::LLVM;
+
+        // Callee saved general purpose registers of the common 64-bit abis.
+        constexpr std::uint64_t callee_saved_registers = 6;
+
+        std::string location(mlir::Location loc) {
+            auto file = loc->findInstanceOf< mlir::FileLineColLoc >();
+            if (!file) {
+                return {};
+            }
+
+            return llvm::formatv(
+                "{0}:{1}:{2}", file.getFilename().getValue(), file.getLine(), file.getColumn()
+            ).str();
+        }
+
+        struct frame_collector
+        {
+            explicit frame_collector(vast_module mod) : dl(mod) {
+                for (auto fn : mod.getOps< LLVM::LLVMFuncOp >()) {
+                    functions[fn.getName()] = fn;
+                }
+                pointer = std::uint64_t(dl.getTypeSize(LLVM::LLVMPointerType::get(mod.getContext())));
+            }
+
+            frame_usage collect(LLVM::LLVMFuncOp fn) {
+                frame_usage usage;
+                usage.name = fn.getName().str();
+                usage.loc  = location(fn.getLoc());
+
+                llvm::DenseSet< operation > return_slots;
+                fn.walk([&] (LLVM::CallOp call) { visit_call(call, usage, return_slots); });
+
+                auto &entry = fn.getBody().front();
+                fn.walk([&] (LLVM::AllocaOp alloca) {
+                    auto [size, align, known] = slot(alloca);
+                    usage.dynamic |= !known || alloca->getBlock() != &entry;
+
+                    auto &total = return_slots.contains(alloca) ? usage.return_slots : usage.locals;
+                    total = llvm::alignTo(total, align) + size;
+
+                    if (size > usage.largest_slot) {
+                        usage.largest_slot     = size;
+                        usage.largest_slot_loc = location(alloca.getLoc());
+                    }
+                });
+
+                usage.spills = spills(fn, !usage.callees.empty() || usage.indirect_calls);
+                return usage;
+            }
+
+            void visit_call(
+                LLVM::CallOp call, frame_usage &usage, llvm::DenseSet< operation > &return_slots
+            ) {
+                auto name = call.getCallee();
+                if (!name) {
+                    usage.indirect_calls = true;
+                    return;
+                }
+
+                if (llvm::find(usage.callees, *name) == usage.callees.end()) {
+                    usage.callees.push_back(name->str());
+                }
+
+                auto callee = functions.lookup(*name);
+                if (!callee) {
+                    return;
+                }
+
+                std::uint64_t copies = 0;
+                auto args = call.getArgOperands();
+                for (unsigned i = 0; i < args.size() && i < callee.getNumArguments(); ++i) {
+                    if (auto byval = callee.getArgAttrOfType< mlir::TypeAttr >(
+                            i, LLVM::LLVMDialect::getByValAttrName()
+                        )) {
+                        copies += std::uint64_t(dl.getTypeSize(byval.getValue()));
+                    }
+
+                    if (callee.getArgAttr(i, LLVM::LLVMDialect::getStructRetAttrName())) {
+                        if (auto alloca = args[i].getDefiningOp< LLVM::AllocaOp >()) {
+                            return_slots.insert(alloca);
+                        }
+                    }
+                }
+                usage.byval = std::max(usage.byval, copies);
+            }
+
+            struct slot_size { std::uint64_t size; std::uint64_t align; bool known; };
+
+            slot_size slot(LLVM::AllocaOp alloca) {
+                auto type  = alloca.getElemType();
+                auto size  = std::uint64_t(dl.getTypeSize(type));
+                auto align = alloca.getAlignment().value_or(0);
+                if (align == 0) {
+                    align = std::uint64_t(dl.getTypeABIAlignment(type));
+                }
+
+                llvm::APInt count;
+                if (!mlir::matchPattern(alloca.getArraySize(), mlir::m_ConstantInt(&count))) {
+                    return { size, align, false };
+                }
+
+                return { size * count.getZExtValue(), align, true };
+            }
+
+            std::uint64_t spills(LLVM::LLVMFuncOp fn, bool calls) {
+                std::uint64_t live_out = 0;
+                fn.walk([&] (operation op) {
+                    for (auto result : op->getResults()) {
+                        auto escapes = llvm::any_of(result.getUsers(), [&] (operation user) {
+                            return user->getBlock() != op->getBlock();
+                        });
+                        live_out += escapes;
+                    }
+                });
+
+                auto saved = std::min(live_out, callee_saved_registers);
+                return pointer * (saved + (calls ? 2 : 0));
+            }
+
+            mlir::DataLayout dl;
+            std::uint64_t pointer = 8;
+            llvm::StringMap< LLVM::LLVMFuncOp > functions;
+        };
+
+        // Worst cases along the calls, functions on a cycle have none.
+        struct worst_case_solver
+        {
+            explicit worst_case_solver(std::vector< frame_usage > &functions) : functions(functions) {
+                for (std::size_t i = 0; i < functions.size(); ++i) {
+                    index[functions[i].name] = i;
+                }
+            }
+
+            enum class state { unvisited, visiting, done };
+
+            void solve() {
+                states.assign(functions.size(), state::unvisited);
+                for (std::size_t i = 0; i < functions.size(); ++i) {
+                    visit(i);
+                }
+            }
+
+            void visit(std::size_t i) {
+                if (states[i] != state::unvisited) {
+                    return;
+                }
+
+                states[i] = state::visiting;
+                auto &fn = functions[i];
+                fn.incomplete = fn.indirect_calls;
+
+                std::uint64_t deepest = 0;
+                const frame_usage *next = nullptr;
+                bool bounded = true;
+
+                for (const auto &name : fn.callees) {
+                    auto it = index.find(name);
+                    if (it == index.end()) {
+                        fn.incomplete = true;
+                        continue;
+                    }
+
+                    visit(it->second);
+                    const auto &callee = functions[it->second];
+                    if (states[it->second] == state::visiting || !callee.worst_case) {
+                        bounded = false;
+                        continue;
+                    }
+
+                    fn.incomplete |= callee.incomplete;
+                    if (*callee.worst_case > deepest || !next) {
+                        deepest = *callee.worst_case;
+                        next    = &callee;
+                    }
+                }
+
+                if (bounded) {
+                    fn.worst_case = fn.frame() + deepest;
+                    fn.worst_case_path = { fn.name };
+                    if (next) {
+                        fn.worst_case_path.insert(
+                            fn.worst_case_path.end(),
+                            next->worst_case_path.begin(), next->worst_case_path.end()
+                        );
+                    }
+                }
+
+                states[i] = state::done;
+            }
+
+            std::vector< frame_usage > &functions;
+            llvm::StringMap< std::size_t > index;
+            std::vector< state > states;
+        };
+
+    } // namespace
+
+    stack_usage stack_usage::collect(vast_module mod) {
+        stack_usage usage;
+        frame_collector collector(mod);
+        for (auto fn : mod.getOps< LLVM::LLVMFuncOp >()) {
+            if (!fn.isExternal()) {
+                usage.functions.push_back(collector.collect(fn));
+            }
+        }
+
+        worst_case_solver(usage.functions).solve();
+        return usage;
+    }
+
+    void stack_usage::write(llvm::raw_ostream &os, string_ref file) const {
+        llvm::json::OStream json(os, /* IndentSize */ 2);
+        json.object([&] {
+            json.attribute("file", file);
+            json.attributeArray("functions", [&] {
+                for (const auto &fn : functions) {
+                    json.object([&] {
+                        json.attribute("name", fn.name);
+                        if (!fn.loc.empty()) {
+                            json.attribute("loc", fn.loc);
+                        }
+                        json.attribute("frame", fn.frame());
+                        json.attribute("locals", fn.locals);
+                        json.attribute("return_slots", fn.return_slots);
+                        json.attribute("byval", fn.byval);
+                        json.attribute("spills", fn.spills);
+                        json.attribute("dynamic", fn.dynamic);
+
+                        if (fn.largest_slot) {
+                            json.attributeObject("largest_slot", [&] {
+                                json.attribute("size", fn.largest_slot);
+                                if (!fn.largest_slot_loc.empty()) {
+                                    json.attribute("loc", fn.largest_slot_loc);
+                                }
+                            });
+                        }
+
+                        json.attributeArray("callees", [&] {
+                            for (const auto &callee : fn.callees) {
+                                json.value(callee);
+                            }
+                        });
+
+                        json.attribute("worst_case", fn.worst_case
+                            ? llvm::json::Value(*fn.worst_case) : llvm::json::Value(nullptr)
+                        );
+                        json.attributeArray("worst_case_path", [&] {
+                            for (const auto &name : fn.worst_case_path) {
+                                json.value(name);
+                            }
+                        });
+                        json.attribute("incomplete", fn.incomplete);
+                    });
+                }
+            });
+        });
+        os << "\n";
+    }
+
+} // namespace vast::target::llvmir
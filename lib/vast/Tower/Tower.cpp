@@ -15,8 +15,62 @@ namespace vast::tw {
     }
 
     auto default_loc_rewriter_t::prev(mlir::Operation *op) -> mlir::Operation * {
-        auto fl = mlir::cast< mlir::FusedLoc >(op->getLoc());
-        auto ol = mlir::cast< mlir::OpaqueLoc >(fl.getMetadata());
+        // Operations of the first level and the ones created anew by passes
+        // carry no provenance.
+        auto fl = mlir::dyn_cast< mlir::FusedLoc >(op->getLoc());
+        if (!fl) {
+            return nullptr;
+        }
+
+        auto ol = mlir::dyn_cast_or_null< mlir::OpaqueLoc >(fl.getMetadata());
+        if (!ol || ol.getUnderlyingTypeID() != mlir::TypeID::get< mlir::Operation * >()) {
+            return nullptr;
+        }
+
         return mlir::OpaqueLoc::getUnderlyingLocation< mlir::Operation * >(ol);
     }
+
+    auto side_table_loc_rewriter_t::record(const mlir::IRMapping &mapping, vast_module mod)
+        -> void
+    {
+        llvm::DenseMap< mlir::Operation *, mlir::Operation * > clones;
+        for (auto [from, to] : mapping.getOperationMap()) {
+            clones.try_emplace(to, from);
+        }
+
+        // Clones erased by the passes must not leak into the table. Their
+        // storage might have been reused by newly created operations, which
+        // the name check rules out at least for operations of other kinds.
+        mod.walk([&] (mlir::Operation *op) {
+            if (auto it = clones.find(op); it != clones.end()) {
+                if (it->second->getName() == op->getName()) {
+                    parents[op] = it->second;
+                }
+            }
+        });
+    }
+
+    auto side_table_loc_rewriter_t::prev(mlir::Operation *op) const -> mlir::Operation * {
+        return parents.lookup(op);
+    }
+
+    auto side_table_loc_rewriter_t::forget(const llvm::DenseSet< mlir::Operation * > &ops)
+        -> void
+    {
+        llvm::SmallVector< mlir::Operation * > stale;
+        for (auto [op, parent] : parents) {
+            if (ops.contains(op) || ops.contains(parent)) {
+                stale.push_back(op);
+            }
+        }
+
+        for (auto op : stale) {
+            parents.erase(op);
+        }
+    }
+
+    // Both towers are instantiated in full, so that the one no tool uses keeps
+    // compiling, e.g., `default_tower` that cannot spill.
+    template struct tower< default_loc_rewriter_t >;
+    template struct tower< side_table_loc_rewriter_t >;
 } // namespace vast::tw
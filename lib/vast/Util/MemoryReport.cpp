@@ -0,0 +1,152 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/MemoryReport.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Operation.h>
+VAST_UNRELAX_WARNINGS
+
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#define VAST_HAS_GETRUSAGE 1
+#endif
+
+namespace vast {
+
+    namespace {
+
+        // Resident set of the process from `/proc`, zero where there is none.
+        std::size_t current_rss() {
+            auto statm = llvm::MemoryBuffer::getFileAsStream("/proc/self/statm");
+            if (!statm) {
+                return 0;
+            }
+
+            // Second field, in pages.
+            auto resident = (*statm)->getBuffer().split(' ').second.split(' ').first;
+            std::size_t pages = 0;
+            if (resident.getAsInteger(10, pages)) {
+                return 0;
+            }
+
+            return pages * llvm::sys::Process::getPageSizeEstimate();
+        }
+
+        std::size_t peak_rss() {
+#ifdef VAST_HAS_GETRUSAGE
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) {
+                return 0;
+            }
+    #ifdef __APPLE__
+            return std::size_t(usage.ru_maxrss);
+    #else
+            return std::size_t(usage.ru_maxrss) * 1024;
+    #endif
+#else
+            return 0;
+#endif
+        }
+
+        double mib(std::size_t bytes) { return double(bytes) / (1024 * 1024); }
+
+    } // namespace
+
+    std::size_t resident_set_bytes() { return current_rss(); }
+
+    memory_report::footprint memory_report::measure(operation root) {
+        footprint result;
+
+        llvm::DenseSet< mlir::Type > types;
+        llvm::DenseSet< mlir::Attribute > attrs;
+        llvm::DenseSet< mlir::Attribute > locs;
+
+        // The walker does not revisit nested attributes and types.
+        mlir::AttrTypeWalker walker;
+        walker.addWalk([&] (mlir::Attribute attr) {
+            if (attr.isa< mlir::LocationAttr >()) {
+                locs.insert(attr);
+            } else {
+                attrs.insert(attr);
+            }
+        });
+        walker.addWalk([&] (mlir::Type type) { types.insert(type); });
+
+        root->walk([&] (operation op) {
+            ++result.ops;
+            result.op_bytes += sizeof(mlir::Operation)
+                + op->getNumOperands() * sizeof(mlir::OpOperand)
+                + op->getNumResults() * 2 * sizeof(void *)
+                + op->getNumSuccessors() * sizeof(mlir::BlockOperand)
+                + op->getNumRegions() * sizeof(mlir::Region);
+
+            walker.walk(op->getAttrDictionary());
+            walker.walk(mlir::LocationAttr(op->getLoc()));
+            for (auto type : op->getResultTypes()) {
+                walker.walk(type);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    ++result.blocks;
+                    result.op_bytes += sizeof(mlir::Block) + block.getNumArguments() * 4 * sizeof(void *);
+                    for (auto arg : block.getArguments()) {
+                        walker.walk(arg.getType());
+                        walker.walk(mlir::LocationAttr(arg.getLoc()));
+                    }
+                }
+            }
+        });
+
+        result.types = types.size();
+        result.attrs = attrs.size();
+        result.locs  = locs.size();
+        return result;
+    }
+
+    void memory_report::sample(string_ref phase, operation root) {
+        row sampled = {
+            .phase    = phase.str(),
+            .rss      = current_rss(),
+            .peak_rss = peak_rss(),
+            .malloc   = llvm::sys::Process::GetMallocUsage(),
+            .ast      = ast_bytes ? ast_bytes() : 0,
+        };
+
+        if (root) {
+            sampled.ir = measure(root);
+        }
+
+        rows.push_back(std::move(sampled));
+    }
+
+    void memory_report::print(llvm::raw_ostream &os) const {
+        os << "vast memory report (MiB)\n";
+        os << llvm::formatv(
+            "  {0,-36} {1,9} {2,9} {3,9} {4,9} {5,10} {6,9} {7,8} {8,8} {9,8}\n",
+            "phase", "rss", "peak", "malloc", "ast", "ops", "op bytes", "types", "attrs", "locs"
+        );
+
+        for (const auto &r : rows) {
+            os << llvm::formatv(
+                "  {0,-36} {1,9:F1} {2,9:F1} {3,9:F1} {4,9:F1}",
+                r.phase, mib(r.rss), mib(r.peak_rss), mib(r.malloc), mib(r.ast)
+            );
+
+            if (r.ir) {
+                os << llvm::formatv(
+                    " {0,10} {1,9:F1} {2,8} {3,8} {4,8}",
+                    r.ir->ops, mib(r.ir->op_bytes), r.ir->types, r.ir->attrs, r.ir->locs
+                );
+            }
+
+            os << "\n";
+        }
+    }
+
+} // namespace vast
@@ -0,0 +1,464 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Metrics.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/Path.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/MemoryReport.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if LLVM_ON_UNIX
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef SOCK_CLOEXEC
+#define SOCK_CLOEXEC 0
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace vast::metrics {
+
+    void atomic_double::store(double value) {
+        bits.store(std::bit_cast< std::uint64_t >(value), std::memory_order_relaxed);
+    }
+
+    void atomic_double::add(double value) {
+        auto old = bits.load(std::memory_order_relaxed);
+        while (!bits.compare_exchange_weak(
+            old, std::bit_cast< std::uint64_t >(std::bit_cast< double >(old) + value),
+            std::memory_order_relaxed
+        )) {}
+    }
+
+    double atomic_double::load() const {
+        return std::bit_cast< double >(bits.load(std::memory_order_relaxed));
+    }
+
+    histogram::histogram(std::vector< double > bounds)
+        : bounds(std::move(bounds))
+        , buckets(std::make_unique< std::atomic< std::uint64_t >[] >(this->bounds.size() + 1))
+    {
+        llvm::sort(this->bounds);
+    }
+
+    void histogram::observe(double value) {
+        auto bucket = std::size_t(llvm::lower_bound(bounds, value) - bounds.begin());
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        observed.fetch_add(1, std::memory_order_relaxed);
+        total.add(value);
+    }
+
+    std::vector< double > histogram::latency_bounds() {
+        std::vector< double > out;
+        for (double bound = 1e-4; bound < 30; bound *= 4) {
+            out.push_back(bound);
+        }
+        return out;
+    }
+
+    std::vector< std::uint64_t > histogram::bucket_counts() const {
+        std::vector< std::uint64_t > out;
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            out.push_back(buckets[i].load(std::memory_order_relaxed));
+        }
+        return out;
+    }
+
+    registry &registry::global() {
+        static registry instance;
+        return instance;
+    }
+
+    auto registry::make(string_ref name, string_ref help, kind type, labels by) -> metric & {
+        auto it = llvm::find_if(families, [&] (const auto &family) { return family.name == name; });
+        if (it == families.end()) {
+            families.push_back({ name.str(), help.str(), type, {} });
+            it = std::prev(families.end());
+        }
+
+        VAST_CHECK(it->type == type, "metric {0} registered with another type", name);
+
+        auto &metrics = it->metrics;
+        auto same = llvm::find_if(metrics, [&] (const auto &m) { return m.by == by; });
+        if (same != metrics.end()) {
+            return *same;
+        }
+
+        metrics.push_back({ std::move(by), nullptr, nullptr, nullptr, nullptr });
+        return metrics.back();
+    }
+
+    counter &registry::make_counter(string_ref name, string_ref help, labels by) {
+        std::lock_guard lock(mutex);
+        auto &m = make(name, help, kind::counter, std::move(by));
+        if (!m.as_counter) {
+            m.as_counter = std::make_unique< counter >();
+        }
+        return *m.as_counter;
+    }
+
+    gauge &registry::make_gauge(string_ref name, string_ref help, labels by) {
+        std::lock_guard lock(mutex);
+        auto &m = make(name, help, kind::gauge, std::move(by));
+        if (!m.as_gauge) {
+            m.as_gauge = std::make_unique< gauge >();
+        }
+        return *m.as_gauge;
+    }
+
+    histogram &registry::make_histogram(
+        string_ref name, string_ref help, labels by, std::vector< double > bounds
+    ) {
+        std::lock_guard lock(mutex);
+        auto &m = make(name, help, kind::histogram, std::move(by));
+        if (!m.as_histogram) {
+            m.as_histogram = std::make_unique< histogram >(std::move(bounds));
+        }
+        return *m.as_histogram;
+    }
+
+    void registry::make_gauge_fn(
+        string_ref name, string_ref help, std::function< double() > fn, labels by
+    ) {
+        std::lock_guard lock(mutex);
+        make(name, help, kind::gauge, std::move(by)).fn = std::move(fn);
+    }
+
+    namespace {
+
+        std::string escape(string_ref value) {
+            std::string out;
+            for (char c : value) {
+                switch (c) {
+                    case '\\': out += "\\\\"; break;
+                    case '"':  out += "\\\""; break;
+                    case '\n': out += "\\n"; break;
+                    default:   out += c;
+                }
+            }
+            return out;
+        }
+
+        // `{a="x",b="y"}`, with an extra label, e.g., `le` of buckets.
+        std::string show_labels(const labels &by, string_ref extra = {}, string_ref extra_value = {}) {
+            if (by.empty() && extra.empty()) {
+                return {};
+            }
+
+            std::string out = "{";
+            for (const auto &[key, value] : by) {
+                if (out.size() > 1) {
+                    out += ",";
+                }
+                out += key + "=\"" + escape(value) + "\"";
+            }
+
+            if (!extra.empty()) {
+                if (out.size() > 1) {
+                    out += ",";
+                }
+                out += extra.str() + "=\"" + extra_value.str() + "\"";
+            }
+            return out + "}";
+        }
+
+        std::string show_number(double value) {
+            if (std::isinf(value)) {
+                return value > 0 ? "+Inf" : "-Inf";
+            }
+            if (std::isnan(value)) {
+                return "NaN";
+            }
+            if (value == std::floor(value) && std::abs(value) < 1e15) {
+                return llvm::formatv("{0}", std::int64_t(value)).str();
+            }
+            return llvm::formatv("{0:e6}", value).str();
+        }
+
+        constexpr string_ref type_name(int type) {
+            switch (type) {
+                case 0:  return "counter";
+                case 1:  return "gauge";
+                default: return "histogram";
+            }
+        }
+
+    } // namespace
+
+    void registry::write_openmetrics(llvm::raw_ostream &os) const {
+        std::lock_guard lock(mutex);
+        for (const auto &family : families) {
+            os << "# TYPE " << family.name << " " << type_name(int(family.type)) << "\n";
+            os << "# HELP " << family.name << " " << family.help << "\n";
+
+            for (const auto &m : family.metrics) {
+                switch (family.type) {
+                    case kind::counter:
+                        os << family.name << "_total" << show_labels(m.by) << " "
+                           << m.as_counter->value() << "\n";
+                        break;
+                    case kind::gauge: {
+                        auto value = m.fn ? m.fn() : m.as_gauge->value();
+                        os << family.name << show_labels(m.by) << " " << show_number(value) << "\n";
+                        break;
+                    }
+                    case kind::histogram: {
+                        const auto &h = *m.as_histogram;
+                        auto counts   = h.bucket_counts();
+                        const auto &bounds = h.upper_bounds();
+
+                        std::uint64_t cumulative = 0;
+                        for (std::size_t i = 0; i < counts.size(); ++i) {
+                            cumulative += counts[i];
+                            auto le = i < bounds.size() ? show_number(bounds[i]) : std::string("+Inf");
+                            os << family.name << "_bucket" << show_labels(m.by, "le", le) << " "
+                               << cumulative << "\n";
+                        }
+                        os << family.name << "_count" << show_labels(m.by) << " " << h.count() << "\n";
+                        os << family.name << "_sum" << show_labels(m.by) << " " << show_number(h.sum()) << "\n";
+                        break;
+                    }
+                }
+            }
+        }
+        os << "# EOF\n";
+    }
+
+    void register_process_metrics(registry &reg) {
+        auto start = std::chrono::steady_clock::now();
+        reg.make_gauge_fn("vast_process_resident_memory_bytes", "Resident set of the process.", [] {
+            return double(resident_set_bytes());
+        });
+        reg.make_gauge_fn("vast_process_uptime_seconds", "Seconds since the metrics were registered.", [start] {
+            std::chrono::duration< double > up = std::chrono::steady_clock::now() - start;
+            return up.count();
+        });
+    }
+
+    //
+    // exporters
+    //
+    exporter::~exporter() { stop(); }
+
+    void exporter::start() {
+        worker = std::thread([this] {
+            while (!stopped.load()) {
+#if LLVM_ON_UNIX
+                if (fd() >= 0) {
+                    pollfd entry = { fd(), POLLIN, 0 };
+                    // Short timeouts keep `stop` responsive.
+                    if (::poll(&entry, 1, 200) > 0) {
+                        poll();
+                    }
+                    continue;
+                }
+#endif
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                poll();
+            }
+        });
+    }
+
+    void exporter::stop() {
+        stopped.store(true);
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    namespace {
+
+        //
+        // Rewrites the file every period, a rename makes the update atomic
+        // for readers of the file.
+        //
+        struct file_exporter final : exporter
+        {
+            file_exporter(registry &reg, std::string path, std::chrono::milliseconds period)
+                : exporter(reg, period), path(std::move(path))
+            {}
+
+            ~file_exporter() override {
+                stop();
+                dump();
+            }
+
+            void poll() override {
+                auto now = std::chrono::steady_clock::now();
+                if (now - last >= period) {
+                    last = now;
+                    dump();
+                }
+            }
+
+            void dump() const {
+                auto temp = path + ".tmp";
+                std::error_code ec;
+                {
+                    llvm::raw_fd_ostream os(temp, ec);
+                    if (ec) {
+                        return;
+                    }
+                    reg.write_openmetrics(os);
+                }
+                (void) llvm::sys::fs::rename(temp, path);
+            }
+
+            std::string path;
+            std::chrono::steady_clock::time_point last;
+        };
+
+#if LLVM_ON_UNIX
+
+        //
+        // Minimal http server, each connection gets the metrics whatever it
+        // asks for, and is closed.
+        //
+        struct http_exporter final : exporter
+        {
+            http_exporter(registry &reg, int sock) : exporter(reg, std::chrono::seconds(1)), sock(sock) {}
+
+            ~http_exporter() override {
+                stop();
+                ::close(sock);
+            }
+
+            int fd() const override { return sock; }
+
+            void poll() override {
+                auto client = ::accept(sock, nullptr, nullptr);
+                if (client < 0) {
+                    return;
+                }
+
+                // The request itself does not matter, but it has to be read
+                // for clients that wait until it is.
+                char request[1024];
+                (void) ::recv(client, request, sizeof(request), MSG_DONTWAIT);
+
+                std::string body;
+                llvm::raw_string_ostream os(body);
+                reg.write_openmetrics(os);
+                os.flush();
+
+                auto response = llvm::formatv(
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                    "Content-Length: {0}\r\n"
+                    "Connection: close\r\n\r\n", body.size()
+                ).str() + body;
+
+                string_ref rest = response;
+                while (!rest.empty()) {
+                    auto sent = ::send(client, rest.data(), rest.size(), MSG_NOSIGNAL);
+                    if (sent < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (sent <= 0) {
+                        break;
+                    }
+                    rest = rest.drop_front(std::size_t(sent));
+                }
+                ::close(client);
+            }
+
+            int sock;
+        };
+
+        std::unique_ptr< exporter > make_http(string_ref host, string_ref port, registry &reg) {
+            addrinfo hints = {};
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags    = AI_PASSIVE;
+
+            addrinfo *found = nullptr;
+            auto node = host.empty() ? std::string("127.0.0.1") : host.str();
+            if (auto err = ::getaddrinfo(node.c_str(), port.str().c_str(), &hints, &found)) {
+                llvm::errs() << "error: cannot resolve metrics address " << node << ":" << port
+                             << ": " << ::gai_strerror(err) << '\n';
+                return nullptr;
+            }
+
+            int sock = -1;
+            for (auto addr = found; addr; addr = addr->ai_next) {
+                sock = ::socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+                if (sock < 0) {
+                    continue;
+                }
+
+                int reuse = 1;
+                ::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                if (::bind(sock, addr->ai_addr, addr->ai_addrlen) == 0 && ::listen(sock, 16) == 0) {
+                    break;
+                }
+
+                ::close(sock);
+                sock = -1;
+            }
+            ::freeaddrinfo(found);
+
+            if (sock < 0) {
+                llvm::errs() << "error: cannot listen for metrics on " << node << ":" << port
+                             << ": " << std::strerror(errno) << '\n';
+                return nullptr;
+            }
+
+            return std::make_unique< http_exporter >(reg, sock);
+        }
+
+#else
+
+        std::unique_ptr< exporter > make_http(string_ref, string_ref, registry &) {
+            llvm::errs() << "error: metrics over http are supported only on unix hosts\n";
+            return nullptr;
+        }
+
+#endif
+
+    } // namespace
+
+    std::unique_ptr< exporter > exporter::make(string_ref spec, registry &reg) {
+        // `[host]:port`, the port is numeric.
+        auto [host, port] = spec.rsplit(':');
+        unsigned number = 0;
+        if (!port.empty() && spec.contains(':') && !port.getAsInteger(10, number)) {
+            return make_http(host, port, reg);
+        }
+
+        auto [path, seconds] = spec.rsplit('@');
+        unsigned interval = 10;
+        if (spec.contains('@') && seconds.getAsInteger(10, interval)) {
+            llvm::errs() << "error: malformed interval of metrics file: " << spec << '\n';
+            return nullptr;
+        }
+
+        if (path.empty()) {
+            llvm::errs() << "error: missing path of metrics file\n";
+            return nullptr;
+        }
+
+        return std::make_unique< file_exporter >(
+            reg, path.str(), std::chrono::seconds(std::max(interval, 1u))
+        );
+    }
+
+} // namespace vast::metrics
@@ -0,0 +1,166 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/PassInstrumentation.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/MemoryReport.hpp"
+#include "vast/Util/PatternProfile.hpp"
+
+#include <mutex>
+
+namespace vast {
+
+    namespace {
+
+        using dialect_counts = llvm::StringMap< std::int64_t >;
+
+        string_ref pass_name(mlir::Pass *pass) {
+            auto name = pass->getArgument();
+            return name.empty() ? pass->getName() : name;
+        }
+
+        dialect_counts count_ops(operation root) {
+            dialect_counts counts;
+            root->walk([&] (operation op) { ++counts[op->getName().getDialectNamespace()]; });
+            return counts;
+        }
+
+        //
+        // Accumulates operation counts over all runs of a pass, since nested
+        // passes run once per anchor operation, possibly on multiple threads.
+        //
+        struct ir_size_instrumentation : mlir::PassInstrumentation
+        {
+            struct pass_sizes
+            {
+                std::size_t runs = 0;
+                dialect_counts before;
+                dialect_counts after;
+            };
+
+            ~ir_size_instrumentation() override { print(llvm::errs()); }
+
+            void runBeforePass(mlir::Pass *pass, operation op) override {
+                auto counts = count_ops(op);
+
+                std::lock_guard lock(mutex);
+                auto &sizes = passes[pass_name(pass)];
+                ++sizes.runs;
+                for (const auto &[dialect, count] : counts) {
+                    sizes.before[dialect] += count;
+                }
+            }
+
+            void runAfterPass(mlir::Pass *pass, operation op) override {
+                auto counts = count_ops(op);
+
+                std::lock_guard lock(mutex);
+                auto &sizes = passes[pass_name(pass)];
+                for (const auto &[dialect, count] : counts) {
+                    sizes.after[dialect] += count;
+                }
+            }
+
+            void runAfterPassFailed(mlir::Pass *pass, operation op) override {
+                runAfterPass(pass, op);
+            }
+
+            void print(llvm::raw_ostream &os) const {
+                os << "vast ir size report\n";
+                for (const auto &[name, sizes] : passes) {
+                    os << llvm::formatv("  {0} ({1} runs)\n", name, sizes.runs);
+
+                    llvm::MapVector< string_ref, std::pair< std::int64_t, std::int64_t > > rows;
+                    for (const auto &entry : sizes.before) {
+                        rows[entry.getKey()].first = entry.getValue();
+                    }
+
+                    for (const auto &entry : sizes.after) {
+                        rows[entry.getKey()].second = entry.getValue();
+                    }
+
+                    for (const auto &[dialect, row] : rows) {
+                        os << llvm::formatv("    {0,-12} {1,10} -> {2,10}\n", dialect, row.first, row.second);
+                    }
+                }
+            }
+
+            std::mutex mutex;
+            llvm::MapVector< string_ref, pass_sizes > passes;
+        };
+
+        //
+        // Nests runs of passes in the time trace, the detail is the symbol
+        // the pass runs on, e.g., the function of a nested pass.
+        //
+        struct trace_instrumentation : mlir::PassInstrumentation
+        {
+            void runBeforePass(mlir::Pass *pass, operation op) override {
+                llvm::timeTraceProfilerBegin(pass_name(pass), [&] {
+                    if (auto sym = mlir::dyn_cast< mlir::SymbolOpInterface >(op)) {
+                        return sym.getName().str();
+                    }
+                    return op->getName().getStringRef().str();
+                });
+            }
+
+            void runAfterPass(mlir::Pass *, operation) override { llvm::timeTraceProfilerEnd(); }
+
+            void runAfterPassFailed(mlir::Pass *, operation) override { llvm::timeTraceProfilerEnd(); }
+        };
+
+        struct memory_instrumentation : mlir::PassInstrumentation
+        {
+            explicit memory_instrumentation(memory_report &report) : report(report) {}
+
+            // Nested passes run per operation and possibly in parallel.
+            void runAfterPass(mlir::Pass *pass, operation op) override {
+                if (!op->getParentOp()) {
+                    report.sample(pass_name(pass), op);
+                }
+            }
+
+            memory_report &report;
+        };
+
+    } // namespace
+
+    void configure_pass_manager(mlir::PassManager &pm, const pass_manager_config &config) {
+        pm.enableVerifier(config.verify_each);
+
+        if (config.timing) {
+            pm.enableTiming();
+        }
+
+        if (config.statistics) {
+            pm.enableStatistics();
+        }
+
+        if (config.ir_size_report) {
+            pm.addInstrumentation(std::make_unique< ir_size_instrumentation >());
+        }
+
+        if (config.pattern_profile) {
+            enable_pattern_profiling(true);
+        }
+
+        if (config.trace) {
+            pm.addInstrumentation(std::make_unique< trace_instrumentation >());
+        }
+
+        if (config.memory) {
+            pm.addInstrumentation(std::make_unique< memory_instrumentation >(*config.memory));
+        }
+    }
+
+} // namespace vast
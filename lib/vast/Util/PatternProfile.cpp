@@ -0,0 +1,135 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/PatternProfile.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+namespace vast {
+
+    namespace {
+
+        std::atomic< bool > profile_by_default = false;
+
+        //
+        // Forwards to the wrapped pattern, so the conversion driver sees the same
+        // root, benefit and generated operations as for the original one.
+        //
+        struct profiled_pattern final : mlir::RewritePattern
+        {
+            using entry_ptr = std::shared_ptr< pattern_profile::entry >;
+
+            template< typename ...args_t >
+            profiled_pattern(
+                std::unique_ptr< mlir::RewritePattern > inner, entry_ptr stats, args_t &&...args
+            )
+                : mlir::RewritePattern(std::forward< args_t >(args)...)
+                , inner(std::move(inner)), stats(std::move(stats))
+            {
+                setDebugName(this->inner->getDebugName());
+                addDebugLabels(this->inner->getDebugLabels());
+                setHasBoundedRewriteRecursion(this->inner->hasBoundedRewriteRecursion());
+            }
+
+            static std::unique_ptr< mlir::RewritePattern > wrap(
+                std::unique_ptr< mlir::RewritePattern > pattern, pattern_profile &profile
+            ) {
+                auto stats   = profile.make_entry(pattern->getDebugName());
+                auto benefit = pattern->getBenefit();
+                auto ctx     = pattern->getContext();
+
+                llvm::SmallVector< string_ref > generated;
+                for (auto name : pattern->getGeneratedOps()) {
+                    generated.push_back(name.getStringRef());
+                }
+
+                auto root  = pattern->getRootKind();
+                auto iface = pattern->getRootInterfaceID();
+                auto trait = pattern->getRootTraitID();
+
+                auto make = [&] (auto &&...args) {
+                    return std::make_unique< profiled_pattern >(
+                        std::move(pattern), std::move(stats), args..., benefit, ctx, generated
+                    );
+                };
+
+                if (root) {
+                    return make(root->getStringRef());
+                }
+
+                if (iface) {
+                    return make(MatchInterfaceOpTypeTag(), *iface);
+                }
+
+                if (trait) {
+                    return make(MatchTraitOpTypeTag(), *trait);
+                }
+
+                return make(MatchAnyOpTypeTag());
+            }
+
+            logical_result matchAndRewrite(operation op, mlir::PatternRewriter &rewriter) const override {
+                auto start  = pattern_profile::clock::now();
+                auto result = inner->matchAndRewrite(op, rewriter);
+                stats->record(mlir::succeeded(result), pattern_profile::clock::now() - start);
+                return result;
+            }
+
+            std::unique_ptr< mlir::RewritePattern > inner;
+            entry_ptr stats;
+        };
+
+    } // namespace
+
+    auto pattern_profile::make_entry(string_ref name) -> std::shared_ptr< entry > {
+        std::lock_guard lock(mutex);
+        return entries.emplace_back(std::make_shared< entry >(name.str()));
+    }
+
+    void pattern_profile::print(llvm::raw_ostream &os) const {
+        struct row { std::uint64_t attempts = 0, successes = 0; std::int64_t ns = 0; };
+
+        llvm::MapVector< string_ref, row > rows;
+        {
+            std::lock_guard lock(mutex);
+            for (const auto &e : entries) {
+                auto &r = rows[e->name];
+                r.attempts  += e->attempts;
+                r.successes += e->successes;
+                r.ns        += e->nanoseconds;
+            }
+        }
+
+        auto sorted = rows.takeVector();
+        std::stable_sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+            return a.second.ns > b.second.ns;
+        });
+
+        os << llvm::formatv("vast pattern profile: {0}\n", pass);
+        os << llvm::formatv("{0,10} {1,10} {2,10} {3,12}  {4}\n",
+            "attempts", "success", "failure", "time [us]", "pattern"
+        );
+
+        for (const auto &[name, r] : sorted) {
+            os << llvm::formatv("{0,10} {1,10} {2,10} {3,12}  {4}\n",
+                r.attempts, r.successes, r.attempts - r.successes, r.ns / 1000, name
+            );
+        }
+    }
+
+    void profile_patterns(mlir::RewritePatternSet &patterns, pattern_profile &profile) {
+        for (auto &pattern : patterns.getNativePatterns()) {
+            pattern = profiled_pattern::wrap(std::move(pattern), profile);
+        }
+    }
+
+    void enable_pattern_profiling(bool enable) { profile_by_default = enable; }
+
+    bool pattern_profiling_enabled() { return profile_by_default; }
+
+} // namespace vast
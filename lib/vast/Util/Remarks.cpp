@@ -0,0 +1,115 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Remarks.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/SymbolTable.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::remarks {
+
+    namespace {
+
+        constexpr llvm::StringLiteral kind_key     = "vast.remark";
+        constexpr llvm::StringLiteral pass_key     = "pass";
+        constexpr llvm::StringLiteral name_key     = "name";
+        constexpr llvm::StringLiteral function_key = "function";
+
+        std::optional< remark_kind > parse_kind(string_ref kind) {
+            if (kind == "passed")   return remark_kind::passed;
+            if (kind == "missed")   return remark_kind::missed;
+            if (kind == "analysis") return remark_kind::analysis;
+            return std::nullopt;
+        }
+
+        // Name of the symbol that encloses `op`, a function or the global
+        // of an initializer.
+        string_ref function_name(operation op) {
+            for (; op && !mlir::isa< mlir::ModuleOp >(op); op = op->getParentOp()) {
+                auto symbol = mlir::dyn_cast< mlir::SymbolOpInterface >(op);
+                if (symbol && op->getNumRegions() != 0) {
+                    return symbol.getName();
+                }
+            }
+            return {};
+        }
+
+        std::string suffix(remark_kind kind, string_ref pass) {
+            return (" [" + option(kind) + "=" + pass + "]").str();
+        }
+
+    } // namespace
+
+    string_ref to_string(remark_kind kind) {
+        switch (kind) {
+            case remark_kind::passed:   return "passed";
+            case remark_kind::missed:   return "missed";
+            case remark_kind::analysis: return "analysis";
+        }
+        VAST_UNREACHABLE("unknown remark kind");
+    }
+
+    string_ref option(remark_kind kind) {
+        switch (kind) {
+            case remark_kind::passed:   return "-Rpass";
+            case remark_kind::missed:   return "-Rpass-missed";
+            case remark_kind::analysis: return "-Rpass-analysis";
+        }
+        VAST_UNREACHABLE("unknown remark kind");
+    }
+
+    std::optional< remark_info > get_remark_info(mlir::Diagnostic &diag) {
+        if (diag.getSeverity() != mlir::DiagnosticSeverity::Remark) {
+            return std::nullopt;
+        }
+
+        auto fused = mlir::dyn_cast< mlir::FusedLoc >(diag.getLocation());
+        auto meta  = fused ? mlir::dyn_cast_or_null< mlir::DictionaryAttr >(fused.getMetadata())
+                           : mlir::DictionaryAttr();
+        if (!meta) {
+            return std::nullopt;
+        }
+
+        auto get = [&] (string_ref key) {
+            auto attr = meta.getAs< mlir::StringAttr >(key);
+            return attr ? attr.getValue() : string_ref();
+        };
+
+        auto kind = parse_kind(get(kind_key));
+        if (!kind) {
+            return std::nullopt;
+        }
+
+        remark_info info{ *kind, get(pass_key).str(), get(name_key).str(), get(function_key).str(), diag.str() };
+        string_ref message = info.message;
+        if (message.consume_back(suffix(info.kind, info.pass))) {
+            info.message = message.str();
+        }
+        return info;
+    }
+
+    remark::remark(remark_kind kind, operation op, string_ref pass, string_ref name)
+        : kind(kind), op(op), pass(pass.str()), name(name.str()), os(message)
+    {}
+
+    remark::~remark() {
+        auto ctx = op->getContext();
+        auto str = [&] (string_ref value) { return mlir::StringAttr::get(ctx, value); };
+
+        mlir::NamedAttribute entries[] = {
+            { str(kind_key), str(to_string(kind)) },
+            { str(pass_key), str(pass) },
+            { str(name_key), str(name) },
+            { str(function_key), str(function_name(op)) },
+        };
+
+        auto loc = mlir::FusedLoc::get(
+            { op->getLoc() }, mlir::DictionaryAttr::get(ctx, entries), ctx
+        );
+        mlir::emitRemark(loc) << os.str() << suffix(kind, pass);
+    }
+
+} // namespace vast::remarks
@@ -0,0 +1,302 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#
+# Compile-time regression harness. Compiles the corpus of
+# `test/compile-time/corpus.json` with vast-front, records wall time, peak
+# memory, time of each pass and operation counts per phase, and compares them
+# against a stored baseline.
+#
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tarfile
+import time
+import urllib.request
+import zipfile
+
+from typing import Any, Dict, List, Tuple
+
+Metrics = Dict[str, Any]
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+project_dir = os.path.dirname(script_dir)
+corpus_dir = os.path.join(project_dir, "test", "compile-time")
+
+# Options of vast-front for each measured phase.
+PHASES = {
+    "hl": ["-vast-emit-mlir=hl"],
+    "llvm": ["-vast-emit-mlir=llvm", "-vast-pass-timing"],
+    "llvm-ir": ["-vast-emit-llvm"],
+}
+
+# Phase whose operation counts are reported, in a separate run, so that the
+# counting does not add to the measured time.
+SIZE_PHASE = "llvm"
+
+# Passes that run shorter than this in the baseline are not compared, their
+# time is mostly noise.
+MIN_PASS_TIME = 0.005
+
+#
+# Corpus
+#
+
+def sha256(path: str) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        for chunk in iter(lambda: file.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def fetch(name: str, url: str, cache: str) -> Tuple[str, str]:
+    """Downloads and unpacks an archive once, returns its root and checksum."""
+    root = os.path.join(cache, name)
+    archive = os.path.join(cache, os.path.basename(url))
+
+    if not os.path.isfile(archive):
+        print(f"fetching {url}", file=sys.stderr)
+        os.makedirs(cache, exist_ok=True)
+        with urllib.request.urlopen(url) as response, open(archive + ".part", "wb") as out:
+            shutil.copyfileobj(response, out)
+        os.replace(archive + ".part", archive)
+        shutil.rmtree(root, ignore_errors=True)
+
+    if not os.path.isdir(root):
+        if zipfile.is_zipfile(archive):
+            with zipfile.ZipFile(archive) as packed:
+                packed.extractall(root)
+        else:
+            with tarfile.open(archive) as packed:
+                packed.extractall(root)
+
+    return root, sha256(archive)
+
+
+def load_corpus(manifest: str, cache: str, only: List[str]) -> Dict[str, Metrics]:
+    with open(manifest) as file:
+        entries = json.load(file)
+
+    corpus = {}
+    for name, entry in entries.items():
+        if only and name not in only:
+            continue
+
+        if "url" in entry:
+            root, digest = fetch(name, entry["url"], cache)
+        else:
+            root, digest = os.path.dirname(manifest), None
+
+        includes = [f"-I{os.path.join(root, path)}" for path in entry.get("includes", [])]
+        corpus[name] = {
+            "root": root,
+            "sha256": digest,
+            "files": entry["files"],
+            "args": includes + entry.get("args", []),
+        }
+
+    return corpus
+
+#
+# Measurement
+#
+
+def run(command: List[str]) -> Tuple[int, float, int, str]:
+    """Returns the exit code, wall time, peak RSS in KiB and stderr."""
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = process.stderr.read().decode(errors="replace")
+    _, status, usage = os.wait4(process.pid, 0)
+    wall = time.perf_counter() - start
+    process.returncode = os.waitstatus_to_exitcode(status)
+
+    # macOS reports bytes, Linux KiB.
+    rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return process.returncode, wall, rss, stderr
+
+
+timing_line = re.compile(r"^\s+(\d+\.\d+)\s+\(\s*[\d.]+%\)\s+(.+?)\s*$")
+
+def parse_pass_timing(stderr: str) -> Dict[str, float]:
+    """Wall times of the `Execution time report` of `-vast-pass-timing`."""
+    passes = {}
+    in_report = False
+    for line in stderr.splitlines():
+        if "Execution time report" in line:
+            in_report = True
+            continue
+
+        if in_report and (match := timing_line.match(line)):
+            name = match.group(2)
+            if name != "Total":
+                passes[name] = passes.get(name, 0.0) + float(match.group(1))
+
+    return passes
+
+
+size_pass = re.compile(r"^  (\S+) \(\d+ runs\)$")
+size_row = re.compile(r"^    (\S+)\s+(\d+) ->\s+(\d+)$")
+
+def parse_ir_sizes(stderr: str) -> Dict[str, int]:
+    """Operations after each pass of `-vast-ir-size-report`."""
+    sizes = {}
+    current = None
+    for line in stderr.splitlines():
+        if match := size_pass.match(line):
+            current = match.group(1)
+            sizes[current] = 0
+        elif current and (match := size_row.match(line)):
+            sizes[current] += int(match.group(3))
+
+    return sizes
+
+
+def measure(front: str, source: str, args: List[str], phase: str, repeat: int) -> Metrics:
+    command = [front, source] + args + PHASES[phase] + ["-o", os.devnull]
+
+    walls, rss, passes = [], 0, {}
+    for _ in range(repeat):
+        code, wall, peak, stderr = run(command)
+        if code != 0:
+            return {"error": stderr.strip().splitlines()[-1:] or [f"exit code {code}"]}
+
+        walls.append(wall)
+        rss = max(rss, peak)
+        # Keep the pass times of the fastest run.
+        if wall == min(walls):
+            passes = parse_pass_timing(stderr)
+
+    metrics = {"wall": min(walls), "rss": rss}
+    if passes:
+        metrics["passes"] = passes
+
+    if phase == SIZE_PHASE:
+        _, _, _, stderr = run(command + ["-vast-ir-size-report"])
+        metrics["ops"] = parse_ir_sizes(stderr)
+
+    return metrics
+
+
+def measure_corpus(front: str, corpus: Dict[str, Metrics], phases: List[str], repeat: int) -> Metrics:
+    results = {}
+    for name, entry in corpus.items():
+        for file in entry["files"]:
+            source = os.path.join(entry["root"], file)
+            for phase in phases:
+                key = f"{name}/{os.path.basename(file)}/{phase}"
+                print(f"measuring {key}", file=sys.stderr)
+                results[key] = measure(front, source, entry["args"], phase, repeat)
+
+    sources = {name: entry["sha256"] for name, entry in corpus.items() if entry["sha256"]}
+    return {"sources": sources, "results": results}
+
+#
+# Comparison
+#
+
+def regressed(before: float, after: float, threshold: float) -> bool:
+    return before > 0 and after > before * (1 + threshold)
+
+
+def compare(baseline: Metrics, current: Metrics, threshold: float) -> List[str]:
+    """Human readable regressions of `current` against `baseline`."""
+    changed = {
+        name for name, digest in current["sources"].items()
+        if baseline["sources"].get(name, digest) != digest
+    }
+
+    for name in sorted(changed):
+        print(f"warning: sources of {name} differ from the baseline, not compared", file=sys.stderr)
+
+    found = []
+    for key, after in current["results"].items():
+        before = baseline["results"].get(key)
+        if before is None or key.split("/")[0] in changed:
+            continue
+
+        if "error" in after:
+            if "error" not in before:
+                found.append(f"{key}: fails: {' '.join(after['error'])}")
+            continue
+
+        if "error" in before:
+            continue
+
+        def check(what: str, old: float, new: float, unit: str):
+            if regressed(old, new, threshold):
+                found.append(f"{key}: {what} {old:.3f}{unit} -> {new:.3f}{unit} (+{(new / old - 1) * 100:.1f}%)")
+
+        check("wall time", before["wall"], after["wall"], "s")
+        check("peak rss", before["rss"] / 1024, after["rss"] / 1024, "MiB")
+
+        for name, old in before.get("passes", {}).items():
+            if old >= MIN_PASS_TIME:
+                check(f"pass {name}", old, after.get("passes", {}).get(name, 0.0), "s")
+
+        for name, old in before.get("ops", {}).items():
+            new = after.get("ops", {}).get(name, 0)
+            if regressed(old, new, threshold):
+                found.append(f"{key}: operations after {name} {old} -> {new}")
+
+    return found
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Compile-time regression harness of vast-front.")
+    parser.add_argument("--vast-front", default=shutil.which("vast-front") or "vast-front",
+                        help="vast-front to measure")
+    parser.add_argument("--corpus", default=os.path.join(corpus_dir, "corpus.json"),
+                        help="corpus manifest")
+    parser.add_argument("--cache", default="compile-time-corpus",
+                        help="directory of the downloaded corpus")
+    parser.add_argument("--baseline", help="results to compare against")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write the results to --baseline instead of comparing")
+    parser.add_argument("--output", help="write the results to a file")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="regression threshold in percent (default 10)")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="runs of each phase, the fastest is kept (default 3)")
+    parser.add_argument("--phases", nargs="+", choices=list(PHASES), default=list(PHASES))
+    parser.add_argument("--only", nargs="+", default=[], help="measure only these corpus entries")
+    opts = parser.parse_args()
+
+    corpus = load_corpus(opts.corpus, opts.cache, opts.only)
+    current = measure_corpus(opts.vast_front, corpus, opts.phases, opts.repeat)
+
+    if opts.output:
+        with open(opts.output, "w") as file:
+            json.dump(current, file, indent=2, sort_keys=True)
+
+    if not opts.baseline:
+        return 0
+
+    if opts.update_baseline:
+        with open(opts.baseline, "w") as file:
+            json.dump(current, file, indent=2, sort_keys=True)
+        return 0
+
+    if not os.path.isfile(opts.baseline):
+        print(f"no baseline at {opts.baseline}, record one with --update-baseline", file=sys.stderr)
+        return 0
+
+    with open(opts.baseline) as file:
+        baseline = json.load(file)
+
+    regressions = compare(baseline, current, opts.threshold / 100)
+    for regression in regressions:
+        print(f"regression: {regression}")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
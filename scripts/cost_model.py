@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#
+# Cost model of translation units. Reads the reports of
+# `vast-front -vast-cost-report` and `-vast-estimate-cost`, lists the units
+# by their estimated cost, most expensive first, and fits the model of the
+# estimate to the measured times of full compilations. The fitted model is
+# read by `vast-front -vast-cost-model=<file>`.
+#
+
+import argparse
+import json
+import os
+import sys
+
+from typing import Any, Dict, List, Optional
+
+Report = Dict[str, Any]
+
+SUFFIX = ".cost.json"
+
+# Ridge term of the fit, relative to the scale of the features.
+RIDGE = 1e-6
+
+#
+# Reports
+#
+
+def collect(paths: List[str]) -> List[Report]:
+    """Reports of the given files and of the directories searched recursively."""
+    files = []
+    for path in paths:
+        if not os.path.isdir(path):
+            files.append(path)
+            continue
+
+        for root, _, names in os.walk(path):
+            files.extend(os.path.join(root, name) for name in names if name.endswith(SUFFIX))
+
+    reports = []
+    for path in sorted(files):
+        try:
+            with open(path) as file:
+                report = json.load(file)
+        except (OSError, json.JSONDecodeError) as error:
+            print(f"warning: skipping {path}: {error}", file=sys.stderr)
+            continue
+
+        report["path"] = path
+        reports.append(report)
+    return reports
+
+
+def rank(reports: List[Report], phase: str):
+    print(f"{'estimate':>12} {'measured':>12}  file")
+    for report in sorted(reports, key=lambda r: r.get("estimate_ms", 0.0), reverse=True):
+        measured = report.get("measured_ms", {}).get(phase)
+        shown = f"{measured:>10.1f}ms" if measured is not None else f"{'-':>12}"
+        print(f"{report.get('estimate_ms', 0.0):>10.1f}ms {shown}  {report.get('file') or report['path']}")
+
+#
+# Fit
+#
+
+def solve(matrix: List[List[float]], rhs: List[float]) -> Optional[List[float]]:
+    """Gaussian elimination with partial pivoting."""
+    size = len(rhs)
+    rows = [row[:] + [value] for row, value in zip(matrix, rhs)]
+    for col in range(size):
+        pivot = max(range(col, size), key=lambda r: abs(rows[r][col]))
+        if abs(rows[pivot][col]) < 1e-12:
+            return None
+        rows[col], rows[pivot] = rows[pivot], rows[col]
+        for r in range(col + 1, size):
+            factor = rows[r][col] / rows[col][col]
+            for c in range(col, size + 1):
+                rows[r][c] -= factor * rows[col][c]
+
+    result = [0.0] * size
+    for r in reversed(range(size)):
+        result[r] = (rows[r][size] - sum(rows[r][c] * result[c] for c in range(r + 1, size))) / rows[r][r]
+    return result
+
+
+def least_squares(samples: List[List[float]], targets: List[float]) -> Optional[List[float]]:
+    """Ridge regression of columns scaled to at most one, the first is the intercept."""
+    width = len(samples[0])
+    scale = [max(max(abs(row[c]) for row in samples), 1e-12) for c in range(width)]
+    scaled = [[row[c] / scale[c] for c in range(width)] for row in samples]
+
+    normal = [[sum(row[i] * row[j] for row in scaled) for j in range(width)] for i in range(width)]
+    for i in range(1, width):
+        normal[i][i] += RIDGE * len(samples)
+    moment = [sum(row[i] * y for row, y in zip(scaled, targets)) for i in range(width)]
+
+    result = solve(normal, moment)
+    return [value / scale[c] for c, value in enumerate(result)] if result else None
+
+
+def fit(reports: List[Report], phase: str) -> Optional[Dict[str, Any]]:
+    """Non-negative coefficients: features that would get a negative one are dropped."""
+    measured = [r for r in reports if phase in r.get("measured_ms", {}) and r.get("features")]
+    if not measured:
+        print(f"error: no report measures the phase '{phase}'", file=sys.stderr)
+        return None
+
+    features = sorted(measured[0]["features"])
+    targets = [r["measured_ms"][phase] for r in measured]
+
+    active = list(features)
+    while True:
+        samples = [[1.0] + [float(r["features"].get(name, 0)) for name in active] for r in measured]
+        result = least_squares(samples, targets)
+        if result is None:
+            print("error: the reports do not determine the model, add more units", file=sys.stderr)
+            return None
+
+        negative = [name for name, value in zip(active, result[1:]) if value < 0]
+        if not negative:
+            break
+        active = [name for name in active if name not in negative]
+
+    coefficients = {name: 0.0 for name in features}
+    coefficients.update(zip(active, result[1:]))
+    model = {"intercept": max(result[0], 0.0), "coefficients": coefficients}
+
+    predicted = [model["intercept"] + sum(coefficients[name] * r["features"].get(name, 0) for name in features)
+                 for r in measured]
+    mean = sum(targets) / len(targets)
+    total = sum((y - mean) ** 2 for y in targets)
+    residual = sum((y - p) ** 2 for y, p in zip(targets, predicted))
+    errors = [abs(p - y) / y for y, p in zip(targets, predicted) if y > 0]
+
+    r2 = 1.0 - residual / total if total > 0 else 1.0
+    print(f"fitted {len(measured)} units: r2 {r2:.3f}, mean relative error {100 * sum(errors) / max(len(errors), 1):.1f}%",
+          file=sys.stderr)
+    return model
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Cost model of translation units compiled by vast-front.")
+    parser.add_argument("reports", nargs="+",
+                        help=f"reports of -vast-cost-report, or directories searched for *{SUFFIX}")
+    parser.add_argument("--fit", metavar="MODEL",
+                        help="fit the model to the measured reports and write it to MODEL")
+    parser.add_argument("--phase", default="total",
+                        help="measured phase the model predicts (default total)")
+    opts = parser.parse_args()
+
+    reports = collect(opts.reports)
+    if not reports:
+        print("error: no reports found", file=sys.stderr)
+        return 1
+
+    if not opts.fit:
+        rank(reports, opts.phase)
+        return 0
+
+    model = fit(reports, opts.phase)
+    if model is None:
+        return 1
+
+    with open(opts.fit, "w") as file:
+        json.dump(model, file, indent=2, sort_keys=True)
+        file.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
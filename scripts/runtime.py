@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#
+# Runtime harness. Builds the C kernels of `test/runtime/Inputs` with
+# vast-front and with clang at each optimization level, checks that both
+# programs print the same output, and reports the ratio of their run times
+# and of the sizes of their code. Ratios are compared against a stored
+# baseline and against fixed limits.
+#
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+from typing import Any, Dict, List, Optional, Tuple
+
+from compile_time import regressed
+
+Metrics = Dict[str, Any]
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+project_dir = os.path.dirname(script_dir)
+kernels_dir = os.path.join(project_dir, "test", "runtime", "Inputs")
+
+LEVELS = ["-O0", "-O1", "-O2", "-O3", "-Os"]
+
+# Runs shorter than this are mostly the startup of the process, their ratio
+# is not compared.
+MIN_RUN_TIME = 0.02
+
+#
+# Build
+#
+
+def first_tool(*names: str) -> str:
+    for name in names:
+        if path := shutil.which(name):
+            return path
+    return names[0]
+
+
+def check_call(command: List[str]) -> Optional[str]:
+    """Returns the last line of stderr if the command fails."""
+    process = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    if process.returncode == 0:
+        return None
+    lines = process.stderr.decode(errors="replace").strip().splitlines()
+    return lines[-1] if lines else f"exit code {process.returncode}"
+
+
+def build(compiler: List[str], clang: str, source: str, level: str, args: List[str],
+          workdir: str, tag: str) -> Tuple[Optional[str], str, str]:
+    """Compiles the kernel to an object with `compiler` and links it with clang."""
+    name = os.path.splitext(os.path.basename(source))[0]
+    obj = os.path.join(workdir, f"{name}{level}.{tag}.o")
+    exe = os.path.join(workdir, f"{name}{level}.{tag}")
+
+    error = check_call(compiler + ["-c", level, source, "-o", obj] + args)
+    if not error:
+        error = check_call([clang, obj, "-o", exe, "-lm"])
+    return error, obj, exe
+
+
+text_row = re.compile(r"^\s*(\d+)\s+\d+\s+\d+\s+\d+\s+[0-9a-f]+\s")
+
+def code_size(size_tool: str, obj: str) -> int:
+    """Bytes of code of an object, the `text` column of Berkeley `size`."""
+    output = subprocess.run([size_tool, obj], capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        if match := text_row.match(line):
+            return int(match.group(1))
+    return os.path.getsize(obj)
+
+#
+# Measurement
+#
+
+def run(exe: str, repeat: int) -> Tuple[Optional[str], float, str]:
+    """Returns the error, the fastest wall time and the output of the program."""
+    walls, output = [], ""
+    for _ in range(repeat):
+        start = time.perf_counter()
+        process = subprocess.run([exe], capture_output=True, text=True)
+        walls.append(time.perf_counter() - start)
+        if process.returncode != 0:
+            return f"exit code {process.returncode}", 0.0, process.stdout
+        output = process.stdout
+    return None, min(walls), output
+
+
+def measure(opts: argparse.Namespace, source: str, level: str) -> Metrics:
+    args = [f"-DSCALE={opts.scale}"]
+    vast = [opts.vast_front, "-vast-pipeline=with-abi"]
+
+    result = {}
+    for tag, compiler in (("vast", vast), ("clang", [opts.clang])):
+        error, obj, exe = build(compiler, opts.clang, source, level, args, opts.workdir, tag)
+        if error:
+            return {"error": [f"{tag}: {error}"]}
+
+        error, wall, output = run(exe, opts.repeat)
+        if error:
+            return {"error": [f"{tag}: {error}"]}
+
+        result[tag] = {"wall": wall, "size": code_size(opts.size_tool, obj), "output": output}
+
+    vast, clang = result["vast"], result["clang"]
+    if vast["output"] != clang["output"]:
+        return {"error": ["outputs of vast and clang differ"]}
+
+    return {
+        "vast": {"wall": vast["wall"], "size": vast["size"]},
+        "clang": {"wall": clang["wall"], "size": clang["size"]},
+        "runtime_ratio": vast["wall"] / clang["wall"] if clang["wall"] > 0 else 0.0,
+        "size_ratio": vast["size"] / clang["size"] if clang["size"] > 0 else 0.0,
+    }
+
+
+def measure_kernels(opts: argparse.Namespace) -> Metrics:
+    os.makedirs(opts.workdir, exist_ok=True)
+
+    results = {}
+    for source in sorted(os.listdir(opts.kernels)):
+        name, ext = os.path.splitext(source)
+        if ext != ".c" or (opts.only and name not in opts.only):
+            continue
+
+        for level in opts.levels:
+            key = f"{name}/{level}"
+            print(f"measuring {key}", file=sys.stderr)
+            results[key] = measure(opts, os.path.join(opts.kernels, source), level)
+
+    return {"scale": opts.scale, "results": results}
+
+
+def report(current: Metrics):
+    print(f"{'kernel':<24} {'vast':>9} {'clang':>9} {'time':>7} {'vast':>8} {'clang':>8} {'size':>7}")
+    for key, entry in sorted(current["results"].items()):
+        if "error" in entry:
+            print(f"{key:<24} error: {' '.join(entry['error'])}")
+            continue
+
+        vast, clang = entry["vast"], entry["clang"]
+        print(f"{key:<24} {vast['wall']:>8.3f}s {clang['wall']:>8.3f}s {entry['runtime_ratio']:>6.2f}x "
+              f"{vast['size']:>8} {clang['size']:>8} {entry['size_ratio']:>6.2f}x")
+
+#
+# Comparison
+#
+
+def check_limits(current: Metrics, max_runtime: Optional[float], max_size: Optional[float]) -> List[str]:
+    """Kernels that fail or whose ratios exceed the limits."""
+    found = []
+    for key, entry in current["results"].items():
+        if "error" in entry:
+            found.append(f"{key}: fails: {' '.join(entry['error'])}")
+            continue
+
+        timed = entry["clang"]["wall"] >= MIN_RUN_TIME
+        if max_runtime and timed and entry["runtime_ratio"] > max_runtime:
+            found.append(f"{key}: runtime ratio {entry['runtime_ratio']:.2f} exceeds {max_runtime:.2f}")
+        if max_size and entry["size_ratio"] > max_size:
+            found.append(f"{key}: code size ratio {entry['size_ratio']:.2f} exceeds {max_size:.2f}")
+
+    return found
+
+
+def compare(baseline: Metrics, current: Metrics, threshold: float) -> List[str]:
+    """Ratios of `current` that grew above the threshold against `baseline`."""
+    if baseline.get("scale") != current["scale"]:
+        print("warning: the baseline was recorded at a different scale, not compared", file=sys.stderr)
+        return []
+
+    found = []
+    for key, after in current["results"].items():
+        before = baseline["results"].get(key)
+        if before is None or "error" in before or "error" in after:
+            continue
+
+        if after["clang"]["wall"] >= MIN_RUN_TIME:
+            old, new = before["runtime_ratio"], after["runtime_ratio"]
+            if regressed(old, new, threshold):
+                found.append(f"{key}: runtime ratio {old:.2f} -> {new:.2f}")
+
+        old, new = before["size_ratio"], after["size_ratio"]
+        if regressed(old, new, threshold):
+            found.append(f"{key}: code size ratio {old:.2f} -> {new:.2f}")
+
+    return found
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Runtime harness of code generated by vast-front.")
+    parser.add_argument("--vast-front", default=shutil.which("vast-front") or "vast-front",
+                        help="vast-front to measure")
+    parser.add_argument("--clang", default=first_tool("clang-17", "clang"),
+                        help="clang to compare against, also links both programs")
+    parser.add_argument("--size-tool", default=first_tool("llvm-size-17", "llvm-size", "size"),
+                        help="tool printing the sizes of sections in the Berkeley format")
+    parser.add_argument("--kernels", default=kernels_dir, help="directory of the kernels")
+    parser.add_argument("--workdir", default="runtime-kernels",
+                        help="directory of the built programs")
+    parser.add_argument("--levels", nargs="+", choices=LEVELS, default=["-O0", "-O2"],
+                        help="optimization levels (default -O0 -O2)")
+    parser.add_argument("--scale", type=int, default=1,
+                        help="multiplier of the work of each kernel (default 1)")
+    parser.add_argument("--repeat", type=int, default=5,
+                        help="runs of each program, the fastest is kept (default 5)")
+    parser.add_argument("--only", nargs="+", default=[], help="measure only these kernels")
+    parser.add_argument("--baseline", help="results to compare against")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write the results to --baseline instead of comparing")
+    parser.add_argument("--output", help="write the results to a file")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="regression threshold of the ratios in percent (default 10)")
+    parser.add_argument("--max-runtime-ratio", type=float,
+                        help="fail if vast code runs this many times longer than clang code")
+    parser.add_argument("--max-size-ratio", type=float,
+                        help="fail if vast code is this many times larger than clang code")
+    opts = parser.parse_args()
+
+    current = measure_kernels(opts)
+    report(current)
+
+    if opts.output:
+        with open(opts.output, "w") as file:
+            json.dump(current, file, indent=2, sort_keys=True)
+
+    failures = check_limits(current, opts.max_runtime_ratio, opts.max_size_ratio)
+
+    if opts.baseline and opts.update_baseline:
+        with open(opts.baseline, "w") as file:
+            json.dump(current, file, indent=2, sort_keys=True)
+    elif opts.baseline and os.path.isfile(opts.baseline):
+        with open(opts.baseline) as file:
+            failures += compare(json.load(file), current, opts.threshold / 100)
+    elif opts.baseline:
+        print(f"no baseline at {opts.baseline}, record one with --update-baseline", file=sys.stderr)
+
+    for failure in failures:
+        print(f"regression: {failure}")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
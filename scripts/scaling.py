@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#
+# Scaling harness. Generates C programs of growing size along one dimension
+# (functions, structs, fields, typedef depth, nesting depth or statements per
+# function), compiles each with vast-front and fits wall time, peak memory and
+# time of each pass against the size. A phase that grows faster than
+# `--max-exponent` (e.g., quadratic lookups of symbols) fails the run.
+#
+
+import argparse
+import json
+import math
+import os
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+from typing import Any, Dict, List, Optional, Tuple
+
+from compile_time import PHASES, MIN_PASS_TIME, parse_pass_timing
+
+Metrics = Dict[str, Any]
+
+# Size of the program in each dimension when another one is scaled.
+DEFAULTS = {
+    "functions": 200,
+    "structs": 50,
+    "fields": 8,
+    "typedef_depth": 2,
+    "nesting": 2,
+    "statements": 8,
+}
+
+# Sizes of the scaled dimension, each twice the previous one.
+SIZES = {
+    "functions": [500, 1000, 2000, 4000],
+    "structs": [250, 500, 1000, 2000],
+    "fields": [32, 64, 128, 256],
+    "typedef_depth": [16, 32, 64, 128],
+    "nesting": [8, 16, 32, 64],
+    "statements": [100, 200, 400, 800],
+}
+
+# Phases that run shorter than this on the largest input are not fitted, the
+# startup of vast-front dominates them.
+MIN_WALL_TIME = 0.1
+
+FIELD_TYPES = ["int", "long", "double", "char", "unsigned", "short"]
+
+#
+# Generator
+#
+
+def generate(functions: int, structs: int, fields: int, typedef_depth: int,
+             nesting: int, statements: int) -> str:
+    """C program whose every part grows linearly with its parameters."""
+    structs = max(structs, 1)
+    fields = max(fields, 1)
+    out = []
+
+    # Each struct links to the previous one, so that records refer to each
+    # other, and is reached through a chain of typedefs.
+    for s in range(structs):
+        out.append(f"struct s{s} {{")
+        for f in range(fields):
+            out.append(f"    {FIELD_TYPES[f % len(FIELD_TYPES)]} f{f};")
+        if s > 0:
+            out.append(f"    struct s{s - 1} *link;")
+        out.append("};")
+
+        alias = f"struct s{s}"
+        for d in range(typedef_depth):
+            out.append(f"typedef {alias} t{s}_{d};")
+            alias = f"t{s}_{d}"
+        out.append(f"typedef {alias} r{s};")
+
+    globals_count = max(structs, 1)
+    for g in range(globals_count):
+        out.append(f"r{g} g{g};")
+
+    def body(fn: int, depth: int, indent: str):
+        record = fn % structs
+        for k in range(statements):
+            field = f"f{(fn + k) % fields}"
+            kind = k % 4
+            if kind == 0:
+                out.append(f"{indent}p->{field} += n;")
+            elif kind == 1:
+                out.append(f"{indent}int v{depth}_{k} = p->{field} + g{record}.{field};")
+                out.append(f"{indent}sum += v{depth}_{k};")
+            elif kind == 2 and fn > 0:
+                out.append(f"{indent}sum += fn{fn - 1}(&g{(fn - 1) % structs}, n - 1);")
+            else:
+                out.append(f"{indent}g{record}.{field} = sum;")
+
+        if depth < nesting:
+            var = f"i{depth}"
+            if depth % 2 == 0:
+                out.append(f"{indent}for (int {var} = 0; {var} < n; ++{var}) {{")
+            else:
+                out.append(f"{indent}if (sum % {depth + 2}) {{")
+            body(fn, depth + 1, indent + "    ")
+            out.append(f"{indent}}}")
+
+    for fn in range(functions):
+        out.append(f"int fn{fn}(r{fn % structs} *p, int n) {{")
+        out.append("    int sum = 0;")
+        body(fn, 0, "    ")
+        out.append("    return sum;")
+        out.append("}")
+
+    out.append("int main(void) {")
+    if functions:
+        out.append(f"    return fn{functions - 1}(&g{(functions - 1) % structs}, 1);")
+    else:
+        out.append("    return 0;")
+    out.append("}")
+
+    return "\n".join(out) + "\n"
+
+#
+# Measurement
+#
+
+def run(command: List[str], timeout: float) -> Tuple[Optional[int], float, int, str]:
+    """Returns the exit code (None on a timeout), wall time, peak RSS in KiB and stderr."""
+    with tempfile.TemporaryFile() as err:
+        start = time.perf_counter()
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=err)
+
+        while True:
+            pid, status, usage = os.wait4(process.pid, os.WNOHANG)
+            wall = time.perf_counter() - start
+            if pid:
+                break
+            if wall > timeout:
+                process.send_signal(signal.SIGKILL)
+                os.wait4(process.pid, 0)
+                process.returncode = -signal.SIGKILL
+                return None, wall, 0, ""
+            time.sleep(0.01)
+
+        err.seek(0)
+        stderr = err.read().decode(errors="replace")
+
+    code = process.returncode = os.waitstatus_to_exitcode(status)
+    # macOS reports bytes, Linux KiB.
+    rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return code, wall, rss, stderr
+
+
+def measure(front: str, source: str, phase: str, repeat: int, timeout: float) -> Metrics:
+    command = [front, source] + PHASES[phase] + ["-o", os.devnull]
+
+    walls, rss, passes = [], 0, {}
+    for _ in range(repeat):
+        code, wall, peak, stderr = run(command, timeout)
+        if code is None:
+            return {"error": [f"timed out after {timeout:.0f}s"]}
+        if code != 0:
+            return {"error": stderr.strip().splitlines()[-1:] or [f"exit code {code}"]}
+
+        walls.append(wall)
+        rss = max(rss, peak)
+        # Keep the pass times of the fastest run.
+        if wall == min(walls):
+            passes = parse_pass_timing(stderr)
+
+    metrics = {"wall": min(walls), "rss": rss}
+    if passes:
+        metrics["passes"] = passes
+    return metrics
+
+#
+# Fitting
+#
+
+def exponent(sizes: List[int], values: List[float]) -> Optional[float]:
+    """Slope of the least squares line of log(value) against log(size)."""
+    points = [(math.log(s), math.log(v)) for s, v in zip(sizes, values) if s > 0 and v > 0]
+    if len(points) < 2:
+        return None
+
+    mean_x = sum(x for x, _ in points) / len(points)
+    mean_y = sum(y for _, y in points) / len(points)
+    var = sum((x - mean_x) ** 2 for x, _ in points)
+    if var == 0:
+        return None
+    return sum((x - mean_x) * (y - mean_y) for x, y in points) / var
+
+
+def series(results: List[Metrics]) -> Dict[str, List[float]]:
+    """Values of each metric of a phase, in the order of the sizes."""
+    out = {"rss": [float(r["rss"]) for r in results]}
+    if results[-1]["wall"] >= MIN_WALL_TIME:
+        out["wall"] = [r["wall"] for r in results]
+
+    # Passes too short on the largest input are noise.
+    largest = results[-1].get("passes", {})
+    for name, time_spent in largest.items():
+        if time_spent >= MIN_PASS_TIME:
+            out[f"pass {name}"] = [r.get("passes", {}).get(name, 0.0) for r in results]
+    return out
+
+
+def fit(sizes: List[int], measured: Dict[str, List[Metrics]]) -> Dict[str, Dict[str, Optional[float]]]:
+    fits = {}
+    for phase, results in measured.items():
+        if any("error" in r for r in results):
+            continue
+        fits[phase] = {metric: exponent(sizes, values) for metric, values in series(results).items()}
+    return fits
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Scaling harness of vast-front.")
+    parser.add_argument("--vast-front", default=shutil.which("vast-front") or "vast-front",
+                        help="vast-front to measure")
+    parser.add_argument("--scale", choices=list(DEFAULTS), default="functions",
+                        help="dimension of the program that grows (default functions)")
+    parser.add_argument("--sizes", type=int, nargs="+",
+                        help="sizes of the scaled dimension, defaults depend on --scale")
+    for name, value in DEFAULTS.items():
+        parser.add_argument(f"--{name.replace('_', '-')}", type=int, default=value,
+                            help=f"size of the other programs in this dimension (default {value})")
+    parser.add_argument("--phases", nargs="+", choices=list(PHASES), default=list(PHASES))
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="runs of each size, the fastest is kept (default 1)")
+    parser.add_argument("--timeout", type=float, default=300.0,
+                        help="seconds a compilation may take before it counts as hung (default 300)")
+    parser.add_argument("--max-exponent", type=float, default=1.5,
+                        help="fail if a metric grows faster than size^exponent (default 1.5)")
+    parser.add_argument("--workdir", default="scaling-inputs",
+                        help="directory of the generated programs")
+    parser.add_argument("--generate", metavar="FILE",
+                        help="only write a program of the given sizes to FILE ('-' for stdout)")
+    parser.add_argument("--output", help="write the measurements and fits to a file")
+    opts = parser.parse_args()
+
+    params = {name: getattr(opts, name) for name in DEFAULTS}
+
+    if opts.generate:
+        source = generate(**params)
+        if opts.generate == "-":
+            sys.stdout.write(source)
+        else:
+            with open(opts.generate, "w") as file:
+                file.write(source)
+        return 0
+
+    sizes = sorted(opts.sizes or SIZES[opts.scale])
+    os.makedirs(opts.workdir, exist_ok=True)
+
+    measured = {phase: [] for phase in opts.phases}
+    for size in sizes:
+        source = os.path.join(opts.workdir, f"{opts.scale}-{size}.c")
+        with open(source, "w") as file:
+            file.write(generate(**dict(params, **{opts.scale: size})))
+
+        for phase in opts.phases:
+            print(f"measuring {opts.scale}={size} {phase}", file=sys.stderr)
+            measured[phase].append(measure(opts.vast_front, source, phase, opts.repeat, opts.timeout))
+
+    fits = fit(sizes, measured)
+
+    if opts.output:
+        with open(opts.output, "w") as file:
+            json.dump({"scale": opts.scale, "sizes": sizes, "results": measured, "fits": fits},
+                      file, indent=2, sort_keys=True)
+
+    failures = []
+    for phase, results in measured.items():
+        for size, result in zip(sizes, results):
+            if "error" in result:
+                failures.append(f"{phase} {opts.scale}={size}: fails: {' '.join(result['error'])}")
+
+    for phase, metrics in fits.items():
+        for metric, k in metrics.items():
+            if k is None:
+                continue
+            print(f"{phase:8} {metric:40} ~ size^{k:.2f}")
+            if k > opts.max_exponent:
+                failures.append(f"{phase} {metric}: grows as size^{k:.2f} in {opts.scale}")
+
+    for failure in failures:
+        print(f"scaling: {failure}")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
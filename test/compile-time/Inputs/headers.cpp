@@ -0,0 +1,34 @@
+// A translation unit dominated by the standard library headers it includes,
+// measures the cost of declarations that are never used.
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct entry {
+    std::string name;
+    int count;
+};
+
+int count_words(const std::vector< std::string > &words) {
+    std::map< std::string, int > counts;
+    for (const auto &word : words) {
+        ++counts[word];
+    }
+
+    std::vector< entry > entries;
+    for (const auto &[name, count] : counts) {
+        entries.push_back({ name, count });
+    }
+
+    std::sort(entries.begin(), entries.end(), [] (const entry &a, const entry &b) {
+        return a.count > b.count;
+    });
+
+    return entries.empty() ? 0 : entries.front().count;
+}
@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.a.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DSECOND %s -o %t.b.mlir
+// RUN: %vast-link --stats %t.a.mlir %t.b.mlir -o %t.mlir 2> %t.stats
+// RUN: %file-check %s -input-file=%t.mlir
+// RUN: %file-check %s -input-file=%t.stats -check-prefix=STATS
+// RUN: %vast-link --emit-bytecode %t.a.mlir %t.b.mlir -o %t.mlirbc && %vast-opt %t.mlirbc | diff -B %t.mlir -
+
+// CHECK: hl.struct "point"
+// CHECK-NOT: hl.struct "point"
+struct point { int x, y; };
+
+// CHECK: hl.func @helper
+// CHECK: hl.func @get
+// CHECK: hl.call @helper.1
+// CHECK: hl.func @main
+// CHECK: hl.call @get
+// CHECK: hl.call @helper(
+// CHECK: hl.func @helper.1
+static int helper(struct point p) { return p.x; }
+
+#ifndef SECOND
+int get(struct point p);
+int main(void) { struct point p = { 1, 2 }; return get(p) + helper(p); }
+#else
+int get(struct point p) { return helper(p); }
+#endif
+
+// STATS: modules: 2
+// STATS: deduplicated: 1
+// STATS: merged symbols: 1
+// STATS: renamed: 1
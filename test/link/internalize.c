@@ -0,0 +1,39 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.a.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DLIBRARY %s -o %t.b.mlir
+// RUN: %vast-link %t.a.mlir %t.b.mlir -o %t.mlir
+// RUN: %vast-opt --vast-hl-internalize %t.mlir | %file-check %s
+// RUN: %vast-opt --vast-hl-internalize %t.mlir | %file-check %s -check-prefix=DEAD
+// RUN: %vast-opt "--vast-hl-internalize=entry-points=main,lib_unused" %t.mlir | %file-check %s -check-prefix=EXPORT
+
+#ifdef LIBRARY
+
+// CHECK-DAG: hl.var "lib_state" sc_static
+int lib_state;
+
+// DEAD-NOT: hl.var "lib_table"
+// EXPORT: hl.var "lib_table" sc_static
+int lib_table[16] = { 1 };
+
+// CHECK-DAG: hl.func @lib_used internal
+int lib_used(int x) { return x + lib_state; }
+
+// DEAD-NOT: hl.func @lib_unused
+// EXPORT: hl.func @lib_unused ()
+int lib_unused(void) { return lib_table[0]; }
+
+// CHECK-DAG: hl.func @reset_handler internal
+void reset_handler(void) { lib_state = 0; }
+
+// Referenced by the linker script, it stays visible.
+// CHECK-DAG: hl.var "vectors"
+// DEAD-NOT: hl.var "vectors" {{.*}}sc_static
+void (*vectors[])(void) __attribute__((section(".vectors"))) = { reset_handler };
+
+#else
+
+int lib_used(int x);
+
+// CHECK-DAG: hl.func @main ()
+int main(void) { return lib_used(1); }
+
+#endif
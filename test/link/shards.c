@@ -0,0 +1,46 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir
+// RUN: %vast-opt --shard=2 %t.mlir -o %t.shard.mlir
+// RUN: %file-check %s -input-file=%t.shard.0.mlir -check-prefix=S0
+// RUN: %file-check %s -input-file=%t.shard.1.mlir -check-prefix=S1
+// RUN: %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm %t.shard.0.mlir -o %t.ll.0.mlir
+// RUN: %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm %t.shard.1.mlir -o %t.ll.1.mlir
+// RUN: %vast-link --merge-shards %t.ll.0.mlir %t.ll.1.mlir | %file-check %s -check-prefix=MERGED
+
+// S0: vast.shard.internal = ["helper"]
+// S1: vast.shard.internal = ["helper"]
+
+// S0: hl.var "counter"
+// S0-NOT: sc_extern
+// S1: hl.var "counter" sc_extern
+int counter;
+
+// S0: hl.func @helper (
+// S0-NOT: hl.add
+// S1: hl.func @helper (
+// S1: hl.add
+// MERGED-DAG: llvm.func internal @helper(
+static int helper(int x) { return x + 1; }
+
+// S0: hl.func @small (
+// S0-NOT: hl.call
+// S1: hl.func @small (
+// S1: hl.call @helper
+// MERGED-DAG: llvm.func @small(
+int small(int x) { return helper(x) * 2 + counter; }
+
+// S0: hl.func @big (
+// S0: hl.call @helper
+// S1: hl.func @big (
+// S1-NOT: hl.for
+// MERGED-DAG: llvm.func @big(
+int big(int x) {
+    int y = helper(x);
+    for (int i = 0; i < x; ++i) {
+        y += i * x;
+        if (y > 100) {
+            y = y / 2 - i;
+        }
+    }
+    counter += y;
+    return y * y + x;
+}
@@ -59,8 +59,11 @@ tools = [
     ),
     ToolSubst('%vast-cc', command = 'vast-cc'),
     ToolSubst('%vast-query', command = 'vast-query'),
+    ToolSubst('%vast-link', command = 'vast-link'),
+    ToolSubst('%vast-translate', command = 'vast-translate'),
     ToolSubst('%vast-front', command = 'vast-front'),
     ToolSubst('%vast-repl', command = 'vast-repl'),
+    ToolSubst('%vast-lsp-server', command = 'vast-lsp-server'),
     ToolSubst('%vast-cc1', command = 'vast-front',
         extra_args=[
             "-cc1",
@@ -69,6 +72,8 @@ tools = [
         ]
     ),
     ToolSubst('%file-check', command = 'FileCheck'),
+    ToolSubst('%llvm-profdata', command = 'llvm-profdata'),
+    ToolSubst('%llvm-dis', command = 'llvm-dis'),
     ToolSubst('%clang', command = 'clang-17')
 ]
 
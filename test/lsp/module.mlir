@@ -0,0 +1,29 @@
+// RUN: %vast-lsp-server --incremental-modules --lit-test < %s | %file-check %s
+{"jsonrpc":"2.0","id":0,"method":"initialize","params":{"processId":123,"rootUri":"test:///","capabilities":{},"trace":"off"}}
+// CHECK-LABEL: "id": 0
+// -----
+{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":{"uri":"test:///foo.mlir","languageId":"mlir","version":1,"text":"module {\n  hl.func @value () -> !hl.int {\n    %0 = hl.const #core.integer<42> : !hl.int\n    hl.return %0 : !hl.int\n  }\n  hl.func @main () -> !hl.int {\n    %0 = hl.call @value() : () -> !hl.int\n    hl.return %0 : !hl.int\n  }\n}\n"}}}
+// CHECK: "method": "textDocument/publishDiagnostics"
+// CHECK: "diagnostics": []
+// -----
+{"jsonrpc":"2.0","id":1,"method":"textDocument/definition","params":{"textDocument":{"uri":"test:///foo.mlir"},"position":{"line":6,"character":20}}}
+// CHECK-LABEL: "id": 1
+// CHECK: "line": 1
+// CHECK: "uri": "test:///foo.mlir"
+// -----
+{"jsonrpc":"2.0","id":2,"method":"textDocument/references","params":{"textDocument":{"uri":"test:///foo.mlir"},"position":{"line":1,"character":12},"context":{"includeDeclaration":false}}}
+// CHECK-LABEL: "id": 2
+// CHECK: "line": 6
+// -----
+{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"test:///foo.mlir","version":2},"contentChanges":[{"range":{"start":{"line":6,"character":4},"end":{"line":6,"character":4}},"text":"oops "}]}}
+// CHECK: "method": "textDocument/publishDiagnostics"
+// CHECK: "line": 6
+// CHECK: "severity": 1
+// -----
+{"jsonrpc":"2.0","id":3,"method":"textDocument/hover","params":{"textDocument":{"uri":"test:///foo.mlir"},"position":{"line":1,"character":12}}}
+// CHECK-LABEL: "id": 3
+// CHECK: hl.func @value
+// -----
+{"jsonrpc":"2.0","id":4,"method":"shutdown"}
+// -----
+{"jsonrpc":"2.0","method":"exit"}
@@ -0,0 +1,33 @@
+// RUN: %vast-lsp-server --c-sources --lit-test < %s | %file-check %s
+{"jsonrpc":"2.0","id":0,"method":"initialize","params":{"processId":123,"rootUri":"test:///","capabilities":{},"trace":"off"}}
+// CHECK-LABEL: "id": 0
+// CHECK: "definitionProvider": true
+// CHECK: "hoverProvider": true
+// CHECK: "referencesProvider": true
+// -----
+{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":{"uri":"test:///foo.c","languageId":"c","version":1,"text":"int value(void) { return 42; }\nint main(void) { return value(); }\n"}}}
+// -----
+{"jsonrpc":"2.0","id":1,"method":"textDocument/definition","params":{"textDocument":{"uri":"test:///foo.c"},"position":{"line":1,"character":25}}}
+// CHECK-LABEL: "id": 1
+// CHECK: "line": 0
+// CHECK: "uri": "test:///foo.c"
+// -----
+{"jsonrpc":"2.0","id":2,"method":"textDocument/hover","params":{"textDocument":{"uri":"test:///foo.c"},"position":{"line":1,"character":25}}}
+// CHECK-LABEL: "id": 2
+// CHECK: "kind": "markdown"
+// CHECK: "value": "```mlir{{.*}}hl.func @value
+// -----
+{"jsonrpc":"2.0","id":3,"method":"textDocument/references","params":{"textDocument":{"uri":"test:///foo.c"},"position":{"line":0,"character":5},"context":{"includeDeclaration":false}}}
+// CHECK-LABEL: "id": 3
+// CHECK: "line": 1
+// CHECK: "uri": "test:///foo.c"
+// -----
+{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"test:///foo.c","version":2},"contentChanges":[{"text":"int other(void) { return 42; }\nint main(void) { return other(); }\n"}]}}
+// -----
+{"jsonrpc":"2.0","id":4,"method":"textDocument/hover","params":{"textDocument":{"uri":"test:///foo.c"},"position":{"line":1,"character":25}}}
+// CHECK-LABEL: "id": 4
+// CHECK: hl.func @other
+// -----
+{"jsonrpc":"2.0","id":5,"method":"shutdown"}
+// -----
+{"jsonrpc":"2.0","method":"exit"}
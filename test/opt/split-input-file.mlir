@@ -0,0 +1,29 @@
+// RUN: %vast-opt --split-input-file --split-jobs=4 --canonicalize %s | %file-check %s
+// RUN: %vast-opt --split-input-file --split-jobs=1 --canonicalize %s | %file-check %s
+
+// CHECK-LABEL: func.func @first
+// CHECK-NEXT: return
+func.func @first() {
+  return
+}
+
+// -----
+
+// CHECK: {{^// -{5}$}}
+// CHECK-LABEL: func.func @second
+// CHECK-NEXT: %[[C:.*]] = arith.constant 3 : i32
+// CHECK-NEXT: return %[[C]]
+func.func @second() -> i32 {
+  %a = arith.constant 1 : i32
+  %b = arith.constant 2 : i32
+  %c = arith.addi %a, %b : i32
+  return %c : i32
+}
+
+// -----
+
+// CHECK: {{^// -{5}$}}
+// CHECK-LABEL: func.func @third
+func.func @third() {
+  return
+}
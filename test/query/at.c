@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t
+// RUN: %vast-query --at=at.c:23-24 %t | %file-check %s -check-prefix=BODY
+// RUN: %vast-query --at=at.c:18 %t | %file-check %s -check-prefix=GLOBAL
+// RUN: %vast-query --format=ndjson --at=query/at.c:24 %t | %file-check %s -check-prefix=JSON
+// RUN: not %vast-query --at=at.c:24-23 %t 2>&1 | %file-check %s -check-prefix=INVALID
+
+// BODY: hl.func : foo
+// BODY-NEXT: hl.var {{.*}}:23:
+// BODY-NOT: hl.func : bar
+// BODY: hl.ref {{.*}}:24:
+
+// GLOBAL-NOT: hl.func
+// GLOBAL: hl.var {{.*}}:18:
+
+// JSON: {"kind":"op","op":"hl.ref",{{.*}}"function":"foo",{{.*}}"line":24,
+
+// INVALID: error: invalid location 'at.c:24-23'
+int g;
+
+int bar(void) { return 0; }
+
+int foo(int x) {
+    int a = x;
+    return a + bar();
+}
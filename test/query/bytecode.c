@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-mlir-bytecode %s -o %t.mlirbc
+// RUN: %vast-query --show-symbols=functions %t.mlirbc | %file-check %s -check-prefix=FUN
+// RUN: %vast-query --show-symbols=vars --scope=main %t.mlirbc | %file-check %s -check-prefix=MAIN-VAR
+// RUN: %vast-opt %t.mlirbc | %file-check %s -check-prefix=TEXT
+
+// FUN-DAG: func : foo
+// TEXT: hl.func @foo
+int foo() {
+    int a;
+    return a;
+}
+
+// MAIN-VAR-NOT: hl.var : a
+// MAIN-VAR: hl.var : b
+// FUN-DAG: func : main
+int main()
+{
+    int b = 1;
+    return b;
+}
@@ -0,0 +1,55 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t
+// RUN: %vast-query --callgraph=callers --functions=leaf %t | %file-check %s -check-prefix=CALLERS
+// RUN: %vast-query --callgraph=callees --functions=main,even %t | %file-check %s -check-prefix=CALLEES
+// RUN: %vast-query --callgraph=reachable %t | %file-check %s -check-prefix=REACH
+// RUN: %vast-query --callgraph=sccs %t | %file-check %s -check-prefix=SCC
+// RUN: %vast-query --format=ndjson --callgraph=sccs %t | %file-check %s -check-prefix=JSON
+
+// Functions are numbered in the order they are first seen, the declaration of
+// odd comes before even. The call graph is cached in the index.
+// RUN: %vast-query --build-index=%t.idx %t
+// RUN: %vast-query --index=%t.idx --callgraph=sccs < /dev/null | %file-check %s -check-prefix=SCC
+
+// CALLERS: even
+// CALLERS-NEXT: self
+// CALLERS-NEXT: unused
+// CALLERS-NEXT: main (indirect)
+
+// CALLEES: main:
+// CALLEES-NEXT: leaf (indirect)
+// CALLEES-NEXT: even
+// CALLEES-NEXT: self
+// CALLEES-NEXT: even:
+// CALLEES-NEXT: leaf
+// CALLEES-NEXT: odd
+
+// REACH: leaf
+// REACH-NEXT: odd
+// REACH-NEXT: even
+// REACH-NEXT: self
+// REACH-NEXT: main
+// REACH-NOT: unused
+
+// SCC: odd even
+// SCC-NEXT: self
+// SCC-NOT: main
+
+// JSON: {"kind":"scc","functions":["odd","even"]}
+// JSON-NEXT: {"kind":"scc","functions":["self"]}
+
+int leaf(void) { return 0; }
+
+int odd(int n);
+
+int even(int n) { return n ? odd(n - 1) : leaf(); }
+
+int odd(int n) { return n ? even(n - 1) : 0; }
+
+int self(int n) { return n ? self(n - 1) + leaf() : 0; }
+
+int unused(void) { return leaf(); }
+
+int main(void) {
+    int (*fp)(void) = leaf;
+    return even(4) + self(2) + fp();
+}
@@ -0,0 +1,23 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --show-symbols=globs %t | \
+// RUN: %file-check %s -check-prefix=GLOB
+
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --show-symbols=types %t | \
+// RUN: %file-check %s -check-prefix=TYPE
+
+// GLOB: hl.var : counter
+// GLOB-NOT: hl.var : calls
+// GLOB-NOT: hl.var : local
+int counter;
+
+// TYPE-DAG: hl.typedef : global_t
+typedef int global_t;
+
+int foo() {
+    static int calls;
+    // TYPE-DAG: hl.typedef : local_t
+    typedef int local_t;
+    local_t local = calls++;
+    return local + counter;
+}
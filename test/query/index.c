@@ -0,0 +1,44 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --build-index=%t.idx %t
+
+// RUN: %vast-query --index=%t.idx --show-symbols=functions %t | \
+// RUN: %file-check %s -check-prefix=FUN
+
+// RUN: %vast-query --index=%t.idx --show-symbols=vars --scope=main %t | \
+// RUN: %file-check %s -check-prefix=MAIN-VAR
+
+// RUN: %vast-query --index=%t.idx --symbol-users=a --scope=foo %t | \
+// RUN: %file-check %s -check-prefix=FOO
+
+// The index is answered from without the module.
+// RUN: %vast-query --index=%t.idx --show-symbols=functions < /dev/null | \
+// RUN: %file-check %s -check-prefix=FUN
+
+// An index out of date with the module is not used.
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DEXTRA %s -o %t && \
+// RUN: %vast-query --index=%t.idx --show-symbols=globs %t | \
+// RUN: %file-check %s -check-prefix=GLOB
+
+// FUN-DAG: func : foo
+// FOO: hl.ref %0
+int foo() {
+    int a;
+    return a;
+}
+
+// GLOB: hl.var : g
+int g;
+
+#ifdef EXTRA
+// GLOB: hl.var : h
+int h;
+#endif
+
+// MAIN-VAR-DAG: hl.var : a
+// MAIN-VAR-DAG: hl.var : b
+// FUN-DAG: func : main
+int main()
+{
+    int a = 1, b = 1;
+    return a + b;
+}
@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-query --layout-report %t | %file-check %s
+// RUN: %vast-query --layout-report --record=tight_t %t | %file-check %s -check-prefix=ONE
+
+// CHECK: struct loose { /* typedef loose_t */
+// CHECK: char tag;
+// CHECK: XXX 7 bytes hole, try to pack
+// CHECK: double x;
+// CHECK: char flag;
+// CHECK: XXX 7 bytes padding
+// CHECK: size: 24, align: 8, cachelines: 1, members: 3
+// CHECK: holes: 1, sum holes: 7 bytes, padding: 7 bytes
+// CHECK: uses: {{[1-9][0-9]*}}, wasted: 14 bytes
+
+// CHECK: struct big {
+// CHECK: cacheline 1 boundary (64 bytes)
+// CHECK: size: 72, align: 8, cachelines: 2, members: 2
+
+// CHECK: struct tight {
+// CHECK: size: 16, align: 8, cachelines: 1, members: 2
+// CHECK: wasted: 0 bytes, score: 0
+
+// ONE-NOT: struct loose
+// ONE: struct tight { /* typedef tight_t */
+// ONE-NOT: struct
+
+typedef struct loose { char tag; double x; char flag; } loose_t;
+typedef struct tight { double x; long y; } tight_t;
+struct big { char pad[60]; double x; };
+
+double sum(loose_t *a, loose_t *b, tight_t *t, struct big *g) {
+    return a->x + b->x + t->x + g->x;
+}
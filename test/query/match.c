@@ -0,0 +1,46 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t
+// RUN: %vast-query --match='hl.call callee(memcpy) operand(2, !const)' %t | %file-check %s -check-prefix=MEMCPY
+// RUN: %vast-query --match='hl.for|hl.while contains(hl.call)' %t | %file-check %s -check-prefix=LOOP
+// RUN: %vast-query --match='hl.call inside(hl.for)' --scope=loop_call %t | %file-check %s -check-prefix=INSIDE
+// RUN: %vast-query --format=ndjson --match='hl.call callee(mem*)' %t | %file-check %s -check-prefix=JSON
+// RUN: not %vast-query --match='hl.call callee(' %t 2>&1 | %file-check %s -check-prefix=INVALID
+
+// MEMCPY-NOT: copy_fixed
+// MEMCPY: hl.func : copy_var
+// MEMCPY-NEXT: hl.call @memcpy
+// MEMCPY-NOT: copy_fixed
+
+// LOOP-NOT: loop_plain
+// LOOP: hl.func : loop_call
+// LOOP-NEXT: hl.for
+// LOOP-NOT: loop_plain
+
+// INSIDE: hl.func : loop_call
+// INSIDE-NEXT: hl.call @copy_var
+
+// JSON: {"kind":"match","op":"hl.call",{{.*}}"function":"copy_fixed",
+// JSON-NEXT: {"kind":"match","op":"hl.call",{{.*}}"function":"copy_var",
+
+// INVALID: error: invalid pattern at column {{[0-9]+}}: expected a name of a callee
+
+void *memcpy(void *dst, const void *src, unsigned long size);
+
+void copy_fixed(int *dst, const int *src) {
+    memcpy(dst, src, sizeof(int));
+}
+
+void copy_var(int *dst, const int *src, unsigned long size) {
+    memcpy(dst, src, size);
+}
+
+int loop_plain(int n) {
+    int sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += i;
+    return sum;
+}
+
+void loop_call(int *dst, const int *src, int n) {
+    for (int i = 0; i < n; ++i)
+        copy_var(dst + i, src + i, sizeof(int));
+}
@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t
+// RUN: echo '{"jsonrpc":"2.0","id":1,"method":"symbols","params":{"kind":"functions"}}' > %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":2,"method":"symbols"}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":3,"method":"rename"}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":4,"method":"shutdown"}' >> %t.in
+// RUN: %vast-query --serve --metrics=%t.prom %t < %t.in
+// RUN: %file-check %s --input-file=%t.prom
+
+// CHECK: # TYPE vast_query_requests counter
+// CHECK: vast_query_requests_total{method="symbols"} 2
+// CHECK: vast_query_requests_total{method="unknown"} 1
+// CHECK: # TYPE vast_query_request_seconds histogram
+// CHECK: vast_query_request_seconds_bucket{method="symbols",le="+Inf"} 2
+// CHECK: vast_query_request_seconds_count{method="symbols"} 2
+// CHECK: vast_query_errors_total 1
+// CHECK: vast_query_served_modules 1
+// CHECK: # TYPE vast_process_resident_memory_bytes gauge
+// CHECK: # EOF
+
+int leaf(void) { return 0; }
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t/sub
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DFIRST %s -o %t/a.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-mlir-bytecode %s -o %t/sub/b.mlirbc
+// RUN: %vast-query --symbol-users=foo %t | %file-check %s -check-prefix=DIR
+// RUN: %vast-query --show-symbols=functions %t/sub/b.mlirbc %t/a.mlir | \
+// RUN: %file-check %s -check-prefix=FILES
+// RUN: not %vast-query --build-index=%t.idx %t/a.mlir %t/sub/b.mlirbc 2>&1 | \
+// RUN: %file-check %s -check-prefix=INDEX
+
+// INDEX: error: --build-index and --index take a single input module
+
+// DIR: // {{.*}}a.mlir
+// DIR-NEXT: hl.call @foo
+// DIR: // {{.*}}b.mlirbc
+// DIR-NEXT: hl.call @foo
+
+// FILES: // {{.*}}b.mlirbc
+// FILES-DAG: func : foo
+// FILES-DAG: func : second
+// FILES: // {{.*}}a.mlir
+// FILES-DAG: func : foo
+// FILES-DAG: func : first
+int foo(void) { return 0; }
+
+#ifdef FIRST
+int first(void) { return foo(); }
+#else
+int second(void) { return foo() + 1; }
+#endif
@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --format=ndjson --show-symbols=functions %t | \
+// RUN: %file-check %s -check-prefix=FUN
+
+// RUN: %vast-query --format=ndjson --symbol-users=a --scope=foo %t | \
+// RUN: %file-check %s -check-prefix=USER
+
+// RUN: %vast-query --format=ndjson --show-symbols=vars %t %t | \
+// RUN: %file-check %s -check-prefix=MULTI
+
+// FUN: {"kind":"symbol","op":"hl.func","name":"foo","location":{"file":"{{.*}}ndjson.c","line":[[@LINE+6]],"column":{{[0-9]+}}},"scope":
+// USER: {"kind":"user","op":"hl.ref","symbol":"a","text":"{{.*}}hl.ref %0{{.*}}","location":{"file":"{{.*}}ndjson.c","line":[[@LINE+7]],"column":{{[0-9]+}}},"scope":"foo"}
+
+// MULTI-NOT: //
+// MULTI: {"kind":"symbol","module":"{{.*}}","op":"hl.var","name":"a",{{.*}}"scope":"foo"}
+// MULTI: {"kind":"symbol","module":"{{.*}}","op":"hl.var","name":"a",{{.*}}"scope":"foo"}
+int foo() {
+    int a;
+    return a;
+}
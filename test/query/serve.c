@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t
+// RUN: echo '{"jsonrpc":"2.0","id":1,"method":"symbols","params":{"kind":"functions"}}' > %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":2,"method":"users","params":{"symbols":["x"],"scope":"use"}}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":3,"method":"callgraph","params":{"query":"callers","functions":["leaf"]}}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","method":"symbols"}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":4,"method":"rename"}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":5,"method":"at","params":{"location":"serve.c"}}' >> %t.in
+// RUN: echo 'not json' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":6,"method":"shutdown"}' >> %t.in
+// RUN: echo '{"jsonrpc":"2.0","id":7,"method":"symbols"}' >> %t.in
+// RUN: %vast-query --serve %t < %t.in | %file-check %s
+
+// CHECK: {"jsonrpc":"2.0","id":1,"result":[{"kind":"symbol","op":"hl.func","name":"leaf",{{.*}}},{"kind":"symbol","op":"hl.func","name":"use",{{.*}}}]}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":2,"result":[{"kind":"user","op":"hl.ref","symbol":"x",{{.*}}"scope":"use"}]}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":3,"result":[{"kind":"caller","function":"leaf","caller":"use","indirect":false}]}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":4,"error":{"code":-32601,"message":"unknown method 'rename'"}}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":5,"error":{"code":-32602,"message":"invalid parameters of 'at'"}}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":null,"error":{"code":-32700,"message":"cannot parse the request"}}
+// CHECK-NEXT: {"jsonrpc":"2.0","id":6,"result":null}
+// CHECK-NOT: "id":7
+
+int leaf(void) { return 0; }
+
+int use(void) {
+    int x = leaf();
+    return x;
+}
@@ -0,0 +1,9 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-query --storage-report %t | %file-check %s
+
+// CHECK: types: {{[0-9]+}} uniqued
+// CHECK: hl.int
+// CHECK: attributes: {{[0-9]+}} uniqued
+// CHECK: locations: {{[0-9]+}} uniqued
+// CHECK: operations: {{[0-9]+}}
+// CHECK: hl
+int main() { int x = 0; return x; }
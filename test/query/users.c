@@ -10,6 +10,16 @@
 // RUN: %vast-query --symbol-users=a --scope=foo %t | \
 // RUN: %file-check %s -check-prefix=FOO
 
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --symbol-users=a,b --scope=main %t | \
+// RUN: %file-check %s -check-prefix=BATCH
+
+// BATCH: a:
+// BATCH-NEXT: hl.ref %0
+// BATCH-NEXT: hl.ref %0
+// BATCH-NEXT: b:
+// BATCH-NEXT: hl.ref %1
+
 // FOO: hl.ref %0
 int foo() {
     int a;
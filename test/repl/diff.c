@@ -0,0 +1,14 @@
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf\n diff 0 1\n exit" | %vast-repl | %file-check %s
+// CHECK: symbol {{.*}} before {{.*}} after {{.*}} added {{.*}} removed {{.*}} rewritten
+// CHECK: main
+// CHECK-NOT: same
+// CHECK: total
+// REQUIRES: repl
+
+int same(int x);
+
+int main(void) {
+    if (same(1))
+        return 1;
+    return 0;
+}
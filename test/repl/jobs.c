@@ -0,0 +1,8 @@
+// RUN: printf "load %s &\n wait\n raise vast-hl-to-ll-cf,vast-hl-to-ll-vars &\n wait\n jobs\n show module\n exit" | %vast-repl | %file-check %s
+// CHECK: [done] load {{.*}}jobs.c, 1/1 steps in {{.*}} s
+// CHECK: [done] raise vast-hl-to-ll-cf,vast-hl-to-ll-vars, 2/2 steps in {{.*}} s
+// CHECK: no job is running
+// CHECK: @main
+// REQUIRES: repl
+
+int main(void) { int x = 0; return x; }
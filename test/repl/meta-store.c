@@ -0,0 +1,12 @@
+// RUN: printf "tag" > %t.blob
+// RUN: printf "load %s\n meta add 7 foo\n meta put 7 %t.blob\n meta save %t.meta\n meta blob 7\n meta blob 8\n raise vast-hl-to-ll-cf\n meta attached\n exit" | %vast-repl | %file-check %s
+// CHECK: 1 blobs
+// CHECK-NEXT: tag
+// CHECK-NOT: tag
+// CHECK: 7: hl.func @foo (3 bytes)
+// CHECK-NOT: @bar
+// REQUIRES: repl
+
+int foo(void) { return 0; }
+
+int bar(void) { return foo(); }
@@ -0,0 +1,9 @@
+// RUN: printf "load %s\n meta add 7 foo\n meta get 7\n meta get 8\n exit" | %vast-repl | %file-check %s
+// CHECK: hl.func @foo {{.*}}meta_identifier
+// CHECK: hl.func @foo {{.*}}meta_identifier
+// CHECK-NOT: hl.func @bar
+// REQUIRES: repl
+
+int foo(void) { return 0; }
+
+int bar(void) { return foo(); }
@@ -0,0 +1,23 @@
+// RUN: sed 's/return 1;/return 2;/' %s > %t.c
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf\n load %t.c\n show module\n exit" | %vast-repl | %file-check %s
+// CHECK-LABEL: hl.func @kept
+// CHECK-NOT: hl.return
+// CHECK: ll.return
+// CHECK-LABEL: hl.func @edited
+// CHECK-NOT: hl.return
+// CHECK: hl.const #core.integer<2>
+// CHECK-NOT: hl.return
+// CHECK: ll.return
+// REQUIRES: repl
+
+int kept(int x) {
+    if (x)
+        return x;
+    return 0;
+}
+
+int edited(int x) {
+    if (x)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,11 @@
+// RUN: cp %s %t.c
+// RUN: printf "load %t.c\n show module\n load %t.c\n show module\n exit" | %vast-repl | %file-check %s
+// CHECK: hl.func @value
+// CHECK: hl.const #core.integer<42>
+// CHECK: hl.func @value
+// CHECK: hl.const #core.integer<42>
+// REQUIRES: repl
+
+#define VALUE 42
+
+int value(void) { return VALUE; }
@@ -0,0 +1,8 @@
+// RUN: printf "load %s\n run add 2,40\n run add 1,-3 O0\n bench add 3 1,2\n exit" | %vast-repl | %file-check %s
+// CHECK: result: 42
+// CHECK: time:
+// CHECK: result: -2
+// CHECK: runs: 3, min: {{.*}} ms, median: {{.*}} ms
+// REQUIRES: repl
+
+int add(int a, int b) { return a + b; }
@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: printf "load %s\n spill %t/a 1\n raise vast-hl-to-ll-cf,vast-hl-to-ll-vars\n show module\n exit" | %vast-repl | %file-check %s
+// RUN: ls %t/a | %file-check %s -check-prefix=FILES
+// RUN: printf "load %s\n spill %t/b 1\n raise vast-hl-to-ll-cf,vast-hl-to-ll-vars\n spill %t/b 100000\n diff 1 2\n exit" | %vast-repl | %file-check %s -check-prefix=RELOAD
+// RUN: not ls %t/b/tower-level-1.mlirbc
+// REQUIRES: repl
+
+// CHECK: hl.func @same
+// CHECK: hl.func @main
+// CHECK: ll.return
+
+// FILES: tower-level-1.mlirbc
+
+// RELOAD: symbol {{.*}} before {{.*}} after
+// RELOAD: main
+// RELOAD: total
+
+int same(int x);
+
+int main(void) {
+    int x = 1;
+    if (same(x))
+        return x;
+    return 0;
+}
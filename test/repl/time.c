@@ -0,0 +1,7 @@
+// RUN: printf "load %s\n time raise vast-hl-to-ll-cf\n profile raise vast-hl-to-ll-vars\n exit" | %vast-repl | %file-check %s
+// CHECK: vast-hl-to-ll-cf: {{.*}} ms, ops {{[0-9]+}} -> {{[0-9]+}}, memory {{[-+][0-9]+}} bytes
+// CHECK: vast-hl-to-ll-vars: {{.*}} ms, ops {{[0-9]+}} -> {{[0-9]+}}, memory {{[-+][0-9]+}} bytes
+// CHECK: Execution time report
+// REQUIRES: repl
+
+int main(void) { return 0; }
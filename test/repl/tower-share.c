@@ -0,0 +1,24 @@
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf\n show module\n diff 0 1\n exit" | %vast-repl | %file-check %s
+// CHECK: hl.struct "point"
+// CHECK: hl.func @same
+// CHECK: hl.func @main
+// CHECK: ll.return
+// CHECK: symbol {{.*}} before {{.*}} after
+// CHECK-NOT: point
+// CHECK-NOT: same
+// CHECK: main
+// CHECK-NOT: point
+// CHECK-NOT: same
+// CHECK: total
+// REQUIRES: repl
+
+struct point { int x, y; };
+
+int same(struct point *p);
+
+int main(void) {
+    struct point p = { 1, 2 };
+    if (same(&p))
+        return p.x;
+    return p.y;
+}
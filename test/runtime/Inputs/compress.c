@@ -0,0 +1,124 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// LZ77 compression with a hash chain of matches, as deflate does, followed by
+// decompression and a check of the round trip.
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+#define INPUT (1 << 17)
+#define WINDOW (1 << 15)
+#define HASH (1 << 14)
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define MAX_CHAIN 32
+
+static unsigned char input[INPUT];
+static unsigned char packed[INPUT * 2];
+static unsigned char output[INPUT];
+
+static int head[HASH];
+static int prev[WINDOW];
+
+static unsigned hash3(const unsigned char *p) {
+    return ((unsigned) p[0] << 10 ^ (unsigned) p[1] << 5 ^ p[2]) & (HASH - 1);
+}
+
+// Literals are a zero byte and the literal, matches are the length, ranging
+// from MIN_MATCH, and two bytes of the distance.
+static int compress(const unsigned char *in, int size, unsigned char *out) {
+    int pos = 0, written = 0;
+
+    for (int i = 0; i < HASH; ++i)
+        head[i] = -1;
+
+    while (pos < size) {
+        int best = 0, distance = 0;
+        if (pos + MIN_MATCH <= size) {
+            unsigned h = hash3(in + pos);
+            int chain = MAX_CHAIN;
+            for (int cand = head[h]; cand >= 0 && pos - cand < WINDOW && chain--; cand = prev[cand % WINDOW]) {
+                int len = 0, limit = size - pos < MAX_MATCH ? size - pos : MAX_MATCH;
+                while (len < limit && in[cand + len] == in[pos + len])
+                    ++len;
+                if (len > best) {
+                    best = len;
+                    distance = pos - cand;
+                }
+            }
+            prev[pos % WINDOW] = head[h];
+            head[h] = pos;
+        }
+
+        if (best >= MIN_MATCH) {
+            out[written++] = (unsigned char) (best - MIN_MATCH + 1);
+            out[written++] = (unsigned char) (distance >> 8);
+            out[written++] = (unsigned char) distance;
+            for (int i = 1; i < best; ++i) {
+                if (pos + i + MIN_MATCH <= size) {
+                    unsigned h = hash3(in + pos + i);
+                    prev[(pos + i) % WINDOW] = head[h];
+                    head[h] = pos + i;
+                }
+            }
+            pos += best;
+        } else {
+            out[written++] = 0;
+            out[written++] = in[pos++];
+        }
+    }
+
+    return written;
+}
+
+static int decompress(const unsigned char *in, int size, unsigned char *out) {
+    int pos = 0, written = 0;
+    while (pos < size) {
+        int tag = in[pos++];
+        if (tag == 0) {
+            out[written++] = in[pos++];
+            continue;
+        }
+
+        int len = tag + MIN_MATCH - 1;
+        int distance = in[pos] << 8 | in[pos + 1];
+        pos += 2;
+        for (int i = 0; i < len; ++i, ++written)
+            out[written] = out[written - distance];
+    }
+    return written;
+}
+
+int main(void) {
+    static const char *words[] = {
+        "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ",
+        "compression ", "of ", "text ", "with ", "repeated ", "words ", "\n"
+    };
+
+    unsigned state = 99;
+    for (int i = 0; i < INPUT;) {
+        state = state * 22695477u + 1u;
+        const char *word = words[(state >> 16) % 15];
+        for (int j = 0; word[j] && i < INPUT; ++j)
+            input[i++] = (unsigned char) word[j];
+    }
+
+    unsigned long checksum = 0;
+    for (int round = 0; round < 32 * SCALE; ++round) {
+        input[round] ^= (unsigned char) round;
+        int size = compress(input, INPUT, packed);
+        int restored = decompress(packed, size, output);
+        if (restored != INPUT || memcmp(input, output, INPUT) != 0) {
+            printf("round trip failed\n");
+            return 1;
+        }
+        checksum = checksum * 131 + (unsigned long) size;
+    }
+
+    printf("%lu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// FNV-1a and murmur-like hashing into an open addressing table.
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+#define SLOTS (1 << 15)
+
+struct entry {
+    unsigned long key;
+    unsigned long value;
+    int used;
+};
+
+static struct entry table[SLOTS];
+
+static unsigned long fnv1a(const unsigned char *data, int size) {
+    unsigned long hash = 14695981039346656037ul;
+    for (int i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ul;
+    }
+    return hash;
+}
+
+static unsigned long mix(unsigned long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdul;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ul;
+    x ^= x >> 33;
+    return x;
+}
+
+static void insert(unsigned long key, unsigned long value) {
+    unsigned long slot = mix(key) & (SLOTS - 1);
+    while (table[slot].used && table[slot].key != key)
+        slot = (slot + 1) & (SLOTS - 1);
+    table[slot].key = key;
+    table[slot].value += value;
+    table[slot].used = 1;
+}
+
+static unsigned long lookup(unsigned long key) {
+    unsigned long slot = mix(key) & (SLOTS - 1);
+    while (table[slot].used) {
+        if (table[slot].key == key)
+            return table[slot].value;
+        slot = (slot + 1) & (SLOTS - 1);
+    }
+    return 0;
+}
+
+int main(void) {
+    unsigned char buffer[64];
+    unsigned long checksum = 0;
+
+    for (int round = 0; round < 64 * SCALE; ++round) {
+        memset(table, 0, sizeof(table));
+        for (int i = 0; i < SLOTS / 2; ++i) {
+            for (int j = 0; j < (int) sizeof(buffer); ++j)
+                buffer[j] = (unsigned char) (i * 7 + j * 13 + round);
+            insert(fnv1a(buffer, sizeof(buffer)), (unsigned long) i);
+        }
+        for (int i = 0; i < SLOTS; ++i)
+            checksum += lookup(mix((unsigned long) i) ^ (unsigned long) round);
+        for (int i = 0; i < SLOTS; i += 31)
+            checksum = checksum * 33 + table[i].key;
+    }
+
+    printf("%lu\n", checksum);
+    return 0;
+}
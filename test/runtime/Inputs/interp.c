@@ -0,0 +1,82 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// A stack machine interpreter dispatched by a switch, running a program that
+// sums the lengths of the collatz sequences of a range of numbers.
+
+#include <stdio.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+enum opcode {
+    op_push, op_load, op_store, op_add, op_sub, op_mul, op_div, op_mod,
+    op_lt, op_eq, op_jump, op_jump_if_zero, op_halt
+};
+
+struct instr {
+    enum opcode op;
+    long arg;
+};
+
+// Variables: 0 is n, 1 is x, 2 is the sum and 3 is the limit.
+//
+// for (n = 1; n < limit; ++n)
+//     for (x = n; x != 1; ++sum)
+//         x = x % 2 ? 3 * x + 1 : x / 2;
+static const struct instr program[] = {
+    /*  0 */ { op_push, 1 }, { op_store, 0 },
+    /*  2 */ { op_load, 0 }, { op_load, 3 }, { op_lt, 0 }, { op_jump_if_zero, 37 },
+    /*  6 */ { op_load, 0 }, { op_store, 1 },
+    /*  8 */ { op_load, 1 }, { op_push, 1 }, { op_eq, 0 }, { op_jump_if_zero, 13 },
+    /* 12 */ { op_jump, 32 },
+    /* 13 */ { op_load, 1 }, { op_push, 2 }, { op_mod, 0 }, { op_jump_if_zero, 23 },
+    /* 17 */ { op_load, 1 }, { op_push, 3 }, { op_mul, 0 }, { op_push, 1 }, { op_add, 0 },
+    /* 22 */ { op_jump, 26 },
+    /* 23 */ { op_load, 1 }, { op_push, 2 }, { op_div, 0 },
+    /* 26 */ { op_store, 1 },
+    /* 27 */ { op_load, 2 }, { op_push, 1 }, { op_add, 0 }, { op_store, 2 },
+    /* 31 */ { op_jump, 8 },
+    /* 32 */ { op_load, 0 }, { op_push, 1 }, { op_add, 0 }, { op_store, 0 },
+    /* 36 */ { op_jump, 2 },
+    /* 37 */ { op_halt, 0 },
+};
+
+static long run(const struct instr *code, long *vars) {
+    long stack[16];
+    int sp = 0;
+    int pc = 0;
+
+    for (;;) {
+        const struct instr *in = &code[pc++];
+        switch (in->op) {
+            case op_push:  stack[sp++] = in->arg; break;
+            case op_load:  stack[sp++] = vars[in->arg]; break;
+            case op_store: vars[in->arg] = stack[--sp]; break;
+            case op_add:   --sp; stack[sp - 1] += stack[sp]; break;
+            case op_sub:   --sp; stack[sp - 1] -= stack[sp]; break;
+            case op_mul:   --sp; stack[sp - 1] *= stack[sp]; break;
+            case op_div:   --sp; stack[sp - 1] /= stack[sp]; break;
+            case op_mod:   --sp; stack[sp - 1] %= stack[sp]; break;
+            case op_lt:    --sp; stack[sp - 1] = stack[sp - 1] < stack[sp]; break;
+            case op_eq:    --sp; stack[sp - 1] = stack[sp - 1] == stack[sp]; break;
+            case op_jump:  pc = (int) in->arg; break;
+            case op_jump_if_zero:
+                if (stack[--sp] == 0)
+                    pc = (int) in->arg;
+                break;
+            case op_halt:  return vars[2];
+        }
+    }
+}
+
+int main(void) {
+    long checksum = 0;
+    for (int round = 0; round < SCALE; ++round) {
+        long vars[4] = { 0, 0, 0, 30000 + round };
+        checksum += run(program, vars);
+    }
+
+    printf("%ld\n", checksum);
+    return 0;
+}
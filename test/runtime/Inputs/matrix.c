@@ -0,0 +1,66 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// Dense matrix multiplication, transposition and a stencil.
+
+#include <stdio.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+#define N 192
+
+static double a[N][N], b[N][N], c[N][N];
+
+static void init(void) {
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            a[i][j] = (double) ((i * j) % 7) / 7.0;
+            b[i][j] = (double) ((i + 2 * j) % 5) / 5.0;
+        }
+    }
+}
+
+static void multiply(void) {
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j)
+            c[i][j] = 0.0;
+        for (int k = 0; k < N; ++k) {
+            double aik = a[i][k];
+            for (int j = 0; j < N; ++j)
+                c[i][j] += aik * b[k][j];
+        }
+    }
+}
+
+static void transpose(double m[N][N]) {
+    for (int i = 0; i < N; ++i) {
+        for (int j = i + 1; j < N; ++j) {
+            double t = m[i][j];
+            m[i][j] = m[j][i];
+            m[j][i] = t;
+        }
+    }
+}
+
+static void stencil(void) {
+    for (int i = 1; i < N - 1; ++i)
+        for (int j = 1; j < N - 1; ++j)
+            a[i][j] = 0.2 * (c[i][j] + c[i - 1][j] + c[i + 1][j] + c[i][j - 1] + c[i][j + 1]) / N;
+}
+
+int main(void) {
+    double checksum = 0.0;
+
+    init();
+    for (int round = 0; round < 40 * SCALE; ++round) {
+        multiply();
+        transpose(b);
+        stencil();
+        for (int i = 0; i < N; ++i)
+            checksum += c[i][(i * 5) % N];
+    }
+
+    printf("%.3f\n", checksum);
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// Naive, Knuth-Morris-Pratt and Boyer-Moore-Horspool string search.
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+#define TEXT (1 << 18)
+
+static char text[TEXT + 1];
+
+static int naive(const char *hay, int n, const char *needle, int m) {
+    int count = 0;
+    for (int i = 0; i + m <= n; ++i) {
+        int j = 0;
+        while (j < m && hay[i + j] == needle[j])
+            ++j;
+        count += j == m;
+    }
+    return count;
+}
+
+static int kmp(const char *hay, int n, const char *needle, int m) {
+    int fail[64];
+    fail[0] = 0;
+    for (int i = 1, k = 0; i < m; ++i) {
+        while (k > 0 && needle[i] != needle[k])
+            k = fail[k - 1];
+        if (needle[i] == needle[k])
+            ++k;
+        fail[i] = k;
+    }
+
+    int count = 0;
+    for (int i = 0, k = 0; i < n; ++i) {
+        while (k > 0 && hay[i] != needle[k])
+            k = fail[k - 1];
+        if (hay[i] == needle[k])
+            ++k;
+        if (k == m) {
+            ++count;
+            k = fail[k - 1];
+        }
+    }
+    return count;
+}
+
+static int horspool(const char *hay, int n, const char *needle, int m) {
+    int shift[256];
+    for (int i = 0; i < 256; ++i)
+        shift[i] = m;
+    for (int i = 0; i < m - 1; ++i)
+        shift[(unsigned char) needle[i]] = m - 1 - i;
+
+    int count = 0;
+    for (int i = 0; i + m <= n; i += shift[(unsigned char) hay[i + m - 1]])
+        count += memcmp(hay + i, needle, (size_t) m) == 0;
+    return count;
+}
+
+int main(void) {
+    static const char *needles[] = { "abcab", "aaaab", "cabbac", "bcabcabca", "ccccc" };
+    unsigned long checksum = 0;
+
+    unsigned state = 7;
+    for (int i = 0; i < TEXT; ++i) {
+        state = state * 1664525u + 1013904223u;
+        text[i] = (char) ('a' + (state >> 24) % 3);
+    }
+
+    for (int round = 0; round < 4 * SCALE; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            int m = (int) strlen(needles[i]);
+            checksum = checksum * 7 + (unsigned long) naive(text, TEXT, needles[i], m);
+            checksum = checksum * 7 + (unsigned long) kmp(text, TEXT, needles[i], m);
+            checksum = checksum * 7 + (unsigned long) horspool(text, TEXT, needles[i], m);
+        }
+    }
+
+    printf("%lu\n", checksum);
+    return 0;
+}
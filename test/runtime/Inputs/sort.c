@@ -0,0 +1,87 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+// Quicksort and merge sort of pseudo-random integers.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef SCALE
+#define SCALE 1
+#endif
+
+#define COUNT (1 << 16)
+
+static unsigned state = 12345;
+
+static unsigned next(void) {
+    state = state * 1103515245u + 12345u;
+    return state >> 8;
+}
+
+static void swap(unsigned *a, unsigned *b) {
+    unsigned t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static void quicksort(unsigned *data, int lo, int hi) {
+    while (lo < hi) {
+        unsigned pivot = data[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (data[i] < pivot)
+                ++i;
+            while (data[j] > pivot)
+                --j;
+            if (i <= j)
+                swap(&data[i++], &data[j--]);
+        }
+        if (j - lo < hi - i) {
+            quicksort(data, lo, j);
+            lo = i;
+        } else {
+            quicksort(data, i, hi);
+            hi = j;
+        }
+    }
+}
+
+static void merge_sort(unsigned *data, unsigned *tmp, int n) {
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            int i = lo, j = mid, k = lo;
+            while (i < mid && j < hi)
+                tmp[k++] = data[i] <= data[j] ? data[i++] : data[j++];
+            while (i < mid)
+                tmp[k++] = data[i++];
+            while (j < hi)
+                tmp[k++] = data[j++];
+        }
+        for (int i = 0; i < n; ++i)
+            data[i] = tmp[i];
+    }
+}
+
+int main(void) {
+    unsigned *data = malloc(COUNT * sizeof(unsigned));
+    unsigned *tmp = malloc(COUNT * sizeof(unsigned));
+    unsigned long checksum = 0;
+
+    for (int round = 0; round < 20 * SCALE; ++round) {
+        for (int i = 0; i < COUNT; ++i)
+            data[i] = next();
+        if (round % 2)
+            quicksort(data, 0, COUNT - 1);
+        else
+            merge_sort(data, tmp, COUNT);
+        for (int i = 0; i < COUNT; i += 97)
+            checksum = checksum * 31 + data[i];
+    }
+
+    printf("%lu\n", checksum);
+    free(data);
+    free(tmp);
+    return 0;
+}
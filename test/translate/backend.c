@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o %t.hl.mlir
+// RUN: %vast-translate --emit=llvm %t.hl.mlir -o - | %file-check %s -check-prefix=LLVM
+// RUN: %vast-translate --emit=asm %t.hl.mlir -o - | %file-check %s -check-prefix=ASM
+// RUN: %vast-translate %t.hl.mlir -o %t.o && test -s %t.o
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=llvm %s -o %t.llvm.mlir
+// RUN: %vast-translate --emit=llvm %t.llvm.mlir -o - | %file-check %s -check-prefix=LLVM
+// RUN: %vast-translate -O2 --emit=llvm %t.hl.mlir -o - | %file-check %s -check-prefix=OPT
+
+// LLVM: target triple = "x86_64-unknown-linux-gnu"
+// LLVM: define {{.*}}i32 @square(i32
+
+// ASM: square:
+
+// OPT: define {{.*}}i32 @square(i32
+// OPT: mul nsw i32
+
+int square(int x) {
+    return x * x;
+}
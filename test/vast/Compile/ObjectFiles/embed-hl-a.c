@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-obj -vast-embed-hl %s -o %t.o
+// RUN: %vast-link %t.o | %file-check %s -check-prefix=LINK
+// RUN: %vast-query --show-symbols=functions %t.o | %file-check %s -check-prefix=QUERY
+
+// LINK: hl.func @embedded
+// LINK: hl.add
+
+// QUERY: embedded
+int embedded(int a, int b) {
+    return a + b;
+}
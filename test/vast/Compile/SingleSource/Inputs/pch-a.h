@@ -0,0 +1,9 @@
+typedef unsigned long size_type;
+
+struct point { int x, y; };
+
+enum color { red, green, blue };
+
+static inline int norm1(struct point p) {
+    return (p.x < 0 ? -p.x : p.x) + (p.y < 0 ? -p.y : p.y);
+}
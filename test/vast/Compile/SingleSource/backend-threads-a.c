@@ -0,0 +1,18 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-obj -vast-backend-threads=4 %s -o %t.o
+// RUN: objdump -t %t.o | %file-check %s
+// REQUIRES: data-layout-lowering
+
+static int twice(int x) { return 2 * x; }
+
+int foo(int x) { return twice(x) + 1; }
+
+int bar(int x) { return twice(x) - 1; }
+
+int baz(void) { return foo(1) + bar(2); }
+
+// CHECK-DAG: F .text{{.*}} foo
+// CHECK-DAG: F .text{{.*}} bar
+// CHECK-DAG: F .text{{.*}} baz
+
+// Local symbols stay local in the combined object.
+// CHECK-DAG: l {{.*}} F .text{{.*}} twice
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t.cache
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache %s -o %t.first.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache %s -o %t.second.mlir
+// RUN: diff %t.first.mlir %t.second.mlir
+// RUN: find %t.cache -type f | wc -l | %file-check %s -check-prefix=ONE
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-cache-dir=%t.cache %s -o %t.llvm.mlir
+// RUN: find %t.cache -type f | wc -l | %file-check %s -check-prefix=TWO
+// RUN: %file-check %s -input-file=%t.second.mlir
+
+// ONE: 1
+// TWO: 2
+
+// CHECK: hl.func @foo
+int foo(int x) { return x + 1; }
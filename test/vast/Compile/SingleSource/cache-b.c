@@ -0,0 +1,16 @@
+// RUN: rm -rf %t.cache
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-remote-cache=http://127.0.0.1:1/vast %s -o %t.remote.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache -vast-remote-cache=http://127.0.0.1:1/vast %s -o %t.first.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache %s -o %t.second.mlir
+// RUN: diff %t.remote.mlir %t.first.mlir
+// RUN: diff %t.first.mlir %t.second.mlir
+// RUN: find %t.cache -type f | wc -l | %file-check %s -check-prefix=ONE
+// RUN: %file-check %s -input-file=%t.second.mlir
+
+// An unreachable remote cache is a miss, the job is compiled locally and
+// the key does not depend on the locations of the caches.
+
+// ONE: 1
+
+// CHECK: hl.func @foo
+int foo(int x) { return x + 1; }
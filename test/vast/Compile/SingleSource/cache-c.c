@@ -0,0 +1,17 @@
+// RUN: rm -rf %t.cache
+// RUN: cp %s %t.c
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache %t.c -o %t.packed.mlir
+// RUN: sed -i 's/pack(1)/pack(4)/' %t.c
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t.cache %t.c -o %t.aligned.mlir
+// RUN: find %t.cache -type f | wc -l | %file-check %s -check-prefix=TWO
+
+// Pragmas handled by the parser leave no tokens, yet they are a part of the
+// key, the second job misses the cache.
+
+// TWO: 2
+
+#pragma pack(1)
+struct s { char c; int i; };
+#pragma pack()
+
+unsigned long size(void) { return sizeof(struct s); }
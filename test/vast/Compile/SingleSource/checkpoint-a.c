@@ -0,0 +1,8 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-stop-after=simplify -vast-emit-mlir-bytecode %s -o %t.mlirbc
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-start-from=%t.mlirbc %s -o - | %file-check %s -check-prefix=MLIR
+// RUN: %vast-cc1 -vast-emit-llvm -vast-start-from=%t.mlirbc %s -o - | %file-check %s -check-prefix=LLVM
+
+// MLIR-NOT: vast.checkpoint
+// MLIR: llvm.func @add
+// LLVM: define {{.*}} i32 @add
+int add(int a, int b) { return a + b; }
@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%S", "file": "database-a.c", "command": "cc -DVALUE=2 -c database-a.c -o database-a.o"}]' > %t/compile_commands.json
+// RUN: %vast-front -p %t/compile_commands.json --output-dir=%t/out --filter=none
+// RUN: not ls %t/out/database-a.mlir
+// RUN: %vast-front -p %t/compile_commands.json --output-dir=%t/out --jobs=2 -- -vast-emit-mlir=hl
+// RUN: %file-check %s -input-file=%t/out/database-a.mlir
+
+// CHECK: hl.func @foo
+// CHECK: hl.const #core.integer<2>
+int foo(void) { return VALUE; }
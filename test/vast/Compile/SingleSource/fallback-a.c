@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-fallback-max-ops=60 -Rpass-analysis=clang-fallback %s -o - 2> %t.remarks | %file-check %s
+// RUN: %file-check --input-file=%t.remarks %s -check-prefix=REMARK
+// RUN: %vast-front -vast-fallback-max-ops=60 %s -o %t && %t
+
+// The counter is shared by the function of vast and the one of clang.
+// CHECK-DAG: @counter.vast.fallback = internal global i32
+static int counter;
+
+// CHECK-DAG: define {{.*}}i32 @count(
+int count(void) { return ++counter; }
+
+// REMARK: fallback-a.c:[[@LINE+2]]:{{[0-9]+}}: remark: function is compiled by clang, it has more operations than the budget [-Rpass-analysis=clang-fallback]
+// CHECK-DAG: define internal {{.*}}i32 @checksum.vast.fallback(
+static int checksum(const int *values, int size) {
+    int sum = 0;
+    for (int i = 0; i < size; ++i) {
+        sum = sum * 31 + values[i];
+        if (sum > 1000000)
+            sum %= 1000003;
+        counter += values[i] & 1;
+    }
+    return sum;
+}
+
+int main(void) {
+    int values[] = { 1, 2, 3, 4, 5 };
+    int sum = checksum(values, 5);
+    count();
+    return sum == 986115 && counter == 4 ? 0 : 1;
+}
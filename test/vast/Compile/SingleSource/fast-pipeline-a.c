@@ -0,0 +1,22 @@
+// RUN: %vast-front -vast-pipeline=fast -o %t %s && (%t; test $? -eq 42)
+
+struct counter
+{
+    int value;
+};
+
+static inline __attribute__((always_inline)) void bump( struct counter *c, int by )
+{
+    c->value += by;
+}
+
+int main()
+{
+    struct counter c = { 0 };
+    for ( int i = 0; i < 6; ++i ) {
+        if ( i % 2 )
+            continue;
+        bump( &c, 14 );
+    }
+    return c.value;
+}
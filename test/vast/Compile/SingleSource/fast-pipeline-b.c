@@ -0,0 +1,24 @@
+// RUN: %vast-front -vast-pipeline=fast -o %t %s && (%t; test $? -eq 42)
+
+// Code after a terminator is removed before the control flow is lowered.
+int pick(int x)
+{
+    switch ( x ) {
+        case 1: return 30; break;
+        case 2: return 10; x++;
+        default: break;
+    }
+
+    for ( ;; ) {
+        break;
+        x++;
+    }
+
+    return 2;
+    x++;
+}
+
+int main()
+{
+    return pick(1) + pick(2) + pick(3);
+}
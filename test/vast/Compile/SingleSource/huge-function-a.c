@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// A generated function of 4096 sequential conditionals on one variable, the
+// lowering is to stay linear in the size of the function.
+
+#define STEP(n) if (s == n) { acc += n; s = n + 1; }
+#define STEP4(n) STEP(n) STEP(n + 1) STEP(n + 2) STEP(n + 3)
+#define STEP16(n) STEP4(n) STEP4(n + 4) STEP4(n + 8) STEP4(n + 12)
+#define STEP64(n) STEP16(n) STEP16(n + 16) STEP16(n + 32) STEP16(n + 48)
+#define STEP256(n) STEP64(n) STEP64(n + 64) STEP64(n + 128) STEP64(n + 192)
+#define STEP1024(n) STEP256(n) STEP256(n + 256) STEP256(n + 512) STEP256(n + 768)
+
+// CHECK-LABEL: define {{.*}} @machine
+// CHECK-COUNT-4096: icmp eq i32
+// CHECK: ret i32
+int machine(int s) {
+    int acc = 0;
+    STEP1024(0) STEP1024(1024) STEP1024(2048) STEP1024(3072)
+    return acc;
+}
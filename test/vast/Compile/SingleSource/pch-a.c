@@ -0,0 +1,19 @@
+// RUN: rm -rf %t.cache
+// RUN: %vast-cc1 -x c-header -emit-pch %S/Inputs/pch-a.h -o %t.pch
+// RUN: %vast-cc1 -include-pch %t.pch -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -include-pch %t.pch -vast-emit-mlir=hl -vast-hl-header-cache=%t.cache %s -o %t.first.mlir
+// RUN: find %t.cache -name '*.mlirbc' | wc -l | %file-check %s -check-prefix=ENTRIES
+// RUN: %vast-cc1 -include-pch %t.pch -vast-emit-mlir=hl -vast-hl-header-cache=%t.cache %s -o %t.second.mlir
+// RUN: %file-check %s -input-file=%t.second.mlir
+
+// ENTRIES: 1
+
+// CHECK-DAG: hl.typedef "size_type"
+// CHECK-DAG: hl.struct "point"
+// CHECK-DAG: hl.enum "color"
+// CHECK-DAG: hl.func @norm1
+// CHECK-DAG: hl.func @distance
+
+size_type distance(struct point p, enum color c) {
+    return c == green ? 0 : norm1(p);
+}
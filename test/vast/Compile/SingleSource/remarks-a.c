@@ -0,0 +1,42 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -O1 -vast-emit-llvm -Rpass='vast-.*' -Rpass-missed=vast-hl-dce %s -o /dev/null 2>&1 | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -O1 -vast-emit-llvm -opt-record-file %t.yaml %s -o /dev/null
+// RUN: %file-check --input-file=%t.yaml %s -check-prefix=YAML
+
+int f(void);
+
+// CHECK-DAG: remarks-a.c:[[@LINE+4]]:{{[0-9]+}}: remark: condition is always false, the then branch is removed [-Rpass=vast-hl-dce]
+// YAML-DAG: Pass: vast-hl-dce
+// YAML-DAG: Name: ConstantCondition
+int disabled(void) {
+    if (0) {
+        f();
+    }
+    return 0;
+}
+
+// CHECK-DAG: remarks-a.c:[[@LINE+3]]:{{[0-9]+}}: remark: code after hl.return is removed [-Rpass=vast-hl-dce]
+int unreachable(void) {
+    return f();
+    f();
+}
+
+// CHECK-DAG: remarks-a.c:[[@LINE+4]]:{{[0-9]+}}: remark: hl.if of a constant condition is kept, its regions have jump targets [-Rpass-missed=vast-hl-dce]
+// YAML-DAG: --- !Missed
+int labels(void) {
+    goto inside;
+    if (0) {
+    inside:
+        f();
+    }
+    return 0;
+}
+
+// CHECK-DAG: remarks-a.c:[[@LINE+3]]:{{[0-9]+}}: remark: switch of 2 cases is lowered to ll.switch [-Rpass=vast-hl-to-ll-cf]
+// YAML-DAG: Function: dispatch
+int dispatch(int x) {
+    switch (x) {
+        case 1: return 1;
+        case 2: return 4;
+        default: return 0;
+    }
+}
@@ -0,0 +1,18 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-retarget=aarch64-unknown-linux-gnu %s -o %t.ll
+// RUN: %file-check %s --check-prefix=VARIANT < %t.aarch64-unknown-linux-gnu.ll
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-retarget=aarch64-unknown-linux-gnu -DARCH %s -o %t.arch.ll 2>&1 | %file-check %s --check-prefix=FALLBACK
+// RUN: %file-check %s --check-prefix=VARIANT < %t.arch.aarch64-unknown-linux-gnu.ll
+// REQUIRES: data-layout-lowering
+
+#ifdef ARCH
+#ifdef __x86_64__
+int arch(void) { return 1; }
+#endif
+#endif
+
+int add(int a, int b) { return a + b; }
+
+// VARIANT: target triple = "aarch64-unknown-linux-gnu"
+// VARIANT: define {{.*}} @add
+
+// FALLBACK: remark: {{.*}} is compiled again for aarch64-unknown-linux-gnu, it refers to the predefined macro __x86_64__
@@ -0,0 +1,27 @@
+// REQUIRES: shell
+// RUN: mktemp -u /tmp/vast-front.XXXXXX > %t.sock
+// RUN: %vast-front --serve=$(cat %t.sock) > %t.log 2>&1 & echo $! > %t.pid
+// RUN: for i in $(seq 100); do test -S $(cat %t.sock) && break; sleep 0.1; done
+// RUN: %vast-front --connect=$(cat %t.sock) -vast-emit-mlir=hl %s -o - > %t.mlir; echo "ok: $?" > %t.status
+// RUN: %vast-front --connect=$(cat %t.sock) -vast-emit-mlir=hl -DBROKEN %s -o - 2> %t.err; echo "broken: $?" >> %t.status
+// RUN: kill $(cat %t.pid); rm -f $(cat %t.sock)
+// RUN: %file-check --input-file=%t.mlir %s
+// RUN: %file-check --input-file=%t.status %s -check-prefix=STATUS
+// RUN: %file-check --input-file=%t.err %s -check-prefix=ERR
+
+// The jobs are checked after the server is stopped, so that a failed check
+// does not leave it running.
+
+// CHECK: hl.func @answer
+// CHECK: hl.return
+
+// STATUS: ok: 0
+// STATUS-NEXT: broken: 1
+
+// ERR: error: broken job
+
+#ifdef BROKEN
+#error broken job
+#endif
+
+int answer(void) { return 42; }
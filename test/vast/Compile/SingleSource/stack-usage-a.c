@@ -0,0 +1,36 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-stack-usage=%t.json %s -o %t.ll
+// RUN: %file-check --input-file=%t.json %s
+// REQUIRES: data-layout-lowering
+
+// CHECK: "name": "leaf",
+// CHECK: "largest_slot": {
+// CHECK-NEXT: "size": 256
+// CHECK: "worst_case": {{[0-9]+}},
+// CHECK-NEXT: "worst_case_path": [
+// CHECK-NEXT: "leaf"
+// CHECK-NEXT: ],
+// CHECK-NEXT: "incomplete": false
+int leaf(int i)
+{
+    char buffer[256];
+    buffer[i] = (char)i;
+    return buffer[0];
+}
+
+// CHECK: "name": "parse",
+// CHECK: "callees": [
+// CHECK-NEXT: "leaf"
+// CHECK: "worst_case_path": [
+// CHECK-NEXT: "parse",
+// CHECK-NEXT: "leaf"
+int parse(int i) { return leaf(i) + 1; }
+
+// CHECK: "name": "rec",
+// CHECK: "worst_case": null,
+int rec(int n) { return n ? rec(n - 1) + parse(n) : 0; }
+
+// CHECK: "name": "main",
+// CHECK: "worst_case": null,
+// CHECK: "incomplete": true
+extern int ext(int);
+int main(void) { return rec(3) + ext(1); }
@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -flto=thin -emit-llvm-bc %s -o %t.bc
+// RUN: %llvm-dis %t.bc -o - | %file-check %s -check-prefix=THIN
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -flto -emit-llvm-bc %s -o %t.full.bc
+// RUN: %llvm-dis %t.full.bc -o - | %file-check %s -check-prefix=FULL
+
+// THIN: define {{.*}} @add
+// THIN: "EnableSplitLTOUnit"
+// THIN: ^0 = module:
+// THIN: gv: (name: "add"
+
+// FULL: define {{.*}} @add
+// FULL: !"ThinLTO", i32 0
+int add(int a, int b) {
+    return a + b;
+}
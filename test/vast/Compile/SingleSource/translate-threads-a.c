@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-translate-threads=3 %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-translate-threads=3 %s -o %t.again.ll
+// RUN: diff %t.ll %t.again.ll
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -debug-info-kind=line-tables-only -vast-translate-threads=3 %s -o %t.g.ll
+// RUN: %file-check --input-file=%t.g.ll %s -check-prefix=DEBUG
+
+// Debug info is translated serially, into a single compile unit.
+// DEBUG-COUNT-1: distinct !DICompileUnit(
+// DEBUG-NOT: distinct !DICompileUnit(
+
+// CHECK: @counter = internal global i32 0
+// CHECK: @total = global i32 0
+
+// CHECK: define internal i32 @twice
+// CHECK: define i32 @foo
+// CHECK: call i32 @twice
+// CHECK: define i32 @bar
+// CHECK: load i32, ptr @counter
+// CHECK: define i32 @baz
+// CHECK-NOT: define
+
+static int counter = 0;
+int total = 0;
+
+static int twice(int x) { return 2 * x; }
+
+int foo(int x) { return twice(x) + 1; }
+
+int bar(int x) { counter += x; return counter; }
+
+int baz(void) { total = foo(1) + bar(2); return total; }
@@ -0,0 +1,28 @@
+// RUN: %vast-front --target=aarch64-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-emit-abi | %file-check %s -check-prefix=ABI
+
+struct point
+{
+    float x;
+    float y;
+};
+
+struct triple
+{
+    int a;
+    int b;
+    int c;
+};
+
+// Homogeneous aggregates take a SIMD register per member.
+// ABI: abi.func {{.*}}(%arg0: !hl.lvalue<f32>, %arg1: !hl.lvalue<f32>) -> f32
+float length2( struct point p )
+{
+    return p.x * p.x + p.y * p.y;
+}
+
+// Other composites up to 16 bytes take general registers.
+// ABI: abi.func {{.*}}(%arg0: !hl.lvalue<i64>, %arg1: !hl.lvalue<i64>) -> si32
+int total( struct triple t )
+{
+    return t.a + t.b + t.c;
+}
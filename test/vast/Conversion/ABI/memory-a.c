@@ -0,0 +1,33 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-emit-abi --vast-lower-abi="aggregates-through-memory=1" | %file-check %s
+
+struct pair
+{
+    long x;
+    int y;
+};
+
+// CHECK:      hl.func @get {{.*}} (%arg0: !hl.lvalue<i64>, %arg1: !hl.lvalue<i32>)
+// CHECK:        [[V:%[0-9]+]] = ll.uninitialized_var : !hl.lvalue<!hl.elaborated<!hl.record<"pair">>>
+// CHECK:        hl.addressof [[V]]
+// CHECK:        hl.cstyle_cast {{.*}} BitCast : {{.*}} -> !hl.ptr<i64>
+// CHECK:        hl.assign
+// CHECK:        hl.subscript
+// CHECK:        hl.cstyle_cast {{.*}} BitCast : {{.*}} -> !hl.ptr<i32>
+// CHECK:        hl.assign
+// CHECK-NOT:    ll.extract
+int get( struct pair p )
+{
+    return p.y;
+}
+
+int forward( struct pair p );
+
+// The parameter is only forwarded, its incoming pieces are passed on.
+// CHECK:      hl.func @pass {{.*}} (%arg0: !hl.lvalue<i64>, %arg1: !hl.lvalue<i32>)
+// CHECK:        [[X:%[0-9]+]] = hl.implicit_cast %arg0 LValueToRValue : !hl.lvalue<i64> -> i64
+// CHECK:        [[Y:%[0-9]+]] = hl.implicit_cast %arg1 LValueToRValue : !hl.lvalue<i32> -> i32
+// CHECK:        hl.call @forward([[X]], [[Y]])
+int pass( struct pair p )
+{
+    return forward( p );
+}
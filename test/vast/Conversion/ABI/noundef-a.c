@@ -0,0 +1,9 @@
+// RUN: %vast-front --target=x86_64-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-emit-abi | %file-check %s -check-prefix=ABI
+// RUN: %vast-front --target=x86_64-linux-gnu -vast-emit-llvm -vast-pipeline=with-abi %s -o - | %file-check %s
+
+// The record is passed as an integer, which may hold undefined padding.
+struct padded { char c; int i; };
+
+// ABI: abi.func {{.*}}pass{{.*}}(%arg0: !hl.lvalue<i64> {abi.coerced}, %arg1: !hl.lvalue<{{s?}}i32>)
+// CHECK: define {{.*}}i32 @pass(i64 %{{[0-9]+}}, i32 noundef %{{[0-9]+}})
+int pass(struct padded p, int x) { return p.i + x; }
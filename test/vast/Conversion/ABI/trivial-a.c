@@ -0,0 +1,24 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-emit-abi | %file-check %s -check-prefix=ABI
+
+struct wrapped
+{
+    int x;
+};
+
+// Scalars are passed as they are, neither the function nor its calls are wrapped.
+// ABI:     hl.func @add {{.*}}(%arg0: !hl.lvalue<si32>, %arg1: !hl.lvalue<si32>) -> si32
+// ABI-NOT: abi.prologue
+// ABI-NOT: abi.epilogue
+int add( int a, int b )
+{
+    return a + b;
+}
+
+// ABI:     abi.func @vast.abifn
+// ABI:     abi.prologue
+int fn( struct wrapped w )
+{
+    // ABI-NOT: abi.call_exec
+    // ABI:     hl.call @add
+    return add( w.x, 1 );
+}
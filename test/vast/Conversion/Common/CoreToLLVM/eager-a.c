@@ -0,0 +1,48 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-lazy-regions --vast-irs-to-llvm --vast-core-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @in_range
+// CHECK-NOT: llvm.cond_br
+// CHECK: [[L:%[0-9]+]] = llvm.icmp "ne"
+// CHECK: [[R:%[0-9]+]] = llvm.icmp "ne"
+// CHECK: [[F:%[0-9]+]] = llvm.mlir.constant(false) : i1
+// CHECK: llvm.select [[L]], [[R]], [[F]] : i1, i1
+int in_range(int v, int lo, int hi) {
+    int res = lo <= v && v < hi;
+    return res;
+}
+
+// CHECK-LABEL: llvm.func @either
+// CHECK-NOT: llvm.cond_br
+// CHECK: [[T:%[0-9]+]] = llvm.mlir.constant(true) : i1
+// CHECK: llvm.select {{%[0-9]+}}, [[T]], {{%[0-9]+}} : i1, i1
+int either(int a, int b) {
+    int res = a || b;
+    return res;
+}
+
+// The right side may be poison when the left one is false.
+// CHECK-LABEL: llvm.func @next_above
+// CHECK-NOT: llvm.and
+// CHECK: llvm.select {{.*}} : i1, i1
+int next_above(int n, int k) {
+    int res = n < 2147483647 && n + 1 > k;
+    return res;
+}
+
+// CHECK-LABEL: llvm.func @max
+// CHECK-NOT: llvm.cond_br
+// CHECK: llvm.select {{.*}} : i1, i32
+int max(int a, int b) {
+    int res = a > b ? a : b;
+    return res;
+}
+
+int side(int);
+
+// CHECK-LABEL: llvm.func @guarded
+// CHECK: llvm.cond_br
+// CHECK: llvm.call @side
+int guarded(int a) {
+    int res = a ? side(a) : 0;
+    return res;
+}
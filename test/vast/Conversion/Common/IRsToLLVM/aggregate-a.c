@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+struct big { int data[8]; };
+struct small { int a, b; };
+
+// CHECK-LABEL: llvm.func @copy
+// CHECK: [[LEN:%[0-9]+]] = llvm.mlir.constant(32 : i64) : i64
+// CHECK: "llvm.intr.memcpy"({{%[0-9]+}}, {{%[0-9]+}}, [[LEN]])
+void copy(struct big *dst, struct big *src) { *dst = *src; }
+
+// CHECK-LABEL: llvm.func @init_copy
+// CHECK: "llvm.intr.memcpy"
+void init_copy(struct big *src) { struct big b = *src; }
+
+// CHECK-LABEL: llvm.func @small_copy
+// CHECK-NOT: llvm.intr.memcpy
+// CHECK: llvm.store {{%[0-9]+}}, {{%[0-9]+}} : !llvm.ptr<struct<"small", (i32, i32)>>
+void small_copy(struct small *dst, struct small *src) { *dst = *src; }
+
+// CHECK-LABEL: llvm.func @partial
+// CHECK: [[LEN:%[0-9]+]] = llvm.mlir.constant(40 : i64) : i64
+// CHECK: "llvm.intr.memset"({{%[0-9]+}}, {{%[0-9]+}}, [[LEN]])
+// CHECK: llvm.getelementptr inbounds {{%[0-9]+}}[0, 0]
+// CHECK-NOT: llvm.getelementptr
+// CHECK: llvm.return
+void partial() { int x[10] = { 1 }; }
+
+// CHECK-LABEL: llvm.func @complete
+// CHECK-NOT: llvm.intr.memset
+// CHECK: llvm.return
+void complete() { int x[2] = { 1, 2 }; }
@@ -0,0 +1,23 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+struct __attribute__((aligned(64))) line { int data[4]; };
+
+// HL: hl.var @buffer {{.*}}hl.alignment = #hl.alignment<64>
+// CHECK: llvm.mlir.global internal @buffer() {alignment = 64 : i64}
+char buffer[128] __attribute__((aligned(64)));
+
+// HL-NOT: hl.var @plain {{.*}}hl.alignment
+int plain;
+
+// CHECK-LABEL: llvm.func @locals
+// CHECK: llvm.alloca {{%[0-9]+}} x i32 {alignment = 32 : i64}
+// CHECK: llvm.alloca {{%[0-9]+}} x !llvm.struct<"line", {{.*}}> {alignment = 64 : i64}
+// CHECK: llvm.store {{%[0-9]+}}, {{%[0-9]+}} {alignment = 32 : i64}
+// CHECK: llvm.load {{%[0-9]+}} {alignment = 32 : i64}
+int locals(int v) {
+    _Alignas(32) int x;
+    struct line l;
+    x = v;
+    return x;
+}
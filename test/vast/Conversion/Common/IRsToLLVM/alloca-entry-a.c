@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+int next(int);
+
+// CHECK-LABEL: llvm.func @loop
+// CHECK:   llvm.alloca {{.*}} x i32
+// CHECK:   llvm.alloca {{.*}} x i32
+// CHECK:   llvm.alloca {{.*}} x i32
+// CHECK:   llvm.br
+// CHECK-NOT: llvm.alloca
+// CHECK: llvm.return
+int loop(int n)
+{
+    int sum = 0;
+    for (int i = 0; i < n; ++i) {
+        int v = next(i);
+        sum += v;
+    }
+    return sum;
+}
@@ -2,6 +2,9 @@
 
 void count()
 {
-    // CHECK: llvm.store [[V4:%[0-9]+]], [[V10:%[0-9]+]] : !llvm.ptr<array<3 x i32>>
+    // CHECK: [[E0:%[0-9]+]] = llvm.getelementptr inbounds {{%[0-9]+}}[0, 0] : (!llvm.ptr<array<3 x i32>>) -> !llvm.ptr<i32>
+    // CHECK: llvm.store {{%[0-9]+}}, [[E0]] : !llvm.ptr<i32>
+    // CHECK: [[E2:%[0-9]+]] = llvm.getelementptr inbounds {{%[0-9]+}}[0, 2] : (!llvm.ptr<array<3 x i32>>) -> !llvm.ptr<i32>
+    // CHECK: llvm.store {{%[0-9]+}}, [[E2]] : !llvm.ptr<i32>
     int x[3] = { 112, 212, 4121 };
 }
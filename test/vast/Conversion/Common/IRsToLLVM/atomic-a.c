@@ -0,0 +1,49 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @load
+// CHECK: llvm.load {{%[0-9]+}} atomic seq_cst {alignment = 4 : i64}
+int load(int *p) {
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+// CHECK-LABEL: llvm.func @store
+// CHECK: llvm.store {{%[0-9]+}}, {{%[0-9]+}} atomic release {alignment = 4 : i64}
+void store(int *p, int v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+// CHECK-LABEL: llvm.func @fetch_add
+// CHECK: llvm.atomicrmw add {{%[0-9]+}}, {{%[0-9]+}} monotonic
+int fetch_add(int *p) {
+    return __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+
+// CHECK-LABEL: llvm.func @add_fetch
+// CHECK: [[OLD:%[0-9]+]] = llvm.atomicrmw add {{%[0-9]+}}, {{%[0-9]+}} monotonic
+// CHECK: llvm.add [[OLD]], {{%[0-9]+}} : i32
+int add_fetch(int *p) {
+    return __atomic_add_fetch(p, 1, __ATOMIC_RELAXED);
+}
+
+// The previous value is stored only if the exchange fails.
+// CHECK-LABEL: llvm.func @cas
+// CHECK: [[PAIR:%[0-9]+]] = llvm.cmpxchg weak {{%[0-9]+}}, {{%[0-9]+}}, {{%[0-9]+}} acq_rel acquire
+// CHECK: [[OLD:%[0-9]+]] = llvm.extractvalue [[PAIR]][0]
+// CHECK: [[OK:%[0-9]+]] = llvm.extractvalue [[PAIR]][1]
+// CHECK: llvm.cond_br [[OK]], ^[[REST:bb[0-9]+]], ^[[FAIL:bb[0-9]+]]
+// CHECK: ^[[FAIL]]:
+// CHECK:   llvm.store [[OLD]]
+// CHECK:   llvm.br ^[[REST]]
+_Bool cas(int *p, int *expected, int desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// CHECK-LABEL: llvm.func @fences
+// CHECK-NOT: llvm.fence monotonic
+// CHECK: llvm.fence acquire
+// CHECK: llvm.fence syncscope("singlethread") seq_cst
+void fences(void) {
+    __atomic_thread_fence(__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
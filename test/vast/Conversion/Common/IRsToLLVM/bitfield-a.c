@@ -0,0 +1,49 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-geps --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK: !llvm.struct<"hdr", (i8, i8, i8, array<1 x i8>)>
+struct hdr {
+    unsigned version : 4;
+    unsigned ihl : 4;
+    unsigned char tos;
+    int flags : 3;
+};
+
+// CHECK-LABEL: llvm.func @get_ihl
+// CHECK:   [[UNIT:%[0-9]+]] = llvm.load {{.*}} : !llvm.ptr<i8>
+// CHECK:   [[SHR:%[0-9]+]] = llvm.lshr [[UNIT]]
+// CHECK:   [[AND:%[0-9]+]] = llvm.and [[SHR]]
+// CHECK:   llvm.zext [[AND]] : i8 to i32
+unsigned get_ihl(struct hdr *h) { return h->ihl; }
+
+// CHECK-LABEL: llvm.func @get_flags
+// CHECK:   [[UNIT:%[0-9]+]] = llvm.load {{.*}} : !llvm.ptr<i8>
+// CHECK:   [[SHL:%[0-9]+]] = llvm.shl [[UNIT]]
+// CHECK:   [[SHR:%[0-9]+]] = llvm.ashr [[SHL]]
+// CHECK:   llvm.sext [[SHR]] : i8 to i32
+int get_flags(struct hdr *h) { return h->flags; }
+
+// Updates of fields in one storage unit are merged into a single store.
+// CHECK-LABEL: llvm.func @set
+// CHECK:       llvm.load {{.*}} : !llvm.ptr<i8>
+// CHECK-NOT:   llvm.load {{.*}} : !llvm.ptr<i8>
+// CHECK:       llvm.store {{.*}} : !llvm.ptr<i8>
+// CHECK-NOT:   llvm.store
+// CHECK:       llvm.return
+void set(struct hdr *h)
+{
+    h->version = 4;
+    h->ihl = 5;
+}
+
+// A unit wider than the alignment of the record is an array of bytes, an i64
+// would make the record 16 bytes aligned to 8.
+// CHECK: !llvm.struct<"quad", (array<8 x i8>, i32)>
+struct quad {
+    int a : 16, b : 16, c : 16, d : 16;
+    int e;
+};
+
+// CHECK-LABEL: llvm.func @get_c
+// CHECK:   llvm.bitcast {{.*}} : !llvm.ptr<array<8 x i8>> to !llvm.ptr<i64>
+// CHECK:   llvm.load {{.*}} {alignment = 4 : i64} : !llvm.ptr<i64>
+int get_c(struct quad *q) { return q->c; }
@@ -0,0 +1,29 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @copy
+// CHECK: "llvm.intr.memcpy"
+// CHECK: llvm.trunc {{%[0-9]+}} : i32 to i8
+// CHECK: "llvm.intr.memset"
+void copy(void *dst, const void *src, unsigned long n) {
+    __builtin_memcpy(dst, src, n);
+    __builtin_memset(dst, 0, n);
+}
+
+// CHECK-LABEL: llvm.func @bits
+// CHECK: llvm.intr.ctpop({{%[0-9]+}}) : (i32) -> i32
+// CHECK: "llvm.intr.ctlz"
+// CHECK: llvm.trunc {{%[0-9]+}} : i64 to i32
+// CHECK: llvm.intr.bswap({{%[0-9]+}}) : (i32) -> i32
+unsigned bits(unsigned x, unsigned long long ll) {
+    return __builtin_popcount(x) + __builtin_clzll(ll) + __builtin_bswap32(x);
+}
+
+// CHECK-LABEL: llvm.func @hints
+// CHECK: "llvm.intr.prefetch"
+// CHECK: "llvm.intr.assume"
+// CHECK: llvm.unreachable
+void hints(int *p, int x) {
+    __builtin_prefetch(p);
+    __builtin_assume(x > 0);
+    __builtin_unreachable();
+}
@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o - | %file-check %s -check-prefix=NODBG
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -debug-info-kind=line-tables-only -vast-emit-llvm %s -o - | %file-check %s -check-prefix=DBG
+
+// NODBG-NOT: !dbg
+// NODBG-NOT: DISubprogram
+
+// DBG: define {{.*}} @add{{.*}} !dbg
+// DBG: DISubprogram
+int add(int a, int b) {
+    return a + b;
+}
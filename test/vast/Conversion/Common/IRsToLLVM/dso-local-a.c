@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -fvisibility=hidden -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HIDDEN
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="dso-local=1" | %file-check %s -check-prefix=STATIC
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="dso-local=1 pic=1" | %file-check %s -check-prefix=PIC
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="dso-local=1 pic=1 no-plt=1" | %file-check %s -check-prefix=NOPLT
+
+// HIDDEN: hl.var @data {hl.visibility = #hl.visibility<"hidden">}
+// STATIC: llvm.mlir.global internal @data() {{.*}}dso_local
+// PIC: llvm.mlir.global internal @data()
+// PIC-NOT: dso_local
+int data = 1;
+
+// HIDDEN: hl.func @compute
+// HIDDEN-NOT: hl.visibility
+// STATIC: llvm.func @compute(i32) -> i32
+// STATIC-NOT: dso_local
+// PIC: llvm.func @compute(i32) -> i32
+// PIC-NOT: dso_local
+// NOPLT: llvm.func @compute(i32) -> i32 attributes {{{.*}}passthrough = ["nonlazybind"]
+int compute(int);
+
+// HIDDEN: hl.func @exported {{.*}}hl.visibility = #hl.visibility<"protected">
+// STATIC: llvm.func @exported({{.*}}dso_local{{.*}}visibility_ = 2
+// PIC: llvm.func @exported({{.*}}dso_local{{.*}}visibility_ = 2
+__attribute__((visibility("protected")))
+int exported(int x) { return compute(x) + data; }
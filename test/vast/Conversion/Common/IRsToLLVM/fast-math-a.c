@@ -0,0 +1,33 @@
+// RUN: %vast-cc1 -ffast-math -ffp-contract=fast -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -ffast-math -ffp-contract=fast -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=FAST
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -ffp-contract=on -vast-emit-llvm %s -o %t.on.ll
+// RUN: %file-check --input-file=%t.on.ll %s -check-prefix=ON
+
+// HL: hl.fmul {{.*}} {hl.fastmath = #hl.fastmath<reassoc = true, nnan = true, ninf = true, nsz = true, arcp = true, contract = true, afn = true>}
+
+// FAST-LABEL: define {{.*}} @mad
+// FAST: fmul fast float
+// FAST: fadd fast float
+
+// ON-LABEL: define {{.*}} @mad
+// ON-NOT: fmul
+// ON: call float @llvm.fmuladd.f32
+float mad(float a, float b, float c) { return a * b + c; }
+
+// ON-LABEL: define {{.*}} @msub
+// ON: fneg float
+// ON: call float @llvm.fmuladd.f32
+float msub(float a, float b, float c) { return c - a * b; }
+
+// ON-LABEL: define {{.*}} @off
+// ON: fmul float
+// ON: fadd float
+float off(float a, float b, float c) {
+    #pragma STDC FP_CONTRACT OFF
+    return a * b + c;
+}
+
+// FAST-LABEL: define {{.*}} @less
+// FAST: fcmp fast olt
+int less(double a, double b) { return a < b; }
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// HL: hl.func @hot {{.*}}hot = #hl.hot
+// CHECK: llvm.func @hot() attributes {passthrough = ["hot"]}
+__attribute__((hot)) void hot(void) {}
+
+// HL: hl.func @cold {{.*}}cold = #hl.cold
+// CHECK: llvm.func @cold() attributes {passthrough = ["noinline", "cold"]}
+__attribute__((cold, noinline)) void cold(void) {}
+
+// CHECK: llvm.func @fatal() attributes {passthrough = ["noreturn"]}
+_Noreturn void fatal(void);
+
+// CHECK: llvm.func @square(i32) -> i32 attributes {memory = #llvm.memory_effects<other = none, argMem = none, inaccessibleMem = none>}
+__attribute__((const)) int square(int);
+
+// CHECK: llvm.func @length(!llvm.ptr<i8>) -> i64 attributes {memory = #llvm.memory_effects<other = read, argMem = read, inaccessibleMem = read>}
+__attribute__((pure)) unsigned long length(const char *);
@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="lifetime-markers=1" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s -check-prefix=NOMARKERS
+
+void use(int *);
+
+// CHECK-LABEL: llvm.func @scoped
+// CHECK:   [[A:%[0-9]+]] = llvm.alloca {{.*}} x !llvm.array<64 x i32>
+// CHECK:   [[B:%[0-9]+]] = llvm.alloca {{.*}} x !llvm.array<64 x i32>
+// CHECK:   llvm.intr.lifetime.start 256, [[B]]
+// CHECK:   llvm.intr.lifetime.end 256, [[B]]
+// CHECK:   llvm.intr.lifetime.start 256, [[A]]
+// CHECK:   llvm.intr.lifetime.end 256, [[A]]
+// NOMARKERS-NOT: lifetime
+void scoped(void)
+{
+    {
+        int a[64];
+        use(a);
+    }
+    {
+        int b[64];
+        use(b);
+    }
+}
@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+int fail(int);
+
+// CHECK-LABEL: llvm.func @check
+int check(int v)
+{
+    // CHECK: llvm.cond_br {{.*}} weights([1, 2000])
+    if (__builtin_expect(v < 0, 0))
+        return fail(v);
+    return v;
+}
+
+// CHECK-LABEL: llvm.func @sum
+int sum(int n)
+{
+    int s = 0;
+    // CHECK: llvm.cond_br {{.*}} weights([2000, 1])
+    for (int i = 0; __builtin_expect(i < n, 1); i++)
+        s += i;
+    return s;
+}
@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK: [[UNROLL:#loop_unroll[0-9]*]] = #llvm.loop_unroll<count = 4 : i32>
+// CHECK: [[LOOP:#loop_annotation[0-9]*]] = #llvm.loop_annotation<unroll = [[UNROLL]]>
+
+// CHECK-LABEL: llvm.func @clear
+void clear(int *v, int n)
+{
+    // CHECK: llvm.br ^bb{{[0-9]+}} {loop_annotation = [[LOOP]]}
+    #pragma unroll 4
+    for (int i = 0; i < n; i++)
+        v[i] = 0;
+}
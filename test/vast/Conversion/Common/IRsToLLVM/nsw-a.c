@@ -0,0 +1,61 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-ll-geps --vast-irs-to-llvm="no-signed-wrap=1" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-ll-geps --vast-irs-to-llvm | %file-check %s -check-prefix=WRAP
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -fwrapv -vast-emit-llvm %s -o %t.wrapv.ll
+// RUN: %file-check --input-file=%t.wrapv.ll %s -check-prefix=WRAPV
+
+struct pair { int a; int b; };
+
+// CHECK-LABEL: llvm.func @sadd
+// CHECK:       llvm.add {{.*}} {hl.nsw = #hl.nsw} : i32
+// WRAP-LABEL:  llvm.func @sadd
+// WRAP:        llvm.add {{%[0-9]+}}, {{%[0-9]+}} : i32
+// LLVM-LABEL:  define {{.*}} @sadd
+// LLVM:        add nsw i32
+// WRAPV-LABEL: define {{.*}} @sadd
+// WRAPV:       add i32
+int sadd(int x, int y) { return x + y; }
+
+// CHECK-LABEL: llvm.func @umul
+// CHECK:       llvm.mul {{%[0-9]+}}, {{%[0-9]+}} : i32
+// LLVM-LABEL:  define {{.*}} @umul
+// LLVM:        mul i32
+unsigned umul(unsigned x, unsigned y) { return x * y; }
+
+// CHECK-LABEL: llvm.func @at
+// CHECK:       llvm.getelementptr inbounds
+// WRAP-LABEL:  llvm.func @at
+// WRAP:        llvm.getelementptr {{%[0-9]+}}
+// LLVM-LABEL:  define {{.*}} @at
+// LLVM:        getelementptr inbounds i32
+// WRAPV-LABEL: define {{.*}} @at
+// WRAPV:       getelementptr i32
+int at(int *arr, int i) { return arr[i]; }
+
+// CHECK-LABEL: llvm.func @second
+// CHECK:       llvm.getelementptr inbounds
+// WRAP-LABEL:  llvm.func @second
+// WRAP:        llvm.getelementptr inbounds
+int second(struct pair *p) { return p->b; }
+
+// Narrow operands are promoted to int, their wrap is defined.
+// CHECK-LABEL: llvm.func @sinc
+// CHECK-NOT:   hl.nsw
+// CHECK:       llvm.return
+// LLVM-LABEL:  define {{.*}} @sinc
+// LLVM-NOT:    nsw i16
+// LLVM:        ret i16
+short sinc(short s) { s++; return s; }
+
+// CHECK-LABEL: llvm.func @cadd
+// CHECK-NOT:   hl.nsw
+// CHECK:       llvm.return
+// LLVM-LABEL:  define {{.*}} @cadd
+// LLVM-NOT:    nsw i8
+// LLVM:        ret i8
+signed char cadd(signed char c, signed char d) { c += d; return c; }
+
+// CHECK-LABEL: llvm.func @iinc
+// CHECK:       {hl.nsw = #hl.nsw} : i32
+int iinc(int i) { i++; return i; }
@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="noundef=1" | %file-check %s
+
+struct pair { int a; long b; };
+
+extern "C" {
+
+// HL:    hl.func @first {{.*}}(!hl.ptr<si32> {hl.nonnull = #hl.nonnull}, !hl.ptr<si32>)
+// CHECK: llvm.func @first(!llvm.ptr<i32> {llvm.nonnull, llvm.noundef}, !llvm.ptr<i32> {llvm.noundef})
+__attribute__((nonnull(1))) void first(int *p, int *q);
+
+// HL:    hl.func @aligned {{.*}}(!hl.ptr<si32> {hl.align_value = #hl.align_value<16>})
+// CHECK: llvm.func @aligned(!llvm.ptr<i32> {llvm.align = 16 : i64, llvm.noundef})
+void aligned(int *p __attribute__((align_value(16))));
+
+// CHECK: llvm.func @by_ref(!llvm.ptr<i32> {llvm.align = 4 : i64, llvm.dereferenceable = 4 : i64, llvm.nonnull, llvm.noundef})
+void by_ref(int &r);
+
+// CHECK: llvm.func @by_record_ref(!llvm.ptr<{{.*}}> {llvm.align = 8 : i64, llvm.dereferenceable = 16 : i64, llvm.nonnull, llvm.noundef})
+void by_record_ref(const pair &r);
+
+// CHECK: llvm.func @scalars(i32 {llvm.noundef}, f64 {llvm.noundef})
+void scalars(int i, double d);
+
+}
@@ -0,0 +1,34 @@
+// RUN: %llvm-profdata merge %S/Inputs/pgo-a.proftext -o %t.profdata
+// RUN: %vast-cc1 -fprofile-instrument-use-path=%t.profdata -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -fprofile-instrument-use-path=%t.profdata -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// HL-LABEL: hl.func @work
+// HL-DAG: hl.entry_count = #hl.entry_count<10>
+// HL-DAG: hl.branch_weights = #hl.branch_weights<[1001, 11]>
+// HL-DAG: hl.branch_weights = #hl.branch_weights<[335, 667]>
+int work(int n) {
+    int sum = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i % 3 == 0)
+            sum += i;
+    }
+    return sum;
+}
+
+// HL-LABEL: hl.func @classify
+// HL-DAG: hl.entry_count = #hl.entry_count<20>
+// HL-DAG: hl.branch_weights = #hl.branch_weights<[9, 6, 8]>
+int classify(int c) {
+    switch (c) {
+        case 0: return 1;
+        case 1: return 2;
+        default: return 0;
+    }
+}
+
+// LLVM-DAG: !{!"function_entry_count", i64 10}
+// LLVM-DAG: !{!"function_entry_count", i64 20}
+// LLVM-DAG: !{!"branch_weights", i32 1001, i32 11}
+// LLVM-DAG: !{!"branch_weights", i32 335, i32 667}
+// LLVM-DAG: !{!"branch_weights", i32 9, i32 6, i32 8}
@@ -0,0 +1,34 @@
+// RUN: %vast-cc1 -fprofile-instrument=clang -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -fprofile-instrument=clang -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// HL-LABEL: hl.func @work
+// HL: hl.call @llvm.instrprof.increment
+// HL: hl.for
+// HL: hl.call @llvm.instrprof.increment
+// HL: hl.if
+// HL: hl.call @llvm.instrprof.increment
+int work(int n) {
+    int sum = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i % 3 == 0)
+            sum += i;
+    }
+    return sum;
+}
+
+// HL-LABEL: hl.func @classify
+// HL: hl.call @llvm.instrprof.increment
+// HL: hl.switch
+// HL: hl.case
+// HL: hl.call @llvm.instrprof.increment
+int classify(int c) {
+    switch (c) {
+        case 0: return 1;
+        case 1: return c && work(c);
+        default: return 0;
+    }
+}
+
+// LLVM-DAG: @__profc_work = {{.*}}[3 x i64]
+// LLVM-DAG: @__profc_classify = {{.*}}[6 x i64]
@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK: llvm.func @copy({{%arg0: !llvm.ptr<f32> {llvm.noalias}, %arg1: !llvm.ptr<f32> {llvm.noalias}, %arg2: !llvm.ptr<f32>, %arg3: i32}})
+void copy(float *restrict dst, const float *restrict src, float *other, int n)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = src[i] + other[i];
+}
+
+// CHECK: llvm.func @decl(!llvm.ptr<i32> {llvm.noalias})
+void decl(int *restrict p);
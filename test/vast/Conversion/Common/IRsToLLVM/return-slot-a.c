@@ -0,0 +1,53 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="return-slots=1" | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+// RUN: %vast-cc1 -triple aarch64-unknown-linux-gnu -vast-emit-llvm %s -o %t.arm.ll
+// RUN: %file-check --input-file=%t.arm.ll %s -check-prefix=ARM
+
+// Only x86-64 System V targets use the return slots.
+// ARM-NOT: sret
+
+struct small { long a, b; };
+struct large { long a, b, c, d, e, f, g, h; };
+
+// CHECK-LABEL: llvm.func @make_small
+// CHECK-SAME: -> !llvm.struct<"small"
+struct small make_small(long v) {
+    struct small s = { v, v };
+    return s;
+}
+
+// The returned local is built in the slot.
+// CHECK-LABEL: llvm.func @make_large
+// CHECK-SAME: (%arg0: !llvm.ptr<struct<"large"{{.*}}> {llvm.noalias, llvm.sret = !llvm.struct<"large"
+// CHECK-NOT: llvm.alloca {{.*}} x !llvm.struct<"large"
+// CHECK: llvm.return
+// CHECK-NOT: llvm.return
+// LLVM-LABEL: define {{.*}}void @make_large(ptr noalias sret(%struct.large)
+struct large make_large(long v) {
+    struct large l;
+    l.a = v;
+    l.h = v;
+    return l;
+}
+
+// The call initializes `l` in place.
+// CHECK-LABEL: llvm.func @use_large
+// CHECK: [[L:%[0-9]+]] = llvm.alloca {{.*}} x !llvm.struct<"large"
+// CHECK: llvm.call @make_large([[L]], {{.*}}) : (!llvm.ptr<struct<"large"
+// CHECK-NOT: llvm.store {{.*}} : !llvm.struct<"large"
+// LLVM-LABEL: @use_large
+// LLVM: call void @make_large(ptr
+long use_large(long v) {
+    struct large l = make_large(v);
+    return l.a + l.h;
+}
+
+// A returned call result is built in the slot of the caller.
+// CHECK-LABEL: llvm.func @forward_large
+// CHECK-SAME: (%arg0: !llvm.ptr<struct<"large"{{.*}}> {llvm.noalias, llvm.sret
+// CHECK: llvm.call @make_large(%arg0, {{.*}})
+// CHECK-NEXT: llvm.return
+struct large forward_large(long v) {
+    return make_large(v + 1);
+}
@@ -0,0 +1,23 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+int puts(const char *);
+
+// CHECK-DAG: llvm.mlir.global private unnamed_addr constant @vast.strlit.constant_1("hello\00")
+// CHECK-DAG: llvm.mlir.global private unnamed_addr constant @vast.strlit.constant_2("world\00")
+// CHECK-NOT: @vast.strlit.constant_3
+
+// CHECK-DAG: llvm.mlir.global internal local_unnamed_addr constant @limit
+const int limit = 10;
+
+// CHECK-DAG: llvm.mlir.global internal @counter
+int counter = 0;
+
+void report()
+{
+    // CHECK: llvm.mlir.addressof @vast.strlit.constant_1
+    puts("hello");
+    // CHECK: llvm.mlir.addressof @vast.strlit.constant_2
+    puts("world");
+    // CHECK: llvm.mlir.addressof @vast.strlit.constant_1
+    puts("hello");
+}
@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @dispatch
+int dispatch(int op, int a, int b)
+{
+    // CHECK: llvm.switch {{%[0-9]+}} : i32, ^bb{{[0-9]+}} [
+    // CHECK-NEXT: 0: ^bb{{[0-9]+}},
+    // CHECK-NEXT: 1: ^bb{{[0-9]+}},
+    // CHECK-NEXT: 2: ^bb{{[0-9]+}},
+    // CHECK-NEXT: 3: ^bb{{[0-9]+}}
+    // CHECK-NEXT: ]
+    switch (op) {
+        case 0: return a + b;
+        case 1: return a - b;
+        case 2:
+        case 3: a *= 2; break;
+        default: return 0;
+    }
+    return a;
+}
@@ -0,0 +1,35 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+int handler(int state);
+void consume(int *state);
+
+// CHECK-LABEL: llvm.func @dispatch
+// CHECK: llvm.call @handler({{.*}}hl.tail
+// LLVM-LABEL: @dispatch
+// LLVM: tail call i32 @handler
+int dispatch(int state) { return handler(state); }
+
+// HL-LABEL: hl.func @forward
+// HL: hl.call @handler{{.*}}hl.musttail
+// CHECK-LABEL: llvm.func @forward
+// CHECK: llvm.call @handler({{.*}}hl.musttail
+// LLVM-LABEL: @forward
+// LLVM: musttail call i32 @handler
+int forward(int state) {
+    __attribute__((musttail)) return handler(state);
+}
+
+// The caller frame escapes to `consume`.
+// CHECK-LABEL: llvm.func @escaping
+// CHECK-NOT: hl.tail
+// CHECK: llvm.return
+// LLVM-LABEL: @escaping
+// LLVM-NOT: tail call
+// LLVM: ret i32
+int escaping(int state) {
+    consume(&state);
+    return handler(state);
+}
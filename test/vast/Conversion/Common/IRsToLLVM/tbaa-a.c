@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="tbaa=1" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s -check-prefix=NOTBAA
+
+// CHECK-DAG: [[ROOT:#[a-z_0-9]+]] = #llvm.tbaa_root<id = "Simple C/C++ TBAA">
+// CHECK-DAG: [[CHAR:#[a-z_0-9]+]] = #llvm.tbaa_type_desc<id = "omnipotent char", members = {<[[ROOT]], 0>}>
+// CHECK-DAG: [[INT:#[a-z_0-9]+]] = #llvm.tbaa_type_desc<id = "int", members = {<[[CHAR]], 0>}>
+// CHECK-DAG: [[FLOAT:#[a-z_0-9]+]] = #llvm.tbaa_type_desc<id = "float", members = {<[[CHAR]], 0>}>
+// CHECK-DAG: [[INT_TAG:#[a-z_0-9]+]] = #llvm.tbaa_tag<base_type = [[INT]], access_type = [[INT]], offset = 0>
+// CHECK-DAG: [[FLOAT_TAG:#[a-z_0-9]+]] = #llvm.tbaa_tag<base_type = [[FLOAT]], access_type = [[FLOAT]], offset = 0>
+
+// NOTBAA-NOT: tbaa
+
+// CHECK: llvm.func @fn
+int fn(int *i, float *f)
+{
+    // CHECK: llvm.store {{.*}} {tbaa = [[[FLOAT_TAG]]]} : f32
+    *f = 1.0f;
+    // CHECK: llvm.load {{.*}} {tbaa = [[[INT_TAG]]]} : {{.*}} -> i32
+    return *i;
+}
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="tls-model=local-exec" | %file-check %s -check-prefix=DEFAULT
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// HL: hl.var @counter {hl.tls_model = #hl.tls_model<"initial-exec">} tsc_gnu_thread
+// CHECK: llvm.mlir.global internal thread_local @counter() {hl.tls_model = #hl.tls_model<"initial-exec">}
+// DEFAULT: llvm.mlir.global internal thread_local @counter() {hl.tls_model = #hl.tls_model<"initial-exec">}
+// LLVM: @counter = internal thread_local(initialexec) global i32
+__thread int counter __attribute__((tls_model("initial-exec")));
+
+// HL: hl.var @state tsc_c_thread
+// CHECK: llvm.mlir.global internal thread_local @state() : i64
+// DEFAULT: llvm.mlir.global internal thread_local @state() {hl.tls_model = #hl.tls_model<"local-exec">}
+// LLVM: @state = internal thread_local global i64
+_Thread_local long state;
+
+int bump(void) { return ++counter + (int)state; }
@@ -0,0 +1,41 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=llvm %s -o - | %file-check %s -check-prefix=LLVM
+
+typedef __builtin_va_list va_list;
+
+// HL: hl.struct "__va_list_tag"
+// HL-LABEL: hl.func @sum
+// HL: hl.builtin.va_start
+// HL: hl.builtin.va_arg {{.*}} -> !hl.int
+// HL: hl.builtin.va_arg {{.*}} -> !hl.double
+// HL: hl.builtin.va_end
+
+// LLVM-LABEL: llvm.func @sum
+// LLVM:     llvm.intr.vastart
+// LLVM-NOT: llvm.va_arg
+// LLVM:     llvm.icmp "ule" {{.*}}
+// LLVM:     llvm.select
+// LLVM:     llvm.intr.vaend
+double sum(int n, ...)
+{
+    va_list ap;
+    __builtin_va_start(ap, n);
+    double total = 0;
+    for (int i = 0; i < n; ++i)
+        total += __builtin_va_arg(ap, int) * __builtin_va_arg(ap, double);
+    __builtin_va_end(ap);
+    return total;
+}
+
+// HL-LABEL: hl.func @copy
+// HL: hl.builtin.va_copy
+// LLVM-LABEL: llvm.func @copy
+// LLVM: llvm.intr.vacopy
+void copy(int n, ...)
+{
+    va_list ap, aq;
+    __builtin_va_start(ap, n);
+    __builtin_va_copy(aq, ap);
+    __builtin_va_end(aq);
+    __builtin_va_end(ap);
+}
@@ -0,0 +1,47 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types="strict-enums=1" --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="value-ranges=1" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="value-ranges=1" | %file-check %s -check-prefix=NOSTRICT
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -O1 -fstrict-enums -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// HL: hl.enum "color" {hl.value_range = #hl.value_range<0, 4>}
+enum color { red, green, blue };
+
+// HL: hl.enum "sign" {hl.value_range = #hl.value_range<-2, 2>}
+enum sign { negative = -1, positive = 1 };
+
+// HL: hl.enum "fixed" :
+// HL-NOT: hl.value_range
+enum fixed : int { low, high };
+
+extern "C" {
+
+// CHECK-LABEL: llvm.func @load_color
+// CHECK: llvm.load {{.*}}hl.value_range = #hl.value_range<0, 4>
+// NOSTRICT-LABEL: llvm.func @load_color
+// NOSTRICT-NOT: hl.value_range
+// LLVM-LABEL: @load_color
+// LLVM: load i32, ptr {{.*}}, !range [[COLOR:![0-9]+]], !noundef
+int load_color(color *c) { return *c; }
+
+// CHECK-LABEL: llvm.func @load_sign
+// CHECK: llvm.load {{.*}}hl.value_range = #hl.value_range<-2, 2>
+int load_sign(sign *s) { return *s; }
+
+// CHECK-LABEL: llvm.func @load_fixed
+// CHECK-NOT: hl.value_range
+// CHECK: llvm.return
+int load_fixed(fixed *f) { return *f; }
+
+// CHECK-LABEL: llvm.func @load_bool
+// CHECK: llvm.load {{.*}}hl.value_range = #hl.value_range<0, 2>
+// NOSTRICT-LABEL: llvm.func @load_bool
+// NOSTRICT: llvm.load {{.*}}hl.value_range = #hl.value_range<0, 2>
+// LLVM-LABEL: @load_bool
+// LLVM: load i8, ptr {{.*}}, !range [[BOOL:![0-9]+]], !noundef
+bool load_bool(bool *b) { return *b; }
+
+}
+
+// LLVM-DAG: [[COLOR]] = !{i32 0, i32 4}
+// LLVM-DAG: [[BOOL]] = !{i8 0, i8 2}
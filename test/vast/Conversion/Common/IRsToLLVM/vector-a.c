@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+typedef int v4si __attribute__((vector_size(16)));
+typedef float v4sf __attribute__((vector_size(16)));
+
+// CHECK-LABEL: llvm.func @add
+// CHECK: llvm.add {{%[0-9]+}}, {{%[0-9]+}} : vector<4xi32>
+v4si add(v4si a, v4si b) { return a + b; }
+
+// CHECK-LABEL: llvm.func @scale
+// CHECK: [[ONE:%[0-9]+]] = llvm.insertelement
+// CHECK: [[SPLAT:%[0-9]+]] = llvm.shufflevector [[ONE]], [[ONE]] [0, 0, 0, 0] : vector<4xf32>
+// CHECK: llvm.fmul {{%[0-9]+}}, [[SPLAT]] : vector<4xf32>
+v4sf scale(v4sf a, float s) { return a * s; }
+
+// CHECK-LABEL: llvm.func @less
+// CHECK: [[CMP:%[0-9]+]] = llvm.icmp "slt" {{%[0-9]+}}, {{%[0-9]+}} : vector<4xi32>
+// CHECK: llvm.sext [[CMP]] : vector<4xi1> to vector<4xi32>
+v4si less(v4si a, v4si b) { return a < b; }
+
+// CHECK-LABEL: llvm.func @flip
+// CHECK: llvm.shufflevector {{%[0-9]+}}, {{%[0-9]+}} [3, 2, 1, 0] : vector<4xi32>
+v4si flip(v4si a) { return __builtin_shufflevector(a, a, 3, 2, 1, 0); }
+
+// CHECK-LABEL: llvm.func @sum_lane
+// CHECK: llvm.extractelement {{%[0-9]+}}[{{%[0-9]+}} : i32] : vector<4xi32>
+int sum_lane(v4si a, v4si b) { return (a + b)[0]; }
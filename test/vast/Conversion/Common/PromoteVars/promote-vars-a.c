@@ -0,0 +1,35 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-ll-promote-vars | %file-check %s
+
+void use(int *);
+
+// CHECK-LABEL: hl.func @scalar
+// CHECK-NOT:   ll.uninitialized_var
+// CHECK:       [[A:%[0-9]+]] = hl.implicit_cast {{.*}} LValueToRValue
+// CHECK:       [[C:%[0-9]+]] = hl.const #core.integer<2>
+// CHECK:       [[M:%[0-9]+]] = hl.mul [[A]], [[C]]
+// CHECK:       [[S:%[0-9]+]] = hl.add [[M]], [[M]]
+// CHECK:       hl.return [[S]]
+int scalar(int a)
+{
+    int b = a * 2;
+    b = b + b;
+    return b;
+}
+
+// CHECK-LABEL: hl.func @escaped
+// CHECK:       ll.uninitialized_var : !hl.lvalue<si32>
+void escaped(void)
+{
+    int x = 0;
+    use(&x);
+}
+
+// CHECK-LABEL: hl.func @branch
+// CHECK:       ll.uninitialized_var : !hl.lvalue<si32>
+int branch(int c)
+{
+    int x = 0;
+    if (c)
+        x = 1;
+    return x;
+}
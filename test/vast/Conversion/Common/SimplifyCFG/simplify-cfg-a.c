@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-func --vast-hl-to-ll --vast-ll-simplify-cfg | %file-check %s
+
+void callee(int);
+
+// CHECK: ll.func @empty
+// CHECK-NOT: core.scope
+// CHECK: ll.return
+void empty(void) {
+    {}
+    {}
+}
+
+// The start block of the loop scope stays in place.
+// CHECK: ll.func @loop
+// CHECK: ll.scope {
+// CHECK: ll.br ^bb1
+// CHECK: ^bb1:
+// CHECK: ll.cond_scope_ret
+// CHECK: ll.scope_recurse
+void loop(int n) {
+    for (int i = 0; i < n; ++i) {
+        callee(i);
+    }
+}
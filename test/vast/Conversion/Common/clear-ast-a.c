@@ -0,0 +1,14 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-clear-ast-before-lowering -vast-memory-report %s -o %t.mlir 2>&1 | %file-check %s -check-prefix=REPORT
+// RUN: %file-check %s -input-file=%t.mlir
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -clear-ast-before-backend -vast-emit-llvm %s -o - | %file-check %s -check-prefix=LLVM
+
+// REPORT: codegen_driver::finalize
+// REPORT: clear ast
+// REPORT: vast-irs-to-llvm
+
+// CHECK: llvm.func @add
+// LLVM: define {{.*}}i32 @add
+
+struct point { int x, y; };
+
+int add(struct point p) { return p.x + p.y; }
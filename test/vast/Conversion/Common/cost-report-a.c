@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -vast-emit-llvm -vast-estimate-cost -vast-cost-report=%t.estimate.json %s -o %t.ll
+// RUN: %file-check --input-file=%t.estimate.json %s -check-prefix=ESTIMATE
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-cost-report=%t.full.json %s -o %t.ll
+// RUN: %file-check --input-file=%t.full.json %s -check-prefix=FULL
+
+// ESTIMATE: "features": {
+// ESTIMATE: "functions": 2,
+// ESTIMATE-NEXT: "records": {{[0-9]+}},
+// ESTIMATE-NEXT: "globals": 1,
+// ESTIMATE: "estimate_ms": {{[0-9.e+-]+}}
+// ESTIMATE-NOT: measured_ms
+
+// FULL: "estimate_ms":
+// FULL: "measured_ms": {
+// FULL-NEXT: "parse and codegen":
+// FULL: "lower_hl_module":
+// FULL: "EmitBackendOutput":
+// FULL: "total":
+
+struct point { int x, y; };
+
+int counter = 0;
+
+int dot(struct point a, struct point b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+int main(void) {
+    struct point p = { 1, 2 };
+    counter += dot(p, p);
+    return counter;
+}
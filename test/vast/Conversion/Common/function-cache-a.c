@@ -0,0 +1,22 @@
+// RUN: rm -rf %t.cache
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-function-cache=%t.cache %s -o %t.first.mlir
+// RUN: find %t.cache -name '*.mlirbc' | wc -l | %file-check %s -check-prefix=ENTRIES
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-function-cache=%t.cache %s -o %t.second.mlir
+// RUN: diff %t.first.mlir %t.second.mlir
+// RUN: %file-check %s -input-file=%t.second.mlir
+
+// The body of `name` refers to a global created by the lowering, so only
+// `add` and `twice` are cached.
+// ENTRIES: 2
+
+// CHECK: llvm.func @add
+// CHECK: llvm.add
+// CHECK: llvm.func @twice
+// CHECK: llvm.call @add
+// CHECK: llvm.func @name
+
+int add(int a, int b) { return a + b; }
+
+int twice(int a) { return add(a, a); }
+
+const char *name(void) { return "twice"; }
@@ -0,0 +1,27 @@
+// RUN: rm -rf %t.cache
+// RUN: cp %s %t.c
+// RUN: %vast-cc1 -O2 -vast-emit-mlir=llvm -vast-function-cache=%t.cache %t.c -o %t.first.mlir
+// RUN: find %t.cache -name '*.mlirbc' | wc -l | %file-check %s -check-prefix=ENTRIES
+// RUN: sed -i 's/a + 1;/a + 2;/' %t.c
+// RUN: %vast-cc1 -O2 -vast-emit-mlir=llvm -vast-function-cache=%t.cache %t.c -o %t.second.mlir
+// RUN: %file-check %s -input-file=%t.second.mlir
+
+// With inlining, the key of `outer` covers the body of `leaf`, which it
+// reaches through `mid`. Functions that reach an indirect call or a static
+// global are not cached.
+// ENTRIES: 3
+
+int leaf(int a) { return a + 1; }
+
+int mid(int a) { return leaf(a); }
+
+// CHECK-LABEL: llvm.func @outer
+// CHECK: llvm.mlir.constant(2 : i32)
+// CHECK: llvm.return
+int outer(int a) { return mid(a); }
+
+static int flag;
+
+int get_flag(void) { return flag; }
+
+int dispatch(int (*fn)(int), int a) { return fn(a); }
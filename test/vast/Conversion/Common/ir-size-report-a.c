@@ -0,0 +1,12 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-ir-size-report %s -o /dev/null 2>&1 | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pass-timing %s -o /dev/null 2>&1 | %file-check %s -check-prefix=TIMING
+
+// CHECK: vast ir size report
+// CHECK: vast-irs-to-llvm (1 runs)
+// CHECK-DAG: hl {{ +[0-9]+}} -> {{ +}}0
+// CHECK-DAG: llvm {{ +[0-9]+}} -> {{ +[0-9]+}}
+
+// TIMING: Execution time report
+// TIMING: IRsToLLVM
+
+int main() { return 0; }
@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-memory-report %s -o /dev/null 2>&1 | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-memory-report %s -o %t.ll 2>&1 | %file-check %s -check-prefix=BACKEND
+
+// CHECK: vast memory report (MiB)
+// CHECK: phase {{ +}}rss {{ +}}peak {{ +}}malloc {{ +}}ast {{ +}}ops
+// CHECK: parse and codegen {{.*[0-9]+}}
+// CHECK: codegen_driver::finalize
+// CHECK: vast-irs-to-llvm
+
+// BACKEND: vast memory report (MiB)
+// BACKEND: vast-core-to-llvm
+// BACKEND: translate to llvm ir
+// BACKEND: EmitBackendOutput
+
+int main() { return 0; }
@@ -0,0 +1,8 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pattern-profile %s -o /dev/null 2>&1 | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="profile-patterns=true" -o /dev/null 2>&1 | %file-check %s
+
+// CHECK: vast pattern profile: vast-irs-to-llvm
+// CHECK: attempts {{ +}}success {{ +}}failure {{ +}}time [us] {{ +}}pattern
+// CHECK: func_op
+
+int main() { return 0; }
@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pass-timing %s -o /dev/null 2>&1 | %file-check %s -check-prefix=FAST --implicit-check-not=HLSymbolDCE --implicit-check-not=FlattenScopes
+// RUN: %vast-cc1 -O1 -vast-emit-mlir=llvm -vast-pipeline=fast -vast-pass-timing %s -o /dev/null 2>&1 | %file-check %s -check-prefix=FAST --implicit-check-not=HLSymbolDCE --implicit-check-not=FlattenScopes
+// RUN: %vast-cc1 -O1 -vast-emit-mlir=llvm -vast-pass-timing %s -o /dev/null 2>&1 | %file-check %s -check-prefix=BASELINE
+
+// Without -vast-pipeline, -O0 takes the fast pipeline and higher levels the
+// baseline one.
+
+// FAST: Execution time report
+// FAST-DAG: HLLowerTypes
+// FAST-DAG: IRsToLLVM
+
+// BASELINE: Execution time report
+// BASELINE-DAG: HLSymbolDCE
+// BASELINE-DAG: FlattenScopes
+// BASELINE-DAG: IRsToLLVM
+
+int main() { return 0; }
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-trace=%t.json %s -o /dev/null
+// RUN: %file-check %s -input-file=%t.json
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-trace=%t.ll.json %s -o %t.ll
+// RUN: %file-check %s -input-file=%t.ll.json -check-prefix=BACKEND
+
+// CHECK-DAG: "name":"ExecuteCompiler"
+// CHECK-DAG: "name":"HandleTopLevelDecl"
+// CHECK-DAG: "detail":"main"
+// CHECK-DAG: "name":"codegen_driver::finalize"
+// CHECK-DAG: "name":"verify module"
+// CHECK-DAG: "name":"emit_high_level_pass"
+// CHECK-DAG: "name":"lower_hl_module"
+// CHECK-DAG: "name":"vast-irs-to-llvm"
+
+// BACKEND-DAG: "name":"lower_hl_module"
+// BACKEND-DAG: "name":"translate to llvm ir"
+// BACKEND-DAG: "name":"EmitBackendOutput"
+
+int main() { return 0; }
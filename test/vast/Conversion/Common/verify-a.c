@@ -0,0 +1,7 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-verify=every-pass %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-verify=once %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-verify=never -vast-verify-diags %s -o - | %file-check %s
+
+// CHECK: llvm.func @add
+
+int add(int a, int b) { return a + b; }
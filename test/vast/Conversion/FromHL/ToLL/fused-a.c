@@ -0,0 +1,26 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll | %file-check %s
+
+struct X { int a; };
+
+// CHECK: ll.func @fn
+int fn(int c)
+{
+    // CHECK: [[X:%[0-9]+]] = ll.uninitialized_var : !hl.lvalue<!hl.elaborated<!hl.record<"X">>>
+    struct X x;
+
+    // CHECK: "ll.gep"
+    x.a = 5;
+
+    // CHECK: core.lazy.op
+    // CHECK: core.bin.land
+    int b = c && x.a;
+
+    // CHECK: ll.scope {
+    // CHECK: ll.cond_scope_ret
+    for (int i = 0; i < c; ++i) {
+        break;
+    }
+
+    // CHECK: ll.return
+    return b;
+}
@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// CHECK-LABEL: hl.func @lt
+// CHECK: [[C:%[0-9]+]] = hl.cmp slt {{.*}} -> i1
+// CHECK-NOT: hl.implicit_cast
+// CHECK: ll.cond_br [[C]] : i1
+
+// LLVM-LABEL: define {{.*}} @lt
+// LLVM: [[C:%[0-9]+]] = icmp slt i32
+// LLVM-NOT: zext
+// LLVM: br i1 [[C]]
+int lt(int a, int b) {
+    if (a < b)
+        return 1;
+    return 0;
+}
+
+// The comparison is a value of the expression, it keeps its type.
+// CHECK-LABEL: hl.func @keep
+// CHECK: hl.cmp sgt {{.*}} -> si32
+int keep(int a, int b) {
+    int c = a > b;
+    if (c)
+        return c;
+    return 0;
+}
@@ -0,0 +1,53 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf=rotate-loops=true --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-rotate-loops -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// CHECK: [[UNROLL:#loop_unroll[0-9]*]] = #llvm.loop_unroll<count = 4 : i32>
+// CHECK: [[LOOP:#loop_annotation[0-9]*]] = #llvm.loop_annotation<unroll = [[UNROLL]]>
+
+// The guard and the latch test the condition, the latch branches back to
+// the body.
+// LLVM-LABEL: define {{.*}} @sum
+// LLVM: icmp slt
+// LLVM: br i1
+// LLVM: add nsw
+// LLVM: icmp slt
+// LLVM: br i1
+int sum(int n)
+{
+    int s = 0, i = 0;
+    while (i < n) {
+        s += i;
+        ++i;
+    }
+    return s;
+}
+
+// CHECK-LABEL: llvm.func @clear
+// CHECK-NOT: loop_annotation
+// CHECK: llvm.cond_br {{.*}} {loop_annotation = [[LOOP]]}
+void clear(int *v, int n)
+{
+    #pragma unroll 4
+    for (int i = 0; i < n; i++)
+        v[i] = 0;
+}
+
+// `continue` goes to the increment, which precedes the latch.
+// LLVM-LABEL: define {{.*}} @odd
+// LLVM: icmp slt
+// LLVM: br i1
+// LLVM: srem
+// LLVM: add nsw i32 {{.*}}, 1
+// LLVM: icmp slt
+// LLVM: br i1
+int odd(int n)
+{
+    int c = 0;
+    for (int i = 0; i < n; i++) {
+        if (i % 2 == 0)
+            continue;
+        c++;
+    }
+    return c;
+}
@@ -0,0 +1,38 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+
+int classify(int c)
+{
+    int r = 0;
+    // CHECK: ll.scope {
+    // CHECK:   ll.br ^bb1
+    // CHECK: ^bb1:
+    // CHECK:   ll.switch {{%[0-9]+}} : i32, ^bb5, dense<[1, 2, 3]> : vector<3xi32> [^bb2, ^bb3, ^bb4]
+    switch (c) {
+        // CHECK: ^bb2:
+        // CHECK:   ll.scope_ret
+        case 1: r = 10; break;
+        // CHECK: ^bb3:
+        // CHECK:   ll.br ^bb4
+        case 2:
+        // CHECK: ^bb4:
+        // CHECK:   ll.br ^bb5
+        case 3: r = 20;
+        // CHECK: ^bb5:
+        // CHECK:   ll.scope_ret
+        default: r += 1;
+    }
+    // CHECK: }
+    return r;
+}
+
+int no_default(int c)
+{
+    // CHECK: ll.switch {{%[0-9]+}} : i32, ^bb4, dense<[0, 1]> : vector<2xi32> [^bb2, ^bb3]
+    switch (c) {
+        case 0: return 1;
+        case 1: return 2;
+    }
+    // CHECK: ^bb4:
+    // CHECK:   ll.scope_ret
+    return 0;
+}
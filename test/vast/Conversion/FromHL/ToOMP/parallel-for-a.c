@@ -0,0 +1,26 @@
+// RUN: %vast-cc1 -fopenmp -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-omp | %file-check %s
+
+// CHECK-LABEL: hl.func @scale
+// CHECK: omp.parallel {
+// CHECK:   [[UB:%[a-z0-9_]+]] = builtin.unrealized_conversion_cast {{.*}} : si32 to i32
+// CHECK:   omp.wsloop schedule(static) for ([[IV:%[a-z0-9]+]]) : i32 = ({{.*}}) to ([[UB]]) step ({{.*}}) {
+// CHECK:     [[V:%[a-z0-9_]+]] = builtin.unrealized_conversion_cast [[IV]] : i32 to si32
+// CHECK:     hl.assign [[V]] to
+// CHECK:     omp.yield
+// CHECK-NOT: hl.for
+void scale(float *a, int n) {
+    #pragma omp parallel for
+    for (int i = 0; i < n; ++i) {
+        a[i] *= 2.0f;
+    }
+}
+
+// CHECK-LABEL: hl.func @outer_iv
+// CHECK: omp.wsloop schedule(dynamic = {{.*}})
+void outer_iv(int *a) {
+    int i;
+    #pragma omp parallel for schedule(dynamic, 8)
+    for (i = 0; i < 128; i++) {
+        a[i] = i;
+    }
+}
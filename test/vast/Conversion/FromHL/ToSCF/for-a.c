@@ -0,0 +1,65 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-scf | %file-check %s
+
+// CHECK-LABEL: hl.func @sum
+// CHECK: [[LB:%[a-z0-9_]+]] = builtin.unrealized_conversion_cast {{.*}} : si32 to i32
+// CHECK: [[UB:%[a-z0-9_]+]] = builtin.unrealized_conversion_cast {{.*}} : si32 to i32
+// CHECK: scf.for [[IV:%[a-z0-9]+]] = [[LB]] to [[UB]] step {{.*}} : i32
+// CHECK: [[V:%[a-z0-9_]+]] = builtin.unrealized_conversion_cast [[IV]] : i32 to si32
+// CHECK: hl.assign [[V]] to
+// CHECK-NOT: hl.for
+int sum(int *a, int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        s += a[i];
+    }
+    return s;
+}
+
+// CHECK-LABEL: hl.func @strided
+// CHECK: scf.for
+void strided(int *a) {
+    for (int i = 0; i < 64; i += 4) {
+        a[i] = 0;
+    }
+}
+
+// CHECK-LABEL: hl.func @early_exit
+// CHECK-NOT: scf.for
+// CHECK: hl.for
+int early_exit(int *a, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (a[i])
+            return i;
+    }
+    return -1;
+}
+
+// CHECK-LABEL: hl.func @written
+// CHECK-NOT: scf.for
+// CHECK: hl.for
+void written(int *a, int n) {
+    for (int i = 0; i < n; ++i) {
+        i += a[i];
+    }
+}
+
+// CHECK-LABEL: hl.func @assigned_before
+// CHECK: scf.for
+void assigned_before(int *a, int n) {
+    int i;
+    i = 0;
+    for (; i < n; ++i) {
+        a[i] = i;
+    }
+}
+
+// CHECK-LABEL: hl.func @escaped_before
+// CHECK-NOT: scf.for
+// CHECK: hl.for
+void escaped_before(int *a, int n) {
+    int i;
+    int *p = &i;
+    for (i = 0; i < n; ++i) {
+        *p += a[i];
+    }
+}
@@ -0,0 +1,7 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK-DAG: #dlti.dl_entry<!hl.int, #core.layout<32, 32>>
+// CHECK-DAG: #dlti.dl_entry<!hl.char, #core.layout<8, 8>>
+char c;
+int i;
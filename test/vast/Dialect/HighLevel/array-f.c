@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK: hl.var "table" {initial_value = dense<[0, 1, 4, 9, 16, 25, 36, 49, 64, 81, 0, 0, 0, 0, 0, 0]> : tensor<16xi32>} : !hl.lvalue<!hl.array<16, !hl.int< const >>>
+// CHECK-NOT: hl.initlist
+const int table[16] = { 0, 1, 4, 9, 16, 25, 36, 49, 64, 81 };
+
+// CHECK: hl.var "grid" {initial_value = dense<{{\[\[}}1.000000e+00, {{.*}}]]> : tensor<4x4xf32>}
+float grid[4][4] = { { 1.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+// CHECK: hl.var "small" : !hl.lvalue<!hl.array<3, !hl.int>> = {
+// CHECK:   hl.initlist
+int small[3] = { 1, 2, 3 };
@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %s -o - | %file-check %s -check-prefix=LLVM
+
+// LLVM: llvm.mlir.global private unnamed_addr constant @__const.lookup(dense<[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]> : tensor<16xi32>)
+
+int lookup(int i) {
+    // HL: hl.var "table" {initial_value = dense<[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]> : tensor<16xi32>} : !hl.lvalue<!hl.array<16, !hl.int>>
+    // HL-NOT: hl.initlist
+    // LLVM: llvm.mlir.addressof @__const.lookup
+    // LLVM: "llvm.intr.memcpy"
+    int table[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+    // HL: hl.var "mixed" : !hl.lvalue<!hl.array<16, !hl.int>> = {
+    // HL:   hl.initlist
+    int mixed[16] = { i };
+    return table[i] + mixed[0];
+}
@@ -0,0 +1,54 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK-LABEL: hl.func @load
+// CHECK: hl.atomic.load {{%[0-9]+}} seq_cst : !hl.ptr<!hl.int> -> !hl.int
+int load(int *p) {
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+// CHECK-LABEL: hl.func @store
+// CHECK: hl.atomic.store {{%[0-9]+}} to {{%[0-9]+}} release : !hl.int, !hl.ptr<!hl.int>
+void store(int *p, int v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+// CHECK-LABEL: hl.func @fetch_add
+// CHECK: hl.atomic.rmw add {{%[0-9]+}}, {{%[0-9]+}} relaxed
+int fetch_add(int *p) {
+    return __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+
+// CHECK-LABEL: hl.func @nand_fetch
+// CHECK: [[OLD:%[0-9]+]] = hl.atomic.rmw nand {{%[0-9]+}}, [[ARG:%[0-9]+]] acq_rel
+// CHECK: [[AND:%[0-9]+]] = hl.bin.and [[OLD]], [[ARG]]
+// CHECK: hl.not [[AND]]
+unsigned nand_fetch(unsigned *p, unsigned v) {
+    return __atomic_nand_fetch(p, v, __ATOMIC_ACQ_REL);
+}
+
+// CHECK-LABEL: hl.func @max
+// CHECK: hl.atomic.rmw umax
+unsigned max(unsigned *p, unsigned v) {
+    return __atomic_fetch_max(p, v, __ATOMIC_SEQ_CST);
+}
+
+// CHECK-LABEL: hl.func @cas
+// CHECK: hl.atomic.cmpxchg {{%[0-9]+}}, {{%[0-9]+}}, {{%[0-9]+}} acq_rel acquire weak
+_Bool cas(int *p, int *expected, int desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// CHECK-LABEL: hl.func @order
+// CHECK: hl.atomic.load {{%[0-9]+}} seq_cst
+int order(int *p, int o) {
+    return __atomic_load_n(p, o);
+}
+
+// CHECK-LABEL: hl.func @fences
+// CHECK: hl.atomic.fence acquire
+// CHECK: hl.atomic.fence seq_cst single_thread
+void fences(void) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
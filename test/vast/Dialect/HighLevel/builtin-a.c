@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK-LABEL: hl.func @copy
+// CHECK: hl.builtin.memcpy {{%[0-9]+}}, {{%[0-9]+}}, {{%[0-9]+}} : (!hl.ptr<!hl.void>, !hl.ptr<!hl.void< const >>, !hl.long< unsigned >) -> !hl.ptr<!hl.void>
+// CHECK: hl.builtin.memset {{%[0-9]+}}, {{%[0-9]+}}, {{%[0-9]+}} : (!hl.ptr<!hl.void>, !hl.int, !hl.long< unsigned >) -> !hl.ptr<!hl.void>
+void copy(void *dst, const void *src, unsigned long n) {
+    __builtin_memcpy(dst, src, n);
+    __builtin_memset(dst, 0, n);
+}
+
+// CHECK-LABEL: hl.func @bits
+// CHECK: hl.builtin.popcount {{%[0-9]+}} : !hl.int< unsigned > -> !hl.int
+// CHECK: hl.builtin.clz {{%[0-9]+}} : !hl.longlong< unsigned > -> !hl.int
+// CHECK: hl.builtin.ctz {{%[0-9]+}} : !hl.long< unsigned > -> !hl.int
+// CHECK: hl.builtin.bswap {{%[0-9]+}} : !hl.int< unsigned > -> !hl.int< unsigned >
+unsigned bits(unsigned x, unsigned long l, unsigned long long ll) {
+    return __builtin_popcount(x) + __builtin_clzll(ll) + __builtin_ctzl(l) + __builtin_bswap32(x);
+}
+
+// CHECK-LABEL: hl.func @hints
+// CHECK: hl.builtin.prefetch {{%[0-9]+}} {locality = 3 : i32, rw = 0 : i32} : !hl.ptr<!hl.void< const >>
+// CHECK: hl.builtin.prefetch {{%[0-9]+}} {locality = 1 : i32, rw = 1 : i32} : !hl.ptr<!hl.void< const >>
+// CHECK: hl.builtin.assume {{%[0-9]+}} : !hl.int
+// CHECK: hl.builtin.unreachable
+void hints(int *p, int x) {
+    __builtin_prefetch(p);
+    __builtin_prefetch(p, 1, 1);
+    __builtin_assume(x > 0);
+    if (x > 10)
+        __builtin_unreachable();
+}
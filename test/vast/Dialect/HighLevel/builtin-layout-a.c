@@ -0,0 +1,10 @@
+// RUN: %vast-front --target=x86_64-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=LP64
+// RUN: %vast-front --target=aarch64-apple-darwin -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=DARWIN
+// RUN: %vast-front --target=x86_64-linux-gnu -mlong-double-64 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=CUSTOM
+
+// LP64: hl.builtin_layout = "lp64"
+// DARWIN: hl.builtin_layout = "lp64-double-long-double"
+// CUSTOM-NOT: hl.builtin_layout
+
+long double ld;
+long l;
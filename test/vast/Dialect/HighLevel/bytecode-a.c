@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt -o %t.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-mlir-bytecode %s -o %t.mlirbc
+// RUN: %vast-opt %t.mlirbc -o %t.roundtrip.mlir
+// RUN: diff %t.mlir %t.roundtrip.mlir
+// RUN: %file-check --input-file=%t.roundtrip.mlir %s
+
+// CHECK: hl.struct "point"
+struct point { int x, y; };
+
+// CHECK: hl.enum "color"
+enum color { red, green };
+
+// CHECK: hl.typedef "point_t" : !hl.elaborated<!hl.record<"point">>
+typedef struct point point_t;
+
+typedef float vec4 __attribute__((vector_size(16)));
+
+extern const int values[];
+
+// CHECK: hl.var "str" : !hl.lvalue<!hl.ptr<!hl.char< const >>>
+const char *str = "bytecode";
+
+// CHECK: hl.func @f
+// CHECK: hl.const #core.float<2.500000e+00> : !hl.double
+// CHECK: hl.const #core.integer<7> : !hl.int< unsigned >
+unsigned long f(volatile point_t *restrict p, enum color c, vec4 v, int a[3]) {
+    double d = 2.5;
+    unsigned u = 7u;
+    return p->x + c + v[0] + a[1] + values[0] + d + u;
+}
@@ -0,0 +1,8 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-codegen-report=2 %s -o /dev/null 2>&1 | %file-check %s
+
+// CHECK: vast codegen report: top 2 of {{[0-9]+}} declarations
+// CHECK: time [us]
+// CHECK-DAG: {{[0-9]+ +[1-9][0-9]* +-?[0-9]+}}  {{sum|main}}
+int sum(int a, int b) { return a + b; }
+
+int main() { return sum(1, 2); }
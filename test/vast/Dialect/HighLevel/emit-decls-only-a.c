@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-decls-only %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-decls-only %s -o - > %t && %vast-opt %t | diff -B %t -
+
+// CHECK: hl.typedef "number"
+typedef int number;
+
+// CHECK: hl.struct "point"
+struct point { number x, y; };
+
+// CHECK: hl.var @origin
+struct point origin = { 0, 0 };
+
+// CHECK: hl.func @sum {{.*}}(!hl.lvalue<!hl.elaborated<!hl.record<"point">>>) -> !hl.int
+// CHECK-NOT: hl.return
+int sum(struct point p) { return p.x + p.y; }
+
+// CHECK: hl.func @main
+// CHECK-NOT: hl.call
+int main() { return sum(origin); }
@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-reachable-from=entry %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl "-vast-emit-reachable-from=entry,other" %s -o - | %file-check %s -check-prefix=BOTH
+
+struct unused { int x; };
+struct used { int y; };
+
+// CHECK-NOT: hl.struct "unused"
+// CHECK-NOT: hl.var "unused_global"
+int unused_global;
+
+// CHECK: hl.var "used_global"
+int used_global;
+
+// CHECK-NOT: hl.func @other
+// BOTH: hl.func @other
+int other(void) { return unused_global; }
+
+// CHECK: hl.func @callee
+// CHECK: hl.globref "used_global"
+int callee(struct used *u) { return u->y + used_global; }
+
+// CHECK: hl.func @entry
+// CHECK: hl.call @callee
+int entry(struct used *u) { return callee(u); }
+
+// CHECK-NOT: hl.func @main
+int main(void) { return other(); }
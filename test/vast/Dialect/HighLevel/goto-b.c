@@ -1,18 +1,25 @@
 // RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
 // RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
-// REQUIRES: indirect-goto
 
 void foo(int test) {
+    // CHECK: [[FOO:%[0-9]+]] = hl.label.decl "foo" : !hl.label
+    // CHECK: [[BAR:%[0-9]+]] = hl.label.decl "bar" : !hl.label
     void *ptr;
 
+    // CHECK: hl.labeladdr [[FOO]] : !hl.ptr<!hl.void>
+    // CHECK: hl.labeladdr [[BAR]] : !hl.ptr<!hl.void>
     if (test)
         ptr = &&foo;
     else
         ptr = &&bar;
 
+    // CHECK: [[P:%[0-9]+]] = hl.implicit_cast {{.*}} LValueToRValue : !hl.lvalue<!hl.ptr<!hl.void>> -> !hl.ptr<!hl.void>
+    // CHECK: hl.indirect_goto [[P]] : !hl.ptr<!hl.void>
     goto *ptr;
 
+    // CHECK: hl.label [[FOO]]
     foo: /* ... */;
 
+    // CHECK: hl.label [[BAR]]
     bar: /* ... */;
 }
@@ -0,0 +1,14 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-lazy-function-bodies %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-lazy-function-bodies -vast-emit-reachable-from=main %s -o - | %file-check %s -check-prefix=REACH
+
+// CHECK: hl.func @square
+// CHECK-NOT: hl.mul
+// REACH: hl.func @square
+// REACH: hl.mul
+int square(int x) { return x * x; }
+
+// CHECK: hl.func @main
+// CHECK-NOT: hl.call
+// REACH: hl.func @main
+// REACH: hl.call @square
+int main() { return square(2); }
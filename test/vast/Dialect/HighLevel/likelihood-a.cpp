@@ -0,0 +1,39 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+
+#define unlikely(x) __builtin_expect(!!(x), 0)
+
+int fail(int);
+
+// CHECK-LABEL: hl.func @_Z6expecti
+int expect(int v)
+{
+    // CHECK: hl.if {
+    // CHECK: } {hl.likelihood = #hl.likelihood<false>}
+    if (unlikely(v < 0))
+        return fail(v);
+    return v;
+}
+
+// CHECK-LABEL: hl.func @_Z4attri
+int attr(int v)
+{
+    // CHECK: hl.if {
+    // CHECK: } {hl.likelihood = #hl.likelihood<false>}
+    if (v > 0) {
+        return v;
+    } else [[likely]] {
+        return -v;
+    }
+}
+
+// CHECK-LABEL: hl.func @_Z4loopi
+int loop(int n)
+{
+    int s = 0;
+    // CHECK: hl.while {
+    // CHECK: } {hl.likelihood = #hl.likelihood<true>}
+    while (n--) [[likely]] {
+        s += n;
+    }
+    return s;
+}
@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=full %s -o - | %file-check %s -check-prefix=FULL
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=line %s -o - | %file-check %s -check-prefix=LINE
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=none %s -o - | %file-check %s -check-prefix=NONE
+
+int main() { return 0; }
+
+// FULL: hl.return {{.*}}/locs-a.c:5:14
+// FULL: } {{.*}}/locs-a.c:5:5
+
+// LINE: hl.return {{.*}}/locs-a.c:5:0
+// LINE: } {{.*}}/locs-a.c:5:0
+
+// NONE-NOT: locs-a.c:5
@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=full %s -o - | %file-check %s
+
+// Operations from a macro are located at its expansion.
+#define RET return 0
+
+int expanded(void) { RET; }
+
+// CHECK-LABEL: hl.func @expanded
+// CHECK: hl.return {{.*}}/locs-b.c:6:22
+
+#line 100 "renamed.c"
+int renamed(void) { return 1; }
+
+// CHECK-LABEL: hl.func @renamed
+// CHECK: hl.return {{.*}}renamed.c:100:21
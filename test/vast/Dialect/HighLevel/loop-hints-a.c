@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+
+void scale(float *v, int n)
+{
+    // CHECK: hl.for
+    // CHECK: hl.loop_hints = #hl.loop_hints<vectorize = true, vectorize_width = 8 : i32, interleave_count = 2 : i32>
+    #pragma clang loop vectorize(enable) vectorize_width(8) interleave_count(2)
+    for (int i = 0; i < n; i++)
+        v[i] *= 2.0f;
+}
+
+void unrolled(int *v, int n)
+{
+    int i = 0;
+    // CHECK: hl.while
+    // CHECK: hl.loop_hints = #hl.loop_hints<unroll_count = 4 : i32>
+    #pragma unroll 4
+    while (i < n)
+        v[i++] = 0;
+}
+
+void rolled(int *v, int n)
+{
+    // CHECK: hl.loop_hints = #hl.loop_hints<unroll = false>
+    #pragma nounroll
+    for (int i = 0; i < n; i++)
+        v[i] = i;
+}
@@ -0,0 +1,34 @@
+// RUN: %vast-cc1 -fopenmp -vast-emit-mlir=hl %s -o - | %file-check %s
+
+// CHECK-LABEL: hl.func @sum
+// CHECK: omp.parallel {
+// CHECK: [[COPY:%[0-9]+]] = hl.var "s" : !hl.lvalue<!hl.int> = {
+// CHECK:   hl.const #core.integer<0> : !hl.int
+// CHECK: hl.for
+// CHECK: } {hl.worksharing = #hl.worksharing<schedule = "dynamic", chunk = 4 : i64, nowait = false>}
+// CHECK: omp.critical {
+// CHECK:   hl.assign.add
+// CHECK:   omp.terminator
+// CHECK: omp.terminator
+int sum(int *a, int n) {
+    int s = 0;
+    #pragma omp parallel for schedule(dynamic, 4) reduction(+:s)
+    for (int i = 0; i < n; ++i) {
+        s += a[i];
+    }
+    return s;
+}
+
+// CHECK-LABEL: hl.func @count
+// CHECK: omp.parallel {
+// CHECK:   omp.critical {
+// CHECK:     hl.post.inc
+// CHECK:     omp.terminator
+// CHECK:   omp.terminator
+void count(int *c) {
+    #pragma omp parallel
+    {
+        #pragma omp critical
+        (*c)++;
+    }
+}
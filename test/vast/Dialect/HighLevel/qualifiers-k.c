@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK: hl.var "cvc" {{.*}}: !hl.lvalue<!hl.char< unsigned, const, volatile >>
+const volatile unsigned char cvc;
+
+// CHECK: hl.var "vd" {{.*}}: !hl.lvalue<!hl.double< volatile >>
+volatile double vd;
+
+// CHECK: hl.var "cb" {{.*}}: !hl.lvalue<!hl.bool< const >>
+const _Bool cb = 0;
+
+// CHECK: hl.var "rp" {{.*}}: !hl.lvalue<!hl.ptr<!hl.void< const, volatile >,  restrict >>
+const volatile void * restrict rp;
+
+// CHECK: hl.var "plain" {{.*}}: !hl.lvalue<!hl.long>
+long plain;
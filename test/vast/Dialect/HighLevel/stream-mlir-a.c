@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-mlir %s -o %t.mlir
+// RUN: %file-check --input-file=%t.mlir %s
+// RUN: %vast-opt %t.mlir -o /dev/null
+
+// CHECK: module
+// CHECK: hl.struct "point"
+struct point { int x, y; };
+
+// CHECK: hl.func @sum
+// CHECK: hl.return
+int sum(struct point p) { return p.x + p.y; }
+
+int forward_decl(int a);
+
+// CHECK: hl.func @main
+// CHECK: hl.call @forward_decl
+int main() {
+    struct point p = { 1, 2 };
+    return forward_decl(sum(p));
+}
+
+// CHECK: hl.func @forward_decl
+// CHECK: hl.return
+int forward_decl(int a) { return a; }
+
+// A redeclaration of a streamed definition is not printed again.
+// CHECK-NOT: hl.func @sum
+int sum(struct point p);
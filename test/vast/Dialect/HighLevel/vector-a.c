@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+typedef int v4si __attribute__((vector_size(16)));
+typedef float v4sf __attribute__((ext_vector_type(4)));
+
+// CHECK-LABEL: hl.func @add
+// CHECK: hl.add {{%[0-9]+}}, {{%[0-9]+}} : (!hl.elaborated<!hl.typedef<"v4si">>, !hl.elaborated<!hl.typedef<"v4si">>) -> !hl.elaborated<!hl.typedef<"v4si">>
+v4si add(v4si a, v4si b) { return a + b; }
+
+// CHECK-LABEL: hl.func @scale
+// CHECK: hl.implicit_cast {{%[0-9]+}} VectorSplat
+// CHECK: hl.fmul
+v4sf scale(v4sf a, float s) { return a * s; }
+
+// CHECK-LABEL: hl.func @less
+// CHECK: hl.cmp slt
+v4si less(v4si a, v4si b) { return a < b; }
+
+// CHECK-LABEL: hl.func @flip
+// CHECK: hl.vector.shuffle {{%[0-9]+}}, {{%[0-9]+}} array<i32: 3, 2, 1, 0>
+v4si flip(v4si a) { return __builtin_shufflevector(a, a, 3, 2, 1, 0); }
+
+// CHECK-LABEL: hl.func @lane
+// CHECK: [[ADDR:%[0-9]+]] = hl.addressof {{%[0-9]+}}
+// CHECK: [[PTR:%[0-9]+]] = hl.implicit_cast [[ADDR]] BitCast
+// CHECK: hl.subscript [[PTR]]
+int lane(v4si a, int i) { return a[i]; }
+
+// CHECK-LABEL: hl.func @sum_lane
+// CHECK: hl.vector.extract {{%[0-9]+}}[{{%[0-9]+}}]
+int sum_lane(v4si a, v4si b) { return (a + b)[0]; }
@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.serial.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-verify-threads=4 %s -o %t.threads.mlir
+// RUN: diff %t.serial.mlir %t.threads.mlir
+// RUN: %file-check --input-file=%t.threads.mlir %s
+
+struct point { int x, y; };
+
+// CHECK: hl.func @sum
+int sum(struct point p) { return p.x + p.y; }
+
+int forward_decl(int a);
+
+// CHECK: hl.func @main
+int main()
+{
+    struct point p = { 1, 2 };
+    // CHECK: hl.call @forward_decl
+    return forward_decl(sum(p));
+}
+
+// CHECK: hl.func @forward_decl
+int forward_decl(int a) { return a; }
@@ -1,11 +1,10 @@
 // RUN: %vast-front %s -vast-emit-mlir=hl -o - | %file-check %s
 // RUN: %vast-front %s -vast-emit-mlir=hl -o - > %t && %vast-opt %t | diff -B %t -
 
-int load(int* p) {
+int *fetch_add(int **p) {
     // CHECK: unsup.stmt "AtomicExpr"
     // CHECK: hl.ref %arg0
     // CHECK: hl.const #core.integer<5>
-    int q = __atomic_load_n (p, __ATOMIC_SEQ_CST);
+    int *q = __atomic_fetch_add (p, 1, __ATOMIC_SEQ_CST);
     return q;
 }
-
@@ -0,0 +1,17 @@
+// RUN: %vast-front %s -vast-emit-mlir=hl -vast-elide-unsupported -o - 2> %t.report | %file-check %s
+// RUN: %file-check %s -input-file=%t.report -check-prefix=REPORT
+
+// CHECK: hl.func @_Z9fetch_addPPi
+// CHECK-NEXT: unsup.stmt "elided"
+// CHECK-NOT: unsup.stmt "AtomicExpr"
+int *fetch_add(int **p) {
+    int *q = __atomic_fetch_add (p, 1, __ATOMIC_SEQ_CST);
+    return q;
+}
+
+// CHECK: hl.func @_Z6plain
+// CHECK: hl.return
+int plain(int a) { return a; }
+
+// REPORT: vast elided 1 unsupported function bodies
+// REPORT: 1  AtomicExpr
@@ -0,0 +1,34 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-canonicalize | %file-check %s
+
+#define FLAGS ((1 << 4) | (1 << 2) | 3)
+
+// CHECK-LABEL: hl.func @flags
+// CHECK-NOT: hl.bin.shl
+// CHECK-NOT: hl.bin.or
+// CHECK: hl.const #core.integer<23> : !hl.int
+int flags() { return FLAGS; }
+
+// CHECK-LABEL: hl.func @round_trip
+// CHECK-NOT: hl.implicit_cast {{.*}} IntegralCast
+int round_trip(int x) { return (int)(long)x; }
+
+// CHECK-LABEL: hl.func @deref
+// CHECK-NOT: hl.deref
+int deref(int x) { return *&x; }
+
+// CHECK-LABEL: hl.func @branch
+// CHECK-NOT: hl.if
+// CHECK: core.scope
+// CHECK: hl.const #core.integer<1>
+// CHECK-NOT: hl.const #core.integer<2>
+int branch() {
+    if (sizeof(long) == 8) {
+        return 1;
+    } else {
+        return 2;
+    }
+}
+
+// CHECK-LABEL: hl.func @division
+// CHECK: hl.sdiv
+int division() { return 1 / 0; }
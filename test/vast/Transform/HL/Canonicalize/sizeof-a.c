@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-canonicalize | %file-check %s
+
+struct pair { int a; char b; };
+
+unsigned long sizes(int n) {
+    // CHECK-NOT: hl.sizeof.type
+    // CHECK: hl.const #core.integer<8> : !hl.long< unsigned >
+    unsigned long l = sizeof(long);
+
+    // CHECK: hl.const #core.integer<40> : !hl.long< unsigned >
+    int a[10];
+    unsigned long s = sizeof a;
+
+    // CHECK: hl.const #core.integer<4> : !hl.long< unsigned >
+    unsigned long p = _Alignof(struct pair);
+
+    // CHECK: hl.sizeof.expr
+    int vla[n];
+    return sizeof vla;
+}
@@ -0,0 +1,29 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-constant-globals | %file-check %s
+
+static int verbose = 0;
+static int level = 3;
+static int disabled;
+static int counter = 0;
+int exported = 1;
+
+void log_line(int);
+
+// CHECK-LABEL: hl.func @run
+void run(int x) {
+    // CHECK-NOT: hl.globref "verbose"
+    // CHECK: hl.if
+    // CHECK: hl.const #core.integer<0>
+    if (verbose)
+        log_line(x);
+
+    // CHECK: hl.const #core.integer<3>
+    // CHECK-NOT: hl.globref "disabled"
+    // CHECK: hl.const #core.integer<0>
+    log_line(level + disabled);
+
+    // CHECK: hl.globref "counter"
+    ++counter;
+
+    // CHECK: hl.globref "exported"
+    log_line(exported);
+}
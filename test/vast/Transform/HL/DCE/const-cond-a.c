@@ -0,0 +1,58 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce | %file-check %s
+
+int f(void);
+
+// CHECK-LABEL: hl.func @disabled
+// CHECK-NOT: hl.if
+// CHECK-NOT: hl.call @f
+// CHECK: hl.return
+int disabled()
+{
+    if (0) {
+        f();
+    }
+    return 0;
+}
+
+// CHECK-LABEL: hl.func @enabled
+// CHECK-NOT: hl.if
+// CHECK: core.scope
+// CHECK: hl.call @f
+int enabled()
+{
+    if (1) {
+        f();
+    }
+    return 0;
+}
+
+// CHECK-LABEL: hl.func @never
+// CHECK-NOT: hl.while
+// CHECK-NOT: hl.for
+// CHECK: hl.return
+int never()
+{
+    while (0) { f(); }
+    for (;0;) { f(); }
+    return 0;
+}
+
+// CHECK-LABEL: hl.func @ternary
+// CHECK-NOT: hl.cond
+// CHECK: hl.call @f
+int ternary()
+{
+    return 1 ? f() : 0;
+}
+
+// CHECK-LABEL: hl.func @labels
+// CHECK: hl.if
+int labels()
+{
+    goto inside;
+    if (0) {
+    inside:
+        f();
+    }
+    return 0;
+}
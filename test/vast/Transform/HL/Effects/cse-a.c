@@ -0,0 +1,16 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --cse | %file-check %s
+
+// CHECK-LABEL: hl.func @square
+// CHECK: hl.add
+// CHECK-NOT: hl.add
+// CHECK: hl.mul
+int square(int a, int b) {
+    return (a + b) * (a + b);
+}
+
+// Loads of volatile objects are kept.
+// CHECK-LABEL: hl.func @twice
+// CHECK-COUNT-2: LValueToRValue : !hl.lvalue<!hl.int<{{ *}}volatile{{ *}}>>
+int twice(volatile int *p) {
+    return *p + *p;
+}
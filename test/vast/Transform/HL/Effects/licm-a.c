@@ -0,0 +1,10 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --loop-invariant-code-motion | %file-check %s
+
+// CHECK-LABEL: hl.func @fill
+// CHECK: hl.const #core.integer<3>
+// CHECK: hl.for
+void fill(int *a, int n, int k) {
+    for (int i = 0; i < n; ++i) {
+        a[i] = k * 3;
+    }
+}
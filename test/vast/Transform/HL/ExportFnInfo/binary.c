@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info="format=binary o=%t.bin" -o /dev/null
+// RUN: %file-check %s < %t.bin
+
+struct node { struct node *next; int value; };
+
+// CHECK: VASTFNFO
+// CHECK: walk
+// CHECK: node
+int walk(struct node *n) { return n->value; }
+
+void reset(struct node *n, int value) { n->value = value; }
@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info -o /dev/null | %file-check %s
+
+struct s { char c; int i; };
+
+// CHECK: "align": 32
+// CHECK: "offset": 0
+// CHECK: "offset": 32
+// CHECK: "name": "s"
+// CHECK: "padding": 24
+// CHECK: "size": 64
+void f(struct s *p) {}
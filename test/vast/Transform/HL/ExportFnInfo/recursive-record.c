@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info -o /dev/null | %file-check %s
+
+struct node { struct node *next; int value; };
+
+// CHECK: "reset": {
+// CHECK: "element_type": {
+// CHECK: "fields": [
+// CHECK: "element_type": {
+// CHECK-NOT: "fields"
+// CHECK: "name": "node"
+// CHECK: "offset": 0
+// CHECK: "offset": 64
+// CHECK: "name": "node"
+// CHECK: "walk": {
+void reset(struct node *n, int value) { n->value = value; }
+
+int walk(struct node *n) { return n->value; }
@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-false-sharing 2>&1 >/dev/null | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-warn-false-sharing %s -o /dev/null 2>&1 | %file-check %s
+
+int pthread_mutex_lock(void *mutex);
+
+struct stats { long hits; long misses; };
+
+struct padded { long hits; char pad[56]; long misses; };
+
+struct counter { long value; };
+
+struct counter per_thread[8];
+
+// CHECK-DAG: warning: field 'hits' of 'stats' is written concurrently and shares cache line 0 with other written fields (false sharing)
+// CHECK-DAG: warning: elements of 'per_thread' (8 bytes of 'counter') are written concurrently and share 64 byte cache lines (false sharing)
+// CHECK-NOT: of 'padded'
+void record(struct stats *s, struct padded *p, void *mutex, int id) {
+    pthread_mutex_lock(mutex);
+    s->hits++;
+    s->misses += 1;
+    p->hits++;
+    p->misses++;
+    per_thread[id].value++;
+}
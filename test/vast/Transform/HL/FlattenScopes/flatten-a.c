@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-flatten-scopes | %file-check %s
+
+void callee(int);
+
+// CHECK: hl.func @flatten
+void flatten(int a) {
+    // CHECK-NOT: core.scope
+    // CHECK: hl.call @callee
+    {
+        {
+            callee(a);
+        }
+    }
+    // CHECK: hl.call @callee
+    {
+        callee(a);
+    }
+    // CHECK: hl.return
+}
+
+// CHECK: hl.func @keep
+void keep(int a) {
+    // CHECK: core.scope
+    // CHECK-NEXT: hl.var "x"
+    {
+        int x = a;
+        callee(x);
+    }
+    callee(a);
+}
@@ -0,0 +1,52 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-function-attrs | %file-check %s
+
+int counter;
+
+void unknown(int *ptr);
+
+// CHECK-LABEL: hl.func @square
+// CHECK-SAME: const = #hl.const
+// CHECK-SAME: nothrow = #hl.nothrow
+int square(int x) { return x * x; }
+
+// CHECK-LABEL: hl.func @sum
+// CHECK-SAME: llvm.nocapture
+// CHECK-SAME: llvm.readonly
+// CHECK-SAME: pure = #hl.pure
+int sum(const int *values, int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i)
+        total += values[i] + square(i);
+    return total;
+}
+
+// CHECK-LABEL: hl.func @fill
+// CHECK-SAME: llvm.nocapture
+// CHECK-SAME: llvm.writeonly
+// CHECK-NOT: pure
+// CHECK-SAME: nothrow = #hl.nothrow
+void fill(int *values, int n) {
+    for (int i = 0; i < n; ++i)
+        values[i] = i;
+}
+
+// CHECK-LABEL: hl.func @get
+// CHECK-SAME: pure = #hl.pure
+int get(void) { return counter; }
+
+// Mutual recursion is summarized as a whole.
+// CHECK-LABEL: hl.func @odd
+// CHECK-SAME: const = #hl.const
+int even(int n);
+int odd(int n) { return n == 0 ? 0 : even(n - 1); }
+
+// CHECK-LABEL: hl.func @even
+// CHECK-SAME: const = #hl.const
+int even(int n) { return n == 0 ? 1 : odd(n - 1); }
+
+// CHECK-LABEL: hl.func @escape
+// CHECK-NOT: llvm.nocapture
+// CHECK-NOT: pure
+// CHECK-NOT: nothrow
+// CHECK: hl.call @unknown
+void escape(int *ptr) { unknown(ptr); }
@@ -0,0 +1,71 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-canonicalize --vast-hl-heap-to-stack | %file-check %s
+
+void *malloc(unsigned long size);
+void *calloc(unsigned long count, unsigned long size);
+void free(void *ptr);
+
+void sink(int *ptr);
+
+// CHECK-LABEL: hl.func @local
+// CHECK: [[S:%[0-9]+]] = hl.var "buf.stack" {hl.alignment = #hl.alignment<16>}{{.*}} : !hl.lvalue<!hl.array<64, !hl.char>>
+// CHECK: hl.var "buf" : !hl.lvalue<!hl.ptr<!hl.int>>
+// CHECK: hl.ref [[S]]
+// CHECK: ArrayToPointerDecay
+// CHECK-NOT: hl.call @malloc
+// CHECK-NOT: hl.call @free
+// CHECK: hl.return
+int local(int n) {
+    int *buf = malloc(16 * sizeof(int));
+    if (!buf)
+        return -1;
+    for (int i = 0; i < 16; ++i)
+        buf[i] = i * n;
+    int sum = buf[3] + buf[7];
+    free(buf);
+    return sum;
+}
+
+// CHECK-LABEL: hl.func @zeroed
+// CHECK: hl.var "buf.stack" {hl.alignment = #hl.alignment<16>}{{.*}} : !hl.lvalue<!hl.array<32, !hl.char>>
+// CHECK: hl.builtin.memset
+// CHECK-NOT: hl.call @calloc
+// CHECK-NOT: hl.call @free
+// CHECK: hl.return
+int zeroed(void) {
+    int *buf = calloc(8, sizeof(int));
+    int first = buf[0];
+    free(buf);
+    return first;
+}
+
+// CHECK-LABEL: hl.func @escaping
+// CHECK-NOT: hl.var "buf.stack"
+// CHECK: hl.call @malloc
+// CHECK: hl.call @free
+void escaping(void) {
+    int *buf = malloc(16);
+    sink(buf);
+    free(buf);
+}
+
+// CHECK-LABEL: hl.func @leaking
+// CHECK-NOT: hl.var "buf.stack"
+// CHECK: hl.call @malloc
+// CHECK: hl.call @free
+int leaking(int n) {
+    int *buf = malloc(16);
+    buf[0] = n;
+    if (n)
+        return buf[0];
+    free(buf);
+    return 0;
+}
+
+// CHECK-LABEL: hl.func @large
+// CHECK-NOT: hl.var "buf.stack"
+// CHECK: hl.call @malloc
+void large(void) {
+    char *buf = malloc(4096);
+    buf[0] = 0;
+    free(buf);
+}
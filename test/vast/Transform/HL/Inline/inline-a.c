@@ -0,0 +1,37 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline | %file-check %s
+
+static int twice(int x) { return x + x; }
+
+__attribute__((noinline)) static int thrice(int x) { return x + x + x; }
+
+int fact(int n) { if (n <= 1) return 1; return n * fact(n - 1); }
+
+// CHECK-LABEL: hl.func @caller
+// CHECK: hl.var "twice.arg0" : !hl.lvalue<!hl.int>
+// CHECK-NOT: hl.call @twice
+// CHECK: hl.call @thrice
+// CHECK: hl.call @fact
+int caller(int v) {
+    int a;
+    a = twice(v);
+    a = a + thrice(v);
+    return a + fact(v);
+}
+
+int big(int x) {
+    x = x * 3 + 1; x = x * 3 + 1; x = x * 3 + 1; x = x * 3 + 1; x = x * 3 + 1;
+    return x;
+}
+
+// CHECK-LABEL: hl.func @not_flat
+// CHECK: hl.call @big
+int not_flat(int v) { return big(v); }
+
+// CHECK-LABEL: hl.func @flat
+// CHECK: hl.var "big.arg0"
+// CHECK-NOT: hl.call @big
+__attribute__((flatten)) int flat(int v) {
+    int a;
+    a = big(v);
+    return a;
+}
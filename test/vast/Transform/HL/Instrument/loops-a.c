@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-instrument="loops=true calls=sink" | %file-check %s
+
+// CHECK: hl.var @__vast_prof_data
+// CHECK-SAME: "vast_prof"
+
+void sink(int v);
+
+void fn(int n)
+{
+    // CHECK: hl.func @fn
+    // CHECK: hl.globref @__vast_prof_data
+    // CHECK: hl.pre.inc
+    // CHECK: hl.for
+    for (int i = 0; i < n; ++i)
+    {
+        // CHECK: hl.pre.inc
+        // CHECK: hl.call @sink
+        sink(i);
+    }
+}
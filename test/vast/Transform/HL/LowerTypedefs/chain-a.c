@@ -0,0 +1,11 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-typedefs | %file-check %s
+
+typedef int A;
+typedef A B;
+typedef B *C;
+typedef C D;
+
+// CHECK: hl.func @fn ({{%arg[0-9]+}}: !hl.lvalue<!hl.ptr<!hl.int>>) -> !hl.ptr<!hl.ptr<!hl.int>>
+D *fn(D x) { return 0; }
+
+// CHECK-NOT: hl.typedef
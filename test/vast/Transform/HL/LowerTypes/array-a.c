@@ -3,7 +3,7 @@
 // CHECK: hl.var "ai" : !hl.lvalue<memref<10xsi32>>
 int ai[10];
 
-// CHECK: hl.var "aci" : !hl.lvalue<memref<5xsi32>>
+// CHECK: hl.var "aci" {hl.constant_storage = #hl.constant_storage} : !hl.lvalue<memref<5xsi32>>
 const int aci[5];
 
 // CHECK: hl.var "avi" : !hl.lvalue<memref<5xsi32>>
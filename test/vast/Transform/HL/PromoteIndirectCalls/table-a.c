@@ -0,0 +1,43 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-promote-indirect-calls | %file-check %s
+
+struct ops {
+    int (*apply)(int);
+    void (*reset)(void);
+};
+
+int twice(int x) { return 2 * x; }
+int thrice(int x) { return 3 * x; }
+void nop(void) {}
+
+struct ops fast = { twice, nop };
+struct ops slow = { .apply = thrice, .reset = nop };
+
+// CHECK-LABEL: hl.func @run
+int run(struct ops *ops, int x) {
+    // CHECK: hl.if
+    // CHECK: hl.funcref @nop
+    // CHECK: hl.cmp eq
+    // CHECK: hl.call @nop
+    // CHECK: hl.indirect_call
+    ops->reset();
+
+    // CHECK: hl.var "icp.result"
+    // CHECK: hl.if
+    // CHECK: hl.funcref @twice
+    // CHECK: hl.call @twice
+    // CHECK: hl.if
+    // CHECK: hl.funcref @thrice
+    // CHECK: hl.call @thrice
+    // CHECK: hl.indirect_call
+    int y;
+    y = ops->apply(x);
+
+    // CHECK: hl.var "z"
+    // CHECK: hl.cond
+    // CHECK: hl.call @twice
+    // CHECK: hl.cond
+    // CHECK: hl.call @thrice
+    // CHECK: hl.indirect_call
+    int z = ops->apply(y);
+    return z;
+}
@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-symbol-dce | %file-check %s
+
+// CHECK-NOT: hl.typedef "unused_t"
+typedef int unused_t;
+
+// CHECK-NOT: hl.struct "unused"
+struct unused { int x; };
+
+// CHECK: hl.struct "used"
+struct used { int y; };
+
+// CHECK-NOT: hl.var "unused_global"
+static int unused_global;
+
+// CHECK: hl.var "used_global"
+static int used_global;
+
+// CHECK-NOT: hl.func @unused_helper
+static inline int unused_helper(void) { return 0; }
+
+// CHECK: hl.func @used_helper
+static inline int used_helper(struct used *u) { return u->y + used_global; }
+
+// CHECK: hl.func @entry
+int entry(struct used *u) { return used_helper(u); }
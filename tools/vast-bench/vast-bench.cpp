@@ -0,0 +1,484 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <benchmark/benchmark.h>
+
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Tooling/Tooling.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <mlir/InitAllDialects.h>
+#include <mlir/Parser/Parser.h>
+#include <mlir/Pass/PassManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/CodeGen/CodeGenDriver.hpp"
+#include "vast/CodeGen/CodeGenMeta.hpp"
+#include "vast/CodeGen/Mangler.hpp"
+#include "vast/Conversion/Passes.hpp"
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::bench
+{
+    //
+    // Translation unit measured by the benchmarks, either generated or read
+    // from a file given on the command line.
+    //
+    struct input
+    {
+        std::string name;
+        std::string path;
+        std::string source;
+    };
+
+    //
+    // Records with typedefs, loops over linked lists and a function that calls
+    // all the others, `size` of each. Every phase grows linearly with the size.
+    //
+    std::string synthetic_source(unsigned size) {
+        std::string source;
+        llvm::raw_string_ostream os(source);
+
+        for (unsigned i = 0; i < size; ++i) {
+            os << llvm::formatv(
+                "typedef struct node_{0} {{ int value; struct node_{0} *next; double weight[4]; } node_{0}_t;\n"
+                "static int fold_{0}(node_{0}_t *list, int bound) {{\n"
+                "    int sum = 0;\n"
+                "    for (int i = 0; i < bound && list; ++i, list = list->next) {{\n"
+                "        if (list->value % 2)\n"
+                "            sum += list->value;\n"
+                "        else\n"
+                "            sum -= (int)list->weight[i % 4];\n"
+                "    }\n"
+                "    return sum;\n"
+                "}\n", i
+            );
+        }
+
+        os << "int entry(void) {\n    int total = 0;\n";
+        for (unsigned i = 0; i < size; ++i) {
+            os << llvm::formatv(
+                "    node_{0}_t n{0} = {{ {0} };\n    total += fold_{0}(&n{0}, {0});\n", i
+            );
+        }
+        os << "    return total;\n}\n";
+
+        return os.str();
+    }
+
+    //
+    // Declarations, statements and types of a translation unit, collected
+    // once, so that the benchmarks of a codegen component measure only that
+    // component.
+    //
+    struct ast_index : clang::RecursiveASTVisitor< ast_index >
+    {
+        std::vector< const clang::Decl * > decls;
+        std::vector< const clang::Stmt * > stmts;
+        std::vector< clang::QualType > types;
+        std::vector< clang::GlobalDecl > globals;
+
+        explicit ast_index(acontext_t &actx) : actx(actx) {
+            TraverseDecl(actx.getTranslationUnitDecl());
+        }
+
+        bool VisitDecl(clang::Decl *decl) {
+            if (decl->isImplicit() || clang::isa< clang::TranslationUnitDecl >(decl)) {
+                return true;
+            }
+
+            decls.push_back(decl);
+            if (decl->getDeclContext()->isDependentContext()) {
+                return true;
+            }
+
+            if (auto value = clang::dyn_cast< clang::ValueDecl >(decl)) {
+                add_type(value->getType());
+            } else if (auto type = clang::dyn_cast< clang::TypeDecl >(decl)) {
+                add_type(actx.getTypeDeclType(type));
+            }
+
+            // Constructors and destructors are mangled per their variants.
+            if (clang::isa< clang::CXXConstructorDecl, clang::CXXDestructorDecl >(decl)) {
+                return true;
+            }
+
+            if (auto fn = clang::dyn_cast< clang::FunctionDecl >(decl)) {
+                if (!fn->isDependentContext()) {
+                    globals.emplace_back(fn);
+                }
+            } else if (auto var = clang::dyn_cast< clang::VarDecl >(decl)) {
+                if (var->hasGlobalStorage() && !var->isStaticLocal()) {
+                    globals.emplace_back(var);
+                }
+            }
+
+            return true;
+        }
+
+        bool VisitStmt(clang::Stmt *stmt) {
+            stmts.push_back(stmt);
+            return true;
+        }
+
+      private:
+        void add_type(clang::QualType type) {
+            if (!type.isNull() && !type->isDependentType()) {
+                types.push_back(type);
+            }
+        }
+
+        acontext_t &actx;
+    };
+
+    //
+    // Stage of the lowering of an emitted module. Each stage is measured on
+    // the output of the stages before it.
+    //
+    struct stage
+    {
+        std::string name;
+        std::function< void(mlir::PassManager &) > populate;
+        // Side stages are measured on the input of the next stage, but their
+        // output is not lowered further.
+        bool side = false;
+    };
+
+    // Mirrors `lower_hl_module` with the ABI passes aside.
+    std::vector< stage > lowering_stages() {
+        return {
+            { "vast-hl-inline", [] (auto &pm) { pm.addPass(hl::createHLInlinePass(true)); } },
+            { "vast-hl-symbol-dce", [] (auto &pm) { pm.addPass(hl::createHLSymbolDCEPass()); } },
+            { "vast-hl-canonicalize", [] (auto &pm) { pm.addPass(hl::createHLCanonicalizePass()); } },
+            { "vast-hl-lower-types", [] (auto &pm) { pm.addPass(hl::createHLLowerTypesPass()); } },
+            { "vast-hl-dce", [] (auto &pm) { pm.template nest< hl::FuncOp >().addPass(hl::createDCEPass()); } },
+            { "vast-hl-lower-typedefs", [] (auto &pm) { pm.addPass(hl::createLowerTypeDefsPass()); } },
+            { "vast-hl-splice-trailing-scopes",
+                [] (auto &pm) { pm.addPass(hl::createSpliceTrailingScopes()); }, /* side */ true },
+            { "vast-emit-abi", [] (auto &pm) { pm.addPass(createEmitABIPass()); }, /* side */ true },
+            { "vast-hl-to-ll-func", [] (auto &pm) { pm.addPass(createHLToLLFuncPass()); } },
+            { "vast-hl-to-ll", [] (auto &pm) { pm.template nest< ll::FuncOp >().addPass(createHLToLLPass()); } },
+            { "vast-irs-to-llvm", [] (auto &pm) { pm.addPass(createIRsToLLVMPass()); } },
+            { "vast-core-to-llvm", [] (auto &pm) { pm.addPass(createCoreToLLVMPass()); } },
+        };
+    }
+
+    bool is_cxx_source(string_ref path) {
+        auto ext = llvm::sys::path::extension(path);
+        return ext == ".cpp" || ext == ".cc" || ext == ".cxx" || ext == ".hpp";
+    }
+
+    //
+    // Input with its AST. The emitted module and the inputs of each stage are
+    // prepared on the first benchmark of the input that needs them.
+    //
+    struct prepared
+    {
+        std::unique_ptr< clang::ASTUnit > unit;
+        std::optional< ast_index > index;
+
+        bool lowered_stages = false;
+        llvm::StringMap< owning_module_ref > stage_inputs;
+        owning_module_ref lowered;
+
+        // The emitted hl module and its textual dump.
+        owning_module_ref emitted;
+        std::string dump;
+    };
+
+    struct suite
+    {
+        suite() {
+            mlir::DialectRegistry registry;
+            vast::registerAllDialects(registry);
+            mlir::registerAllDialects(registry);
+            target::llvmir::register_vast_to_llvm_ir(registry);
+            mctx.appendDialectRegistry(registry);
+            mctx.loadAllAvailableDialects();
+            // Nested passes run on one thread, so that the results do not
+            // depend on the cores of the machine.
+            mctx.disableMultithreading();
+        }
+
+        // Fails if the input does not compile.
+        logical_result add(input in);
+
+        void register_benchmarks();
+
+      private:
+        prepared &prepare(std::size_t id);
+
+        owning_module_ref emit(clang::ASTUnit &unit);
+
+        void register_benchmark(std::string name, std::size_t id, auto &&run) {
+            benchmark::RegisterBenchmark(
+                (name + "/" + inputs[id].name).c_str(),
+                [this, id, run] (benchmark::State &state) { run(state, prepare(id)); }
+            )->UseManualTime()->Unit(benchmark::kMicrosecond);
+        }
+
+        mcontext_t mctx;
+        std::vector< input > inputs;
+        std::vector< prepared > states;
+        std::vector< stage > stages = lowering_stages();
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    // Runs `work` in a timed region of the current iteration.
+    void timed(benchmark::State &state, auto &&work) {
+        auto start = clock::now();
+        work();
+        state.SetIterationTime(std::chrono::duration< double >(clock::now() - start).count());
+    }
+
+    owning_module_ref suite::emit(clang::ASTUnit &unit) {
+        auto &actx = unit.getASTContext();
+
+        clang::CodeGenOptions codegen_opts;
+        clang::FrontendOptions front_opts;
+        cc::action_options opts = {
+            .headers = unit.getHeaderSearchOpts(),
+            .codegen = codegen_opts,
+            .target  = actx.getTargetInfo().getTargetOpts(),
+            .lang    = actx.getLangOpts(),
+            .front   = front_opts,
+            .diags   = unit.getDiagnostics(),
+            .vfs     = unit.getFileManager().getVirtualFileSystem(),
+            .pp      = unit.getPreprocessor().getPreprocessorOpts()
+        };
+        cc::vast_args vargs;
+
+        auto lang = actx.getLangOpts().CPlusPlus ? cg::source_language::CXX : cg::source_language::C;
+        cg::codegen_context cgctx(mctx, actx, lang);
+        cg::codegen_driver driver(cgctx, opts, vargs);
+
+        for (auto decl : actx.getTranslationUnitDecl()->decls()) {
+            if (!decl->isImplicit()) {
+                driver.handle_top_level_decl(decl);
+            }
+        }
+
+        driver.finalize();
+        return std::move(cgctx.mod);
+    }
+
+    logical_result suite::add(input in) {
+        std::vector< std::string > args = { is_cxx_source(in.path) ? "-std=c++17" : "-std=c17" };
+
+        prepared state;
+        state.unit = clang::tooling::buildASTFromCodeWithArgs(in.source, args, in.path, "vast-bench");
+        if (!state.unit || state.unit->getDiagnostics().hasErrorOccurred()) {
+            return mlir::failure();
+        }
+
+        state.index.emplace(state.unit->getASTContext());
+        inputs.push_back(std::move(in));
+        states.push_back(std::move(state));
+        return mlir::success();
+    }
+
+    prepared &suite::prepare(std::size_t id) {
+        auto &state = states[id];
+        if (state.lowered_stages) {
+            return state;
+        }
+
+        auto mod = emit(*state.unit);
+        state.emitted = owning_module_ref(mod->clone());
+        llvm::raw_string_ostream(state.dump) << *state.emitted;
+
+        for (const auto &st : stages) {
+            state.stage_inputs[st.name] = owning_module_ref(mod->clone());
+            if (st.side) {
+                continue;
+            }
+
+            mlir::PassManager pm(&mctx);
+            st.populate(pm);
+            VAST_CHECK(mlir::succeeded(pm.run(*mod)), "vast-bench: {0} failed on {1}", st.name, inputs[id].path);
+        }
+
+        state.lowered = std::move(mod);
+        state.lowered_stages = true;
+        return state;
+    }
+
+    void suite::register_benchmarks() {
+        for (std::size_t id = 0; id < inputs.size(); ++id) {
+            register_benchmark("codegen", id, [this] (benchmark::State &state, prepared &p) {
+                for (auto _ : state) {
+                    owning_module_ref mod;
+                    timed(state, [&] { mod = emit(*p.unit); });
+                }
+            });
+
+            register_benchmark("types", id, [this] (benchmark::State &state, prepared &p) {
+                auto &actx = p.unit->getASTContext();
+                for (auto _ : state) {
+                    // Fresh context, conversions are not cached across iterations.
+                    cg::codegen_context cgctx(mctx, actx, cg::source_language::C);
+                    cg::default_meta_gen meta(&actx, &mctx);
+                    cg::default_codegen gen(cgctx, meta);
+                    timed(state, [&] {
+                        for (auto type : p.index->types) {
+                            benchmark::DoNotOptimize(gen.convert(type));
+                        }
+                    });
+                }
+                state.counters["types"] = double(p.index->types.size());
+            });
+
+            register_benchmark("meta", id, [this] (benchmark::State &state, prepared &p) {
+                auto &actx = p.unit->getASTContext();
+                for (auto _ : state) {
+                    cg::default_meta_gen meta(&actx, &mctx);
+                    timed(state, [&] {
+                        for (auto decl : p.index->decls) {
+                            benchmark::DoNotOptimize(meta.location(decl));
+                        }
+
+                        for (auto stmt : p.index->stmts) {
+                            if (auto expr = clang::dyn_cast< clang::Expr >(stmt)) {
+                                benchmark::DoNotOptimize(meta.location(expr));
+                            } else {
+                                benchmark::DoNotOptimize(meta.location(stmt));
+                            }
+                        }
+                    });
+                }
+                state.counters["locations"] = double(p.index->decls.size() + p.index->stmts.size());
+            });
+
+            register_benchmark("mangle", id, [] (benchmark::State &state, prepared &p) {
+                auto &actx = p.unit->getASTContext();
+                const auto &target = actx.getTargetInfo();
+                for (auto _ : state) {
+                    cg::CodeGenMangler mangler(actx.createMangleContext());
+                    timed(state, [&] {
+                        for (auto decl : p.index->globals) {
+                            benchmark::DoNotOptimize(mangler.get_mangled_name(decl, target, ""));
+                        }
+                    });
+                }
+                state.counters["names"] = double(p.index->globals.size());
+            });
+
+            register_benchmark("print", id, [] (benchmark::State &state, prepared &p) {
+                for (auto _ : state) {
+                    std::string out;
+                    llvm::raw_string_ostream os(out);
+                    timed(state, [&] { p.emitted->print(os); });
+                    benchmark::DoNotOptimize(out);
+                }
+                state.SetBytesProcessed(int64_t(state.iterations() * p.dump.size()));
+            });
+
+            register_benchmark("parse", id, [this] (benchmark::State &state, prepared &p) {
+                for (auto _ : state) {
+                    owning_module_ref mod;
+                    timed(state, [&] {
+                        mod = mlir::parseSourceString< vast_module >(p.dump, &mctx);
+                    });
+                    VAST_CHECK(mod, "vast-bench: cannot parse the hl dump");
+                }
+                state.SetBytesProcessed(int64_t(state.iterations() * p.dump.size()));
+            });
+
+            for (const auto &st : stages) {
+                register_benchmark("pass/" + st.name, id, [this, st] (benchmark::State &state, prepared &p) {
+                    const auto &before = p.stage_inputs[st.name];
+                    for (auto _ : state) {
+                        owning_module_ref mod(before->clone());
+                        mlir::PassManager pm(&mctx);
+                        st.populate(pm);
+                        timed(state, [&] {
+                            VAST_CHECK(mlir::succeeded(pm.run(*mod)), "vast-bench: {0} failed", st.name);
+                        });
+                    }
+                });
+            }
+
+            register_benchmark("translate", id, [] (benchmark::State &state, prepared &p) {
+                for (auto _ : state) {
+                    owning_module_ref mod(p.lowered->clone());
+                    llvm::LLVMContext llvm_ctx;
+                    std::unique_ptr< llvm::Module > result;
+                    timed(state, [&] { result = target::llvmir::translate(*mod, llvm_ctx); });
+                    VAST_CHECK(result, "vast-bench: translation to llvm failed");
+                }
+            });
+        }
+    }
+
+} // namespace vast::bench
+
+int main(int argc, char **argv) {
+    // Removes the benchmark flags, the rest are input files.
+    benchmark::Initialize(&argc, argv);
+
+    vast::bench::suite suite;
+    for (unsigned size : { 16, 64, 256 }) {
+        auto added = suite.add({
+            .name   = "synthetic/" + std::to_string(size),
+            .path   = "synthetic.c",
+            .source = vast::bench::synthetic_source(size)
+        });
+        VAST_CHECK(mlir::succeeded(added), "vast-bench: synthetic input does not compile");
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        vast::string_ref arg = argv[i];
+        if (arg.starts_with("-")) {
+            llvm::errs() << "vast-bench: unknown option " << arg << "\n";
+            return 1;
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(arg);
+        if (!buffer) {
+            llvm::errs() << "vast-bench: cannot read " << arg << ": " << buffer.getError().message() << "\n";
+            return 1;
+        }
+
+        llvm::SmallString< 256 > path(arg);
+        llvm::sys::fs::make_absolute(path);
+        auto added = suite.add({
+            .name   = llvm::sys::path::filename(arg).str(),
+            .path   = path.str().str(),
+            .source = (*buffer)->getBuffer().str()
+        });
+
+        if (mlir::failed(added)) {
+            llvm::errs() << "vast-bench: " << arg << " does not compile\n";
+            return 1;
+        }
+    }
+
+    suite.register_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
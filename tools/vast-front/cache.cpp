@@ -0,0 +1,327 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Compilation cache of vast-front. With `-vast-cache-dir=<dir>` the output of
+// a job is stored under a key of its preprocessed source, the cc1 options, the
+// `-vast-*` options and the version of vast. A later job of the same key
+// copies the stored output and skips codegen, lowering and the backend.
+//
+// With `-vast-remote-cache=<url>` entries are also shared through a plain http
+// server, `GET` and `PUT` of `<url>/<key>`, e.g., the `ac` store of a Bazel
+// remote cache. Transfers are done by `curl`, a miss of the local cache is
+// looked up remotely and the upload of a new entry runs in the background.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Frontend/PreprocessorOutputOptions.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Lex/Preprocessor.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Config/config.h"
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    namespace {
+
+        struct key_hasher {
+            void add(string_ref data) {
+                hasher.update(data);
+                // Separate the fields, so that "ab" "c" and "a" "bc" differ.
+                hasher.update(string_ref("\0", 1));
+            }
+
+            void add(unsigned value) { add(string_ref(std::to_string(value))); }
+
+            std::string hex() { return llvm::toHex(hasher.final(), /* LowerCase */ true); }
+
+            llvm::BLAKE3 hasher;
+        };
+
+        // Feeds everything written to it to a hasher.
+        struct hash_ostream : llvm::raw_ostream {
+            explicit hash_ostream(llvm::BLAKE3 &hasher) : hasher(hasher) {}
+            ~hash_ostream() override { flush(); }
+
+            void write_impl(const char *ptr, std::size_t size) override {
+                hasher.update(string_ref(ptr, size));
+                pos += size;
+            }
+
+            std::uint64_t current_pos() const override { return pos; }
+
+            llvm::BLAKE3 &hasher;
+            std::uint64_t pos = 0;
+        };
+
+        // Hashes the preprocessed translation unit as `-E` prints it, with
+        // line markers and pragmas, as the pragmas handled by the parser,
+        // e.g., `pack` or `STDC FP_CONTRACT`, leave no tokens. The printed
+        // columns are approximate, so the tokens are also hashed with their
+        // presumed locations, which are a part of the output, e.g., of the
+        // locations of mlir operations and of the debug info.
+        struct hash_preprocessed_action : clang::PreprocessorFrontendAction {
+            explicit hash_preprocessed_action(key_hasher &key) : key(key) {}
+
+            void ExecuteAction() override {
+                auto &ci = getCompilerInstance();
+                auto &pp = ci.getPreprocessor();
+                auto &sm = pp.getSourceManager();
+
+                const char *file = nullptr;
+                llvm::SmallString< 128 > buffer;
+                pp.setTokenWatcher([&] (const clang::Token &tok) {
+                    if (auto loc = sm.getPresumedLoc(tok.getLocation()); loc.isValid()) {
+                        if (loc.getFilename() != file) {
+                            file = loc.getFilename();
+                            key.add(string_ref(file));
+                        }
+                        key.add(loc.getLine());
+                        key.add(loc.getColumn());
+                    }
+
+                    key.add(pp.getSpelling(tok, buffer));
+                });
+
+                clang::PreprocessorOutputOptions opts;
+                opts.ShowCPP = 1;
+                opts.ShowLineMarkers = 1;
+
+                key_hasher text;
+                {
+                    hash_ostream os(text.hasher);
+                    clang::DoPrintPreprocessedInput(pp, &os, opts);
+                }
+                pp.setTokenWatcher(nullptr);
+
+                key.add(string_ref(text.hex()));
+            }
+
+            key_hasher &key;
+        };
+
+        std::optional< std::string > cache_key(compiler_instance &ci, const vast_args &vargs) {
+            key_hasher key;
+            key.add(vast::version);
+
+            // The output path does not change the output.
+            auto cc1 = ci.getInvocation().getCC1CommandLine();
+            for (auto it = cc1.begin(); it != cc1.end(); ++it) {
+                if (*it == "-o" && std::next(it) != cc1.end()) {
+                    ++it;
+                    continue;
+                }
+
+                key.add(*it);
+            }
+
+            // Neither do the locations of the caches, so that jobs with
+            // different local caches share the remote entries.
+            for (auto arg : vargs.args) {
+                auto name = string_ref(arg).drop_front(vast_option_prefix.size()).split('=').first;
+                if (name == opt::cache_dir || name == opt::remote_cache) {
+                    continue;
+                }
+
+                key.add(string_ref(arg));
+            }
+
+            // Preprocessing is repeated by the compilation, report its
+            // diagnostics only once.
+            auto &diags = ci.getDiagnostics();
+            auto suppressed = diags.getSuppressAllDiagnostics();
+            diags.setSuppressAllDiagnostics(true);
+            hash_preprocessed_action preprocess(key);
+            auto preprocessed = ci.ExecuteAction(preprocess);
+            diags.setSuppressAllDiagnostics(suppressed);
+
+            if (!preprocessed) {
+                return std::nullopt;
+            }
+
+            return key.hex();
+        }
+
+        std::string cache_entry(string_ref dir, string_ref key) {
+            // Entries are spread over subdirectories by the first byte.
+            llvm::SmallString< 256 > path(dir);
+            llvm::sys::path::append(path, key.take_front(2), key);
+            return std::string(path.str());
+        }
+
+        bool store(string_ref output, string_ref entry) {
+            if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(entry))) {
+                return false;
+            }
+
+            // Concurrent jobs of the same key must not see a partial entry.
+            llvm::SmallString< 256 > temporary;
+            if (llvm::sys::fs::createUniqueFile(entry + ".%%%%%%%%.tmp", temporary)) {
+                return false;
+            }
+
+            if (llvm::sys::fs::copy_file(output, temporary)
+                || llvm::sys::fs::rename(temporary, entry)
+            ) {
+                llvm::sys::fs::remove(temporary);
+                return false;
+            }
+
+            return true;
+        }
+
+        //
+        // Transfers of the remote cache. A missing `curl`, an unreachable
+        // server or a missing entry are all a miss, the job is then compiled
+        // locally.
+        //
+        struct remote_cache {
+            static std::optional< remote_cache > of(const vast_args &vargs, string_ref key) {
+                auto url = vargs.get_option(opt::remote_cache);
+                if (!url) {
+                    return std::nullopt;
+                }
+
+                auto curl = llvm::sys::findProgramByName("curl");
+                if (!curl) {
+                    llvm::errs() << "warning: cannot find curl, the vast remote cache is not used\n";
+                    return std::nullopt;
+                }
+
+                return remote_cache{ *curl, (url->rtrim('/') + "/" + key).str() };
+            }
+
+            // The output is written only by a complete download.
+            bool fetch(string_ref output) const {
+                llvm::SmallString< 256 > download;
+                if (llvm::sys::fs::createUniqueFile(output + ".%%%%%%%%.remote", download)) {
+                    return false;
+                }
+
+                auto args = curl_args({ "--output", download, url });
+                if (llvm::sys::ExecuteAndWait(curl, args, std::nullopt, quiet()) != 0
+                    || llvm::sys::fs::rename(download, output)
+                ) {
+                    llvm::sys::fs::remove(download);
+                    return false;
+                }
+
+                return true;
+            }
+
+            // An entry of the local cache is not modified anymore, its upload
+            // outlives the job. Otherwise the job waits for the upload of its
+            // output.
+            bool store(string_ref file, bool detach) const {
+                auto args = curl_args({ "--upload-file", file, url });
+                if (!detach) {
+                    return llvm::sys::ExecuteAndWait(curl, args, std::nullopt, quiet()) == 0;
+                }
+
+                bool failed = false;
+                llvm::sys::ExecuteNoWait(
+                    curl, args, std::nullopt, quiet(), 0, nullptr, &failed
+                );
+                return !failed;
+            }
+
+            std::vector< string_ref > curl_args(std::initializer_list< string_ref > rest) const {
+                // `--fail` turns http errors, e.g., 404 of a missing entry, into
+                // a failure of curl. A slow server must not stall the build.
+                std::vector< string_ref > args = {
+                    curl, "--silent", "--fail", "--connect-timeout", "2", "--max-time", "60"
+                };
+                args.insert(args.end(), rest);
+                return args;
+            }
+
+            static std::array< std::optional< string_ref >, 3 > quiet() {
+                return { std::nullopt, string_ref(""), string_ref("") };
+            }
+
+            std::string curl;
+            std::string url;
+        };
+
+    } // namespace
+
+    bool cacheable(compiler_instance &ci, const vast_args &vargs) {
+        const auto &opts = ci.getFrontendOpts();
+        return (vargs.get_option(opt::cache_dir) || vargs.get_option(opt::remote_cache))
+            && opts.Inputs.size() == 1
+            && !opts.OutputFile.empty()
+            && opts.OutputFile != "-"
+            // An entry keeps a single output.
+            && !vargs.has_option(opt::retarget)
+            && !vargs.has_option(opt::cost_report)
+            && !vargs.has_option(opt::estimate_cost)
+            && !vargs.has_option(opt::stack_usage)
+            && ci.getCodeGenOpts().OptRecordFile.empty();
+    }
+
+    bool execute_cached(
+        compiler_instance &ci, const vast_args &vargs, llvm::function_ref< bool() > execute
+    ) {
+        auto key = cache_key(ci, vargs);
+        if (!key) {
+            return execute();
+        }
+
+        auto dir    = vargs.get_option(opt::cache_dir);
+        auto entry  = dir ? cache_entry(*dir, *key) : std::string();
+        auto output = string_ref(ci.getFrontendOpts().OutputFile);
+
+        if (dir && llvm::sys::fs::exists(entry) && !llvm::sys::fs::copy_file(entry, output)) {
+            return true;
+        }
+
+        auto remote = remote_cache::of(vargs, *key);
+        auto stored = [&] {
+            if (dir && !store(output, entry)) {
+                llvm::errs() << "warning: cannot store " << output << " in the vast cache " << *dir << '\n';
+                return false;
+            }
+            return bool(dir);
+        };
+
+        if (remote && remote->fetch(output)) {
+            stored();
+            return true;
+        }
+
+        if (!execute()) {
+            return false;
+        }
+
+        if (ci.getDiagnostics().hasErrorOccurred()) {
+            return true;
+        }
+
+        auto local = stored();
+        if (remote && !remote->store(local ? string_ref(entry) : output, local)) {
+            llvm::errs() << "warning: cannot store " << output << " in the vast remote cache\n";
+        }
+
+        return true;
+    }
+
+} // namespace vast::cc
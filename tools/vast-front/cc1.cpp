@@ -56,7 +56,9 @@ namespace vast::cc {
 
     bool execute_compiler_invocation(compiler_instance *ci, const vast_args &vargs);
 
-    int cc1(const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr) {
+    int cc1(
+        const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr, bool install_error_handler
+    ) {
         // FIXME: ensureSufficientStack
 
         auto comp = std::make_unique< compiler_instance >();
@@ -81,8 +83,13 @@ namespace vast::cc {
         // auto &target_opts   = comp->getFrontendOpts();
         auto &header_opts   = comp->getHeaderSearchOpts();
 
+        // `-vast-trace` records every scope, unless `-ftime-trace` shares the
+        // profiler with its granularity.
+        auto vast_trace_path = vargs.get_option(opt::trace);
         if (!frontend_opts.TimeTracePath.empty()) {
             llvm::timeTraceProfilerInitialize(frontend_opts.TimeTraceGranularity, tool);
+        } else if (vast_trace_path) {
+            llvm::timeTraceProfilerInitialize(/* granularity */ 0, tool);
         }
 
         // --print-supported-cpus takes priority over the actual compilation.
@@ -102,7 +109,9 @@ namespace vast::cc {
 
         // Set an error handler, so that any LLVM backend diagnostics go through our
         // error handler.
-        llvm::install_fatal_error_handler(error_handler, static_cast<void*>(&comp->getDiagnostics()));
+        if (install_error_handler) {
+            llvm::install_fatal_error_handler(error_handler, static_cast<void*>(&comp->getDiagnostics()));
+        }
 
         diags.flush();
         if (!success) {
@@ -143,23 +152,36 @@ namespace vast::cc {
                 ));
             }
 
-            if (auto profilerOutput = comp->createOutputFile(
-                    frontend_opts.TimeTracePath, /*Binary=*/false,
-                    /*RemoveFileOnSignal=*/false,
-                    /*useTemporary=*/false
-                ))
-            {
-                llvm::timeTraceProfilerWrite(*profilerOutput);
-                profilerOutput.reset();
-                llvm::timeTraceProfilerCleanup();
-                comp->clearOutputFiles(false);
+            auto write_trace = [&] (string_ref path) {
+                if (auto profilerOutput = comp->createOutputFile(
+                        path, /*Binary=*/false,
+                        /*RemoveFileOnSignal=*/false,
+                        /*useTemporary=*/false
+                    ))
+                {
+                    llvm::timeTraceProfilerWrite(*profilerOutput);
+                    profilerOutput.reset();
+                    comp->clearOutputFiles(false);
+                }
+            };
+
+            if (!frontend_opts.TimeTracePath.empty()) {
+                write_trace(frontend_opts.TimeTracePath);
+            }
+
+            if (vast_trace_path) {
+                write_trace(*vast_trace_path);
             }
+
+            llvm::timeTraceProfilerCleanup();
         }
 
         // Our error handler depends on the Diagnostics object, which we're
         // potentially about to delete. Uninstall the handler now so that any
         // later errors use the default handling behavior instead.
-        llvm::remove_fatal_error_handler();
+        if (install_error_handler) {
+            llvm::remove_fatal_error_handler();
+        }
 
         // When running with -disable-free, don't do any destruction or shutdown.
         if (frontend_opts.DisableFree) {
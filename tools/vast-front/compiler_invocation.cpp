@@ -14,9 +14,16 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Frontend/Action.hpp"
 #include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Retarget.hpp"
 
 namespace vast::cc
 {
+    // compilation cache. Lives inside cache.cpp
+    extern bool cacheable(compiler_instance &ci, const vast_args &vargs);
+    extern bool execute_cached(
+        compiler_instance &ci, const vast_args &vargs, llvm::function_ref< bool() > execute
+    );
+
     frontend_action_ptr create_frontend_action(const vast_args &vargs) {
         if (vargs.has_option(opt::emit_mlir)) {
             return std::make_unique< vast::cc::emit_mlir_action >(vargs);
@@ -26,6 +33,10 @@ namespace vast::cc
             return std::make_unique< vast::cc::emit_llvm_action >(vargs);
         }
 
+        if (vargs.has_option(opt::emit_bc)) {
+            return std::make_unique< vast::cc::emit_bc_action >(vargs);
+        }
+
         if (vargs.has_option(opt::emit_asm)) {
             return std::make_unique< vast::cc::emit_assembly_action >(vargs);
         }
@@ -50,7 +61,12 @@ namespace vast::cc
             case ASTDump:  return std::make_unique< clang::ASTDumpAction >();
             case EmitAssembly: return std::make_unique< vast::cc::emit_assembly_action >(vargs);
             case EmitLLVM: return std::make_unique< vast::cc::emit_llvm_action >(vargs);
+            case EmitBC: return std::make_unique< vast::cc::emit_bc_action >(vargs);
             case EmitObj: return std::make_unique< vast::cc::emit_obj_action >(vargs);
+            // Precompiled headers and modules are serialized clang ASTs, their
+            // users import the declarations they need, see `codegen_context`.
+            case GeneratePCH: return std::make_unique< clang::GeneratePCHAction >();
+            case GenerateModule: return std::make_unique< clang::GenerateModuleFromModuleMapAction >();
             default: VAST_UNREACHABLE("unsupported frontend action");
         }
 
@@ -93,12 +109,29 @@ namespace vast::cc
         if (!action)
             return false;
 
-        bool success = ci->ExecuteAction(*action);
+        auto execute = [&] { return ci->ExecuteAction(*action); };
+        bool success = cacheable(*ci, vargs) ? execute_cached(*ci, vargs, execute) : execute();
 
         if (opts.DisableFree) {
             llvm::BuryPointer(std::move(action));
         }
 
+        // Variants of -vast-retarget that depend on the target are compiled
+        // on their own, see `retargeting`.
+        auto fallback_vargs = without_retarget(vargs);
+        for (auto &invocation : take_fallbacks()) {
+            if (!success) {
+                break;
+            }
+
+            compiler_instance fallback;
+            fallback.setInvocation(std::move(invocation));
+            fallback.createDiagnostics(ci->getDiagnostics().getClient(), /* ShouldOwnClient */ false);
+
+            auto fallback_action = create_frontend_action(fallback, fallback_vargs);
+            success = fallback_action && fallback.ExecuteAction(*fallback_action);
+        }
+
         return success;
     }
 
@@ -0,0 +1,330 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Compilation database mode of vast-front. `vast-front -p <compile_commands.json>`
+// compiles every translation unit of the database in this process, on a
+// shared pool of threads. The outputs go to `--output-dir=<dir>`, named after
+// the sources. `--filter=<regex>` selects the sources to compile, `--jobs=N`
+// limits the number of threads and arguments after `--` are appended to every
+// command, e.g., `-- -vast-emit-mlir=hl`.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Regex.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <mlir/IR/DialectRegistry.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/InitAllDialects.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Frontend/Consumer.hpp"
+#include "vast/Frontend/Driver.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Live inside driver.cpp
+std::string get_executable_path(vast::cc::arg_t tool, bool canonical_prefixes);
+void preprocess_vast_arguments(vast::cc::argv_storage &args);
+
+namespace vast::cc {
+
+    // main frontend method. Lives inside cc1.cpp
+    extern int cc1(
+        const vast_args &vargs, argv_t argv, arg_t tool, void *main_addr, bool install_error_handler
+    );
+
+    namespace {
+
+        struct database_options {
+            std::string database;
+            std::string output_dir = ".";
+            std::optional< std::string > filter;
+            unsigned jobs = 0;
+            std::vector< std::string > extra;
+        };
+
+        std::optional< database_options > parse_database_options(argv_t args) {
+            database_options opts;
+            for (auto it = args.begin(); it != args.end(); ++it) {
+                auto arg = string_ref(*it);
+                if (arg == "--") {
+                    opts.extra.assign(std::next(it), args.end());
+                    break;
+                }
+
+                if (arg == "-p" && std::next(it) != args.end()) {
+                    opts.database = *++it;
+                } else if (arg.consume_front("--output-dir=")) {
+                    opts.output_dir = arg.str();
+                } else if (arg.consume_front("--filter=")) {
+                    opts.filter = arg.str();
+                } else if (arg.consume_front("--jobs=")) {
+                    if (arg.getAsInteger(10, opts.jobs)) {
+                        llvm::errs() << "error: invalid number of jobs '" << arg << "'\n";
+                        return std::nullopt;
+                    }
+                } else {
+                    llvm::errs() << "error: unknown argument '" << arg
+                                 << "' of the compilation database mode\n";
+                    return std::nullopt;
+                }
+            }
+
+            if (opts.database.empty()) {
+                llvm::errs() << "error: missing compilation database, use -p <path>\n";
+                return std::nullopt;
+            }
+
+            return opts;
+        }
+
+        // Outputs of the build and dependency files would be written relative
+        // to the working directory of vast-front, and by all jobs at once.
+        std::vector< std::string > strip_outputs(const std::vector< std::string > &args) {
+            std::vector< std::string > out;
+            for (auto it = args.begin(); it != args.end(); ++it) {
+                auto arg = string_ref(*it);
+                if (arg == "-o" || arg == "-MF" || arg == "-MT" || arg == "-MQ") {
+                    if (std::next(it) != args.end()) {
+                        ++it;
+                    }
+                    continue;
+                }
+
+                if (arg == "-MD" || arg == "-MMD"
+                    || arg.startswith("-MF") || arg.startswith("-MT") || arg.startswith("-MQ")
+                ) {
+                    continue;
+                }
+
+                out.push_back(*it);
+            }
+
+            return out;
+        }
+
+        std::string absolute_source(const clang::tooling::CompileCommand &cmd) {
+            llvm::SmallString< 256 > path(cmd.Filename);
+            llvm::sys::fs::make_absolute(cmd.Directory, path);
+            llvm::sys::path::remove_dots(path, /* remove_dot_dot */ true);
+            return std::string(path.str());
+        }
+
+        //
+        // The cc1 command of a database entry, with the output redirected
+        // into the output directory.
+        //
+        struct job_builder {
+            const database_options &opts;
+            std::string tool;
+            std::string output_dir;
+            llvm::StringSet<> outputs = {};
+
+            // Sources of the same name get distinct outputs, numbered in the
+            // order of the database.
+            std::string output_for(string_ref source, string_ref extension) {
+                auto stem = llvm::sys::path::stem(source);
+                std::string name = (llvm::Twine(stem) + extension).str();
+                for (unsigned i = 1; !outputs.insert(name).second; ++i) {
+                    name = (llvm::Twine(stem) + "." + llvm::Twine(i) + extension).str();
+                }
+
+                llvm::SmallString< 256 > path(output_dir);
+                llvm::sys::path::append(path, name);
+                return std::string(path.str());
+            }
+
+            std::optional< std::vector< std::string > > build(
+                const clang::tooling::CompileCommand &cmd
+            ) {
+                if (cmd.CommandLine.empty()) {
+                    return std::nullopt;
+                }
+
+                auto args = strip_outputs(cmd.CommandLine);
+                args.front() = tool;
+                args.insert(args.end(), { "-working-directory", cmd.Directory });
+                args.insert(args.end(), opts.extra.begin(), opts.extra.end());
+
+                argv_storage cmd_args;
+                for (const auto &arg : args) {
+                    cmd_args.push_back(arg.c_str());
+                }
+                preprocess_vast_arguments(cmd_args);
+
+                auto unused_cc1 = [] (argv_storage_base &) { return 1; };
+                vast::cc::driver drv(tool, cmd_args, unused_cc1, /* canonical_prefixes */ true);
+                auto comp = drv.make_compilation();
+                if (!comp || comp->containsError()) {
+                    return std::nullopt;
+                }
+
+                // Only the compilation itself runs in process, e.g., not an
+                // external assembler.
+                const auto &jobs = comp->getJobs();
+                if (jobs.size() != 1 || jobs.begin()->getArguments().empty()
+                    || string_ref(jobs.begin()->getArguments().front()) != "-cc1"
+                ) {
+                    llvm::errs() << "error: " << cmd.Filename << ": expected a single cc1 job\n";
+                    return std::nullopt;
+                }
+
+                auto [vargs, ccargs] = filter_args(cmd_args);
+                bool mlir = opt::emit_only_mlir(vargs);
+                bool bytecode = vargs.has_option(opt::emit_mlir_bytecode);
+
+                std::vector< std::string > job = { tool };
+                const auto &cc1_args = jobs.begin()->getArguments();
+                for (auto it = cc1_args.begin(); it != cc1_args.end(); ++it) {
+                    auto arg = string_ref(*it);
+                    // Every job would leak its compiler instance.
+                    if (arg == "-disable-free") {
+                        continue;
+                    }
+
+                    job.emplace_back(arg);
+                    if (arg == "-o" && std::next(it) != cc1_args.end()) {
+                        auto ext = mlir
+                            ? std::string(bytecode ? ".mlirbc" : ".mlir")
+                            : llvm::sys::path::extension(*++it).str();
+                        job.push_back(output_for(cmd.Filename, ext));
+                    }
+                }
+
+                return job;
+            }
+        };
+
+        // Contexts are not shared among translation units, the named types of
+        // one would clash with the other. They share the dialect registry and
+        // the threads of the pool instead.
+        std::unique_ptr< mcontext_t > make_job_context(
+            const mlir::DialectRegistry &registry, llvm::ThreadPool &pool
+        ) {
+            auto mctx = std::make_unique< mcontext_t >(registry, mcontext_t::Threading::DISABLED);
+            vast::load_vast_dialects(*mctx);
+            mctx->setThreadPool(pool);
+            return mctx;
+        }
+
+        int run_job(
+            const std::vector< std::string > &args, const mlir::DialectRegistry &registry,
+            llvm::ThreadPool &pool
+        ) {
+            argv_storage cmd_args;
+            for (const auto &arg : args) {
+                cmd_args.push_back(arg.c_str());
+            }
+
+            VAST_RELAX_WARNINGS
+            void *get_executable_path_ptr = (void *) (intptr_t) get_executable_path;
+            VAST_UNRELAX_WARNINGS
+
+            auto [vargs, ccargs] = filter_args(cmd_args);
+            preload_mcontext(make_job_context(registry, pool));
+
+            // The fatal error handler is global, it cannot report to the
+            // diagnostics of one of the jobs.
+            auto ccargs_ref = llvm::ArrayRef(ccargs).slice(2);
+            return cc1(vargs, ccargs_ref, cmd_args[0], get_executable_path_ptr, false);
+        }
+
+    } // namespace
+
+    int compile_database(argv_t args, arg_t tool) {
+        auto opts = parse_database_options(args);
+        if (!opts) {
+            return 1;
+        }
+
+        std::string error;
+        auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+            opts->database, error, clang::tooling::JSONCommandLineSyntax::AutoDetect
+        );
+        if (!db) {
+            llvm::errs() << "error: " << error << '\n';
+            return 1;
+        }
+
+        std::optional< llvm::Regex > filter;
+        if (opts->filter) {
+            filter.emplace(*opts->filter);
+            if (!filter->isValid(error)) {
+                llvm::errs() << "error: invalid filter '" << *opts->filter << "': " << error << '\n';
+                return 1;
+            }
+        }
+
+        llvm::SmallString< 256 > output_dir(opts->output_dir);
+        if (llvm::sys::fs::make_absolute(output_dir)
+            || llvm::sys::fs::create_directories(output_dir)
+        ) {
+            llvm::errs() << "error: cannot create the output directory " << opts->output_dir << '\n';
+            return 1;
+        }
+
+        // The drivers run one at a time, only the cc1 jobs run on the pool.
+        job_builder builder = { *opts, get_executable_path(tool, /* canonical_prefixes */ true),
+                                std::string(output_dir.str()) };
+
+        int status = 0;
+        std::vector< std::vector< std::string > > jobs;
+        for (const auto &cmd : db->getAllCompileCommands()) {
+            if (filter && !filter->match(absolute_source(cmd))) {
+                continue;
+            }
+
+            if (auto job = builder.build(cmd)) {
+                jobs.push_back(std::move(*job));
+            } else {
+                status = 1;
+            }
+        }
+
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmPrinters();
+        llvm::InitializeAllAsmParsers();
+
+        mlir::DialectRegistry registry;
+        mlir::registerAllDialects(registry);
+        vast::registerAllDialects(registry);
+
+        // Passes of the jobs run their parallel work on the same pool, a job
+        // waiting for its tasks executes them meanwhile.
+        llvm::ThreadPool pool(llvm::hardware_concurrency(opts->jobs));
+
+        std::atomic_uint failed = 0;
+        for (const auto &job : jobs) {
+            pool.async([&] {
+                if (run_job(job, registry, pool)) {
+                    ++failed;
+                }
+            });
+        }
+        pool.wait();
+
+        if (failed) {
+            llvm::errs() << "error: " << failed.load() << " of " << jobs.size()
+                         << " translation units failed\n";
+            status = 1;
+        }
+
+        return status;
+    }
+
+} // namespace vast::cc
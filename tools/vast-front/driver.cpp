@@ -21,7 +21,20 @@ VAST_UNRELAX_WARNINGS
 
 // main frontend method. Lives inside cc1_main.cpp
 namespace vast::cc {
-    extern int cc1(const vast_args & vargs, argv_t argv, arg_t tool, void *main_addr);
+    extern int cc1(
+        const vast_args & vargs, argv_t argv, arg_t tool, void *main_addr,
+        bool install_error_handler = true
+    );
+
+    // compile server mode. Lives inside server.cpp
+    extern int serve(
+        string_ref path, string_ref metrics_spec, arg_t tool,
+        llvm::function_ref< int(argv_storage &) > compile
+    );
+    extern int connect_to_server(string_ref path, argv_t args);
+
+    // compilation database mode. Lives inside database.cpp
+    extern int compile_database(argv_t args, arg_t tool);
 } // namespace vast::cc
 
 VAST_RELAX_WARNINGS
@@ -114,28 +127,7 @@ void preprocess_vast_arguments(vast::cc::argv_storage &args) {
     }
 }
 
-int main(int argc, char **argv) try {
-    // Initialize variables to call the driver
-    llvm::InitLLVM x(argc, argv);
-
-    auto msg = llvm::formatv(
-        "PLEASE submit a bug report to {0} and include the crash backtrace, "
-        "preprocessed source, and associated run script.\n", vast::bug_report_url
-    ).str();
-
-    llvm::setBugReportMsg(msg.c_str());
-
-    vast::cc::argv_storage cmd_args(argv, argv + argc);
-
-    if (llvm::sys::Process::FixupStandardFileDescriptors()) {
-        return 1;
-    }
-
-    llvm::InitializeAllTargets();
-
-    llvm::BumpPtrAllocator pointer_allocator;
-    llvm::StringSaver saver(pointer_allocator);
-
+static int compile(vast::cc::argv_storage &cmd_args) {
     // FIXME: deal with CL mode
 
     // Check if vast-front is in the frontend mode
@@ -159,6 +151,56 @@ int main(int argc, char **argv) try {
     // Not in the frontend mode - continue in the compiler driver mode.
     vast::cc::driver driver(driver_path, cmd_args, &execute_cc1_tool, canonical_prefixes);
     return driver.execute();
+}
+
+int main(int argc, char **argv) try {
+    // The client of the compile server only forwards the job, keep it light.
+    if (argc > 1) {
+        if (auto path = vast::string_ref(argv[1]); path.consume_front("--connect=")) {
+            return vast::cc::connect_to_server(path, vast::cc::argv_t(argv + 2, argv + argc));
+        }
+    }
+
+    // Initialize variables to call the driver
+    llvm::InitLLVM x(argc, argv);
+
+    auto msg = llvm::formatv(
+        "PLEASE submit a bug report to {0} and include the crash backtrace, "
+        "preprocessed source, and associated run script.\n", vast::bug_report_url
+    ).str();
+
+    llvm::setBugReportMsg(msg.c_str());
+
+    vast::cc::argv_storage cmd_args(argv, argv + argc);
+
+    if (llvm::sys::Process::FixupStandardFileDescriptors()) {
+        return 1;
+    }
+
+    llvm::InitializeAllTargets();
+
+    if (argc > 1) {
+        if (auto path = vast::string_ref(argv[1]); path.consume_front("--serve=")) {
+            llvm::InitializeAllTargetMCs();
+            llvm::InitializeAllAsmPrinters();
+            llvm::InitializeAllAsmParsers();
+
+            vast::string_ref metrics;
+            if (argc > 2) {
+                metrics = argv[2];
+                if (!metrics.consume_front("--metrics=")) {
+                    metrics = {};
+                }
+            }
+            return vast::cc::serve(path, metrics, argv[0], compile);
+        }
+
+        if (vast::string_ref(argv[1]) == "-p") {
+            return vast::cc::compile_database(vast::cc::argv_t(argv + 1, argv + argc), argv[0]);
+        }
+    }
+
+    return compile(cmd_args);
 } catch (std::exception &e) {
     llvm::errs() << "error: " << e.what() << '\n';
     std::exit(1);
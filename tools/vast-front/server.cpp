@@ -0,0 +1,482 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Compile server of vast-front. `vast-front --serve=<socket>` keeps a warm
+// process with initialized targets and preloaded dialects, and forks a worker
+// per job. `vast-front --connect=<socket> <args...>` is the thin client that
+// can be used as `CC`. It forwards its working directory, arguments and stdio
+// descriptors to the server, and exits with the status of the job.
+//
+// `--metrics=<spec>` after `--serve` exports metrics of the jobs. The server
+// stays single-threaded, workers report their status and duration through a
+// pipe, and the server polls it along with its socket and the exporter.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/DialectRegistry.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/InitAllDialects.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Frontend/Consumer.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Metrics.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if LLVM_ON_UNIX
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace vast::cc {
+
+#if LLVM_ON_UNIX
+
+    namespace {
+
+        // stdin, stdout and stderr of the client
+        constexpr int forwarded_fds = 3;
+
+        bool write_all(int fd, const void *data, std::size_t size) {
+            auto bytes = static_cast< const char * >(data);
+            while (size) {
+                auto written = ::write(fd, bytes, size);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (written <= 0) {
+                    return false;
+                }
+
+                bytes += written;
+                size  -= std::size_t(written);
+            }
+
+            return true;
+        }
+
+        bool read_all(int fd, void *data, std::size_t size) {
+            auto bytes = static_cast< char * >(data);
+            while (size) {
+                auto read = ::read(fd, bytes, size);
+                if (read < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (read <= 0) {
+                    return false;
+                }
+
+                bytes += read;
+                size  -= std::size_t(read);
+            }
+
+            return true;
+        }
+
+        int make_socket(string_ref path, sockaddr_un &addr) {
+            if (path.size() >= sizeof(addr.sun_path)) {
+                llvm::errs() << "error: socket path too long: " << path << '\n';
+                return -1;
+            }
+
+            addr = {};
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, path.data(), path.size());
+
+            auto sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (sock < 0) {
+                llvm::errs() << "error: cannot create socket: " << std::strerror(errno) << '\n';
+            }
+
+            return sock;
+        }
+
+        // The descriptors are attached to a single tag byte by SCM_RIGHTS.
+        bool send_stdio(int sock) {
+            char tag = 0;
+            iovec iov = { &tag, 1 };
+
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * forwarded_fds)] = {};
+
+            msghdr msg = {};
+            msg.msg_iov        = &iov;
+            msg.msg_iovlen     = 1;
+            msg.msg_control    = control;
+            msg.msg_controllen = sizeof(control);
+
+            auto cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type  = SCM_RIGHTS;
+            cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * forwarded_fds);
+
+            int fds[forwarded_fds] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+            std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+            return ::sendmsg(sock, &msg, 0) == 1;
+        }
+
+        bool receive_stdio(int sock, int (&fds)[forwarded_fds]) {
+            char tag = 0;
+            iovec iov = { &tag, 1 };
+
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+            msghdr msg = {};
+            msg.msg_iov        = &iov;
+            msg.msg_iovlen     = 1;
+            msg.msg_control    = control;
+            msg.msg_controllen = sizeof(control);
+
+            if (::recvmsg(sock, &msg, 0) != 1) {
+                return false;
+            }
+
+            auto cmsg = CMSG_FIRSTHDR(&msg);
+            if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+                return false;
+            }
+
+            std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+            return true;
+        }
+
+        //
+        // A request is a 64-bit payload size followed by the payload:
+        // the client working directory and its arguments, each terminated by '\0'.
+        //
+        struct request {
+            std::string cwd;
+            std::vector< std::string > args;
+        };
+
+        bool send_request(int sock, string_ref cwd, argv_t args) {
+            std::string payload;
+            payload.append(cwd.data(), cwd.size()).push_back('\0');
+            for (auto arg : args) {
+                payload.append(arg).push_back('\0');
+            }
+
+            std::uint64_t size = payload.size();
+            return write_all(sock, &size, sizeof(size))
+                && write_all(sock, payload.data(), payload.size());
+        }
+
+        std::optional< request > receive_request(int sock) {
+            std::uint64_t size = 0;
+            if (!read_all(sock, &size, sizeof(size))) {
+                return std::nullopt;
+            }
+
+            std::string payload(size, '\0');
+            if (!read_all(sock, payload.data(), payload.size())) {
+                return std::nullopt;
+            }
+
+            if (payload.empty() || payload.back() != '\0') {
+                return std::nullopt;
+            }
+
+            auto [cwd, rest] = string_ref(payload).split('\0');
+
+            request req;
+            req.cwd = cwd.str();
+            while (!rest.empty()) {
+                auto [arg, tail] = rest.split('\0');
+                req.args.push_back(arg.str());
+                rest = tail;
+            }
+
+            return req;
+        }
+
+        std::unique_ptr< mcontext_t > make_warm_context() {
+            mlir::DialectRegistry registry;
+            mlir::registerAllDialects(registry);
+            vast::registerAllDialects(registry);
+
+            // No threads may exist in the server when the workers are forked.
+            auto mctx = std::make_unique< mcontext_t >(registry, mcontext_t::Threading::DISABLED);
+            vast::load_vast_dialects(*mctx);
+            return mctx;
+        }
+
+        // Written by a worker to the server when its job ends, records are
+        // smaller than PIPE_BUF, so writes of workers do not interleave.
+        struct job_record
+        {
+            std::int32_t status;
+            double seconds;
+        };
+
+        struct server_metrics
+        {
+            metrics::counter &jobs = metrics::registry::global().make_counter(
+                "vast_front_jobs", "Jobs of the compile server."
+            );
+            metrics::counter &failures = metrics::registry::global().make_counter(
+                "vast_front_job_failures", "Jobs that failed or whose worker crashed."
+            );
+            metrics::counter &fork_failures = metrics::registry::global().make_counter(
+                "vast_front_fork_failures", "Jobs dropped as their worker could not be forked."
+            );
+            metrics::histogram &job_seconds = metrics::registry::global().make_histogram(
+                "vast_front_job_seconds", "Seconds of a job from the fork of its worker."
+            );
+            metrics::gauge &active = metrics::registry::global().make_gauge(
+                "vast_front_active_workers", "Workers that did not exit yet."
+            );
+
+            void finished(const job_record &record) {
+                job_seconds.observe(record.seconds);
+                if (record.status != 0) {
+                    failures.inc();
+                }
+            }
+        };
+
+        int run_job(
+            int client, arg_t tool, std::unique_ptr< mcontext_t > warm,
+            llvm::function_ref< int(argv_storage &) > compile
+        ) {
+            int fds[forwarded_fds];
+            if (!receive_stdio(client, fds)) {
+                return 1;
+            }
+
+            auto req = receive_request(client);
+            if (!req) {
+                return 1;
+            }
+
+            for (int fd = 0; fd < forwarded_fds; ++fd) {
+                ::dup2(fds[fd], fd);
+                ::close(fds[fd]);
+            }
+
+            int status = 1;
+            if (::chdir(req->cwd.c_str()) == 0) {
+                warm->enableMultithreading(true);
+                preload_mcontext(std::move(warm));
+
+                argv_storage args = { tool };
+                for (const auto &arg : req->args) {
+                    args.push_back(arg.c_str());
+                }
+
+                status = compile(args);
+            } else {
+                llvm::errs() << "error: cannot change directory to " << req->cwd << '\n';
+            }
+
+            llvm::outs().flush();
+            llvm::errs().flush();
+
+            std::int32_t result = status;
+            write_all(client, &result, sizeof(result));
+            return status;
+        }
+
+    } // namespace
+
+    int serve(
+        string_ref path, string_ref metrics_spec, arg_t tool,
+        llvm::function_ref< int(argv_storage &) > compile
+    ) {
+        sockaddr_un addr;
+        auto sock = make_socket(path, addr);
+        if (sock < 0) {
+            return 1;
+        }
+
+        // Replace a stale socket of a previous server, but nothing else.
+        struct stat st;
+        if (::lstat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+            ::unlink(addr.sun_path);
+        }
+
+        if (::bind(sock, reinterpret_cast< sockaddr * >(&addr), sizeof(addr)) < 0
+            || ::listen(sock, SOMAXCONN) < 0
+        ) {
+            llvm::errs() << "error: cannot listen on " << path << ": " << std::strerror(errno) << '\n';
+            ::close(sock);
+            return 1;
+        }
+
+        std::unique_ptr< metrics::exporter > exporter;
+        if (!metrics_spec.empty()) {
+            metrics::register_process_metrics();
+            exporter = metrics::exporter::make(metrics_spec);
+            if (!exporter) {
+                ::close(sock);
+                return 1;
+            }
+        }
+
+        // Linkers and other tools spawned by workers do not inherit the pipe.
+        int reports[2];
+        if (::pipe(reports) < 0) {
+            llvm::errs() << "error: cannot create pipe: " << std::strerror(errno) << '\n';
+            ::close(sock);
+            return 1;
+        }
+        ::fcntl(reports[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(reports[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(reports[1], F_SETFD, FD_CLOEXEC);
+
+        // Workers are reaped by the loop, which counts crashed ones.
+        std::signal(SIGCHLD, SIG_DFL);
+
+        server_metrics measured;
+        auto warm = make_warm_context();
+
+        for (;;) {
+            pollfd fds[3] = {
+                { sock, POLLIN, 0 },
+                { reports[0], POLLIN, 0 },
+                { exporter ? exporter->fd() : -1, POLLIN, 0 },
+            };
+
+            // Workers are reaped at least every second, even if crashed ones
+            // report nothing.
+            auto ready = ::poll(fds, 3, 1000);
+            if (ready < 0 && errno != EINTR) {
+                llvm::errs() << "error: poll failed: " << std::strerror(errno) << '\n';
+                break;
+            }
+
+            job_record record;
+            while (::read(reports[0], &record, sizeof(record)) == sizeof(record)) {
+                measured.finished(record);
+            }
+
+            int wstatus = 0;
+            while (::waitpid(-1, &wstatus, WNOHANG) > 0) {
+                measured.active.dec();
+                if (WIFSIGNALED(wstatus)) {
+                    measured.failures.inc();
+                }
+            }
+
+            // The file exporter has no descriptor and checks its interval itself.
+            if (exporter && (exporter->fd() < 0 || (fds[2].revents & POLLIN))) {
+                exporter->poll();
+            }
+
+            if (ready <= 0 || !(fds[0].revents & POLLIN)) {
+                continue;
+            }
+
+            auto client = ::accept(sock, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                llvm::errs() << "error: accept failed: " << std::strerror(errno) << '\n';
+                break;
+            }
+
+            auto pid = ::fork();
+            if (pid == 0) {
+                ::close(sock);
+                ::close(reports[0]);
+                if (exporter && exporter->fd() >= 0) {
+                    ::close(exporter->fd());
+                }
+
+                auto start  = std::chrono::steady_clock::now();
+                auto status = run_job(client, tool, std::move(warm), compile);
+
+                std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+                job_record done = { std::int32_t(status), elapsed.count() };
+                write_all(reports[1], &done, sizeof(done));
+                ::_exit(status);
+            }
+
+            if (pid < 0) {
+                llvm::errs() << "error: fork failed: " << std::strerror(errno) << '\n';
+                measured.fork_failures.inc();
+            } else {
+                measured.jobs.inc();
+                measured.active.inc();
+            }
+
+            ::close(client);
+        }
+
+        ::close(reports[0]);
+        ::close(reports[1]);
+        ::close(sock);
+        ::unlink(addr.sun_path);
+        return 1;
+    }
+
+    int connect_to_server(string_ref path, argv_t args) {
+        sockaddr_un addr;
+        auto sock = make_socket(path, addr);
+        if (sock < 0) {
+            return 1;
+        }
+
+        if (::connect(sock, reinterpret_cast< sockaddr * >(&addr), sizeof(addr)) < 0) {
+            llvm::errs() << "error: cannot connect to vast-front server at " << path
+                         << ": " << std::strerror(errno) << '\n';
+            ::close(sock);
+            return 1;
+        }
+
+        llvm::SmallString< 256 > cwd;
+        if (auto ec = llvm::sys::fs::current_path(cwd)) {
+            llvm::errs() << "error: cannot get working directory: " << ec.message() << '\n';
+            ::close(sock);
+            return 1;
+        }
+
+        std::int32_t status = 1;
+        if (!send_stdio(sock) || !send_request(sock, cwd, args)
+            || !read_all(sock, &status, sizeof(status))
+        ) {
+            llvm::errs() << "error: vast-front server at " << path << " dropped the job\n";
+            status = 1;
+        }
+
+        ::close(sock);
+        return status;
+    }
+
+#else
+
+    int serve(string_ref, string_ref, arg_t, llvm::function_ref< int(argv_storage &) >) {
+        llvm::errs() << "error: vast-front server is supported only on unix hosts\n";
+        return 1;
+    }
+
+    int connect_to_server(string_ref, argv_t) {
+        llvm::errs() << "error: vast-front server is supported only on unix hosts\n";
+        return 1;
+    }
+
+#endif
+
+} // namespace vast::cc
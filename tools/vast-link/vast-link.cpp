@@ -0,0 +1,187 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ToolOutputFile.h"
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Dialect/HighLevel/Linker.hpp"
+#include "vast/Target/LLVMIR/EmbeddedHL.hpp"
+#include "vast/Target/LLVMIR/Shards.hpp"
+#include "vast/Util/Common.hpp"
+
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    cl::list< std::string > input_files{
+        cl::desc("<input modules>"), cl::Positional, cl::OneOrMore
+    };
+
+    cl::opt< std::string > output_file{
+        "o", cl::desc("Output module"), cl::value_desc("filename"), cl::init("-")
+    };
+
+    cl::opt< bool > emit_bytecode{
+        "emit-bytecode", cl::desc("Write the linked module as mlir bytecode")
+    };
+
+    cl::opt< bool > print_stats{
+        "stats", cl::desc("Print statistics of the link to stderr")
+    };
+
+    cl::opt< bool > merge_shards{
+        "merge-shards", cl::desc("Merge shards of vast-opt --shard lowered to the llvm dialect")
+    };
+    // clang-format on
+} // namespace vast::cl
+
+namespace vast
+{
+    logical_result write(vast_module mod) {
+        if (mlir::failed(mlir::verify(mod))) {
+            return mlir::failure();
+        }
+
+        std::string err;
+        auto out = mlir::openOutputFile(cl::output_file, &err);
+        if (!out) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        if (cl::emit_bytecode) {
+            if (mlir::failed(mlir::writeBytecodeToFile(mod, out->os()))) {
+                return mlir::failure();
+            }
+        } else {
+            mod->print(out->os());
+            out->os() << '\n';
+        }
+
+        out->keep();
+        return mlir::success();
+    }
+
+    owning_module_ref make_module(mcontext_t &ctx) {
+        return owning_module_ref(vast_module::create(mlir::UnknownLoc::get(&ctx)));
+    }
+
+    logical_result merge(mcontext_t &ctx) {
+        std::vector< owning_module_ref > shards;
+        for (const auto &path : cl::input_files) {
+            auto mod = mlir::parseSourceFile< vast_module >(path, mlir::ParserConfig(&ctx));
+            if (!mod) {
+                return mlir::failure();
+            }
+            shards.push_back(std::move(mod));
+        }
+
+        llvm::SmallVector< vast_module > refs;
+        for (auto &shard : shards) {
+            refs.push_back(*shard);
+        }
+
+        auto merged = make_module(ctx);
+        if (mlir::failed(target::llvmir::merge_shards(*merged, refs))) {
+            return mlir::failure();
+        }
+
+        return write(*merged);
+    }
+
+    // An input is a module, or an object with the modules embedded by
+    // `-vast-embed-hl`, e.g., a relocatable object of a whole program.
+    logical_result read_input(
+        mcontext_t &ctx, string_ref path, std::vector< owning_module_ref > &mods
+    ) {
+        auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(path, /* IsText */ false);
+        if (!buffer) {
+            llvm::errs() << "error: cannot open " << path << ": " << buffer.getError().message() << "\n";
+            return mlir::failure();
+        }
+
+        if (target::llvmir::is_object_file((*buffer)->getMemBufferRef())) {
+            std::string err;
+            auto embedded = target::llvmir::extract_hl_modules((*buffer)->getMemBufferRef(), ctx, &err);
+            if (!embedded) {
+                llvm::errs() << "error: " << path << ": " << err << "\n";
+                return mlir::failure();
+            }
+
+            for (auto &mod : *embedded) {
+                mods.push_back(std::move(mod));
+            }
+            return mlir::success();
+        }
+
+        auto mod = mlir::parseSourceFile< vast_module >(path, mlir::ParserConfig(&ctx));
+        if (!mod) {
+            return mlir::failure();
+        }
+
+        mods.push_back(std::move(mod));
+        return mlir::success();
+    }
+
+    logical_result link(mcontext_t &ctx) {
+        auto linked = make_module(ctx);
+        hl::module_linker linker(*linked);
+
+        for (const auto &path : cl::input_files) {
+            std::vector< owning_module_ref > mods;
+            if (mlir::failed(read_input(ctx, path, mods))) {
+                return mlir::failure();
+            }
+
+            for (auto &mod : mods) {
+                if (mlir::failed(linker.link(*mod))) {
+                    return mlir::failure();
+                }
+            }
+        }
+
+        if (mlir::failed(write(*linked))) {
+            return mlir::failure();
+        }
+
+        if (cl::print_stats) {
+            const auto &stats = linker.stats();
+            llvm::errs() << "modules: "        << stats.modules        << '\n'
+                         << "deduplicated: "   << stats.deduplicated   << '\n'
+                         << "merged symbols: " << stats.merged_symbols << '\n'
+                         << "renamed: "        << stats.renamed        << '\n';
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast
+
+int main(int argc, char **argv) {
+    llvm::InitLLVM x(argc, argv);
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST high-level module linker\n");
+
+    mlir::DialectRegistry registry;
+    vast::registerAllDialects(registry);
+    mlir::registerAllDialects(registry);
+
+    vast::mcontext_t ctx(registry);
+    ctx.loadAllAvailableDialects();
+
+    return mlir::failed(vast::cl::merge_shards ? vast::merge(ctx) : vast::link(ctx));
+}
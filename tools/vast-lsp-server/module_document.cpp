@@ -0,0 +1,596 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/lsp/document.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Parser/Parser.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Symbols.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+namespace vast::lsp
+{
+    //
+    // Printed modules are split by `// -----` lines and then by the
+    // operations at the top of their modules, the lines indented by two
+    // spaces. Each operation is parsed on its own in a buffer that repeats
+    // the lines before the module, i.e., its aliases and header, and the
+    // location aliases after it. An edit of one operation leaves the buffers
+    // of the others as they were, so their parses are reused. A split that
+    // does not look like a printed module is parsed as a whole.
+    //
+    namespace
+    {
+        struct chunk_diagnostic
+        {
+            // Line and column in the buffer, none if the location is elsewhere.
+            std::optional< std::pair< unsigned, unsigned > > pos;
+            proto::DiagnosticSeverity severity;
+            std::string message;
+        };
+
+        struct chunk
+        {
+            std::string buffer;
+            // The buffer is made of the prefix, the body, the closing brace
+            // of the module and the suffix.
+            unsigned prefix_lines = 0, body_lines = 0;
+
+            owning_module_ref mod;
+            std::vector< chunk_diagnostic > parse_diagnostics;
+
+            llvm::StringMap< llvm::SmallVector< mlir::Operation *, 1 > > top_symbols;
+            llvm::StringMap< llvm::SmallVector< mlir::Operation *, 1 > > nested_symbols;
+
+            // Set once verified, guarded by the verifier of the document.
+            std::optional< std::vector< chunk_diagnostic > > verify_diagnostics;
+        };
+
+        using chunk_ptr = std::shared_ptr< chunk >;
+
+        // Lines of the document, 0-based, where the parts of a buffer are.
+        struct placement
+        {
+            unsigned section_line, body_line, close_line, suffix_line;
+        };
+
+        struct placed_chunk
+        {
+            chunk_ptr piece;
+            placement at;
+
+            unsigned to_document(unsigned line) const {
+                if (line < piece->prefix_lines) {
+                    return at.section_line + line;
+                }
+                line -= piece->prefix_lines;
+                if (line < piece->body_lines) {
+                    return at.body_line + line;
+                }
+                line -= piece->body_lines;
+                return line == 0 ? at.close_line : at.suffix_line + line - 1;
+            }
+
+            bool contains(unsigned line) const {
+                return line >= at.body_line && line < at.body_line + piece->body_lines;
+            }
+        };
+
+        struct split_chunk
+        {
+            std::string buffer;
+            unsigned prefix_lines, body_lines;
+            placement at;
+        };
+
+        bool is_split_marker(string_ref line) { return line.starts_with("// -----"); }
+
+        bool is_top_level_start(string_ref line) {
+            return line.size() > 2 && line.starts_with("  ") && line[2] != ' ' && line[2] != '}';
+        }
+
+        void append_lines(std::string &buffer, llvm::ArrayRef< string_ref > lines) {
+            for (auto line : lines) {
+                buffer.append(line.begin(), line.end());
+                buffer.push_back('\n');
+            }
+        }
+
+        void split_section(
+            llvm::ArrayRef< string_ref > lines, unsigned first, unsigned last,
+            std::vector< split_chunk > &chunks
+        ) {
+            auto section = lines.slice(first, last - first);
+
+            auto header = llvm::find_if(section, [] (string_ref line) {
+                return line.starts_with("module") && line.rtrim().ends_with("{");
+            });
+            auto close = llvm::find_if(llvm::reverse(section), [] (string_ref line) {
+                return line.rtrim() == "}";
+            });
+
+            auto whole = [&] {
+                split_chunk piece{ {}, 0, unsigned(section.size()), {} };
+                append_lines(piece.buffer, section);
+                auto end  = first + std::max(piece.body_lines, 1u) - 1;
+                piece.at  = { first, first, end, end };
+                chunks.push_back(std::move(piece));
+            };
+
+            if (header == section.end() || close == section.rend()) {
+                return whole();
+            }
+
+            auto header_line = unsigned(header - section.begin());
+            auto close_line  = unsigned(section.rend() - close) - 1;
+            if (close_line <= header_line) {
+                return whole();
+            }
+
+            std::string prefix, suffix;
+            append_lines(prefix, section.take_front(header_line + 1));
+            append_lines(suffix, section.drop_front(close_line + 1));
+
+            // An empty module is a chunk too, its header may be edited. Lines
+            // before the first operation go with it.
+            llvm::SmallVector< unsigned > starts = { header_line + 1 };
+            for (auto line = header_line + 2; line < close_line; ++line) {
+                if (is_top_level_start(section[line])) {
+                    starts.push_back(line);
+                }
+            }
+            starts.push_back(close_line);
+
+            for (std::size_t i = 0; i + 1 < starts.size(); ++i) {
+                auto begin = starts[i], end = starts[i + 1];
+                split_chunk piece{ prefix, header_line + 1, end - begin, {} };
+                append_lines(piece.buffer, section.slice(begin, end - begin));
+                piece.buffer += "}\n";
+                piece.buffer += suffix;
+                piece.at = { first, first + begin, first + close_line, first + close_line + 1 };
+                chunks.push_back(std::move(piece));
+            }
+        }
+
+        std::vector< split_chunk > split(string_ref text) {
+            llvm::SmallVector< string_ref > lines;
+            text.split(lines, '\n');
+            if (!lines.empty() && lines.back().empty()) {
+                lines.pop_back();
+            }
+
+            std::vector< split_chunk > chunks;
+            unsigned first = 0;
+            for (unsigned line = 0; line <= lines.size(); ++line) {
+                if (line == lines.size() || is_split_marker(lines[line])) {
+                    if (line > first) {
+                        split_section(lines, first, line, chunks);
+                    }
+                    first = line + 1;
+                }
+            }
+            return chunks;
+        }
+
+        chunk_diagnostic make_diagnostic(mlir::Diagnostic &diag, string_ref path) {
+            chunk_diagnostic result;
+
+            auto loc = file_location(diag.getLocation());
+            if (loc && loc->getFilename().getValue() == path) {
+                result.pos = { loc->getLine() - 1, loc->getColumn() ? loc->getColumn() - 1 : 0 };
+            }
+
+            switch (diag.getSeverity()) {
+                case mlir::DiagnosticSeverity::Error:
+                    result.severity = proto::DiagnosticSeverity::Error; break;
+                case mlir::DiagnosticSeverity::Warning:
+                    result.severity = proto::DiagnosticSeverity::Warning; break;
+                case mlir::DiagnosticSeverity::Note:
+                case mlir::DiagnosticSeverity::Remark:
+                    result.severity = proto::DiagnosticSeverity::Information; break;
+            }
+
+            result.message = diag.str();
+            return result;
+        }
+
+        chunk_ptr parse(
+            split_chunk source, const std::string &path, mcontext_t &ctx, std::mutex &ctx_mutex
+        ) {
+            auto piece = std::make_shared< chunk >();
+            piece->buffer       = std::move(source.buffer);
+            piece->prefix_lines = source.prefix_lines;
+            piece->body_lines   = source.body_lines;
+
+            {
+                std::lock_guard lock(ctx_mutex);
+                mlir::ScopedDiagnosticHandler handler(&ctx, [&] (mlir::Diagnostic &diag) {
+                    piece->parse_diagnostics.push_back(make_diagnostic(diag, path));
+                    return mlir::success();
+                });
+
+                // Verification is left to the verifier.
+                mlir::ParserConfig config(&ctx, /* verifyAfterParse */ false);
+                piece->mod = mlir::parseSourceString< mlir::ModuleOp >(piece->buffer, config, path);
+            }
+
+            if (piece->mod) {
+                for (auto &top : piece->mod->getBody()->getOperations()) {
+                    util::symbols(&top, [&] (auto symbol) {
+                        auto op = symbol.getOperation();
+                        auto &table = op == &top ? piece->top_symbols : piece->nested_symbols;
+                        table[util::symbol_name(symbol)].push_back(op);
+                    });
+                }
+            }
+
+            return piece;
+        }
+
+        //
+        // Verifies the chunks of a document once no edit came for a while,
+        // each chunk once. Chunks are verified by their top-level operations,
+        // so uses of symbols of other chunks are not checked.
+        //
+        struct verifier
+        {
+            using diagnostics = std::vector< chunk_diagnostic >;
+            using callback    = std::function< void(const std::vector< placed_chunk > &, std::int64_t) >;
+
+            static constexpr auto delay = std::chrono::milliseconds(300);
+
+            verifier(std::string path, mcontext_t &ctx, std::mutex &ctx_mutex, callback done)
+                : path(std::move(path)), ctx(ctx), ctx_mutex(ctx_mutex), done(std::move(done))
+                , worker([this] { loop(); })
+            {}
+
+            ~verifier() {
+                {
+                    std::lock_guard lock(mutex);
+                    stop = true;
+                }
+                wake.notify_all();
+                worker.join();
+            }
+
+            void schedule(std::vector< placed_chunk > chunks, std::int64_t version) {
+                {
+                    std::lock_guard lock(mutex);
+                    pending         = std::move(chunks);
+                    pending_version = version;
+                    deadline        = std::chrono::steady_clock::now() + delay;
+                    scheduled       = true;
+                }
+                wake.notify_all();
+            }
+
+            std::optional< diagnostics > verified(const chunk &piece) const {
+                std::lock_guard lock(mutex);
+                return piece.verify_diagnostics;
+            }
+
+          private:
+            void loop() {
+                std::unique_lock lock(mutex);
+                while (true) {
+                    wake.wait(lock, [&] { return stop || scheduled; });
+                    while (!stop && std::chrono::steady_clock::now() < deadline) {
+                        wake.wait_until(lock, deadline);
+                    }
+
+                    if (stop) {
+                        return;
+                    }
+
+                    auto chunks  = std::move(pending);
+                    auto version = pending_version;
+                    scheduled    = false;
+
+                    lock.unlock();
+                    for (const auto &placed : chunks) {
+                        verify(*placed.piece);
+                    }
+                    lock.lock();
+
+                    // A newer version is published once it is verified.
+                    if (!scheduled && !stop) {
+                        lock.unlock();
+                        done(chunks, version);
+                        lock.lock();
+                    }
+                }
+            }
+
+            void verify(chunk &piece) {
+                if (!piece.mod || verified(piece)) {
+                    return;
+                }
+
+                diagnostics found;
+                for (auto &top : piece.mod->getBody()->getOperations()) {
+                    std::lock_guard lock(ctx_mutex);
+                    mlir::ScopedDiagnosticHandler handler(&ctx, [&] (mlir::Diagnostic &diag) {
+                        found.push_back(make_diagnostic(diag, path));
+                        return mlir::success();
+                    });
+                    (void) mlir::verify(&top);
+                }
+
+                std::lock_guard lock(mutex);
+                piece.verify_diagnostics = std::move(found);
+            }
+
+            std::string path;
+            mcontext_t &ctx;
+            std::mutex &ctx_mutex;
+            callback done;
+
+            mutable std::mutex mutex;
+            std::condition_variable wake;
+            bool stop = false, scheduled = false;
+            std::vector< placed_chunk > pending;
+            std::int64_t pending_version = 0;
+            std::chrono::steady_clock::time_point deadline;
+
+            // Started last, when the rest is initialized.
+            std::thread worker;
+        };
+
+        struct module_document final : document
+        {
+            module_document(
+                const proto::URIForFile &uri, std::string text, std::int64_t version,
+                mcontext_t &ctx, std::mutex &ctx_mutex, diagnostics_publisher publish
+            )
+                : uri(uri), path(uri.file().str()), text(std::move(text)), version(version)
+                , ctx(ctx), ctx_mutex(ctx_mutex), publish(std::move(publish))
+                , checker(path, ctx, ctx_mutex, [this] (const auto &verified, std::int64_t published) {
+                    publish(diagnostics(verified, published));
+                })
+            {
+                rebuild();
+            }
+
+            void update(
+                llvm::ArrayRef< proto::TextDocumentContentChangeEvent > changes, std::int64_t version
+            ) override {
+                if (mlir::failed(proto::TextDocumentContentChangeEvent::applyTo(changes, text))) {
+                    return;
+                }
+                this->version = version;
+                rebuild();
+            }
+
+            std::optional< proto::Hover > hover(proto::Position pos) const override {
+                auto id = identifier_at(text, pos);
+                if (!id) {
+                    return std::nullopt;
+                }
+
+                auto [symbol, _] = find(id->name, pos);
+                if (!symbol) {
+                    return std::nullopt;
+                }
+
+                proto::Hover result(id->range);
+                result.contents.kind  = proto::MarkupKind::Markdown;
+                result.contents.value = hover_markdown(symbol);
+                return result;
+            }
+
+            std::vector< proto::Location > definition(proto::Position pos) const override {
+                std::vector< proto::Location > result;
+                auto id = identifier_at(text, pos);
+                if (!id) {
+                    return result;
+                }
+
+                if (auto [symbol, placed] = find(id->name, pos); symbol) {
+                    add_location(result, *placed, symbol->getLoc());
+                }
+                return result;
+            }
+
+            std::vector< proto::Location > references(proto::Position pos, bool declaration) const override {
+                std::vector< proto::Location > result;
+                auto id = identifier_at(text, pos);
+                if (!id) {
+                    return result;
+                }
+
+                auto [symbol, placed] = find(id->name, pos);
+                if (!symbol) {
+                    return result;
+                }
+
+                if (declaration) {
+                    add_location(result, *placed, symbol->getLoc());
+                }
+
+                // Values of vast symbols are used in their chunk only.
+                if (mlir::isa< util::vast_symbol_interface >(symbol)) {
+                    for (auto user : symbol->getUsers()) {
+                        add_location(result, *placed, user->getLoc());
+                    }
+                    return result;
+                }
+
+                for (const auto &other : chunks) {
+                    if (!other.piece->mod) {
+                        continue;
+                    }
+
+                    auto uses = mlir::SymbolTable::getSymbolUses(other.piece->mod->getOperation());
+                    if (!uses) {
+                        continue;
+                    }
+
+                    for (const auto &use : *uses) {
+                        if (use.getSymbolRef().getRootReference().getValue() == id->name) {
+                            add_location(result, other, use.getUser()->getLoc());
+                        }
+                    }
+                }
+                return result;
+            }
+
+          private:
+            void rebuild() {
+                std::vector< placed_chunk > next;
+                llvm::StringMap< chunk_ptr > reused;
+                for (auto &split_piece : split(text)) {
+                    auto at = split_piece.at;
+                    auto it = parsed.find(split_piece.buffer);
+                    auto piece = it != parsed.end()
+                        ? it->second
+                        : parse(std::move(split_piece), path, ctx, ctx_mutex);
+                    reused.try_emplace(piece->buffer, piece);
+                    next.push_back({ piece, at });
+                }
+
+                parsed = std::move(reused);
+                chunks = std::move(next);
+
+                // Diagnostics of the parse now, those of the verification
+                // once the edits settle.
+                publish(diagnostics(chunks, version));
+                checker.schedule(chunks, version);
+            }
+
+            proto::PublishDiagnosticsParams diagnostics(
+                const std::vector< placed_chunk > &placed_chunks, std::int64_t version
+            ) const {
+                proto::PublishDiagnosticsParams params(uri, version);
+
+                auto add = [&] (const placed_chunk &placed, const chunk_diagnostic &diag) {
+                    proto::Position pos(int(placed.at.body_line), 0);
+                    if (diag.pos) {
+                        pos = proto::Position(
+                            int(placed.to_document(diag.pos->first)), int(diag.pos->second)
+                        );
+                    }
+
+                    proto::Diagnostic result;
+                    result.range    = proto::Range(pos);
+                    result.severity = diag.severity;
+                    result.source   = "vast";
+                    result.message  = diag.message;
+                    params.diagnostics.push_back(std::move(result));
+                };
+
+                for (const auto &placed : placed_chunks) {
+                    for (const auto &diag : placed.piece->parse_diagnostics) {
+                        add(placed, diag);
+                    }
+                    if (auto verified = checker.verified(*placed.piece)) {
+                        for (const auto &diag : *verified) {
+                            add(placed, diag);
+                        }
+                    }
+                }
+                return params;
+            }
+
+            const placed_chunk *chunk_at(unsigned line) const {
+                auto after = llvm::upper_bound(chunks, line, [] (unsigned line, const auto &placed) {
+                    return line < placed.at.body_line;
+                });
+                if (after == chunks.begin()) {
+                    return nullptr;
+                }
+                auto placed = std::prev(after);
+                return placed->contains(line) ? &*placed : nullptr;
+            }
+
+            // A name defined in the operation around the position wins over
+            // a top-level one.
+            std::pair< mlir::Operation *, const placed_chunk * > find(
+                string_ref name, proto::Position pos
+            ) const {
+                if (auto here = chunk_at(unsigned(pos.line))) {
+                    auto it = here->piece->nested_symbols.find(name);
+                    if (it != here->piece->nested_symbols.end()) {
+                        return { it->second.front(), here };
+                    }
+                }
+
+                for (const auto &placed : chunks) {
+                    auto it = placed.piece->top_symbols.find(name);
+                    if (it != placed.piece->top_symbols.end()) {
+                        return { it->second.front(), &placed };
+                    }
+                }
+                return { nullptr, nullptr };
+            }
+
+            // Locations in the buffer of a chunk are mapped to the document,
+            // those of other files, e.g., of the C source, are kept.
+            void add_location(
+                std::vector< proto::Location > &locations, const placed_chunk &placed,
+                mlir::Location loc
+            ) const {
+                auto file_loc = file_location(loc);
+                if (!file_loc) {
+                    return;
+                }
+
+                auto line   = file_loc->getLine() ? file_loc->getLine() - 1 : 0;
+                auto column = file_loc->getColumn() ? file_loc->getColumn() - 1 : 0;
+
+                auto file = file_loc->getFilename().getValue();
+                if (file == path) {
+                    proto::Position pos(int(placed.to_document(line)), int(column));
+                    locations.push_back({ uri, proto::Range(pos) });
+                    return;
+                }
+
+                auto other = proto::URIForFile::fromFile(file);
+                if (!other) {
+                    llvm::consumeError(other.takeError());
+                    return;
+                }
+                locations.push_back({ *other, proto::Range(proto::Position(int(line), int(column))) });
+            }
+
+            proto::URIForFile uri;
+            std::string path;
+            std::string text;
+            std::int64_t version;
+
+            mcontext_t &ctx;
+            std::mutex &ctx_mutex;
+            diagnostics_publisher publish;
+
+            // Parses by their buffers, of the current text only.
+            llvm::StringMap< chunk_ptr > parsed;
+            std::vector< placed_chunk > chunks;
+
+            // Destroyed first, its thread publishes through the document.
+            verifier checker;
+        };
+
+    } // namespace
+
+    document_ptr make_module_document(
+        const proto::URIForFile &uri, std::string text, std::int64_t version,
+        mcontext_t &ctx, std::mutex &ctx_mutex, diagnostics_publisher publish
+    ) {
+        return std::make_unique< module_document >(
+            uri, std::move(text), version, ctx, ctx_mutex, std::move(publish)
+        );
+    }
+
+} // namespace vast::lsp
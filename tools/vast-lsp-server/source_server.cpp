@@ -0,0 +1,627 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/lsp/source_server.hpp"
+#include "vast/lsp/document.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/PrecompiledPreamble.h>
+#include <clang/Lex/PreprocessorOptions.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/DialectRegistry.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/Tools/lsp-server-support/Logging.h>
+#include <mlir/Tools/lsp-server-support/Protocol.h>
+#include <mlir/Tools/lsp-server-support/Transport.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Action.hpp"
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/CompilerInvocation.hpp"
+#include "vast/Frontend/Diagnostics.hpp"
+#include "vast/Util/Metrics.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace vast::lsp
+{
+    //
+    // Metrics of the server, registered once, exported by `--metrics`.
+    //
+    struct method_metrics
+    {
+        explicit method_metrics(string_ref method)
+            : requests(metrics::registry::global().make_counter(
+                "vast_lsp_requests", "Requests of the language server.", {{ "method", method.str() }}
+            ))
+            , latency(metrics::registry::global().make_histogram(
+                "vast_lsp_request_seconds", "Seconds to answer a request.", {{ "method", method.str() }}
+            ))
+        {}
+
+        // Counts the request and times it until the end of the scope.
+        metrics::scoped_timer measure() {
+            requests.inc();
+            return metrics::scoped_timer(latency);
+        }
+
+        metrics::counter &requests;
+        metrics::histogram &latency;
+    };
+
+    struct server_metrics
+    {
+        static server_metrics &get() {
+            static server_metrics instance;
+            return instance;
+        }
+
+        method_metrics hover{ "textDocument/hover" };
+        method_metrics definition{ "textDocument/definition" };
+        method_metrics references{ "textDocument/references" };
+
+        metrics::counter &preamble_hits = metrics::registry::global().make_counter(
+            "vast_lsp_preamble_hits", "Compilations that reused the precompiled preamble."
+        );
+        metrics::counter &preamble_misses = metrics::registry::global().make_counter(
+            "vast_lsp_preamble_misses", "Compilations that built the precompiled preamble."
+        );
+        metrics::histogram &compile = metrics::registry::global().make_histogram(
+            "vast_lsp_compile_seconds", "Seconds to compile a source document to its module."
+        );
+        metrics::counter &compile_failures = metrics::registry::global().make_counter(
+            "vast_lsp_compile_failures", "Compilations of source documents without a module."
+        );
+        metrics::gauge &documents = metrics::registry::global().make_gauge(
+            "vast_lsp_open_documents", "Documents open in the server."
+        );
+    };
+
+    //
+    // Precompiled preamble of a document, its `#include`s and other
+    // directives before the first declaration. Edits of the rest of the
+    // document reuse it and parse the headers no more.
+    //
+    struct preamble_cache
+    {
+        // Empty if the document has no preamble or it cannot be built.
+        const clang::PrecompiledPreamble *get(
+            const clang::CompilerInvocation &invocation, const llvm::MemoryBuffer &buffer,
+            llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem > vfs,
+            clang::DiagnosticsEngine &diags
+        ) {
+            auto bounds = clang::ComputePreambleBounds(
+                *invocation.getLangOpts(), buffer.getMemBufferRef(), /* MaxLines */ 0
+            );
+
+            if (bounds.Size == 0) {
+                preamble.reset();
+                return nullptr;
+            }
+
+            if (preamble && preamble->CanReuse(invocation, buffer.getMemBufferRef(), bounds, *vfs)) {
+                server_metrics::get().preamble_hits.inc();
+                return &*preamble;
+            }
+
+            server_metrics::get().preamble_misses.inc();
+
+            clang::PreambleCallbacks callbacks;
+            auto built = clang::PrecompiledPreamble::Build(
+                invocation, &buffer, bounds, diags, vfs,
+                std::make_shared< clang::PCHContainerOperations >(),
+                /* StoreInMemory */ true, /* StoragePath */ "", callbacks
+            );
+
+            if (!built) {
+                preamble.reset();
+                return nullptr;
+            }
+
+            preamble.emplace(std::move(*built));
+            return &*preamble;
+        }
+
+      private:
+        std::optional< clang::PrecompiledPreamble > preamble;
+    };
+
+    // The text of the document stands in for the file on disk, which does
+    // not need to exist.
+    owning_module_ref emit_module(const std::string &path, string_ref text, preamble_cache &cache) {
+        std::vector< const char * > ccargs = { path.c_str() };
+        cc::buffered_diagnostics diags(ccargs);
+
+        auto comp = std::make_unique< cc::compiler_instance >();
+        auto success = cc::compiler_invocation::create_from_args(
+            comp->getInvocation(), diags.engine, ccargs, "vast-lsp-server"
+        );
+
+        if (comp->createDiagnostics(); !comp->hasDiagnostics()) {
+            return {};
+        }
+
+        diags.flush();
+        if (!success) {
+            comp->getDiagnosticClient().finish();
+            return {};
+        }
+
+        auto vfs         = llvm::vfs::getRealFileSystem();
+        auto buffer      = llvm::MemoryBuffer::getMemBufferCopy(text, path);
+        auto &invocation = comp->getInvocation();
+        if (auto preamble = cache.get(invocation, *buffer, vfs, comp->getDiagnostics())) {
+            preamble->AddImplicitPreamble(invocation, vfs, buffer.get());
+        }
+
+        // The compiler instance owns the buffer.
+        invocation.getPreprocessorOpts().addRemappedFile(path, buffer.release());
+        comp->createFileManager(vfs);
+
+        cc::vast_args vargs = {};
+        cc::emit_mlir_module action(vargs);
+        if (!comp->ExecuteAction(action)) {
+            return {};
+        }
+        return action.result();
+    }
+
+    //
+    // positions
+    //
+    std::optional< std::size_t > offset_of(string_ref text, proto::Position pos) {
+        std::size_t offset = 0;
+        for (int line = 0; line < pos.line; ++line) {
+            offset = text.find('\n', offset);
+            if (offset == string_ref::npos) {
+                return std::nullopt;
+            }
+            ++offset;
+        }
+
+        auto result = offset + std::size_t(pos.character);
+        return result <= text.size() ? std::optional(result) : std::nullopt;
+    }
+
+    std::optional< identifier > identifier_at(string_ref text, proto::Position pos) {
+        auto at = offset_of(text, pos);
+        if (!at) {
+            return std::nullopt;
+        }
+
+        auto is_identifier = [] (char c) { return llvm::isAlnum(c) || c == '_'; };
+
+        auto begin = *at, end = *at;
+        while (begin > 0 && is_identifier(text[begin - 1])) {
+            --begin;
+        }
+        while (end < text.size() && is_identifier(text[end])) {
+            ++end;
+        }
+
+        if (begin == end || llvm::isDigit(text[begin])) {
+            return std::nullopt;
+        }
+
+        return identifier{
+            text.slice(begin, end),
+            proto::Range(
+                proto::Position(pos.line, pos.character - int(*at - begin)),
+                proto::Position(pos.line, pos.character + int(end - *at))
+            )
+        };
+    }
+
+    std::optional< mlir::FileLineColLoc > file_location(mlir::Location loc) {
+        std::optional< mlir::FileLineColLoc > result;
+        loc->walk([&] (mlir::Location inner) {
+            if (auto file_loc = inner.dyn_cast< mlir::FileLineColLoc >()) {
+                result = file_loc;
+                return mlir::WalkResult::interrupt();
+            }
+            return mlir::WalkResult::advance();
+        });
+        return result;
+    }
+
+    std::string hover_markdown(mlir::Operation *op) {
+        std::string result;
+        llvm::raw_string_ostream os(result);
+        os << "```mlir\n";
+        op->print(os, mlir::OpPrintingFlags().skipRegions());
+        os << "\n```";
+        os.flush();
+        return result;
+    }
+
+    //
+    // Symbols of a module by name. A name may be defined in more scopes, a
+    // lookup prefers the definition in the top-level operation around the
+    // position, then a top-level one. Top-level operations of the document
+    // are ordered by their lines, an operation spans the lines up to the
+    // next one.
+    //
+    struct symbol_index
+    {
+        symbol_index(mlir::ModuleOp mod, string_ref path)
+            : mod(mod), users(mod.getOperation())
+        {
+            for (auto &top : mod.getBody()->getOperations()) {
+                auto loc = file_location(top.getLoc());
+                if (loc && loc->getFilename().getValue() == path) {
+                    tops.emplace_back(loc->getLine(), &top);
+                }
+
+                util::symbols(&top, [&] (auto symbol) {
+                    auto op = symbol.getOperation();
+                    symbols[util::symbol_name(symbol)].push_back({
+                        op, op == &top ? nullptr : &top
+                    });
+                });
+            }
+
+            llvm::stable_sort(tops, [] (const auto &a, const auto &b) {
+                return a.first < b.first;
+            });
+        }
+
+        mlir::Operation *lookup(string_ref name, proto::Position pos) const {
+            auto it = symbols.find(name);
+            if (it == symbols.end()) {
+                return nullptr;
+            }
+
+            auto line  = unsigned(pos.line) + 1;
+            auto after = llvm::upper_bound(tops, line, [] (unsigned line, const auto &top) {
+                return line < top.first;
+            });
+            auto scope = after == tops.begin() ? nullptr : std::prev(after)->second;
+
+            const auto &candidates = it->second;
+            for (const auto &candidate : candidates) {
+                if (candidate.scope && candidate.scope == scope) {
+                    return candidate.definition;
+                }
+            }
+
+            for (const auto &candidate : candidates) {
+                if (!candidate.scope) {
+                    return candidate.definition;
+                }
+            }
+
+            return candidates.front().definition;
+        }
+
+        void yield_users(mlir::Operation *symbol, auto &&yield) const {
+            if (auto op = mlir::dyn_cast< util::vast_symbol_interface >(symbol)) {
+                users.yield_users(op, mod, yield);
+            } else if (auto op = mlir::dyn_cast< util::mlir_symbol_interface >(symbol)) {
+                users.yield_users(op, mod, yield);
+            }
+        }
+
+      private:
+        struct definition
+        {
+            mlir::Operation *definition;
+            // Top-level operation of a nested definition.
+            mlir::Operation *scope;
+        };
+
+        mlir::ModuleOp mod;
+        util::symbol_user_map users;
+        llvm::StringMap< llvm::SmallVector< definition, 1 > > symbols;
+        std::vector< std::pair< unsigned, mlir::Operation * > > tops;
+    };
+
+    //
+    // C or C++ document. A failed compilation, e.g., of a half-written edit,
+    // keeps the module and the index of the last successful one.
+    //
+    struct source_document final : document
+    {
+        source_document(const proto::URIForFile &uri, std::string text)
+            : uri(uri), path(uri.file().str()), text(std::move(text))
+        {
+            compile();
+        }
+
+        void update(
+            llvm::ArrayRef< proto::TextDocumentContentChangeEvent > changes, std::int64_t
+        ) override {
+            if (mlir::failed(proto::TextDocumentContentChangeEvent::applyTo(changes, text))) {
+                proto::Logger::error("failed to apply the edits of {0}", uri.uri());
+                return;
+            }
+            compile();
+        }
+
+        std::optional< proto::Hover > hover(proto::Position pos) const override {
+            auto id = identifier_at(text, pos);
+            if (!id || !index) {
+                return std::nullopt;
+            }
+
+            auto symbol = index->lookup(id->name, pos);
+            if (!symbol) {
+                return std::nullopt;
+            }
+
+            proto::Hover result(id->range);
+            result.contents.kind  = proto::MarkupKind::Markdown;
+            result.contents.value = hover_markdown(symbol);
+            return result;
+        }
+
+        std::vector< proto::Location > definition(proto::Position pos) const override {
+            std::vector< proto::Location > result;
+            if (auto symbol = find(pos)) {
+                add_location(result, symbol->getLoc());
+            }
+            return result;
+        }
+
+        std::vector< proto::Location > references(proto::Position pos, bool declaration) const override {
+            std::vector< proto::Location > result;
+            auto symbol = find(pos);
+            if (!symbol) {
+                return result;
+            }
+
+            if (declaration) {
+                add_location(result, symbol->getLoc());
+            }
+
+            index->yield_users(symbol, [&] (mlir::Operation *user) {
+                add_location(result, user->getLoc());
+            });
+            return result;
+        }
+
+      private:
+        void compile() {
+            auto &measured = server_metrics::get();
+            owning_module_ref mod;
+            {
+                metrics::scoped_timer timer(measured.compile);
+                mod = emit_module(path, text, preamble);
+            }
+
+            if (!mod) {
+                measured.compile_failures.inc();
+                return;
+            }
+
+            index.reset();
+            this->mod = std::move(mod);
+            index.emplace(this->mod.get(), path);
+        }
+
+        mlir::Operation *find(proto::Position pos) const {
+            auto id = identifier_at(text, pos);
+            return id && index ? index->lookup(id->name, pos) : nullptr;
+        }
+
+        // Locations in other files, e.g., headers, are reported by their paths.
+        void add_location(std::vector< proto::Location > &locations, mlir::Location loc) const {
+            auto file_loc = file_location(loc);
+            if (!file_loc) {
+                return;
+            }
+
+            proto::Position pos(int(file_loc->getLine()) - 1, int(file_loc->getColumn()) - 1);
+
+            auto file = file_loc->getFilename().getValue();
+            if (file == path) {
+                locations.push_back({ uri, proto::Range(pos) });
+                return;
+            }
+
+            auto other = proto::URIForFile::fromFile(file);
+            if (!other) {
+                llvm::consumeError(other.takeError());
+                return;
+            }
+            locations.push_back({ *other, proto::Range(pos) });
+        }
+
+        proto::URIForFile uri;
+        std::string path;
+        std::string text;
+
+        preamble_cache preamble;
+        owning_module_ref mod;
+        std::optional< symbol_index > index;
+    };
+
+    //
+    // server
+    //
+    // Requests are answered on the main thread, diagnostics of modules are
+    // published from their verifiers too, so replies and notifications are
+    // sent under `output`.
+    //
+    struct source_server
+    {
+        source_server(proto::JSONTransport &transport, mlir::DialectRegistry &registry)
+            : handler(transport), ctx(registry)
+            , publish(handler.outgoingNotification< proto::PublishDiagnosticsParams >(
+                "textDocument/publishDiagnostics"
+            ))
+        {
+            ctx.loadAllAvailableDialects();
+
+            handler.method("initialize", this, &source_server::on_initialize);
+            handler.notification("initialized", this, &source_server::on_initialized);
+            handler.method("shutdown", this, &source_server::on_shutdown);
+
+            handler.notification("textDocument/didOpen", this, &source_server::on_open);
+            handler.notification("textDocument/didChange", this, &source_server::on_change);
+            handler.notification("textDocument/didClose", this, &source_server::on_close);
+
+            handler.method("textDocument/hover", this, &source_server::on_hover);
+            handler.method("textDocument/definition", this, &source_server::on_definition);
+            handler.method("textDocument/references", this, &source_server::on_references);
+        }
+
+        void on_initialize(const proto::InitializeParams &, proto::Callback< llvm::json::Value > reply) {
+            std::lock_guard lock(output);
+            llvm::json::Object capabilities{
+                { "textDocumentSync", llvm::json::Object{
+                    { "openClose", true },
+                    { "change", int(proto::TextDocumentSyncKind::Incremental) },
+                    { "save", true },
+                } },
+                { "hoverProvider", true },
+                { "definitionProvider", true },
+                { "referencesProvider", true },
+            };
+
+            reply(llvm::json::Object{
+                { "serverInfo", llvm::json::Object{
+                    { "name", "vast-lsp-server" }, { "version", "0.0.0" }
+                } },
+                { "capabilities", std::move(capabilities) },
+            });
+        }
+
+        void on_initialized(const proto::InitializedParams &) {}
+
+        void on_shutdown(const proto::NoParams &, proto::Callback< std::nullptr_t > reply) {
+            std::lock_guard lock(output);
+            shutdown = true;
+            reply(nullptr);
+        }
+
+        // Modules are recognized by their extension, anything else is
+        // compiled as a source.
+        void on_open(const proto::DidOpenTextDocumentParams &params) {
+            const auto &doc = params.textDocument;
+            auto &entry = documents[doc.uri.file()];
+            if (!entry) {
+                server_metrics::get().documents.inc();
+            }
+            entry.reset();
+            if (doc.uri.file().ends_with(".mlir")) {
+                entry = make_module_document(
+                    doc.uri, doc.text, doc.version, ctx, ctx_mutex,
+                    [this] (const proto::PublishDiagnosticsParams &diagnostics) {
+                        std::lock_guard lock(output);
+                        publish(diagnostics);
+                    }
+                );
+            } else {
+                entry = std::make_unique< source_document >(doc.uri, doc.text);
+            }
+        }
+
+        void on_change(const proto::DidChangeTextDocumentParams &params) {
+            if (auto doc = document(params.textDocument.uri)) {
+                doc->update(params.contentChanges, params.textDocument.version);
+            }
+        }
+
+        void on_close(const proto::DidCloseTextDocumentParams &params) {
+            if (documents.erase(params.textDocument.uri.file())) {
+                server_metrics::get().documents.dec();
+            }
+        }
+
+        void on_hover(
+            const proto::TextDocumentPositionParams &params,
+            proto::Callback< std::optional< proto::Hover > > reply
+        ) {
+            std::lock_guard lock(output);
+            auto timer = server_metrics::get().hover.measure();
+            auto doc = document(params.textDocument.uri);
+            reply(doc ? doc->hover(params.position) : std::nullopt);
+        }
+
+        void on_definition(
+            const proto::TextDocumentPositionParams &params,
+            proto::Callback< std::vector< proto::Location > > reply
+        ) {
+            std::lock_guard lock(output);
+            auto timer = server_metrics::get().definition.measure();
+            auto doc = document(params.textDocument.uri);
+            reply(doc ? doc->definition(params.position) : std::vector< proto::Location >{});
+        }
+
+        void on_references(
+            const proto::ReferenceParams &params,
+            proto::Callback< std::vector< proto::Location > > reply
+        ) {
+            std::lock_guard lock(output);
+            auto timer = server_metrics::get().references.measure();
+            auto doc = document(params.textDocument.uri);
+            reply(doc
+                ? doc->references(params.position, params.context.includeDeclaration)
+                : std::vector< proto::Location >{}
+            );
+        }
+
+        lsp::document *document(const proto::URIForFile &uri) {
+            auto it = documents.find(uri.file());
+            return it == documents.end() ? nullptr : it->second.get();
+        }
+
+        proto::MessageHandler handler;
+
+        // Context of modules, sources are compiled in their own.
+        mcontext_t ctx;
+        std::mutex ctx_mutex;
+
+        std::mutex output;
+        proto::OutgoingNotification< proto::PublishDiagnosticsParams > publish;
+
+        // Declared after what documents use, they are closed first.
+        llvm::StringMap< document_ptr > documents;
+        bool shutdown = false;
+    };
+
+    logical_result serve_sources(mlir::DialectRegistry &registry, bool lit_test, string_ref metrics_spec) {
+        // Metrics are exported from a thread of their own, every update is
+        // atomic.
+        std::unique_ptr< metrics::exporter > exporter;
+        if (!metrics_spec.empty()) {
+            server_metrics::get();
+            metrics::register_process_metrics();
+            exporter = metrics::exporter::make(metrics_spec);
+            if (!exporter) {
+                return mlir::failure();
+            }
+            exporter->start();
+        }
+
+        auto style = proto::JSONStreamStyle::Standard;
+        if (lit_test) {
+            style = proto::JSONStreamStyle::Delimited;
+            proto::URIForFile::registerSupportedScheme("test");
+        }
+
+        proto::JSONTransport transport(stdin, llvm::outs(), style, /* prettyOutput */ lit_test);
+        source_server server(transport, registry);
+
+        if (auto error = transport.run(server.handler)) {
+            proto::Logger::error("transport error: {0}", error);
+            llvm::consumeError(std::move(error));
+            return mlir::failure();
+        }
+
+        return mlir::success(server.shutdown);
+    }
+
+} // namespace vast::lsp
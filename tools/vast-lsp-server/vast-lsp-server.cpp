@@ -7,13 +7,37 @@ VAST_RELAX_WARNINGS
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/Tools/mlir-lsp-server/MlirLspServerMain.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/lsp/source_server.hpp"
 
 int main(int argc, char **argv) {
     mlir::DialectRegistry registry;
     mlir::registerAllDialects(registry);
     vast::registerAllDialects(registry);
+
+    // `--c-sources` serves C and C++ sources and parses modules incrementally,
+    // in place of the MLIR server, `--incremental-modules` is its alias for
+    // editors of modules only. `--metrics=<spec>` exports metrics of the
+    // server.
+    llvm::ArrayRef< char * > args(argv, argc);
+    auto has_flag = [&] (llvm::StringRef flag) {
+        return llvm::any_of(args.drop_front(), [&] (const char *arg) { return flag == arg; });
+    };
+
+    llvm::StringRef metrics;
+    for (llvm::StringRef arg : args.drop_front()) {
+        if (arg.consume_front("--metrics=")) {
+            metrics = arg;
+        }
+    }
+
+    if (has_flag("--c-sources") || has_flag("--incremental-modules")) {
+        return failed(vast::lsp::serve_sources(registry, has_flag("--lit-test"), metrics));
+    }
+
     return failed(MlirLspServerMain(argc, argv, registry));
 }
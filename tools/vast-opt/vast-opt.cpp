@@ -3,27 +3,236 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/ToolUtilities.h"
 #include "mlir/Target/LLVMIR/Dialect/All.h"
+#include "mlir/Tools/ParseUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Conversion/Passes.hpp"
 
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/HighLevel/Shard.hpp"
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Dialect/Dialects.hpp"
 
+namespace vast::cl
+{
+    // clang-format off
+    llvm::cl::opt< unsigned > shard{
+        "shard",
+        llvm::cl::desc("Split the module into N shards of functions, <output>.<i>.mlir, instead of running passes"),
+        llvm::cl::value_desc("N"),
+        llvm::cl::init(0)
+    };
+
+    llvm::cl::opt< unsigned > split_jobs{
+        "split-jobs",
+        llvm::cl::desc("Threads that process the splits of --split-input-file, all hardware threads by default, 1 processes them in order as mlir-opt does"),
+        llvm::cl::value_desc("N"),
+        llvm::cl::init(0)
+    };
+    // clang-format on
+} // namespace vast::cl
+
+namespace vast
+{
+    std::string shard_path(llvm::StringRef output, unsigned idx) {
+        auto ext = llvm::sys::path::extension(output);
+        llvm::SmallString< 256 > path(output);
+        llvm::sys::path::replace_extension(path, llvm::Twine(idx) + (ext.empty() ? ".mlir" : ext));
+        return std::string(path.str());
+    }
+
+    // Shards are written as text, each to be lowered by a separate process.
+    mlir::LogicalResult write_shards(
+        llvm::StringRef input, llvm::StringRef output, mlir::DialectRegistry &registry
+    ) {
+        if (output == "-") {
+            llvm::errs() << "error: --shard needs an output file, -o <path>\n";
+            return mlir::failure();
+        }
+
+        std::string err;
+        auto file = mlir::openInputFile(input, &err);
+        if (!file) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        llvm::SourceMgr source_mgr;
+        source_mgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+
+        mcontext_t ctx(registry);
+        auto mod = mlir::parseSourceFile< vast_module >(source_mgr, mlir::ParserConfig(&ctx));
+        if (!mod) {
+            return mlir::failure();
+        }
+
+        auto shards = hl::shard_module(*mod, cl::shard);
+        for (unsigned idx = 0; idx < shards.size(); ++idx) {
+            auto out = mlir::openOutputFile(shard_path(output, idx), &err);
+            if (!out) {
+                llvm::errs() << "error: " << err << "\n";
+                return mlir::failure();
+            }
+
+            shards[idx]->print(out->os());
+            out->os() << '\n';
+            out->keep();
+        }
+
+        return mlir::success();
+    }
+
+    //
+    // Splits of `--split-input-file` are independent: each is parsed in a
+    // context of its own, as in mlir-opt, and the passes of a split see only
+    // its module, so the splits can be processed concurrently.
+    //
+    struct split_result
+    {
+        std::string output;
+        std::string diagnostics;
+        bool failed = false;
+    };
+
+    mlir::LogicalResult process_split(
+        const std::shared_ptr< llvm::SourceMgr > &source_mgr, mcontext_t &ctx,
+        const mlir::MlirOptMainConfig &config, llvm::raw_ostream &os
+    ) {
+        auto op = mlir::parseSourceFileForTool(
+            source_mgr, mlir::ParserConfig(&ctx), !config.shouldUseExplicitModule()
+        );
+        if (!op) {
+            return mlir::failure();
+        }
+
+        mlir::PassManager pm(op.get()->getName(), mlir::PassManager::Nesting::Implicit);
+        pm.enableVerifier(config.shouldVerifyPasses());
+        if (mlir::failed(mlir::applyPassManagerCLOptions(pm))
+            || mlir::failed(config.setupPassPipeline(pm))
+            || mlir::failed(pm.run(*op))
+        ) {
+            return mlir::failure();
+        }
+
+        op.get()->print(os);
+        os << '\n';
+        return mlir::success();
+    }
+
+    // Contexts of the splits are single-threaded, the splits themselves run
+    // on the threads.
+    split_result process_split(
+        std::unique_ptr< llvm::MemoryBuffer > buffer, mlir::DialectRegistry &registry,
+        const mlir::MlirOptMainConfig &config
+    ) {
+        split_result result;
+        llvm::raw_string_ostream os(result.output);
+        llvm::raw_string_ostream diags(result.diagnostics);
+
+        mcontext_t ctx(registry, mcontext_t::Threading::DISABLED);
+        ctx.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+
+        auto source_mgr = std::make_shared< llvm::SourceMgr >();
+        source_mgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+
+        if (config.shouldVerifyDiagnostics()) {
+            ctx.printOpOnDiagnostic(false);
+            mlir::SourceMgrDiagnosticVerifierHandler handler(*source_mgr, &ctx, diags);
+            // Only the expected diagnostics matter, not the result.
+            (void) process_split(source_mgr, ctx, config, os);
+            result.failed = mlir::failed(handler.verify());
+        } else {
+            mlir::SourceMgrDiagnosticHandler handler(*source_mgr, &ctx, diags);
+            result.failed = mlir::failed(process_split(source_mgr, ctx, config, os));
+        }
+
+        os.flush();
+        diags.flush();
+        return result;
+    }
+
+    // Outputs and diagnostics of the splits are written in their order, the
+    // same as in a serial run.
+    mlir::LogicalResult process_splits_in_parallel(
+        llvm::StringRef input, llvm::StringRef output, mlir::DialectRegistry &registry,
+        const mlir::MlirOptMainConfig &config
+    ) {
+        std::string err;
+        auto file = mlir::openInputFile(input, &err);
+        if (!file) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        auto out = mlir::openOutputFile(output, &err);
+        if (!out) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        // The splitter of mlir-opt names the splits by their lines and warns
+        // of near misses of the marker.
+        std::vector< std::unique_ptr< llvm::MemoryBuffer > > splits;
+        (void) mlir::splitAndProcessBuffer(
+            std::move(file),
+            [&] (std::unique_ptr< llvm::MemoryBuffer > split, llvm::raw_ostream &) {
+                splits.push_back(std::move(split));
+                return mlir::success();
+            },
+            llvm::nulls(), /* enableSplitting */ true, /* insertMarkerInOutput */ false
+        );
+
+        std::vector< split_result > results(splits.size());
+        {
+            llvm::ThreadPool pool(llvm::hardware_concurrency(cl::split_jobs));
+            for (std::size_t idx = 0; idx < splits.size(); ++idx) {
+                pool.async([&, idx] {
+                    results[idx] = process_split(std::move(splits[idx]), registry, config);
+                });
+            }
+            pool.wait();
+        }
+
+        bool failed = false;
+        for (std::size_t idx = 0; idx < results.size(); ++idx) {
+            if (idx) {
+                out->os() << "\n// -----\n";
+            }
+            out->os() << results[idx].output;
+            llvm::errs() << results[idx].diagnostics;
+            failed |= results[idx].failed;
+        }
+
+        out->keep();
+        return mlir::failure(failed);
+    }
+
+    // Bytecode outputs of splits are written as mlir-opt does, in order.
+    bool parallel_splits(const mlir::MlirOptMainConfig &config) {
+        return config.shouldSplitInputFile() && cl::split_jobs != 1 && !config.shouldEmitBytecode();
+    }
+
+} // namespace vast
+
 int main(int argc, char **argv)
 {
     mlir::registerAllPasses();
@@ -39,7 +248,18 @@ int main(int argc, char **argv)
     // register conversions
     mlir::registerAllToLLVMIRTranslations(registry);
 
-    return failed(
-        mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry)
+    auto [input, output] = mlir::registerAndParseCLIOptions(
+        argc, argv, "VAST Optimizer driver\n", registry
     );
+
+    if (vast::cl::shard) {
+        return failed(vast::write_shards(input, output, registry));
+    }
+
+    auto config = mlir::MlirOptMainConfig::createFromCLOptions();
+    if (vast::parallel_splits(config)) {
+        return failed(vast::process_splits_in_parallel(input, output, registry, config));
+    }
+
+    return failed(mlir::MlirOptMain(argc, argv, input, output, registry));
 }
@@ -0,0 +1,189 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/query/callgraph.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace vast::query
+{
+    call_graph call_graph::build(std::vector< std::string > functions, std::vector< edge > edges) {
+        // A direct call of a pair sorts before an indirect one and is kept.
+        llvm::sort(edges, [] (const edge &a, const edge &b) {
+            return std::tie(a.caller, a.callee, a.indirect) < std::tie(b.caller, b.callee, b.indirect);
+        });
+
+        auto last = std::unique(edges.begin(), edges.end(), [] (const edge &a, const edge &b) {
+            return a.caller == b.caller && a.callee == b.callee;
+        });
+        edges.erase(last, edges.end());
+
+        call_graph graph(std::move(functions), std::move(edges));
+        graph.index();
+        graph.compute_components();
+        return graph;
+    }
+
+    call_graph call_graph::load(
+        std::vector< std::string > functions, std::vector< edge > edges,
+        std::vector< std::uint32_t > components
+    ) {
+        call_graph graph(std::move(functions), std::move(edges));
+        graph.components = std::move(components);
+        graph.index();
+        return graph;
+    }
+
+    void call_graph::index() {
+        auto size = functions.size();
+
+        for (std::uint32_t fn = 0; fn < size; ++fn) {
+            ids.try_emplace(functions[fn], fn);
+        }
+
+        first_callee.assign(size + 1, 0);
+        first_caller.assign(size + 1, 0);
+        for (const auto &e : edges) {
+            ++first_callee[e.caller + 1];
+            ++first_caller[e.callee + 1];
+        }
+
+        for (std::size_t fn = 0; fn < size; ++fn) {
+            first_callee[fn + 1] += first_callee[fn];
+            first_caller[fn + 1] += first_caller[fn];
+        }
+
+        // Edges are sorted by callers, so callers of a function are sorted too.
+        by_callee.resize(edges.size());
+        auto next = first_caller;
+        for (std::uint32_t e = 0; e < edges.size(); ++e) {
+            by_callee[next[edges[e].callee]++] = e;
+        }
+    }
+
+    //
+    // Tarjan's algorithm with an explicit stack, call chains of a large
+    // module would overflow the native one.
+    //
+    void call_graph::compute_components() {
+        constexpr auto unvisited = std::numeric_limits< std::uint32_t >::max();
+
+        auto size = functions.size();
+        std::vector< std::uint32_t > order(size, unvisited), low(size, 0);
+        std::vector< bool > on_stack(size, false);
+        std::vector< std::uint32_t > stack;
+
+        struct frame { std::uint32_t fn, next; };
+        std::vector< frame > frames;
+
+        components.assign(size, 0);
+        std::uint32_t counter = 0, component = 0;
+
+        auto visit = [&] (std::uint32_t fn) {
+            order[fn] = low[fn] = counter++;
+            stack.push_back(fn);
+            on_stack[fn] = true;
+            frames.push_back({ fn, first_callee[fn] });
+        };
+
+        for (std::uint32_t root = 0; root < size; ++root) {
+            if (order[root] != unvisited) {
+                continue;
+            }
+
+            visit(root);
+            while (!frames.empty()) {
+                auto fn = frames.back().fn;
+                if (frames.back().next < first_callee[fn + 1]) {
+                    auto callee = edges[frames.back().next++].callee;
+                    if (order[callee] == unvisited) {
+                        visit(callee);
+                    } else if (on_stack[callee]) {
+                        low[fn] = std::min(low[fn], order[callee]);
+                    }
+                    continue;
+                }
+
+                if (low[fn] == order[fn]) {
+                    std::uint32_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        on_stack[member] = false;
+                        components[member] = component;
+                    } while (member != fn);
+                    ++component;
+                }
+
+                frames.pop_back();
+                if (!frames.empty()) {
+                    auto caller = frames.back().fn;
+                    low[caller] = std::min(low[caller], low[fn]);
+                }
+            }
+        }
+    }
+
+    std::optional< std::uint32_t > call_graph::lookup(string_ref name) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::vector< bool > call_graph::reachable(llvm::ArrayRef< std::uint32_t > entries) const {
+        std::vector< bool > seen(size(), false);
+        std::vector< std::uint32_t > worklist;
+        for (auto fn : entries) {
+            if (!seen[fn]) {
+                seen[fn] = true;
+                worklist.push_back(fn);
+            }
+        }
+
+        while (!worklist.empty()) {
+            auto fn = worklist.back();
+            worklist.pop_back();
+            for_each_callee(fn, [&] (const edge &e) {
+                if (!seen[e.callee]) {
+                    seen[e.callee] = true;
+                    worklist.push_back(e.callee);
+                }
+            });
+        }
+
+        return seen;
+    }
+
+    std::vector< std::vector< std::uint32_t > > call_graph::recursive_components() const {
+        std::map< std::uint32_t, std::vector< std::uint32_t > > members;
+        for (std::uint32_t fn = 0; fn < size(); ++fn) {
+            members[components[fn]].push_back(fn);
+        }
+
+        auto calls_itself = [&] (std::uint32_t fn) {
+            bool result = false;
+            for_each_callee(fn, [&] (const edge &e) { result |= e.callee == fn; });
+            return result;
+        };
+
+        std::vector< std::vector< std::uint32_t > > result;
+        for (auto &[_, fns] : members) {
+            if (fns.size() > 1 || calls_itself(fns.front())) {
+                result.push_back(std::move(fns));
+            }
+        }
+
+        // Components in the order of their first functions.
+        llvm::sort(result, [] (const auto &a, const auto &b) { return a.front() < b.front(); });
+        return result;
+    }
+
+} // namespace vast::query
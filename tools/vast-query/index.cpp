@@ -0,0 +1,328 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/query/index.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::query
+{
+    namespace
+    {
+        constexpr llvm::StringLiteral magic = "VASTQIDX";
+        constexpr std::uint32_t version     = 2;
+
+        constexpr std::uint32_t has_stamp = 1 << 0;
+
+        // Offsets of the header fields.
+        constexpr std::size_t version_offset     = 8;
+        constexpr std::size_t flags_offset       = 12;
+        constexpr std::size_t size_offset        = 16;
+        constexpr std::size_t mtime_offset       = 24;
+        constexpr std::size_t num_views_offset   = 32;
+        constexpr std::size_t num_symbols_offset = 36;
+        constexpr std::size_t num_users_offset     = 40;
+        constexpr std::size_t num_functions_offset = 44;
+        constexpr std::size_t num_calls_offset     = 48;
+        constexpr std::size_t strings_offset       = 52;
+        constexpr std::size_t header_size          = 56;
+
+        // Strings are referred to by their offset and size.
+        constexpr std::size_t view_size     = 4 * sizeof(std::uint32_t);
+        constexpr std::size_t symbol_size   = 7 * sizeof(std::uint32_t);
+        constexpr std::size_t user_size     = 2 * sizeof(std::uint32_t);
+        constexpr std::size_t function_size = 3 * sizeof(std::uint32_t);
+        constexpr std::size_t call_size     = 3 * sizeof(std::uint32_t);
+
+    } // namespace
+
+    std::optional< source_stamp > get_source_stamp(string_ref path) {
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(path, status)) {
+            return std::nullopt;
+        }
+
+        auto mtime = status.getLastModificationTime().time_since_epoch().count();
+        return source_stamp{ status.getSize(), static_cast< std::uint64_t >(mtime) };
+    }
+
+    //
+    // index_builder
+    //
+    void index_builder::add_view(string_ref scope) {
+        views.push_back({ intern(scope), std::uint32_t(symbols.size()), 0 });
+    }
+
+    void index_builder::add_symbol(
+        string_ref name, string_ref text, std::uint32_t kinds,
+        const std::vector< std::string > &symbol_users
+    ) {
+        VAST_ASSERT(!views.empty());
+        symbols.push_back({
+            intern(name), intern(text), kinds,
+            std::uint32_t(users.size()), std::uint32_t(symbol_users.size())
+        });
+
+        for (const auto &user : symbol_users) {
+            users.push_back(intern(user));
+        }
+
+        ++views.back().size;
+    }
+
+    void index_builder::set_call_graph(const call_graph &graph) {
+        functions.clear();
+        calls.clear();
+
+        for (std::uint32_t fn = 0; fn < graph.size(); ++fn) {
+            functions.push_back({ intern(graph.name(fn)), graph.component(fn) });
+        }
+
+        for (const auto &e : graph.get_edges()) {
+            calls.push_back({ e.caller, e.callee, e.indirect });
+        }
+    }
+
+    // Users are printed once for every view they are seen from, the pool
+    // keeps a single copy of each.
+    auto index_builder::intern(string_ref str) -> string_entry {
+        auto [it, inserted] = interned.try_emplace(str, std::uint32_t(strings.size()));
+        if (inserted) {
+            strings.append(str.begin(), str.end());
+        }
+        return { it->second, std::uint32_t(str.size()) };
+    }
+
+    void index_builder::write(llvm::raw_ostream &os, std::optional< source_stamp > stamp) const {
+        llvm::support::endian::Writer out(os, llvm::support::little);
+
+        os << magic;
+        out.write< std::uint32_t >(version);
+        out.write< std::uint32_t >(stamp ? has_stamp : 0);
+        out.write< std::uint64_t >(stamp ? stamp->size : 0);
+        out.write< std::uint64_t >(stamp ? stamp->mtime : 0);
+        out.write< std::uint32_t >(std::uint32_t(views.size()));
+        out.write< std::uint32_t >(std::uint32_t(symbols.size()));
+        out.write< std::uint32_t >(std::uint32_t(users.size()));
+        out.write< std::uint32_t >(std::uint32_t(functions.size()));
+        out.write< std::uint32_t >(std::uint32_t(calls.size()));
+        out.write< std::uint32_t >(std::uint32_t(strings.size()));
+
+        for (const auto &view : views) {
+            out.write< std::uint32_t >({ view.name.offset, view.name.size, view.first, view.size });
+        }
+
+        for (const auto &sym : symbols) {
+            out.write< std::uint32_t >({
+                sym.name.offset, sym.name.size, sym.text.offset, sym.text.size,
+                sym.kinds, sym.first, sym.size
+            });
+        }
+
+        for (const auto &user : users) {
+            out.write< std::uint32_t >({ user.offset, user.size });
+        }
+
+        for (const auto &fn : functions) {
+            out.write< std::uint32_t >({ fn.name.offset, fn.name.size, fn.component });
+        }
+
+        for (const auto &call : calls) {
+            out.write< std::uint32_t >({ call.caller, call.callee, call.indirect });
+        }
+
+        os << strings;
+    }
+
+    //
+    // symbol_index
+    //
+    std::optional< symbol_index > symbol_index::open(string_ref path, std::string *err) {
+        auto buffer = llvm::MemoryBuffer::getFile(
+            path, /* IsText */ false, /* RequiresNullTerminator */ false
+        );
+
+        if (!buffer) {
+            *err = llvm::formatv("cannot open index '{0}': {1}", path, buffer.getError().message()).str();
+            return std::nullopt;
+        }
+
+        symbol_index index(std::move(*buffer));
+        if (!index.verify(err)) {
+            *err = llvm::formatv("malformed index '{0}': {1}", path, *err).str();
+            return std::nullopt;
+        }
+
+        return index;
+    }
+
+    std::uint32_t symbol_index::read32(std::size_t offset) const {
+        return llvm::support::endian::read32le(buffer->getBufferStart() + offset);
+    }
+
+    std::uint64_t symbol_index::read64(std::size_t offset) const {
+        return llvm::support::endian::read64le(buffer->getBufferStart() + offset);
+    }
+
+    // Layout of the arrays follows from the counts of the header.
+    bool symbol_index::verify(std::string *err) const {
+        auto size = buffer->getBufferSize();
+        if (size < header_size || !buffer->getBuffer().starts_with(magic)) {
+            *err = "not a symbol index";
+            return false;
+        }
+
+        if (read32(version_offset) != version) {
+            *err = "unsupported version";
+            return false;
+        }
+
+        std::uint64_t views   = read32(num_views_offset);
+        std::uint64_t symbols = read32(num_symbols_offset);
+        std::uint64_t users     = read32(num_users_offset);
+        std::uint64_t functions = read32(num_functions_offset);
+        std::uint64_t calls     = read32(num_calls_offset);
+        std::uint64_t strings   = read32(strings_offset);
+
+        auto expected = header_size + views * view_size + symbols * symbol_size
+                      + users * user_size + functions * function_size
+                      + calls * call_size + strings;
+        if (expected != size || views == 0) {
+            *err = "truncated index";
+            return false;
+        }
+
+        auto strings_start = size - strings;
+        auto valid_string = [&] (std::size_t offset) {
+            return std::uint64_t(read32(offset)) + read32(offset + 4) <= strings;
+        };
+
+        auto views_start = header_size;
+        for (std::uint64_t v = 0; v < views; ++v) {
+            auto at = views_start + v * view_size;
+            if (!valid_string(at) || std::uint64_t(read32(at + 8)) + read32(at + 12) > symbols) {
+                *err = "invalid view";
+                return false;
+            }
+        }
+
+        auto symbols_start = views_start + views * view_size;
+        for (std::uint64_t s = 0; s < symbols; ++s) {
+            auto at = symbols_start + s * symbol_size;
+            if (!valid_string(at) || !valid_string(at + 8)
+                || std::uint64_t(read32(at + 20)) + read32(at + 24) > users
+            ) {
+                *err = "invalid symbol";
+                return false;
+            }
+        }
+
+        auto users_start = symbols_start + symbols * symbol_size;
+        for (std::uint64_t u = 0; u < users; ++u) {
+            if (!valid_string(users_start + u * user_size)) {
+                *err = "invalid user";
+                return false;
+            }
+        }
+
+        // Edges of the graph have to be sorted and unique, the graph is
+        // indexed as it is read.
+        auto functions_start = users_start + users * user_size;
+        for (std::uint64_t f = 0; f < functions; ++f) {
+            auto at = functions_start + f * function_size;
+            if (!valid_string(at) || read32(at + 8) >= functions) {
+                *err = "invalid function";
+                return false;
+            }
+        }
+
+        auto calls_start = functions_start + functions * function_size;
+        for (std::uint64_t c = 0; c < calls; ++c) {
+            auto at = calls_start + c * call_size;
+            auto caller = read32(at), callee = read32(at + 4);
+            if (caller >= functions || callee >= functions || read32(at + 8) > 1) {
+                *err = "invalid call";
+                return false;
+            }
+
+            if (c > 0) {
+                auto prev = std::pair(read32(at - call_size), read32(at - call_size + 4));
+                if (!(prev < std::pair(caller, callee))) {
+                    *err = "unsorted calls";
+                    return false;
+                }
+            }
+        }
+
+        VAST_ASSERT(calls_start + calls * call_size == strings_start);
+        return true;
+    }
+
+    string_ref symbol_index::read_string(std::size_t offset) const {
+        auto pool = buffer->getBufferSize() - read32(strings_offset);
+        return buffer->getBuffer().substr(pool + read32(offset), read32(offset + 4));
+    }
+
+    std::optional< source_stamp > symbol_index::stamp() const {
+        if (!(read32(flags_offset) & has_stamp)) {
+            return std::nullopt;
+        }
+        return source_stamp{ read64(size_offset), read64(mtime_offset) };
+    }
+
+    std::uint32_t symbol_index::num_views() const { return read32(num_views_offset); }
+
+    string_ref symbol_index::view_name(std::uint32_t v) const {
+        return read_string(header_size + v * view_size);
+    }
+
+    std::pair< std::uint32_t, std::uint32_t > symbol_index::view_symbols(std::uint32_t v) const {
+        auto at = header_size + v * view_size;
+        return { read32(at + 8), read32(at + 12) };
+    }
+
+    auto symbol_index::get_symbol(std::uint32_t idx) const -> symbol {
+        auto symbols_start = header_size + num_views() * view_size;
+        auto users_start   = symbols_start + read32(num_symbols_offset) * symbol_size;
+
+        auto at = symbols_start + std::size_t(idx) * symbol_size;
+        symbol sym{ read_string(at), read_string(at + 8), read32(at + 16), {} };
+
+        auto first = read32(at + 20);
+        auto size  = read32(at + 24);
+        for (auto u = first; u < first + size; ++u) {
+            sym.users.push_back(read_string(users_start + std::size_t(u) * user_size));
+        }
+
+        return sym;
+    }
+
+    call_graph symbol_index::get_call_graph() const {
+        auto functions_start = header_size + num_views() * view_size
+                             + std::size_t(read32(num_symbols_offset)) * symbol_size
+                             + std::size_t(read32(num_users_offset)) * user_size;
+        auto num_functions = read32(num_functions_offset);
+        auto calls_start   = functions_start + std::size_t(num_functions) * function_size;
+
+        std::vector< std::string > functions;
+        std::vector< std::uint32_t > components;
+        for (std::uint32_t f = 0; f < num_functions; ++f) {
+            auto at = functions_start + std::size_t(f) * function_size;
+            functions.push_back(read_string(at).str());
+            components.push_back(read32(at + 8));
+        }
+
+        std::vector< call_graph::edge > edges;
+        for (std::uint32_t c = 0; c < read32(num_calls_offset); ++c) {
+            auto at = calls_start + std::size_t(c) * call_size;
+            edges.push_back({ read32(at), read32(at + 4), read32(at + 8) != 0 });
+        }
+
+        return call_graph::load(std::move(functions), std::move(edges), std::move(components));
+    }
+
+} // namespace vast::query
@@ -0,0 +1,370 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/query/pattern.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/OpDefinition.h>
+#include <mlir/Interfaces/CallInterfaces.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/GlobPattern.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include <vector>
+
+namespace vast::query
+{
+    struct op_pattern::node
+    {
+        enum class kind { callee, attr, operand, contains, inside };
+
+        struct constraint
+        {
+            kind what;
+            bool negated = false;
+            // Symbol of the callee or the value of the attribute.
+            std::optional< llvm::GlobPattern > glob;
+            std::string attr;
+            unsigned index = 0;
+            // An operand without a nested pattern is to be constant.
+            bool value_negated = false;
+            std::unique_ptr< node > nested;
+        };
+
+        // Operations named by any of the globs, meeting every constraint.
+        std::vector< llvm::GlobPattern > names;
+        std::vector< constraint > constraints;
+    };
+
+    namespace
+    {
+        using node = op_pattern::node;
+
+        bool matches(const node &pattern, operation op);
+
+        // Values computed from constants only, e.g., `hl.const` or its casts.
+        // A value read from memory, returned by a call or computed in a
+        // region is not constant.
+        bool is_constant(mlir_value value) {
+            auto op = value.getDefiningOp();
+            if (!op) {
+                return false;
+            }
+
+            if (op->hasTrait< mlir::OpTrait::ConstantLike >()) {
+                return true;
+            }
+
+            if (op->getNumRegions() != 0 || mlir::isa< mlir::CallOpInterface >(op)) {
+                return false;
+            }
+
+            if (mlir::isa< hl::LValueType >(value.getType())) {
+                return false;
+            }
+
+            return llvm::all_of(op->getOperands(), is_constant);
+        }
+
+        std::optional< string_ref > callee(operation op) {
+            auto call = mlir::dyn_cast< mlir::CallOpInterface >(op);
+            if (!call) {
+                return std::nullopt;
+            }
+
+            if (auto symbol = call.getCallableForCallee().dyn_cast< mlir::SymbolRefAttr >()) {
+                return symbol.getLeafReference().getValue();
+            }
+            return std::nullopt;
+        }
+
+        // Strings and symbols match by their value, other attributes by the
+        // way they are printed.
+        std::string show_attr(mlir::Attribute attr) {
+            if (auto str = mlir::dyn_cast< mlir::StringAttr >(attr)) {
+                return str.str();
+            }
+
+            if (auto symbol = mlir::dyn_cast< mlir::SymbolRefAttr >(attr)) {
+                return symbol.getLeafReference().str();
+            }
+
+            std::string buff;
+            llvm::raw_string_ostream ss(buff);
+            attr.print(ss);
+            return ss.str();
+        }
+
+        bool contains(const node &pattern, operation op) {
+            for (auto &region : op->getRegions()) {
+                auto result = region.walk([&] (operation nested) {
+                    return matches(pattern, nested) ? mlir::WalkResult::interrupt() : mlir::WalkResult::advance();
+                });
+                if (result.wasInterrupted()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool inside(const node &pattern, operation op) {
+            for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+                if (matches(pattern, parent)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool holds(const node::constraint &c, operation op) {
+            switch (c.what) {
+                case node::kind::callee: {
+                    auto name = callee(op);
+                    return name && c.glob->match(*name);
+                }
+                case node::kind::attr: {
+                    auto attr = op->getAttr(c.attr);
+                    return attr && (!c.glob || c.glob->match(show_attr(attr)));
+                }
+                case node::kind::operand: {
+                    if (c.index >= op->getNumOperands()) {
+                        return false;
+                    }
+
+                    auto value = op->getOperand(c.index);
+                    bool found = false;
+                    if (!c.nested) {
+                        found = is_constant(value);
+                    } else if (auto def = value.getDefiningOp()) {
+                        found = matches(*c.nested, def);
+                    }
+                    return found != c.value_negated;
+                }
+                case node::kind::contains: return contains(*c.nested, op);
+                case node::kind::inside:   return inside(*c.nested, op);
+            }
+            VAST_UNREACHABLE("unknown kind of constraint");
+        }
+
+        bool matches(const node &pattern, operation op) {
+            auto name = op->getName().getStringRef();
+            if (llvm::none_of(pattern.names, [&] (const auto &glob) { return glob.match(name); })) {
+                return false;
+            }
+
+            return llvm::all_of(pattern.constraints, [&] (const auto &c) {
+                return holds(c, op) != c.negated;
+            });
+        }
+
+        //
+        // Recursive descent parser of patterns. Tokens are the punctuation
+        // characters and the runs of other characters between them and
+        // whitespace, e.g., globs of names.
+        //
+        struct parser
+        {
+            parser(string_ref text, std::string *err)
+                : text(text), rest(text), err(err)
+            {}
+
+            std::unique_ptr< node > parse() {
+                auto root = pattern();
+                if (root && !peek().empty()) {
+                    return fail("unexpected '" + peek() + "'");
+                }
+                return root;
+            }
+
+          private:
+            static bool is_punct(char c) { return llvm::StringRef("()|,!=").contains(c); }
+
+            string_ref peek() {
+                rest = rest.ltrim();
+                if (rest.empty()) {
+                    return {};
+                }
+
+                if (is_punct(rest.front())) {
+                    return rest.take_front();
+                }
+
+                return rest.take_until([] (char c) { return llvm::isSpace(c) || is_punct(c); });
+            }
+
+            string_ref next() {
+                auto token = peek();
+                rest = rest.drop_front(token.size());
+                return token;
+            }
+
+            bool consume(string_ref token) {
+                if (peek() != token) {
+                    return false;
+                }
+                next();
+                return true;
+            }
+
+            std::nullptr_t fail(const llvm::Twine &msg) {
+                if (err && err->empty()) {
+                    *err = llvm::formatv(
+                        "invalid pattern at column {0}: {1}", text.size() - rest.size() + 1, msg.str()
+                    ).str();
+                }
+                return nullptr;
+            }
+
+            bool expect(string_ref token) {
+                if (consume(token)) {
+                    return true;
+                }
+                auto found = peek();
+                auto shown = found.empty() ? std::string("the end") : "'" + found.str() + "'";
+                fail("expected '" + token + "', found " + shown);
+                return false;
+            }
+
+            std::optional< llvm::GlobPattern > glob(string_ref what) {
+                auto token = peek();
+                if (token.empty() || is_punct(token.front())) {
+                    fail("expected " + what);
+                    return std::nullopt;
+                }
+
+                auto compiled = llvm::GlobPattern::create(token);
+                if (!compiled) {
+                    fail(llvm::toString(compiled.takeError()));
+                    return std::nullopt;
+                }
+
+                next();
+                return std::move(*compiled);
+            }
+
+            std::unique_ptr< node > pattern() {
+                auto result = std::make_unique< node >();
+                do {
+                    auto name = glob("a name of an operation");
+                    if (!name) {
+                        return nullptr;
+                    }
+                    result->names.push_back(std::move(*name));
+                } while (consume("|"));
+
+                // Constraints end with the pattern they are nested in.
+                for (auto token = peek(); !token.empty() && token != ")" && token != ","; token = peek()) {
+                    node::constraint c;
+                    if (!constraint(c)) {
+                        return nullptr;
+                    }
+                    result->constraints.push_back(std::move(c));
+                }
+
+                return result;
+            }
+
+            bool constraint(node::constraint &c) {
+                while (consume("!")) {
+                    c.negated = !c.negated;
+                }
+
+                auto keyword = next();
+                auto kind = llvm::StringSwitch< std::optional< node::kind > >(keyword)
+                    .Case("callee", node::kind::callee)
+                    .Case("attr", node::kind::attr)
+                    .Case("operand", node::kind::operand)
+                    .Case("contains", node::kind::contains)
+                    .Case("inside", node::kind::inside)
+                    .Default(std::nullopt);
+                if (!kind) {
+                    fail("unknown constraint '" + keyword + "'");
+                    return false;
+                }
+
+                c.what = *kind;
+                if (!expect("(")) {
+                    return false;
+                }
+
+                switch (c.what) {
+                    case node::kind::callee:
+                        c.glob = glob("a name of a callee");
+                        if (!c.glob) {
+                            return false;
+                        }
+                        break;
+                    case node::kind::attr: {
+                        auto name = next();
+                        if (name.empty() || is_punct(name.front())) {
+                            fail("expected a name of an attribute");
+                            return false;
+                        }
+                        c.attr = name.str();
+                        if (consume("=")) {
+                            c.glob = glob("a value of an attribute");
+                            if (!c.glob) {
+                                return false;
+                            }
+                        }
+                        break;
+                    }
+                    case node::kind::operand: {
+                        if (next().getAsInteger(10, c.index)) {
+                            fail("expected an index of an operand");
+                            return false;
+                        }
+                        if (!expect(",")) {
+                            return false;
+                        }
+                        while (consume("!")) {
+                            c.value_negated = !c.value_negated;
+                        }
+                        if (!consume("const")) {
+                            c.nested = pattern();
+                            if (!c.nested) {
+                                return false;
+                            }
+                        }
+                        break;
+                    }
+                    case node::kind::contains:
+                    case node::kind::inside:
+                        c.nested = pattern();
+                        if (!c.nested) {
+                            return false;
+                        }
+                        break;
+                }
+
+                return expect(")");
+            }
+
+            string_ref text;
+            string_ref rest;
+            std::string *err;
+        };
+
+    } // namespace
+
+    std::optional< op_pattern > op_pattern::parse(string_ref text, std::string *err) {
+        parser p(text, err);
+        auto root = p.parse();
+        if (!root) {
+            return std::nullopt;
+        }
+        return op_pattern(std::shared_ptr< const node >(std::move(root)));
+    }
+
+    bool op_pattern::match(operation op) const {
+        return matches(*root, op);
+    }
+
+} // namespace vast::query
@@ -3,8 +3,11 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Pass/Pass.h"
@@ -12,8 +15,20 @@ VAST_RELAX_WARNINGS
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "mlir/Parser/Parser.h"
+#include "mlir/Bytecode/BytecodeReader.h"
 
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Regex.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
@@ -23,9 +38,21 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/HighLevel/Linker.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/HighLevel/RecordLayout.hpp"
+#include "vast/Dialect/Meta/MetaStore.hpp"
+#include "vast/Target/LLVMIR/EmbeddedHL.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/Metrics.hpp"
 #include "vast/Util/Symbols.hpp"
+#include "vast/query/callgraph.hpp"
+#include "vast/query/index.hpp"
+#include "vast/query/pattern.hpp"
+
+#include <iostream>
+#include <mutex>
 
 using memory_buffer  = std::unique_ptr< llvm::MemoryBuffer >;
 
@@ -38,14 +65,18 @@ namespace vast::cl
         none, function, type, record, var, global, all
     };
 
+    enum class output_format { text, ndjson };
+
+    enum class callgraph_query { none, callers, callees, reachable, sccs };
+
     cl::OptionCategory generic("Vast Generic Options");
     cl::OptionCategory queries("Vast Queries Options");
 
     struct vast_query_options {
-        cl::opt< std::string > input_file{
-            cl::desc("<input file>"),
+        cl::list< std::string > input_files{
+            cl::desc("<input files or directories>"),
             cl::Positional,
-            cl::init("-"),
+            cl::ZeroOrMore,
             cl::cat(generic)
         };
         cl::opt< show_symbol_type > show_symbols{ "show-symbols",
@@ -61,18 +92,101 @@ namespace vast::cl
             cl::init(show_symbol_type::none),
             cl::cat(queries)
         };
-        cl::opt< std::string > show_symbol_users{ "symbol-users",
-            cl::desc("Show users of a given symbol"),
-            cl::value_desc("symbol name"),
+        cl::list< std::string > show_symbol_users{ "symbol-users",
+            cl::desc("Show users of given symbols, the users of each are preceded by its name if there are more"),
+            cl::value_desc("symbol names"),
+            cl::CommaSeparated,
+            cl::cat(queries)
+        };
+        cl::opt< bool > storage_report{ "storage-report",
+            cl::desc("Show uniqued types, attributes and locations by kind and operations by dialect"),
+            cl::init(false),
+            cl::cat(queries)
+        };
+        cl::opt< bool > layout_report{ "layout-report",
+            cl::desc("Show field offsets, padding holes and cache-line boundaries of records, ordered by wasted bytes times uses"),
+            cl::init(false),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > record{ "record",
+            cl::desc("Restrict the layout report to a record, given by its name or a typedef of it"),
+            cl::value_desc("record name"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > at{ "at",
+            cl::desc("Show operations at a location, each after the function it is in"),
+            cl::value_desc("file:line[:col][-line]"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > meta_store{ "meta-store",
+            cl::desc("Show operations with blobs in a metadata store, by their meta identifiers or those of their locations"),
+            cl::value_desc("store file"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > match{ "match",
+            cl::desc("Show operations matching a structural pattern, each after the function it is in"),
+            cl::value_desc("pattern"),
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< callgraph_query > callgraph{ "callgraph",
+            cl::desc("Query the call graph of the module"),
+            cl::values(
+                clEnumValN(callgraph_query::callers, "callers", "show callers of --functions"),
+                clEnumValN(callgraph_query::callees, "callees", "show callees of --functions"),
+                clEnumValN(callgraph_query::reachable, "reachable", "show functions reachable from --functions, main by default"),
+                clEnumValN(callgraph_query::sccs, "sccs", "show recursive strongly connected components")
+            ),
+            cl::init(callgraph_query::none),
+            cl::cat(queries)
+        };
+        cl::list< std::string > functions{ "functions",
+            cl::desc("Functions of call graph queries"),
+            cl::value_desc("function names"),
+            cl::CommaSeparated,
+            cl::cat(queries)
+        };
+        cl::opt< output_format > format{ "format",
+            cl::desc("Format of the results of symbol queries"),
+            cl::values(
+                clEnumValN(output_format::text, "text", "lines of text"),
+                clEnumValN(output_format::ndjson, "ndjson", "a JSON object per line")
+            ),
+            cl::init(output_format::text),
+            cl::cat(queries)
+        };
         cl::opt< std::string > scope_name{ "scope",
             cl::desc("Show values from scope of a given function"),
             cl::value_desc("function name"),
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< std::string > build_index{ "build-index",
+            cl::desc("Write an index of symbols and their users for later queries"),
+            cl::value_desc("index file"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > index{ "index",
+            cl::desc("Answer symbol queries from an index, the input is parsed only if the index is out of date"),
+            cl::value_desc("index file"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< bool > serve{ "serve",
+            cl::desc("Load the input modules once and answer JSON-RPC queries, a request per line of the standard input"),
+            cl::init(false),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > metrics{ "metrics",
+            cl::desc("Export metrics of --serve in the OpenMetrics format, over http of [host]:port or to a file path[@seconds]"),
+            cl::value_desc("spec"),
+            cl::init(""),
+            cl::cat(generic)
+        };
     };
     // clang-format on
 
@@ -83,11 +197,105 @@ namespace vast::cl
 
 namespace vast::query
 {
-    bool show_symbols() { return cl::options->show_symbols != cl::show_symbol_type::none; }
+    //
+    // Parameters of a query. The command line gives one, the server builds
+    // one for every request it answers.
+    //
+    struct query_request
+    {
+        cl::show_symbol_type symbols = cl::show_symbol_type::none;
+        std::vector< std::string > symbol_users;
+        std::string scope;
+        std::string at;
+        cl::callgraph_query callgraph = cl::callgraph_query::none;
+        std::vector< std::string > functions;
+        bool storage_report = false;
+        bool layout_report = false;
+        std::string record;
+        std::string meta_store;
+        // Compiled by `run` or the server from the text of `--match`.
+        std::string match;
+        std::optional< op_pattern > pattern;
+        bool ndjson = false;
+
+        static query_request from_options() {
+            const auto &opts = *cl::options;
+
+            query_request req;
+            req.symbols        = opts.show_symbols;
+            req.symbol_users   = { opts.show_symbol_users.begin(), opts.show_symbol_users.end() };
+            req.scope          = opts.scope_name;
+            req.at             = opts.at;
+            req.callgraph      = opts.callgraph;
+            req.functions      = { opts.functions.begin(), opts.functions.end() };
+            req.storage_report = opts.storage_report;
+            req.layout_report  = opts.layout_report;
+            req.record         = opts.record;
+            req.meta_store     = opts.meta_store;
+            req.match          = opts.match;
+            req.ndjson         = opts.format == cl::output_format::ndjson;
+            return req;
+        }
+
+        bool show_symbols() const { return symbols != cl::show_symbol_type::none; }
+
+        bool show_symbol_users() const { return !symbol_users.empty(); }
+
+        bool constrained_scope() const { return !scope.empty(); }
+
+        bool show_storage_report() const { return storage_report; }
+
+        bool show_layout_report() const { return layout_report; }
+
+        bool show_located() const { return !at.empty(); }
 
-    bool show_symbol_users() { return !cl::options->show_symbol_users.empty(); }
+        bool show_metadata() const { return !meta_store.empty(); }
 
-    bool constrained_scope() { return !cl::options->scope_name.empty(); }
+        bool show_matches() const { return pattern.has_value(); }
+
+        bool show_callgraph() const { return callgraph != cl::callgraph_query::none; }
+
+        llvm::SmallVector< string_ref > symbol_user_names() const {
+            return { symbol_users.begin(), symbol_users.end() };
+        }
+
+        bool is_shown(std::uint32_t kinds) const {
+            switch (symbols) {
+                case cl::show_symbol_type::all:      return true;
+                case cl::show_symbol_type::type:     return kinds & type_symbol;
+                case cl::show_symbol_type::record:   return kinds & record_symbol;
+                case cl::show_symbol_type::var:      return kinds & var_symbol;
+                case cl::show_symbol_type::global:   return kinds & global_symbol;
+                case cl::show_symbol_type::function: return kinds & function_symbol;
+                case cl::show_symbol_type::none:     return false;
+            }
+            VAST_UNREACHABLE("unknown kind of symbols");
+        }
+    };
+
+    bool build_index() { return !cl::options->build_index.empty(); }
+
+    bool use_index() { return !cl::options->index.empty(); }
+
+    bool serve() { return cl::options->serve; }
+
+    string_ref metrics_spec() { return cl::options->metrics; }
+
+    // Indices are of a single module, `run` rejects other inputs.
+    string_ref input_file() {
+        auto &inputs = cl::options->input_files;
+        return inputs.empty() ? string_ref("-") : string_ref(inputs.front());
+    }
+
+    // Storage and layout reports need the module itself, the index keeps only
+    // the text of the results of symbol queries.
+    bool answer_from_index(const query_request &req) {
+        if (!use_index()) {
+            return false;
+        }
+        return req.show_callgraph()
+            || (!req.ndjson && (req.show_symbols() || req.show_symbol_users()));
+    }
 
     template< typename... Ts >
     auto is_one_of() {
@@ -102,112 +310,1831 @@ namespace vast::query
         };
     }
 
-    void show_value(auto value) {
-        llvm::outs() << util::show_symbol_value(value) << "\n";
+    void show_value(llvm::raw_ostream &os, auto value) {
+        os << util::show_symbol_value(value) << "\n";
     }
 
-    logical_result do_show_symbols(auto scope) {
-        auto &show_kind = cl::options->show_symbols;
+    std::uint32_t symbol_kinds(mlir::Operation *op) {
+        std::uint32_t kinds = 0;
+        if (is_one_of< hl::TypeDefOp, hl::TypeDeclOp >()(op))
+            kinds |= type_symbol;
+        if (is_one_of< hl::StructDeclOp >()(op))
+            kinds |= record_symbol;
+        if (is_one_of< hl::VarDeclOp >()(op))
+            kinds |= var_symbol;
+        if (is_global< hl::VarDeclOp >()(op))
+            kinds |= global_symbol;
+        if (is_one_of< hl::FuncOp >()(op))
+            kinds |= function_symbol;
+        return kinds;
+    }
 
-        auto show_if = [=](auto symbol, auto pred) {
-            if (pred(symbol))
-                show_value(symbol);
+    //
+    // Census of uniqued storage reachable from a scope. Every distinct type and
+    // attribute is counted once, recursively including its parameters. Memory is
+    // an estimate: the storage header, a pointer per parameter that is a type or
+    // an attribute, and the characters of strings. Storage of parameters of other
+    // kinds (integers, enums, ...) is not accounted for.
+    //
+    struct storage_census
+    {
+        struct stats
+        {
+            std::uint64_t count = 0;
+            std::uint64_t bytes = 0;
         };
 
-        auto filter_kind = [=](cl::show_symbol_type kind) {
-            return [=](auto symbol) {
-                switch (kind) {
-                    case cl::show_symbol_type::all: show_value(symbol); break;
-                    case cl::show_symbol_type::type:
-                        show_if(symbol, is_one_of< hl::TypeDefOp, hl::TypeDeclOp >());
-                        break;
-                    case cl::show_symbol_type::record:
-                        show_if(symbol, is_one_of< hl::StructDeclOp >());
-                        break;
-                    case cl::show_symbol_type::var:
-                        show_if(symbol, is_one_of< hl::VarDeclOp >());
-                        break;
-                    case cl::show_symbol_type::global:
-                        show_if(symbol, is_global< hl::VarDeclOp >());
-                        break;
-                    case cl::show_symbol_type::function:
-                        show_if(symbol, is_one_of< hl::FuncOp >());
-                        break;
-                    case cl::show_symbol_type::none: break;
+        llvm::StringMap< stats > types;
+        llvm::StringMap< stats > attrs;
+        llvm::StringMap< stats > locs;
+        llvm::StringMap< std::uint64_t > ops;
+
+        llvm::DenseSet< mlir::Type > seen_types;
+        llvm::DenseSet< mlir::Attribute > seen_attrs;
+
+        static std::uint64_t parameters(auto entity) {
+            std::uint64_t count = 0;
+            entity.walkImmediateSubElements(
+                [&](mlir::Attribute) { ++count; }, [&](mlir::Type) { ++count; }
+            );
+            return count;
+        }
+
+        void add_nested(auto entity) {
+            entity.walkImmediateSubElements(
+                [&](mlir::Attribute attr) { add(attr); }, [&](mlir::Type type) { add(type); }
+            );
+        }
+
+        void add(mlir::Type type) {
+            if (!type || !seen_types.insert(type).second) {
+                return;
+            }
+
+            auto &entry = types[type.getAbstractType().getName()];
+            ++entry.count;
+            entry.bytes += sizeof(mlir::TypeStorage) + sizeof(void *) * parameters(type);
+
+            add_nested(type);
+        }
+
+        void add(mlir::Attribute attr) {
+            if (!attr || !seen_attrs.insert(attr).second) {
+                return;
+            }
+
+            auto &by_kind = mlir::isa< mlir::LocationAttr >(attr) ? locs : attrs;
+            auto &entry   = by_kind[attr.getAbstractAttribute().getName()];
+            ++entry.count;
+            entry.bytes += sizeof(mlir::AttributeStorage) + sizeof(void *) * parameters(attr);
+            if (auto str = mlir::dyn_cast< mlir::StringAttr >(attr)) {
+                entry.bytes += str.size();
+            }
+
+            add_nested(attr);
+        }
+
+        void add(mlir::Operation *op) {
+            ++ops[op->getName().getDialectNamespace()];
+
+            add(op->getLoc());
+            add(op->getAttrDictionary());
+            for (auto type : op->getResultTypes()) {
+                add(type);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto arg : block.getArguments()) {
+                        add(arg.getType());
+                        add(arg.getLoc());
+                    }
                 }
-            };
-        };
+            }
+        }
+
+        static void print(llvm::raw_ostream &os, string_ref title, const llvm::StringMap< stats > &table) {
+            llvm::SmallVector< std::pair< string_ref, stats > > rows;
+            stats total;
+            for (const auto &entry : table) {
+                rows.emplace_back(entry.getKey(), entry.getValue());
+                total.count += entry.getValue().count;
+                total.bytes += entry.getValue().bytes;
+            }
+
+            llvm::sort(rows, [](const auto &a, const auto &b) {
+                return std::tie(b.second.bytes, a.first) < std::tie(a.second.bytes, b.first);
+            });
+
+            os << llvm::formatv("{0}: {1} uniqued, ~{2} bytes\n", title, total.count, total.bytes);
+            for (const auto &[kind, row] : rows) {
+                os << llvm::formatv("{0,10} {1,12}  {2}\n", row.count, row.bytes, kind);
+            }
+            os << "\n";
+        }
+
+        void print(llvm::raw_ostream &os) const {
+            print(os, "types", types);
+            print(os, "attributes", attrs);
+            print(os, "locations", locs);
 
-        util::symbols(scope, filter_kind(show_kind));
+            llvm::SmallVector< std::pair< string_ref, std::uint64_t > > rows;
+            std::uint64_t total = 0;
+            for (const auto &entry : ops) {
+                rows.emplace_back(entry.getKey(), entry.getValue());
+                total += entry.getValue();
+            }
+
+            llvm::sort(rows, [](const auto &a, const auto &b) {
+                return std::tie(b.second, a.first) < std::tie(a.second, b.first);
+            });
+
+            os << llvm::formatv("operations: {0}\n", total);
+            for (const auto &[dialect, count] : rows) {
+                os << llvm::formatv("{0,10}  {1}\n", count, dialect.empty() ? "<unknown>" : dialect);
+            }
+        }
+    };
+
+    logical_result do_storage_report(mlir::Operation *scope, llvm::raw_ostream &os) {
+        if (!scope) {
+            return mlir::failure();
+        }
+
+        storage_census census;
+        scope->walk([&](mlir::Operation *op) { census.add(op); });
+        census.print(os);
         return mlir::success();
     }
 
-    logical_result do_show_users(auto scope) {
-        auto &name = cl::options->show_symbol_users;
-        util::yield_users(name.getValue(), scope, [](auto user) {
-            user->print(llvm::outs());
-            llvm::outs() << util::show_location(*user) << "\n";
-        });
+    //
+    // Layout of records in the manner of pahole: fields with their offsets and
+    // sizes, holes between them and boundaries of cache lines. Records are
+    // ordered by the bytes of their padding times the number of values in the
+    // scope of a type built from the record (the record itself, pointers to
+    // it, typedefs of it, ...), i.e., by how much memory traffic the padding
+    // probably costs.
+    //
+    struct layout_report
+    {
+        static constexpr std::uint64_t cache_line = 64 * 8;
+
+        struct entry
+        {
+            hl::StructDeclOp decl;
+            string_ref name;
+            const hl::record_layout *layout;
+            llvm::SmallVector< string_ref > aliases;
+            std::uint64_t uses = 0;
+
+            std::uint64_t wasted() const { return llvm::divideCeil(layout->padding, 8); }
+            std::uint64_t score() const { return wasted() * uses; }
+        };
+
+        layout_report(vast_module mod, mlir::Operation *scope)
+            : layouts(mod)
+        {
+            for (auto def : mod.getOps< hl::TypeDefOp >()) {
+                auto type = hl::getBottomTypedefType(def.getType(), mod);
+                if (auto name = hl::name_of_record(type)) {
+                    aliases[*name].push_back(def.getName());
+                    records_of[def.getName()] = *name;
+                }
+            }
+
+            for (auto decl : mod.getOps< hl::StructDeclOp >()) {
+                auto layout = layouts.lookup(hl::RecordType::get(mod.getContext(), decl.getName()));
+                if (!layout) {
+                    continue;
+                }
+
+                entries.push_back({ decl, decl.getName(), layout, aliases.lookup(decl.getName()) });
+            }
+
+            count_uses(scope);
+
+            llvm::sort(entries, [] (const auto &a, const auto &b) {
+                return std::make_tuple(b.score(), b.layout->padding, a.name)
+                     < std::make_tuple(a.score(), a.layout->padding, b.name);
+            });
+        }
+
+        // Reference to the record by its name or by a typedef of it.
+        bool matches(const entry &e, string_ref name) const {
+            return e.name == name || llvm::is_contained(e.aliases, name);
+        }
+
+        void print(llvm::raw_ostream &os, string_ref record) const {
+            for (const auto &e : entries) {
+                if (record.empty() || matches(e, record)) {
+                    print(os, e);
+                }
+            }
+        }
+
+        bool has(string_ref record) const {
+            return llvm::any_of(entries, [&] (const auto &e) { return matches(e, record); });
+        }
 
+      private:
+        void records_in(mlir_type type, llvm::SmallSetVector< string_ref, 2 > &out) const {
+            if (auto record = mlir::dyn_cast< hl::RecordType >(type)) {
+                out.insert(record.getName());
+            } else if (auto def = mlir::dyn_cast< hl::TypedefType >(type)) {
+                if (auto it = records_of.find(def.getName()); it != records_of.end()) {
+                    out.insert(it->second);
+                }
+            }
+
+            type.walkImmediateSubElements(
+                [] (mlir::Attribute) {}, [&] (mlir_type nested) { records_in(nested, out); }
+            );
+        }
+
+        void count_uses(mlir::Operation *scope) {
+            llvm::StringMap< std::uint64_t > uses;
+            auto add = [&] (mlir_value value) {
+                llvm::SmallSetVector< string_ref, 2 > records;
+                records_in(value.getType(), records);
+                for (auto name : records) {
+                    ++uses[name];
+                }
+            };
+
+            scope->walk([&] (mlir::Operation *op) {
+                for (auto result : op->getResults()) {
+                    add(result);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            add(arg);
+                        }
+                    }
+                }
+            });
+
+            for (auto &e : entries) {
+                e.uses = uses.lookup(e.name);
+            }
+        }
+
+        // Typedef names are kept, as they are what the source spells.
+        static std::string type_name(mlir_type type) {
+            type = hl::strip_elaborated(type);
+
+            std::string dims;
+            while (auto array = mlir::dyn_cast< hl::ArrayType >(type)) {
+                auto size = array.getSize();
+                dims += size ? llvm::formatv("[{0}]", *size).str() : std::string("[]");
+                type = hl::strip_elaborated(array.getElementType());
+            }
+
+            std::string out;
+            if (auto def = mlir::dyn_cast< hl::TypedefType >(type)) {
+                out = def.getName().str();
+            } else if (auto record = mlir::dyn_cast< hl::RecordType >(type)) {
+                out = record.getName().str();
+            } else if (auto ptr = mlir::dyn_cast< hl::PointerType >(type)) {
+                out = type_name(ptr.getElementType()) + " *";
+            } else {
+                llvm::raw_string_ostream ss(out);
+                type.print(ss);
+                ss.flush();
+                string_ref name = out;
+                if (name.consume_front("!hl.")) {
+                    out = name.str();
+                }
+            }
+
+            return out + dims;
+        }
+
+        static std::string show_bits(std::uint64_t bits) {
+            if (bits % 8 == 0) {
+                return llvm::formatv("{0} bytes", bits / 8);
+            }
+            return llvm::formatv("{0} bits", bits);
+        }
+
+        static void boundary(llvm::raw_ostream &os, std::uint64_t line) {
+            os << llvm::formatv("\n\t/* --- cacheline {0} boundary ({1} bytes) --- */\n", line, line * cache_line / 8);
+        }
+
+        void print(llvm::raw_ostream &os, const entry &e) const {
+            const auto &layout = *e.layout;
+
+            os << "struct " << e.name << " {";
+            if (!e.aliases.empty()) {
+                os << " /* typedef " << llvm::join(e.aliases, ", ") << " */";
+            }
+            os << "\n";
+
+            std::uint64_t end = 0, line = 0, holes = 0, hole_bits = 0, members = 0;
+            auto fields = layout.fields.begin();
+            for (auto field : hl::field_defs(e.decl)) {
+                if (fields == layout.fields.end()) {
+                    break;
+                }
+                const auto &placed = *fields++;
+
+                for (; placed.offset >= (line + 1) * cache_line; ++line) {
+                    boundary(os, line + 1);
+                }
+
+                if (placed.offset > end) {
+                    ++holes;
+                    hole_bits += placed.offset - end;
+                    os << "\n\t/* XXX " << show_bits(placed.offset - end) << " hole, try to pack */\n";
+                }
+
+                auto decl = type_name(placed.type) + " " + field.getName().str();
+                if (placed.bits) {
+                    auto unit = placed.unit ? layout.units[*placed.unit].size / 8 : 0;
+                    decl += llvm::formatv(":{0}", *placed.bits).str();
+                    os << llvm::formatv(
+                        "\t{0,-40} /* {1,5}:{2,2} {3,5} */\n",
+                        decl + ";", placed.offset / 8, placed.offset % 8, unit
+                    );
+                } else {
+                    os << llvm::formatv(
+                        "\t{0,-40} /* {1,5}    {2,5} */\n", decl + ";", placed.offset / 8, placed.size / 8
+                    );
+                }
+
+                auto last = placed.size ? (placed.offset + placed.size - 1) / cache_line : line;
+                if (last > line) {
+                    line = last;
+                    os << llvm::formatv(
+                        "\n\t/* --- cacheline {0} boundary ({1} bytes) was {2} bytes ago --- */\n",
+                        line, line * cache_line / 8, (placed.offset + placed.size - line * cache_line) / 8
+                    );
+                }
+
+                ++members;
+                end = std::max(end, placed.offset + placed.size);
+            }
+
+            auto tail = layout.size > end ? layout.size - end : 0;
+            if (tail) {
+                os << "\n\t/* XXX " << show_bits(tail) << " padding */\n";
+            }
+
+            auto lines = llvm::divideCeil(layout.size, cache_line);
+            os << llvm::formatv(
+                "\n\t/* size: {0}, align: {1}, cachelines: {2}, members: {3} */\n",
+                layout.size / 8, layout.align / 8, lines, members
+            );
+            os << llvm::formatv(
+                "\t/* holes: {0}, sum holes: {1}, padding: {2} */\n",
+                holes, show_bits(hole_bits), show_bits(tail)
+            );
+            if (auto rest = layout.size % cache_line) {
+                os << llvm::formatv("\t/* last cacheline: {0} bytes */\n", rest / 8);
+            }
+            os << llvm::formatv(
+                "\t/* uses: {0}, wasted: {1} bytes, score: {2} */\n", e.uses, e.wasted(), e.score()
+            );
+            os << "};\n\n";
+        }
+
+        hl::record_layout_analysis layouts;
+        llvm::StringMap< llvm::SmallVector< string_ref > > aliases;
+        // Record named by every typedef of a record.
+        llvm::StringMap< std::string > records_of;
+        std::vector< entry > entries;
+    };
+
+    logical_result do_layout_report(
+        vast_module mod, mlir::Operation *scope, const query_request &req, llvm::raw_ostream &os
+    ) {
+        if (!scope) {
+            return mlir::failure();
+        }
+
+        layout_report report(mod, scope);
+        if (!req.record.empty() && !report.has(req.record)) {
+            llvm::errs() << "error: unknown record '" << req.record << "'\n";
+            return mlir::failure();
+        }
+
+        report.print(os, req.record);
         return mlir::success();
     }
-} // namespace vast::query
 
-namespace vast
-{
-    logical_result get_scope_operation(auto parent, std::string_view scope_name, auto yield) {
-        auto result =mlir::success();
-        util::symbol_tables(parent, [&](mlir::Operation *op) {
-            if (failed(yield(mlir::SymbolTable::lookupSymbolIn(op, scope_name)))) {
-                result = mlir::failure();
+    std::string show_operation(mlir::Operation *op) {
+        std::string buff;
+        llvm::raw_string_ostream ss(buff);
+        op->print(ss, mlir::OpPrintingFlags().skipRegions());
+        return ss.str();
+    }
+
+    std::string show_user(mlir::Operation *user) {
+        std::string buff;
+        llvm::raw_string_ostream ss(buff);
+        user->print(ss);
+        ss << util::show_location(*user);
+        return ss.str();
+    }
+
+    // Users of a symbol are preceded by its name, if users of more symbols are shown.
+    struct user_printer
+    {
+        user_printer(llvm::ArrayRef< string_ref > names, llvm::raw_ostream &os)
+            : os(os), headers(names.size() > 1)
+        {}
+
+        void operator()(string_ref name, string_ref user) {
+            if (headers && last != name) {
+                os << name << ":\n";
+                last = name;
             }
-        });
+            os << user << "\n";
+        }
 
-        return result;
+      private:
+        llvm::raw_ostream &os;
+        bool headers;
+        std::optional< string_ref > last;
+    };
+
+    // Name of the nearest named operation enclosing `op`, e.g., its function.
+    std::optional< string_ref > parent_scope(mlir::Operation *op) {
+        for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+            if (auto name = parent->getAttrOfType< mlir::StringAttr >(
+                mlir::SymbolTable::getSymbolAttrName()
+            )) {
+                return name.getValue();
+            }
+
+            if (auto symbol = mlir::dyn_cast< util::vast_symbol_interface >(parent)) {
+                return symbol.getSymbolName();
+            }
+        }
+
+        return std::nullopt;
     }
 
-    logical_result do_query(mcontext_t &ctx, memory_buffer buffer) {
-        llvm::SourceMgr source_mgr;
-        source_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    //
+    // Results of symbol queries, lines of text or, with `--format=ndjson`,
+    // a JSON object per result streamed to the output. Objects of a module
+    // queried along with other modules carry the path of the module.
+    //
+    struct result_printer
+    {
+        result_printer(llvm::raw_ostream &os, const query_request &req, string_ref module)
+            : os(os), module(module), ndjson(req.ndjson), users(req.symbol_user_names(), os)
+        {}
 
-        mlir::SourceMgrDiagnosticHandler manager_handler(source_mgr, &ctx);
+        void symbol(auto op) {
+            if (!ndjson) {
+                show_value(os, op);
+                return;
+            }
 
-        // Disable multi-threading when parsing the input file. This removes the
-        // unnecessary/costly context synchronization when parsing.
-        bool wasThreadingEnabled = ctx.isMultithreadingEnabled();
-        ctx.disableMultithreading();
+            record("symbol", op, [&] (auto &json) {
+                json.attribute("name", util::symbol_name(op));
+            });
+        }
 
-        owning_module_ref mod(mlir::parseSourceFile< vast_module >(source_mgr, &ctx));
-        ctx.enableMultithreading(wasThreadingEnabled);
-        if (!mod) {
-            llvm::errs() << "error: cannot parse module\n";
-            return mlir::failure();
+        void user(string_ref name, mlir::Operation *op) {
+            if (!ndjson) {
+                users(name, show_user(op));
+                return;
+            }
+
+            record("user", op, [&] (auto &json) {
+                json.attribute("symbol", name);
+
+                std::string text;
+                llvm::raw_string_ostream ss(text);
+                op->print(ss);
+                json.attribute("text", ss.str());
+            });
         }
 
-        auto process_scope = [&] (auto scope) {
-            if (query::show_symbols()) {
-                return query::do_show_symbols(scope);
+        // Operations at a location follow the function they are in, a
+        // function at the location is shown only once.
+        void located(mlir::Operation *op) {
+            auto fn = mlir::isa< hl::FuncOp >(op) ? op : op->getParentOfType< hl::FuncOp >();
+            in_function("op", op, fn);
+        }
+
+        // Operations matching a pattern, `fn` is the function matched.
+        void matched(mlir::Operation *op, mlir::Operation *fn) {
+            in_function("match", op, fn);
+        }
+
+        void metadata(mlir::Operation *op, meta::identifier_t id, string_ref blob) {
+            if (ndjson) {
+                record("meta", op, [&] (auto &json) {
+                    json.attribute("identifier", id);
+                    json.attribute("text", show_operation(op));
+                    json.attribute("blob", llvm::json::isUTF8(blob) ? blob.str() : llvm::json::fixUTF8(blob));
+                });
+                return;
+            }
+
+            os << id << ": " << show_operation(op) << util::show_location(*op)
+               << " (" << blob.size() << " bytes)\n";
+        }
+
+      private:
+        void in_function(string_ref kind, mlir::Operation *op, mlir::Operation *fn) {
+            if (ndjson) {
+                record(kind, op, [&] (auto &json) {
+                    json.attribute("text", show_operation(op));
+                    if (fn) {
+                        auto symbol = mlir::cast< util::mlir_symbol_interface >(fn);
+                        json.attribute("function", util::symbol_name(symbol));
+                    } else {
+                        json.attribute("function", nullptr);
+                    }
+                });
+                return;
             }
 
-            if (query::show_symbol_users()) {
-                return query::do_show_users(scope);
+            if (fn && fn != last_function) {
+                show_value(os, mlir::cast< util::mlir_symbol_interface >(fn));
+                last_function = fn;
             }
 
-            return mlir::success();
+            if (op != fn) {
+                os << (fn ? "  " : "") << show_operation(op) << util::show_location(*op) << "\n";
+            }
+        }
+
+        void record(string_ref kind, mlir::Operation *op, auto &&fields) {
+            llvm::json::OStream json(os);
+            json.object([&] {
+                json.attribute("kind", kind);
+                if (!module.empty()) {
+                    json.attribute("module", module);
+                }
+
+                json.attribute("op", op->getName().getStringRef());
+                fields(json);
+
+                json.attributeBegin("location");
+                location(json, op->getLoc());
+                json.attributeEnd();
+
+                if (auto scope = parent_scope(op)) {
+                    json.attribute("scope", *scope);
+                } else {
+                    json.attribute("scope", nullptr);
+                }
+            });
+            os << "\n";
+        }
+
+        static void location(llvm::json::OStream &json, mlir::Location loc) {
+            if (auto file_loc = loc.dyn_cast< mlir::FileLineColLoc >()) {
+                json.object([&] {
+                    json.attribute("file", file_loc.getFilename().getValue());
+                    json.attribute("line", file_loc.getLine());
+                    json.attribute("column", file_loc.getColumn());
+                });
+                return;
+            }
+
+            std::string buff;
+            llvm::raw_string_ostream ss(buff);
+            ss << loc;
+            json.value(ss.str());
+        }
+
+        llvm::raw_ostream &os;
+        string_ref module;
+        bool ndjson;
+        user_printer users;
+        mlir::Operation *last_function = nullptr;
+    };
+
+    // Functions and globals are found without a walk of function bodies,
+    // types and records may be local to a function.
+    bool outside_functions(cl::show_symbol_type kind) {
+        return kind == cl::show_symbol_type::function
+            || kind == cl::show_symbol_type::global
+            || kind == cl::show_symbol_type::none;
+    }
+
+    logical_result do_show_symbols(auto scope, const query_request &req, result_printer &print) {
+        auto yield = [&] (auto symbol) {
+            if (req.is_shown(symbol_kinds(symbol)))
+                print.symbol(symbol);
         };
 
-        mlir::Operation *scope = mod.get();
-        if (query::constrained_scope()) {
-            return get_scope_operation(scope, cl::options->scope_name, process_scope);
+        if (outside_functions(req.symbols)) {
+            util::global_symbols(scope, yield);
         } else {
-            return process_scope(scope);
+            util::symbols(scope, yield);
         }
+        return mlir::success();
     }
 
-    logical_result run(mcontext_t &ctx) {
-        std::string err;
-        if (auto input = mlir::openInputFile(cl::options->input_file, &err))
-            return do_query(ctx, std::move(input));
+    //
+    // Range of `--at`. `file:line` selects a line, `file:line:col` a single
+    // position and `file:line[:col]-line` the lines up to the end of the last
+    // one. The file matches a path equal to it or ending with it after a
+    // separator.
+    //
+    struct location_range
+    {
+        using position = std::pair< unsigned, unsigned >;
+
+        std::string file;
+        position begin, end;
+
+        static std::optional< location_range > parse(string_ref spec) {
+            llvm::Regex pattern("^(.+):([0-9]+)(:([0-9]+))?(-([0-9]+))?$");
+            llvm::SmallVector< string_ref, 7 > groups;
+            if (!pattern.match(spec, &groups)) {
+                return std::nullopt;
+            }
+
+            auto number = [] (string_ref str) {
+                unsigned value = 0;
+                return str.getAsInteger(10, value) ? std::nullopt : std::optional(value);
+            };
+
+            auto line   = number(groups[2]);
+            auto column = groups[4].empty() ? std::optional(0u) : number(groups[4]);
+            auto last   = groups[6].empty() ? line : number(groups[6]);
+            if (!line || !column || !last) {
+                return std::nullopt;
+            }
+
+            location_range range{ groups[1].str(), { *line, *column }, { *last, UINT_MAX } };
+            if (!groups[4].empty() && groups[6].empty()) {
+                range.end = range.begin;
+            }
+
+            if (range.end < range.begin) {
+                return std::nullopt;
+            }
+
+            return range;
+        }
+
+        bool matches(string_ref path) const {
+            if (!path.ends_with(file)) {
+                return false;
+            }
+
+            auto rest = path.drop_back(file.size());
+            return rest.empty() || llvm::sys::path::is_separator(rest.back());
+        }
+    };
+
+    //
+    // Operations of a scope sorted by their file locations, for each file by
+    // line and column. An operation with a fused location is found at each
+    // of its file locations. A lookup of a range is logarithmic in the number
+    // of operations of the matched files.
+    //
+    struct location_index
+    {
+        explicit location_index(mlir::Operation *scope) {
+            scope->walk([&] (mlir::Operation *op) {
+                op->getLoc()->walk([&] (mlir::Location loc) {
+                    if (auto file_loc = loc.dyn_cast< mlir::FileLineColLoc >()) {
+                        files[file_loc.getFilename().getValue()].push_back({
+                            { file_loc.getLine(), file_loc.getColumn() }, op
+                        });
+                    }
+                    return mlir::WalkResult::advance();
+                });
+            });
+
+            // Operations at the same position stay in the order of the walk.
+            for (auto &entry : files) {
+                llvm::stable_sort(entry.second, [] (const auto &a, const auto &b) {
+                    return a.pos < b.pos;
+                });
+            }
+        }
+
+        // Operations in `range` in the order of their locations, each once.
+        void lookup(const location_range &range, auto &&yield) const {
+            llvm::SmallVector< string_ref > matched;
+            for (const auto &entry : files) {
+                if (range.matches(entry.getKey())) {
+                    matched.push_back(entry.getKey());
+                }
+            }
+            llvm::sort(matched);
+
+            llvm::SetVector< mlir::Operation * > found;
+            for (auto file : matched) {
+                const auto &ops = files.find(file)->second;
+                auto first = llvm::lower_bound(ops, range.begin, [] (const auto &e, const auto &pos) {
+                    return e.pos < pos;
+                });
+                auto last = llvm::upper_bound(ops, range.end, [] (const auto &pos, const auto &e) {
+                    return pos < e.pos;
+                });
+
+                for (auto it = first; it < last; ++it) {
+                    found.insert(it->op);
+                }
+            }
+
+            for (auto op : found) {
+                yield(op);
+            }
+        }
+
+      private:
+        struct entry
+        {
+            location_range::position pos;
+            mlir::Operation *op;
+        };
+
+        llvm::StringMap< std::vector< entry > > files;
+    };
+
+    logical_result do_show_located(mlir::Operation *scope, const query_request &req, result_printer &print) {
+        auto range = location_range::parse(req.at);
+        VAST_CHECK(range, "invalid location range, it is validated by run");
+
+        location_index index(scope);
+        index.lookup(*range, [&] (auto op) { print.located(op); });
+        return mlir::success();
+    }
+
+    logical_result do_show_metadata(mlir::Operation *scope, const query_request &req, result_printer &print) {
+        std::string err;
+        auto store = meta::store::open(req.meta_store, &err);
+        if (!store) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        meta::identifier_index index(scope);
+        store->for_each_attached(index, [&] (auto op, auto id, auto blob) {
+            print.metadata(op, id, blob);
+        });
+        return mlir::success();
+    }
+
+    logical_result do_show_users(mlir::Operation *scope, const query_request &req, result_printer &print) {
+        util::yield_users(req.symbol_user_names(), scope, [&] (string_ref name, auto user) {
+            print.user(name, user);
+        });
+
+        return mlir::success();
+    }
+
+    //
+    // Operations of the functions of a scope that match the pattern of
+    // `--match`, the functions themselves included. Functions are matched on
+    // the thread pool of the context, each into a buffer of its own. A buffer
+    // is written out as soon as the functions before it are done, so results
+    // stream in the order of the functions whatever the scheduling.
+    //
+    logical_result do_match(
+        mlir::Operation *scope, const query_request &req, llvm::raw_ostream &os, string_ref module
+    ) {
+        std::vector< mlir::Operation * > functions;
+        scope->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *op) {
+            if (mlir::isa< mlir::FunctionOpInterface >(op)) {
+                functions.push_back(op);
+                return mlir::WalkResult::skip();
+            }
+            return mlir::WalkResult::advance();
+        });
+
+        struct function_result
+        {
+            std::string out;
+            bool done = false;
+        };
+
+        std::vector< function_result > results(functions.size());
+        std::mutex mutex;
+        std::size_t next = 0;
+
+        mlir::parallelFor(scope->getContext(), 0, functions.size(), [&] (std::size_t i) {
+            auto fn = functions[i];
+            {
+                llvm::raw_string_ostream out(results[i].out);
+                result_printer print(out, req, module);
+                fn->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *op) {
+                    if (req.pattern->match(op)) {
+                        print.matched(op, fn);
+                    }
+                });
+            }
+
+            std::lock_guard< std::mutex > lock(mutex);
+            results[i].done = true;
+            for (; next < results.size() && results[next].done; ++next) {
+                os << results[next].out;
+                results[next].out = {};
+            }
+            os.flush();
+        });
+
+        return mlir::success();
+    }
+
+    //
+    // Index of the symbols of the module and of every scope `--scope` can
+    // select. The scopes are the symbols of symbol tables, in the order
+    // `get_scope_operation` finds them.
+    //
+    void add_index_view(
+        index_builder &index, const util::symbol_user_map &users_of,
+        string_ref name, mlir::Operation *scope
+    ) {
+        index.add_view(name);
+        util::symbols(scope, [&] (auto symbol) {
+            std::vector< std::string > users;
+            users_of.yield_users(symbol, scope, [&] (auto user) {
+                users.push_back(show_user(user));
+            });
+
+            index.add_symbol(
+                util::symbol_name(symbol), util::show_symbol_value(symbol),
+                symbol_kinds(symbol), users
+            );
+        });
+    }
+
+    //
+    // Call graph of the whole module by one walk, whatever the `--scope`.
+    // Functions are numbered as the walk first finds them or their calls.
+    //
+    call_graph build_call_graph(mlir::Operation *mod) {
+        std::vector< std::string > functions;
+        llvm::StringMap< std::uint32_t > ids;
+        auto id = [&] (string_ref name) {
+            auto [it, inserted] = ids.try_emplace(name, std::uint32_t(functions.size()));
+            if (inserted) {
+                functions.push_back(name.str());
+            }
+            return it->second;
+        };
+
+        std::vector< call_graph::edge > edges;
+        llvm::SetVector< std::uint32_t > address_taken, indirect_callers;
+        mod->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *op) {
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op)) {
+                id(fn.getName());
+                return;
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::FuncRefOp >(op)) {
+                address_taken.insert(id(ref.getFunction()));
+                return;
+            }
+
+            if (!mlir::isa< hl::CallOp, hl::IndirectCallOp >(op)) {
+                return;
+            }
+
+            // Calls out of functions, e.g., in initializers, have no caller.
+            auto caller = op->getParentOfType< hl::FuncOp >();
+            if (!caller) {
+                return;
+            }
+
+            if (auto call = mlir::dyn_cast< hl::CallOp >(op)) {
+                edges.push_back({ id(caller.getName()), id(call.getCallee()), false });
+            } else {
+                indirect_callers.insert(id(caller.getName()));
+            }
+        });
+
+        for (auto caller : indirect_callers) {
+            for (auto callee : address_taken) {
+                edges.push_back({ caller, callee, true });
+            }
+        }
+
+        return call_graph::build(std::move(functions), std::move(edges));
+    }
+
+    std::vector< std::uint32_t > callgraph_functions(const call_graph &graph, const query_request &req) {
+        std::vector< std::uint32_t > fns;
+        for (const auto &name : req.functions) {
+            if (auto fn = graph.lookup(name)) {
+                fns.push_back(*fn);
+            }
+        }
+
+        if (req.functions.empty() && req.callgraph == cl::callgraph_query::reachable) {
+            if (auto fn = graph.lookup("main")) {
+                fns.push_back(*fn);
+            }
+        }
+
+        return fns;
+    }
+
+    //
+    // Results of call graph queries, a function per line or JSON objects
+    // like the other queries. Callers and callees of more functions are
+    // preceded by the name of their function and indirect calls are marked.
+    //
+    logical_result do_callgraph(
+        const call_graph &graph, const query_request &req,
+        llvm::raw_ostream &os, string_ref module
+    ) {
+        auto record = [&] (string_ref kind, auto &&fields) {
+            llvm::json::OStream json(os);
+            json.object([&] {
+                json.attribute("kind", kind);
+                if (!module.empty()) {
+                    json.attribute("module", module);
+                }
+                fields(json);
+            });
+            os << "\n";
+        };
+
+        auto fns = callgraph_functions(graph, req);
+        auto ndjson = req.ndjson;
+        switch (req.callgraph) {
+            case cl::callgraph_query::callers:
+            case cl::callgraph_query::callees: {
+                bool callers = req.callgraph == cl::callgraph_query::callers;
+                string_ref kind = callers ? "caller" : "callee";
+                for (auto fn : fns) {
+                    if (!ndjson && fns.size() > 1) {
+                        os << graph.name(fn) << ":\n";
+                    }
+
+                    auto show = [&] (const call_graph::edge &e) {
+                        auto other = graph.name(callers ? e.caller : e.callee);
+                        if (!ndjson) {
+                            os << other << (e.indirect ? " (indirect)" : "") << "\n";
+                            return;
+                        }
+
+                        record(kind, [&] (auto &json) {
+                            json.attribute("function", graph.name(fn));
+                            json.attribute(kind, other);
+                            json.attribute("indirect", e.indirect);
+                        });
+                    };
+
+                    if (callers) {
+                        graph.for_each_caller(fn, show);
+                    } else {
+                        graph.for_each_callee(fn, show);
+                    }
+                }
+                return mlir::success();
+            }
+            case cl::callgraph_query::reachable: {
+                auto reachable = graph.reachable(fns);
+                for (std::uint32_t fn = 0; fn < graph.size(); ++fn) {
+                    if (!reachable[fn]) {
+                        continue;
+                    }
+
+                    if (!ndjson) {
+                        os << graph.name(fn) << "\n";
+                        continue;
+                    }
+
+                    record("reachable", [&] (auto &json) {
+                        json.attribute("function", graph.name(fn));
+                    });
+                }
+                return mlir::success();
+            }
+            case cl::callgraph_query::sccs: {
+                for (const auto &component : graph.recursive_components()) {
+                    if (!ndjson) {
+                        llvm::interleave(component, os, [&] (auto fn) { os << graph.name(fn); }, " ");
+                        os << "\n";
+                        continue;
+                    }
+
+                    record("scc", [&] (auto &json) {
+                        json.attributeArray("functions", [&] {
+                            for (auto fn : component) {
+                                json.value(graph.name(fn));
+                            }
+                        });
+                    });
+                }
+                return mlir::success();
+            }
+            case cl::callgraph_query::none:
+                return mlir::success();
+        }
+
+        VAST_UNREACHABLE("unknown call graph query");
+    }
+
+    logical_result do_build_index(mlir::Operation *mod) {
+        index_builder index;
+        util::symbol_user_map users_of(mod);
+        add_index_view(index, users_of, "", mod);
+        index.set_call_graph(build_call_graph(mod));
+
+        util::global_symbol_tables(mod, [&] (mlir::Operation *table) {
+            auto &region = table->getRegion(0);
+            if (region.empty()) {
+                return;
+            }
+
+            // A lookup finds the first symbol of a name.
+            llvm::StringSet<> seen;
+            for (auto &op : region.front()) {
+                auto name = op.getAttrOfType< mlir::StringAttr >(
+                    mlir::SymbolTable::getSymbolAttrName()
+                );
+                if (name && seen.insert(name.getValue()).second) {
+                    add_index_view(index, users_of, name.getValue(), &op);
+                }
+            }
+        });
+
+        std::string err;
+        auto out = mlir::openOutputFile(cl::options->build_index, &err);
+        if (!out) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        auto input = input_file();
+        auto stamp = input == "-" ? std::nullopt : get_source_stamp(input);
+        index.write(out->os(), stamp);
+        out->keep();
+        return mlir::success();
+    }
+
+    // An index built from the standard input is used as is.
+    bool is_up_to_date(const symbol_index &index) {
+        auto input = input_file();
+        if (input == "-") {
+            return true;
+        }
+
+        auto stamp = index.stamp();
+        return stamp && stamp == get_source_stamp(input);
+    }
+
+    logical_result do_query_index(const symbol_index &index, const query_request &req) {
+        if (req.show_callgraph()) {
+            return do_callgraph(index.get_call_graph(), req, llvm::outs(), {});
+        }
+
+        if (req.show_symbols()) {
+            index.for_each_view(req.scope, [&] (const auto &view) {
+                view.for_each_symbol([&] (const auto &symbol) {
+                    if (req.is_shown(symbol.kinds))
+                        llvm::outs() << symbol.text << "\n";
+                });
+            });
+            return mlir::success();
+        }
+
+        auto names = req.symbol_user_names();
+        user_printer print(names, llvm::outs());
+        index.for_each_view(req.scope, [&] (const auto &view) {
+            for (auto name : names) {
+                view.for_each_symbol([&] (const auto &symbol) {
+                    if (symbol.name != name) {
+                        return;
+                    }
+
+                    for (auto user : symbol.users) {
+                        print(name, user);
+                    }
+                });
+            }
+        });
+        return mlir::success();
+    }
+} // namespace vast::query
+
+namespace vast
+{
+    logical_result get_scope_operation(auto parent, std::string_view scope_name, auto yield) {
+        auto result =mlir::success();
+        util::global_symbol_tables(parent, [&](mlir::Operation *op) {
+            if (failed(yield(mlir::SymbolTable::lookupSymbolIn(op, scope_name)))) {
+                result = mlir::failure();
+            }
+        });
+
+        return result;
+    }
+
+    // Functions of a bytecode module are read only if they are in a queried
+    // scope, the index and the call graph need all of them.
+    bool lazy_function_loading(const query::query_request &req) {
+        return req.constrained_scope() && !query::build_index() && !req.show_callgraph();
+    }
+
+    owning_module_ref read_bytecode(mlir::BytecodeReader &reader) {
+        mlir::Block block;
+        // Operations other than functions are read right away.
+        auto eager = [] (mlir::Operation *op) { return !mlir::isa< hl::FuncOp >(op); };
+        if (failed(reader.readTopLevel(&block, eager)) || !llvm::hasSingleElement(block)) {
+            return {};
+        }
+
+        auto mod = mlir::dyn_cast< vast_module >(&block.front());
+        if (!mod) {
+            return {};
+        }
+
+        mod->remove();
+        return owning_module_ref(mod);
+    }
+
+    logical_result materialize(mlir::BytecodeReader &reader, mlir::Operation *op) {
+        if (!op || !reader.isMaterializable(op)) {
+            return mlir::success();
+        }
+        return reader.materialize(op, [] (mlir::Operation *) { return true; });
+    }
+
+    // Modules embedded into an object by `-vast-embed-hl` are queried as one,
+    // linked in the order of their frames.
+    owning_module_ref read_embedded(mcontext_t &ctx, llvm::MemoryBufferRef buffer) {
+        std::string err;
+        auto embedded = target::llvmir::extract_hl_modules(buffer, ctx, &err);
+        if (!embedded) {
+            llvm::errs() << "error: " << err << "\n";
+            return {};
+        }
+
+        if (embedded->empty()) {
+            llvm::errs() << "error: the object has no embedded hl module\n";
+            return {};
+        }
+
+        if (embedded->size() == 1) {
+            return std::move(embedded->front());
+        }
+
+        owning_module_ref linked(vast_module::create(mlir::UnknownLoc::get(&ctx)));
+        hl::module_linker linker(*linked);
+        for (auto &mod : *embedded) {
+            if (mlir::failed(linker.link(*mod))) {
+                return {};
+            }
+        }
+        return linked;
+    }
+
+    // The reader has to outlive the lazy functions of the module.
+    owning_module_ref parse_module(
+        mcontext_t &ctx, llvm::SourceMgr &source_mgr,
+        std::optional< mlir::BytecodeReader > &reader, bool lazy
+    ) {
+        auto buffer_ref = source_mgr.getMemoryBuffer(source_mgr.getMainFileID())->getMemBufferRef();
+        if (target::llvmir::is_object_file(buffer_ref)) {
+            return read_embedded(ctx, buffer_ref);
+        }
+
+        if (mlir::isBytecode(buffer_ref)) {
+            reader.emplace(buffer_ref, mlir::ParserConfig(&ctx), lazy);
+            return read_bytecode(*reader);
+        }
+
+        return mlir::parseSourceFile< vast_module >(source_mgr, &ctx);
+    }
+
+    // Results of a module queried along with other modules name the module.
+    logical_result process_module(
+        vast_module mod, std::optional< mlir::BytecodeReader > &reader,
+        const query::query_request &req, llvm::raw_ostream &os, string_ref module = {}
+    ) {
+        if (query::build_index() && failed(query::do_build_index(mod))) {
+            return mlir::failure();
+        }
+
+        if (req.show_callgraph()) {
+            return query::do_callgraph(query::build_call_graph(mod), req, os, module);
+        }
+
+        query::result_printer print(os, req, module);
+        auto process_scope = [&] (auto scope) {
+            if (req.show_symbols()) {
+                return query::do_show_symbols(scope, req, print);
+            }
+
+            if (req.show_symbol_users()) {
+                return query::do_show_users(scope, req, print);
+            }
+
+            if (req.show_located()) {
+                return query::do_show_located(scope, req, print);
+            }
+
+            if (req.show_metadata()) {
+                return query::do_show_metadata(scope, req, print);
+            }
+
+            if (req.show_matches()) {
+                return query::do_match(scope, req, os, module);
+            }
+
+            if (req.show_storage_report()) {
+                return query::do_storage_report(scope, os);
+            }
+
+            if (req.show_layout_report()) {
+                return query::do_layout_report(mod, scope, req, os);
+            }
+
+            return mlir::success();
+        };
+
+        mlir::Operation *scope = mod;
+        if (req.constrained_scope()) {
+            return get_scope_operation(scope, req.scope, [&] (auto op) {
+                if (reader && failed(materialize(*reader, op))) {
+                    return mlir::failure();
+                }
+                return process_scope(op);
+            });
+        } else {
+            return process_scope(scope);
+        }
+    }
+
+    logical_result do_query(mcontext_t &ctx, memory_buffer buffer, const query::query_request &req) {
+        llvm::SourceMgr source_mgr;
+        source_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+
+        mlir::SourceMgrDiagnosticHandler manager_handler(source_mgr, &ctx);
+
+        // Disable multi-threading when parsing the input file. This removes the
+        // unnecessary/costly context synchronization when parsing.
+        bool wasThreadingEnabled = ctx.isMultithreadingEnabled();
+        ctx.disableMultithreading();
+
+        std::optional< mlir::BytecodeReader > reader;
+        auto mod = parse_module(ctx, source_mgr, reader, lazy_function_loading(req));
+
+        ctx.enableMultithreading(wasThreadingEnabled);
+        if (!mod) {
+            llvm::errs() << "error: cannot parse module\n";
+            return mlir::failure();
+        }
+
+        return process_module(mod.get(), reader, req, llvm::outs());
+    }
+
+    //
+    // Inputs are files and directories searched recursively for `.mlir` and
+    // `.mlirbc` modules. Modules found in a directory are queried in the
+    // order of their paths.
+    //
+    logical_result collect_inputs(std::vector< std::string > &files) {
+        auto &inputs = cl::options->input_files;
+        if (inputs.empty()) {
+            files.push_back("-");
+            return mlir::success();
+        }
+
+        for (const auto &input : inputs) {
+            if (!llvm::sys::fs::is_directory(input)) {
+                files.push_back(input);
+                continue;
+            }
+
+            std::vector< std::string > modules;
+            std::error_code ec;
+            llvm::sys::fs::recursive_directory_iterator it(input, ec), end;
+            for (; it != end && !ec; it.increment(ec)) {
+                auto ext = llvm::sys::path::extension(it->path());
+                if ((ext == ".mlir" || ext == ".mlirbc") && llvm::sys::fs::is_regular_file(it->path())) {
+                    modules.push_back(it->path());
+                }
+            }
+
+            if (ec) {
+                llvm::errs() << "error: cannot read directory '" << input << "': " << ec.message() << "\n";
+                return mlir::failure();
+            }
+
+            llvm::sort(modules);
+            files.insert(files.end(), modules.begin(), modules.end());
+        }
+
+        return mlir::success();
+    }
+
+    logical_result query_file(
+        mcontext_t &ctx, string_ref path, const query::query_request &req,
+        llvm::raw_ostream &os, llvm::raw_ostream &err
+    ) {
+        std::string msg;
+        auto input = mlir::openInputFile(path, &msg);
+        if (!input) {
+            err << "error: " << msg << "\n";
+            return mlir::failure();
+        }
+
+        llvm::SourceMgr source_mgr;
+        source_mgr.AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+
+        std::optional< mlir::BytecodeReader > reader;
+        auto mod = parse_module(ctx, source_mgr, reader, lazy_function_loading(req));
+        if (!mod) {
+            err << "error: cannot parse module '" << path << "'\n";
+            return mlir::failure();
+        }
+
+        return process_module(mod.get(), reader, req, os, path);
+    }
+
+    //
+    // Queries modules on the thread pool of the context. Results of each
+    // module are buffered and printed in the order of the inputs, preceded by
+    // the path of the module, so the output does not depend on scheduling.
+    // Diagnostics are ordered the same way.
+    //
+    logical_result do_parallel_query(
+        mcontext_t &ctx, llvm::ArrayRef< std::string > files, const query::query_request &req
+    ) {
+        struct module_result
+        {
+            std::string out, err;
+            bool failed = false;
+        };
+
+        std::vector< module_result > results(files.size());
+        {
+            mlir::ParallelDiagnosticHandler diagnostics(&ctx);
+            mlir::parallelFor(&ctx, 0, files.size(), [&] (std::size_t i) {
+                diagnostics.setOrderIDForThread(i);
+
+                auto &result = results[i];
+                llvm::raw_string_ostream out(result.out), err(result.err);
+                result.failed = mlir::failed(query_file(ctx, files[i], req, out, err));
+
+                diagnostics.eraseOrderIDForThread();
+            });
+        }
+
+        auto result = mlir::success();
+        for (const auto &[file, entry] : llvm::zip(files, results)) {
+            // JSON objects name their module.
+            if (!entry.out.empty() && !req.ndjson) {
+                llvm::outs() << "// " << file << "\n";
+            }
+            llvm::outs() << entry.out;
+
+            llvm::errs() << entry.err;
+            if (entry.failed) {
+                result = mlir::failure();
+            }
+        }
+
+        return result;
+    }
+
+    //
+    // A module of `--serve`, loaded once with the indices its queries share:
+    // users of symbols, operations by locations and the call graph.
+    //
+    struct served_module
+    {
+        served_module(std::string path, owning_module_ref module)
+            : path(std::move(path))
+            , mod(std::move(module))
+            , users_of(mod.get())
+            , locations(mod.get())
+            , graph(query::build_call_graph(mod.get()))
+        {}
+
+        std::string path;
+        owning_module_ref mod;
+        util::symbol_user_map users_of;
+        query::location_index locations;
+        query::call_graph graph;
+    };
+
+    // Functions are read right away, nothing is left to the reader.
+    std::unique_ptr< served_module > load_module(mcontext_t &ctx, string_ref path) {
+        std::string err;
+        auto input = mlir::openInputFile(path, &err);
+        if (!input) {
+            llvm::errs() << "error: " << err << "\n";
+            return nullptr;
+        }
+
+        llvm::SourceMgr source_mgr;
+        source_mgr.AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+        mlir::SourceMgrDiagnosticHandler manager_handler(source_mgr, &ctx);
+
+        std::optional< mlir::BytecodeReader > reader;
+        auto mod = parse_module(ctx, source_mgr, reader, /* lazy */ false);
+        if (!mod) {
+            llvm::errs() << "error: cannot parse module '" << path << "'\n";
+            return nullptr;
+        }
+
+        return std::make_unique< served_module >(path.str(), std::move(mod));
+    }
+
+    //
+    // JSON-RPC 2.0 server of `--serve`. Requests come a line each and are
+    // answered in order, a line each. Results are arrays of the objects of
+    // `--format=ndjson`, of all served modules:
+    //
+    //   symbols   { "kind"?, "scope"? }       a kind of --show-symbols, all by default
+    //   users     { "symbols", "scope"? }
+    //   at        { "location", "scope"? }
+    //   callgraph { "query", "functions"? }
+    //   match     { "pattern", "scope"? }
+    //   shutdown
+    //
+    // Requests without an id are notifications and get no response.
+    //
+    struct query_server
+    {
+        enum error_code : std::int64_t
+        {
+            parse_error      = -32700,
+            invalid_request  = -32600,
+            method_not_found = -32601,
+            invalid_params   = -32602
+        };
+
+        // Metrics of requests by method, registered once so that answers
+        // only update atomics.
+        struct method_metrics
+        {
+            explicit method_metrics(string_ref method)
+                : requests(metrics::registry::global().make_counter(
+                    "vast_query_requests", "Requests of the query server.", {{ "method", method.str() }}
+                ))
+                , latency(metrics::registry::global().make_histogram(
+                    "vast_query_request_seconds", "Seconds to answer a request.", {{ "method", method.str() }}
+                ))
+            {}
+
+            metrics::counter &requests;
+            metrics::histogram &latency;
+        };
+
+        query_server()
+            : errors(metrics::registry::global().make_counter(
+                "vast_query_errors", "Requests answered by an error."
+            ))
+        {
+            for (auto method : { "symbols", "users", "at", "callgraph", "match", "shutdown", "unknown" }) {
+                by_method.try_emplace(method, method);
+            }
+        }
+
+        std::vector< std::unique_ptr< served_module > > modules;
+
+        void add_module(std::unique_ptr< served_module > served) {
+            std::uint64_t ops = 0;
+            served->mod->walk([&] (mlir::Operation *) { ++ops; });
+            metrics::registry::global().make_gauge(
+                "vast_query_served_modules", "Modules loaded by the query server."
+            ).inc();
+            metrics::registry::global().make_gauge(
+                "vast_query_served_operations", "Operations of the loaded modules."
+            ).add(double(ops));
+            modules.push_back(std::move(served));
+        }
+
+        // Returns false once the server is asked to stop.
+        bool answer(string_ref line, llvm::raw_ostream &os) const {
+            auto value = llvm::json::parse(line);
+            if (!value) {
+                llvm::consumeError(value.takeError());
+                respond_error(os, nullptr, parse_error, "cannot parse the request");
+                return true;
+            }
+
+            auto request = value->getAsObject();
+            auto method  = request ? request->getString("method") : std::nullopt;
+            if (!method) {
+                respond_error(os, nullptr, invalid_request, "a request is an object with a method");
+                return true;
+            }
+
+            auto known = by_method.find(*method);
+            const auto &measured = known != by_method.end()
+                ? known->second : by_method.find("unknown")->second;
+            measured.requests.inc();
+            metrics::scoped_timer timer(measured.latency);
+
+            auto id = request->get("id");
+            if (*method == "shutdown") {
+                if (id) {
+                    respond(os, *id, [] (auto &json) { json.value(nullptr); });
+                }
+                return false;
+            }
+
+            llvm::json::Object no_params;
+            auto params = request->getObject("params");
+            query::query_request req;
+            req.ndjson = true;
+
+            auto code = make_request(*method, params ? *params : no_params, req);
+            if (!id) {
+                return true;
+            }
+
+            if (code) {
+                auto message = *code == method_not_found
+                    ? "unknown method '" + method->str() + "'"
+                    : "invalid parameters of '" + method->str() + "'";
+                respond_error(os, *id, *code, message);
+                return true;
+            }
+
+            std::string results;
+            llvm::raw_string_ostream ss(results);
+            run_query(req, ss);
+
+            respond(os, *id, [&] (auto &json) {
+                json.array([&] {
+                    llvm::SmallVector< string_ref > lines;
+                    string_ref(ss.str()).split(lines, '\n', -1, false);
+                    for (auto result : lines) {
+                        json.rawValue(result);
+                    }
+                });
+            });
+            return true;
+        }
+
+      private:
+        llvm::StringMap< method_metrics > by_method;
+        metrics::counter &errors;
+
+        static std::optional< error_code > make_request(
+            string_ref method, const llvm::json::Object &params, query::query_request &req
+        ) {
+            auto strings = [&] (string_ref key, std::vector< std::string > &out) {
+                auto value = params.get(key);
+                if (!value) {
+                    return true;
+                }
+
+                auto array = value->getAsArray();
+                if (!array) {
+                    return false;
+                }
+
+                for (const auto &item : *array) {
+                    auto str = item.getAsString();
+                    if (!str) {
+                        return false;
+                    }
+                    out.push_back(str->str());
+                }
+                return true;
+            };
+
+            if (auto scope = params.getString("scope")) {
+                req.scope = scope->str();
+            }
+
+            if (method == "symbols") {
+                auto kind = params.getString("kind").value_or("all");
+                req.symbols = llvm::StringSwitch< cl::show_symbol_type >(kind)
+                    .Case("functions", cl::show_symbol_type::function)
+                    .Case("types", cl::show_symbol_type::type)
+                    .Case("records", cl::show_symbol_type::record)
+                    .Case("vars", cl::show_symbol_type::var)
+                    .Case("globs", cl::show_symbol_type::global)
+                    .Case("all", cl::show_symbol_type::all)
+                    .Default(cl::show_symbol_type::none);
+                return req.show_symbols() ? std::nullopt : std::optional(invalid_params);
+            }
+
+            if (method == "users") {
+                if (!strings("symbols", req.symbol_users) || !req.show_symbol_users()) {
+                    return invalid_params;
+                }
+                return std::nullopt;
+            }
+
+            if (method == "at") {
+                auto location = params.getString("location");
+                if (!location || !query::location_range::parse(*location)) {
+                    return invalid_params;
+                }
+                req.at = location->str();
+                return std::nullopt;
+            }
+
+            if (method == "callgraph") {
+                auto query = params.getString("query").value_or("");
+                req.callgraph = llvm::StringSwitch< cl::callgraph_query >(query)
+                    .Case("callers", cl::callgraph_query::callers)
+                    .Case("callees", cl::callgraph_query::callees)
+                    .Case("reachable", cl::callgraph_query::reachable)
+                    .Case("sccs", cl::callgraph_query::sccs)
+                    .Default(cl::callgraph_query::none);
+                if (!req.show_callgraph() || !strings("functions", req.functions)) {
+                    return invalid_params;
+                }
+                return std::nullopt;
+            }
+
+            if (method == "match") {
+                auto pattern = params.getString("pattern");
+                if (!pattern) {
+                    return invalid_params;
+                }
+                req.match   = pattern->str();
+                req.pattern = query::op_pattern::parse(req.match, nullptr);
+                return req.show_matches() ? std::nullopt : std::optional(invalid_params);
+            }
+
+            return method_not_found;
+        }
+
+        // Results of modules served along with others name their module.
+        void run_query(const query::query_request &req, llvm::raw_ostream &os) const {
+            for (const auto &served : modules) {
+                string_ref module = modules.size() > 1 ? string_ref(served->path) : string_ref();
+                if (req.show_callgraph()) {
+                    (void) query::do_callgraph(served->graph, req, os, module);
+                    continue;
+                }
+
+                query::result_printer print(os, req, module);
+                auto process_scope = [&] (mlir::Operation *scope) {
+                    // Scopes not in the module have no results.
+                    if (!scope) {
+                        return mlir::success();
+                    }
+
+                    if (req.show_symbols()) {
+                        return query::do_show_symbols(scope, req, print);
+                    }
+
+                    if (req.show_symbol_users()) {
+                        auto names = req.symbol_user_names();
+                        util::yield_users(served->users_of, names, scope, [&] (string_ref name, auto user) {
+                            print.user(name, user);
+                        });
+                        return mlir::success();
+                    }
+
+                    if (req.show_matches()) {
+                        return query::do_match(scope, req, os, module);
+                    }
+
+                    auto range = query::location_range::parse(req.at);
+                    served->locations.lookup(*range, [&] (auto op) {
+                        if (scope->isAncestor(op)) {
+                            print.located(op);
+                        }
+                    });
+                    return mlir::success();
+                };
+
+                mlir::Operation *scope = served->mod.get();
+                if (req.constrained_scope()) {
+                    (void) get_scope_operation(scope, req.scope, process_scope);
+                } else {
+                    (void) process_scope(scope);
+                }
+            }
+        }
+
+        static void respond(llvm::raw_ostream &os, const llvm::json::Value &id, auto &&result) {
+            llvm::json::OStream json(os);
+            json.object([&] {
+                json.attribute("jsonrpc", "2.0");
+                json.attribute("id", id);
+                json.attributeBegin("result");
+                result(json);
+                json.attributeEnd();
+            });
+            os << "\n";
+            os.flush();
+        }
+
+        void respond_error(
+            llvm::raw_ostream &os, const llvm::json::Value &id, error_code code, string_ref message
+        ) const {
+            errors.inc();
+            llvm::json::OStream json(os);
+            json.object([&] {
+                json.attribute("jsonrpc", "2.0");
+                json.attribute("id", id);
+                json.attributeObject("error", [&] {
+                    json.attribute("code", std::int64_t(code));
+                    json.attribute("message", message);
+                });
+            });
+            os << "\n";
+            os.flush();
+        }
+    };
+
+    // Modules are loaded before the first request is read.
+    logical_result do_serve(mcontext_t &ctx, llvm::ArrayRef< std::string > files) {
+        query_server server;
+        for (const auto &file : files) {
+            auto served = load_module(ctx, file);
+            if (!served) {
+                return mlir::failure();
+            }
+            server.add_module(std::move(served));
+        }
+
+        // Metrics are exported from a thread of their own, every update is
+        // atomic.
+        std::unique_ptr< metrics::exporter > exporter;
+        if (!query::metrics_spec().empty()) {
+            metrics::register_process_metrics();
+            exporter = metrics::exporter::make(query::metrics_spec());
+            if (!exporter) {
+                return mlir::failure();
+            }
+            exporter->start();
+        }
+
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (string_ref(line).trim().empty()) {
+                continue;
+            }
+
+            if (!server.answer(line, llvm::outs())) {
+                break;
+            }
+        }
+
+        return mlir::success();
+    }
+
+    logical_result run(mcontext_t &ctx) {
+        auto req = query::query_request::from_options();
+        if (req.show_located() && !query::location_range::parse(req.at)) {
+            llvm::errs() << "error: invalid location '" << req.at
+                         << "', expected file:line[:col][-line]\n";
+            return mlir::failure();
+        }
+
+        if (!req.match.empty()) {
+            std::string err;
+            req.pattern = query::op_pattern::parse(req.match, &err);
+            if (!req.pattern) {
+                llvm::errs() << "error: " << err << "\n";
+                return mlir::failure();
+            }
+        }
+
+        std::vector< std::string > files;
+        if (failed(collect_inputs(files))) {
+            return mlir::failure();
+        }
+
+        if (query::serve()) {
+            if (llvm::is_contained(files, "-") || query::build_index() || query::use_index()) {
+                llvm::errs() << "error: --serve reads requests from the standard input, "
+                                "modules are given as files and indices are not used\n";
+                return mlir::failure();
+            }
+
+            return do_serve(ctx, files);
+        }
+
+        // Modules of a directory are reported by their paths even if there
+        // is only one.
+        if (files.size() != 1 || files.front() != query::input_file()) {
+            if (query::build_index() || query::use_index()) {
+                llvm::errs() << "error: --build-index and --index take a single input module\n";
+                return mlir::failure();
+            }
+
+            return do_parallel_query(ctx, files, req);
+        }
+
+        std::string err;
+        if (query::answer_from_index(req)) {
+            auto index = query::symbol_index::open(cl::options->index, &err);
+            if (!index) {
+                llvm::errs() << "error: " << err << "\n";
+                return mlir::failure();
+            }
+
+            if (query::is_up_to_date(*index)) {
+                return query::do_query_index(*index, req);
+            }
+        }
+
+        if (auto input = mlir::openInputFile(files.front(), &err))
+            return do_query(ctx, std::move(input), req);
         llvm::errs() << "error: " << err << "\n";
         return mlir::failure();
     }
@@ -5,7 +5,9 @@
 
 #include "vast/repl/state.hpp"
 
+#include <clang/Serialization/PCHContainerOperations.h>
 #include <llvm/Support/Signals.h>
+#include <llvm/Support/VirtualFileSystem.h>
 
 #include "vast/CodeGen/CodeGen.hpp"
 #include "vast/Frontend/Action.hpp"
@@ -35,7 +37,44 @@ namespace vast::repl::codegen {
         llvm::sys::RunInterruptHandlers();
     }
 
-    owning_module_ref emit_module(const std::filesystem::path &source, mcontext_t */* mctx */) {
+    const clang::PrecompiledPreamble *preamble_cache::get(
+        const clang::CompilerInvocation &invocation, const llvm::MemoryBuffer &buffer,
+        llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem > vfs,
+        clang::DiagnosticsEngine &diags
+    ) {
+        auto bounds = clang::ComputePreambleBounds(
+            *invocation.getLangOpts(), buffer.getMemBufferRef(), /* MaxLines */ 0
+        );
+
+        if (bounds.Size == 0) {
+            preamble.reset();
+            return nullptr;
+        }
+
+        // Reuse checks the bounds, the options and the included files.
+        if (preamble && preamble->CanReuse(invocation, buffer.getMemBufferRef(), bounds, *vfs)) {
+            return &*preamble;
+        }
+
+        clang::PreambleCallbacks callbacks;
+        auto built = clang::PrecompiledPreamble::Build(
+            invocation, &buffer, bounds, diags, vfs,
+            std::make_shared< clang::PCHContainerOperations >(),
+            /* StoreInMemory */ true, /* StoragePath */ "", callbacks
+        );
+
+        if (!built) {
+            preamble.reset();
+            return nullptr;
+        }
+
+        preamble.emplace(std::move(*built));
+        return &*preamble;
+    }
+
+    owning_module_ref emit_module(
+        const std::filesystem::path &source, mcontext_t */* mctx */, preamble_cache &cache
+    ) {
         // TODO setup args from repl state
         std::vector< const char * > ccargs = { source.c_str() };
         vast::cc::buffered_diagnostics diags(ccargs);
@@ -73,7 +112,22 @@ namespace vast::repl::codegen {
             return {};
         }
 
-        if (auto action = std::make_unique< vast::cc::emit_mlir_module >(vargs); !action) {
+        // Without a buffer the compilation reports the missing source.
+        auto vfs = llvm::vfs::getRealFileSystem();
+        if (auto buffer = llvm::MemoryBuffer::getFile(source.string())) {
+            auto &invocation = comp->getInvocation();
+            if (auto preamble = cache.get(invocation, **buffer, vfs, comp->getDiagnostics())) {
+                preamble->AddImplicitPreamble(invocation, vfs, buffer->get());
+                // The source is parsed as it was when checked against the
+                // preamble, the compiler instance owns the buffer.
+                invocation.getPreprocessorOpts().addRemappedFile(
+                    source.string(), buffer->release()
+                );
+            }
+        }
+        comp->createFileManager(vfs);
+
+        if (auto action = std::make_unique< vast::cc::emit_mlir_module >(vargs); action) {
             comp->ExecuteAction(*action);
             llvm::remove_fatal_error_handler();
             return action->result();
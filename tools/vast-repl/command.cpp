@@ -5,6 +5,21 @@
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Tower/Tower.hpp"
 #include "vast/repl/common.hpp"
+#include "vast/repl/jit.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Parser/Parser.h>
+#include <mlir/Support/Timing.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/Process.h>
+VAST_UNRELAX_WARNINGS
+
+#include <chrono>
+#include <future>
+#include <memory>
 #include <optional>
 
 namespace vast::repl::cmd {
@@ -29,20 +44,94 @@ namespace vast::repl::cmd {
         return file_buffer;
     }
 
+    // Modules, textual or bytecode, are loaded as they are, other sources
+    // are compiled.
+    owning_module_ref load_module(state_t &state) {
+        const auto &source = state.source.value();
+        auto ext = source.extension();
+        if (ext != ".mlir" && ext != ".mlirbc") {
+            return codegen::emit_module(source, &state.ctx, state.preamble);
+        }
+
+        auto mod = mlir::parseSourceFile< mlir::ModuleOp >(
+            source.string(), mlir::ParserConfig(&state.ctx)
+        );
+        if (!mod) {
+            VAST_ERROR("error: cannot parse module {0}", source.string());
+        }
+        return mod;
+    }
+
     void check_and_emit_module(state_t &state) {
         if (!state.tower) {
             check_source(state);
-            auto mod    = codegen::emit_module(state.source.value(), &state.ctx);
-            auto [t, _] = tw::default_tower::get(state.ctx, std::move(mod));
+            auto mod    = load_module(state);
+            auto [t, _] = tower_t::get(state.ctx, std::move(mod));
             state.tower = std::move(t);
         }
     }
 
+    // Reloading an edited source replays the tower incrementally.
+    void install_module(state_t &state, owning_module_ref mod) {
+        if (state.tower) {
+            state.tower->rebuild(std::move(mod));
+        } else {
+            auto [t, _] = tower_t::get(state.ctx, std::move(mod));
+            state.tower = std::move(t);
+        }
+        state.identifiers.clear();
+    }
+
+    //
+    // background jobs
+    //
+    job_t &start_job(state_t &state, std::string description, std::size_t total) {
+        state.job = std::make_unique< job_t >(std::move(description), total);
+        return *state.job;
+    }
+
+    double seconds(const job_t &job) {
+        return std::chrono::duration< double >(std::chrono::steady_clock::now() - job.start).count();
+    }
+
+    void collect_job(state_t &state, bool block) {
+        if (!state.job) {
+            return;
+        }
+
+        auto &pending = state.job->result;
+        if (!block && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        // A failed job is dropped as well, its error is reported instead.
+        auto job    = std::move(state.job);
+        auto finish = job->result.get();
+        llvm::outs() << llvm::formatv(
+            "[{0}] {1}, {2}/{3} steps in {4:F3} s\n", job->cancelled ? "cancelled" : "done",
+            job->description, job->done.load(), job->total, seconds(*job)
+        );
+
+        if (finish) {
+            finish(state);
+        }
+    }
+
+    bool cancel_job(state_t &state) {
+        if (!state.job) {
+            return false;
+        }
+        state.job->cancelled = true;
+        return true;
+    }
+
     //
     // exit command
     //
     void exit::run(state_t &state) const {
         state.exit = true;
+        cancel_job(state);
+        collect_job(state, true);
     }
 
     //
@@ -57,6 +146,25 @@ namespace vast::repl::cmd {
     //
     void load::run(state_t &state) const {
         state.source = get_param< source_param >(params).path;
+
+        if (!get_param< background_param >(params).set) {
+            if (state.tower) {
+                install_module(state, load_module(state));
+            }
+            return;
+        }
+
+        // The module is installed when the job is collected, a cancelled load
+        // is finished and discarded.
+        auto &job  = start_job(state, "load " + state.source->string(), 1);
+        job.result = std::async(std::launch::async, [&state, &job] () -> job_t::finish_t {
+            auto mod = std::make_shared< owning_module_ref >(load_module(state));
+            ++job.done;
+            if (job.cancelled) {
+                return {};
+            }
+            return [mod] (state_t &target) { install_module(target, std::move(*mod)); };
+        });
     };
 
     //
@@ -76,15 +184,17 @@ namespace vast::repl::cmd {
 
     void show_module(state_t &state) {
         check_and_emit_module(state);
-        llvm::outs() << state.tower->top().mod << "\n";
+        llvm::outs() << state.tower->materialize(state.tower->top()).get() << "\n";
     }
 
     void show_symbols(state_t &state) {
         check_and_emit_module(state);
 
-        util::symbols(state.tower->top().mod, [&] (auto symbol) {
-            llvm::outs() << util::show_symbol_value(symbol) << "\n";
-        });
+        for (auto op : state.tower->view(state.tower->top())) {
+            util::symbols(op, [&] (auto symbol) {
+                llvm::outs() << util::show_symbol_value(symbol) << "\n";
+            });
+        }
     }
 
     void show::run(state_t &state) const {
@@ -100,54 +210,526 @@ namespace vast::repl::cmd {
     //
     // meta command
     //
-    void meta::add(state_t &state) const {
-        using ::vast::meta::add_identifier;
+    ::vast::meta::identifier_index &get_identifiers(state_t &state, mlir::Operation *top) {
+        return state.identifiers.try_emplace(top, top).first->second;
+    }
 
+    ::vast::meta::identifier_t meta::identifier() const {
+        string_ref arg = get_param< argument_param >(params).value;
+        ::vast::meta::identifier_t id = 0;
+        if (arg.getAsInteger(0, id)) {
+            VAST_ERROR("error: invalid identifier {0}", arg);
+        }
+        return id;
+    }
+
+    void meta::add(state_t &state) const {
         auto name_param = get_param< symbol_param >(params);
-        util::symbols(state.tower->top().mod, [&] (auto symbol) {
-            if (util::symbol_name(symbol) == name_param.value) {
-                auto id = get_param< identifier_param >(params);
-                add_identifier(symbol, id.value);
-                llvm::outs() << symbol << "\n";
-            }
-        });
+        for (auto op : state.tower->view(state.tower->top())) {
+            auto &identifiers = get_identifiers(state, op);
+            util::symbols(op, [&] (auto symbol) {
+                if (util::symbol_name(symbol) == name_param.value) {
+                    identifiers.add_identifier(symbol, identifier());
+                    llvm::outs() << symbol << "\n";
+                }
+            });
+        }
     }
 
     void meta::get(state_t &state) const {
-        using ::vast::meta::get_with_identifier;
-        auto id = get_param< identifier_param >(params);
-        for (auto op : get_with_identifier(state.tower->top().mod, id.value)) {
-            llvm::outs() << *op << "\n";
+        auto id = identifier();
+        for (auto top : state.tower->view(state.tower->top())) {
+            for (auto op : get_identifiers(state, top).get_with_identifier(id)) {
+                llvm::outs() << *op << "\n";
+            }
         }
     }
 
-    void meta::run(state_t &state) const {
-        check_and_emit_module(state);
+    const ::vast::meta::store &get_metadata(const state_t &state) {
+        if (!state.metadata) {
+            VAST_ERROR("error: no metadata store, see `meta open`");
+        }
+        return *state.metadata;
+    }
 
+    void meta::open(state_t &state) const {
+        std::string err;
+        auto path = get_param< argument_param >(params).value;
+        auto store = ::vast::meta::store::open(path, &err);
+        if (!store) {
+            VAST_ERROR("error: {0}", err);
+        }
+
+        state.metadata = std::move(*store);
+        llvm::outs() << state.metadata->size() << " blobs\n";
+    }
+
+    void meta::blob(state_t &state) const {
+        if (auto blob = get_metadata(state).lookup(identifier())) {
+            llvm::outs() << *blob << "\n";
+        }
+    }
+
+    // Identifier of the operation or of the nearest one it derives from, so
+    // that identifiers given at one level of the tower hold at the levels
+    // raised from it.
+    std::optional< ::vast::meta::identifier_t > inherited_identifier(
+        const state_t &state, mlir::Operation *op
+    ) {
+        for (; op; op = state.tower->prev(op)) {
+            if (auto id = ::vast::meta::identifier_of(op)) {
+                return id;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void meta::attached(state_t &state) const {
+        const auto &metadata = get_metadata(state);
+        for (auto top : state.tower->view(state.tower->top())) {
+            top->walk([&] (mlir::Operation *op) {
+                auto id = inherited_identifier(state, op);
+                if (!id) {
+                    return;
+                }
+
+                auto blob = metadata.lookup(*id);
+                if (!blob) {
+                    return;
+                }
+
+                llvm::outs() << *id << ": " << op->getName();
+                if (auto symbol = mlir::dyn_cast< util::mlir_symbol_interface >(op)) {
+                    llvm::outs() << " @" << util::symbol_name(symbol);
+                }
+                llvm::outs() << " (" << blob->size() << " bytes)\n";
+            });
+        }
+    }
+
+    void meta::put(state_t &state) const {
+        auto path   = get_param< symbol_param >(params).value;
+        auto buffer = llvm::MemoryBuffer::getFile(
+            path, /* IsText */ false, /* RequiresNullTerminator */ false
+        );
+
+        if (!buffer) {
+            VAST_ERROR("error: cannot read blob {0}: {1}", path, buffer.getError().message());
+        }
+
+        state.staged.add(identifier(), (*buffer)->getBuffer());
+    }
+
+    // The store is written aside and renamed over the file, the open store
+    // may be mapped from it.
+    void meta::save(state_t &state) const {
+        ::vast::meta::store_builder out;
+        if (state.metadata) {
+            out.add(*state.metadata);
+        }
+        out.add(state.staged);
+
+        auto path = get_param< argument_param >(params).value;
+        auto tmp  = path + ".tmp";
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream os(tmp, ec);
+            if (ec) {
+                VAST_ERROR("error: cannot write {0}: {1}", tmp, ec.message());
+            }
+            out.write(os);
+        }
+
+        if (auto ec = llvm::sys::fs::rename(tmp, path)) {
+            VAST_ERROR("error: cannot write {0}: {1}", path, ec.message());
+        }
+
+        std::string err;
+        auto store = ::vast::meta::store::open(path, &err);
+        if (!store) {
+            VAST_ERROR("error: {0}", err);
+        }
+
+        state.metadata = std::move(*store);
+        state.staged   = {};
+        llvm::outs() << state.metadata->size() << " blobs\n";
+    }
+
+    void meta::run(state_t &state) const {
         auto action  = get_param< action_param >(params);
+        switch (action) {
+            case meta_action::open: return open(state);
+            case meta_action::put:  return put(state);
+            case meta_action::save: return save(state);
+            default: break;
+        }
+
+        check_and_emit_module(state);
         switch (action) {
             case meta_action::add: add(state); break;
             case meta_action::get: get(state); break;
+            case meta_action::blob: blob(state); break;
+            case meta_action::attached: attached(state); break;
+            default: break;
         }
     }
 
     //
     // raise command
     //
-    void raise::run(state_t &state) const {
+    enum class raise_report { none, time, profile };
+
+    std::size_t count_operations(state_t &state, tower_t::handle_t handle) {
+        std::size_t count = 0;
+        for (auto op : state.tower->view(handle)) {
+            op->walk([&] (mlir::Operation *) { ++count; });
+        }
+        return count;
+    }
+
+    double milliseconds(std::chrono::steady_clock::duration time) {
+        return std::chrono::duration< double, std::milli >(time).count();
+    }
+
+    //
+    // Each pass of the pipeline is a step of the tower. Reports of a step
+    // measure the step alone, not the parsing and printing of the module.
+    // Memory is the difference of the allocated heap. A job is cancelled
+    // between steps.
+    //
+    void raise_pipeline(
+        state_t &state, string_ref pipeline, raise_report report, job_t *job = nullptr
+    ) {
         check_and_emit_module(state);
 
-        std::string pipeline = get_param< pipeline_param >(params).value;
         llvm::SmallVector< llvm::StringRef, 2 > passes;
-        llvm::StringRef(pipeline).split(passes, ',');
+        pipeline.split(passes, ',');
 
-        mlir::PassManager pm(&state.ctx);
         auto th = state.tower->top();
         for (auto pass : passes) {
+            if (job && job->cancelled) {
+                break;
+            }
+
+            mlir::PassManager pm(&state.ctx);
             if (mlir::failed(mlir::parsePassPipeline(pass, pm))) {
                 VAST_UNREACHABLE("error: failed to parse pass pipeline");
             }
+
+            if (report == raise_report::none) {
+                th = state.tower->apply(th, pm);
+                if (job) {
+                    ++job->done;
+                }
+                continue;
+            }
+
+            // Per-pass times are printed when the step is done.
+            mlir::DefaultTimingManager timing;
+            if (report == raise_report::profile) {
+                timing.setEnabled(true);
+                timing.setOutput(llvm::outs());
+                timing.setDisplayMode(mlir::DefaultTimingManager::DisplayMode::Tree);
+                pm.enableTiming(timing);
+            }
+
+            auto ops_before    = count_operations(state, th);
+            auto memory_before = std::int64_t(llvm::sys::Process::GetMallocUsage());
+            auto start         = std::chrono::steady_clock::now();
+
             th = state.tower->apply(th, pm);
+
+            auto time   = std::chrono::steady_clock::now() - start;
+            auto memory = std::int64_t(llvm::sys::Process::GetMallocUsage()) - memory_before;
+            llvm::outs() << llvm::formatv(
+                "{0}: {1:F3} ms, ops {2} -> {3}, memory {4}{5} bytes\n",
+                pass, milliseconds(time), ops_before, count_operations(state, th),
+                memory < 0 ? "" : "+", memory
+            );
+        }
+    }
+
+    void raise::run(state_t &state) const {
+        auto pipeline = get_param< pipeline_param >(params).value;
+        if (!get_param< background_param >(params).set) {
+            raise_pipeline(state, pipeline, raise_report::none);
+            state.identifiers.clear();
+            return;
+        }
+
+        // Levels are pushed to the tower as the steps go, those of a cancelled
+        // raise are kept.
+        check_and_emit_module(state);
+        auto steps = std::size_t(llvm::count(pipeline, ',')) + 1;
+        auto &job  = start_job(state, "raise " + pipeline, steps);
+        job.result = std::async(std::launch::async, [&state, &job, pipeline] () -> job_t::finish_t {
+            raise_pipeline(state, pipeline, raise_report::none, &job);
+            return [] (state_t &target) { target.identifiers.clear(); };
+        });
+    }
+
+    //
+    // diff command
+    //
+    struct function_diff
+    {
+        std::size_t before = 0, after = 0;
+        std::size_t added = 0, removed = 0, rewritten = 0;
+
+        bool changed() const { return added || removed || rewritten || before != after; }
+    };
+
+    string_ref top_level_name(mlir::Operation *op) {
+        auto name = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName());
+        return name ? name.getValue() : string_ref("<unnamed>");
+    }
+
+    //
+    // Operations of the later level without an origin in the earlier one are
+    // added, those whose origin is of another kind are rewritten. Operations
+    // of the earlier level that nothing derives from are removed. Top-level
+    // operations the levels share are unchanged and only counted.
+    //
+    void diff::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto &tower = *state.tower;
+        auto last   = tower.top().id;
+        auto from   = get_param< from_param >(params).value;
+        auto to     = get_param< to_param >(params).value;
+        if (from > last || to > last) {
+            VAST_ERROR("error: unknown level, the last one is {0}", last);
+        }
+
+        tower_t::handle_t src{ from }, dst{ to };
+
+        auto src_view = tower.view(src);
+        std::vector< mlir::Operation * > before(src_view.begin(), src_view.end());
+        llvm::DenseSet< mlir::Operation * > in_before(before.begin(), before.end());
+
+        auto dst_view = tower.view(dst);
+        std::vector< mlir::Operation * > after(dst_view.begin(), dst_view.end());
+
+        llvm::MapVector< string_ref, function_diff > functions;
+        llvm::DenseSet< mlir::Operation * > shared, sources;
+        for (auto top : after) {
+            auto &entry = functions[top_level_name(top)];
+            if (in_before.contains(top)) {
+                shared.insert(top);
+                top->walk([&] (mlir::Operation *) { ++entry.before; ++entry.after; });
+                continue;
+            }
+
+            top->walk([&] (mlir::Operation *op) {
+                ++entry.after;
+                auto origin = tower.origin(src, op);
+                if (!origin) {
+                    ++entry.added;
+                    return;
+                }
+
+                sources.insert(origin);
+                if (origin->getName() != op->getName()) {
+                    ++entry.rewritten;
+                }
+            });
+        }
+
+        for (auto top : before) {
+            if (shared.contains(top)) {
+                continue;
+            }
+
+            auto &entry = functions[top_level_name(top)];
+            top->walk([&] (mlir::Operation *op) {
+                ++entry.before;
+                if (!sources.contains(op)) {
+                    ++entry.removed;
+                }
+            });
+        }
+
+        auto row = [] (string_ref name, const function_diff &entry) {
+            llvm::outs() << llvm::formatv(
+                "{0,-32} {1,10} {2,10} {3,8} {4,8} {5,10}\n", name,
+                entry.before, entry.after, entry.added, entry.removed, entry.rewritten
+            );
+        };
+
+        llvm::outs() << llvm::formatv(
+            "{0,-32} {1,10} {2,10} {3,8} {4,8} {5,10}\n",
+            "symbol", "before", "after", "added", "removed", "rewritten"
+        );
+
+        function_diff total;
+        for (const auto &[name, entry] : functions) {
+            total.before    += entry.before;
+            total.after     += entry.after;
+            total.added     += entry.added;
+            total.removed   += entry.removed;
+            total.rewritten += entry.rewritten;
+            if (entry.changed()) {
+                row(name, entry);
+            }
+        }
+        row("total", total);
+    }
+
+    //
+    // time and profile commands
+    //
+    void time::run(state_t &state) const {
+        auto pipeline = get_param< pipeline_param >(params).value;
+        switch (get_param< command_param >(params)) {
+            case timed_command::raise: raise_pipeline(state, pipeline, raise_report::time); break;
+        }
+        state.identifiers.clear();
+    }
+
+    void profile::run(state_t &state) const {
+        auto pipeline = get_param< pipeline_param >(params).value;
+        switch (get_param< command_param >(params)) {
+            case timed_command::raise: raise_pipeline(state, pipeline, raise_report::profile); break;
+        }
+        state.identifiers.clear();
+    }
+
+    //
+    // run and bench commands
+    //
+    struct jit_params
+    {
+        std::vector< std::int64_t > args;
+        unsigned opt_level = 2;
+    };
+
+    jit_params parse_jit_params(string_ref args, string_ref opt) {
+        // An optimization level may stand in place of missing arguments.
+        if (opt.empty() && args.size() == 2 && args.front() == 'O') {
+            std::swap(args, opt);
+        }
+
+        jit_params result;
+        if (!opt.empty()) {
+            if (opt.size() != 2 || opt[0] != 'O' || opt[1] < '0' || opt[1] > '3') {
+                VAST_ERROR("error: unknown optimization level {0}", opt);
+            }
+            result.opt_level = unsigned(opt[1] - '0');
+        }
+
+        llvm::SmallVector< string_ref > values;
+        args.split(values, ',', -1, false);
+        for (auto value : values) {
+            std::int64_t arg = 0;
+            if (value.trim().getAsInteger(0, arg)) {
+                VAST_ERROR("error: invalid argument {0}", value);
+            }
+            result.args.push_back(arg);
+        }
+
+        return result;
+    }
+
+    // The tower is left as it is, a copy of its top is lowered.
+    jit::compiled_function compile(state_t &state, string_ref name, const jit_params &params) {
+        check_and_emit_module(state);
+
+        auto mod = state.tower->materialize(state.tower->top());
+        jit::compiled_function fn(std::move(mod), name, params.opt_level);
+        if (fn.params() != params.args.size()) {
+            VAST_ERROR("error: function {0} takes {1} arguments", name, fn.params());
+        }
+        return fn;
+    }
+
+    void run_function::run(state_t &state) const {
+        auto name = get_param< function_param >(params).value;
+        auto jit  = parse_jit_params(
+            get_param< args_param >(params).value, get_param< opt_param >(params).value
+        );
+
+        auto fn     = compile(state, name, jit);
+        auto start  = std::chrono::steady_clock::now();
+        auto result = fn.call(jit.args);
+        auto time   = std::chrono::steady_clock::now() - start;
+
+        if (result) {
+            llvm::outs() << "result: " << *result << "\n";
+        }
+        llvm::outs() << llvm::formatv("time: {0:F3} ms\n", milliseconds(time));
+    }
+
+    void bench_function::run(state_t &state) const {
+        auto name  = get_param< function_param >(params).value;
+        auto count = get_param< count_param >(params).value;
+        if (count == 0) {
+            VAST_ERROR("error: bench needs a positive number of runs");
+        }
+
+        auto jit = parse_jit_params(
+            get_param< args_param >(params).value, get_param< opt_param >(params).value
+        );
+
+        auto fn = compile(state, name, jit);
+        std::vector< double > times;
+        times.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            (void) fn.call(jit.args);
+            times.push_back(milliseconds(std::chrono::steady_clock::now() - start));
+        }
+
+        llvm::sort(times);
+        auto mid    = times.size() / 2;
+        auto median = times.size() % 2 ? times[mid] : (times[mid - 1] + times[mid]) / 2;
+        llvm::outs() << llvm::formatv(
+            "runs: {0}, min: {1:F3} ms, median: {2:F3} ms\n", count, times.front(), median
+        );
+    }
+
+    //
+    // spill command
+    //
+    void spill::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto directory = get_param< directory_param >(params).path;
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            VAST_ERROR("error: cannot create {0}: {1}", directory.string(), ec.message());
+        }
+
+        state.tower->spill_to_disk({
+            .directory = std::move(directory),
+            .budget    = get_param< budget_param >(params).value
+        });
+        state.identifiers.clear();
+    }
+
+    //
+    // jobs, wait and cancel commands
+    //
+    void jobs::run(state_t &state) const {
+        if (!state.job) {
+            llvm::outs() << "no job is running\n";
+            return;
+        }
+
+        const auto &job = *state.job;
+        llvm::outs() << llvm::formatv(
+            "{0}: {1}/{2} steps, {3:F3} s{4}\n", job.description, job.done.load(), job.total,
+            seconds(job), job.cancelled ? ", cancelling" : ""
+        );
+    }
+
+    void wait::run(state_t &state) const {
+        collect_job(state, true);
+    }
+
+    void cancel::run(state_t &state) const {
+        if (!cancel_job(state)) {
+            llvm::outs() << "no job is running\n";
         }
     }
 
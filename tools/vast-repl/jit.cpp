@@ -0,0 +1,127 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/repl/jit.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/ExecutionEngine/ExecutionEngine.h>
+#include <mlir/ExecutionEngine/OptUtils.h>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/TargetSelect.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Target/LLVMIR/Convert.hpp"
+
+namespace vast::repl::jit {
+
+    namespace
+    {
+        void initialize_native_target() {
+            static bool initialized = [] {
+                llvm::InitializeNativeTarget();
+                llvm::InitializeNativeTargetAsmPrinter();
+                return true;
+            }();
+            (void) initialized;
+        }
+
+        // Integer parameters are passed in full registers by the supported
+        // calling conventions, so any arity is called through 64-bit ones.
+        std::int64_t invoke(void *address, llvm::ArrayRef< std::int64_t > args) {
+            using i64 = std::int64_t;
+            switch (args.size()) {
+                case 0: return reinterpret_cast< i64 (*)() >(address)();
+                case 1: return reinterpret_cast< i64 (*)(i64) >(address)(args[0]);
+                case 2: return reinterpret_cast< i64 (*)(i64, i64) >(address)(args[0], args[1]);
+                case 3: return reinterpret_cast< i64 (*)(i64, i64, i64) >(address)(
+                    args[0], args[1], args[2]
+                );
+                case 4: return reinterpret_cast< i64 (*)(i64, i64, i64, i64) >(address)(
+                    args[0], args[1], args[2], args[3]
+                );
+            }
+            VAST_UNREACHABLE("unsupported number of arguments: {0}", args.size());
+        }
+
+    } // namespace
+
+    compiled_function::compiled_function(owning_module_ref mod, string_ref name, unsigned opt_level) {
+        initialize_native_target();
+
+        auto &mctx = *mod->getContext();
+        target::llvmir::register_vast_to_llvm_ir(mctx);
+        target::llvmir::lower_hl_module(mod.get());
+
+        // The signature is checked on the translated module, the lowering
+        // decides the widths of the parameters.
+        std::string error;
+        auto build = [&] (mlir::Operation *op, llvm::LLVMContext &llvm_ctx) {
+            auto llvm_mod = target::llvmir::translate(mlir::cast< vast_module >(op), llvm_ctx);
+            auto fn = llvm_mod ? llvm_mod->getFunction(name) : nullptr;
+            if (!fn || fn->isDeclaration()) {
+                error = "no definition of function " + name.str();
+                return llvm_mod;
+            }
+
+            auto type = fn->getFunctionType();
+            if (type->isVarArg() || type->getNumParams() > max_params) {
+                error = "cannot call function " + name.str() + " of this many parameters";
+                return llvm_mod;
+            }
+
+            for (auto param : type->params()) {
+                if (!param->isIntegerTy() || param->getIntegerBitWidth() > 64) {
+                    error = "cannot call function " + name.str() + " of non-integer parameters";
+                    return llvm_mod;
+                }
+            }
+
+            auto result = type->getReturnType();
+            if (!result->isVoidTy() && (!result->isIntegerTy() || result->getIntegerBitWidth() > 64)) {
+                error = "cannot call function " + name.str() + " of a non-integer result";
+                return llvm_mod;
+            }
+
+            param_count  = type->getNumParams();
+            result_width = result->isVoidTy() ? 0 : result->getIntegerBitWidth();
+            return llvm_mod;
+        };
+
+        mlir::ExecutionEngineOptions options;
+        options.llvmModuleBuilder = build;
+        options.transformer = mlir::makeOptimizingTransformer(opt_level, 0, nullptr);
+        options.jitCodeGenOptLevel = llvm::CodeGenOpt::Level(opt_level);
+
+        auto created = mlir::ExecutionEngine::create(mod.get(), options);
+        if (!created) {
+            VAST_ERROR("error: cannot compile module: {0}", llvm::toString(created.takeError()));
+        }
+
+        if (!error.empty()) {
+            VAST_ERROR("error: {0}", error);
+        }
+
+        engine = std::move(*created);
+        auto symbol = engine->lookup(name);
+        if (!symbol) {
+            VAST_ERROR("error: {0}", llvm::toString(symbol.takeError()));
+        }
+        address = *symbol;
+    }
+
+    compiled_function::compiled_function(compiled_function &&) = default;
+    compiled_function::~compiled_function() = default;
+
+    std::optional< std::int64_t > compiled_function::call(llvm::ArrayRef< std::int64_t > args) const {
+        VAST_CHECK(args.size() == param_count, "expected {0} arguments", param_count);
+
+        auto value = invoke(address, args);
+        if (!result_width) {
+            return std::nullopt;
+        }
+        return llvm::SignExtend64(std::uint64_t(value), result_width);
+    }
+
+} // namespace vast::repl::jit
@@ -22,6 +22,8 @@ VAST_UNRELAX_WARNINGS
 #include "vast/repl/cli.hpp"
 #include "vast/repl/command.hpp"
 
+#include <cerrno>
+
 using args_t = std::vector< vast::string_ref >;
 
 args_t load_args(int argc, char **argv) {
@@ -58,8 +60,15 @@ namespace vast::repl
                             "get started.\n";
 
             while (!cli.exit()) {
+                cli.poll();
+
+                // Ctrl-C cancels a background job before it quits the repl.
                 std::string cmd;
                 if (auto quit = linenoise::Readline("> ", cmd)) {
+                    if (errno == EAGAIN && cli.cancel()) {
+                        llvm::outs() << "cancelling the job after its current step\n";
+                        continue;
+                    }
                     break;
                 }
 
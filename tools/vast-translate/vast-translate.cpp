@@ -0,0 +1,306 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/TargetParser/Host.h"
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
+#include "vast/Util/Common.hpp"
+
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    enum class emit_kind { llvm, bitcode, assembly, object };
+
+    enum class pipeline_kind { automatic, baseline, with_abi, fast };
+
+    enum class reloc_kind { pic, static_ };
+
+    // clang-format off
+    cl::opt< std::string > input_file{
+        cl::desc("<input module>"), cl::Positional, cl::init("-")
+    };
+
+    cl::opt< std::string > output_file{
+        "o", cl::desc("Output file"), cl::value_desc("filename"), cl::init("-")
+    };
+
+    cl::opt< emit_kind > emit{
+        "emit", cl::desc("Kind of the output"), cl::init(emit_kind::object),
+        cl::values(
+            clEnumValN(emit_kind::llvm, "llvm", "Textual llvm ir"),
+            clEnumValN(emit_kind::bitcode, "bc", "llvm bitcode"),
+            clEnumValN(emit_kind::assembly, "asm", "Target assembly"),
+            clEnumValN(emit_kind::object, "obj", "Object file")
+        )
+    };
+
+    cl::opt< pipeline_kind > pipeline{
+        "pipeline", cl::desc("Lowering pipeline of modules not in the llvm dialect"),
+        cl::init(pipeline_kind::automatic),
+        cl::values(
+            clEnumValN(pipeline_kind::automatic, "auto", "By the optimization level, as vast-front"),
+            clEnumValN(pipeline_kind::baseline, "baseline", "Baseline pipeline"),
+            clEnumValN(pipeline_kind::with_abi, "with-abi", "Baseline pipeline with the abi lowering"),
+            clEnumValN(pipeline_kind::fast, "fast", "Passes the lowering depends on only")
+        )
+    };
+
+    cl::opt< unsigned > opt_level{
+        "O", cl::desc("Optimization level of the lowering and the backend"),
+        cl::Prefix, cl::init(0)
+    };
+
+    cl::opt< std::string > triple{
+        "mtriple", cl::desc("Target triple, by default the one of the module or of the host")
+    };
+
+    cl::opt< std::string > cpu{
+        "mcpu", cl::desc("Target cpu, by default a generic one")
+    };
+
+    cl::opt< reloc_kind > relocation_model{
+        "relocation-model", cl::desc("Relocation model"), cl::init(reloc_kind::pic),
+        cl::values(
+            clEnumValN(reloc_kind::pic, "pic", "Position independent code"),
+            clEnumValN(reloc_kind::static_, "static", "Non-relocatable code")
+        )
+    };
+
+    cl::opt< unsigned > translate_threads{
+        "translate-threads", cl::desc("Threads of the translation to llvm ir"), cl::init(1)
+    };
+
+    cl::opt< bool > timing{
+        "timing", cl::desc("Report the time of the lowering passes to stderr")
+    };
+    // clang-format on
+} // namespace vast::cl
+
+namespace vast
+{
+    namespace llvmir = target::llvmir;
+
+    logical_result error(const llvm::Twine &msg) {
+        llvm::errs() << "vast-translate: error: " << msg << "\n";
+        return mlir::failure();
+    }
+
+    // A module lowered to the llvm dialect, e.g., by `vast-opt`, is
+    // translated as is.
+    bool needs_lowering(vast_module mod) {
+        if (mod->hasAttr(llvmir::checkpoint_attr)) {
+            return true;
+        }
+
+        auto result = mod->walk([&] (operation op) {
+            auto dialect = op->getDialect();
+            if (op == mod.getOperation() || mlir::isa_and_nonnull< mlir::LLVM::LLVMDialect >(dialect)) {
+                return mlir::WalkResult::advance();
+            }
+            return mlir::WalkResult::interrupt();
+        });
+        return result.wasInterrupted();
+    }
+
+    llvmir::pipeline lowering_pipeline() {
+        switch (cl::pipeline) {
+            case cl::pipeline_kind::automatic: return llvmir::default_pipeline(cl::opt_level);
+            case cl::pipeline_kind::baseline:  return llvmir::pipeline::baseline;
+            case cl::pipeline_kind::with_abi:  return llvmir::pipeline::with_abi;
+            case cl::pipeline_kind::fast:      return llvmir::pipeline::fast;
+        }
+        VAST_UNREACHABLE("unknown pipeline");
+    }
+
+    // Defaults of clang compiling C for the level.
+    llvmir::lowering_options get_lowering_options() {
+        auto optimize = cl::opt_level > 0;
+        auto pic      = cl::relocation_model == cl::reloc_kind::pic;
+        return {
+            .strict_aliasing  = optimize,
+            .lifetime_markers = optimize,
+            .signed_overflow_undefined = true,
+            .noundef_params   = true,
+            .value_ranges     = optimize,
+            .promote_vars     = optimize,
+            .inline_functions = optimize,
+            .dso_local        = true,
+            .pic              = pic,
+            .pie              = pic,
+            .return_slots     = true
+        };
+    }
+
+    std::unique_ptr< llvm::TargetMachine > create_target_machine(llvm::Module &mod) {
+        auto triple = !cl::triple.empty() ? cl::triple.getValue()
+            : !mod.getTargetTriple().empty() ? mod.getTargetTriple()
+            : llvm::sys::getDefaultTargetTriple();
+
+        std::string err;
+        auto target = llvm::TargetRegistry::lookupTarget(triple, err);
+        if (!target) {
+            llvm::errs() << "vast-translate: error: " << err << "\n";
+            return nullptr;
+        }
+
+        auto level = cl::opt_level == 0 ? llvm::CodeGenOpt::None
+            : cl::opt_level == 1 ? llvm::CodeGenOpt::Less
+            : cl::opt_level == 2 ? llvm::CodeGenOpt::Default
+            : llvm::CodeGenOpt::Aggressive;
+        auto reloc = cl::relocation_model == cl::reloc_kind::pic
+            ? llvm::Reloc::PIC_ : llvm::Reloc::Static;
+
+        auto cpu = !cl::cpu.empty() ? cl::cpu.getValue() : std::string("generic");
+        std::unique_ptr< llvm::TargetMachine > tm(target->createTargetMachine(
+            triple, cpu, /* features */ "", llvm::TargetOptions(), reloc, std::nullopt, level
+        ));
+
+        if (tm) {
+            mod.setTargetTriple(triple);
+            if (mod.getDataLayoutStr().empty()) {
+                mod.setDataLayout(tm->createDataLayout());
+            }
+        }
+        return tm;
+    }
+
+    void optimize(llvm::Module &mod, llvm::TargetMachine &tm) {
+        if (cl::opt_level == 0) {
+            return;
+        }
+
+        llvm::LoopAnalysisManager lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager cgam;
+        llvm::ModuleAnalysisManager mam;
+
+        llvm::PassBuilder pb(&tm);
+        pb.registerModuleAnalyses(mam);
+        pb.registerCGSCCAnalyses(cgam);
+        pb.registerFunctionAnalyses(fam);
+        pb.registerLoopAnalyses(lam);
+        pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+        auto level = cl::opt_level == 1 ? llvm::OptimizationLevel::O1
+            : cl::opt_level == 2 ? llvm::OptimizationLevel::O2
+            : llvm::OptimizationLevel::O3;
+        pb.buildPerModuleDefaultPipeline(level).run(mod, mam);
+    }
+
+    logical_result emit(llvm::Module &mod, llvm::TargetMachine &tm) {
+        auto binary = cl::emit == cl::emit_kind::bitcode || cl::emit == cl::emit_kind::object;
+
+        std::error_code ec;
+        llvm::ToolOutputFile out(
+            cl::output_file, ec, binary ? llvm::sys::fs::OF_None : llvm::sys::fs::OF_Text
+        );
+        if (ec) {
+            return error("cannot open " + cl::output_file + ": " + ec.message());
+        }
+
+        switch (cl::emit) {
+            case cl::emit_kind::llvm:
+                mod.print(out.os(), nullptr);
+                break;
+            case cl::emit_kind::bitcode:
+                llvm::WriteBitcodeToFile(mod, out.os());
+                break;
+            case cl::emit_kind::assembly:
+            case cl::emit_kind::object: {
+                auto kind = cl::emit == cl::emit_kind::object
+                    ? llvm::CGFT_ObjectFile : llvm::CGFT_AssemblyFile;
+
+                llvm::legacy::PassManager pm;
+                if (tm.addPassesToEmitFile(pm, out.os(), nullptr, kind)) {
+                    return error("the target cannot emit this kind of file");
+                }
+                pm.run(mod);
+                break;
+            }
+        }
+
+        out.keep();
+        return mlir::success();
+    }
+
+    logical_result translate(mcontext_t &mctx) {
+        auto mod = mlir::parseSourceFile< vast_module >(cl::input_file, mlir::ParserConfig(&mctx));
+        if (!mod) {
+            return mlir::failure();
+        }
+
+        if (needs_lowering(*mod)) {
+            pass_manager_config config;
+            config.timing = cl::timing;
+            llvmir::lower_hl_module(mod.get(), lowering_pipeline(), config, get_lowering_options());
+        }
+
+        llvm::LLVMContext llvm_ctx;
+        auto llvm_mod = llvmir::translate(mod.get(), llvm_ctx, cl::translate_threads);
+        if (!llvm_mod) {
+            return error("cannot translate the module to llvm ir");
+        }
+
+        // Only the llvm module is needed from now on.
+        mod = nullptr;
+
+        if (llvm::verifyModule(*llvm_mod, &llvm::errs())) {
+            return error("the translated module is not valid");
+        }
+
+        auto tm = create_target_machine(*llvm_mod);
+        if (!tm) {
+            return mlir::failure();
+        }
+
+        optimize(*llvm_mod, *tm);
+        return emit(*llvm_mod, *tm);
+    }
+
+} // namespace vast
+
+int main(int argc, char **argv) {
+    llvm::InitLLVM x(argc, argv);
+
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST module to object translator\n");
+
+    mlir::DialectRegistry registry;
+    vast::registerAllDialects(registry);
+    mlir::registerAllDialects(registry);
+    vast::target::llvmir::register_vast_to_llvm_ir(registry);
+
+    vast::mcontext_t mctx(registry);
+    mctx.loadAllAvailableDialects();
+
+    return mlir::failed(vast::translate(mctx));
+}